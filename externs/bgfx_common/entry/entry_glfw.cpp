@@ -242,6 +242,20 @@ namespace entry
 		uint8_t m_buttons[Key::Count - Key::GamepadA];
 	};
 
+	// -headless renders offscreen, no window is created
+	static bool isHeadless(int _argc, const char* const* _argv)
+	{
+		for (int ii = 1; ii < _argc; ++ii)
+		{
+			if (0 == bx::strCmp(_argv[ii], "-headless") )
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
 	struct MainThreadEntry
 	{
 		int m_argc;
@@ -416,6 +430,11 @@ namespace entry
 			m_mte.m_argc = _argc;
 			m_mte.m_argv = _argv;
 
+			if (isHeadless(_argc, _argv) )
+			{
+				return runHeadless(_argc, _argv);
+			}
+
 			glfwSetErrorCallback(errorCb);
 
 			if (!glfwInit() )
@@ -625,6 +644,24 @@ namespace entry
 			return m_thread.getExitCode();
 		}
 
+		// the app runs on this thread, the window messages have no window to go to
+		int runHeadless(int _argc, const char* const* _argv)
+		{
+			WindowHandle handle = { m_windowAlloc.alloc() };
+			m_window[0] = NULL;
+
+			m_eventQueue.postSizeEvent(handle, ENTRY_DEFAULT_WIDTH, ENTRY_DEFAULT_HEIGHT);
+
+			int32_t result = main(_argc, _argv);
+
+			while (Msg* msg = m_msgs.pop() )
+			{
+				delete msg;
+			}
+
+			return result;
+		}
+
 		void updateWindowSize(GLFWwindow* _window)
 		{
 			int32_t width{ 0 };
@@ -880,7 +917,8 @@ namespace entry
 
 	void* getNativeWindowHandle(WindowHandle _handle)
 	{
-		return glfwNativeWindowHandle(s_ctx.m_window[_handle.idx]);
+		GLFWwindow* window = s_ctx.m_window[_handle.idx];
+		return NULL != window ? glfwNativeWindowHandle(window) : NULL;
 	}
 
 	void* getNativeDisplayHandle()
@@ -330,6 +330,7 @@ bool processNode(Scene& _scene, std::vector<std::pair<uint32_t, uint32_t>>& _pri
             draw.vertexOffset = mesh.vertexOffset;
             draw.meshletVisibilityOffset = meshletVisibilityOffset;
             _scene.meshDraws.push_back(draw);
+            _scene.drawNodes.push_back((uint32_t)cgltf_node_index(_data, _node));
 
             uint32_t meshletCount = 0;
             if (_seamlessLod) {
@@ -337,7 +338,7 @@ bool processNode(Scene& _scene, std::vector<std::pair<uint32_t, uint32_t>>& _pri
             }
             else {
                 for (uint32_t lod = 0; lod < mesh.lodCount; lod++)
-                    meshletCount = std::max(meshletCount, mesh.lods[lod].meshletCount); // use the maximum one for current mesh
+                    meshletCount += mesh.lods[lod].meshletCount; // meshlets from different lods can be selected for the same draw
             }
 
             meshletVisibilityOffset += meshletCount;
@@ -457,6 +458,22 @@ bool loadGltfScene(Scene& _scene, const char* _path, bool _buildMeshlet, bool _s
         processMesh(_scene.geometry, primitives, gltfMesh, _buildMeshlet, _seamlessLod);
     }
 
+    // -- transform hierarchy, one node for each gltf node, draws refer to it in processNode
+    _scene.transformNodes.resize(data->nodes_count);
+    for (uint32_t ii = 0; ii < data->nodes_count; ++ii)
+    {
+        const cgltf_node* gltfNode = &data->nodes[ii];
+
+        TransformNode& node = _scene.transformNodes[ii];
+        node.pos = vec3(gltfNode->translation[0], gltfNode->translation[1], gltfNode->translation[2] * handednessFactor);
+        node.scale = vec3(gltfNode->scale[0], gltfNode->scale[1], gltfNode->scale[2]);
+        node.orit[0] = gltfNode->rotation[0];
+        node.orit[1] = gltfNode->rotation[1];
+        node.orit[2] = gltfNode->rotation[2] * handednessFactor;
+        node.orit[3] = gltfNode->rotation[3] * handednessFactor;
+        node.parent = gltfNode->parent ? (uint32_t)cgltf_node_index(data, gltfNode->parent) : kInvalidTransformNode;
+    }
+
     // -- nodes
     for (uint32_t ii = 0; ii < data->nodes_count; ++ii)
     {
@@ -465,6 +482,8 @@ bool loadGltfScene(Scene& _scene, const char* _path, bool _buildMeshlet, bool _s
         processNode(_scene, primitives, data, gltfNode, _seamlessLod);
     }
 
+    buildTransformHierarchy(_scene);
+
     // -- images
     char root_path[256];
     getCurrFolder(root_path, 256, _path);
@@ -192,6 +192,42 @@ bool appendMesh(Geometry& _result, std::vector<Vertex>& _vtxes, std::vector<uint
     return true;
 }
 
+void buildMeshletLodBounds(Geometry& _geo)
+{
+    _geo.meshletLods.clear();
+    _geo.meshletLods.resize(_geo.meshlets.size());
+
+    for (const Mesh& mesh : _geo.meshes)
+    {
+        for (uint32_t lodIdx = 0; lodIdx < mesh.lodCount; ++lodIdx)
+        {
+            const MeshLod& lod = mesh.lods[lodIdx];
+            const bool hasParent = (lodIdx + 1) < mesh.lodCount;
+
+            // any meshlet of the next lod that overlaps this one lies in the self sphere expanded by its diameter
+            // so use the largest one to get a parent bound that covers all of them, otherwise holes would appear between the lods
+            float parentRadius = 0.f;
+            if (hasParent)
+            {
+                const MeshLod& parent = mesh.lods[lodIdx + 1];
+                for (uint32_t ii = 0; ii < parent.meshletCount; ++ii)
+                    parentRadius = glm::max(parentRadius, _geo.meshlets[parent.meshletOffset + ii].radius);
+            }
+
+            for (uint32_t ii = 0; ii < lod.meshletCount; ++ii)
+            {
+                const Meshlet& m = _geo.meshlets[lod.meshletOffset + ii];
+                MeshletLodBounds& bounds = _geo.meshletLods[lod.meshletOffset + ii];
+
+                bounds.p_c = m.center;
+                bounds.p_r = m.radius + 2.f * parentRadius;
+                bounds.s_err = lod.error;
+                bounds.p_err = hasParent ? mesh.lods[lodIdx + 1].error : FLT_MAX;
+            }
+        }
+    }
+}
+
 bool parseObj(const char* _path, std::vector<Vertex>& _vertices, std::vector<uint32_t>& _indices)
 {
     fastObjMesh* obj = fast_obj_read(_path);
@@ -77,6 +77,17 @@ struct alignas(16) Cluster
     uint8_t vertexCount;
 };
 
+// per-meshlet lod bounds for the regular lod pipeline, parallel to Geometry::meshlets
+// the meshlet center/radius is the self bound, the parent bound encloses every meshlet of the next lod that may replace it
+struct alignas(16) MeshletLodBounds
+{
+    vec3 p_c;
+    float p_r;
+
+    float s_err;
+    float p_err;
+};
+
 // store all data for meshes with same rendering properties
 struct Geometry
 {
@@ -84,6 +95,7 @@ struct Geometry
     std::vector<uint32_t>   indices;
     std::vector<Meshlet>    meshlets;
     std::vector<Cluster>    clusters;
+    std::vector<MeshletLodBounds> meshletLods;
     std::vector<uint32_t>   meshletdata;
     std::vector<Mesh>       meshes;
 };
@@ -117,5 +129,6 @@ struct alignas(16) SeamlessCluster
 
 size_t appendMeshlets(Geometry& result, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
 bool appendMesh(Geometry& _result, std::vector<Vertex>& _vtxes, std::vector<uint32_t>& _idxes, bool _buildMeshlets);
+void buildMeshletLodBounds(Geometry& _geo);
 bool processSeamlessMesh(Geometry& _outGeo, std::vector<SeamlessVertex>& _vertices, const size_t _idxCount);
 bool loadObj(Geometry& result, const char* path, bool buildMeshlets, bool seamlessLod);
\ No newline at end of file
@@ -28,6 +28,9 @@ namespace kage
     constexpr unsigned int kMaxNumFrameLatency = 3;
     constexpr unsigned int kMaxNumFrameBuffers = 128;
 
+    // the frames the percentiles of the pass timings are taken from
+    constexpr unsigned int kPassTimeHistorySize = 256;
+
     constexpr unsigned int kMaxDrawCalls = ((64 << 10) - 1); // 65535
 
     // bind-less setting
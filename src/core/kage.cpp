@@ -15,6 +15,7 @@
 #include "bx/readerwriter.h"
 #include "bx/settings.h"
 #include "bx/handlealloc.h"
+#include "bx/timer.h"
 
 
 
@@ -260,6 +261,9 @@ namespace kage
         void setNativeWindowHandle(void* _hWnd);
 
         bool checkSupports(VulkanSupportExtension _ext);
+        bool checkSubgroupArithmeticSupports();
+        bool checkStorageImageSupports(ResourceFormat _format);
+        bool checkBufferDeviceAddressSupports();
 
         ShaderHandle registShader(const char* _name, const char* _path);
         ProgramHandle registProgram(const char* _name, const Memory* _shaders, const uint16_t _shaderCount, const uint32_t _sizePushConstants, const BindlessHandle _bindless);
@@ -305,6 +309,9 @@ namespace kage
 
         void updateBuffer(const BufferHandle _hbuf, const Memory* _mem, const uint32_t _offset, const uint32_t _size);
         void updateImage(const ImageHandle _hImg, uint32_t _width, uint32_t _height, uint32_t _layers, const Memory* _mem);
+        void updateImageMips(const ImageHandle _hImg, uint32_t _width, uint32_t _height, uint32_t _numMips, const Memory* _mem);
+        void updateBufferAddresses(const BufferHandle _hBuf, const BufferHandle* _srcs, uint16_t _num, uint32_t _offset);
+        void setPassVariant(const PassHandle _hPass, const GraphicsPipelineConfig& _config, const Memory* _specData, bool _bind);
 
         // renderer execute commands
         void rendererExecCmdQ(CommandQueue& _cmdQ);
@@ -327,6 +334,9 @@ namespace kage
         void bake();
 
         void reset(uint32_t _windth, uint32_t _height, uint32_t _reset);
+        void setPresentMode(PresentMode _mode);
+        void setLatencyMarker(LatencyMarker _marker);
+        LatencyTimings getLatencyTimings();
         void rhi_render();
         void shutdown();
 
@@ -334,9 +344,23 @@ namespace kage
         bool isRenderGraphDataDirty() const { return m_isRenderGraphDataDirty; }
 
         double getPassTime(const PassHandle _hPass);
+        double getPassRecordTime(const PassHandle _hPass);
         uint64_t getPassClipping(const PassHandle _hPass);
 
+        PassTimings getPassTimings(const PassHandle _hPass);
+        PassTimings getGpuTimings();
+        void resetPassTimings();
+        bool dumpPassTimings(const char* _path);
+        MemoryStats getMemoryStats();
+        uint32_t getMemoryBuckets(MemoryBucket* _out, uint32_t _max);
+        uint32_t getMemoryPassUsage(MemoryPassUsage* _out, uint32_t _max);
+        bool dumpMemoryTimeline(const char* _path);
+        void requestReadback(const char* _path);
+        void setShaderHotReload(bool _enable);
+        bool readBuffer(const BufferHandle _hBuf, void* _dst, uint32_t _size, uint32_t _offset);
+
         void brx_setGeoInstances(const Memory* _desc);
+        void brx_updateGeoInstances(const Memory* _deltas);
         void brx_regGeoBuffers(const Memory* _bufs, BufferHandle _vtx, BufferHandle _idx);
         void brx_setUserResources(const Memory* _reses);
         void brx_setDebugInfos(const Memory* _debug);
@@ -672,6 +696,21 @@ namespace kage
         return m_rhiContext->checkSupports(_ext);
     }
 
+    bool Context::checkSubgroupArithmeticSupports()
+    {
+        return m_rhiContext->checkSubgroupArithmeticSupports();
+    }
+
+    bool Context::checkStorageImageSupports(ResourceFormat _format)
+    {
+        return m_rhiContext->checkStorageImageSupports(_format);
+    }
+
+    bool Context::checkBufferDeviceAddressSupports()
+    {
+        return m_rhiContext->checkBufferDeviceAddressSupports();
+    }
+
     ShaderHandle Context::registShader(const char* _name, const char* _path)
     {
         uint16_t idx = m_shaderHandles.alloc();
@@ -1681,6 +1720,12 @@ namespace kage
                 return;
             }
 
+            if (m_bufferMetas[_hBuf.id].usage & BufferUsageFlagBits::read_only)
+            {
+                message(DebugMsgType::error, "the read_only buffer 0x%x can not be written in pass", _hBuf.id);
+                return;
+            }
+
             passMeta.writeBufferNum = insertResInteract(m_writeBuffers, _hPass, _hBuf.id, interact);
             passMeta.writeBufAliasNum = insertWriteResAlias(m_writeForcedBufferAliases, _hPass, _hBuf.id, _outAlias.id);
 
@@ -1891,6 +1936,56 @@ namespace kage
         m_cmdQueue.cmdUpdateImage(_hImg, _width, _height, _layers, _mem);
     }
 
+    void Context::updateImageMips(
+        const ImageHandle _hImg
+        , uint32_t _width
+        , uint32_t _height
+        , uint32_t _numMips
+        , const Memory* _mem
+    )
+    {
+        m_cmdQueue.cmdUpdateImageMips(_hImg, _width, _height, _numMips, _mem);
+    }
+
+    void Context::setPassVariant(const PassHandle _hPass, const GraphicsPipelineConfig& _config, const Memory* _specData, bool _bind)
+    {
+        if (!isValid(_hPass))
+        {
+            message(DebugMsgType::error, "invalid pass when trying to setPassVariant! pass: 0x%x", _hPass.id);
+
+            if (_specData)
+                release(_specData);
+
+            return;
+        }
+
+        m_cmdQueue.cmdSetPassVariant(_hPass, _config, _specData, _bind);
+    }
+
+    void Context::updateBufferAddresses(const BufferHandle _hBuf, const BufferHandle* _srcs, uint16_t _num, uint32_t _offset)
+    {
+        const Memory* mem = alloc(_num * sizeof(BufferHandle));
+        bx::memCopy(mem->data, _srcs, mem->size);
+
+        // only read through the pointers, the graph would not see them in any pass
+        for (uint16_t ii = 0; ii < _num; ++ii)
+        {
+            if (!isValid(_srcs[ii]))
+            {
+                continue;
+            }
+
+            const UnifiedResHandle res{ _srcs[ii] };
+            if (kInvalidIndex == getElemIndex(m_staticUnifiedReses, res))
+            {
+                m_staticUnifiedReses.push_back(res);
+                setRenderGraphDataDirty();
+            }
+        }
+
+        m_cmdQueue.cmdUpdateBufferAddresses(_hBuf, mem, _offset);
+    }
+
     void Context::rendererExecCmdQ(CommandQueue& _cmdQ)
     {
         _cmdQ.reset();
@@ -1974,6 +2069,47 @@ namespace kage
                             release(ubc->m_mem);
                     }
                     break;
+                case Command::update_image_mips:
+                    {
+                        const UpdateImageMipsCmd* umc = reinterpret_cast<const UpdateImageMipsCmd*>(cmd);
+                        m_rhiContext->updateImageMips(
+                            umc->m_handle
+                            , umc->m_width
+                            , umc->m_height
+                            , umc->m_numMips
+                            , umc->m_mem
+                        );
+
+                        if (umc->m_mem)
+                            release(umc->m_mem);
+                    }
+                    break;
+                case Command::update_buffer_addresses:
+                    {
+                        const UpdateBufferAddressesCmd* uac = reinterpret_cast<const UpdateBufferAddressesCmd*>(cmd);
+                        m_rhiContext->updateBufferAddresses(
+                            uac->m_handle
+                            , uac->m_srcs
+                            , uac->m_offset
+                        );
+
+                        release(uac->m_srcs);
+                    }
+                    break;
+                case Command::set_pass_variant:
+                    {
+                        const SetPassVariantCmd* svc = reinterpret_cast<const SetPassVariantCmd*>(cmd);
+                        m_rhiContext->setPassVariant(
+                            svc->m_handle
+                            , svc->m_config
+                            , svc->m_specData
+                            , svc->m_bind
+                        );
+
+                        if (svc->m_specData)
+                            release(svc->m_specData);
+                    }
+                    break;
                 case Command::set_name:
                     {
                         const SetNameCmd* snc = reinterpret_cast<const SetNameCmd*>(cmd);
@@ -2006,7 +2142,7 @@ namespace kage
 
     namespace vk
     {
-        extern RHIContext* rendererCreate(const Resolution& _config, void* _wnd);
+        extern RHIContext* rendererCreate(const Resolution& _config, void* _wnd, bool _headless);
         extern void rendererDestroy();
     }
 
@@ -2017,7 +2153,7 @@ namespace kage
         m_resolution = _init.resolution;
         m_nativeWnd = _init.windowHandle;
 
-        m_rhiContext = vk::rendererCreate(m_resolution, m_nativeWnd);
+        m_rhiContext = vk::rendererCreate(m_resolution, m_nativeWnd, _init.headless);
 
         m_cmdQueue.init(_init.minCmdBufSize);
         
@@ -2103,6 +2239,23 @@ namespace kage
         m_rhiContext->updateResolution(m_resolution);
     }
 
+    void Context::setPresentMode(PresentMode _mode)
+    {
+        m_resolution.presentMode = _mode;
+
+        m_rhiContext->updateResolution(m_resolution);
+    }
+
+    void Context::setLatencyMarker(LatencyMarker _marker)
+    {
+        m_rhiContext->setLatencyMarker(_marker, bx::getHPCounter());
+    }
+
+    LatencyTimings Context::getLatencyTimings()
+    {
+        return m_rhiContext->getLatencyTimings();
+    }
+
     void Context::rhi_render()
     {
         message(DebugMsgType::essential, "start rendering");
@@ -2140,17 +2293,83 @@ namespace kage
         return m_rhiContext->getPassTime(_hPass);
     }
 
+    double Context::getPassRecordTime(const PassHandle _hPass)
+    {
+        return m_rhiContext->getPassRecordTime(_hPass);
+    }
+
     uint64_t Context::getPassClipping(const PassHandle _hPass)
     {
         return m_rhiContext->getPassClipping(_hPass);
     }
 
+    PassTimings Context::getPassTimings(const PassHandle _hPass)
+    {
+        return m_rhiContext->getPassTimings(_hPass);
+    }
+
+    PassTimings Context::getGpuTimings()
+    {
+        return m_rhiContext->getGpuTimings();
+    }
+
+    void Context::resetPassTimings()
+    {
+        m_rhiContext->resetPassTimings();
+    }
+
+    bool Context::dumpPassTimings(const char* _path)
+    {
+        return m_rhiContext->dumpPassTimings(_path);
+    }
+
+    MemoryStats Context::getMemoryStats()
+    {
+        return m_rhiContext->getMemoryStats();
+    }
+
+    uint32_t Context::getMemoryBuckets(MemoryBucket* _out, uint32_t _max)
+    {
+        return m_rhiContext->getMemoryBuckets(_out, _max);
+    }
+
+    uint32_t Context::getMemoryPassUsage(MemoryPassUsage* _out, uint32_t _max)
+    {
+        return m_rhiContext->getMemoryPassUsage(_out, _max);
+    }
+
+    bool Context::dumpMemoryTimeline(const char* _path)
+    {
+        return m_rhiContext->dumpMemoryTimeline(_path);
+    }
+
+    void Context::requestReadback(const char* _path)
+    {
+        m_rhiContext->requestReadback(_path);
+    }
+
+    void Context::setShaderHotReload(bool _enable)
+    {
+        m_rhiContext->setShaderHotReload(_enable);
+    }
+
+    bool Context::readBuffer(const BufferHandle _hBuf, void* _dst, uint32_t _size, uint32_t _offset)
+    {
+        return m_rhiContext->readBuffer(_hBuf, _dst, _size, _offset);
+    }
+
     void Context::brx_setGeoInstances(const Memory* _desc)
     {
         m_rhiContext->brx_setGeoInstances(_desc);
         m_transientMemories.push_back(_desc);
     }
 
+    void Context::brx_updateGeoInstances(const Memory* _deltas)
+    {
+        m_rhiContext->brx_updateGeoInstances(_deltas);
+        m_transientMemories.push_back(_deltas);
+    }
+
     void Context::brx_regGeoBuffers(const Memory* _bufs, BufferHandle _vtx, BufferHandle _idx)
     {
         m_staticUnifiedReses.push_back({ _vtx });
@@ -2387,6 +2606,21 @@ namespace kage
         return s_ctx->checkSupports(_ext);
     }
 
+    bool checkSubgroupArithmeticSupports()
+    {
+        return s_ctx->checkSubgroupArithmeticSupports();
+    }
+
+    bool checkStorageImageSupports(ResourceFormat _format)
+    {
+        return s_ctx->checkStorageImageSupports(_format);
+    }
+
+    bool checkBufferDeviceAddressSupports()
+    {
+        return s_ctx->checkBufferDeviceAddressSupports();
+    }
+
     ShaderHandle registShader(const char* _name, const char* _path)
     {
         return s_ctx->registShader(_name, _path);
@@ -2510,6 +2744,34 @@ namespace kage
         s_ctx->updateBuffer(_hBuf, _mem, _offset, size);
     }
 
+    void updateBufferAddresses(
+        const BufferHandle _buf
+        , const BufferHandle* _srcs
+        , uint16_t _num
+        , uint32_t _offset /*= 0*/
+    )
+    {
+        s_ctx->updateBufferAddresses(_buf, _srcs, _num, _offset);
+    }
+
+    void precompilePassVariant(
+        const PassHandle _hPass
+        , const GraphicsPipelineConfig& _config
+        , const Memory* _specData /*= nullptr*/
+    )
+    {
+        s_ctx->setPassVariant(_hPass, _config, _specData, false);
+    }
+
+    void setPassVariant(
+        const PassHandle _hPass
+        , const GraphicsPipelineConfig& _config
+        , const Memory* _specData /*= nullptr*/
+    )
+    {
+        s_ctx->setPassVariant(_hPass, _config, _specData, true);
+    }
+
     void kage::updateImage(const ImageHandle _hImg
         , uint32_t _width
         , uint32_t _height
@@ -2520,6 +2782,16 @@ namespace kage
         s_ctx->updateImage(_hImg, _width, _height, _layers, _mem);
     }
 
+    void updateImageMips(const ImageHandle _hImg
+        , uint32_t _width
+        , uint32_t _height
+        , uint32_t _numMips
+        , const Memory* _mem /*= nullptr */
+    )
+    {
+        s_ctx->updateImageMips(_hImg, _width, _height, _numMips, _mem);
+    }
+
     void startRec(const PassHandle _hPass)
     {
         s_ctx->startRec(_hPass);
@@ -2792,16 +3064,91 @@ namespace kage
         shutdownAllocator();
     }
 
+    void setPresentMode(PresentMode _mode)
+    {
+        s_ctx->setPresentMode(_mode);
+    }
+
+    void setLatencyMarker(LatencyMarker _marker)
+    {
+        s_ctx->setLatencyMarker(_marker);
+    }
+
+    LatencyTimings getLatencyTimings()
+    {
+        return s_ctx->getLatencyTimings();
+    }
+
     double getPassTime(const PassHandle _hPass)
     {
         return s_ctx->getPassTime(_hPass);
     }
 
+    double getPassRecordTime(const PassHandle _hPass)
+    {
+        return s_ctx->getPassRecordTime(_hPass);
+    }
+
     double getGpuTime()
     {
         return s_ctx->getGpuTime();
     }
 
+    PassTimings getPassTimings(const PassHandle _hPass)
+    {
+        return s_ctx->getPassTimings(_hPass);
+    }
+
+    PassTimings getGpuTimings()
+    {
+        return s_ctx->getGpuTimings();
+    }
+
+    void resetPassTimings()
+    {
+        s_ctx->resetPassTimings();
+    }
+
+    bool dumpPassTimings(const char* _path)
+    {
+        return s_ctx->dumpPassTimings(_path);
+    }
+
+    MemoryStats getMemoryStats()
+    {
+        return s_ctx->getMemoryStats();
+    }
+
+    uint32_t getMemoryBuckets(MemoryBucket* _out, uint32_t _max)
+    {
+        return s_ctx->getMemoryBuckets(_out, _max);
+    }
+
+    uint32_t getMemoryPassUsage(MemoryPassUsage* _out, uint32_t _max)
+    {
+        return s_ctx->getMemoryPassUsage(_out, _max);
+    }
+
+    bool dumpMemoryTimeline(const char* _path)
+    {
+        return s_ctx->dumpMemoryTimeline(_path);
+    }
+
+    void requestReadback(const char* _path)
+    {
+        s_ctx->requestReadback(_path);
+    }
+
+    void setShaderHotReload(bool _enable)
+    {
+        s_ctx->setShaderHotReload(_enable);
+    }
+
+    bool readBuffer(const BufferHandle _hBuf, void* _dst, uint32_t _size, uint32_t _offset /*= 0*/)
+    {
+        return s_ctx->readBuffer(_hBuf, _dst, _size, _offset);
+    }
+
     uint64_t getPassClipping(const PassHandle _hPass)
     {
         return s_ctx->getPassClipping(_hPass);
@@ -2812,6 +3159,11 @@ namespace kage
         s_ctx->brx_setGeoInstances(_desc);
     }
 
+    void brx_updateGeoInstances(const Memory* _deltas)
+    {
+        s_ctx->brx_updateGeoInstances(_deltas);
+    }
+
     void brx_regGeoBuffers(const Memory* _bufs, BufferHandle _vtx, BufferHandle _idx)
     {
         s_ctx->brx_regGeoBuffers(_bufs, _vtx, _idx);
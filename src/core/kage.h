@@ -10,6 +10,11 @@ namespace kage
     using ShaderHandleList = std::initializer_list<const ShaderHandle>;
     // rendering info
     bool checkSupports(VulkanSupportExtension _ext);
+    bool checkSubgroupArithmeticSupports();
+    // the image can be written in a compute shader without a format qualifier
+    bool checkStorageImageSupports(ResourceFormat _format);
+    // the buffers can be read through the device addresses, see BufferUsageFlagBits::device_address
+    bool checkBufferDeviceAddressSupports();
 
     // resource management functions
     ShaderHandle registShader(const char* _name, const char* _path);
@@ -82,6 +87,43 @@ namespace kage
         , const Memory* _mem = nullptr
     );
 
+    // re-create the image with a new top mip, the coarsest mip stays the same
+    // the mips both images have are copied on the gpu, _mem holds the new finer mips only, mip major like the initial upload
+    // the bindless arrays holding the image are rewritten, the frames in flight are waited for once in the frame
+    void updateImageMips(
+        const ImageHandle _hImg
+        , uint32_t _width
+        , uint32_t _height
+        , uint32_t _numMips
+        , const Memory* _mem = nullptr
+    );
+
+    // writes the device addresses of _srcs into _buf as uint64 in order, the sources need the device_address usage
+    // the sources are kept alive in the graph even if no pass binds them
+    void updateBufferAddresses(
+        const BufferHandle _buf
+        , const BufferHandle* _srcs
+        , uint16_t _num
+        , uint32_t _offset = 0
+    );
+
+    // pipeline variants of a pass, the spec constants and the render state replace the ones in the PassDesc
+    // a variant keeps the program, the bindings and the attachments of the pass, switching it needs no rebake
+    // _specData holds the int constants, nullptr keeps the ones of the PassDesc; compute passes ignore _config
+    // the variants are cached by the hash of all of it, a missing one is compiled on a background thread
+    void precompilePassVariant(
+        const PassHandle _hPass
+        , const GraphicsPipelineConfig& _config
+        , const Memory* _specData = nullptr
+    );
+
+    // binds the variant from the first frame it is compiled in, the pass keeps the pipeline it has until then
+    void setPassVariant(
+        const PassHandle _hPass
+        , const GraphicsPipelineConfig& _config
+        , const Memory* _specData = nullptr
+    );
+
     // APIs that would used in the render loop
     void startRec(const PassHandle _hPass);
 
@@ -234,15 +276,52 @@ namespace kage
     void reset(uint32_t _width, uint32_t _height, uint32_t _reset);
     void shutdown();
 
+    // frame pacing
+    void setPresentMode(PresentMode _mode);
+    void setLatencyMarker(LatencyMarker _marker);
+    LatencyTimings getLatencyTimings();
+
     // naive profiling data
     double getPassTime(const PassHandle _hPass);
+    // the cpu time to encode the pass into the command buffer, in ms
+    double getPassRecordTime(const PassHandle _hPass);
     double getGpuTime();
     uint64_t getPassClipping(const PassHandle _hPass);
 
+    // smoothed and percentile timings, the queries are read back a few frames later without waiting for them
+    PassTimings getPassTimings(const PassHandle _hPass);
+    PassTimings getGpuTimings();
+
+    // the per-pass timings are accumulated every frame since the last reset
+    // dump writes the avg/min/max of each pass as json, in the execution order
+    void resetPassTimings();
+    bool dumpPassTimings(const char* _path);
+
+    // the memory the graph allocates, computed on the call
+    // the lists return the full count, at most _max entries are written, the passes are in the execution order
+    // dump writes the buckets with their live passes as json, to find the passes that drive the peak
+    MemoryStats getMemoryStats();
+    uint32_t getMemoryBuckets(MemoryBucket* _out, uint32_t _max);
+    uint32_t getMemoryPassUsage(MemoryPassUsage* _out, uint32_t _max);
+    bool dumpMemoryTimeline(const char* _path);
+
+    // read back the image presented by the next render(), .png or .exr by the extension of _path
+    void requestReadback(const char* _path);
+
+    // watch the spv files, a changed one rebuilds the programs and pipelines using it
+    void setShaderHotReload(bool _enable);
+
+    // copy from a host visible buffer, the frames in flight might still be writing to it
+    bool readBuffer(const BufferHandle _hBuf, void* _dst, uint32_t _size, uint32_t _offset = 0);
+
     // ffx expose ========================================
 
     // set brixelizer instances
     void brx_setGeoInstances(const Memory* _desc);
+
+    // add, update or remove brixelizer instances, an array of BrixelInstanceDelta
+    // updated instances are kept dynamic until they stay still, then baked as static again
+    void brx_updateGeoInstances(const Memory* _deltas);
     
     // set index/vertex buffers for brixelizer
     void brx_regGeoBuffers(const Memory* _bufs, BufferHandle _vtx, BufferHandle _idx);
@@ -185,6 +185,7 @@ namespace kage
         void*           pData{ nullptr };
         uint16_t        resCount{ 0 };
 
+        ResourceLifetime    lifetime{ ResourceLifetime::transition };
         ResInteractDesc    barrierState;
     };
 
@@ -203,6 +204,7 @@ namespace kage
         void*       pData;
 
         ImageAspectFlags    aspectFlags;
+        ResourceLifetime    lifetime{ ResourceLifetime::transition };
         ResInteractDesc    barrierState;
     };
 
@@ -308,6 +308,11 @@ namespace kage
             transfer_dst = 1 << 6,
             uniform_texel = 1 << 7,
             storage_texel = 1 << 8,
+            device_address = 1 << 9, // the shaders can read it through a pointer, see updateBufferAddresses
+
+            // the content is only written on creation or by updateBuffer, never by a pass
+            // no barrier is tracked for the reads, it can not be bound for write
+            read_only = 1 << 10,
 
             max_enum = 0x7fff,
         };
@@ -559,6 +564,14 @@ namespace kage
     };
 
 
+    // falls back to fifo if the surface does not support it
+    enum class PresentMode : uint8_t
+    {
+        immediate,
+        mailbox,
+        fifo,
+    };
+
     struct Resolution
     {
         uint32_t width{ 2560 };
@@ -566,7 +579,8 @@ namespace kage
         uint32_t reset{ 0 };
         ResourceFormat format{ ResourceFormat::r8g8b8a8_unorm };
         uint8_t numBackBuffers{ 2 };
-        uint8_t maxFrameLatency{ kMaxNumFrameLatency };
+        uint8_t maxFrameLatency{ kMaxNumFrameLatency }; // frames in flight, [1, kMaxNumFrameLatency]
+        PresentMode presentMode{ PresentMode::immediate };
     };
 
     struct Init
@@ -576,6 +590,85 @@ namespace kage
         void * windowHandle{ nullptr };
         const char* name{ nullptr };
         uint32_t minCmdBufSize;
+
+        // no surface and no present, the present image is copied into an offscreen image instead
+        // the windowHandle is ignored
+        bool headless{ false };
+    };
+
+    // gpu time in ms, the percentiles are over the last kPassTimeHistorySize frames with results
+    struct PassTimings
+    {
+        double last{ 0.0 };
+        double smoothed{ 0.0 }; // exponential moving average
+        double p50{ 0.0 };
+        double p95{ 0.0 };
+        double p99{ 0.0 };
+        uint32_t numSamples{ 0 };
+    };
+
+    // set by the app on the frame being built, the submit and present are marked by the renderer
+    enum class LatencyMarker : uint8_t
+    {
+        input_sample,
+        simulation_end,
+    };
+
+    // in ms, smoothed; the photon is approximated by the gpu finishing the frame, the wait for the scanout is not included
+    struct LatencyTimings
+    {
+        double inputToSimulationEnd{ 0.0 };
+        double simulationEndToSubmit{ 0.0 };
+        double submitToPresent{ 0.0 };
+        double presentToGpuDone{ 0.0 };
+
+        PassTimings inputToPhoton;
+    };
+
+    // the memory of the baked graph, the sizes are the memory requirements of the device
+    // a bucket is one allocation, the resources aliased in it share the memory
+    // the passes are in the execution order, a bucket is live from the first to the last pass using any of its resources
+    // the transient buckets hold the per-frame resources, the others are live in every pass
+    struct MemoryStats
+    {
+        uint64_t allocatedBytes{ 0 };
+        uint64_t aliasedBytes{ 0 }; // the bytes the aliases would take without sharing
+        uint64_t transientBytes{ 0 };
+        uint64_t peakTransientBytes{ 0 }; // the most transient bytes live in a pass
+        PassHandle peakPass{ kInvalidHandle };
+
+        uint64_t stagingBytes{ 0 }; // copied through the staging buffers by the last frame
+        uint64_t pendingStagingBytes{ 0 }; // held by the transfer queue until its copies are done
+        uint64_t hostBytes{ 0 }; // the scratch, readback and breadcrumb buffers
+
+        uint32_t bufferCount{ 0 };
+        uint32_t imageCount{ 0 };
+        uint32_t bucketCount{ 0 };
+    };
+
+    struct MemoryBucket
+    {
+        const char* name{ nullptr }; // of the base resource
+        bool isImage{ false };
+        bool transient{ false };
+
+        uint16_t resCount{ 0 };
+        uint64_t allocatedBytes{ 0 };
+        uint64_t aliasedBytes{ 0 };
+
+        // the index in the execution order, kInvalidHandle if no pass uses it
+        uint16_t firstPass{ kInvalidHandle };
+        uint16_t lastPass{ kInvalidHandle };
+        float occupancy{ 0.f }; // the share of the passes it is live in
+    };
+
+    struct MemoryPassUsage
+    {
+        PassHandle pass{ kInvalidHandle };
+        const char* name{ nullptr };
+        uint64_t liveBytes{ 0 };
+        uint64_t transientBytes{ 0 };
+        uint16_t liveBuckets{ 0 };
     };
 
     struct VertexBindingDesc
@@ -19,12 +19,18 @@
 #include "pass/mix_rasterzation/vkz_mr_soft_raster.h"
 #include "pass/mix_rasterzation/vkz_mr_hard_raster.h"
 #include "pass/vkz_modify_indirect_cmds.h"
+#include "pass/vkz_sw_occlusion.h"
+#include "pass/vkz_transform_hierarchy.h"
+#include "pass/vkz_taa.h"
+#include "pass/vkz_texture_streaming.h"
 
 #include "entry/entry.h"
 #include "bx/timer.h"
 
 #include "radiance_cascade/vkz_radiance_cascade.h"
 #include "deferred/vkz_deferred.h"
+#include "deferred/vkz_light_cluster.h"
+#include "deferred/vkz_sky_ibl.h"
 #include "radiance_cascade/vkz_rc_debug.h"
 #include "ffx_intg/brixel_intg_kage.h"
 #include "radiance_cascade/vkz_rc2d.h"
@@ -59,12 +65,44 @@ namespace
             config.resolution.width = _width;
             config.resolution.height = _height;
             config.name = "vulkage demo";
-            config.windowHandle = entry::getNativeWindowHandle(entry::kDefaultWindowHandle);
+
+            // the options the renderer is created with
+            for (int32_t ii = 0; ii < _argc; ++ii)
+            {
+                // render into an offscreen image, the entry creates no window
+                if (strcmp(_argv[ii], "-headless") == 0)
+                {
+                    m_headless = true;
+                }
+
+                // -present fifo, mailbox or immediate
+                if (strcmp(_argv[ii], "-present") == 0 && ii + 1 < _argc)
+                {
+                    const char* mode = _argv[ii + 1];
+                    config.resolution.presentMode = strcmp(mode, "fifo") == 0
+                        ? kage::PresentMode::fifo
+                        : strcmp(mode, "mailbox") == 0
+                        ? kage::PresentMode::mailbox
+                        : kage::PresentMode::immediate
+                        ;
+                }
+
+                // frames in flight: -fif 2
+                if (strcmp(_argv[ii], "-fif") == 0 && ii + 1 < _argc)
+                {
+                    config.resolution.maxFrameLatency = (uint8_t)glm::clamp(atoi(_argv[ii + 1]), 1, (int)kage::kMaxNumFrameLatency);
+                }
+            }
+            config.headless = m_headless;
+            config.windowHandle = m_headless ? nullptr : entry::getNativeWindowHandle(entry::kDefaultWindowHandle);
 
             m_width = _width;
             m_height = _height;
 
-            entry::setMouseLock(entry::kDefaultWindowHandle, false);
+            if (!m_headless)
+            {
+                entry::setMouseLock(entry::kDefaultWindowHandle, false);
+            }
 
             kage::init(config);
 
@@ -87,12 +125,121 @@ namespace
                     continue;
                 }
 
+                // compact g-buffer
+                if (strcmp(arg, "-g") == 0)
+                {
+                    m_gBufferLayout = GBufferLayout::compact;
+                    continue;
+                }
+
+                // prefilter the sky on the gpu, skip the cache and the cpu reference
+                if (strcmp(arg, "-ibl_gpu") == 0)
+                {
+                    m_iblOnGpu = true;
+                    continue;
+                }
+
                 if (strcmp(arg, "-l") == 0)
                 {
                     seamlessLod = true;
                     continue;
                 }
 
+                if (strcmp(arg, "-headless") == 0)
+                {
+                    continue;
+                }
+
+                // parsed before the init
+                if ((strcmp(arg, "-present") == 0 || strcmp(arg, "-fif") == 0) && ii + 1 < _argc)
+                {
+                    ++ii;
+                    continue;
+                }
+
+                // stop after n frames: -frames 120
+                if (strcmp(arg, "-frames") == 0 && ii + 1 < _argc)
+                {
+                    m_numFrames = (uint32_t)atoi(_argv[ii + 1]);
+
+                    ++ii;
+                    continue;
+                }
+
+                // read back the last frame: -readback out.png or out.exr
+                if (strcmp(arg, "-readback") == 0 && ii + 1 < _argc)
+                {
+                    m_readbackPath = _argv[ii + 1];
+
+                    ++ii;
+                    continue;
+                }
+
+                // dump the pass timings of the run: -timings out.json
+                if (strcmp(arg, "-timings") == 0 && ii + 1 < _argc)
+                {
+                    m_timingsPath = _argv[ii + 1];
+
+                    ++ii;
+                    continue;
+                }
+
+                // rebuild the passes when a spv in the shader folder changes
+                if (strcmp(arg, "-hot") == 0)
+                {
+                    kage::setShaderHotReload(true);
+                    continue;
+                }
+
+                // read the static scene buffers through the device addresses in the culling and raster passes
+                if (strcmp(arg, "-addr") == 0)
+                {
+                    m_useSceneAddr = true;
+                    continue;
+                }
+
+                // stream the texture mips by the g-buffer feedback
+                if (strcmp(arg, "-stream") == 0)
+                {
+                    m_streamTextures = true;
+                    continue;
+                }
+
+                // the same residency logic without the gpu uploads, the feedback is estimated on the cpu
+                if (strcmp(arg, "-stream_sim") == 0)
+                {
+                    m_streamTextures = true;
+                    m_streamSimulate = true;
+                    continue;
+                }
+
+                // the texture budget in MB: -stream_budget 256
+                if (strcmp(arg, "-stream_budget") == 0 && ii + 1 < _argc)
+                {
+                    m_streamTextures = true;
+                    m_streamBudgetMB = (uint32_t)glm::max(atoi(_argv[ii + 1]), 1);
+
+                    ++ii;
+                    continue;
+                }
+
+                // temporal upscaling instead of the smaa
+                if (strcmp(arg, "-taa") == 0)
+                {
+                    m_useTaa = true;
+                    continue;
+                }
+
+                // render scale of the temporal upscaling: -rs 0.5
+                if (strcmp(arg, "-rs") == 0 && ii + 1 < _argc)
+                {
+                    m_useTaa = true;
+                    m_demoData.dbg_features.common.renderScale = glm::clamp((float)atof(_argv[ii + 1]), .25f, 1.f);
+
+                    ++ii;
+                    continue;
+                }
+
                 if (ii > 0)
                 {
                     pathes[pathCount] = arg;
@@ -101,8 +248,26 @@ namespace
             }
             pathes.resize(pathCount);
 
+            if (m_headless && 0 == m_numFrames)
+            {
+                m_numFrames = kHeadlessDefaultFrames;
+            }
+
+            if (m_useSceneAddr && !kage::checkBufferDeviceAddressSupports())
+            {
+                kage::message(kage::warning, "-addr: the buffer device address is not supported on this device, use the bindings");
+                m_useSceneAddr = false;
+            }
+
             initScene(pathes, forceParse, kage::kSeamlessLod);
 
+            // all targets are created at the output size, they are resized to the render size in the first update
+            m_demoData.dbg_features.common.taaEnabled = m_useTaa;
+            m_renderWidth = _width;
+            m_renderHeight = _height;
+            m_outWidth = _width;
+            m_outHeight = _height;
+
             // ui data
             m_demoData.input.width = (float)_width;
             m_demoData.input.height = (float)_height;
@@ -135,6 +300,8 @@ namespace
                 return false;
             }
 
+            kage::setLatencyMarker(kage::LatencyMarker::input_sample);
+
             int64_t now = bx::getHPCounter();
             static int64_t last = now;
             const int64_t frameTime = now - last;
@@ -170,11 +337,28 @@ namespace
             m_demoData.logic.frontZ = front.z;
 
 
+            updateRenderSize();
+
             refreshData();
 
-            updatePyramid(m_pyramid, m_width, m_height, m_demoData.dbg_features.common.dbgPauseCullTransform);
+            if (m_demoData.dbg_features.common.animateInstances)
+                animateInstances(deltaTimeMS);
+
+            updateTransformHierarchy(m_transformHierarchy);
 
-            updateSkybox(m_skybox, m_width, m_height);
+            // cpu occlusion runs in parallel with the pass recording, it tests the draws where the gpu draws them this frame
+            for (uint32_t di : m_transformHierarchy.movedDraws)
+            {
+                setSoftOcclusionDrawTransform(m_swOcclusion, di, getDrawTransform(m_transformHierarchy, di));
+            }
+
+            m_swOcclusion.enabled = m_demoData.dbg_features.common.swOcclusionEnabled;
+            kickSoftOcclusion(m_swOcclusion, m_demoData.trans, m_demoData.constants);
+
+            updatePyramid(m_pyramid, m_renderWidth, m_renderHeight, m_demoData.dbg_features.common.dbgPauseCullTransform);
+
+            updateSkybox(m_skybox, m_renderWidth, m_renderHeight);
+            updateSkyIbl(m_skyIbl);
 
             updateMeshCulling(m_meshCullingEarly, m_demoData.constants, m_scene.drawCount);
             updateMeshCulling(m_meshCullingLate, m_demoData.constants, m_scene.drawCount);
@@ -185,16 +369,16 @@ namespace
             updateTriangleCulling(m_triangleCullingEarly, m_demoData.constants);
             updateTriangleCulling(m_triangleCullingLate, m_demoData.constants);
 
-            updateModifyIndirectCmds(m_modify2MeshletCullingEarly, m_width, m_height);
-            updateModifyIndirectCmds(m_modify2MeshletCullingLate, m_width, m_height);
-            updateModifyIndirectCmds(m_modify2TriangleCullingEarly, m_width, m_height);
-            updateModifyIndirectCmds(m_modify2TriangleCullingLate, m_width, m_height);
+            updateModifyIndirectCmds(m_modify2MeshletCullingEarly, m_renderWidth, m_renderHeight);
+            updateModifyIndirectCmds(m_modify2MeshletCullingLate, m_renderWidth, m_renderHeight);
+            updateModifyIndirectCmds(m_modify2TriangleCullingEarly, m_renderWidth, m_renderHeight);
+            updateModifyIndirectCmds(m_modify2TriangleCullingLate, m_renderWidth, m_renderHeight);
 
-            updateModifyIndirectCmds(m_modify2SoftRasterEarly, m_width, m_height);
-            updateModifyIndirectCmds(m_modify2SoftRasterLate, m_width, m_height);
+            updateModifyIndirectCmds(m_modify2SoftRasterEarly, m_renderWidth, m_renderHeight);
+            updateModifyIndirectCmds(m_modify2SoftRasterLate, m_renderWidth, m_renderHeight);
 
-            updateModifyIndirectCmds(m_modify2HardRasterEarly, m_width, m_height);
-            updateModifyIndirectCmds(m_modify2HardRasterLate, m_width, m_height);
+            updateModifyIndirectCmds(m_modify2HardRasterEarly, m_renderWidth, m_renderHeight);
+            updateModifyIndirectCmds(m_modify2HardRasterLate, m_renderWidth, m_renderHeight);
 
             updateSoftRaster(m_softRasterEarly);
             updateSoftRaster(m_softRasterLate);
@@ -202,21 +386,51 @@ namespace
             updateHardRaster(m_hardRasterEarly, m_demoData.constants);
             updateHardRaster(m_hardRasterLate, m_demoData.constants);
 
-            updateDeferredShading(m_deferred, m_width, m_height, m_demoData.trans.cameraPos, m_demoData.dbg_features.rc3d.totalRadius, m_demoData.dbg_features.rc3d.idx_type, m_demoData.dbg_features.rc3d);
+            updateLights();
+
+            if (m_streamTextures)
+                updateTextureStreaming(m_texStreaming, m_demoData.trans, m_demoData.constants);
+
+            const mat4 invViewProj = glm::inverse(m_demoData.trans.proj * m_demoData.trans.view);
+            updateDeferredShading(m_deferred, m_renderWidth, m_renderHeight, m_demoData.trans.cameraPos, invViewProj, m_demoData.dbg_features.rc3d.totalRadius, m_demoData.dbg_features.rc3d.idx_type, m_demoData.dbg_features.rc3d);
 
             const kage::Memory* memTransform = kage::alloc(sizeof(TransformData));
             memcpy_s(memTransform->data, memTransform->size, &m_demoData.trans, sizeof(TransformData));
             kage::updateBuffer(m_transformBuf, memTransform);
 
-            m_smaa.update(m_width, m_height);
+            if (m_useTaa)
+            {
+                updateTaa(m_taa, m_renderWidth, m_renderHeight, m_width, m_height, m_jitter, m_demoData.dbg_features.common.taaFeedback);
+            }
+            else
+            {
+                m_smaa.update(m_width, m_height);
+            }
+
+            updateSoftOcclusion(m_swOcclusion);
             {
                 m_demoData.dbg_features.brx.presentImg = kage::ImageHandle{};
                 updateUI(m_ui, m_demoData.input, m_demoData.dbg_features, m_demoData.logic);
             }
 
+            // the last frame of a fixed length run
+            const bool lastFrame = m_numFrames > 0 && m_frameIdx + 1 >= m_numFrames;
+            if (lastFrame && !m_readbackPath.empty())
+            {
+                kage::requestReadback(m_readbackPath.c_str());
+            }
+
             // render
+            kage::setLatencyMarker(kage::LatencyMarker::simulation_end);
             kage::render();
 
+            // skip the first frames, the one-off bakes and the cold caches are not part of the timings
+            m_frameIdx++;
+            if (m_frameIdx == kTimingWarmupFrames && m_frameIdx < m_numFrames)
+            {
+                kage::resetPassTimings();
+            }
+
             // update profiling info
             {
                 static float avgCpuTime = 0.0f;
@@ -224,13 +438,23 @@ namespace
                 setUIProfile("fps", 1000.f / avgCpuTime, "");
                 setUIProfile("cpu(avg)", avgCpuTime, "ms");
 
-                static float avgGpuTime = 0.0f;
-                avgGpuTime = avgGpuTime * 0.95f + (float)kage::getGpuTime() * 0.05f;
-                setUIProfile("gpu(avg)", avgGpuTime, "ms");
+                const kage::PassTimings gpuTimings = kage::getGpuTimings();
+                setUIProfile("gpu(avg)", (float)gpuTimings.smoothed, "ms");
+                setUIProfile("gpu(p95)", (float)gpuTimings.p95, "ms");
+                setUIProfile("gpu(p99)", (float)gpuTimings.p99, "ms");
+
+                const kage::LatencyTimings latency = kage::getLatencyTimings();
+                setUIProfile("latency(avg)", (float)latency.inputToPhoton.smoothed, "ms");
+                setUIProfile("latency(p99)", (float)latency.inputToPhoton.p99, "ms");
 
                 setUIProfile("mesh cull (E)", (float)kage::getPassTime(m_meshCullingEarly.pass), "ms");
                 setUIProfile("mesh cull (L)", (float)kage::getPassTime(m_meshCullingLate.pass), "ms");
 
+                setUIProfile("-> cmd scan (E)", (float)kage::getPassTime(m_meshCullingEarly.scanPass), "ms");
+                setUIProfile("-> cmd scan (L)", (float)kage::getPassTime(m_meshCullingLate.scanPass), "ms");
+                setUIProfile("-> cmd scatter (E)", (float)kage::getPassTime(m_meshCullingEarly.scatterPass), "ms");
+                setUIProfile("-> cmd scatter (L)", (float)kage::getPassTime(m_meshCullingLate.scatterPass), "ms");
+
                 setUIProfile("mlt cull (E)", (float)kage::getPassTime(m_meshletCullingEarly.pass), "ms");
                 setUIProfile("mlt cull (L)", (float)kage::getPassTime(m_meshletCullingLate.pass), "ms");
 
@@ -255,13 +479,71 @@ namespace
                 setUIProfile("-> modify2_hard (E)", (float)kage::getPassTime(m_modify2HardRasterEarly.pass), "ms");
                 setUIProfile("-> modify2_hard (L)", (float)kage::getPassTime(m_modify2HardRasterLate.pass), "ms");
 
-                setUIProfile("smaa_edgecolor", (float)kage::getPassTime(m_smaa.m_edgeColor.pass), "ms");
-                setUIProfile("smaa_weight", (float)kage::getPassTime(m_smaa.m_weight.pass), "ms");
-                setUIProfile("smaa_blur", (float)kage::getPassTime(m_smaa.m_blend.pass), "ms");
+                // the cpu side of the scene passes, compare with and without -addr
+                const kage::PassHandle scenePasses[] =
+                {
+                    m_meshletCullingEarly.pass, m_meshletCullingLate.pass,
+                    m_triangleCullingEarly.pass, m_triangleCullingLate.pass,
+                    m_softRasterEarly.pass, m_softRasterLate.pass,
+                    m_hardRasterEarly.pass, m_hardRasterLate.pass,
+                };
+                double sceneRecordTime = 0.0;
+                for (const kage::PassHandle& pass : scenePasses)
+                {
+                    sceneRecordTime += kage::isValid(pass) ? kage::getPassRecordTime(pass) : 0.0;
+                }
+                setUIProfile(m_useSceneAddr ? "scene record(cpu, addr)" : "scene record(cpu)", (float)sceneRecordTime, "ms");
+
+                if (m_useTaa)
+                {
+                    setUIProfile("taa resolve", (float)kage::getPassTime(m_taa.resolve.pass), "ms");
+                    setUIProfile("taa history", (float)kage::getPassTime(m_taa.copy.pass), "ms");
+                    setUIProfile("render width", m_renderWidth, "px");
+                    setUIProfile("render height", m_renderHeight, "px");
+                }
+                else
+                {
+                    setUIProfile("smaa_edgecolor", (float)kage::getPassTime(m_smaa.m_edgeColor.pass), "ms");
+                    setUIProfile("smaa_weight", (float)kage::getPassTime(m_smaa.m_weight.pass), "ms");
+                    setUIProfile("smaa_blur", (float)kage::getPassTime(m_smaa.m_blend.pass), "ms");
+                }
 
                 setUIProfile("ui", (float)kage::getPassTime(m_ui.pass), "ms");
 
+                setUIProfile("transform hierarchy", (float)kage::getPassTime(m_transformHierarchy.pass), "ms");
+                setUIProfile("transform uploads", m_transformHierarchy.uploadedCount, "");
+
+                setUIProfile("sw occlusion(cpu)", m_swOcclusion.cpuTime, "ms");
+                setUIProfile("sw occluders", m_swOcclusion.occluderCount, "");
+                setUIProfile("sw occluded", m_swOcclusion.occludedCount, "");
+
+                if (m_streamTextures)
+                {
+                    setUIProfile("tex stream(cpu)", m_texStreaming.cpuTime, "ms");
+                    setUIProfile("tex resident", float(m_texStreaming.residentBytes) / (1024.f * 1024.f), "MB");
+                    setUIProfile("tex loads", (uint32_t)m_texStreaming.loads.size(), "");
+                    setUIProfile("tex loaded", m_texStreaming.loadedCount, "");
+                    setUIProfile("tex evicted", m_texStreaming.evictedCount, "");
+                }
+
                 setUIProfile("skybox", (float)kage::getPassTime(m_skybox.pass), "ms");
+                if (m_skyIbl.gpuBake)
+                {
+                    setUIProfile("sky prefilter", (float)kage::getPassTime(m_skyIbl.prefilterPass), "ms");
+                    setUIProfile("sky sh", (float)kage::getPassTime(m_skyIbl.shPass), "ms");
+                }
+
+                setUIProfile("deferred", (float)kage::getPassTime(m_deferred.pass), "ms");
+                setUIProfile("light cluster", (float)kage::getPassTime(m_lightCluster.pass), "ms");
+                setUIProfile("lights", (uint32_t)m_lightCluster.lights.size(), "");
+                if (m_lightCluster.useCpuBuild)
+                {
+                    setUIProfile("light cluster(cpu)", m_lightCluster.cpuTime, "ms");
+                    setUIProfile("light cluster pairs", m_lightCluster.cpuLightPairs, "");
+                    setUIProfile("light cluster max", m_lightCluster.cpuMaxClusterLights, "");
+                }
+                setUIProfile("g-buffer", getGBufferBytesPerPixel(m_gBuffer.layout), "B/px");
+                setUIProfile("g-buffer traffic", getGBufferTrafficMB(m_gBuffer.layout, m_renderWidth, m_renderHeight), "MB");
 
                 float triCnt = (float)(kage::getPassClipping(m_hardRasterLate.pass)) + (float)(kage::getPassClipping(m_hardRasterEarly.pass));
                 setUIProfile("tri count", triCnt, "");
@@ -269,9 +551,36 @@ namespace
             }
             KG_FrameMark;
 
+            if (lastFrame)
+            {
+                if (!m_timingsPath.empty())
+                {
+                    kage::dumpPassTimings(m_timingsPath.c_str());
+                }
+
+                return false;
+            }
+
             return true;
         }
 
+        void updateLights()
+        {
+            const Dbg_Common& common = m_demoData.dbg_features.common;
+
+            // the demo scenes have no lights, spread random ones over the scene
+            const uint32_t lightCount = glm::min((uint32_t)glm::max(common.lightCount, 0), m_lightCluster.maxLights);
+            if (lightCount != (uint32_t)m_lightCluster.lights.size())
+            {
+                std::vector<PunctualLight> lights;
+                generateRandomLights(lights, lightCount, m_scene.radius);
+                setLights(m_lightCluster, lights.data(), lightCount);
+            }
+
+            m_lightCluster.useCpuBuild = common.cpuLightClusters;
+            updateLightCluster(m_lightCluster, m_demoData.trans, m_demoData.constants, common.dbgPauseCullTransform);
+        }
+
         int shutdown() override
         {
             freeCameraDestroy();
@@ -282,13 +591,18 @@ namespace
 
         bool initScene(const std::vector<std::string>& _pathes, bool _forceParse, bool _seamlessLod)
         {
-            bool lmr = loadScene(m_scene, _pathes, m_supportMeshShading, _seamlessLod, _forceParse);
+            bool lmr = loadScene(m_scene, _pathes, m_supportMeshShading, _seamlessLod, _forceParse, m_streamTextures);
             return lmr;
         }
 
 
         void createBuffers()
         {
+            // the static scene buffers, only uploaded once
+            const kage::BufferUsageFlags staticUsage = m_useSceneAddr
+                ? (kage::BufferUsageFlagBits::device_address | kage::BufferUsageFlagBits::read_only)
+                : kage::BufferUsageFlagBits::none;
+
             // mesh data
             {
                 const kage::Memory* memMeshBuf = kage::alloc((uint32_t)(sizeof(Mesh) * m_scene.geometry.meshes.size()));
@@ -296,7 +610,7 @@ namespace
 
                 kage::BufferDesc meshBufDesc;
                 meshBufDesc.size = memMeshBuf->size;
-                meshBufDesc.usage = kage::BufferUsageFlagBits::storage | kage::BufferUsageFlagBits::transfer_dst;
+                meshBufDesc.usage = kage::BufferUsageFlagBits::storage | kage::BufferUsageFlagBits::transfer_dst | staticUsage;
                 meshBufDesc.memFlags = kage::MemoryPropFlagBits::device_local;
                 m_meshBuf = kage::registBuffer("mesh", meshBufDesc, memMeshBuf);
             }
@@ -360,7 +674,7 @@ namespace
 
                 kage::BufferDesc vtxBufDesc;
                 vtxBufDesc.size = memVtxBuf->size;
-                vtxBufDesc.usage = kage::BufferUsageFlagBits::storage | kage::BufferUsageFlagBits::transfer_dst;
+                vtxBufDesc.usage = kage::BufferUsageFlagBits::storage | kage::BufferUsageFlagBits::transfer_dst | staticUsage;
                 vtxBufDesc.memFlags = kage::MemoryPropFlagBits::device_local;
                 m_vtxBuf = kage::registBuffer("vtx", vtxBufDesc, memVtxBuf);
             }
@@ -399,11 +713,24 @@ namespace
 
                     kage::BufferDesc meshletBufferDesc;
                     meshletBufferDesc.size = memMeshletBuf->size;
-                    meshletBufferDesc.usage = kage::BufferUsageFlagBits::storage | kage::BufferUsageFlagBits::transfer_dst;
+                    meshletBufferDesc.usage = kage::BufferUsageFlagBits::storage | kage::BufferUsageFlagBits::transfer_dst | staticUsage;
                     meshletBufferDesc.memFlags = kage::MemoryPropFlagBits::device_local;
                     m_meshletBuffer = kage::registBuffer("meshlet(cluster)_buffer", meshletBufferDesc, memMeshletBuf);
                 }
 
+                // meshlet lod bounds buffer, the seamless lod pipeline keeps the bounds in the clusters
+                if (kage::kSeamlessLod != 1 && !m_scene.geometry.meshletLods.empty())
+                {
+                    const kage::Memory* memMeshletLodBuf = kage::alloc((uint32_t)(m_scene.geometry.meshletLods.size() * sizeof(MeshletLodBounds)));
+                    memcpy(memMeshletLodBuf->data, m_scene.geometry.meshletLods.data(), memMeshletLodBuf->size);
+
+                    kage::BufferDesc meshletLodBufferDesc;
+                    meshletLodBufferDesc.size = memMeshletLodBuf->size;
+                    meshletLodBufferDesc.usage = kage::BufferUsageFlagBits::storage | kage::BufferUsageFlagBits::transfer_dst | staticUsage;
+                    meshletLodBufferDesc.memFlags = kage::MemoryPropFlagBits::device_local;
+                    m_meshletLodBuffer = kage::registBuffer("meshlet_lod_buffer", meshletLodBufferDesc, memMeshletLodBuf);
+                }
+
                 // meshlet data buffer
                 {
                     const kage::Memory* memMeshletDataBuf = kage::alloc((uint32_t)(m_scene.geometry.meshletdata.size() * sizeof(uint32_t)));
@@ -411,32 +738,64 @@ namespace
 
                     kage::BufferDesc meshletDataBufferDesc;
                     meshletDataBufferDesc.size = memMeshletDataBuf->size;
-                    meshletDataBufferDesc.usage = kage::BufferUsageFlagBits::storage | kage::BufferUsageFlagBits::transfer_dst;
+                    meshletDataBufferDesc.usage = kage::BufferUsageFlagBits::storage | kage::BufferUsageFlagBits::transfer_dst | staticUsage;
                     meshletDataBufferDesc.memFlags = kage::MemoryPropFlagBits::device_local;
                     m_meshletDataBuffer = kage::registBuffer("meshlet_data_buffer", meshletDataBufferDesc, memMeshletDataBuf);
                 }
+
+                // scene address block, the addresses are written once the buffers are created
+                if (m_useSceneAddr)
+                {
+                    kage::BufferHandle addrs[(uint16_t)SceneAddressSlot::count];
+                    addrs[(uint16_t)SceneAddressSlot::meshes] = m_meshBuf;
+                    addrs[(uint16_t)SceneAddressSlot::meshlets] = m_meshletBuffer;
+                    addrs[(uint16_t)SceneAddressSlot::meshlet_lods] = m_meshletLodBuffer; // invalid with the seamless lod, a null address
+                    addrs[(uint16_t)SceneAddressSlot::vertices] = m_vtxBuf;
+                    addrs[(uint16_t)SceneAddressSlot::meshlet_data] = m_meshletDataBuffer;
+
+                    kage::BufferDesc sceneAddrBufDesc;
+                    sceneAddrBufDesc.size = (uint32_t)(sizeof(uint64_t) * COUNTOF(addrs));
+                    sceneAddrBufDesc.usage = kage::BufferUsageFlagBits::uniform | kage::BufferUsageFlagBits::transfer_dst | kage::BufferUsageFlagBits::read_only;
+                    sceneAddrBufDesc.memFlags = kage::MemoryPropFlagBits::device_local;
+                    m_sceneAddrBuf = kage::registBuffer("scene_address", sceneAddrBufDesc);
+
+                    kage::updateBufferAddresses(m_sceneAddrBuf, addrs, COUNTOF(addrs));
+                }
             }
         }
 
         void createImages()
         {
             // create scene images
-            for (const ImageInfo& img : m_scene.images)
+            if (m_streamTextures)
             {
-                const kage::Memory* mem = kage::copy(m_scene.imageDatas.data() + img.dataOffset, img.dataSize);
-                kage::ImageDesc imgDesc;
-                imgDesc.width = img.w;
-                imgDesc.height = img.h;
-                imgDesc.depth = 1;
-                imgDesc.numLayers = img.layerCount;
-                imgDesc.numMips = img.mipCount;
-                imgDesc.format = img.format;
-                imgDesc.type = (img.layerCount > 1) ? kage::ImageType::type_3d : kage::ImageType::type_2d;
-                imgDesc.viewType = img.isCubeMap ? kage::ImageViewType::type_cube : kage::ImageViewType::type_2d;
-                imgDesc.usage = kage::ImageUsageFlagBits::sampled | kage::ImageUsageFlagBits::transfer_dst;
+                TextureStreamingInitData tsInit{};
+                tsInit.budget = uint64_t(m_streamBudgetMB) << 20;
+                tsInit.gpuFeedback = m_supportMeshShading;
+                tsInit.simulate = m_streamSimulate;
+                initTextureStreaming(m_texStreaming, m_scene, tsInit);
 
-                kage::ImageHandle imgHandle = kage::registTexture(img.name, imgDesc, mem);
-                m_sceneImages.emplace_back(imgHandle);
+                getStreamedImages(m_texStreaming, m_sceneImages);
+            }
+            else
+            {
+                for (const ImageInfo& img : m_scene.images)
+                {
+                    const kage::Memory* mem = kage::copy(m_scene.imageDatas.data() + img.dataOffset, img.dataSize);
+                    kage::ImageDesc imgDesc;
+                    imgDesc.width = img.w;
+                    imgDesc.height = img.h;
+                    imgDesc.depth = 1;
+                    imgDesc.numLayers = img.layerCount;
+                    imgDesc.numMips = img.mipCount;
+                    imgDesc.format = img.format;
+                    imgDesc.type = (img.layerCount > 1) ? kage::ImageType::type_3d : kage::ImageType::type_2d;
+                    imgDesc.viewType = img.isCubeMap ? kage::ImageViewType::type_cube : kage::ImageViewType::type_2d;
+                    imgDesc.usage = kage::ImageUsageFlagBits::sampled | kage::ImageUsageFlagBits::transfer_dst;
+
+                    kage::ImageHandle imgHandle = kage::registTexture(img.name, imgDesc, mem);
+                    m_sceneImages.emplace_back(imgHandle);
+                }
             }
 
             {
@@ -458,11 +817,12 @@ namespace
             }
 
             {
-                m_skybox_cube = loadImageFromFile("skybox_cubemap", "./data/textures/cubemap_vulkan.ktx");
+                m_skybox_cube = loadImageFromFile("skybox_cubemap", m_skyCubePath);
             }
 
             {
-                m_gBuffer = createGBuffer();
+                // both rasterizers write the velocity
+                m_gBuffer = createGBuffer(m_gBufferLayout, true);
             }
         }
 
@@ -470,11 +830,29 @@ namespace
         {
             preparePyramid(m_pyramid, m_width, m_height);
 
+            // transform hierarchy, all passes below read the draws from its output
+            {
+                TransformHierarchyInitData thInit{};
+                thInit.meshDrawBuf = m_meshDrawBuf;
+                initTransformHierarchy(m_transformHierarchy, m_scene, thInit);
+            }
+
+            // cpu software occlusion
+            {
+                SoftOcclusionInitData soInit{};
+                initSoftOcclusion(m_swOcclusion, m_scene, soInit);
+            }
+
             // skybox pass
             {
                 initSkyboxPass(m_skybox, m_transformBuf, m_color, m_skybox_cube);
             }
 
+            // ambient of the sky
+            {
+                initSkyIbl(m_skyIbl, m_skybox_cube, m_skyCubePath, m_iblOnGpu);
+            }
+
             // == EARLY passes ==
             // 
             
@@ -482,12 +860,14 @@ namespace
             {
                 MeshCullingInitData cullingInit{};
                 cullingInit.meshBuf = m_meshBuf;
-                cullingInit.meshDrawBuf = m_meshDrawBuf;
+                cullingInit.meshDrawBuf = m_transformHierarchy.meshDrawBufOutAlias;
                 cullingInit.transBuf = m_transformBuf;
                 cullingInit.pyramid = m_pyramid.image;
                 cullingInit.meshDrawCmdBuf = m_meshDrawCmdBuf;
                 cullingInit.meshDrawCmdCountBuf = m_indirectCountBuf;
                 cullingInit.meshDrawVisBuf = m_meshDrawVisBuf;
+                cullingInit.drawCount = m_scene.drawCount;
+                cullingInit.swOcclusionVisBuf = m_swOcclusion.visBuf;
 
                 initMeshCulling(m_meshCullingEarly, cullingInit, PassStage::early, RenderPipeline::mixed);
             }
@@ -509,11 +889,14 @@ namespace
                 meshletCullingInit.meshletCmdBuf = m_modify2MeshletCullingEarly.cmdBufOutAlias;
                 meshletCullingInit.meshletCmdCntBuf = m_modify2MeshletCullingEarly.indirectCmdBufOutAlias;
                 meshletCullingInit.meshBuf = m_meshBuf;
-                meshletCullingInit.meshDrawBuf = m_meshDrawBuf;
+                meshletCullingInit.meshDrawBuf = m_transformHierarchy.meshDrawBufOutAlias;
                 meshletCullingInit.transformBuf = m_transformBuf;
                 meshletCullingInit.meshletBuf = m_meshletBuffer;
+                meshletCullingInit.meshletLodBuf = m_meshletLodBuffer;
+                meshletCullingInit.sceneAddrBuf = m_sceneAddrBuf;
                 meshletCullingInit.meshletVisBuf = m_meshletVisBuf;
                 meshletCullingInit.pyramid = m_pyramid.image;
+                meshletCullingInit.trivialAccept = true;
                 initMeshletCulling(m_meshletCullingEarly, meshletCullingInit, PassStage::early, kage::kSeamlessLod);
             }
 
@@ -533,11 +916,14 @@ namespace
                 TriangleCullingInitData triangleCullingInit{};
                 triangleCullingInit.meshletPayloadBuf = m_modify2TriangleCullingEarly.cmdBufOutAlias;
                 triangleCullingInit.meshletPayloadCntBuf = m_modify2TriangleCullingEarly.indirectCmdBufOutAlias;
-                triangleCullingInit.meshDrawBuf = m_meshDrawBuf;
+                triangleCullingInit.meshDrawBuf = m_transformHierarchy.meshDrawBufOutAlias;
                 triangleCullingInit.transformBuf = m_transformBuf;
                 triangleCullingInit.vtxBuf = m_vtxBuf;
                 triangleCullingInit.meshletBuf = m_meshletBuffer;
                 triangleCullingInit.meshletDataBuf = m_meshletDataBuffer;
+                triangleCullingInit.sceneAddrBuf = m_sceneAddrBuf;
+                triangleCullingInit.triPayloadBuf = m_meshletCullingEarly.triPayloadBufOutAlias;
+                triangleCullingInit.triCountBuf = m_meshletCullingEarly.triCountBufOutAlias;
                 triangleCullingInit.pyramid = m_pyramid.image;
                 initTriangleCulling(m_triangleCullingEarly, triangleCullingInit, PassStage::early, kage::kSeamlessLod);
             }
@@ -561,17 +947,20 @@ namespace
                 initData.payloadCntBuf = m_modify2SoftRasterEarly.indirectCmdBufOutAlias;
                 initData.pyramid = m_pyramid.image;
 
-                initData.meshDrawBuf = m_meshDrawBuf;
+                initData.meshDrawBuf = m_transformHierarchy.meshDrawBufOutAlias;
+                initData.prevDrawBuf = m_transformHierarchy.prevDrawBufOutAlias;
                 initData.transformBuf = m_transformBuf;
                 initData.vtxBuf = m_vtxBuf;
                 initData.meshletBuf = m_meshletBuffer;
                 initData.meshletDataBuf = m_meshletDataBuffer;
+                initData.sceneAddrBuf = m_sceneAddrBuf;
                 
                 initData.width = m_width;
                 initData.height = m_height;
 
                 initData.color = m_color;
                 initData.depth = m_depth;
+                initData.velocity = m_gBuffer.velocity;
                 
                 initSoftRaster(m_softRasterEarly, initData, PassStage::early);
             }
@@ -595,7 +984,9 @@ namespace
                 hrInit.meshBuffer = m_meshBuf;
                 hrInit.meshletBuffer = m_meshletBuffer;
                 hrInit.meshletDataBuffer = m_meshletDataBuffer;
-                hrInit.meshDrawBuffer = m_meshDrawBuf;
+                hrInit.sceneAddrBuffer = m_sceneAddrBuf;
+                hrInit.meshDrawBuffer = m_transformHierarchy.meshDrawBufOutAlias;
+                hrInit.prevDrawBuffer = m_transformHierarchy.prevDrawBufOutAlias;
                 hrInit.transformBuffer = m_transformBuf;
 
 
@@ -603,7 +994,9 @@ namespace
                 hrInit.depth = m_softRasterEarly.depthOutAlias;
 
                 hrInit.g_buffer = m_gBuffer;
+                hrInit.g_buffer.velocity = m_softRasterEarly.velocityOutAlias;
                 hrInit.bindless = m_bindlessArray;
+                hrInit.texFeedbackBuf = m_texStreaming.feedbackBuf;
 
                 initHardRaster(m_hardRasterEarly, hrInit, PassStage::early);
             }
@@ -624,8 +1017,10 @@ namespace
                 cullingInit.pyramid = m_pyramid.imgOutAlias;
 
                 cullingInit.meshBuf = m_meshBuf;
-                cullingInit.meshDrawBuf = m_meshDrawBuf;
+                cullingInit.meshDrawBuf = m_transformHierarchy.meshDrawBufOutAlias;
                 cullingInit.transBuf = m_transformBuf;
+                cullingInit.drawCount = m_scene.drawCount;
+                cullingInit.swOcclusionVisBuf = m_swOcclusion.visBuf;
 
                 initMeshCulling(m_meshCullingLate, cullingInit, PassStage::late, RenderPipeline::mixed);
             }
@@ -649,10 +1044,13 @@ namespace
                 meshletCullingInit.meshletCmdCntBuf = m_modify2MeshletCullingLate.indirectCmdBufOutAlias;
 
                 meshletCullingInit.meshBuf = m_meshBuf;
-                meshletCullingInit.meshDrawBuf = m_meshDrawBuf;
+                meshletCullingInit.meshDrawBuf = m_transformHierarchy.meshDrawBufOutAlias;
                 meshletCullingInit.transformBuf = m_transformBuf;
                 meshletCullingInit.meshletBuf = m_meshletBuffer;
+                meshletCullingInit.meshletLodBuf = m_meshletLodBuffer;
+                meshletCullingInit.sceneAddrBuf = m_sceneAddrBuf;
                 meshletCullingInit.pyramid = m_pyramid.imgOutAlias;
+                meshletCullingInit.trivialAccept = true;
 
                 initMeshletCulling(m_meshletCullingLate, meshletCullingInit, PassStage::late, kage::kSeamlessLod);
             }
@@ -674,11 +1072,14 @@ namespace
                 triangleCullingInit.meshletPayloadBuf = m_modify2TriangleCullingLate.cmdBufOutAlias;
                 triangleCullingInit.meshletPayloadCntBuf = m_modify2TriangleCullingLate.indirectCmdBufOutAlias;
 
-                triangleCullingInit.meshDrawBuf = m_meshDrawBuf;
+                triangleCullingInit.meshDrawBuf = m_transformHierarchy.meshDrawBufOutAlias;
                 triangleCullingInit.transformBuf = m_transformBuf;
                 triangleCullingInit.vtxBuf = m_vtxBuf;
                 triangleCullingInit.meshletBuf = m_meshletBuffer;
                 triangleCullingInit.meshletDataBuf = m_meshletDataBuffer;
+                triangleCullingInit.sceneAddrBuf = m_sceneAddrBuf;
+                triangleCullingInit.triPayloadBuf = m_meshletCullingLate.triPayloadBufOutAlias;
+                triangleCullingInit.triCountBuf = m_meshletCullingLate.triCountBufOutAlias;
                 triangleCullingInit.pyramid = m_pyramid.imgOutAlias;
                 initTriangleCulling(m_triangleCullingLate, triangleCullingInit, PassStage::late, kage::kSeamlessLod);
             }
@@ -702,11 +1103,13 @@ namespace
                 initData.payloadBuf = m_modify2SoftRasterLate.cmdBufOutAlias;
                 initData.payloadCntBuf = m_modify2SoftRasterLate.indirectCmdBufOutAlias;
 
-                initData.meshDrawBuf = m_meshDrawBuf;
+                initData.meshDrawBuf = m_transformHierarchy.meshDrawBufOutAlias;
+                initData.prevDrawBuf = m_transformHierarchy.prevDrawBufOutAlias;
                 initData.transformBuf = m_transformBuf;
                 initData.vtxBuf = m_vtxBuf;
                 initData.meshletBuf = m_meshletBuffer;
                 initData.meshletDataBuf = m_meshletDataBuffer;
+                initData.sceneAddrBuf = m_sceneAddrBuf;
 
                 initData.vtxBuf = m_vtxBuf;
                 initData.width = m_width;
@@ -714,6 +1117,7 @@ namespace
 
                 initData.color = m_supportMeshShading ? m_hardRasterEarly.g_bufferOutAlias.albedo : m_softRasterEarly.colorOutAlias;
                 initData.depth = m_supportMeshShading ? m_hardRasterEarly.depthOutAlias : m_softRasterEarly.depthOutAlias;
+                initData.velocity = m_supportMeshShading ? m_hardRasterEarly.g_bufferOutAlias.velocity : m_softRasterEarly.velocityOutAlias;
 
                 initSoftRaster(m_softRasterLate, initData, PassStage::late);
             }
@@ -737,39 +1141,121 @@ namespace
                 hrInit.depth = m_softRasterLate.depthOutAlias;
                 hrInit.g_buffer = m_hardRasterEarly.g_bufferOutAlias;
                 hrInit.g_buffer.albedo = m_softRasterLate.colorOutAlias;
+                hrInit.g_buffer.velocity = m_softRasterLate.velocityOutAlias;
 
                 hrInit.vtxBuffer = m_vtxBuf;
                 hrInit.meshBuffer = m_meshBuf;
                 hrInit.meshletBuffer = m_meshletBuffer;
                 hrInit.meshletDataBuffer = m_meshletDataBuffer;
-                hrInit.meshDrawBuffer = m_meshDrawBuf;
+                hrInit.sceneAddrBuffer = m_sceneAddrBuf;
+                hrInit.meshDrawBuffer = m_transformHierarchy.meshDrawBufOutAlias;
+                hrInit.prevDrawBuffer = m_transformHierarchy.prevDrawBufOutAlias;
                 hrInit.transformBuffer = m_transformBuf;
                 hrInit.bindless = m_bindlessArray;
+                hrInit.texFeedbackBuf = m_hardRasterEarly.texFeedbackBufOutAlias;
 
                 initHardRaster(m_hardRasterLate, hrInit, PassStage::late);
             }
 
+            // light cluster
+            {
+                LightClusterInitData lcInit{};
+                lcInit.pyramid = m_pyramid.imgOutAlias;
+                lcInit.width = m_width;
+                lcInit.height = m_height;
+
+                initLightCluster(m_lightCluster, lcInit);
+            }
+
             // deferred
             {
-                initDeferredShading(m_deferred, m_hardRasterLate.g_bufferOutAlias, m_skybox.colorOutAlias, RadianceCascadesData{});
+                initDeferredShading(m_deferred, m_hardRasterLate.g_bufferOutAlias, m_hardRasterLate.depthOutAlias, m_skybox.colorOutAlias, RadianceCascadesData{}, getLightClusterData(m_lightCluster), getSkyIblData(m_skyIbl));
             }
 
-            // smaa
+            // temporal upscaling or smaa
+            kage::ImageHandle aaOut;
+            if (m_useTaa)
+            {
+                TaaInitData taaInit{};
+                taaInit.color = m_deferred.outColorAlias;
+                taaInit.depth = m_hardRasterLate.depthOutAlias;
+                taaInit.velocity = m_supportMeshShading ? m_hardRasterLate.g_bufferOutAlias.velocity : m_softRasterLate.velocityOutAlias;
+                taaInit.outWidth = m_width;
+                taaInit.outHeight = m_height;
+
+                initTaa(m_taa, taaInit);
+                aaOut = m_taa.outAlias;
+            }
+            else
             {
                 kage::ImageHandle aaDepthIn = m_hardRasterLate.depthOutAlias;
                 kage::ImageHandle aaColorIn = m_deferred.outColorAlias;
 
                 m_smaa.prepare(m_width, m_height, aaColorIn, aaDepthIn);
+                aaOut = m_smaa.m_outAliasImg;
             }
 
             // ui
             {
-                kage::ImageHandle uiColorIn = m_smaa.m_outAliasImg;
+                kage::ImageHandle uiColorIn = aaOut;
                 kage::ImageHandle uiDepthIn = m_hardRasterLate.depthOutAlias;
                 initUI(m_ui, uiColorIn, uiDepthIn, 1.3f);
             }
         }
 
+        // spin the root nodes around the y axis, the children follow through the hierarchy
+        void animateInstances(float _deltaTimeMS)
+        {
+            const quat spin = glm::angleAxis(glm::radians(_deltaTimeMS * 0.05f), vec3(0.f, 1.f, 0.f));
+
+            const uint32_t rootCount = m_transformHierarchy.levelOffsets.size() > 1 ? m_transformHierarchy.levelOffsets[1] : 0;
+            for (uint32_t ii = 0; ii < rootCount; ++ii)
+            {
+                const TransformNode& node = getNodeTransform(m_transformHierarchy, ii);
+                setNodeTransform(m_transformHierarchy, ii, node.pos, spin * node.orit, node.scale);
+            }
+        }
+
+        // the render size follows the output size and the render scale of the temporal upscaling
+        // the render size targets are resized by hand, the swapchain resize sets all attachments to the output size
+        void updateRenderSize()
+        {
+            const float scale = m_useTaa ? m_demoData.dbg_features.common.renderScale : 1.f;
+            const uint32_t rw = glm::max(1u, uint32_t(float(m_width) * scale));
+            const uint32_t rh = glm::max(1u, uint32_t(float(m_height) * scale));
+
+            if (rw == m_renderWidth && rh == m_renderHeight && m_width == m_outWidth && m_height == m_outHeight)
+            {
+                return;
+            }
+
+            m_renderWidth = rw;
+            m_renderHeight = rh;
+            m_outWidth = m_width;
+            m_outHeight = m_height;
+
+            kage::updateImage(m_color, rw, rh);
+            kage::updateImage(m_depth, rw, rh);
+
+            kage::ImageHandle gbImgs[kMaxGBufferImages];
+            const uint32_t gbCount = getGBufferImages(m_gBuffer, gbImgs);
+            for (uint32_t ii = 0; ii < gbCount; ++ii)
+            {
+                kage::updateImage(gbImgs[ii], rw, rh);
+            }
+
+            kage::updateImage(m_deferred.outColor, rw, rh);
+
+            SoftRaster* softRasters[] = { &m_softRasterEarly, &m_softRasterLate };
+            for (SoftRaster* sr : softRasters)
+            {
+                sr->width = rw;
+                sr->height = rh;
+                kage::updateImage(sr->u32depth, rw, rh);
+                kage::updateImage(sr->u32debugImg, rw, rh);
+            }
+        }
+
         void refreshData()
         {
             float znear = .1f;
@@ -795,15 +1281,30 @@ namespace
                 s_campos = cameraPos;
             }
 
-            float lodErrThreshold = (2 / s_proj[1][1]) * (1.f / float(m_height)); // 1px
+            float lodErrThreshold = (2 / s_proj[1][1]) * (1.f / float(m_renderHeight)); // 1px
+
+            // only the rendering is jittered, the culling and the velocity use the plain proj
+            const mat4 viewProj = proj * view;
+            static mat4 s_prevViewProj = viewProj;
+
+            m_jitter = vec2(0.f);
+            mat4 jitteredProj = proj;
+            if (m_useTaa)
+            {
+                m_jitter = getTaaJitter(m_taa.frameIdx, m_renderWidth, m_renderHeight, m_width, m_height);
+                jitteredProj = glm::translate(mat4(1.f), vec3(m_jitter, 0.f)) * proj;
+            }
 
             m_demoData.trans.cull_view = s_view;
             m_demoData.trans.cull_proj = s_proj;
             m_demoData.trans.cull_cameraPos = vec4(s_campos, 1.f);
 
             m_demoData.trans.view = view;
-            m_demoData.trans.proj = proj;
+            m_demoData.trans.proj = jitteredProj;
             m_demoData.trans.cameraPos = vec4(cameraPos, 1.f);
+            m_demoData.trans.prevViewProj = s_prevViewProj;
+            m_demoData.trans.jitter = vec4(m_jitter, 0.f, 0.f);
+            s_prevViewProj = viewProj;
 
             m_demoData.constants.P00 = s_proj[0][0];
             m_demoData.constants.P11 = s_proj[1][1];
@@ -813,8 +1314,8 @@ namespace
             m_demoData.constants.frustum[1] = s_fx.z;
             m_demoData.constants.frustum[2] = s_fy.y;
             m_demoData.constants.frustum[3] = s_fy.z;
-            m_demoData.constants.screenWidth = (float)m_width;
-            m_demoData.constants.screenHeight = (float)m_height;
+            m_demoData.constants.screenWidth = (float)m_renderWidth;
+            m_demoData.constants.screenHeight = (float)m_renderHeight;
             m_demoData.constants.pyramidWidth = (float)m_pyramid.width;
             m_demoData.constants.pyramidHeight = (float)m_pyramid.height;
             m_demoData.constants.lodErrorThreshold = lodErrThreshold;
@@ -850,9 +1351,26 @@ namespace
         uint32_t m_width;
         uint32_t m_height;
         uint32_t m_debug;
+
+        // temporal upscaling
+        bool m_useTaa{ false };
+        uint32_t m_renderWidth;
+        uint32_t m_renderHeight;
+        uint32_t m_outWidth;
+        uint32_t m_outHeight;
+        vec2 m_jitter{ 0.f };
         uint32_t m_reset;
         entry::MouseState m_mouseState;
 
+        // headless / fixed length runs
+        static constexpr uint32_t kHeadlessDefaultFrames = 64;
+        static constexpr uint32_t kTimingWarmupFrames = 8;
+        bool m_headless{ false };
+        uint32_t m_numFrames{ 0 }; // 0 runs until the window is closed
+        uint32_t m_frameIdx{ 0 };
+        std::string m_readbackPath;
+        std::string m_timingsPath;
+
         kage::BufferHandle m_meshBuf;
         kage::BufferHandle m_meshDrawBuf;
         kage::BufferHandle m_meshDrawCmdBuf;
@@ -862,16 +1380,30 @@ namespace
         kage::BufferHandle m_idxBuf;
         kage::BufferHandle m_vtxBuf;
         kage::BufferHandle m_meshletBuffer;
+        kage::BufferHandle m_meshletLodBuffer;
         kage::BufferHandle m_meshletDataBuffer;
         kage::BufferHandle m_transformBuf;
 
+        // static scene buffers through the device addresses
+        bool m_useSceneAddr{ false };
+        kage::BufferHandle m_sceneAddrBuf;
+
         // images
         kage::ImageHandle m_color;
         kage::ImageHandle m_depth;
         std::vector<kage::ImageHandle> m_sceneImages;
+
+        bool m_streamTextures{ false };
+        bool m_streamSimulate{ false };
+        uint32_t m_streamBudgetMB{ 256 };
+        TextureStreaming m_texStreaming{};
         kage::ImageHandle m_skybox_cube;
+        const char* m_skyCubePath{ "./data/textures/cubemap_vulkan.ktx" };
+        bool m_iblOnGpu{ false };
+        SkyIbl m_skyIbl{};
         kage::BindlessHandle m_bindlessArray;
         GBuffer m_gBuffer{};
+        GBufferLayout m_gBufferLayout{ GBufferLayout::full };
 
         // passes
         Skybox m_skybox{};
@@ -902,8 +1434,13 @@ namespace
         SoftRaster m_softRasterLate{};
 
         DeferredShading m_deferred{};
+        LightCluster m_lightCluster{};
+
+        SoftOcclusion m_swOcclusion{};
+        TransformHierarchy m_transformHierarchy{};
 
         SMAA m_smaa{};
+        Taa m_taa{};
         Pyramid m_pyramid{};
         UIRendering m_ui{};
     };
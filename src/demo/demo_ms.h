@@ -23,6 +23,8 @@
 
 #include "radiance_cascade/vkz_radiance_cascade.h"
 #include "deferred/vkz_deferred.h"
+#include "deferred/vkz_light_cluster.h"
+#include "deferred/vkz_sky_ibl.h"
 #include "radiance_cascade/vkz_rc_debug.h"
 #include "ffx_intg/brixel_intg_kage.h"
 #include "radiance_cascade/vkz_rc2d.h"
@@ -86,6 +88,53 @@ namespace
                     continue;
                 }
 
+                // compact g-buffer
+                if (strcmp(arg, "-g") == 0)
+                {
+                    m_gBufferLayout = GBufferLayout::compact;
+                    continue;
+                }
+
+                // prefilter the sky on the gpu, skip the cache and the cpu reference
+                if (strcmp(arg, "-ibl_gpu") == 0)
+                {
+                    m_iblOnGpu = true;
+                    continue;
+                }
+
+                // tiled smaa, weights only in the tiles with edges
+                if (strcmp(arg, "-smaa_tiled") == 0)
+                {
+                    m_smaaMode = SMAAMode::tiled;
+                    continue;
+                }
+
+                // the edges of the tiled smaa: -smaa_edge luma|color|depth
+                if (strcmp(arg, "-smaa_edge") == 0 && ii + 1 < _argc)
+                {
+                    const char* source = _argv[ii + 1];
+                    if (strcmp(source, "color") == 0)
+                        m_smaaEdgeSource = SMAAEdgeSource::color;
+                    else if (strcmp(source, "depth") == 0)
+                        m_smaaEdgeSource = SMAAEdgeSource::depth;
+                    else
+                        m_smaaEdgeSource = SMAAEdgeSource::luma;
+
+                    ++ii;
+                    continue;
+                }
+
+                // radiance cascades storage format: -rcf rgba8|r11g11b10|rgb9e5|rgba16f
+                if (strcmp(arg, "-rcf") == 0 && ii + 1 < _argc)
+                {
+                    RCStorageFormat format = parseRCStorageFormat(_argv[ii + 1]);
+                    if (format != RCStorageFormat::count)
+                        m_rcFormat = format;
+
+                    ++ii;
+                    continue;
+                }
+
                 if (ii > 0)
                 {
                     pathes[pathCount] = arg;
@@ -94,6 +143,8 @@ namespace
             }
             pathes.resize(pathCount);
 
+            m_rcFormat = getSupportedRCStorageFormat(m_rcFormat);
+
             initScene(pathes, forceParse, kage::kSeamlessLod);
 
             // ui data
@@ -161,6 +212,18 @@ namespace
                 brxData.tmin = brx.tmin;
                 brxData.tmax = brx.tmax;
                 brxData.followCam = brx.followCam;
+                brxData.maxBricksPerBake = brx.maxBricksPerBake;
+
+                if (brx.animateInstances)
+                {
+                    animateBrxInstances(deltaTimeMS);
+                }
+
+                if (brx.hideInstances != m_brxInstancesHidden)
+                {
+                    m_brxInstancesHidden = brx.hideInstances;
+                    toggleBrxInstances(m_brxInstancesHidden);
+                }
 
                 brxUpdate(m_brixel, brxData);
             }
@@ -170,13 +233,22 @@ namespace
             refreshData();
 
             updateSkybox(m_skybox, m_width, m_height);
+            updateSkyIbl(m_skyIbl);
 
             updateMeshCulling(m_culling, m_demoData.constants, m_scene.drawCount);
             updateMeshCulling(m_cullingLate, m_demoData.constants, m_scene.drawCount);
             updateMeshCulling(m_cullingAlpha, m_demoData.constants, m_scene.drawCount);
 
 
-            updateDeferredShading(m_deferred, m_width, m_height, m_demoData.trans.cameraPos, m_demoData.dbg_features.rc3d.totalRadius, m_demoData.dbg_features.rc3d.idx_type, m_demoData.dbg_features.rc3d);
+            updateLights();
+
+            // the probe volume may be snapped to the probe grid
+            const vec3 rcCenter = m_useRc3d 
+                ? getRadianceCascadeCenter(m_demoData.dbg_features.rc3d, m_demoData.trans.cameraPos) 
+                : vec3(m_demoData.trans.cameraPos);
+
+            const mat4 invViewProj = glm::inverse(m_demoData.trans.proj * m_demoData.trans.view);
+            updateDeferredShading(m_deferred, m_width, m_height, rcCenter, invViewProj, m_demoData.dbg_features.rc3d.totalRadius, m_demoData.dbg_features.rc3d.idx_type, m_demoData.dbg_features.rc3d);
 
             if (m_supportMeshShading)
             {
@@ -184,9 +256,9 @@ namespace
                 updateModifyIndirectCmds(m_taskSubmitLate, m_width, m_height);
                 updateModifyIndirectCmds(m_taskSubmitAlpha, m_width, m_height);
 
-                updateMeshShading(m_meshShading, m_demoData.constants);
-                updateMeshShading(m_meshShadingLate, m_demoData.constants);
-                updateMeshShading(m_meshShadingAlpha, m_demoData.constants);
+                updateMeshShading(m_meshShading, m_demoData.constants, m_demoData.dbg_features.common.wireframe);
+                updateMeshShading(m_meshShadingLate, m_demoData.constants, m_demoData.dbg_features.common.wireframe);
+                updateMeshShading(m_meshShadingAlpha, m_demoData.constants, m_demoData.dbg_features.common.wireframe);
             }
             else
             {
@@ -249,9 +321,7 @@ namespace
                 static float avgCpuTime = 0.0f;
                 avgCpuTime = avgCpuTime * 0.95f + (deltaTimeMS) * 0.05f;
                 setUIProfile("cpu(avg)", avgCpuTime, "ms");
-                static float avgGpuTime = 0.0f;
-                avgGpuTime = avgGpuTime * 0.95f + (float)kage::getGpuTime() * 0.05f;
-                setUIProfile("gpu(avg)", avgGpuTime, "ms");
+                setUIProfile("gpu(avg)", (float)kage::getGpuTimings().smoothed, "ms");
                 setUIProfile("mesh cull (E)", (float)kage::getPassTime(m_culling.pass), "ms");
                 setUIProfile("mesh draw (E)", (float)kage::getPassTime(m_meshShading.pass), "ms");
                 setUIProfile("mesh cull (L)", (float)kage::getPassTime(m_cullingLate.pass), "ms");
@@ -260,13 +330,90 @@ namespace
                 setUIProfile("mesh draw (A)", (float)kage::getPassTime(m_meshShadingAlpha.pass), "ms");
                 setUIProfile("pyramid", (float)kage::getPassTime(m_pyramid.pass), "ms");
                 setUIProfile("ui", (float)kage::getPassTime(m_ui.pass), "ms");
-                setUIProfile("smaa_luma", (float)kage::getPassTime(m_smaa.m_edgeLuma.pass), "ms");
-                setUIProfile("smaa_color", (float)kage::getPassTime(m_smaa.m_edgeColor.pass), "ms");
-                setUIProfile("smaa_depth", (float)kage::getPassTime(m_smaa.m_edgeDepth.pass), "ms");
+                if (SMAAMode::tiled == m_smaaMode)
+                {
+                    setUIProfile("smaa_edge_tiles", (float)kage::getPassTime(m_smaa.m_edgeTiles.pass), "ms");
+                }
+                else
+                {
+                    setUIProfile("smaa_luma", (float)kage::getPassTime(m_smaa.m_edgeLuma.pass), "ms");
+                    setUIProfile("smaa_color", (float)kage::getPassTime(m_smaa.m_edgeColor.pass), "ms");
+                    setUIProfile("smaa_depth", (float)kage::getPassTime(m_smaa.m_edgeDepth.pass), "ms");
+                }
                 setUIProfile("smaa_weight", (float)kage::getPassTime(m_smaa.m_weight.pass), "ms");
                 setUIProfile("smaa_blend", (float)kage::getPassTime(m_smaa.m_blend.pass), "ms");
+                setUIProfile("smaa total", (float)m_smaa.getTime(), "ms");
                 setUIProfile("skybox", (float)kage::getPassTime(m_skybox.pass), "ms");
+                if (m_skyIbl.gpuBake)
+                {
+                    setUIProfile("sky prefilter", (float)kage::getPassTime(m_skyIbl.prefilterPass), "ms");
+                    setUIProfile("sky sh", (float)kage::getPassTime(m_skyIbl.shPass), "ms");
+                }
                 setUIProfile("deferred", (float)kage::getPassTime(m_deferred.pass), "ms");
+                setUIProfile("light cluster", (float)kage::getPassTime(m_lightCluster.pass), "ms");
+                setUIProfile("lights", (uint32_t)m_lightCluster.lights.size(), "");
+                if (m_lightCluster.useCpuBuild)
+                {
+                    setUIProfile("light cluster(cpu)", m_lightCluster.cpuTime, "ms");
+                    setUIProfile("light cluster pairs", m_lightCluster.cpuLightPairs, "");
+                    setUIProfile("light cluster max", m_lightCluster.cpuMaxClusterLights, "");
+                }
+                setUIProfile("g-buffer", getGBufferBytesPerPixel(m_gBuffer.layout), "B/px");
+
+                if (m_useBrixelizer)
+                {
+                    setUIProfile("brx inst added", m_brixel.addedInsts, "");
+                    setUIProfile("brx inst updated", m_brixel.updatedInsts, "");
+                    setUIProfile("brx inst removed", m_brixel.removedInsts, "");
+                }
+
+                if (m_useRc3d)
+                {
+                    // the cost of a frame against the frames to refresh all the rays
+                    const RadianceCascadeBuild& rcb = m_radianceCascade.build;
+                    const float buildTime = (float)kage::getPassTime(rcb.pass);
+                    setUIProfile("rc build", buildTime, "ms");
+                    setUIProfile("rc merge ray", (float)kage::getPassTime(m_radianceCascade.mergeRay.pass), "ms");
+                    setUIProfile("rc merge probe", (float)kage::getPassTime(m_radianceCascade.mergeProbe.pass), "ms");
+                    setUIProfile("rc rays/frame", float(rcb.raysPerFrame) * 1e-6f, "M");
+                    setUIProfile("rc converge", rcb.convergeFrames, "frames");
+                    setUIProfile("rc converge time", float(rcb.convergeFrames) * avgCpuTime, "ms");
+                    setUIProfile("rc invalidations", rcb.invalidations, "");
+
+                    // the occupancy is only rebuilt when the volume moved
+                    const RCOccupancy& occ = m_radianceCascade.occupancy;
+                    const float voxTime = (float)kage::getPassTime(occ.voxTasks.pass) + (float)kage::getPassTime(occ.voxelize.pass);
+                    setUIProfile("rc voxelize", voxTime, "ms");
+                    setUIProfile("rc oct tree", (float)kage::getPassTime(occ.octTree.pass), "ms");
+                    setUIProfile("rc probe alloc", (float)kage::getPassTime(occ.probeAlloc.pass), "ms");
+                    setUIProfile("rc occupancy rebuilds", occ.rebuilds, "");
+                    setUIProfile("rc occupancy mem", float(occ.memorySize) / (1024.f * 1024.f), "MB");
+                    if (m_demoData.dbg_features.rc3d.sparseProbes)
+                    {
+                        setUIProfile("rc live probes", occ.liveProbes, "");
+                        setUIProfile("rc live ratio", occ.totalProbes ? float(occ.liveProbes) * 100.f / float(occ.totalProbes) : 0.f, "%");
+                    }
+
+                    // the vram of the current configuration, and the total of each format for the same sizes
+                    const float toMB = 1.f / (1024.f * 1024.f);
+                    const RCMemoryReport mem = getRadianceCascadeMemory(m_radianceCascade);
+                    setUIProfile("rc atlas mem", float(mem.cascade) * toMB, "MB");
+                    setUIProfile("rc merged ray mem", float(mem.mergedRay) * toMB, "MB");
+                    setUIProfile("rc merged probe mem", float(mem.mergedProbe) * toMB, "MB");
+                    setUIProfile("rc total mem", float(mem.total) * toMB, "MB");
+                    setUIProfile("rc texel size", getRCStorageTexelSize(rcb.format), "bytes");
+
+                    for (uint32_t ii = 0; ii < (uint32_t)RCStorageFormat::count; ++ii)
+                    {
+                        const RCStorageFormat format = RCStorageFormat(ii);
+                        const RCMemoryReport fmtMem = calcRadianceCascadeMemory(format, rcb.probeSideCount, rcb.rayGridSideCount, m_radianceCascade.mergeProbe.currLv);
+
+                        char name[64];
+                        snprintf(name, COUNTOF(name), "rc mem %s", getRCStorageFormatName(format));
+                        setUIProfile(name, float(fmtMem.total + mem.occupancy) * toMB, "MB");
+                    }
+                }
+                setUIProfile("g-buffer traffic", getGBufferTrafficMB(m_gBuffer.layout, m_width, m_height), "MB");
 
                 float triCnt = (float)(kage::getPassClipping(m_meshShading.pass)) + (float)(kage::getPassClipping(m_meshShadingLate.pass));
                 setUIProfile("tri count", triCnt, "");
@@ -279,6 +426,23 @@ namespace
             return true;
         }
 
+        void updateLights()
+        {
+            const Dbg_Common& common = m_demoData.dbg_features.common;
+
+            // the demo scenes have no lights, spread random ones over the scene
+            const uint32_t lightCount = glm::min((uint32_t)glm::max(common.lightCount, 0), m_lightCluster.maxLights);
+            if (lightCount != (uint32_t)m_lightCluster.lights.size())
+            {
+                std::vector<PunctualLight> lights;
+                generateRandomLights(lights, lightCount, m_scene.radius);
+                setLights(m_lightCluster, lights.data(), lightCount);
+            }
+
+            m_lightCluster.useCpuBuild = common.cpuLightClusters;
+            updateLightCluster(m_lightCluster, m_demoData.trans, m_demoData.constants, common.dbgPauseCullTransform);
+        }
+
         int shutdown() override
         {
             freeCameraDestroy();
@@ -411,6 +575,19 @@ namespace
                     m_meshletBuffer = kage::registBuffer("meshlet(cluster)_buffer", meshletBufferDesc, memMeshletBuf);
                 }
 
+                // meshlet lod bounds buffer, the seamless lod pipeline keeps the bounds in the clusters
+                if (kage::kSeamlessLod != 1 && !m_scene.geometry.meshletLods.empty())
+                {
+                    const kage::Memory* memMeshletLodBuf = kage::alloc((uint32_t)(m_scene.geometry.meshletLods.size() * sizeof(MeshletLodBounds)));
+                    memcpy(memMeshletLodBuf->data, m_scene.geometry.meshletLods.data(), memMeshletLodBuf->size);
+
+                    kage::BufferDesc meshletLodBufferDesc;
+                    meshletLodBufferDesc.size = memMeshletLodBuf->size;
+                    meshletLodBufferDesc.usage = kage::BufferUsageFlagBits::storage | kage::BufferUsageFlagBits::transfer_dst;
+                    meshletLodBufferDesc.memFlags = kage::MemoryPropFlagBits::device_local;
+                    m_meshletLodBuffer = kage::registBuffer("meshlet_lod_buffer", meshletLodBufferDesc, memMeshletLodBuf);
+                }
+
                 // meshlet data buffer
                 {
                     const kage::Memory* memMeshletDataBuf = kage::alloc((uint32_t)(m_scene.geometry.meshletdata.size() * sizeof(uint32_t)));
@@ -465,11 +642,11 @@ namespace
             }
 
             {
-                m_skybox_cube = loadImageFromFile("skybox_cubemap", "./data/textures/cubemap_vulkan.ktx");
+                m_skybox_cube = loadImageFromFile("skybox_cubemap", m_skyCubePath);
             }
 
             {
-                m_gBuffer = createGBuffer();
+                m_gBuffer = createGBuffer(m_gBufferLayout);
             }
         }
 
@@ -485,6 +662,7 @@ namespace
                 cullingInit.meshBuf = m_meshBuf;
                 cullingInit.meshDrawBuf = m_meshDrawBuf;
                 cullingInit.transBuf = m_transformBuf;
+                cullingInit.drawCount = m_scene.drawCount;
                 cullingInit.pyramid = m_pyramid.image;
                 cullingInit.meshDrawCmdBuf = m_meshDrawCmdBuf;
                 cullingInit.meshDrawCmdCountBuf = m_meshDrawCmdCountBuf;
@@ -498,6 +676,11 @@ namespace
                 initSkyboxPass(m_skybox, m_transformBuf, m_color, m_skybox_cube);
             }
 
+            // ambient of the sky
+            {
+                initSkyIbl(m_skyIbl, m_skybox_cube, m_skyCubePath, m_iblOnGpu);
+            }
+
             // draw early pass
             if (!m_supportMeshShading)
             {
@@ -523,6 +706,7 @@ namespace
                 msInit.vtxBuffer = m_vtxBuf;
                 msInit.meshBuffer = m_meshBuf;
                 msInit.meshletBuffer = m_meshletBuffer;
+                msInit.meshletLodBuffer = m_meshletLodBuffer;
                 msInit.meshletDataBuffer = m_meshletDataBuffer;
                 msInit.meshDrawBuffer = m_meshDrawBuf;
                 msInit.meshDrawCmdBuffer = m_taskSubmit.cmdBufOutAlias;
@@ -548,6 +732,7 @@ namespace
                 cullingInit.meshBuf = m_meshBuf;
                 cullingInit.meshDrawBuf = m_meshDrawBuf;
                 cullingInit.transBuf = m_transformBuf;
+                cullingInit.drawCount = m_scene.drawCount;
                 cullingInit.pyramid = m_pyramid.imgOutAlias;
                 cullingInit.meshDrawCmdBuf = m_supportMeshShading ? m_taskSubmit.cmdBufOutAlias : m_culling.cmdBufOutAlias;
                 cullingInit.meshDrawCmdCountBuf = m_supportMeshShading ? m_taskSubmit.indirectCmdBufOutAlias : m_culling.cmdCountBufOutAlias;
@@ -581,6 +766,7 @@ namespace
                 msInit.vtxBuffer = m_vtxBuf;
                 msInit.meshBuffer = m_meshBuf;
                 msInit.meshletBuffer = m_meshletBuffer;
+                msInit.meshletLodBuffer = m_meshletLodBuffer;
                 msInit.meshletDataBuffer = m_meshletDataBuffer;
                 msInit.meshDrawBuffer = m_meshDrawBuf;
                 msInit.meshDrawCmdBuffer = m_taskSubmitLate.cmdBufOutAlias;
@@ -603,6 +789,7 @@ namespace
                 cullingInit.meshBuf = m_meshBuf;
                 cullingInit.meshDrawBuf = m_meshDrawBuf;
                 cullingInit.transBuf = m_transformBuf;
+                cullingInit.drawCount = m_scene.drawCount;
                 cullingInit.pyramid = m_pyramid.imgOutAlias;
                 cullingInit.meshDrawCmdBuf = m_supportMeshShading ? m_taskSubmitLate.cmdBufOutAlias : m_cullingLate.cmdBufOutAlias;
                 cullingInit.meshDrawCmdCountBuf = m_supportMeshShading ? m_taskSubmitLate.indirectCmdBufOutAlias : m_cullingLate.cmdCountBufOutAlias;
@@ -623,6 +810,7 @@ namespace
                 msInit.vtxBuffer = m_vtxBuf;
                 msInit.meshBuffer = m_meshBuf;
                 msInit.meshletBuffer = m_meshletBuffer;
+                msInit.meshletLodBuffer = m_meshletLodBuffer;
                 msInit.meshletDataBuffer = m_meshletDataBuffer;
                 msInit.meshDrawBuffer = m_meshDrawBuf;
                 msInit.meshDrawCmdBuffer = m_taskSubmitAlpha.cmdBufOutAlias;
@@ -665,12 +853,18 @@ namespace
                 rcInit.depth = cascadeDepthIn;
                 rcInit.meshBuf = m_meshBuf;
                 rcInit.meshDrawBuf = m_meshDrawBuf;
-                rcInit.idxBuf = m_idxBuf;
+                rcInit.meshletBuf = m_meshletBuffer;
+                rcInit.meshletDataBuf = m_meshletDataBuffer;
                 rcInit.vtxBuf = m_vtxBuf;
                 rcInit.maxDrawCmdCount = (uint32_t)m_scene.meshDraws.size();
+                rcInit.voxTaskCapacity = getRCVoxTaskCount(m_scene, kage::kSeamlessLod == 1);
+                rcInit.seamless = kage::kSeamlessLod == 1;
                 rcInit.bindless = m_bindlessArray;
                 rcInit.skybox = m_skybox_cube;
                 rcInit.currCas = m_demoData.dbg_features.rc3d.startCascade;
+                rcInit.format = m_rcFormat;
+                rcInit.probeSideCount = getRCProbeSideCount(m_demoData.dbg_features.rc3d);
+                rcInit.rayGridSideCount = getRCRayGridSideCount(m_demoData.dbg_features.rc3d);
 
                 memcpy(&rcInit.brx, &m_brixel.userReses, sizeof(BRX_UserResources));
 
@@ -689,9 +883,17 @@ namespace
                 if (m_useRc3d) {
                     rcData.cascades = m_radianceCascade.build.radCascdOutAlias;
                     rcData.mergedCascade = m_radianceCascade.mergeProbe.mergedCascadesAlias;
+                    rcData.format = m_rcFormat;
                 }
 
-                initDeferredShading(m_deferred, m_meshShadingAlpha.g_bufferOutAlias, m_skybox.colorOutAlias, rcData);
+                LightClusterInitData lcInit{};
+                lcInit.pyramid = m_pyramid.imgOutAlias;
+                lcInit.width = m_width;
+                lcInit.height = m_height;
+                initLightCluster(m_lightCluster, lcInit);
+
+                kage::ImageHandle deferredDepthIn = m_supportMeshShading ? m_meshShadingAlpha.depthOutAlias : m_vtxShadingLate.depthOutAlias;
+                initDeferredShading(m_deferred, m_meshShadingAlpha.g_bufferOutAlias, deferredDepthIn, m_skybox.colorOutAlias, rcData, getLightClusterData(m_lightCluster), getSkyIblData(m_skyIbl));
             }
 
             // probe debug
@@ -705,6 +907,7 @@ namespace
                 vdinit.trans = m_radianceCascade.build.trans;
 
                 vdinit.cascade = m_radianceCascade.build.radCascdOutAlias;
+                vdinit.format = m_rcFormat;
 
                 prepareProbeDebug(m_probDebug, vdinit);
             }
@@ -723,7 +926,7 @@ namespace
                         : m_deferred.outColorAlias
                     : m_vtxShadingLate.colorOutAlias;
 
-                m_smaa.prepare(m_width, m_height, aaColorIn, aaDepthIn);
+                m_smaa.prepare(m_width, m_height, aaColorIn, aaDepthIn, m_smaaMode, m_smaaEdgeSource);
             }
 
             // ui
@@ -735,6 +938,36 @@ namespace
             }
         }
 
+        // spin every other draw in place, the brixelizer rebuilds the moved instances
+        void animateBrxInstances(float _deltaTimeMS)
+        {
+            const quat spin = glm::angleAxis(glm::radians(_deltaTimeMS * 0.05f), vec3(0.f, 1.f, 0.f));
+
+            for (uint32_t ii = 1; ii < m_scene.drawCount; ii += 2)
+            {
+                MeshDraw& draw = m_scene.meshDraws[ii];
+                draw.orit = glm::normalize(spin * draw.orit);
+
+                brxUpdateInstance(m_brixel, m_scene, ii);
+            }
+
+            const kage::Memory* mem = kage::alloc((uint32_t)(m_scene.meshDraws.size() * sizeof(MeshDraw)));
+            memcpy(mem->data, m_scene.meshDraws.data(), mem->size);
+            kage::updateBuffer(m_meshDrawBuf, mem);
+        }
+
+        // only the sdf loses the draws, the raster still draws them
+        void toggleBrxInstances(bool _hide)
+        {
+            for (uint32_t ii = 1; ii < m_scene.drawCount; ii += 2)
+            {
+                if (_hide)
+                    brxRemoveInstance(m_brixel, ii);
+                else
+                    brxAddInstance(m_brixel, m_scene, ii);
+            }
+        }
+
         void refreshData()
         {
             float znear = .1f;
@@ -770,6 +1003,12 @@ namespace
             m_demoData.trans.proj = proj;
             m_demoData.trans.cameraPos = vec4(cameraPos, 1.f);
 
+            // no jitter here, the velocity is only consumed by the temporal upscaling of the mixed raster demo
+            static mat4 s_prevViewProj = proj * view;
+            m_demoData.trans.prevViewProj = s_prevViewProj;
+            m_demoData.trans.jitter = vec4(0.f);
+            s_prevViewProj = proj * view;
+
             m_demoData.constants.P00 = s_proj[0][0];
             m_demoData.constants.P11 = s_proj[1][1];
             m_demoData.constants.znear = znear;
@@ -815,6 +1054,7 @@ namespace
         bool m_useRc3d;
         bool m_useBrixelizer;
         bool m_useRc2d;
+        bool m_brxInstancesHidden{ false };
 
         std::vector<kage::ImageHandle> m_sceneImages;
 
@@ -833,15 +1073,24 @@ namespace
         kage::BufferHandle m_idxBuf;
         kage::BufferHandle m_vtxBuf;
         kage::BufferHandle m_meshletBuffer;
+        kage::BufferHandle m_meshletLodBuffer;
         kage::BufferHandle m_meshletDataBuffer;
         kage::BufferHandle m_transformBuf;
 
         kage::ImageHandle m_skybox_cube;
+        const char* m_skyCubePath{ "./data/textures/cubemap_vulkan.ktx" };
+        bool m_iblOnGpu{ false };
+        SkyIbl m_skyIbl{};
 
         kage::BindlessHandle m_bindlessArray;
 
         GBuffer m_gBuffer{};
+        GBufferLayout m_gBufferLayout{ GBufferLayout::full };
+        RCStorageFormat m_rcFormat{ RCStorageFormat::rgba8 };
+        SMAAMode m_smaaMode{ SMAAMode::three_pass };
+        SMAAEdgeSource m_smaaEdgeSource{ SMAAEdgeSource::luma };
         DeferredShading m_deferred{};
+        LightCluster m_lightCluster{};
 
         // images
         kage::ImageHandle m_color;
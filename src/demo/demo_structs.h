@@ -14,6 +14,10 @@ struct alignas(16) TransformData
 
     vec4 cameraPos;
     vec4 cull_cameraPos;
+
+    // the last frame's view proj without the jitter, for the velocity
+    mat4 prevViewProj;
+    vec4 jitter; // xy: the jitter of the proj in ndc
 };
 
 struct alignas(16) DrawCull
@@ -97,14 +101,26 @@ struct Dbg_Common
     bool ocEnabled = true;
     bool meshletOcEnabled = true;
     bool taskSubmitEnabled = true;
+    bool swOcclusionEnabled = true;
+    bool animateInstances = false;
+    bool wireframe = false; // the mesh shading passes
     bool showPyramid = false;
     int  debugPyramidLevel = 0;
     float speed = 3.f;
 
+    int  lightCount = 256;
+    bool cpuLightClusters = false;
+
+    // temporal upscaling, set by the demo that supports it
+    bool taaEnabled = false;
+    float renderScale = 1.f;
+    float taaFeedback = .9f;
+
     bool dbgBrx;
     bool dbgRc3d;
     bool dbgRc2d;
     bool dbgPauseCullTransform;
+    bool dbgMemory = false;
 };
 
 struct Dbg_Brixel
@@ -115,9 +131,14 @@ struct Dbg_Brixel
     float sdfEps = 1.5f;
     float tmin = .5f;
     float tmax = 1000.f;
+    uint32_t maxBricksPerBake = 1 << 14;
 
     kage::ImageHandle presentImg;
     bool followCam = true;
+
+    // every other draw, to exercise the instance updates of the backend
+    bool animateInstances = false;
+    bool hideInstances = false;
 };
 
 struct Dbg_RadianceCascades
@@ -141,8 +162,20 @@ struct Dbg_RadianceCascades
     uint32_t startCascade = 0;
     uint32_t cascadeCount = kage::k_rclv0_cascadeLv;
 
+    // level 0 sizes, the other levels are derived from them
+    uint32_t probeSideCount = kage::k_rclv0_probeSideCount;
+    uint32_t rayGridSideCount = kage::k_rclv0_rayGridSideCount;
+
     bool followCam = true;
     bool pauseUpdate = false;
+
+    // million rays traced per frame, 0 rebuilds all the cascades every frame
+    float rayBudgetM = 0.f;
+
+    // trace only the probes near surfaces, found by the voxel occupancy
+    bool sparseProbes = false;
+    // revoxelize the moved draws and refresh the live probes every frame
+    bool dynamicOccupancy = false;
 };
 
 struct Dbg_Rc2d
@@ -194,6 +227,17 @@ enum class RenderPipeline : uint8_t
     count = 3,      // count of culling passes
 };
 
+// the slots of the scene address block, keep sync with scene_address.h
+enum class SceneAddressSlot : uint16_t
+{
+    meshes = 0,
+    meshlets = 1,       // the clusters with the seamless lod
+    meshlet_lods = 2,
+    vertices = 3,
+    meshlet_data = 4,
+    count = 5,
+};
+
 inline vec4 normalizePlane(vec4 p)
 {
     return p / glm::length(p);
@@ -165,7 +165,11 @@ namespace kage
             set_name,
 
             update_image,
+            update_image_mips,
             update_buffer,
+            update_buffer_addresses,
+
+            set_pass_variant,
 
             record,
 
@@ -306,6 +310,16 @@ namespace kage
         const Memory* m_mem;
     };
 
+    struct UpdateImageMipsCmd : public Command
+    {
+        ENTRY_IMPLEMENT_COMMAND(UpdateImageMipsCmd, Command::update_image_mips);
+        ImageHandle m_handle;
+        uint32_t m_width;
+        uint32_t m_height;
+        uint32_t m_numMips;
+        const Memory* m_mem;
+    };
+
     struct UpdateBufferCmd : public Command
     {
         ENTRY_IMPLEMENT_COMMAND(UpdateBufferCmd, Command::update_buffer);
@@ -315,6 +329,23 @@ namespace kage
         uint32_t m_size;
     };
 
+    struct SetPassVariantCmd : public Command
+    {
+        ENTRY_IMPLEMENT_COMMAND(SetPassVariantCmd, Command::set_pass_variant);
+        PassHandle m_handle;
+        GraphicsPipelineConfig m_config;
+        const Memory* m_specData;
+        bool m_bind;
+    };
+
+    struct UpdateBufferAddressesCmd : public Command
+    {
+        ENTRY_IMPLEMENT_COMMAND(UpdateBufferAddressesCmd, Command::update_buffer_addresses);
+        BufferHandle m_handle;
+        const Memory* m_srcs;
+        uint32_t m_offset;
+    };
+
     struct RecordCmd : public Command
     {
         ENTRY_IMPLEMENT_COMMAND(RecordCmd, Command::record);
@@ -682,6 +713,18 @@ namespace kage
             push(cmd);
         }
 
+        void cmdUpdateImageMips(ImageHandle _handle, uint32_t _width, uint32_t _height, uint32_t _numMips, const Memory* _mem)
+        {
+            UpdateImageMipsCmd cmd;
+            cmd.m_handle = _handle;
+            cmd.m_width = _width;
+            cmd.m_height = _height;
+            cmd.m_numMips = _numMips;
+            cmd.m_mem = _mem;
+
+            push(cmd);
+        }
+
         void cmdUpdateBuffer(BufferHandle _handle, const Memory* _mem, uint32_t _offset = 0, uint32_t _size = 0)
         {
             UpdateBufferCmd cmd;
@@ -693,6 +736,27 @@ namespace kage
             push(cmd);
         }
 
+        void cmdUpdateBufferAddresses(BufferHandle _handle, const Memory* _srcs, uint32_t _offset = 0)
+        {
+            UpdateBufferAddressesCmd cmd;
+            cmd.m_handle = _handle;
+            cmd.m_srcs = _srcs;
+            cmd.m_offset = _offset;
+
+            push(cmd);
+        }
+
+        void cmdSetPassVariant(PassHandle _handle, const GraphicsPipelineConfig& _config, const Memory* _specData, bool _bind)
+        {
+            SetPassVariantCmd cmd;
+            cmd.m_handle = _handle;
+            cmd.m_config = _config;
+            cmd.m_specData = _specData;
+            cmd.m_bind = _bind;
+
+            push(cmd);
+        }
+
         void cmdRecord(PassHandle _pass)
         {
             RecordCmd cmd;
@@ -1477,6 +1477,7 @@ namespace kage
         _bkt.desc.format = _info.format;
 
         _bkt.initialBarrierState = _info.initialState;
+        _bkt.lifetime = _info.lifetime;
         _bkt.base_hbuf = _info.hBuf;
         _bkt.reses = _reses;
         _bkt.forceAliased = _forceAliased;
@@ -1505,6 +1506,7 @@ namespace kage
 
         _bkt.aspectFlags = _info.aspectFlags;
         _bkt.initialBarrierState = _info.initialState;
+        _bkt.lifetime = _info.lifetime;
         _bkt.basse_himg = _info.hImg;
         _bkt.reses = _reses;
         _bkt.forceAliased = _forceAliased;
@@ -1760,7 +1762,7 @@ namespace kage
             info.pData = bkt.pData;
             info.resCount = (uint16_t)bkt.reses.size();
 
-
+            info.lifetime = bkt.lifetime;
             info.barrierState = bkt.initialBarrierState;
 
             bx::write(&m_rhiMemWriter, info, nullptr);
@@ -1814,6 +1816,7 @@ namespace kage
             info.resCount = (uint16_t)bkt.reses.size();
 
             info.aspectFlags = bkt.aspectFlags;
+            info.lifetime = bkt.lifetime;
             info.barrierState = bkt.initialBarrierState;
 
             bx::write(&m_rhiMemWriter, info, nullptr);
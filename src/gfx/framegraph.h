@@ -260,6 +260,7 @@ namespace kage
 
             BufferDesc      desc;
             ResInteractDesc initialBarrierState;
+            ResourceLifetime lifetime{ ResourceLifetime::transition };
 
             bool            forceAliased{ false };
             stl::vector<UnifiedResHandle> reses;
@@ -286,6 +287,7 @@ namespace kage
 
             ImageAspectFlags   aspectFlags;
             ResInteractDesc    initialBarrierState;
+            ResourceLifetime   lifetime{ ResourceLifetime::transition };
 
             bool        forceAliased{ false };
 
@@ -148,12 +148,15 @@ namespace kage
         inline bx::MemoryBlockI* memoryBlock() const {return m_pMemBlockBaked;}
         inline bx::AllocatorI* allocator() const { return m_pAllocator; }
 
-        virtual void init(const Resolution& _resolution, void* _wnd) {};
+        virtual void init(const Resolution& _resolution, void* _wnd, bool _headless) {};
 
         virtual void bake();
         virtual bool run() { return false; };
 
         virtual bool checkSupports(VulkanSupportExtension _ext) { return false; }
+        virtual bool checkSubgroupArithmeticSupports() { return false; }
+        virtual bool checkStorageImageSupports(ResourceFormat _format) { return false; }
+        virtual bool checkBufferDeviceAddressSupports() { return false; }
         virtual void updateResolution(const Resolution& _resolution) {};
 
         // update 
@@ -173,9 +176,44 @@ namespace kage
             , const Memory* _mem
         ) {};
 
+        virtual void updateImageMips(
+            const ImageHandle _hImg
+            , const uint16_t _width
+            , const uint16_t _height
+            , const uint16_t _numMips
+            , const Memory* _mem
+        ) {};
+
+        virtual void setPassVariant(
+            const PassHandle _hPass
+            , const GraphicsPipelineConfig& _config
+            , const Memory* _specData
+            , bool _bind
+        ) {};
+
+        virtual void updateBufferAddresses(
+            const BufferHandle _hBuf
+            , const Memory* _srcs
+            , const uint32_t _offset
+        ) {};
+
         virtual double getPassTime(const PassHandle _hPass) { return 0.0; }
+        virtual double getPassRecordTime(const PassHandle _hPass) { return 0.0; }
         virtual double getGPUTime() { return 0.0; }
         virtual uint64_t getPassClipping(const PassHandle _hPass) { return 0; }
+        virtual PassTimings getPassTimings(const PassHandle _hPass) { return {}; }
+        virtual PassTimings getGpuTimings() { return {}; }
+        virtual void resetPassTimings() {};
+        virtual bool dumpPassTimings(const char* _path) { return false; }
+        virtual MemoryStats getMemoryStats() { return {}; }
+        virtual uint32_t getMemoryBuckets(MemoryBucket* _out, uint32_t _max) { return 0; }
+        virtual uint32_t getMemoryPassUsage(MemoryPassUsage* _out, uint32_t _max) { return 0; }
+        virtual bool dumpMemoryTimeline(const char* _path) { return false; }
+        virtual bool readBuffer(const BufferHandle _hBuf, void* _dst, uint32_t _size, uint32_t _offset) { return false; }
+        virtual void requestReadback(const char* _path) {};
+        virtual void setLatencyMarker(LatencyMarker _marker, int64_t _time) {};
+        virtual LatencyTimings getLatencyTimings() { return {}; }
+        virtual void setShaderHotReload(bool _enable) {};
 
         void parseOp();
 
@@ -195,6 +233,7 @@ namespace kage
         // -- rendering commands ends
 
         virtual void brx_setGeoInstances(const Memory* _desc) {};
+        virtual void brx_updateGeoInstances(const Memory* _deltas) {};
         virtual void brx_regGeoBuffers(const Memory* _bufs) {};
         virtual void brx_setUserResources(const Memory* _reses) {};
         virtual void brx_setDebugInfos(const Memory* _debug) {};
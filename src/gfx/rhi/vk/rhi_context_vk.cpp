@@ -7,7 +7,12 @@
 #include "rhi_context_vk.h"
 
 #include <algorithm> //sort
+#include <sys/stat.h> // for the shader file watch
 #include "bx/hash.h"
+#include "bx/file.h"
+#include "bx/math.h" // for halfFromFloat
+#include "bx/timer.h"
+#include "bimg/bimg.h"
 #include "gfx/command_buffer.h"
 
 #include "FidelityFX/host/backends/vk/ffx_vk.h"
@@ -194,11 +199,11 @@ namespace kage { namespace vk
         s_debugNames = nullptr;
     }
 
-    RHIContext* rendererCreate(const Resolution& _resolution, void* _wnd)
+    RHIContext* rendererCreate(const Resolution& _resolution, void* _wnd, bool _headless)
     {
         s_renderVK = BX_NEW(g_bxAllocator, RHIContext_vk)(g_bxAllocator);
 
-        s_renderVK->init(_resolution, _wnd);
+        s_renderVK->init(_resolution, _wnd, _headless);
         
         return s_renderVK;
     }
@@ -296,6 +301,10 @@ namespace kage { namespace vk
         {
             usage |= VK_BUFFER_USAGE_STORAGE_TEXEL_BUFFER_BIT;
         }
+        if (_usageFlags & BufferUsageFlagBits::device_address)
+        {
+            usage |= VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+        }
 
         return usage;
     }
@@ -1322,42 +1331,6 @@ namespace kage { namespace vk
         return "UNDEFINED";
     }
 
-    bool getVertexInputState(VkPipelineVertexInputStateCreateInfo& _out, const stl::vector<VertexBindingDesc>& _bindings, const stl::vector<VertexAttributeDesc>& _attributes)
-    {
-        if (_bindings.empty() && _attributes.empty())
-        {
-            return false;
-        }
-
-        stl::vector<VkVertexInputBindingDescription> bindings(_bindings.size());
-        for (uint32_t ii = 0; ii < _bindings.size(); ++ ii)
-        {
-            const VertexBindingDesc& bind = _bindings[ii];
-            bindings[ii] = { bind.binding, bind.stride, getInputRate(bind.inputRate) };
-        }
-
-        stl::vector<VkVertexInputAttributeDescription> attributes(_attributes.size());
-        for (uint32_t ii = 0; ii < _attributes.size(); ++ii)
-        {
-            const VertexAttributeDesc& attr = _attributes[ii];
-            attributes[ii] = { attr.location, attr.binding, getFormat(attr.format), attr.offset };
-        }
-
-        const kage::Memory* vtxBindingMem = kage::alloc(uint32_t(sizeof(VkVertexInputBindingDescription) * bindings.size()));
-        memcpy(vtxBindingMem->data, bindings.data(), sizeof(VkVertexInputBindingDescription) * bindings.size());
-
-        const kage::Memory* vtxAttributeMem = kage::alloc(uint32_t(sizeof(VkVertexInputAttributeDescription) * attributes.size()));
-        memcpy(vtxAttributeMem->data, attributes.data(), sizeof(VkVertexInputAttributeDescription) * attributes.size());
-
-        _out.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-        _out.vertexBindingDescriptionCount = (uint32_t)bindings.size();
-        _out.pVertexBindingDescriptions = (VkVertexInputBindingDescription*)vtxBindingMem->data;
-        _out.vertexAttributeDescriptionCount = (uint32_t)attributes.size();
-        _out.pVertexAttributeDescriptions = (VkVertexInputAttributeDescription*)vtxAttributeMem->data;
-
-        return true;
-    }
-
     void enumrateDeviceExtPorps(VkPhysicalDevice physicalDevice, stl::vector<VkExtensionProperties>& availableExtensions)
     {
         uint32_t extensionCount = 0;
@@ -1403,6 +1376,36 @@ namespace kage { namespace vk
         return props;
     }
 
+    // the clock of bx::getHPCounter
+#if BX_PLATFORM_WINDOWS
+    constexpr VkTimeDomainEXT kHostTimeDomain = VK_TIME_DOMAIN_QUERY_PERFORMANCE_COUNTER_EXT;
+#else
+    constexpr VkTimeDomainEXT kHostTimeDomain = VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT;
+#endif // BX_PLATFORM_WINDOWS
+
+    bool supportsHostTimeDomain(VkPhysicalDevice _physicalDevice)
+    {
+        if (nullptr == vkGetPhysicalDeviceCalibrateableTimeDomainsEXT)
+        {
+            return false;
+        }
+
+        uint32_t count = 0;
+        vkGetPhysicalDeviceCalibrateableTimeDomainsEXT(_physicalDevice, &count, nullptr);
+        stl::vector<VkTimeDomainEXT> domains(count);
+        vkGetPhysicalDeviceCalibrateableTimeDomainsEXT(_physicalDevice, &count, domains.data());
+
+        bool device = false;
+        bool host = false;
+        for (const VkTimeDomainEXT domain : domains)
+        {
+            device |= (VK_TIME_DOMAIN_DEVICE_EXT == domain);
+            host |= (kHostTimeDomain == domain);
+        }
+
+        return device && host;
+    }
+
     VkQueryPool createQueryPool(VkDevice device, uint32_t queryCount, VkQueryType queryType)
     {
         VkQueryPoolCreateInfo createInfo = { VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO };
@@ -1506,25 +1509,28 @@ namespace kage { namespace vk
         shutdown();
     }
 
-    void RHIContext_vk::init(const Resolution& _resolution, void* _wnd)
+    void RHIContext_vk::init(const Resolution& _resolution, void* _wnd, bool _headless)
     {
         KG_ZoneScopedC(Color::indian_red);
 
         VK_CHECK(volkInitialize());
 
-        this->createInstance();
+        this->createInstance(_headless);
 
         if (BX_ENABLED(KAGE_DEBUG))
         {
             m_debugCallback = registerDebugCallback(m_instance);
         }
 
-        createPhysicalDevice();
+        createPhysicalDevice(_headless);
 
         stl::vector<VkExtensionProperties> supportedExtensions;
         enumrateDeviceExtPorps(m_physicalDevice, supportedExtensions);
 
         m_supportMeshShading = checkExtSupportness(supportedExtensions, VK_EXT_MESH_SHADER_EXTENSION_NAME, false);
+        m_supportBufferMarker = checkExtSupportness(supportedExtensions, VK_AMD_BUFFER_MARKER_EXTENSION_NAME, false);
+        m_supportCalibratedTimestamps = checkExtSupportness(supportedExtensions, VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME, false)
+            && supportsHostTimeDomain(m_physicalDevice);
 
         vkGetPhysicalDeviceProperties(m_physicalDevice, &m_phyDeviceProps);
         assert(m_phyDeviceProps.limits.timestampPeriod);
@@ -1532,7 +1538,9 @@ namespace kage { namespace vk
         m_gfxFamilyIdx = getGraphicsFamilyIndex(m_physicalDevice);
         assert(m_gfxFamilyIdx != VK_QUEUE_FAMILY_IGNORED);
 
-        m_device = kage::vk::createDevice(m_instance, m_physicalDevice, m_gfxFamilyIdx, m_supportMeshShading);
+        const uint32_t transferFamilyIdx = getTransferFamilyIndex(m_physicalDevice);
+
+        m_device = kage::vk::createDevice(m_instance, m_physicalDevice, m_gfxFamilyIdx, transferFamilyIdx, m_supportMeshShading, m_supportBufferMarker, m_supportCalibratedTimestamps, _headless);
         assert(m_device);
         
         // only single device used in this application.
@@ -1540,7 +1548,10 @@ namespace kage { namespace vk
 
         m_nwh = _wnd;
 
-        m_swapchain.create(m_nwh, _resolution);
+        // the offscreen image of the headless mode allocates from it
+        vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &m_memProps);
+
+        m_swapchain.create(m_nwh, _resolution, _headless);
 
         m_swapchainFormat = m_swapchain.getSwapchainFormat();
         m_depthFormat = VK_FORMAT_D32_SFLOAT;
@@ -1566,10 +1577,28 @@ namespace kage { namespace vk
         m_descPool =  createDescriptorPool(m_device);
         assert(m_descPool);
 
+        // one timestamp at the end of each frame in flight
+        if (m_supportCalibratedTimestamps)
+        {
+            m_latencyQueryPool = createQueryPool(m_device, kMaxNumFrameLatency, VK_QUERY_TYPE_TIMESTAMP);
+
+            uint32_t familyCount = 0;
+            vkGetPhysicalDeviceQueueFamilyProperties(m_physicalDevice, &familyCount, nullptr);
+            stl::vector<VkQueueFamilyProperties> familyProps(familyCount);
+            vkGetPhysicalDeviceQueueFamilyProperties(m_physicalDevice, &familyCount, familyProps.data());
+            m_timestampValidBits = familyProps[m_gfxFamilyIdx].timestampValidBits;
+        }
+
+        // shared by all pipelines, internally synchronized for the compile jobs
+        {
+            VkPipelineCacheCreateInfo pci = { VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO };
+            VK_CHECK(vkCreatePipelineCache(m_device, &pci, nullptr, &m_pipelineCache));
+        }
+
         {
             m_numFramesInFlight = _resolution.maxFrameLatency == 0
                 ? kMaxNumFrameLatency
-                : _resolution.maxFrameLatency
+                : bx::min<uint32_t>(_resolution.maxFrameLatency, kMaxNumFrameLatency)
                 ;
 
             m_cmd.init(m_gfxFamilyIdx, m_queue, m_numFramesInFlight);
@@ -1577,7 +1606,15 @@ namespace kage { namespace vk
             m_cmd.alloc(&m_cmdBuffer);
         }
 
-        vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &m_memProps);
+        // the initial data goes through the graphics queue without a dedicated transfer family
+        if (VK_QUEUE_FAMILY_IGNORED != transferFamilyIdx)
+        {
+            VkQueue transferQueue = VK_NULL_HANDLE;
+            vkGetDeviceQueue(m_device, transferFamilyIdx, 0, &transferQueue);
+            assert(transferQueue);
+
+            m_upload.init(transferFamilyIdx, transferQueue);
+        }
 
         for (uint32_t ii = 0; ii < m_numFramesInFlight; ++ii)
         {
@@ -1599,6 +1636,10 @@ namespace kage { namespace vk
         RHIContext::bake();
 
         m_cmd.createQueryPools((uint32_t)m_passContainer.size());
+
+        m_breadcrumbs.create((uint32_t)m_passContainer.size(), m_supportBufferMarker);
+
+        m_memTelemetryDirty = true;
     }
 
     bool RHIContext_vk::run()
@@ -1627,11 +1668,20 @@ namespace kage { namespace vk
             return false;
         }
 
+        checkShaderReload();
+        updatePipelineVariants();
+
+        // the swaps of this frame are already recorded
+        m_imageSwapWaited = false;
+
         if (!m_swapchain.acquire(m_cmdBuffer))
         {
             return true;
         }
 
+        // the frames done while the cpu was busy, before this one is recorded
+        pollLatencyFrames();
+
         VkCommandBufferBeginInfo beginInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
         beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
@@ -1646,6 +1696,16 @@ namespace kage { namespace vk
             vkCmdResetQueryPool(m_cmdBuffer, m_cmd.m_currTimestampQueryPool, 0, m_cmd.m_timestampQueryPoolCount);
 
             vkCmdWriteTimestamp(m_cmdBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_cmd.m_currTimestampQueryPool, 0);
+
+            if (m_latencyQueryPool)
+            {
+                vkCmdResetQueryPool(m_cmdBuffer, m_latencyQueryPool, m_cmd.m_currentFrameInFlight, 1);
+            }
+
+            // the submit of this frame is the next one
+            m_breadcrumbs.begin(m_cmd.m_currentFrameInFlight, m_cmd.m_submitted + 1);
+
+            const double toMs = 1000.0 / double(bx::getHPFrequency());
             
             // render passes
             for (size_t ii = 0; ii < m_passContainer.size(); ++ii)
@@ -1656,8 +1716,16 @@ namespace kage { namespace vk
                 KG_VkZoneTransient(m_tracyVkCtx, var, m_cmdBuffer, pn);
                 message(info, "==== start pass : %s", pn);
 
+                VkDebugUtilsLabelEXT label = { VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT };
+                label.pLabelName = pn;
+                vkCmdBeginDebugUtilsLabelEXT(m_cmdBuffer, &label);
+
+                m_breadcrumbs.mark(m_cmdBuffer, (uint32_t)ii, false);
+
                 vkCmdBeginQuery(m_cmdBuffer, m_cmd.m_currStatisticsQueryPool, (uint32_t)ii, 0);
 
+                const int64_t recStart = bx::getHPCounter();
+
                 createBarriers(passId);
 
                 executePass(passId);
@@ -1665,26 +1733,74 @@ namespace kage { namespace vk
                 // will dispatch barriers internally
                 flushWriteBarriers(passId);
 
+                m_passRecordTime[passId] = double(bx::getHPCounter() - recStart) * toMs;
+
                 vkCmdEndQuery(m_cmdBuffer, m_cmd.m_currStatisticsQueryPool, (uint32_t)ii);
 
                 // write time stamp
                 vkCmdWriteTimestamp(m_cmdBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_cmd.m_currTimestampQueryPool, (uint32_t)(ii + 1));
+
+                m_breadcrumbs.mark(m_cmdBuffer, (uint32_t)ii, true);
+
+                vkCmdEndDebugUtilsLabelEXT(m_cmdBuffer);
                 message(info, "==== end pass : %s", pn);
             }
 
             // to swapchain
             drawToSwapchain(m_swapchain.m_swapchainImageIndex);
+
+            if (m_readbackRequested)
+            {
+                recordReadback(m_swapchain.m_swapchainImageIndex);
+            }
+
+            // the gpu done of the latency
+            if (m_latencyQueryPool)
+            {
+                vkCmdWriteTimestamp(m_cmdBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_latencyQueryPool, m_cmd.m_currentFrameInFlight);
+            }
         }
 
-        m_cmd.addWaitSemaphore(m_swapchain.m_prevAcquiredSemaphore, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
-        m_cmd.addSignalSemaphore(m_swapchain.m_prevRenderedSemaphore);
+        m_cmd.markQueriesIssued();
+
+        LatencyFrame& latency = m_latencyFrames[m_cmd.m_currentFrameInFlight];
+        latency.input = m_latencyMarkers[(uint32_t)LatencyMarker::input_sample];
+        latency.simulationEnd = m_latencyMarkers[(uint32_t)LatencyMarker::simulation_end];
+        latency.submit = bx::getHPCounter();
+        latency.pending = 0 != latency.input;
+        bx::memSet(m_latencyMarkers, 0, sizeof(m_latencyMarkers));
+
+        // headless has no semaphore to wait or signal
+        if (VK_NULL_HANDLE != m_swapchain.m_prevAcquiredSemaphore)
+        {
+            m_cmd.addWaitSemaphore(m_swapchain.m_prevAcquiredSemaphore, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+            m_cmd.addSignalSemaphore(m_swapchain.m_prevRenderedSemaphore);
+        }
 
         m_swapchain.m_prevAcquiredSemaphore = VK_NULL_HANDLE;
 
-        m_cmd.kick(); // end and dispatch the command buffer
+        submitUploads();
+
+        m_cmd.kick(m_readbackRequested); // end and dispatch the command buffer, wait for it if the readback is needed
+
+        m_lastStagingBytes = m_frameStagingBytes;
+        m_frameStagingBytes = 0;
+
         m_cmd.alloc(&m_cmdBuffer); // alloc a new command buffer, and wait for fence of previous frame
-        fillQueryResults(m_cmd.m_statistics, m_cmd.m_timestamps);
+        pollLatencyFrames();
+        if (m_cmd.m_queryResultsReady)
+        {
+            fillQueryResults(m_cmd.m_statistics, m_cmd.m_timestamps);
+        }
         m_swapchain.present();
+        latency.present = bx::getHPCounter();
+
+        pollLatencyFrames();
+
+        if (m_readbackRequested)
+        {
+            writeReadback();
+        }
 
         m_cmd.finish();
 
@@ -1693,11 +1809,85 @@ namespace kage { namespace vk
 
     void RHIContext_vk::kick(bool _finishAll /*= false*/)
     {
+        submitUploads();
+
         m_cmd.kick(_finishAll);
         m_cmd.alloc(&m_cmdBuffer);
         m_cmd.finish(_finishAll);
     }
 
+    void RHIContext_vk::submitUploads()
+    {
+        if (!m_upload.isValid())
+        {
+            return;
+        }
+
+        // ahead of the frame, so the wait is never before the signal
+        m_upload.flush();
+
+        uint64_t value = 0;
+        VkPipelineStageFlags stages = 0;
+        if (m_barrierDispatcher.takeUploadWait(value, stages))
+        {
+            m_cmd.addWaitSemaphore(m_upload.m_timeline, stages, value);
+        }
+    }
+
+    void RHIContext_vk::checkDeviceLost(VkResult _result)
+    {
+        if (VK_ERROR_DEVICE_LOST != _result || m_deviceLost)
+        {
+            return;
+        }
+
+        m_deviceLost = true;
+
+        message(DebugMsgType::error, "device lost after %llu submits", (unsigned long long)m_cmd.m_submitted);
+
+        if (!m_breadcrumbs.isValid())
+        {
+            return;
+        }
+
+        // the unfinished frames only, the oldest first
+        for (uint32_t ff = 0; ff < m_numFramesInFlight; ++ff)
+        {
+            const uint32_t frame = (m_cmd.m_currentFrameInFlight + ff) % m_numFramesInFlight;
+            const uint32_t serial = m_breadcrumbs.m_serials[frame];
+            if (0 == serial)
+            {
+                continue;
+            }
+
+            int32_t lastFinished = -1;
+            bool running = false;
+            for (uint32_t ii = 0; ii < m_breadcrumbs.m_passCount && ii < m_passContainer.size(); ++ii)
+            {
+                const PassHandle pass = { m_passContainer.getIdAt(ii) };
+                const Breadcrumbs_vk::State state = m_breadcrumbs.getState(frame, ii);
+
+                if (Breadcrumbs_vk::State::running == state)
+                {
+                    message(DebugMsgType::error, "\tframe %u: pass \"%s\" started and never finished", serial, getName(pass));
+                    running = true;
+                }
+                else if (Breadcrumbs_vk::State::finished == state)
+                {
+                    lastFinished = (int32_t)ii;
+                }
+            }
+
+            if (!running && lastFinished >= 0 && uint32_t(lastFinished + 1) < m_breadcrumbs.m_passCount)
+            {
+                message(DebugMsgType::error, "\tframe %u: stopped after pass \"%s\""
+                    , serial
+                    , getName(PassHandle{ m_passContainer.getIdAt(lastFinished) })
+                );
+            }
+        }
+    }
+
     void RHIContext_vk::shutdown()
     {
         KG_ZoneScopedC(Color::indian_red);
@@ -1708,6 +1898,9 @@ namespace kage { namespace vk
         }
 
         vkDeviceWaitIdle(m_device);
+        flushPipelineVariants();
+
+        m_upload.shutdown();
 
         // shut brixelizer
         brx::shutdown(m_brx);
@@ -1721,6 +1914,14 @@ namespace kage { namespace vk
 
         m_swapchain.destroy();
 
+        if (m_readbackBuf.buffer)
+        {
+            destroyBuffer({ m_readbackBuf });
+            m_readbackBuf = {};
+        }
+
+        m_breadcrumbs.destroy();
+
         for (uint32_t ii = 0; ii < m_bindlessContainer.size(); ++ii)
         {
             Bindless_vk& bindless = m_bindlessContainer.getDataRef(m_bindlessContainer.getIdAt(ii));
@@ -1797,20 +1998,26 @@ namespace kage { namespace vk
             }
         }
 
-        // render pass
-        for (uint32_t ii = 0; ii < m_passContainer.size(); ++ii)
+        // render pass, the pipelines are owned by the variants
+        for (auto it = m_pipelineVariants.begin(); it != m_pipelineVariants.end(); ++it)
         {
-            uint16_t passId = m_passContainer.getIdAt(ii);
-            PassInfo_vk& pass = m_passContainer.getDataRef(passId);
-
-            if (m_device && pass.pipeline)
+            PipelineVariant_vk& variant = it->second;
+            if (variant.pipeline)
             {
-                vkDestroyPipeline(m_device, pass.pipeline, nullptr);
-                pass.pipeline = VK_NULL_HANDLE;
+                vkDestroyPipeline(m_device, variant.pipeline, nullptr);
+                variant.pipeline = VK_NULL_HANDLE;
             }
         }
+        m_pipelineVariants.clear();
+        m_variantWaitingPasses.clear();
         m_passContainer.clear();
 
+        if (m_pipelineCache)
+        {
+            vkDestroyPipelineCache(m_device, m_pipelineCache, nullptr);
+            m_pipelineCache = VK_NULL_HANDLE;
+        }
+
         // shader
         for (uint32_t ii = 0; ii < m_shaderContainer.size(); ++ii)
         {
@@ -1842,6 +2049,12 @@ namespace kage { namespace vk
             m_descPool = VK_NULL_HANDLE;
         }
 
+        if (m_latencyQueryPool)
+        {
+            vkDestroyQueryPool(m_device, m_latencyQueryPool, 0);
+            m_latencyQueryPool = VK_NULL_HANDLE;
+        }
+
         if (m_device)
         {
             vkDestroyDevice(m_device, 0);
@@ -1856,11 +2069,16 @@ namespace kage { namespace vk
 
         // descriptor set layout
         m_bufferCreateInfos.clear();
+        m_readOnlyBuffers.clear();
         m_imgCreateInfos.clear();
 
         m_programShaderIds.clear();
         m_progThreadCount.clear();
 
+        m_shaderFiles.clear();
+        m_programCreateInfos.clear();
+        m_passPipelineDescs.clear();
+
         m_aliasToBaseBuffers.clear();
         m_aliasToBaseImages.clear();
     }
@@ -1884,144 +2102,831 @@ namespace kage { namespace vk
             double timeEnd = double(_timestamps[ii + 1]) * m_phyDeviceProps.limits.timestampPeriod * 1e-6;
 
             m_passTime.insert({ passId, timeEnd - timeStart });
+            accumulatePassTime(m_passTimeStats[passId], timeEnd - timeStart);
+            pushPassTime(m_passTimeHistory[passId], timeEnd - timeStart);
         }
         double gpuTimeStart = double(_timestamps[0]) * m_phyDeviceProps.limits.timestampPeriod * 1e-6;
         double gpuTimeEnd = double(_timestamps.back()) * m_phyDeviceProps.limits.timestampPeriod * 1e-6;
         m_gpuTime = gpuTimeEnd - gpuTimeStart;
+        accumulatePassTime(m_gpuTimeStat, m_gpuTime);
+        pushPassTime(m_gpuTimeHistory, m_gpuTime);
     }
 
-    bool RHIContext_vk::checkSupports(VulkanSupportExtension _ext)
+    void RHIContext_vk::accumulatePassTime(PassTimeStat& _stat, double _time)
     {
-        KG_ZoneScopedC(Color::indian_red);
-        const char* extName = getExtName(_ext);
-        stl::vector<VkExtensionProperties> supportedExtensions;
-        enumrateDeviceExtPorps(m_physicalDevice, supportedExtensions);
-
-        return checkExtSupportness(supportedExtensions, extName);
+        _stat.sum += _time;
+        _stat.min = _stat.count > 0 ? glm::min(_stat.min, _time) : _time;
+        _stat.max = _stat.count > 0 ? glm::max(_stat.max, _time) : _time;
+        _stat.count++;
     }
 
-    void RHIContext_vk::updateResolution(const Resolution& _resolution)
+    void RHIContext_vk::pushPassTime(PassTimeHistory& _history, double _time)
     {
-        KG_ZoneScopedC(Color::indian_red);
-        if (_resolution.width != m_resolution.width
-            || _resolution.height != m_resolution.height
-            || _resolution.reset != m_resolution.reset
-            || m_swapchain.m_shouldRecreateSwapchain
-            )
-        {
-            // untrack old swapchain images
-            for (uint32_t ii = 0; ii < m_swapchain.m_swapchainImageCount; ++ii)
-            {
-                unsetLocalDebugName(m_swapchain.m_swapchainImages[ii]);
-                m_barrierDispatcher.untrack(m_swapchain.m_swapchainImages[ii]);
-            }
+        constexpr double kSmoothing = 0.05;
 
-            m_swapchain.update(m_nwh, _resolution);
+        _history.smoothed = _history.count > 0 
+            ? _history.smoothed * (1.0 - kSmoothing) + _time * kSmoothing
+            : _time;
+        _history.last = _time;
 
-            // track new images
-            for (uint32_t ii = 0; ii < m_swapchain.m_swapchainImageCount; ++ii)
-            {
-                VkImage scimg = m_swapchain.m_swapchainImages[ii];
-                setDebugObjName(m_device, scimg, "Img_Swapchain_%d", ii);
+        _history.samples[_history.next] = float(_time);
+        _history.next = (_history.next + 1) % kPassTimeHistorySize;
+        _history.count = glm::min(_history.count + 1, kPassTimeHistorySize);
+    }
 
-                m_barrierDispatcher.track(
-                    m_swapchain.m_swapchainImages[ii]
-                    , VK_IMAGE_ASPECT_COLOR_BIT
-                    , { 0, VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT }
-                );
-            }
+    PassTimings RHIContext_vk::getTimings(const PassTimeHistory& _history) const
+    {
+        PassTimings result{};
+        result.last = _history.last;
+        result.smoothed = _history.smoothed;
+        result.numSamples = _history.count;
 
-            // update attachments
-            for (const kage::ImageHandle & hImg : m_colorAttchBase)
-            {
-                updateImage(hImg, _resolution.width, _resolution.height, 1, nullptr);
-            }
+        if (0 == _history.count)
+        {
+            return result;
+        }
 
-            for (const kage::ImageHandle & hImg : m_depthAttchBase)
-            {
-                updateImage(hImg, _resolution.width, _resolution.height, 1, nullptr);
-            }
+        float sorted[kPassTimeHistorySize];
+        bx::memCopy(sorted, _history.samples, sizeof(float) * _history.count);
+        std::sort(sorted, sorted + _history.count);
 
-            m_resolution = _resolution;
-            message(info,
-                "update m_resolution: width: %d, height: %d, reset: %016x"
-                , m_resolution.width
-                , m_resolution.height
-                , m_resolution.reset
-            );
+        // nearest rank
+        auto percentile = [&](double _p) {
+            uint32_t rank = (uint32_t)glm::ceil(_p * double(_history.count));
+            return double(sorted[glm::clamp(rank, 1u, _history.count) - 1]);
+        };
 
-            m_updated = true;
+        result.p50 = percentile(0.50);
+        result.p95 = percentile(0.95);
+        result.p99 = percentile(0.99);
+
+        return result;
+    }
+
+    PassTimings RHIContext_vk::getPassTimings(const PassHandle _hPass)
+    {
+        auto it = m_passTimeHistory.find(_hPass.id);
+        if (m_passTimeHistory.end() == it)
+        {
+            return {};
         }
+        return getTimings(it->second);
     }
 
-    void RHIContext_vk::updateBuffer(
-        const BufferHandle _hBuf
-        , const Memory* _mem
-        , const uint32_t _offset
-        , const uint32_t _size
-    )
+    PassTimings RHIContext_vk::getGpuTimings()
     {
-        KG_ZoneScopedC(Color::indian_red);
-        const char* bufName = getName(_hBuf);
-        KG_ZoneName(bufName, strlen(bufName));
+        return getTimings(m_gpuTimeHistory);
+    }
 
-        if (!m_bufferContainer.exist(_hBuf))
+    void RHIContext_vk::resetPassTimings()
+    {
+        m_passTimeStats.clear();
+        m_gpuTimeStat = {};
+    }
+
+    bool RHIContext_vk::dumpPassTimings(const char* _path)
+    {
+        FILE* file = fopen(_path, "w");
+        if (!file)
         {
-            message(info, "updateBuffer will not perform for buffer %d! It might be useless after render pass sorted", _hBuf.id);
-            return;
+            message(error, "failed to open %s for the pass timings", _path);
+            return false;
         }
 
-        const Buffer_vk& buf = m_bufferContainer.getIdToData(_hBuf);
-        BufferHandle hbase = m_aliasToBaseBuffers.getIdToData(_hBuf);
-        const Buffer_vk& baseBuf = m_bufferContainer.getIdToData(hbase);
+        auto avg = [](const PassTimeStat& _stat) {
+            return _stat.count > 0 ? _stat.sum / double(_stat.count) : 0.0;
+        };
 
-        const BufferCreateInfo& createInfo = m_bufferCreateInfos.getDataRef(hbase);
+        fprintf(file, "{\n");
+        fprintf(file, "  \"frames\": %u,\n", m_gpuTimeStat.count);
+        const PassTimings gpuTimings = getGpuTimings();
+        fprintf(file, "  \"gpu\": { \"avg_ms\": %.4f, \"min_ms\": %.4f, \"max_ms\": %.4f, \"p50_ms\": %.4f, \"p95_ms\": %.4f, \"p99_ms\": %.4f },\n"
+            , avg(m_gpuTimeStat), m_gpuTimeStat.min, m_gpuTimeStat.max
+            , gpuTimings.p50, gpuTimings.p95, gpuTimings.p99);
+        fprintf(file, "  \"passes\": [\n");
 
-        // re-create buffer if new size is larger than the old one
-        if (buf.size != _size && baseBuf.size < (_offset + _size))
+        // in the execution order
+        for (uint32_t ii = 0; ii < m_passContainer.size(); ++ii)
         {
-            m_barrierDispatcher.untrack(buf.buffer);
-
-            Buffer_vk& bufToRelease = m_bufferContainer.getDataRef(_hBuf);
-            release(bufToRelease.buffer);
-            release(bufToRelease.memory);
+            uint16_t passId = m_passContainer.getIdAt(ii);
 
-            // recreate buffer
-            BufferAliasInfo info{};
-            info.size = _size;
-            info.hbuf = _hBuf;
+            PassTimeStat stat{};
+            auto it = m_passTimeStats.find(passId);
+            if (m_passTimeStats.end() != it)
+            {
+                stat = it->second;
+            }
 
-            Buffer_vk newBuf = kage::vk::createBuffer(
-                info
-                , getBufferUsageFlags(createInfo.usage)
-                , getMemPropFlags(createInfo.memFlags)
-                , getFormat(createInfo.format)
-            );
-            m_bufferContainer.update(_hBuf, newBuf);
+            const PassTimings timings = getPassTimings(PassHandle{ passId });
 
-            ResInteractDesc interact{ createInfo.barrierState };
-            m_barrierDispatcher.track(
-                newBuf.buffer
-                , { getAccessFlags(interact.access), getPipelineStageFlags(interact.stage) }
-                , newBuf.buffer
-            );
+            fprintf(file, "    { \"name\": \"%s\", \"avg_ms\": %.4f, \"min_ms\": %.4f, \"max_ms\": %.4f, \"p50_ms\": %.4f, \"p95_ms\": %.4f, \"p99_ms\": %.4f }%s\n"
+                , getName(PassHandle{ passId }), avg(stat), stat.min, stat.max
+                , timings.p50, timings.p95, timings.p99
+                , (ii + 1 < m_passContainer.size()) ? "," : "");
         }
 
-        const Buffer_vk& newBuf = m_bufferContainer.getIdToData(_hBuf);
+        fprintf(file, "  ]\n");
+        fprintf(file, "}\n");
 
-        if (_mem){
-            uploadBuffer(_hBuf, _mem->data, _mem->size, _offset);
-        }
+        fclose(file);
 
-        // flush host visble but not coherented buf
-        if (    0 == (createInfo.memFlags & MemoryPropFlagBits::host_coherent)
-            &&  0 != (createInfo.memFlags & MemoryPropFlagBits::host_visible)
+        return true;
+    }
+
+    void RHIContext_vk::collectMemoryTelemetry(MemoryTelemetry& _out) const
+    {
+        KG_ZoneScopedC(Color::indian_red);
+
+        _out = {};
+
+        MemoryStats& stats = _out.stats;
+        const uint16_t passCount = (uint16_t)m_passContainer.size();
+
+        // the resource index of each handle
+        stl::unordered_map<uint16_t, uint32_t> bufToRes;
+        stl::unordered_map<uint16_t, uint32_t> imgToRes;
+
+        // the buckets, one per base
+        for (uint32_t ii = 0; ii < m_bufferCreateInfos.size(); ++ii)
+        {
+            const BufferHandle base = m_bufferCreateInfos.getIdAt(ii);
+            const BufferCreateInfo& info = m_bufferCreateInfos.getDataAt(ii);
+            if (!m_bufferContainer.exist(base))
+            {
+                continue;
+            }
+
+            VkMemoryRequirements req;
+            vkGetBufferMemoryRequirements(m_device, getBuffer(base, false).buffer, &req);
+
+            MemoryBucket bucket{};
+            bucket.name = getName(base);
+            bucket.isImage = false;
+            bucket.transient = ResourceLifetime::transition == info.lifetime
+                && nullptr == info.pData
+                && 0 == (info.usage & BufferUsageFlagBits::read_only)
+                ;
+            bucket.allocatedBytes = req.size;
+
+            bufToRes.insert({ base.id, (uint32_t)_out.resources.size() });
+            _out.resources.push_back({ bucket.name, req.size, (uint32_t)_out.buckets.size() });
+            _out.buckets.push_back(bucket);
+        }
+
+        for (uint32_t ii = 0; ii < m_imgCreateInfos.size(); ++ii)
+        {
+            const ImageHandle base = m_imgCreateInfos.getIdAt(ii);
+            const ImageCreateInfo& info = m_imgCreateInfos.getDataAt(ii);
+            if (!m_imageContainer.exist(base))
+            {
+                continue;
+            }
+
+            VkMemoryRequirements req;
+            vkGetImageMemoryRequirements(m_device, getImage(base, false).image, &req);
+
+            MemoryBucket bucket{};
+            bucket.name = getName(base);
+            bucket.isImage = true;
+            bucket.transient = ResourceLifetime::transition == info.lifetime && nullptr == info.pData;
+            bucket.allocatedBytes = req.size;
+
+            imgToRes.insert({ base.id, (uint32_t)_out.resources.size() });
+            _out.resources.push_back({ bucket.name, req.size, (uint32_t)_out.buckets.size() });
+            _out.buckets.push_back(bucket);
+        }
+
+        // the aliases, they own no memory
+        for (uint32_t ii = 0; ii < m_aliasToBaseBuffers.size(); ++ii)
+        {
+            const BufferHandle alias = m_aliasToBaseBuffers.getIdAt(ii);
+            const BufferHandle base = m_aliasToBaseBuffers.getDataAt(ii);
+
+            auto it = bufToRes.find(base.id);
+            if (alias.id == base.id || bufToRes.end() == it || !m_bufferContainer.exist(alias))
+            {
+                continue;
+            }
+
+            VkMemoryRequirements req;
+            vkGetBufferMemoryRequirements(m_device, getBuffer(alias, false).buffer, &req);
+
+            const uint32_t bucketIdx = _out.resources[it->second].bucket;
+
+            bufToRes.insert({ alias.id, (uint32_t)_out.resources.size() });
+            _out.resources.push_back({ getName(alias), req.size, bucketIdx });
+            _out.buckets[bucketIdx].aliasedBytes += req.size;
+        }
+
+        for (uint32_t ii = 0; ii < m_aliasToBaseImages.size(); ++ii)
+        {
+            const ImageHandle alias = m_aliasToBaseImages.getIdAt(ii);
+            const ImageHandle base = m_aliasToBaseImages.getDataAt(ii);
+
+            auto it = imgToRes.find(base.id);
+            if (alias.id == base.id || imgToRes.end() == it || !m_imageContainer.exist(alias))
+            {
+                continue;
+            }
+
+            // the same description as the base
+            const MemoryTelemetry::Resource& baseRes = _out.resources[it->second];
+            const uint32_t bucketIdx = baseRes.bucket;
+            const uint64_t bytes = baseRes.bytes;
+
+            imgToRes.insert({ alias.id, (uint32_t)_out.resources.size() });
+            _out.resources.push_back({ getName(alias), bytes, bucketIdx });
+            _out.buckets[bucketIdx].aliasedBytes += bytes;
+        }
+
+        // the live passes
+        auto touch = [&](const stl::unordered_map<uint16_t, uint32_t>& _map, uint16_t _id, uint16_t _passIdx) {
+            auto it = _map.find(_id);
+            if (_map.end() == it)
+            {
+                return;
+            }
+
+            MemoryTelemetry::Resource& res = _out.resources[it->second];
+            res.firstPass = kInvalidHandle == res.firstPass ? _passIdx : bx::min(res.firstPass, _passIdx);
+            res.lastPass = kInvalidHandle == res.lastPass ? _passIdx : bx::max(res.lastPass, _passIdx);
+        };
+
+        for (uint16_t pp = 0; pp < passCount; ++pp)
+        {
+            const PassInfo_vk& passInfo = m_passContainer.getDataAt(pp);
+
+            for (uint32_t ii = 0; ii < passInfo.readBuffers.size(); ++ii)
+            {
+                touch(bufToRes, passInfo.readBuffers.getIdAt(ii), pp);
+            }
+            for (uint32_t ii = 0; ii < passInfo.writeBuffers.size(); ++ii)
+            {
+                touch(bufToRes, passInfo.writeBuffers.getIdAt(ii), pp);
+            }
+            for (uint32_t ii = 0; ii < passInfo.readImages.size(); ++ii)
+            {
+                touch(imgToRes, passInfo.readImages.getIdAt(ii), pp);
+            }
+            for (uint32_t ii = 0; ii < passInfo.writeImages.size(); ++ii)
+            {
+                touch(imgToRes, passInfo.writeImages.getIdAt(ii), pp);
+            }
+            for (uint32_t ii = 0; ii < passInfo.writeOpInToOut.size(); ++ii)
+            {
+                const UnifiedResHandle out = passInfo.writeOpInToOut.getDataAt(ii);
+                touch(out.isImage() ? imgToRes : bufToRes, out.rawId, pp);
+            }
+
+            touch(bufToRes, passInfo.vertexBufferId, pp);
+            touch(bufToRes, passInfo.indexBufferId, pp);
+            touch(bufToRes, passInfo.indirectBufferId, pp);
+            touch(bufToRes, passInfo.indirectCountBufferId, pp);
+        }
+
+        for (const MemoryTelemetry::Resource& res : _out.resources)
+        {
+            if (kInvalidHandle == res.firstPass)
+            {
+                continue;
+            }
+
+            MemoryBucket& bucket = _out.buckets[res.bucket];
+            bucket.firstPass = kInvalidHandle == bucket.firstPass ? res.firstPass : bx::min(bucket.firstPass, res.firstPass);
+            bucket.lastPass = kInvalidHandle == bucket.lastPass ? res.lastPass : bx::max(bucket.lastPass, res.lastPass);
+        }
+
+        // the occupancy of the passes
+        _out.passes.resize(passCount);
+        for (uint16_t pp = 0; pp < passCount; ++pp)
+        {
+            _out.passes[pp].pass = { m_passContainer.getIdAt(pp) };
+            _out.passes[pp].name = getName(_out.passes[pp].pass);
+        }
+
+        for (MemoryBucket& bucket : _out.buckets)
+        {
+            stats.allocatedBytes += bucket.allocatedBytes;
+            stats.aliasedBytes += bucket.aliasedBytes;
+            stats.transientBytes += bucket.transient ? bucket.allocatedBytes : 0;
+
+            // the others are alive for the whole frame
+            const bool ranged = bucket.transient && kInvalidHandle != bucket.firstPass;
+            const uint16_t first = ranged ? bucket.firstPass : 0;
+            const uint16_t last = ranged ? bucket.lastPass : uint16_t(passCount - 1);
+
+            if (passCount > 0)
+            {
+                bucket.occupancy = float(last - first + 1) / float(passCount);
+            }
+
+            for (uint16_t pp = first; passCount > 0 && pp <= last; ++pp)
+            {
+                MemoryPassUsage& usage = _out.passes[pp];
+                usage.liveBytes += bucket.allocatedBytes;
+                usage.transientBytes += ranged ? bucket.allocatedBytes : 0;
+                usage.liveBuckets++;
+            }
+        }
+
+        for (const MemoryTelemetry::Resource& res : _out.resources)
+        {
+            _out.buckets[res.bucket].resCount++;
+        }
+
+        for (const MemoryPassUsage& usage : _out.passes)
+        {
+            if (usage.transientBytes > stats.peakTransientBytes)
+            {
+                stats.peakTransientBytes = usage.transientBytes;
+                stats.peakPass = usage.pass;
+            }
+        }
+
+        stats.bufferCount = (uint32_t)bufToRes.size();
+        stats.imageCount = (uint32_t)imgToRes.size();
+        stats.bucketCount = (uint32_t)_out.buckets.size();
+    }
+
+    const RHIContext_vk::MemoryTelemetry& RHIContext_vk::getMemoryTelemetry()
+    {
+        if (m_memTelemetryDirty)
+        {
+            collectMemoryTelemetry(m_memTelemetry);
+            m_memTelemetryDirty = false;
+        }
+
+        // these change per frame without touching the resources
+        MemoryStats& stats = m_memTelemetry.stats;
+        stats.stagingBytes = m_lastStagingBytes;
+        stats.pendingStagingBytes = m_upload.isValid() ? m_upload.getPendingBytes() : 0;
+
+        stats.hostBytes = 0;
+        for (uint32_t ii = 0; ii < m_numFramesInFlight; ++ii)
+        {
+            stats.hostBytes += m_scratchBuffer[ii].m_buf.size;
+        }
+        stats.hostBytes += m_readbackBuf.buffer ? m_readbackBuf.size : 0;
+        stats.hostBytes += m_breadcrumbs.isValid() ? m_breadcrumbs.m_buf.size : 0;
+
+        return m_memTelemetry;
+    }
+
+    MemoryStats RHIContext_vk::getMemoryStats()
+    {
+        return getMemoryTelemetry().stats;
+    }
+
+    uint32_t RHIContext_vk::getMemoryBuckets(MemoryBucket* _out, uint32_t _max)
+    {
+        const MemoryTelemetry& telemetry = getMemoryTelemetry();
+
+        const uint32_t count = (uint32_t)telemetry.buckets.size();
+        if (nullptr != _out)
+        {
+            bx::memCopy(_out, telemetry.buckets.data(), sizeof(MemoryBucket) * bx::min(count, _max));
+        }
+
+        return count;
+    }
+
+    uint32_t RHIContext_vk::getMemoryPassUsage(MemoryPassUsage* _out, uint32_t _max)
+    {
+        const MemoryTelemetry& telemetry = getMemoryTelemetry();
+
+        const uint32_t count = (uint32_t)telemetry.passes.size();
+        if (nullptr != _out)
+        {
+            bx::memCopy(_out, telemetry.passes.data(), sizeof(MemoryPassUsage) * bx::min(count, _max));
+        }
+
+        return count;
+    }
+
+    bool RHIContext_vk::dumpMemoryTimeline(const char* _path)
+    {
+        FILE* file = fopen(_path, "w");
+        if (!file)
+        {
+            message(error, "failed to open %s for the memory timeline", _path);
+            return false;
+        }
+
+        const MemoryTelemetry& telemetry = getMemoryTelemetry();
+
+        const MemoryStats& stats = telemetry.stats;
+
+        auto passIdx = [](uint16_t _idx) {
+            return kInvalidHandle == _idx ? -1 : int32_t(_idx);
+        };
+
+        fprintf(file, "{\n");
+        fprintf(file, "  \"allocated_bytes\": %llu,\n", (unsigned long long)stats.allocatedBytes);
+        fprintf(file, "  \"aliased_bytes\": %llu,\n", (unsigned long long)stats.aliasedBytes);
+        fprintf(file, "  \"transient_bytes\": %llu,\n", (unsigned long long)stats.transientBytes);
+        fprintf(file, "  \"peak_transient_bytes\": %llu,\n", (unsigned long long)stats.peakTransientBytes);
+        fprintf(file, "  \"peak_pass\": \"%s\",\n", kInvalidHandle == stats.peakPass.id ? "" : getName(stats.peakPass));
+        fprintf(file, "  \"staging_bytes\": %llu,\n", (unsigned long long)stats.stagingBytes);
+        fprintf(file, "  \"pending_staging_bytes\": %llu,\n", (unsigned long long)stats.pendingStagingBytes);
+        fprintf(file, "  \"host_bytes\": %llu,\n", (unsigned long long)stats.hostBytes);
+
+        // in the execution order
+        fprintf(file, "  \"passes\": [\n");
+        for (size_t ii = 0; ii < telemetry.passes.size(); ++ii)
+        {
+            const MemoryPassUsage& usage = telemetry.passes[ii];
+            fprintf(file, "    { \"name\": \"%s\", \"live_bytes\": %llu, \"transient_bytes\": %llu, \"live_buckets\": %u }%s\n"
+                , getName(usage.pass)
+                , (unsigned long long)usage.liveBytes, (unsigned long long)usage.transientBytes, usage.liveBuckets
+                , (ii + 1 < telemetry.passes.size()) ? "," : "");
+        }
+        fprintf(file, "  ],\n");
+
+        // the pass indices are in the passes above, -1 if no pass uses it
+        fprintf(file, "  \"buckets\": [\n");
+        for (uint32_t bb = 0; bb < telemetry.buckets.size(); ++bb)
+        {
+            const MemoryBucket& bucket = telemetry.buckets[bb];
+            fprintf(file, "    { \"name\": \"%s\", \"type\": \"%s\", \"transient\": %s, \"allocated_bytes\": %llu, \"aliased_bytes\": %llu, \"first_pass\": %d, \"last_pass\": %d, \"occupancy\": %.3f,\n"
+                , bucket.name, bucket.isImage ? "image" : "buffer", bucket.transient ? "true" : "false"
+                , (unsigned long long)bucket.allocatedBytes, (unsigned long long)bucket.aliasedBytes
+                , passIdx(bucket.firstPass), passIdx(bucket.lastPass), bucket.occupancy);
+
+            fprintf(file, "      \"resources\": [");
+            bool first = true;
+            for (const MemoryTelemetry::Resource& res : telemetry.resources)
+            {
+                if (bb != res.bucket)
+                {
+                    continue;
+                }
+
+                fprintf(file, "%s\n        { \"name\": \"%s\", \"bytes\": %llu, \"first_pass\": %d, \"last_pass\": %d }"
+                    , first ? "" : ","
+                    , res.name, (unsigned long long)res.bytes, passIdx(res.firstPass), passIdx(res.lastPass));
+                first = false;
+            }
+            fprintf(file, "\n      ]\n");
+
+            fprintf(file, "    }%s\n", (bb + 1 < telemetry.buckets.size()) ? "," : "");
+        }
+        fprintf(file, "  ]\n");
+        fprintf(file, "}\n");
+
+        fclose(file);
+
+        return true;
+    }
+
+    bool RHIContext_vk::readBuffer(const BufferHandle _hBuf, void* _dst, uint32_t _size, uint32_t _offset)
+    {
+        if (!m_bufferContainer.exist(_hBuf))
+        {
+            message(info, "readBuffer will not perform for buffer %d! It might be useless after render pass sorted", _hBuf.id);
+            return false;
+        }
+
+        const Buffer_vk& buf = m_bufferContainer.getIdToData(_hBuf);
+        if (nullptr == buf.data || _offset + _size > buf.size)
+        {
+            message(warning, "readBuffer: buffer 0x%x is not host visible or too small", _hBuf.id);
+            return false;
+        }
+
+        const BufferHandle baseBuf = { m_aliasToBaseBuffers.getIdToData(_hBuf) };
+        const BufferCreateInfo& info = m_bufferCreateInfos.getIdToData(baseBuf);
+        if (0 == (info.memFlags & MemoryPropFlagBits::host_coherent))
+        {
+            VkMappedMemoryRange range = { VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE };
+            range.memory = buf.memory;
+            range.offset = 0;
+            range.size = VK_WHOLE_SIZE;
+            vkInvalidateMappedMemoryRanges(m_device, 1, &range);
+        }
+
+        bx::memCopy(_dst, (const uint8_t*)buf.data + _offset, _size);
+
+        return true;
+    }
+
+    void RHIContext_vk::requestReadback(const char* _path)
+    {
+        m_readbackPath.set(_path);
+        m_readbackRequested = true;
+    }
+
+    void RHIContext_vk::setLatencyMarker(LatencyMarker _marker, int64_t _time)
+    {
+        m_latencyMarkers[(uint32_t)_marker] = _time;
+    }
+
+    void RHIContext_vk::pollLatencyFrames()
+    {
+        constexpr double kSmoothing = 0.05;
+
+        const double toMs = 1000.0 / double(bx::getHPFrequency());
+        const int64_t now = bx::getHPCounter();
+
+        // the device and host clocks sampled together, taken once the first frame is done
+        uint64_t calibrated[2] = { 0, 0 };
+
+        for (uint32_t ii = 0; ii < m_numFramesInFlight; ++ii)
+        {
+            LatencyFrame& frame = m_latencyFrames[ii];
+            if (!frame.pending
+                || VK_SUCCESS != vkGetFenceStatus(m_device, m_cmd.m_commandList[ii].m_fence))
+            {
+                continue;
+            }
+
+            frame.pending = false;
+
+            // the poll time is late by up to the poll interval without the calibrated timestamps
+            int64_t gpuDone = now;
+
+            uint64_t gpuEnd = 0;
+            if (m_latencyQueryPool
+                && VK_SUCCESS == vkGetQueryPoolResults(m_device, m_latencyQueryPool, ii, 1, sizeof(gpuEnd), &gpuEnd, sizeof(gpuEnd), VK_QUERY_RESULT_64_BIT))
+            {
+                if (0 == calibrated[0])
+                {
+                    VkCalibratedTimestampInfoEXT infos[2] = {
+                        { VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT, nullptr, VK_TIME_DOMAIN_DEVICE_EXT },
+                        { VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT, nullptr, kHostTimeDomain },
+                    };
+                    uint64_t deviation = 0;
+                    VK_CHECK(vkGetCalibratedTimestampsEXT(m_device, COUNTOF(infos), infos, calibrated, &deviation));
+                }
+
+                // how long ago the frame ended on the device, in the host ticks
+                const uint64_t mask = m_timestampValidBits >= 64 ? ~0ull : ((1ull << m_timestampValidBits) - 1);
+                const double agoNs = double((calibrated[0] - gpuEnd) & mask) * double(m_phyDeviceProps.limits.timestampPeriod);
+                gpuDone = int64_t(calibrated[1]) - int64_t(agoNs * double(bx::getHPFrequency()) / 1e9);
+            }
+
+            // a frame without the simulation end marker counts it at the submit
+            const int64_t simulationEnd = frame.simulationEnd != 0 ? frame.simulationEnd : frame.submit;
+            const double stages[] =
+            {
+                double(simulationEnd - frame.input) * toMs,
+                double(frame.submit - simulationEnd) * toMs,
+                double(frame.present - frame.submit) * toMs,
+                bx::max(double(gpuDone - frame.present) * toMs, 0.0), // the gpu may finish before the present returns
+            };
+
+            const bool first = 0 == m_latencyHistory.count;
+            for (uint32_t jj = 0; jj < COUNTOF(stages); ++jj)
+            {
+                m_latencyStages[jj] = first
+                    ? stages[jj]
+                    : m_latencyStages[jj] * (1.0 - kSmoothing) + stages[jj] * kSmoothing;
+            }
+
+            pushPassTime(m_latencyHistory, double(bx::max(gpuDone, frame.present) - frame.input) * toMs);
+        }
+    }
+
+    LatencyTimings RHIContext_vk::getLatencyTimings()
+    {
+        LatencyTimings result{};
+        result.inputToSimulationEnd = m_latencyStages[0];
+        result.simulationEndToSubmit = m_latencyStages[1];
+        result.submitToPresent = m_latencyStages[2];
+        result.presentToGpuDone = m_latencyStages[3];
+        result.inputToPhoton = getTimings(m_latencyHistory);
+
+        return result;
+    }
+
+    bool RHIContext_vk::checkSupports(VulkanSupportExtension _ext)
+    {
+        KG_ZoneScopedC(Color::indian_red);
+        const char* extName = getExtName(_ext);
+        stl::vector<VkExtensionProperties> supportedExtensions;
+        enumrateDeviceExtPorps(m_physicalDevice, supportedExtensions);
+
+        return checkExtSupportness(supportedExtensions, extName);
+    }
+
+    bool RHIContext_vk::checkSubgroupArithmeticSupports()
+    {
+        KG_ZoneScopedC(Color::indian_red);
+
+        VkPhysicalDeviceSubgroupProperties subgroupProps{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES };
+        VkPhysicalDeviceProperties2 props2{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2 };
+        props2.pNext = &subgroupProps;
+        vkGetPhysicalDeviceProperties2(m_physicalDevice, &props2);
+
+        // the scan shader makes no assumption on the subgroup size, it may vary per dispatch
+        return (subgroupProps.supportedStages & VK_SHADER_STAGE_COMPUTE_BIT)
+            && (subgroupProps.supportedOperations & VK_SUBGROUP_FEATURE_BASIC_BIT)
+            && (subgroupProps.supportedOperations & VK_SUBGROUP_FEATURE_ARITHMETIC_BIT);
+    }
+
+    bool RHIContext_vk::checkBufferDeviceAddressSupports()
+    {
+        KG_ZoneScopedC(Color::indian_red);
+
+        VkPhysicalDeviceVulkan12Features features12{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES };
+        VkPhysicalDeviceFeatures2 features2{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+        features2.pNext = &features12;
+        vkGetPhysicalDeviceFeatures2(m_physicalDevice, &features2);
+
+        return features12.bufferDeviceAddress;
+    }
+
+    bool RHIContext_vk::checkStorageImageSupports(ResourceFormat _format)
+    {
+        KG_ZoneScopedC(Color::indian_red);
+
+        VkFormatProperties3 props3{ VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_3 };
+        VkFormatProperties2 props2{ VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_2 };
+        props2.pNext = &props3;
+        vkGetPhysicalDeviceFormatProperties2(m_physicalDevice, getFormat(_format), &props2);
+
+        // the shaders declare the storage images without a format qualifier
+        const VkFormatFeatureFlags2 required = VK_FORMAT_FEATURE_2_STORAGE_IMAGE_BIT | VK_FORMAT_FEATURE_2_STORAGE_WRITE_WITHOUT_FORMAT_BIT;
+        return required == (props3.optimalTilingFeatures & required);
+    }
+
+    void RHIContext_vk::updateResolution(const Resolution& _resolution)
+    {
+        KG_ZoneScopedC(Color::indian_red);
+        if (_resolution.width != m_resolution.width
+            || _resolution.height != m_resolution.height
+            || _resolution.reset != m_resolution.reset
+            || _resolution.presentMode != m_resolution.presentMode
+            || m_swapchain.m_shouldRecreateSwapchain
+            )
+        {
+            // untrack old swapchain images
+            for (uint32_t ii = 0; ii < m_swapchain.m_swapchainImageCount; ++ii)
+            {
+                unsetLocalDebugName(m_swapchain.m_swapchainImages[ii]);
+                m_barrierDispatcher.untrack(m_swapchain.m_swapchainImages[ii]);
+            }
+
+            m_swapchain.update(m_nwh, _resolution);
+
+            // track new images
+            for (uint32_t ii = 0; ii < m_swapchain.m_swapchainImageCount; ++ii)
+            {
+                VkImage scimg = m_swapchain.m_swapchainImages[ii];
+                setDebugObjName(m_device, scimg, "Img_Swapchain_%d", ii);
+
+                m_barrierDispatcher.track(
+                    m_swapchain.m_swapchainImages[ii]
+                    , VK_IMAGE_ASPECT_COLOR_BIT
+                    , { 0, VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT }
+                );
+            }
+
+            // update attachments
+            for (const kage::ImageHandle & hImg : m_colorAttchBase)
+            {
+                updateImage(hImg, _resolution.width, _resolution.height, 1, nullptr);
+            }
+
+            for (const kage::ImageHandle & hImg : m_depthAttchBase)
+            {
+                updateImage(hImg, _resolution.width, _resolution.height, 1, nullptr);
+            }
+
+            m_resolution = _resolution;
+            message(info,
+                "update m_resolution: width: %d, height: %d, reset: %016x"
+                , m_resolution.width
+                , m_resolution.height
+                , m_resolution.reset
+            );
+
+            m_updated = true;
+        }
+    }
+
+    void RHIContext_vk::updateBuffer(
+        const BufferHandle _hBuf
+        , const Memory* _mem
+        , const uint32_t _offset
+        , const uint32_t _size
+    )
+    {
+        KG_ZoneScopedC(Color::indian_red);
+        const char* bufName = getName(_hBuf);
+        KG_ZoneName(bufName, strlen(bufName));
+
+        if (!m_bufferContainer.exist(_hBuf))
+        {
+            message(info, "updateBuffer will not perform for buffer %d! It might be useless after render pass sorted", _hBuf.id);
+            return;
+        }
+
+        const Buffer_vk& buf = m_bufferContainer.getIdToData(_hBuf);
+        BufferHandle hbase = m_aliasToBaseBuffers.getIdToData(_hBuf);
+        const Buffer_vk& baseBuf = m_bufferContainer.getIdToData(hbase);
+
+        const BufferCreateInfo& createInfo = m_bufferCreateInfos.getDataRef(hbase);
+
+        // re-create buffer if new size is larger than the old one
+        if (buf.size != _size && baseBuf.size < (_offset + _size))
+        {
+            m_barrierDispatcher.untrack(buf.buffer);
+
+            Buffer_vk& bufToRelease = m_bufferContainer.getDataRef(_hBuf);
+            release(bufToRelease.buffer);
+            release(bufToRelease.memory);
+
+            // recreate buffer
+            BufferAliasInfo info{};
+            info.size = _size;
+            info.hbuf = _hBuf;
+
+            Buffer_vk newBuf = kage::vk::createBuffer(
+                info
+                , getBufferUsageFlags(createInfo.usage)
+                , getMemPropFlags(createInfo.memFlags)
+                , getFormat(createInfo.format)
+            );
+            m_bufferContainer.update(_hBuf, newBuf);
+            m_memTelemetryDirty = true;
+
+            ResInteractDesc interact{ createInfo.barrierState };
+            m_barrierDispatcher.track(
+                newBuf.buffer
+                , { getAccessFlags(interact.access), getPipelineStageFlags(interact.stage) }
+                , newBuf.buffer
+            );
+        }
+
+        const Buffer_vk& newBuf = m_bufferContainer.getIdToData(_hBuf);
+
+        if (_mem){
+            uploadBuffer(_hBuf, _mem->data, _mem->size, _offset);
+
+            if (isReadOnly(_hBuf))
+            {
+                publishReadOnlyBuffer(_hBuf);
+            }
+        }
+
+        // flush host visble but not coherented buf
+        if (    0 == (createInfo.memFlags & MemoryPropFlagBits::host_coherent)
+            &&  0 != (createInfo.memFlags & MemoryPropFlagBits::host_visible)
             )
         {
             flushBuffer(newBuf);
         }
     }
 
+    void RHIContext_vk::updateBufferAddresses(
+        const BufferHandle _hBuf
+        , const Memory* _srcs
+        , const uint32_t _offset
+    )
+    {
+        KG_ZoneScopedC(Color::indian_red);
+
+        if (!m_bufferContainer.exist(_hBuf))
+        {
+            message(info, "updateBufferAddresses will not perform for buffer %d! It might be useless after render pass sorted", _hBuf.id);
+            return;
+        }
+
+        const uint32_t num = _srcs->size / sizeof(BufferHandle);
+        const BufferHandle* srcs = (const BufferHandle*)_srcs->data;
+
+        stl::vector<uint64_t> addresses(num, 0);
+        for (uint32_t ii = 0; ii < num; ++ii)
+        {
+            // an optional slot
+            if (!isValid(srcs[ii]))
+            {
+                continue;
+            }
+
+            if (!m_bufferContainer.exist(srcs[ii]))
+            {
+                message(warning, "buffer %d is not created, its address is null", srcs[ii].id);
+                continue;
+            }
+
+            const Buffer_vk& buf = getBuffer(srcs[ii]);
+            if (0 == buf.address)
+            {
+                message(warning, "buffer %s is not created with the device_address usage", getName(srcs[ii]));
+            }
+
+            addresses[ii] = (uint64_t)buf.address;
+        }
+
+        uploadBuffer(_hBuf, addresses.data(), num * sizeof(uint64_t), _offset);
+
+        if (isReadOnly(_hBuf))
+        {
+            publishReadOnlyBuffer(_hBuf);
+        }
+    }
+
     void RHIContext_vk::updateImage(
         const ImageHandle _hImg
         , const uint16_t _width
@@ -2091,6 +2996,7 @@ namespace kage { namespace vk
             }
 
             release(baseImgVk.memory);
+            m_memTelemetryDirty = true;
 
             ImageCreateInfo& ci = m_imgCreateInfos.getDataRef(_hImg);
             ci.width = _width;
@@ -2128,6 +3034,211 @@ namespace kage { namespace vk
         }
     }
 
+    static int64_t getFileModifiedTime(const char* _path)
+    {
+        struct stat st;
+        if (0 != stat(_path, &st))
+        {
+            return 0;
+        }
+
+        return int64_t(st.st_mtime);
+    }
+
+    void RHIContext_vk::setShaderHotReload(bool _enable)
+    {
+        m_shaderHotReload = _enable;
+    }
+
+    // the program is in the high bits, the layout is not hashed as it changes on the shader reload
+    static uint64_t hashPipelineVariant(uint16_t _prog, const PipelineBuildInfo_vk& _info)
+    {
+        bx::HashMurmur2A hash;
+        hash.begin();
+        hash.add(_info.queue);
+        hash.add(_info.colorFormats.data(), uint32_t(sizeof(VkFormat) * _info.colorFormats.size()));
+        hash.add(_info.depthFormat);
+        hash.add(_info.vertexBindings.data(), uint32_t(sizeof(VkVertexInputBindingDescription) * _info.vertexBindings.size()));
+        hash.add(_info.vertexAttributes.data(), uint32_t(sizeof(VkVertexInputAttributeDescription) * _info.vertexAttributes.size()));
+        hash.add(_info.configs.enableDepthTest);
+        hash.add(_info.configs.enableDepthWrite);
+        hash.add(_info.configs.depthCompOp);
+        hash.add(_info.configs.cullMode);
+        hash.add(_info.configs.polygonMode);
+        hash.add(uint32_t(_info.specData.size()));
+        hash.add(_info.specData.data(), uint32_t(sizeof(int) * _info.specData.size()));
+
+        return (uint64_t(_prog) << 32) | hash.end();
+    }
+
+    // touches no state of the context, runs on the compile jobs as well
+    static VkPipeline compilePipeline(VkDevice _device, VkPipelineCache _cache, const PipelineBuildInfo_vk& _info)
+    {
+        KG_ZoneScopedC(Color::indian_red);
+
+        VkPipeline pipeline{};
+        if (PassExeQueue::graphics == _info.queue)
+        {
+            VkPipelineRenderingCreateInfo renderInfo = { VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO };
+            renderInfo.colorAttachmentCount = (uint32_t)_info.colorFormats.size();
+            renderInfo.pColorAttachmentFormats = _info.colorFormats.data();
+            renderInfo.depthAttachmentFormat = _info.depthFormat;
+
+            VkPipelineVertexInputStateCreateInfo vtxInputCreateInfo = { VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO };
+            vtxInputCreateInfo.vertexBindingDescriptionCount = (uint32_t)_info.vertexBindings.size();
+            vtxInputCreateInfo.pVertexBindingDescriptions = _info.vertexBindings.data();
+            vtxInputCreateInfo.vertexAttributeDescriptionCount = (uint32_t)_info.vertexAttributes.size();
+            vtxInputCreateInfo.pVertexAttributeDescriptions = _info.vertexAttributes.data();
+
+            const bool hasVIS = !_info.vertexBindings.empty() || !_info.vertexAttributes.empty();
+
+            pipeline = kage::vk::createGraphicsPipeline(_device, _cache, _info.layout, renderInfo, _info.shaders, hasVIS ? &vtxInputCreateInfo : nullptr, _info.specData, _info.configs);
+            assert(pipeline);
+        }
+        else if (PassExeQueue::compute == _info.queue)
+        {
+            pipeline = kage::vk::createComputePipeline(_device, _cache, _info.layout, _info.shaders[0], _info.specData);
+            assert(pipeline);
+        }
+
+        return pipeline;
+    }
+
+    void RHIContext_vk::checkShaderReload()
+    {
+        constexpr uint32_t kShaderWatchInterval = 30;
+
+        if (!m_shaderHotReload || (m_shaderWatchFrame++ % kShaderWatchInterval) != 0)
+        {
+            return;
+        }
+
+        stl::vector<uint16_t> changed;
+        for (uint32_t ii = 0; ii < m_shaderFiles.size(); ++ii)
+        {
+            const uint16_t shaderId = m_shaderFiles.getIdAt(ii);
+            ShaderFile_vk& file = m_shaderFiles.getDataRef(shaderId);
+
+            const int64_t mtime = getFileModifiedTime(file.path);
+            if (0 != mtime && mtime != file.mtime)
+            {
+                file.mtime = mtime;
+                changed.push_back(shaderId);
+            }
+        }
+
+        if (!changed.empty())
+        {
+            reloadShaders(changed);
+        }
+    }
+
+    void RHIContext_vk::reloadShaders(const stl::vector<uint16_t>& _shaderIds)
+    {
+        KG_ZoneScopedC(Color::indian_red);
+
+        // nothing in flight may use the old programs and pipelines
+        kick(true);
+        flushPipelineVariants();
+
+        stl::vector<uint16_t> reloaded;
+        for (const uint16_t shaderId : _shaderIds)
+        {
+            ShaderFile_vk& file = m_shaderFiles.getDataRef(shaderId);
+
+            Shader_vk shader{};
+            if (!loadShader(shader, m_device, file.path))
+            {
+                // retry in the next poll, the compiler might not be done with it
+                file.mtime = 0;
+                message(warning, "failed to reload shader %s", file.path);
+                continue;
+            }
+
+            // the module is not needed once the pipelines are created
+            Shader_vk& old = m_shaderContainer.getDataRef(shaderId);
+            vkDestroyShaderModule(m_device, old.module, nullptr);
+            old = shader;
+
+            reloaded.push_back(shaderId);
+            message(info, "shader reloaded: %s", file.path);
+        }
+
+        // only the programs using the reloaded shaders
+        stl::vector<uint16_t> rebuiltProgs;
+        for (uint32_t ii = 0; ii < m_programContainer.size(); ++ii)
+        {
+            const stl::vector<uint16_t>& shaderIds = m_programShaderIds[ii];
+
+            bool affected = false;
+            for (const uint16_t sid : shaderIds)
+            {
+                affected |= (kInvalidIndex != getElemIndex(reloaded, sid));
+            }
+
+            if (!affected)
+            {
+                continue;
+            }
+
+            const uint16_t progId = m_programContainer.getIdAt(ii);
+            const ProgramCreateInfo& info = m_programCreateInfos.getIdToData(progId);
+
+            VkDescriptorSetLayout setArrLayout = VK_NULL_HANDLE;
+            if (kInvalidHandle != info.bindlessId)
+            {
+                setArrLayout = m_bindlessContainer.getIdToData(info.bindlessId).layout;
+            }
+
+            stl::vector<Shader_vk> shaders;
+            for (const uint16_t sid : shaderIds)
+            {
+                shaders.push_back(m_shaderContainer.getIdToData(sid));
+            }
+
+            Program_vk& prog = m_programContainer.getDataRef(progId);
+            destroyProgram(m_device, prog);
+            prog = kage::vk::createProgram(m_device, getBindPoint(shaders), shaders, info.sizePushConstants, setArrLayout, m_descPool);
+
+            rebuiltProgs.push_back(progId);
+        }
+
+        // and the pipeline variants made of them, the keys stay the same
+        for (auto it = m_pipelineVariants.begin(); it != m_pipelineVariants.end(); ++it)
+        {
+            PipelineVariant_vk& variant = it->second;
+            if (kInvalidIndex == getElemIndex(rebuiltProgs, variant.prog))
+            {
+                continue;
+            }
+
+            if (variant.pipeline)
+            {
+                vkDestroyPipeline(m_device, variant.pipeline, nullptr);
+            }
+
+            PipelineBuildInfo_vk info{};
+            getPipelineBuildInfo(info, m_passContainer.getIdToData(variant.passId), variant.specData, variant.config);
+            variant.pipeline = compilePipeline(m_device, m_pipelineCache, info);
+        }
+
+        for (uint32_t ii = 0; ii < m_passContainer.size(); ++ii)
+        {
+            const uint16_t passId = m_passContainer.getIdAt(ii);
+            PassInfo_vk& passInfo = m_passContainer.getDataRef(passId);
+
+            if (kInvalidIndex == getElemIndex(rebuiltProgs, passInfo.prog.id))
+            {
+                continue;
+            }
+
+            passInfo.pipeline = m_pipelineVariants.find(passInfo.pipelineKey)->second.pipeline;
+
+            // the new non-push set is empty, write it again on the next bind
+            m_bindDescHashPerPass.erase(PassHandle{ passId });
+        }
+    }
+
     void RHIContext_vk::createShader(bx::MemoryReader& _reader)
     {
         KG_ZoneScopedC(Color::indian_red);
@@ -2144,6 +3255,11 @@ namespace kage { namespace vk
         assert(lsr);
 
         m_shaderContainer.addOrUpdate(info.shaderId, shader);
+
+        ShaderFile_vk file{};
+        bx::strCopy(file.path, kMaxPathLen, path);
+        file.mtime = getFileModifiedTime(path);
+        m_shaderFiles.addOrUpdate(info.shaderId, file);
     }
 
     void RHIContext_vk::createProgram(bx::MemoryReader& _reader)
@@ -2173,6 +3289,7 @@ namespace kage { namespace vk
 
         m_programContainer.addOrUpdate(info.progId, prog);
         m_programShaderIds.emplace_back(shaderIds);
+        m_programCreateInfos.addOrUpdate(info.progId, info);
 
         assert(m_programContainer.size() == m_programShaderIds.size());
     }
@@ -2257,13 +3374,19 @@ namespace kage { namespace vk
             };
 
         size_t offset = 0; // the depth is the first one
-        auto preparePassBarriers = [&interacts, &offset, getBarrierState](
+        auto preparePassBarriers = [this, &interacts, &offset, getBarrierState](
               const stl::vector<uint16_t>& _ids
             , ContinuousMap< uint16_t, BarrierState_vk>& _container
             , const ResourceType _type
             ) {
                 for (uint32_t ii = 0; ii < _ids.size(); ++ii)
                 {
+                    // already published to all reads, the write binding is rejected in the front end
+                    if (ResourceType::buffer == _type && isReadOnly(BufferHandle{ _ids[ii] }))
+                    {
+                        continue;
+                    }
+
                     _container.addOrUpdate(_ids[ii], getBarrierState(interacts[offset + ii]));
                 } 
 
@@ -2276,93 +3399,215 @@ namespace kage { namespace vk
         preparePassBarriers(writeBufferIds, passInfo.writeBuffers, ResourceType::buffer);
         assert(offset == interacts.size());
 
-        // write op alias part
+        // write op alias part
+        {
+            size_t writeOpAliasCount = passMeta.writeBufAliasNum + passMeta.writeImgAliasNum;
+            assert(writeOpAliasInIds.size() == writeOpAliasCount);
+            assert(writeOpAliasOutIds.size() == writeOpAliasCount);
+            for (uint32_t ii = 0; ii < writeOpAliasCount; ++ii )
+            {
+                passInfo.writeOpInToOut.addOrUpdate(writeOpAliasInIds[ii], writeOpAliasOutIds[ii]);
+            }
+        }
+
+        PassPipelineDesc_vk pipelineDesc{};
+        pipelineDesc.vertexBindings = passVertexBinding;
+        pipelineDesc.vertexAttributes = passVertexAttribute;
+        pipelineDesc.specData = pipelineSpecData;
+        m_passPipelineDescs.addOrUpdate(passInfo.passId, pipelineDesc);
+
+        // the registration variant is compiled in place, it is the fallback of the other variants
+        passInfo.pipelineKey = requestPipelineVariant(passInfo, pipelineSpecData, passInfo.pipelineConfig, false);
+        passInfo.selectedKey = passInfo.pipelineKey;
+        if (0 != passInfo.pipelineKey)
+        {
+            passInfo.pipeline = m_pipelineVariants.find(passInfo.pipelineKey)->second.pipeline;
+        }
+        m_passContainer.addOrUpdate(passInfo.passId, passInfo);
+    }
+
+    void RHIContext_vk::getPipelineBuildInfo(PipelineBuildInfo_vk& _out, const PassInfo_vk& _passInfo, const stl::vector<int>& _specData, const GraphicsPipelineConfig& _config) const
+    {
+        const uint16_t progIdx = (uint16_t)m_programContainer.getIdIndex(_passInfo.prog);
+        const Program_vk& program = m_programContainer.getIdToData(_passInfo.prog);
+        const stl::vector<uint16_t>& shaderIds = m_programShaderIds[progIdx];
+
+        _out.queue = _passInfo.queue;
+        _out.layout = program.layout;
+        _out.specData = _specData;
+
+        for (const uint16_t sid : shaderIds)
+        {
+            _out.shaders.push_back(m_shaderContainer.getIdToData(sid));
+        }
+
+        if (PassExeQueue::graphics != _passInfo.queue)
+        {
+            assert(shaderIds.size() == 1);
+            return;
+        }
+
+        for (size_t ii = 0; ii < _passInfo.writeImages.size(); ++ii)
+        {
+            uint16_t id = _passInfo.writeImages.getIdAt(ii);
+
+            const Image_vk& img = m_imageContainer.getIdToData({id});
+            const BarrierState_vk& ba = _passInfo.writeImages.getDataAt(ii);
+            if ((ba.accessMask & VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT) == 0)
+                continue;
+
+            _out.colorFormats.emplace_back(img.format);
+        }
+        _out.depthFormat = m_depthFormat;
+
+        const PassPipelineDesc_vk& desc = m_passPipelineDescs.getIdToData(_passInfo.passId);
+        for (const VertexBindingDesc& bind : desc.vertexBindings)
+        {
+            _out.vertexBindings.push_back({ bind.binding, bind.stride, getInputRate(bind.inputRate) });
+        }
+
+        for (const VertexAttributeDesc& attr : desc.vertexAttributes)
+        {
+            _out.vertexAttributes.push_back({ attr.location, attr.binding, getFormat(attr.format), attr.offset });
+        }
+
+        _out.configs = PipelineConfigs_vk{
+            _config.enableDepthTest
+            , _config.enableDepthWrite
+            , getCompareOp(_config.depthCompOp)
+            , getCullMode(_config.cullMode)
+            , getPolygonMode(_config.polygonMode)
+        };
+    }
+
+    uint64_t RHIContext_vk::requestPipelineVariant(const PassInfo_vk& _passInfo, const stl::vector<int>& _specData, const GraphicsPipelineConfig& _config, bool _async)
+    {
+        // no shaders in the extern passes
+        if (PassExeQueue::graphics != _passInfo.queue && PassExeQueue::compute != _passInfo.queue)
+        {
+            return 0;
+        }
+
+        // the render state means nothing to a compute pipeline, keep it out of the key
+        const GraphicsPipelineConfig config = (PassExeQueue::graphics == _passInfo.queue) ? _config : GraphicsPipelineConfig{};
+
+        PipelineBuildInfo_vk info{};
+        getPipelineBuildInfo(info, _passInfo, _specData, config);
+
+        const uint64_t key = hashPipelineVariant(_passInfo.prog.id, info);
+        if (m_pipelineVariants.find(key) != m_pipelineVariants.end())
         {
-            size_t writeOpAliasCount = passMeta.writeBufAliasNum + passMeta.writeImgAliasNum;
-            assert(writeOpAliasInIds.size() == writeOpAliasCount);
-            assert(writeOpAliasOutIds.size() == writeOpAliasCount);
-            for (uint32_t ii = 0; ii < writeOpAliasCount; ++ii )
-            {
-                passInfo.writeOpInToOut.addOrUpdate(writeOpAliasInIds[ii], writeOpAliasOutIds[ii]);
-            }
+            return key;
         }
 
-        VkPipeline pipeline{};
-        if (passMeta.queue == PassExeQueue::graphics)
+        PipelineVariant_vk variant{};
+        variant.passId = _passInfo.passId;
+        variant.prog = _passInfo.prog.id;
+        variant.specData = _specData;
+        variant.config = config;
+
+        if (_async)
         {
-            // create pipeline
-            const uint16_t progIdx = (uint16_t)m_programContainer.getIdIndex(passInfo.prog);
-            const Program_vk& program = m_programContainer.getIdToData(passInfo.prog);
-            const stl::vector<uint16_t>& shaderIds = m_programShaderIds[progIdx];
+            variant.compiling = true;
 
-            stl::vector<VkFormat> colorFormats{};
-            for (size_t ii = 0; ii < passInfo.writeImages.size(); ++ii)
-            {
-                uint16_t id = passInfo.writeImages.getIdAt(ii);
+            PipelineCompileJob_vk job;
+            job.key = key;
+            job.pipeline = std::async(std::launch::async, [device = m_device, cache = m_pipelineCache, info]() {
+                    return compilePipeline(device, cache, info);
+                });
+            m_pipelineJobs.push_back(std::move(job));
+        }
+        else
+        {
+            variant.pipeline = compilePipeline(m_device, m_pipelineCache, info);
+        }
 
-                const Image_vk& img = m_imageContainer.getIdToData({id});
-                const BarrierState_vk& ba = passInfo.writeImages.getDataAt(ii);
-                if ((ba.accessMask & VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT) == 0)
-                    continue;
+        m_pipelineVariants.insert(stl::make_pair(key, variant));
 
-                colorFormats.emplace_back(img.format);
-            }
+        return key;
+    }
 
-            VkPipelineRenderingCreateInfo renderInfo = { VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO };
-            renderInfo.colorAttachmentCount = (uint32_t)colorFormats.size();
-            renderInfo.pColorAttachmentFormats = colorFormats.data();
-            renderInfo.depthAttachmentFormat = m_depthFormat;
+    void RHIContext_vk::updatePipelineVariants()
+    {
+        KG_ZoneScopedC(Color::indian_red);
 
-            stl::vector< Shader_vk> shaders;
-            for (const uint16_t sid : shaderIds)
+        for (size_t ii = 0; ii < m_pipelineJobs.size(); )
+        {
+            PipelineCompileJob_vk& job = m_pipelineJobs[ii];
+            if (std::future_status::ready != job.pipeline.wait_for(std::chrono::seconds(0)))
             {
-                shaders.push_back(m_shaderContainer.getIdToData(sid));
+                ++ii;
+                continue;
             }
 
-            VkPipelineVertexInputStateCreateInfo vtxInputCreateInfo{};
-            bool hasVIS = getVertexInputState(vtxInputCreateInfo, passVertexBinding, passVertexAttribute);
-
-            PipelineConfigs_vk configs{
-                passMeta.pipelineConfig.enableDepthTest
-                , passMeta.pipelineConfig.enableDepthWrite
-                , getCompareOp(passMeta.pipelineConfig.depthCompOp)
-                , getCullMode(passMeta.pipelineConfig.cullMode)
-                , getPolygonMode(passMeta.pipelineConfig.polygonMode)
-            };
+            PipelineVariant_vk& variant = m_pipelineVariants.find(job.key)->second;
+            variant.pipeline = job.pipeline.get();
+            variant.compiling = false;
 
-            VkPipelineCache cache{};
-            cache.vk = 0;
-            pipeline = kage::vk::createGraphicsPipeline(m_device, cache, program.layout, renderInfo, shaders, hasVIS ? &vtxInputCreateInfo : nullptr, pipelineSpecData, configs);
-            assert(pipeline);
+            m_pipelineJobs[ii] = std::move(m_pipelineJobs.back());
+            m_pipelineJobs.pop_back();
         }
-        else if (passMeta.queue == PassExeQueue::compute)
+
+        for (size_t ii = 0; ii < m_variantWaitingPasses.size(); )
         {
-            // create pipeline
-            const uint16_t progIdx = (uint16_t)m_programContainer.getIdIndex(passMeta.prog);
-            const Program_vk& program = m_programContainer.getIdToData(passMeta.prog);
-            const stl::vector<uint16_t>& shaderIds = m_programShaderIds[progIdx];
+            PassInfo_vk& passInfo = m_passContainer.getDataRef(m_variantWaitingPasses[ii]);
 
-            stl::vector< Shader_vk> shaders;
-            for (const uint16_t sid : shaderIds)
+            const PipelineVariant_vk& variant = m_pipelineVariants.find(passInfo.selectedKey)->second;
+            if (variant.compiling)
             {
-                shaders.push_back(m_shaderContainer.getIdToData(sid));
+                ++ii;
+                continue;
             }
 
-            assert(shaderIds.size() == 1);
-            Shader_vk shader = m_shaderContainer.getIdToData(shaderIds[0]);
+            passInfo.pipeline = variant.pipeline;
+            passInfo.pipelineKey = passInfo.selectedKey;
 
-            VkPipelineCache cache{};
-            cache.vk = 0;
-            pipeline = kage::vk::createComputePipeline(m_device, cache, program.layout, shader, pipelineSpecData);
-            assert(pipeline);
+            m_variantWaitingPasses[ii] = m_variantWaitingPasses.back();
+            m_variantWaitingPasses.pop_back();
         }
-        else if (passMeta.queue == PassExeQueue::extern_abstract)
+    }
+
+    void RHIContext_vk::flushPipelineVariants()
+    {
+        for (PipelineCompileJob_vk& job : m_pipelineJobs)
         {
-            // do nothing because there no shaders here
+            job.pipeline.wait();
         }
 
-        passInfo.pipeline = pipeline;
-        m_passContainer.addOrUpdate(passInfo.passId, passInfo);
+        updatePipelineVariants();
+        assert(m_pipelineJobs.empty());
+    }
+
+    void RHIContext_vk::setPassVariant(const PassHandle _hPass, const GraphicsPipelineConfig& _config, const Memory* _specData, bool _bind)
+    {
+        KG_ZoneScopedC(Color::indian_red);
+
+        if (!m_passContainer.exist(_hPass.id))
+        {
+            message(warning, "setPassVariant: pass 0x%x is not baked or is culled, skipping", _hPass.id);
+            return;
+        }
+
+        PassInfo_vk& passInfo = m_passContainer.getDataRef(_hPass.id);
+
+        stl::vector<int> specData = m_passPipelineDescs.getIdToData(_hPass.id).specData;
+        if (_specData)
+        {
+            specData.resize(_specData->size / sizeof(int));
+            memcpy(specData.data(), _specData->data, specData.size() * sizeof(int));
+        }
+
+        const uint64_t key = requestPipelineVariant(passInfo, specData, _config, true);
+        if (!_bind || 0 == key)
+        {
+            return;
+        }
+
+        passInfo.selectedKey = key;
+        if (kInvalidIndex == getElemIndex(m_variantWaitingPasses, _hPass.id))
+        {
+            m_variantWaitingPasses.push_back(_hPass.id);
+        }
     }
 
     void RHIContext_vk::createImage(bx::MemoryReader& _reader)
@@ -2380,6 +3625,10 @@ namespace kage { namespace vk
 
         ImgInitProps_vk initPorps = getImageInitProp(info, m_swapchainFormat, m_depthFormat);
 
+        // the initial data of a single image goes through the transfer queue
+        const bool asyncUpload = m_upload.isValid() && info.pData != nullptr && 1 == info.resCount;
+        initPorps.concurrent = asyncUpload;
+
         stl::vector<Image_vk> images;
         kage::vk::createImage(images, infoList, initPorps);
         assert(images.size() == info.resCount);
@@ -2435,7 +3684,7 @@ namespace kage { namespace vk
 
         if (info.pData != nullptr)
         {
-            uploadImage(info.himg, info.pData, info.size);
+            uploadImage(info.himg, info.pData, info.size, asyncUpload);
         }
 
         KAGE_DELETE_ARRAY(resArr);
@@ -2454,6 +3703,9 @@ namespace kage { namespace vk
         // so the res handle should map to the real buffer array
         stl::vector<BufferAliasInfo> infoList(resArr, resArr + info.resCount);
 
+        // the initial data of a single buffer goes through the transfer queue
+        const bool asyncUpload = m_upload.isValid() && info.pData != nullptr && 1 == info.resCount;
+
         stl::vector<Buffer_vk> buffers;
         kage::vk::createBuffer(
             buffers
@@ -2461,6 +3713,7 @@ namespace kage { namespace vk
             , getBufferUsageFlags(info.usage)
             , getMemPropFlags(info.memFlags)
             , getFormat(info.format)
+            , asyncUpload
         );
 
         assert(buffers.size() == info.resCount);
@@ -2470,6 +3723,11 @@ namespace kage { namespace vk
             buffers[ii].fillVal = info.fillVal;
             m_bufferContainer.addOrUpdate(resArr[ii].hbuf, buffers[ii]);
             m_aliasToBaseBuffers.addOrUpdate(resArr[ii].hbuf, info.hbuf);
+
+            if (info.usage & BufferUsageFlagBits::read_only)
+            {
+                m_readOnlyBuffers.insert(resArr[ii].hbuf.id);
+            }
         }
 
         m_bufferCreateInfos.addOrUpdate(info.hbuf, info);
@@ -2488,13 +3746,18 @@ namespace kage { namespace vk
         // initialize buffer
         if (info.pData != nullptr)
         {
-            uploadBuffer(info.hbuf, info.pData, info.size, 0);
+            uploadBuffer(info.hbuf, info.pData, info.size, 0, asyncUpload);
         }
         else
         {
             fillBuffer(info.hbuf, info.fillVal, info.size);
         }
 
+        if (isReadOnly(info.hbuf))
+        {
+            publishReadOnlyBuffer(info.hbuf);
+        }
+
         KAGE_DELETE_ARRAY(resArr);
     }
 
@@ -2564,6 +3827,13 @@ namespace kage { namespace vk
         );
         assert(sampler);
 
+        {
+            Bindless_vk& ref = m_bindlessContainer.getDataRef(meta.bindlessId);
+            ref.images = imageIds;
+            ref.binding = meta.binding;
+            ref.sampler = sampler;
+        }
+
         for (size_t ii = 0; ii < imageIds.size(); ++ ii)
         {
             const ImageHandle hImg = imageIds[ii];
@@ -2669,6 +3939,11 @@ namespace kage { namespace vk
         brx::setGeoInstances(m_brx, _desc);
     }
 
+    void RHIContext_vk::brx_updateGeoInstances(const Memory* _deltas)
+    {
+        brx::setGeoInstanceDeltas(m_brx, _deltas);
+    }
+
     void RHIContext_vk::brx_regGeoBuffers(const Memory* _bufs)
     {
         brx::setGeoBuffers(m_brx, _bufs);
@@ -3390,27 +4665,27 @@ namespace kage { namespace vk
         return view;
     }
 
-    void RHIContext_vk::createInstance()
+    void RHIContext_vk::createInstance(bool _headless)
     {
         KG_ZoneScopedC(Color::indian_red);
 
-        m_instance = kage::vk::createInstance();
+        m_instance = kage::vk::createInstance(_headless);
         assert(m_instance);
 
         volkLoadInstanceOnly(m_instance);
     }
 
-    void RHIContext_vk::createPhysicalDevice()
+    void RHIContext_vk::createPhysicalDevice(bool _headless)
     {
         VkPhysicalDevice physicalDevices[16];
         uint32_t deviceCount = sizeof(physicalDevices) / sizeof(physicalDevices[0]);
         VK_CHECK(vkEnumeratePhysicalDevices(m_instance, &deviceCount, physicalDevices));
 
-        m_physicalDevice = kage::vk::pickPhysicalDevice(physicalDevices, deviceCount);
+        m_physicalDevice = kage::vk::pickPhysicalDevice(physicalDevices, deviceCount, _headless);
         assert(m_physicalDevice);
     }
 
-    void RHIContext_vk::uploadBuffer(const BufferHandle _hbuf, const void* _data, uint32_t _size, uint32_t _offset)
+    void RHIContext_vk::uploadBuffer(const BufferHandle _hbuf, const void* _data, uint32_t _size, uint32_t _offset, bool _async /*= false*/)
     {
         KG_ZoneScopedC(Color::indian_red);
 
@@ -3425,10 +4700,21 @@ namespace kage { namespace vk
         );
 
         bx::memCopy(scratch.data, _data, _size);
+        m_frameStagingBytes += _size;
 
         VkBufferCopy region = { 0 , _offset, VkDeviceSize(_size) };
 
         const Buffer_vk& buffer = getBuffer(_hbuf);
+
+        // nothing used the buffer yet, the first barrier on it waits for the batch
+        if (_async && m_upload.isValid())
+        {
+            vkCmdCopyBuffer(m_upload.begin(), scratch.buffer, buffer.buffer, 1, &region);
+
+            m_upload.release(scratch);
+            m_barrierDispatcher.markUploaded(buffer.buffer, m_upload.getBatchValue());
+            return;
+        }
         
         m_barrierDispatcher.barrier(buffer.buffer,
             { VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT }
@@ -3447,6 +4733,21 @@ namespace kage { namespace vk
         release(scratch.memory);
     }
 
+    void RHIContext_vk::publishReadOnlyBuffer(const BufferHandle _hbuf)
+    {
+        const VkAccessFlags access = VK_ACCESS_SHADER_READ_BIT
+            | VK_ACCESS_UNIFORM_READ_BIT
+            | VK_ACCESS_INDIRECT_COMMAND_READ_BIT
+            | VK_ACCESS_INDEX_READ_BIT
+            | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT
+            | VK_ACCESS_TRANSFER_READ_BIT;
+
+        m_barrierDispatcher.barrier(getBuffer(_hbuf).buffer,
+            { access, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT }
+        );
+        dispatchBarriers();
+    }
+
     void RHIContext_vk::fillBuffer(const BufferHandle _hbuf, const uint32_t _value, uint32_t _size)
     {
         KG_ZoneScopedC(Color::indian_red);
@@ -3520,7 +4821,7 @@ namespace kage { namespace vk
         return result;
     }
 
-    void RHIContext_vk::uploadImage(const ImageHandle _hImg, const void* _data, uint32_t _size)
+    void RHIContext_vk::uploadImage(const ImageHandle _hImg, const void* _data, uint32_t _size, bool _async /*= false*/)
     {
         KG_ZoneScopedC(Color::indian_red);
 
@@ -3536,18 +4837,11 @@ namespace kage { namespace vk
         );
 
         memcpy(scratch.data, _data, _size);
+        m_frameStagingBytes += _size;
 
         const Image_vk& vkImg = getImage(_hImg);
         const ImageCreateInfo& imgInfo = m_imgCreateInfos.getIdToData(_hImg);
 
-        m_barrierDispatcher.barrier(
-            vkImg.image
-            , vkImg.aspectMask
-            , { VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT }
-        );
-
-        dispatchBarriers();
-
         uint32_t blockSz = (imgInfo.format < ResourceFormat::undefined) ? getBCBlcokSz(vkImg.format) : 0;
         uint32_t size = (imgInfo.format < ResourceFormat::undefined) ? getBCImageSize(vkImg.width, vkImg.height, vkImg.numMips, blockSz) : _size;
 
@@ -3556,10 +4850,27 @@ namespace kage { namespace vk
         uint32_t w = vkImg.width;
         uint32_t h = vkImg.height;
 
+        // plain formats: the texel size comes from the data size, the layers of a mip are packed together
+        uint32_t texelSz = 0;
+        if (0 == blockSz)
+        {
+            uint32_t texelCount = 0;
+            for (uint32_t ii = 0; ii < vkImg.numMips; ++ii)
+            {
+                texelCount += glm::max(1u, vkImg.width >> ii) * glm::max(1u, vkImg.height >> ii) * vkImg.numLayers;
+            }
+            texelSz = _size / texelCount;
+        }
+
+        // a queue without the graphics and compute copies from the 4 bytes aligned offsets only
+        bool aligned = true;
+
         VkBufferImageCopy* regions = (VkBufferImageCopy*)bx::alloc(g_bxAllocator, sizeof(VkBufferImageCopy) * vkImg.numMips);
         bx::memSet(regions, 0, sizeof(VkBufferImageCopy) * vkImg.numMips);
         for (uint32_t ii = 0; ii < vkImg.numMips; ++ii)
         {
+            aligned &= 0 == (bufOffset % 4);
+
             regions[ii].bufferOffset = bufOffset;
             regions[ii].bufferRowLength = 0; // assuming tightly packed already
             regions[ii].bufferImageHeight = 0; // assuming tightly packed already
@@ -3572,11 +4883,43 @@ namespace kage { namespace vk
             regions[ii].imageExtent = {w, h, 1};
             regions[ii].imageOffset = { 0, 0, 0 };
 
-            bufOffset += ((w + 3) / 4) * ((h + 3) / 4) * blockSz;
+            bufOffset += (0 == blockSz)
+                ? w * h * vkImg.numLayers * texelSz
+                : ((w + 3) / 4) * ((h + 3) / 4) * blockSz;
 
             w = (w > 1) ? (w >> 1) : 1;
             h = (h > 1) ? (h >> 1) : 1;
         }
+
+        // nothing used the image yet, the first barrier on it waits for the batch and leaves the transfer dst layout
+        if (_async && aligned && m_upload.isValid())
+        {
+            VkCommandBuffer cmd = m_upload.begin();
+
+            VkImageMemoryBarrier2 toDst = imageBarrier(
+                vkImg.image
+                , vkImg.aspectMask
+                , 0, VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT
+                , VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT
+            );
+            pipelineBarrier(cmd, 0, 0, nullptr, 0, nullptr, 1, &toDst);
+
+            vkCmdCopyBufferToImage(cmd, scratch.buffer, vkImg.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, vkImg.numMips, regions);
+
+            bx::free(g_bxAllocator, regions);
+            m_upload.release(scratch);
+            m_barrierDispatcher.markUploaded(vkImg.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, m_upload.getBatchValue());
+            return;
+        }
+
+        m_barrierDispatcher.barrier(
+            vkImg.image
+            , vkImg.aspectMask
+            , { VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT }
+        );
+
+        dispatchBarriers();
+
         vkCmdCopyBufferToImage(m_cmdBuffer, scratch.buffer, vkImg.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, vkImg.numMips, regions);
         
         // write flush
@@ -3592,6 +4935,217 @@ namespace kage { namespace vk
         release(scratch.memory);
     }
 
+    void RHIContext_vk::updateImageMips(
+        const ImageHandle _hImg
+        , const uint16_t _width
+        , const uint16_t _height
+        , const uint16_t _numMips
+        , const Memory* _mem
+    )
+    {
+        KG_ZoneScopedC(Color::indian_red);
+
+        if (!m_imageContainer.exist(_hImg))
+        {
+            message(info, "updateImageMips will not perform for image %d! It might be useless after render pass sorted", _hImg.id);
+            return;
+        }
+
+        const ImageHandle baseImg = { m_aliasToBaseImages.getIdToData(_hImg) };
+        if (baseImg.id != _hImg.id || m_imgToAliases.find(baseImg)->second.size() > 1)
+        {
+            message(warning, "updateImageMips: image 0x%x has aliases, skipping", _hImg.id);
+            return;
+        }
+
+        const Image_vk oldImg = m_imageContainer.getIdToData(_hImg);
+        if (oldImg.width == _width && oldImg.height == _height && oldImg.numMips == _numMips)
+        {
+            return;
+        }
+
+        // the mips [0, shift) of the new image are not in the old one
+        const int32_t shift = int32_t(_numMips) - int32_t(oldImg.numMips);
+        if (shift > 0 && (nullptr == _mem || 0 == _mem->size))
+        {
+            message(error, "updateImageMips: image 0x%x gains %d mips without data", _hImg.id, shift);
+            return;
+        }
+
+        if (!m_imageSwapWaited)
+        {
+            kick(true);
+            m_imageSwapWaited = true;
+        }
+
+        ImageCreateInfo& ci = m_imgCreateInfos.getDataRef(_hImg);
+        ci.width = _width;
+        ci.height = _height;
+        ci.numMips = _numMips;
+
+        ImgInitProps_vk initPorps = getImageInitProp(ci, m_swapchainFormat, m_depthFormat);
+
+        stl::vector<ImageAliasInfo> aliasInfos(1);
+        aliasInfos[0].himg = _hImg;
+
+        stl::vector<Image_vk> imageVks;
+        kage::vk::createImage(imageVks, aliasInfos, initPorps);
+        const Image_vk& newImg = imageVks[0];
+
+        m_barrierDispatcher.track(newImg.image, newImg.aspectMask, {});
+
+        m_barrierDispatcher.barrier(
+            oldImg.image
+            , oldImg.aspectMask
+            , { VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT }
+        );
+        m_barrierDispatcher.barrier(
+            newImg.image
+            , newImg.aspectMask
+            , { VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT }
+        );
+        dispatchBarriers();
+
+        // the shared mips
+        stl::vector<VkImageCopy> copies;
+        for (int32_t ii = glm::max(shift, 0); ii < int32_t(_numMips); ++ii)
+        {
+            const int32_t src = ii - shift;
+            if (src < 0 || src >= int32_t(oldImg.numMips))
+            {
+                continue;
+            }
+
+            VkImageCopy copy{};
+            copy.srcSubresource = { oldImg.aspectMask, uint32_t(src), 0, oldImg.numLayers };
+            copy.dstSubresource = { newImg.aspectMask, uint32_t(ii), 0, newImg.numLayers };
+            copy.extent = { glm::max(1u, newImg.width >> ii), glm::max(1u, newImg.height >> ii), 1 };
+            copies.push_back(copy);
+        }
+
+        if (!copies.empty())
+        {
+            vkCmdCopyImage(m_cmdBuffer
+                , oldImg.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+                , newImg.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
+                , (uint32_t)copies.size(), copies.data()
+            );
+        }
+
+        // the new finer mips, tightly packed like the uploadImage
+        Buffer_vk scratch{};
+        if (shift > 0)
+        {
+            BufferAliasInfo bai;
+            bai.size = _mem->size;
+            scratch = kage::vk::createBuffer(
+                bai
+                , VK_BUFFER_USAGE_TRANSFER_SRC_BIT
+                , VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+            );
+            memcpy(scratch.data, _mem->data, _mem->size);
+
+            const uint32_t blockSz = (ci.format < ResourceFormat::undefined) ? getBCBlcokSz(newImg.format) : 0;
+
+            uint32_t texelSz = 0;
+            if (0 == blockSz)
+            {
+                uint32_t texelCount = 0;
+                for (int32_t ii = 0; ii < shift; ++ii)
+                {
+                    texelCount += glm::max(1u, newImg.width >> ii) * glm::max(1u, newImg.height >> ii) * newImg.numLayers;
+                }
+                texelSz = _mem->size / texelCount;
+            }
+
+            stl::vector<VkBufferImageCopy> regions(shift);
+            uint32_t bufOffset = 0;
+            for (int32_t ii = 0; ii < shift; ++ii)
+            {
+                const uint32_t w = glm::max(1u, newImg.width >> ii);
+                const uint32_t h = glm::max(1u, newImg.height >> ii);
+
+                VkBufferImageCopy& region = regions[ii];
+                region = {};
+                region.bufferOffset = bufOffset;
+                region.imageSubresource = { newImg.aspectMask, uint32_t(ii), 0, newImg.numLayers };
+                region.imageExtent = { w, h, 1 };
+
+                bufOffset += (0 == blockSz)
+                    ? w * h * newImg.numLayers * texelSz
+                    : ((w + 3) / 4) * ((h + 3) / 4) * blockSz;
+            }
+            assert(bufOffset == _mem->size);
+
+            vkCmdCopyBufferToImage(m_cmdBuffer, scratch.buffer, newImg.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, (uint32_t)regions.size(), regions.data());
+        }
+
+        // the bindless arrays expect the shader read only
+        m_barrierDispatcher.barrier(
+            newImg.image
+            , newImg.aspectMask
+            , { VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT }
+        );
+        dispatchBarriers();
+
+        // the old one is only released after the frame is done
+        {
+            Image_vk& imgVk = m_imageContainer.getDataRef(_hImg);
+            m_barrierDispatcher.untrack(imgVk.image);
+
+            release(imgVk.defaultView);
+            release(imgVk.image);
+            release(imgVk.memory);
+
+            m_imgViewCache.invalidateWithParent(_hImg.id);
+        }
+
+        if (shift > 0)
+        {
+            release(scratch.buffer);
+            release(scratch.memory);
+        }
+
+        m_imageContainer.update(_hImg, newImg);
+        m_memTelemetryDirty = true;
+        refreshDebugNameObject(m_device, oldImg.image, newImg.image);
+
+        rewriteBindlessImage(_hImg, newImg);
+
+        message(info, "update image mips : %04x, %dx%d, %d mips", _hImg.id, _width, _height, _numMips);
+    }
+
+    void RHIContext_vk::rewriteBindlessImage(const ImageHandle _hImg, const Image_vk& _img)
+    {
+        for (uint32_t ii = 0; ii < m_bindlessContainer.size(); ++ii)
+        {
+            const Bindless_vk& bindless = m_bindlessContainer.getIdToData(m_bindlessContainer.getIdAt(ii));
+
+            for (uint32_t jj = 0; jj < (uint32_t)bindless.images.size(); ++jj)
+            {
+                if (bindless.images[jj].id != _hImg.id)
+                {
+                    continue;
+                }
+
+                VkDescriptorImageInfo imgInfo{};
+                imgInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+                imgInfo.imageView = _img.defaultView;
+                imgInfo.sampler = bindless.sampler;
+
+                VkWriteDescriptorSet write{};
+                write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                write.dstSet = bindless.set;
+                write.dstBinding = bindless.binding;
+                write.dstArrayElement = jj + 1; // 0 is reserved for invalid image
+                write.descriptorCount = 1;
+                write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+                write.pImageInfo = &imgInfo;
+                vkUpdateDescriptorSets(m_device, 1, &write, 0, nullptr);
+            }
+        }
+    }
+
     void RHIContext_vk::checkUnmatchedBarriers(uint16_t _passId)
     {
         KG_ZoneScopedC(Color::indian_red);
@@ -3794,7 +5348,7 @@ namespace kage { namespace vk
                     , img.aspectMask
                     , bs);
             }
-            else if (ResourceType::buffer == binding.type)
+            else if (ResourceType::buffer == binding.type && !isReadOnly(binding.buf))
             {
                 const Buffer_vk& buf = getBuffer(binding.buf);
                 m_barrierDispatcher.barrier(buf.buffer, bs);
@@ -4223,6 +5777,16 @@ namespace kage { namespace vk
         return it->second;
     }
 
+    double RHIContext_vk::getPassRecordTime(const PassHandle _hPass)
+    {
+        auto it = m_passRecordTime.find(_hPass.id);
+        if (m_passRecordTime.end() == it)
+        {
+            return 0.0;
+        }
+        return it->second;
+    }
+
     double RHIContext_vk::getGPUTime()
     {
         return m_gpuTime;
@@ -4416,6 +5980,121 @@ namespace kage { namespace vk
     }
 
 
+    void RHIContext_vk::recordReadback(uint32_t _swapImgIdx)
+    {
+        KG_ZoneScopedC(Color::indian_red);
+
+        const uint32_t width = m_swapchain.m_resolution.width;
+        const uint32_t height = m_swapchain.m_resolution.height;
+        const uint32_t size = width * height * 4;
+
+        if (m_readbackBuf.size < size)
+        {
+            if (m_readbackBuf.buffer)
+            {
+                release(m_readbackBuf.buffer);
+                release(m_readbackBuf.memory);
+            }
+
+            BufferAliasInfo info{};
+            info.size = size;
+
+            m_readbackBuf = kage::vk::createBuffer(
+                info
+                , VK_BUFFER_USAGE_TRANSFER_DST_BIT
+                , VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+            );
+        }
+
+        const VkImage swapImg = m_swapchain.m_swapchainImages[_swapImgIdx];
+        m_barrierDispatcher.barrier(
+            swapImg, VK_IMAGE_ASPECT_COLOR_BIT,
+            { VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT }
+        );
+
+        dispatchBarriers();
+
+        VkBufferImageCopy region = {};
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent = { width, height, 1 };
+
+        vkCmdCopyImageToBuffer(m_cmdBuffer, swapImg, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, m_readbackBuf.buffer, 1, &region);
+
+        // back to present
+        m_barrierDispatcher.barrier(
+            swapImg, VK_IMAGE_ASPECT_COLOR_BIT,
+            { 0, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT }
+        );
+
+        dispatchBarriers();
+    }
+
+    void RHIContext_vk::writeReadback()
+    {
+        KG_ZoneScopedC(Color::indian_red);
+
+        m_readbackRequested = false;
+
+        const uint32_t width = m_swapchain.m_resolution.width;
+        const uint32_t height = m_swapchain.m_resolution.height;
+        const uint32_t numPixels = width * height;
+
+        // the swapchain might be bgra, write rgba anyway
+        const bool bgra = (VK_FORMAT_B8G8R8A8_UNORM == m_swapchainFormat);
+        const uint8_t* src = (const uint8_t*)m_readbackBuf.data;
+
+        const bool exr = 0 == bx::strCmpI(m_readbackPath.getExt(), ".exr");
+
+        bx::FileWriter writer;
+        bx::Error err;
+        if (!bx::open(&writer, m_readbackPath, false, &err))
+        {
+            message(error, "failed to open %s for the readback", m_readbackPath.getCPtr());
+            return;
+        }
+
+        if (exr)
+        {
+            // the present image is display referred, it is stored as is
+            stl::vector<uint16_t> pixels(numPixels * 4);
+            for (uint32_t ii = 0; ii < numPixels; ++ii)
+            {
+                const uint8_t* texel = &src[ii * 4];
+                pixels[ii * 4 + 0] = bx::halfFromFloat(float(texel[bgra ? 2 : 0]) / 255.f);
+                pixels[ii * 4 + 1] = bx::halfFromFloat(float(texel[1]) / 255.f);
+                pixels[ii * 4 + 2] = bx::halfFromFloat(float(texel[bgra ? 0 : 2]) / 255.f);
+                pixels[ii * 4 + 3] = bx::halfFromFloat(float(texel[3]) / 255.f);
+            }
+
+            bimg::imageWriteExr(&writer, width, height, width * 8, pixels.data(), bimg::TextureFormat::RGBA16F, false, &err);
+        }
+        else
+        {
+            stl::vector<uint8_t> pixels(numPixels * 4);
+            for (uint32_t ii = 0; ii < numPixels; ++ii)
+            {
+                const uint8_t* texel = &src[ii * 4];
+                pixels[ii * 4 + 0] = texel[bgra ? 2 : 0];
+                pixels[ii * 4 + 1] = texel[1];
+                pixels[ii * 4 + 2] = texel[bgra ? 0 : 2];
+                pixels[ii * 4 + 3] = 255;
+            }
+
+            bimg::imageWritePng(&writer, width, height, width * 4, pixels.data(), bimg::TextureFormat::RGBA8, false, &err);
+        }
+
+        bx::close(&writer);
+
+        if (!err.isOk())
+        {
+            message(error, "failed to write the readback to %s", m_readbackPath.getCPtr());
+            return;
+        }
+
+        message(info, "readback written to %s", m_readbackPath.getCPtr());
+    }
+
     template<typename Ty>
     void RHIContext_vk::release(Ty& _object)
     {
@@ -4748,6 +6427,8 @@ namespace kage { namespace vk
             }
         }
 
+        m_uploadedBuffers.erase(_buf);
+
         // untrack the alias
         {
             using Iter = decltype(m_aliasToBaseBuffers)::iterator;
@@ -4775,6 +6456,8 @@ namespace kage { namespace vk
             }
         }
 
+        m_uploadedImages.erase(_img);
+
         // untrack the alias
         {
             using Iter = decltype(m_aliasToBaseImages)::iterator;
@@ -5062,6 +6745,13 @@ namespace kage { namespace vk
         
         validate(_buf, _dst);
 
+        auto uploaded = m_uploadedBuffers.find(_buf);
+        if (uploaded != m_uploadedBuffers.end())
+        {
+            acquireUploaded(m_trackingBuffers[_buf].srcState, _dst, uploaded->second);
+            m_uploadedBuffers.erase(uploaded);
+        }
+
         BarrierState_vk& bs = m_trackingBuffers[_buf].dstState;
 
         bs.accessMask |= _dst.accessMask;
@@ -5085,11 +6775,87 @@ namespace kage { namespace vk
         BarrierState_vk& src = m_trackingImages[_img].srcState;
         BarrierState_vk& dst = m_trackingImages[_img].dstState;
 
+        auto uploaded = m_uploadedImages.find(_img);
+        if (uploaded != m_uploadedImages.end())
+        {
+            acquireUploaded(src, _dstBarrier, uploaded->second);
+            m_uploadedImages.erase(uploaded);
+        }
+
         dst.accessMask |= _dstBarrier.accessMask;
         dst.stageMask |= _dstBarrier.stageMask;
         dst.imgLayout = _dstBarrier.imgLayout;
     }
 
+    void BarrierDispatcher::markUploaded(const VkBuffer _buf, uint64_t _value)
+    {
+        BX_ASSERT(
+            m_trackingBuffers.find(_buf) != m_trackingBuffers.end()
+            , "buffer: %s not tracking! track it first!"
+            , getLocalDebugName(_buf)
+        );
+
+        // nothing on this queue touched it
+        BufferStatus& st = m_trackingBuffers[_buf];
+        st.srcState = BarrierState_vk{};
+
+        auto base = m_baseBufferStatus.find(_buf);
+        if (base != m_baseBufferStatus.end())
+        {
+            base->second = st;
+        }
+
+        m_uploadedBuffers[_buf] = _value;
+    }
+
+    void BarrierDispatcher::markUploaded(const VkImage _img, VkImageLayout _layout, uint64_t _value)
+    {
+        BX_ASSERT(
+            m_trackingImages.find(_img) != m_trackingImages.end()
+            , "image: %s not tracking! track it first!"
+            , getLocalDebugName(_img)
+        );
+
+        ImageStatus& st = m_trackingImages[_img];
+        st.srcState = BarrierState_vk{ 0, _layout, 0 };
+
+        auto base = m_baseImageStatus.find(_img);
+        if (base != m_baseImageStatus.end())
+        {
+            base->second = st;
+        }
+
+        m_uploadedImages[_img] = _value;
+    }
+
+    void BarrierDispatcher::acquireUploaded(BarrierState_vk& _src, const BarrierState_vk& _dst, uint64_t _value)
+    {
+        // the semaphore wait makes the copies visible at its stage, the barrier chains from there
+        const VkPipelineStageFlags stages = (0 != _dst.stageMask) ? _dst.stageMask : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+        _src.accessMask = 0;
+        _src.stageMask |= stages;
+
+        m_uploadWaitValue = bx::max(m_uploadWaitValue, _value);
+        m_uploadWaitStages |= stages;
+    }
+
+    bool BarrierDispatcher::takeUploadWait(uint64_t& _value, VkPipelineStageFlags& _stages)
+    {
+        if (0 == m_uploadWaitValue)
+        {
+            return false;
+        }
+
+        _value = m_uploadWaitValue;
+        _stages = m_uploadWaitStages;
+
+        m_uploadWaitValue = 0;
+        m_uploadWaitStages = 0;
+
+        return true;
+    }
+
     void BarrierDispatcher::dispatchGlobalBarrier(const VkCommandBuffer& _cmdBuffer, const BarrierState_vk& _src, const BarrierState_vk& _dst)
     {
         VkMemoryBarrier2 ba = memoryBarrier(
@@ -5417,6 +7183,14 @@ namespace kage { namespace vk
         m_timestampQueryPoolCount = _passCount * 2;
         m_passCount = _passCount;
 
+        // the pass count changes with a new bake, the old pools are no longer readable
+        for (uint32_t ii = 0; ii < m_numFramesInFlight; ++ii)
+        {
+            s_renderVK->release(m_commandList[ii].m_statisticsQueryPool);
+            s_renderVK->release(m_commandList[ii].m_timestampQueryPool);
+            m_commandList[ii].m_queriesIssued = false;
+        }
+
         if (m_statisticsQueryCount > 0) {
             for (uint32_t ii = 0; ii < m_numFramesInFlight; ++ii) {
                 m_commandList[ii].m_statisticsQueryPool =
@@ -5443,7 +7217,9 @@ namespace kage { namespace vk
             const VkDevice device = s_renderVK->m_device;
             CommandList& commandList = m_commandList[m_currentFrameInFlight];
 
-            VK_CHECK(vkWaitForFences(device, 1, &commandList.m_fence, VK_TRUE, UINT64_MAX));
+            const VkResult waitResult = vkWaitForFences(device, 1, &commandList.m_fence, VK_TRUE, UINT64_MAX);
+            s_renderVK->checkDeviceLost(waitResult);
+            VK_CHECK(waitResult);
 
             fetchQueryResults();
 
@@ -5469,12 +7245,13 @@ namespace kage { namespace vk
         }
     }
 
-    void CommandQueue_vk::addWaitSemaphore(VkSemaphore _semaphore, VkPipelineStageFlags _stage)
+    void CommandQueue_vk::addWaitSemaphore(VkSemaphore _semaphore, VkPipelineStageFlags _stage, uint64_t _value /*= 0*/)
     {
         BX_ASSERT(m_numWaitSemaphores < BX_COUNTOF(m_waitSemaphores), "Too many wait semaphores.");
 
         m_waitSemaphores[m_numWaitSemaphores] = _semaphore;
         m_waitSemaphoreStages[m_numWaitSemaphores] = _stage;
+        m_waitSemaphoreValues[m_numWaitSemaphores] = _value;
         m_numWaitSemaphores++;
     }
 
@@ -5486,46 +7263,73 @@ namespace kage { namespace vk
         m_numSignalSemaphores++;
     }
 
-    void CommandQueue_vk::fetchQueryResults()
+    // read _count queries as value and availability pairs, false if any of them is not available yet
+    static bool getAvailableQueryResults(VkQueryPool _pool, uint32_t _count, stl::vector<uint64_t>& _data, stl::vector<uint64_t>& _results)
     {
-        // !!!TODO: figure out how to remove VK_QUERY_RESULT_WAIT_BIT
-        // this makes the rendering frames in flight stalled.
         const VkDevice device = s_renderVK->m_device;
-        
+
+        _data.resize(_count * 2);
+
+        VkResult result = vkGetQueryPoolResults(
+            device
+            , _pool
+            , 0
+            , _count
+            , sizeof(uint64_t) * _data.size()
+            , _data.data()
+            , sizeof(uint64_t) * 2
+            , VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT
+        );
+        BX_ASSERT(VK_SUCCESS == result || VK_NOT_READY == result, "vkGetQueryPoolResults(...); VK error 0x%x", result);
+
+        for (uint32_t ii = 0; ii < _count; ++ii)
+        {
+            if (0 == _data[ii * 2 + 1])
+            {
+                return false;
+            }
+        }
+
+        _results.resize(_count);
+        for (uint32_t ii = 0; ii < _count; ++ii)
+        {
+            _results[ii] = _data[ii * 2];
+        }
+
+        return true;
+    }
+
+    void CommandQueue_vk::fetchQueryResults()
+    {
+        // the fence of the frame is signaled already, the results are usually there
+        // if they are not, the frame is dropped from the timings instead of stalling on it
+        m_queryResultsReady = false;
+
+        CommandList& commandList = m_commandList[m_currentFrameInFlight];
+        if (!commandList.m_queriesIssued)
+        {
+            return;
+        }
+        commandList.m_queriesIssued = false;
+
+        bool ready = true;
+
         if(m_statisticsQueryCount > 0)
         {
-            m_statistics.clear();
-            m_statistics.resize(m_passCount);
-
-            VK_CHECK(vkGetQueryPoolResults(
-                device
-                , m_currStatisticsQueryPool
-                , 0
-                , (uint32_t)m_statistics.size()
-                , sizeof(uint64_t) * m_statistics.size()
-                , m_statistics.data()
-                , sizeof(uint64_t)
-                , VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT
-            ));
+            ready &= getAvailableQueryResults(commandList.m_statisticsQueryPool, m_passCount, m_queryData, m_statistics);
         }
 
         if (m_timestampQueryPoolCount > 0)
         {
-            m_timestamps.clear();
-            m_timestamps.resize(m_passCount + 1);
+            ready &= getAvailableQueryResults(commandList.m_timestampQueryPool, m_passCount + 1, m_queryData, m_timestamps);
+        }
 
+        m_queryResultsReady = ready;
+    }
 
-            VK_CHECK(vkGetQueryPoolResults(
-                device
-                , m_currTimestampQueryPool
-                , 0
-                , (uint32_t)m_timestamps.size()
-                , sizeof(uint64_t) * m_timestamps.size()
-                , m_timestamps.data()
-                , sizeof(uint64_t)
-                , VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT
-            ));
-        }
+    void CommandQueue_vk::markQueriesIssued()
+    {
+        m_commandList[m_currentFrameInFlight].m_queriesIssued = true;
     }
 
     void CommandQueue_vk::kick(bool _wait)
@@ -5548,9 +7352,18 @@ namespace kage { namespace vk
 
             VK_CHECK(vkResetFences(device, 1, &m_completedFence));
 
+            // the values of the binary semaphores are ignored
+            const uint64_t signalValues[kMaxNumFrameBuffers] = {};
+
+            VkTimelineSemaphoreSubmitInfo tsi = { VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO };
+            tsi.waitSemaphoreValueCount = m_numWaitSemaphores;
+            tsi.pWaitSemaphoreValues = m_waitSemaphoreValues;
+            tsi.signalSemaphoreValueCount = m_numSignalSemaphores;
+            tsi.pSignalSemaphoreValues = signalValues;
+
             VkSubmitInfo si;
             si.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-            si.pNext = NULL;
+            si.pNext = &tsi;
             si.waitSemaphoreCount = m_numWaitSemaphores;
             si.pWaitSemaphores = &m_waitSemaphores[0];
             si.pWaitDstStageMask = m_waitSemaphoreStages;
@@ -5562,11 +7375,15 @@ namespace kage { namespace vk
             m_numWaitSemaphores = 0;
             m_numSignalSemaphores = 0;
 
-            VK_CHECK(vkQueueSubmit(m_queue, 1, &si, m_completedFence));
+            const VkResult submitResult = vkQueueSubmit(m_queue, 1, &si, m_completedFence);
+            s_renderVK->checkDeviceLost(submitResult);
+            VK_CHECK(submitResult);
 
             if (_wait)
             {
-                VK_CHECK(vkWaitForFences(device, 1, &m_completedFence, VK_TRUE, UINT64_MAX));
+                const VkResult waitResult = vkWaitForFences(device, 1, &m_completedFence, VK_TRUE, UINT64_MAX);
+                s_renderVK->checkDeviceLost(waitResult);
+                VK_CHECK(waitResult);
             }
 
             m_activeCommandBuffer = VK_NULL_HANDLE;
@@ -5633,6 +7450,172 @@ namespace kage { namespace vk
     }
 
 
+    void UploadQueue_vk::init(uint32_t _familyIdx, VkQueue _queue)
+    {
+        KG_ZoneScopedC(Color::indian_red);
+
+        const VkDevice device = s_renderVK->m_device;
+
+        m_familyIdx = _familyIdx;
+        m_queue = _queue;
+        m_submitted = 0;
+        m_current = 0;
+        m_recording = false;
+
+        VkSemaphoreTypeCreateInfo stci = { VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO };
+        stci.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+        stci.initialValue = 0;
+
+        VkSemaphoreCreateInfo sci = { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+        sci.pNext = &stci;
+        VK_CHECK(vkCreateSemaphore(device, &sci, s_renderVK->m_allocatorCb, &m_timeline));
+        setDebugObjName(device, m_timeline, "Semaphore_Upload");
+
+        VkCommandPoolCreateInfo cpci = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+        cpci.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        cpci.queueFamilyIndex = m_familyIdx;
+
+        VkCommandBufferAllocateInfo cbai = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+        cbai.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        cbai.commandBufferCount = 1;
+
+        for (uint32_t ii = 0; ii < kUploadBatchCount; ++ii)
+        {
+            Batch& batch = m_batches[ii];
+
+            VK_CHECK(vkCreateCommandPool(device, &cpci, s_renderVK->m_allocatorCb, &batch.m_commandPool));
+
+            cbai.commandPool = batch.m_commandPool;
+            VK_CHECK(vkAllocateCommandBuffers(device, &cbai, &batch.m_commandBuffer));
+
+            batch.m_value = 0;
+        }
+    }
+
+    void UploadQueue_vk::shutdown()
+    {
+        if (!isValid())
+        {
+            return;
+        }
+
+        flush();
+
+        const VkDevice device = s_renderVK->m_device;
+
+        VkSemaphoreWaitInfo swi = { VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO };
+        swi.semaphoreCount = 1;
+        swi.pSemaphores = &m_timeline;
+        swi.pValues = &m_submitted;
+        VK_CHECK(vkWaitSemaphores(device, &swi, UINT64_MAX));
+
+        for (uint32_t ii = 0; ii < kUploadBatchCount; ++ii)
+        {
+            Batch& batch = m_batches[ii];
+
+            for (const Buffer_vk& staging : batch.m_staging)
+            {
+                destroyBuffer({ staging });
+            }
+            batch.m_staging.clear();
+
+            batch.m_commandBuffer = VK_NULL_HANDLE;
+            vkDestroy(batch.m_commandPool);
+        }
+
+        vkDestroy(m_timeline);
+        m_queue = VK_NULL_HANDLE;
+    }
+
+    VkCommandBuffer UploadQueue_vk::begin()
+    {
+        Batch& batch = m_batches[m_current];
+
+        if (!m_recording)
+        {
+            KG_ZoneScopedC(Color::indian_red);
+
+            const VkDevice device = s_renderVK->m_device;
+
+            // the batch is recycled, its copies must be done
+            if (batch.m_value > 0)
+            {
+                VkSemaphoreWaitInfo swi = { VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO };
+                swi.semaphoreCount = 1;
+                swi.pSemaphores = &m_timeline;
+                swi.pValues = &batch.m_value;
+                VK_CHECK(vkWaitSemaphores(device, &swi, UINT64_MAX));
+            }
+
+            for (const Buffer_vk& staging : batch.m_staging)
+            {
+                destroyBuffer({ staging });
+            }
+            batch.m_staging.clear();
+
+            VK_CHECK(vkResetCommandPool(device, batch.m_commandPool, 0));
+
+            VkCommandBufferBeginInfo cbi = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+            cbi.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+            VK_CHECK(vkBeginCommandBuffer(batch.m_commandBuffer, &cbi));
+
+            m_recording = true;
+        }
+
+        return batch.m_commandBuffer;
+    }
+
+    void UploadQueue_vk::release(const Buffer_vk& _staging)
+    {
+        m_batches[m_current].m_staging.push_back(_staging);
+    }
+
+    uint64_t UploadQueue_vk::getPendingBytes() const
+    {
+        uint64_t result = 0;
+        for (const Batch& batch : m_batches)
+        {
+            for (const Buffer_vk& staging : batch.m_staging)
+            {
+                result += staging.size;
+            }
+        }
+
+        return result;
+    }
+
+    void UploadQueue_vk::flush()
+    {
+        if (!m_recording)
+        {
+            return;
+        }
+
+        KG_ZoneScopedC(Color::indian_red);
+
+        Batch& batch = m_batches[m_current];
+
+        VK_CHECK(vkEndCommandBuffer(batch.m_commandBuffer));
+
+        batch.m_value = ++m_submitted;
+
+        VkTimelineSemaphoreSubmitInfo tsi = { VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO };
+        tsi.signalSemaphoreValueCount = 1;
+        tsi.pSignalSemaphoreValues = &batch.m_value;
+
+        VkSubmitInfo si = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
+        si.pNext = &tsi;
+        si.commandBufferCount = 1;
+        si.pCommandBuffers = &batch.m_commandBuffer;
+        si.signalSemaphoreCount = 1;
+        si.pSignalSemaphores = &m_timeline;
+
+        VK_CHECK(vkQueueSubmit(m_queue, 1, &si, VK_NULL_HANDLE));
+
+        m_current = (m_current + 1) % kUploadBatchCount;
+        m_recording = false;
+    }
+
     void ScratchBuffer::create(uint32_t _size, uint32_t _count)
 {
         const VkPhysicalDeviceMemoryProperties memProps = s_renderVK->m_memProps;
@@ -5695,6 +7678,94 @@ namespace kage { namespace vk
         release(m_buf.memory);
     }
 
+    void Breadcrumbs_vk::create(uint32_t _passCount, bool _bufferMarker)
+    {
+        KG_ZoneScopedC(Color::indian_red);
+
+        destroy();
+
+        m_passCount = _passCount;
+        m_bufferMarker = _bufferMarker;
+        bx::memSet(m_serials, 0, sizeof(m_serials));
+
+        if (0 == m_passCount)
+        {
+            return;
+        }
+
+        // a begin and an end slot per pass
+        BufferAliasInfo bai;
+        bai.size = sizeof(uint32_t) * 2 * m_passCount * kMaxNumFrameLatency;
+        m_buf = kage::vk::createBuffer(
+            bai
+            , VK_BUFFER_USAGE_TRANSFER_DST_BIT
+            , VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+        );
+
+        bx::memSet(m_buf.data, 0, bai.size);
+
+        setDebugObjName(s_renderVK->m_device, m_buf.buffer, "Buf_Breadcrumbs");
+    }
+
+    void Breadcrumbs_vk::destroy()
+    {
+        if (isValid())
+        {
+            destroyBuffer({ m_buf });
+            m_buf = {};
+        }
+
+        m_passCount = 0;
+    }
+
+    void Breadcrumbs_vk::begin(uint32_t _frame, uint64_t _serial)
+    {
+        m_frame = _frame;
+
+        // 0 is the cleared slot
+        m_serials[_frame] = bx::max<uint32_t>(1, uint32_t(_serial));
+    }
+
+    void Breadcrumbs_vk::mark(VkCommandBuffer _cmdBuf, uint32_t _passIdx, bool _end)
+    {
+        if (!isValid() || _passIdx >= m_passCount)
+        {
+            return;
+        }
+
+        const VkDeviceSize offset = sizeof(uint32_t) * ((m_frame * m_passCount + _passIdx) * 2 + (_end ? 1 : 0));
+
+        if (m_bufferMarker)
+        {
+            const VkPipelineStageFlagBits stage = _end
+                ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT
+                : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT
+                ;
+
+            vkCmdWriteBufferMarkerAMD(_cmdBuf, stage, m_buf.buffer, offset, m_serials[m_frame]);
+        }
+        else
+        {
+            vkCmdFillBuffer(_cmdBuf, m_buf.buffer, offset, sizeof(uint32_t), m_serials[m_frame]);
+        }
+    }
+
+    Breadcrumbs_vk::State Breadcrumbs_vk::getState(uint32_t _frame, uint32_t _passIdx) const
+    {
+        const uint32_t* slots = (const uint32_t*)m_buf.data + (_frame * m_passCount + _passIdx) * 2;
+        const uint32_t serial = m_serials[_frame];
+
+        if (slots[1] == serial)
+        {
+            return State::finished;
+        }
+
+        return slots[0] == serial
+            ? State::running
+            : State::not_started
+            ;
+    }
+
     void FrameRecCmds::init()
     {
         start();
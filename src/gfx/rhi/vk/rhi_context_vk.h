@@ -5,6 +5,7 @@
 #include "core/kage_inner.h"
 
 #include "volk.h"
+#include "bx/filepath.h"
 
 #include "vk_resource.h"
 #include "vk_device.h"
@@ -18,6 +19,9 @@
 #include "gfx/command_buffer.h"
 #include "ffx_intg/brixel_intg_vk.h"
 
+#include <vector>
+#include <future>
+
 namespace kage { namespace vk
 {
     template<typename Ty>
@@ -86,12 +90,57 @@ namespace kage { namespace vk
         VkDescriptorSet         set{ VK_NULL_HANDLE };
         uint32_t                setIdx{ 0 };
         uint32_t                setCount{ 0 };
+
+        // to rewrite the descriptor of an image that is re-created
+        stl::vector<ImageHandle> images;
+        uint32_t                binding{ 0 };
+        VkSampler               sampler{ VK_NULL_HANDLE };
     };
 
-    struct PassInfo_vk : PassDesc
+    // everything a pipeline is made of, copied so it can be compiled off the render thread
+    struct PipelineBuildInfo_vk
+    {
+        PassExeQueue queue{ PassExeQueue::graphics };
+        VkPipelineLayout layout{ VK_NULL_HANDLE };
+        stl::vector<Shader_vk> shaders;
+
+        // graphics only
+        stl::vector<VkFormat> colorFormats;
+        VkFormat depthFormat{ VK_FORMAT_UNDEFINED };
+        stl::vector<VkVertexInputBindingDescription> vertexBindings;
+        stl::vector<VkVertexInputAttributeDescription> vertexAttributes;
+        PipelineConfigs_vk configs{};
+
+        stl::vector<int> specData;
+    };
+
+    // a pipeline in the variant cache, keyed by the program and the hash of the build info
+    struct PipelineVariant_vk
     {
         VkPipeline pipeline{};
 
+        // to rebuild it on the shader reload, the formats and the vertex input come from the pass
+        uint16_t passId{ kInvalidHandle };
+        uint16_t prog{ kInvalidHandle };
+        stl::vector<int> specData;
+        GraphicsPipelineConfig config{};
+
+        bool compiling{ false };
+    };
+
+    struct PipelineCompileJob_vk
+    {
+        uint64_t key;
+        std::future<VkPipeline> pipeline;
+    };
+
+    struct PassInfo_vk : PassDesc
+    {
+        VkPipeline pipeline{}; // owned by the variant cache
+
+        uint64_t pipelineKey{ 0 }; // the variant bound
+        uint64_t selectedKey{ 0 }; // bound once it is compiled, the bound one is the fallback until then
+
         uint16_t passId{ kInvalidHandle };
         uint16_t vertexBufferId{ kInvalidHandle };
         uint16_t indexBufferId{ kInvalidHandle };
@@ -215,6 +264,14 @@ namespace kage { namespace vk
             , const BarrierState_vk& _dst
         );
 
+        // written on the transfer queue in the batch of _value, the image is left in _layout
+        // the first barrier on it waits for the batch from its own dst stage
+        void markUploaded(const VkBuffer _buf, uint64_t _value);
+        void markUploaded(const VkImage _img, VkImageLayout _layout, uint64_t _value);
+
+        // the batch value and the stages the next submit waits at, false if there is nothing to wait for
+        bool takeUploadWait(uint64_t& _value, VkPipelineStageFlags& _stages);
+
         VkImageLayout getCurrentImageLayout(const VkImage _img) const;
         BarrierState_vk getBarrierState(const VkImage _img) const;
         BarrierState_vk getBarrierState(const VkBuffer _buf) const;
@@ -224,6 +281,15 @@ namespace kage { namespace vk
     private:
         void clearPending();
 
+        // the first barrier after the upload starts from the stage it waits at
+        void acquireUploaded(BarrierState_vk& _src, const BarrierState_vk& _dst, uint64_t _value);
+
+        stl::unordered_map<VkBuffer, uint64_t> m_uploadedBuffers;
+        stl::unordered_map<VkImage, uint64_t> m_uploadedImages;
+
+        uint64_t m_uploadWaitValue{ 0 };
+        VkPipelineStageFlags m_uploadWaitStages{ 0 };
+
         stl::unordered_set<VkBuffer> m_pendingBuffers;
         stl::unordered_set<VkImage> m_pendingImages;
 
@@ -246,10 +312,13 @@ namespace kage { namespace vk
         void createQueryPools(uint32_t _passCount);
 
         void alloc(VkCommandBuffer* _cmdBuf);
-        void addWaitSemaphore(VkSemaphore _semaphore, VkPipelineStageFlags _stage);
+        // _value is for a timeline semaphore only
+        void addWaitSemaphore(VkSemaphore _semaphore, VkPipelineStageFlags _stage, uint64_t _value = 0);
         void addSignalSemaphore(VkSemaphore _semaphore);
 
+        // reads the queries of the frame the command list is recycled from, never waits for them
         void fetchQueryResults();
+        void markQueriesIssued();
 
         void kick(bool _wait = false);
         void finish(bool _finishAll = false);
@@ -280,6 +349,9 @@ namespace kage { namespace vk
             
             VkQueryPool m_statisticsQueryPool = VK_NULL_HANDLE;
             VkQueryPool m_timestampQueryPool = VK_NULL_HANDLE;
+
+            // the pools are reset and written by a render, each issue is read once
+            bool m_queriesIssued = false;
         };
 
         CommandList m_commandList[kMaxNumFrameLatency];
@@ -287,6 +359,7 @@ namespace kage { namespace vk
         uint32_t             m_numWaitSemaphores;
         VkSemaphore          m_waitSemaphores[kMaxNumFrameBuffers];
         VkPipelineStageFlags m_waitSemaphoreStages[kMaxNumFrameBuffers];
+        uint64_t             m_waitSemaphoreValues[kMaxNumFrameBuffers];
         uint32_t             m_numSignalSemaphores;
         VkSemaphore          m_signalSemaphores[kMaxNumFrameBuffers];
 
@@ -295,6 +368,10 @@ namespace kage { namespace vk
         uint32_t m_timestampQueryPoolCount{ 0 };
         stl::vector<uint64_t> m_timestamps;
         stl::vector<uint64_t> m_statistics;
+        stl::vector<uint64_t> m_queryData; // value and availability pairs
+
+        // false if the last fetch had nothing to read or any query was not available yet
+        bool m_queryResultsReady{ false };
 
         VkQueryPool m_currStatisticsQueryPool;
         VkQueryPool m_currTimestampQueryPool;
@@ -318,6 +395,52 @@ namespace kage { namespace vk
         }
     };
 
+    // copies the initial data of the new resources on a dedicated transfer queue
+    // the copies of a frame are batched and submitted ahead of the frame, a batch signals the timeline semaphore with its value
+    // the resources are shared with the graphics family, the first barrier on one makes the frame wait for its batch
+    constexpr uint32_t kUploadBatchCount = 4;
+
+    struct UploadQueue_vk
+    {
+        void init(uint32_t _familyIdx, VkQueue _queue);
+        void shutdown();
+
+        bool isValid() const { return VK_NULL_HANDLE != m_queue; }
+
+        // the command buffer of the open batch, a recycled batch is waited for
+        VkCommandBuffer begin();
+
+        // the value the open batch signals
+        uint64_t getBatchValue() const { return m_submitted + 1; }
+
+        // freed once the batch it is used in is done
+        void release(const Buffer_vk& _staging);
+
+        // submit the open batch
+        void flush();
+
+        // the staging the batches hold until they are recycled
+        uint64_t getPendingBytes() const;
+
+        uint32_t m_familyIdx{ VK_QUEUE_FAMILY_IGNORED };
+        VkQueue m_queue{ VK_NULL_HANDLE };
+        VkSemaphore m_timeline{ VK_NULL_HANDLE };
+
+        uint64_t m_submitted{ 0 };
+
+        struct Batch
+        {
+            VkCommandPool m_commandPool = VK_NULL_HANDLE;
+            VkCommandBuffer m_commandBuffer = VK_NULL_HANDLE;
+            uint64_t m_value = 0;
+            stl::vector<Buffer_vk> m_staging;
+        };
+
+        Batch m_batches[kUploadBatchCount];
+        uint32_t m_current{ 0 };
+        bool m_recording{ false };
+    };
+
     struct ScratchBuffer
     {
         void create(uint32_t _size, uint32_t _count);
@@ -336,6 +459,38 @@ namespace kage { namespace vk
         uint32_t m_offset;
     };
 
+    // the breadcrumbs of the passes, tells which pass a lost device was executing
+    // each pass writes the serial of its frame into a begin slot before it and into an end slot after it
+    // the buffer is host visible and coherent, it is read on the cpu once the device is lost
+    // VK_AMD_buffer_marker writes at the top and the bottom of the pipe,
+    // the vkCmdFillBuffer fallback is ordered by the barriers between the passes only
+    struct Breadcrumbs_vk
+    {
+        enum class State : uint8_t
+        {
+            not_started,
+            running,
+            finished,
+        };
+
+        void create(uint32_t _passCount, bool _bufferMarker);
+        void destroy();
+
+        bool isValid() const { return VK_NULL_HANDLE != m_buf.buffer; }
+
+        // the following marks write the _serial into the slots of the _frame
+        void begin(uint32_t _frame, uint64_t _serial);
+        void mark(VkCommandBuffer _cmdBuf, uint32_t _passIdx, bool _end);
+
+        State getState(uint32_t _frame, uint32_t _passIdx) const;
+
+        Buffer_vk m_buf{};
+        uint32_t m_passCount{ 0 };
+        uint32_t m_frame{ 0 };
+        uint32_t m_serials[kMaxNumFrameLatency]{};
+        bool m_bufferMarker{ false };
+    };
+
     struct FrameRecCmds
     {
         struct RecCmdRange
@@ -364,17 +519,26 @@ namespace kage { namespace vk
         RHIContext_vk(bx::AllocatorI* _allocator);
         ~RHIContext_vk() override;
 
-        void init(const Resolution& _resolution, void* _wnd) override;
+        void init(const Resolution& _resolution, void* _wnd, bool _headless) override;
         void bake() override;
         bool run() override;
 
         bool render();
         void kick(bool _finishAll = false);
+
+        // submit the upload batch, the frame waits for it if any uploaded resource got a barrier
+        void submitUploads();
+
+        // prints the breadcrumbs of the frames in flight once, if the _result is VK_ERROR_DEVICE_LOST
+        void checkDeviceLost(VkResult _result);
         void shutdown();
 
         void fillQueryResults(const stl::vector<uint64_t>& _statistics, const stl::vector<uint64_t>& _timestamps);
 
         bool checkSupports(VulkanSupportExtension _ext) override;
+        bool checkSubgroupArithmeticSupports() override;
+        bool checkStorageImageSupports(ResourceFormat _format) override;
+        bool checkBufferDeviceAddressSupports() override;
 
         void updateResolution(const Resolution& _resolution) override;
 
@@ -393,6 +557,20 @@ namespace kage { namespace vk
             , const Memory* _mem
         ) override;
 
+        void updateBufferAddresses(
+            const BufferHandle _hBuf
+            , const Memory* _srcs
+            , const uint32_t _offset
+        ) override;
+
+        void updateImageMips(
+            const ImageHandle _hImg
+            , const uint16_t _width
+            , const uint16_t _height
+            , const uint16_t _numMips
+            , const Memory* _mem
+        ) override;
+
         void updateImageWithAlias(
             const ImageHandle _hImg
             , const uint16_t _width
@@ -417,13 +595,28 @@ namespace kage { namespace vk
         void dispatchBarriers();
 
         double getPassTime(const PassHandle _hPass) override;
+        double getPassRecordTime(const PassHandle _hPass) override;
         double getGPUTime() override;
         uint64_t getPassClipping(const PassHandle _hPass) override;
+        PassTimings getPassTimings(const PassHandle _hPass) override;
+        PassTimings getGpuTimings() override;
+        void resetPassTimings() override;
+        bool dumpPassTimings(const char* _path) override;
+        MemoryStats getMemoryStats() override;
+        uint32_t getMemoryBuckets(MemoryBucket* _out, uint32_t _max) override;
+        uint32_t getMemoryPassUsage(MemoryPassUsage* _out, uint32_t _max) override;
+        bool dumpMemoryTimeline(const char* _path) override;
+        void requestReadback(const char* _path) override;
+        void setLatencyMarker(LatencyMarker _marker, int64_t _time) override;
+        void setShaderHotReload(bool _enable) override;
+        LatencyTimings getLatencyTimings() override;
+        bool readBuffer(const BufferHandle _hBuf, void* _dst, uint32_t _size, uint32_t _offset) override;
 
 
         void createShader(bx::MemoryReader& _reader) override;
         void createProgram(bx::MemoryReader& _reader) override;
         void createPass(bx::MemoryReader& _reader) override;
+        void setPassVariant(const PassHandle _hPass, const GraphicsPipelineConfig& _config, const Memory* _specData, bool _bind) override;
         void createImage(bx::MemoryReader& _reader) override;
         void createBuffer(bx::MemoryReader& _reader) override;
         void createSampler(bx::MemoryReader& _reader) override;
@@ -434,6 +627,7 @@ namespace kage { namespace vk
 
         // brixelizer
         void brx_setGeoInstances(const Memory* _desc) override;
+        void brx_updateGeoInstances(const Memory* _deltas) override;
         void brx_regGeoBuffers(const Memory* _bufs) override;
         void brx_setUserResources(const Memory* _reses) override;
         void brx_setDebugInfos(const Memory* _debug) override;
@@ -584,15 +778,16 @@ namespace kage { namespace vk
         VkImageView getCachedImageView(const ImageHandle _hImg, uint16_t _mip, uint16_t _numMips, uint16_t _numLayers, VkImageViewType _type);
         VkBufferView getCachedBufferView(const BufferHandle _hBuf);// the buffer view is for texel buffer access, use the whole size for now
 
-        void createInstance();
-        void createPhysicalDevice();
+        void createInstance(bool _headless);
+        void createPhysicalDevice(bool _headless);
 
         // private pass
         // e.g. upload buffer, copy image, etc.
         // 
-        void uploadBuffer(const BufferHandle _hbuf, const void* _data, uint32_t _size, uint32_t _offset);
+        // _async: the buffer is new, the copy may go to the transfer queue
+        void uploadBuffer(const BufferHandle _hbuf, const void* _data, uint32_t _size, uint32_t _offset, bool _async = false);
         void fillBuffer(const BufferHandle _hbuf, const uint32_t _value, uint32_t _size);
-        void uploadImage(const ImageHandle _himg, const void* data, uint32_t size);
+        void uploadImage(const ImageHandle _himg, const void* data, uint32_t size, bool _async = false);
 
         // barriers
         void checkUnmatchedBarriers(uint16_t _passId);
@@ -629,6 +824,14 @@ namespace kage { namespace vk
             return m_bufferContainer.getIdToData(_hbuf);
         }
 
+        bool isReadOnly(const BufferHandle _hbuf) const
+        {
+            return m_readOnlyBuffers.end() != m_readOnlyBuffers.find(_hbuf.id);
+        }
+
+        // makes the last upload visible to any later read, the passes skip the barriers of it
+        void publishReadOnlyBuffer(const BufferHandle _hbuf);
+
         const Image_vk& getImage(const ImageHandle _himg, bool _base = true) const
         {
             if (_base)
@@ -667,11 +870,56 @@ namespace kage { namespace vk
         StateCacheLru<VkBufferView, 1024> m_bufViewCache;
 
         ContinuousMap<BufferHandle, BufferCreateInfo> m_bufferCreateInfos;
+        stl::unordered_set<uint16_t> m_readOnlyBuffers; // with the aliases
         ContinuousMap<ImageHandle, ImageCreateInfo> m_imgCreateInfos;
 
         stl::vector<stl::vector<uint16_t>> m_programShaderIds;
         stl::vector<uint32_t>           m_progThreadCount;
 
+        // kept to rebuild the programs and pipelines when a shader reloads
+        struct ShaderFile_vk
+        {
+            char path[kMaxPathLen];
+            int64_t mtime{ 0 };
+        };
+
+        struct PassPipelineDesc_vk
+        {
+            stl::vector<VertexBindingDesc> vertexBindings;
+            stl::vector<VertexAttributeDesc> vertexAttributes;
+            stl::vector<int> specData;
+        };
+
+        ContinuousMap<uint16_t, ShaderFile_vk> m_shaderFiles;
+        ContinuousMap<uint16_t, ProgramCreateInfo> m_programCreateInfos;
+        ContinuousMap<uint16_t, PassPipelineDesc_vk> m_passPipelineDescs;
+
+        // pipeline variants
+        // the registration pipeline of a pass is a variant too, all pipelines are owned by the cache
+        // the keys do not change on the shader reload, the variants of the rebuilt programs are re-compiled in place
+        void getPipelineBuildInfo(PipelineBuildInfo_vk& _out, const PassInfo_vk& _passInfo, const stl::vector<int>& _specData, const GraphicsPipelineConfig& _config) const;
+        uint64_t requestPipelineVariant(const PassInfo_vk& _passInfo, const stl::vector<int>& _specData, const GraphicsPipelineConfig& _config, bool _async);
+        // collects the finished compiles and switches the waiting passes, once per frame
+        void updatePipelineVariants();
+        // waits for all compiles, nothing may destroy the shader modules or layouts while one is running
+        void flushPipelineVariants();
+
+        VkPipelineCache m_pipelineCache{};
+        stl::unordered_map<uint64_t, PipelineVariant_vk> m_pipelineVariants;
+        std::vector<PipelineCompileJob_vk> m_pipelineJobs;
+        stl::vector<uint16_t> m_variantWaitingPasses;
+
+        // polls the spv files every kShaderWatchInterval frames
+        void checkShaderReload();
+        void reloadShaders(const stl::vector<uint16_t>& _shaderIds);
+
+        bool m_shaderHotReload{ false };
+        uint32_t m_shaderWatchFrame{ 0 };
+
+        // the bindless sets are not update-after-bind, a re-created image waits for the frames in flight once in the frame
+        void rewriteBindlessImage(const ImageHandle _hImg, const Image_vk& _img);
+        bool m_imageSwapWaited{ false };
+
         ContinuousMap< ImageHandle, ImageHandle> m_aliasToBaseImages;
         ContinuousMap< BufferHandle, BufferHandle> m_aliasToBaseBuffers;
 
@@ -703,6 +951,7 @@ namespace kage { namespace vk
 
         uint32_t m_numFramesInFlight{ kMaxNumFrameLatency };
         CommandQueue_vk m_cmd;
+        UploadQueue_vk m_upload;
         VkCommandBuffer m_cmdBuffer;
 
         VkQueue m_queue;
@@ -717,6 +966,11 @@ namespace kage { namespace vk
         uint32_t m_gfxFamilyIdx;
         // support
         bool m_supportMeshShading{ false };
+        bool m_supportBufferMarker{ false };
+        bool m_supportCalibratedTimestamps{ false };
+
+        Breadcrumbs_vk m_breadcrumbs;
+        bool m_deviceLost{ false };
 
         // barrier dispatcher
         BarrierDispatcher m_barrierDispatcher;
@@ -724,8 +978,97 @@ namespace kage { namespace vk
         // naive profiling
         double m_gpuTime{ 0.0 };
         stl::unordered_map<uint16_t, double> m_passTime;
+        stl::unordered_map<uint16_t, double> m_passRecordTime; // cpu, barriers and commands of the pass
         stl::unordered_map<uint16_t, uint64_t> m_passStatistics;
 
+        // accumulated since the last reset, for the timing dump
+        struct PassTimeStat
+        {
+            double sum{ 0.0 };
+            double min{ 0.0 };
+            double max{ 0.0 };
+            uint32_t count{ 0 };
+        };
+        void accumulatePassTime(PassTimeStat& _stat, double _time);
+
+        stl::unordered_map<uint16_t, PassTimeStat> m_passTimeStats;
+        PassTimeStat m_gpuTimeStat;
+
+        // a ring of the recent frames for the percentiles, kept across resets
+        struct PassTimeHistory
+        {
+            float samples[kPassTimeHistorySize];
+            uint32_t count{ 0 };
+            uint32_t next{ 0 };
+            double last{ 0.0 };
+            double smoothed{ 0.0 };
+        };
+        void pushPassTime(PassTimeHistory& _history, double _time);
+        PassTimings getTimings(const PassTimeHistory& _history) const;
+
+        stl::unordered_map<uint16_t, PassTimeHistory> m_passTimeHistory;
+        PassTimeHistory m_gpuTimeHistory;
+
+        // latency of the frames in flight, indexed as the command lists
+        // the gpu is done with a frame at its last timestamp, read once the fence of its command list is signaled
+        // the timestamp is moved to the host clock with VK_EXT_calibrated_timestamps
+        // without it the gpu done is the poll time: before the recording, after the alloc and after the present,
+        // so it is late by up to the cpu time between two polls
+        struct LatencyFrame
+        {
+            int64_t input{ 0 };
+            int64_t simulationEnd{ 0 };
+            int64_t submit{ 0 };
+            int64_t present{ 0 };
+            bool pending{ false };
+        };
+        void pollLatencyFrames();
+
+        VkQueryPool m_latencyQueryPool{ VK_NULL_HANDLE };
+        uint32_t m_timestampValidBits{ 64 };
+
+        int64_t m_latencyMarkers[2]{}; // of the frame being built, by LatencyMarker
+        LatencyFrame m_latencyFrames[kMaxNumFrameLatency];
+        double m_latencyStages[4]{}; // smoothed, in the order of LatencyTimings
+        PassTimeHistory m_latencyHistory;
+
+        // readback of the presented image, copied after the draw to swapchain and written once the frame is done
+        void recordReadback(uint32_t _swapImgIdx);
+        void writeReadback();
+
+        Buffer_vk m_readbackBuf{};
+        bx::FilePath m_readbackPath;
+        bool m_readbackRequested{ false };
+
+        // memory telemetry, collected from the containers once the resources change
+        struct MemoryTelemetry
+        {
+            struct Resource
+            {
+                const char* name;
+                uint64_t bytes; // the memory requirement on its own
+                uint32_t bucket;
+                uint16_t firstPass{ kInvalidHandle };
+                uint16_t lastPass{ kInvalidHandle };
+            };
+
+            MemoryStats stats;
+            stl::vector<MemoryBucket> buckets;
+            stl::vector<MemoryPassUsage> passes;
+            stl::vector<Resource> resources;
+        };
+        void collectMemoryTelemetry(MemoryTelemetry& _out) const;
+
+        // the cached telemetry, the staging and host counters are refreshed on each call
+        const MemoryTelemetry& getMemoryTelemetry();
+
+        MemoryTelemetry m_memTelemetry;
+        bool m_memTelemetryDirty{ true }; // set by the bake and the re-creations
+
+        // the bytes copied through the staging buffers, of the frame being recorded and of the last one
+        uint64_t m_frameStagingBytes{ 0 };
+        uint64_t m_lastStagingBytes{ 0 };
+
         FrameRecCmds m_frameRecCmds;
         VkDebugReportCallbackEXT m_debugCallback;
 
@@ -38,7 +38,7 @@ namespace kage{ namespace vk
         return callback;
     }
 
-    VkInstance createInstance()
+    VkInstance createInstance(bool headless)
     {
         assert(volkGetInstanceVersion() >= VK_API_VERSION_1_3);
 
@@ -69,17 +69,20 @@ namespace kage{ namespace vk
             createInfo.pNext = &validationFeatures;
         }
 
-        const char* extensions[] = {
-            VK_KHR_SURFACE_EXTENSION_NAME,
+        stl::vector<const char*> extensions;
+        if (!headless)
+        {
+            extensions.push_back(VK_KHR_SURFACE_EXTENSION_NAME);
     #ifdef VK_USE_PLATFORM_WIN32_KHR
-            VK_KHR_WIN32_SURFACE_EXTENSION_NAME,
+            extensions.push_back(VK_KHR_WIN32_SURFACE_EXTENSION_NAME);
     #endif // VK_USE_PLATFORM_WIN32_KHR
-            VK_EXT_DEBUG_UTILS_EXTENSION_NAME,
-            VK_EXT_DEBUG_REPORT_EXTENSION_NAME,
-            VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME,
-        };
-        createInfo.ppEnabledExtensionNames = extensions;
-        createInfo.enabledExtensionCount = COUNTOF(extensions);
+        }
+        extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+        extensions.push_back(VK_EXT_DEBUG_REPORT_EXTENSION_NAME);
+        extensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+
+        createInfo.ppEnabledExtensionNames = extensions.data();
+        createInfo.enabledExtensionCount = (uint32_t)extensions.size();
 
         VkInstance Instance = 0;
         VK_CHECK(vkCreateInstance(&createInfo, 0, &Instance));
@@ -108,6 +111,31 @@ namespace kage{ namespace vk
     }
 
 
+    uint32_t getTransferFamilyIndex(VkPhysicalDevice physicalDevice)
+    {
+        uint32_t propertyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &propertyCount, nullptr);
+        stl::vector<VkQueueFamilyProperties> queueFamilyProperties(propertyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &propertyCount, queueFamilyProperties.data());
+
+        // a dedicated copy engine only, the images are copied mip by mip so the granularity must be a texel
+        for (uint32_t i = 0; i < propertyCount; ++i)
+        {
+            const VkQueueFamilyProperties& props = queueFamilyProperties[i];
+            const VkExtent3D& granularity = props.minImageTransferGranularity;
+
+            if ((props.queueFlags & VK_QUEUE_TRANSFER_BIT)
+                && !(props.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT))
+                && granularity.width == 1 && granularity.height == 1 && granularity.depth == 1
+                )
+            {
+                return i;
+            }
+        }
+
+        return VK_QUEUE_FAMILY_IGNORED;
+    }
+
     bool supportPresentation(VkPhysicalDevice physicalDevice, uint32_t familyIndex)
     {
 #if defined(VK_USE_PLATFORM_WIN32_KHR)
@@ -117,7 +145,7 @@ namespace kage{ namespace vk
 #endif
     }
 
-    VkPhysicalDevice pickPhysicalDevice(VkPhysicalDevice* physicalDevices, uint32_t physicalDevicesCount)
+    VkPhysicalDevice pickPhysicalDevice(VkPhysicalDevice* physicalDevices, uint32_t physicalDevicesCount, bool headless)
     {
         VkPhysicalDevice discrete = 0;
         VkPhysicalDevice fallback = 0;
@@ -134,7 +162,7 @@ namespace kage{ namespace vk
             if (familyIndex == VK_QUEUE_FAMILY_IGNORED)
                 continue;
 
-            if (!supportPresentation(physicalDevices[i], familyIndex))
+            if (!headless && !supportPresentation(physicalDevices[i], familyIndex))
                 continue;
 
             if (!discrete && props.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU) {
@@ -163,17 +191,33 @@ namespace kage{ namespace vk
     }
 
 
-    VkDevice createDevice(VkInstance instance, VkPhysicalDevice physicalDevice, uint32_t familyIndex, bool meshShadingSupported)
+    VkDevice createDevice(VkInstance instance, VkPhysicalDevice physicalDevice, uint32_t familyIndex, uint32_t transferFamilyIndex, bool meshShadingSupported, bool bufferMarkerSupported, bool calibratedTimestampsSupported, bool headless)
     {
         float queueProps[] = { 1.0f };
 
-        VkDeviceQueueCreateInfo queueInfo = { VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO };
-        queueInfo.queueFamilyIndex = familyIndex;
-        queueInfo.queueCount = 1;
-        queueInfo.pQueuePriorities = queueProps;
+        VkDeviceQueueCreateInfo queueInfos[2] = {};
+        uint32_t queueInfoCount = 0;
+
+        queueInfos[queueInfoCount].sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+        queueInfos[queueInfoCount].queueFamilyIndex = familyIndex;
+        queueInfos[queueInfoCount].queueCount = 1;
+        queueInfos[queueInfoCount].pQueuePriorities = queueProps;
+        queueInfoCount++;
+
+        if (VK_QUEUE_FAMILY_IGNORED != transferFamilyIndex)
+        {
+            queueInfos[queueInfoCount].sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+            queueInfos[queueInfoCount].queueFamilyIndex = transferFamilyIndex;
+            queueInfos[queueInfoCount].queueCount = 1;
+            queueInfos[queueInfoCount].pQueuePriorities = queueProps;
+            queueInfoCount++;
+        }
 
         stl::vector<const char*> extensions;
-        extensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+        if (!headless)
+        {
+            extensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+        }
         extensions.push_back(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
         extensions.push_back(VK_KHR_GET_MEMORY_REQUIREMENTS_2_EXTENSION_NAME); // for ffx
         extensions.push_back(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME); // for VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME
@@ -186,6 +230,18 @@ namespace kage{ namespace vk
 
         extensions.push_back(VK_KHR_FRAGMENT_SHADING_RATE_EXTENSION_NAME);
 
+        // the breadcrumbs of the passes
+        if (bufferMarkerSupported)
+        {
+            extensions.push_back(VK_AMD_BUFFER_MARKER_EXTENSION_NAME);
+        }
+
+        // the gpu timestamps in the host clock, for the latency
+        if (calibratedTimestampsSupported)
+        {
+            extensions.push_back(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+        }
+
 
         VkPhysicalDeviceFeatures2 features = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
         features.features.vertexPipelineStoresAndAtomics = true;
@@ -198,6 +254,11 @@ namespace kage{ namespace vk
         features.features.fragmentStoresAndAtomics = true; // enable fragment shader stores and atomics
         features.features.fillModeNonSolid = true; // enable line rasterization mode
 
+        // vk 1.3 allows the unformatted writes per format without the feature, see checkStorageImageSupports
+        VkPhysicalDeviceFeatures supportedFeatures = {};
+        vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+        features.features.shaderStorageImageWriteWithoutFormat = supportedFeatures.shaderStorageImageWriteWithoutFormat;
+
         VkPhysicalDeviceVulkan11Features features11 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES };
         features11.storageBuffer16BitAccess = true;
         features11.uniformAndStorageBuffer16BitAccess = true;
@@ -226,6 +287,16 @@ namespace kage{ namespace vk
         features12.shaderStorageBufferArrayNonUniformIndexing = true;
         // enable 64bit atomic operations
         features12.shaderBufferInt64Atomics = true;
+        // the static scene buffers can be read through the pointers instead of the descriptors
+        // (#extension GL_EXT_buffer_reference : require)
+        // optional in vk 1.2, see checkBufferDeviceAddressSupports
+        VkPhysicalDeviceVulkan12Features supported12 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES };
+        VkPhysicalDeviceFeatures2 supportedFeatures2 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+        supportedFeatures2.pNext = &supported12;
+        vkGetPhysicalDeviceFeatures2(physicalDevice, &supportedFeatures2);
+        features12.bufferDeviceAddress = supported12.bufferDeviceAddress;
+        // the uploads on the transfer queue signal the frame with a counter
+        features12.timelineSemaphore = true;
         
 
         VkPhysicalDeviceVulkan13Features features13 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES };
@@ -243,8 +314,8 @@ namespace kage{ namespace vk
         featuresGPL.graphicsPipelineLibrary = true; // enable for VK_PIPELINE_LAYOUT_CREATE_INDEPENDENT_SETS_BIT_EXT, which allows descriptor sets to be **null** in the chain.
 
         VkDeviceCreateInfo createInfo = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
-        createInfo.queueCreateInfoCount = 1;
-        createInfo.pQueueCreateInfos = &queueInfo;
+        createInfo.queueCreateInfoCount = queueInfoCount;
+        createInfo.pQueueCreateInfos = queueInfos;
         createInfo.ppEnabledExtensionNames = extensions.data();
         createInfo.enabledExtensionCount = uint32_t(extensions.size());
 
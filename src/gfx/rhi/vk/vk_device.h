@@ -5,16 +5,21 @@
 
 namespace kage { namespace vk
 {
-    VkInstance createInstance();
+    // headless leaves out the surface extensions
+    VkInstance createInstance(bool headless);
     VkDebugReportCallbackEXT registerDebugCallback(VkInstance instance);
 
     uint32_t getGraphicsFamilyIndex(VkPhysicalDevice physicalDevice);
 
-    VkPhysicalDevice pickPhysicalDevice(VkPhysicalDevice* physicalDevices, uint32_t physicalDevicesCount);
+    // VK_QUEUE_FAMILY_IGNORED if there is no dedicated transfer family
+    uint32_t getTransferFamilyIndex(VkPhysicalDevice physicalDevice);
+
+    // headless accepts the devices that can't present
+    VkPhysicalDevice pickPhysicalDevice(VkPhysicalDevice* physicalDevices, uint32_t physicalDevicesCount, bool headless);
 
     VkDebugReportCallbackEXT registerDebugCallback(VkInstance instance);
 
-    VkDevice createDevice(VkInstance instance, VkPhysicalDevice physicalDevice, uint32_t familyIndex, bool meshShadingSupported);
+    VkDevice createDevice(VkInstance instance, VkPhysicalDevice physicalDevice, uint32_t familyIndex, uint32_t transferFamilyIndex, bool meshShadingSupported, bool bufferMarkerSupported, bool calibratedTimestampsSupported, bool headless);
 
 }
 } // namespace kage
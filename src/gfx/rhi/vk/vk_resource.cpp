@@ -19,6 +19,7 @@ namespace kage { namespace vk
         const VkDevice _device
         , size_t _size
         , uint32_t _memTypeIdx
+        , VkMemoryAllocateFlags _allocFlags /* = 0 */
     )
     {
         KG_ZoneScopedC(Color::light_coral);
@@ -27,6 +28,13 @@ namespace kage { namespace vk
         allocInfo.allocationSize = _size;
         allocInfo.memoryTypeIndex = _memTypeIdx;
 
+        VkMemoryAllocateFlagsInfo flagsInfo = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO };
+        flagsInfo.flags = _allocFlags;
+        if (0 != _allocFlags)
+        {
+            allocInfo.pNext = &flagsInfo;
+        }
+
         VkDeviceMemory memory = 0;
         VK_CHECK(vkAllocateMemory(_device, &allocInfo, nullptr, &memory));
         
@@ -73,6 +81,7 @@ namespace kage { namespace vk
         , const VkBufferUsageFlags _usage
         , const VkMemoryPropertyFlags _memFlags
         , const VkFormat _format /* = VK_FORMAT_UNDEFINED*/
+        , bool _concurrent /* = false*/
     )
     {
         KG_ZoneScopedC(Color::light_coral);
@@ -113,6 +122,14 @@ namespace kage { namespace vk
             createInfo.size = alignSize;
             createInfo.usage = _usage;
 
+            const uint32_t families[] = { s_renderVK->m_gfxFamilyIdx, s_renderVK->m_upload.m_familyIdx };
+            if (_concurrent)
+            {
+                createInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+                createInfo.queueFamilyIndexCount = COUNTOF(families);
+                createInfo.pQueueFamilyIndices = families;
+            }
+
             Buffer_vk& buf = results[ii];
 
             VK_CHECK(vkCreateBuffer(device, &createInfo, nullptr, &(buf.buffer)));
@@ -131,7 +148,10 @@ namespace kage { namespace vk
         uint32_t memoryTypeIdx = selectMemoryType(memProps, memoryReqs.memoryTypeBits, _memFlags);
         assert(memoryTypeIdx != ~0u);
 
-        VkDeviceMemory memory = allocVkMemory(device, memoryReqs.size, memoryTypeIdx);
+        const bool withAddress = 0 != (_usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT);
+        const VkMemoryAllocateFlags allocFlags = withAddress ? VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT : 0;
+
+        VkDeviceMemory memory = allocVkMemory(device, memoryReqs.size, memoryTypeIdx, allocFlags);
 
         // all buffers share the same memory
         for (uint32_t ii = 0; ii < infoCount; ++ii)
@@ -139,15 +159,24 @@ namespace kage { namespace vk
             Buffer_vk& buf = results[ii];
             VK_CHECK(vkBindBufferMemory(device, buf.buffer, memory, 0));
             buf.memory = memory;
+
+            if (withAddress)
+            {
+                VkBufferDeviceAddressInfo addrInfo = { VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO };
+                addrInfo.buffer = buf.buffer;
+                buf.address = vkGetBufferDeviceAddress(device, &addrInfo);
+            }
         }
 
-        // map to local memory
+        // map to local memory, a memory can only be mapped once so the aliases share the pointer
         if (_memFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
         {
+            void* data = nullptr;
+            VK_CHECK(vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, &data));
+
             for (uint32_t ii = 0; ii < infoCount; ++ii)
             {
-                Buffer_vk& buf = results[ii];
-                VK_CHECK(vkMapMemory(device, memory, 0, buf.size, 0, &(buf.data)));
+                results[ii].data = data;
             }
         }
 
@@ -160,13 +189,14 @@ namespace kage { namespace vk
         , VkBufferUsageFlags _usage
         , VkMemoryPropertyFlags _memFlags
         , VkFormat _format /* = VK_FORMAT_UNDEFINED*/
+        , bool _concurrent /* = false*/
     )
     {
         KG_ZoneScopedC(Color::light_coral);
 
         stl::vector<Buffer_vk> results;
         stl::vector<BufferAliasInfo> infos{1, _info };
-        createBuffer(results, infos, _usage, _memFlags, _format);
+        createBuffer(results, infos, _usage, _memFlags, _format, _concurrent);
 
         return results[0];
     }
@@ -272,6 +302,14 @@ namespace kage { namespace vk
         createInfo.usage = _initProps.usage;
         createInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 
+        const uint32_t families[] = { s_renderVK->m_gfxFamilyIdx, s_renderVK->m_upload.m_familyIdx };
+        if (_initProps.concurrent)
+        {
+            createInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+            createInfo.queueFamilyIndexCount = COUNTOF(families);
+            createInfo.pQueueFamilyIndices = families;
+        }
+
         if (_initProps.viewType == VK_IMAGE_VIEW_TYPE_CUBE)
         {
             createInfo.flags = VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT;
@@ -5,6 +5,19 @@
 
 namespace kage { namespace vk
 {
+    VkDeviceMemory allocVkMemory(
+        const VkDevice _device
+        , size_t _size
+        , uint32_t _memTypeIdx
+        , VkMemoryAllocateFlags _allocFlags = 0
+    );
+
+    uint32_t selectMemoryType(
+        const VkPhysicalDeviceMemoryProperties& _props
+        , uint32_t _typeBits
+        , VkMemoryPropertyFlags _flags
+    );
+
     struct Buffer_vk
     {
         BufferHandle hBuf;
@@ -15,13 +28,18 @@ namespace kage { namespace vk
         void* data;
         size_t size;
         uint32_t fillVal;
+
+        // valid only if created with the shader device address usage
+        VkDeviceAddress address;
     };
 
+    // _concurrent: shared with the transfer queue of the uploads, no ownership transfer needed
     Buffer_vk createBuffer(
         const BufferAliasInfo& _info
         , VkBufferUsageFlags _usage
         , VkMemoryPropertyFlags _memFlags
         , VkFormat _format = VK_FORMAT_UNDEFINED
+        , bool _concurrent = false
     );
     
     void createBuffer(
@@ -30,6 +48,7 @@ namespace kage { namespace vk
         , VkBufferUsageFlags _usage
         , VkMemoryPropertyFlags _memFlags
         , VkFormat _format = VK_FORMAT_UNDEFINED
+        , bool _concurrent = false
     );
 
     void flushBuffer(
@@ -86,6 +105,9 @@ namespace kage { namespace vk
         VkImageLayout       layout{ VK_IMAGE_LAYOUT_GENERAL };
         VkImageViewType     viewType{ VK_IMAGE_VIEW_TYPE_2D };
         VkImageAspectFlags  aspectMask{ VK_IMAGE_ASPECT_COLOR_BIT };
+
+        // shared with the transfer queue of the uploads
+        bool concurrent{ false };
     };
 
     Image_vk createImage(
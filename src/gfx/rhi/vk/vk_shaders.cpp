@@ -6,6 +6,8 @@
 #include "rhi_context_vk.h"
 
 #include <stdio.h>
+#include "bx/hash.h"
+#include "bx/string.h"
 
 #if VK_HEADER_VERSION >= 135
 #include <spirv-headers/spirv.h>
@@ -366,37 +368,116 @@ namespace kage { namespace vk
     }
 
 
+    struct ShaderReflectHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t structSize;
+        uint32_t codeSize;
+        uint32_t codeHash;
+    };
+
+    constexpr uint32_t kShaderReflectMagic = BX_MAKEFOURCC('K', 'R', 'F', 'L');
+
+    static bool loadShaderReflection(Shader_vk& _shader, const char* _path, uint32_t _codeSize, uint32_t _codeHash)
+    {
+        char reflPath[kMaxPathLen];
+        bx::snprintf(reflPath, kMaxPathLen, "%s.refl", _path);
+
+        FILE* file = fopen(reflPath, "rb");
+        if (!file)
+        {
+            return false;
+        }
+
+        ShaderReflectHeader header{};
+        bool result = fread(&header, sizeof(header), 1, file) == 1
+            && header.magic == kShaderReflectMagic
+            && header.version == kShaderReflectVersion
+            && header.structSize == sizeof(Shader_vk)
+            && header.codeSize == _codeSize
+            && header.codeHash == _codeHash
+            && fread(&_shader, sizeof(Shader_vk), 1, file) == 1
+            ;
+
+        fclose(file);
+
+        _shader.module = VK_NULL_HANDLE;
+        return result;
+    }
+
+    static void saveShaderReflection(const Shader_vk& _shader, const char* _path, uint32_t _codeSize, uint32_t _codeHash)
+    {
+        char reflPath[kMaxPathLen];
+        bx::snprintf(reflPath, kMaxPathLen, "%s.refl", _path);
+
+        FILE* file = fopen(reflPath, "wb");
+        if (!file)
+        {
+            message(warning, "failed to write the shader reflection cache %s", reflPath);
+            return;
+        }
+
+        ShaderReflectHeader header{};
+        header.magic = kShaderReflectMagic;
+        header.version = kShaderReflectVersion;
+        header.structSize = sizeof(Shader_vk);
+        header.codeSize = _codeSize;
+        header.codeHash = _codeHash;
+
+        Shader_vk reflected = _shader;
+        reflected.module = VK_NULL_HANDLE;
+
+        fwrite(&header, sizeof(header), 1, file);
+        fwrite(&reflected, sizeof(Shader_vk), 1, file);
+        fclose(file);
+    }
+
     bool loadShader(Shader_vk& shader, VkDevice device, const char* path)
     {
+        KG_ZoneScopedC(Color::indian_red);
+
         FILE* file = fopen(path, "rb");
         if (!file)
             return false;
 
         fseek(file, 0, SEEK_END);
         long length = ftell(file);
-        assert(length >= 0);
         fseek(file, 0, SEEK_SET);
 
-        char* buffer = new char[length];
-        assert(buffer);
+        // a compiler might still be writing it
+        if (length < 20 || length % 4 != 0)
+        {
+            fclose(file);
+            return false;
+        }
 
-        size_t rc = fread(buffer, 1, length, file);
-        assert(rc = size_t(length));
+        stl::vector<uint32_t> code(length / 4);
+        size_t rc = fread(code.data(), 1, length, file);
         fclose(file);
 
-        assert(length % 4 == 0);
+        if (rc != size_t(length) || code[0] != SpvMagicNumber)
+        {
+            return false;
+        }
+
+        const uint32_t codeHash = bx::hash<bx::HashMurmur2A>(code.data(), uint32_t(length));
+
+        Shader_vk reflected{};
+        if (!loadShaderReflection(reflected, path, uint32_t(length), codeHash))
+        {
+            parseShader(reflected, code.data(), uint32_t(length / 4));
+            saveShaderReflection(reflected, path, uint32_t(length), codeHash);
+        }
 
         VkShaderModuleCreateInfo createInfo = { VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO };
-        createInfo.pCode = reinterpret_cast<const uint32_t*>(buffer);
+        createInfo.pCode = code.data();
         createInfo.codeSize = length;
 
         VkShaderModule shaderModule = 0;
         VK_CHECK(vkCreateShaderModule(device, &createInfo, 0, &shaderModule));
 
-        parseShader(shader, reinterpret_cast<const uint32_t*>(buffer), length / 4);
-
-        delete[] buffer;
-
+        shader = reflected;
         shader.module = shaderModule;
         return true;
     }
@@ -699,8 +780,14 @@ namespace kage { namespace vk
         vkDestroyDescriptorUpdateTemplate(_device, _program.updateTemplate, 0);
         vkDestroyPipelineLayout(_device, _program.layout, 0);
         vkDestroyDescriptorSetLayout(_device, _program.pushSetLayout, 0);
-        vkDestroyDescriptorSetLayout(_device, _program.bindlessLayout, 0);
-        vkFreeDescriptorSets(_device, pool, 1, &_program.nonPushDescSet);
+
+        // the bindless layout is owned by the Bindless_vk, shared with the other programs
+
+        // the pool is created with VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT
+        if (_program.nonPushDescSet)
+        {
+            VK_CHECK(vkFreeDescriptorSets(_device, pool, 1, &_program.nonPushDescSet));
+        }
         vkDestroyDescriptorSetLayout(_device, _program.nonPushSetLayout, 0);
     }
 
@@ -793,6 +880,7 @@ namespace kage { namespace vk
         };
          
         VkDescriptorPoolCreateInfo poolCreateInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+        poolCreateInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT; // the sets of the reloaded programs are given back
         poolCreateInfo.maxSets = lmts.maxBoundDescriptorSets;
         poolCreateInfo.poolSizeCount = COUNTOF(poolSizes);
         poolCreateInfo.pPoolSizes = poolSizes;
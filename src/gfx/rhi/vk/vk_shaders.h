@@ -51,6 +51,11 @@ namespace kage { namespace vk
         VkPolygonMode polygonMode{ VK_POLYGON_MODE_FILL };
     };
 
+    // the reflection is cached in <path>.refl next to the spv, keyed by the size and the hash of the code
+    // a changed Shader_vk invalidates the cache by its size, bump kShaderReflectVersion for other layout changes
+    constexpr uint32_t kShaderReflectVersion = 1;
+
+    // false if the file is missing or not a complete spir-v module
     bool loadShader(Shader_vk& shader, VkDevice device, const char* path);
 
     VkPipeline createGraphicsPipeline(VkDevice device, VkPipelineCache pipelineCache, VkPipelineLayout layout, const VkPipelineRenderingCreateInfo& renderInfo
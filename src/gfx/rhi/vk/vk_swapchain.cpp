@@ -10,22 +10,35 @@ namespace kage { namespace vk
 {
     extern RHIContext_vk* s_renderVK;
 
-    VkPresentModeKHR getSwapchainPresentMode(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface)
+    VkPresentModeKHR getPresentMode(PresentMode _mode)
+    {
+        switch (_mode)
+        {
+        case PresentMode::immediate:    return VK_PRESENT_MODE_IMMEDIATE_KHR;
+        case PresentMode::mailbox:      return VK_PRESENT_MODE_MAILBOX_KHR;
+        default:                        return VK_PRESENT_MODE_FIFO_KHR;
+        }
+    }
+
+    VkPresentModeKHR getSwapchainPresentMode(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface, PresentMode _mode)
     {
         stl::vector<VkPresentModeKHR> presentModes(32);
         uint32_t presentModeCount = 32;
         VK_CHECK(vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, surface, &presentModeCount, presentModes.data()));
 
+        const VkPresentModeKHR wanted = getPresentMode(_mode);
         for (uint32_t i = 0; i < presentModeCount; ++i) {
-            if (presentModes[i] == VK_PRESENT_MODE_IMMEDIATE_KHR) {
+            if (presentModes[i] == wanted) {
                 return presentModes[i];
             }
         }
 
+        // fifo is always supported
+        message(warning, "present mode %d is not supported, fall back to fifo", wanted);
         return VK_PRESENT_MODE_FIFO_KHR;
     }
 
-    VkResult Swapchain_vk::create(void* _nwh, const Resolution& _resolution)
+    VkResult Swapchain_vk::create(void* _nwh, const Resolution& _resolution, bool _headless /*= false*/)
     {
         const VkDevice device = s_renderVK->m_device;
         const VkPhysicalDevice physicalDevice = s_renderVK->m_physicalDevice;
@@ -33,6 +46,13 @@ namespace kage { namespace vk
         
         m_nwh = _nwh;
         m_resolution = _resolution;
+        m_headless = _headless;
+
+        if (m_headless)
+        {
+            createOffscreen();
+            return VK_SUCCESS;
+        }
 
         createSurface();
 
@@ -57,6 +77,7 @@ namespace kage { namespace vk
 
         const bool recreateSwapchain = false
             || m_resolution.format != _resolution.format
+            || m_resolution.presentMode != _resolution.presentMode
             || m_resolution.width != _resolution.width
             || m_resolution.height != _resolution.height
             || recreateSurface
@@ -65,6 +86,17 @@ namespace kage { namespace vk
         m_nwh = _nwh;
         m_resolution = _resolution;
 
+        if (m_headless)
+        {
+            if (recreateSwapchain)
+            {
+                s_renderVK->kick(true);
+                releaseOffscreen();
+                createOffscreen();
+            }
+            return;
+        }
+
         if (recreateSwapchain)
         {
             releaseSwapchain();
@@ -124,7 +156,7 @@ namespace kage { namespace vk
             ? VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR
             : surfaceCaps.currentTransform;
 
-        VkPresentModeKHR presentMode = getSwapchainPresentMode(physicalDevice, m_surface);
+        VkPresentModeKHR presentMode = getSwapchainPresentMode(physicalDevice, m_surface, m_resolution.presentMode);
 
         m_sci.surface = m_surface;
         m_sci.minImageCount = glm::max(4u, surfaceCaps.minImageCount);
@@ -188,6 +220,39 @@ namespace kage { namespace vk
         m_shouldRecreateSwapchain = false;
     }
 
+    void Swapchain_vk::createOffscreen()
+    {
+        const VkDevice device = s_renderVK->m_device;
+
+        VkImageCreateInfo ici = { VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
+        ici.imageType = VK_IMAGE_TYPE_2D;
+        ici.format = getSwapchainFormat();
+        ici.extent = { m_resolution.width, m_resolution.height, 1 };
+        ici.mipLevels = 1;
+        ici.arrayLayers = 1;
+        ici.samples = VK_SAMPLE_COUNT_1_BIT;
+        ici.tiling = VK_IMAGE_TILING_OPTIMAL;
+        ici.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+        ici.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        VK_CHECK(vkCreateImage(device, &ici, 0, &m_offscreenImage));
+
+        VkMemoryRequirements memoryReqs;
+        vkGetImageMemoryRequirements(device, m_offscreenImage, &memoryReqs);
+
+        uint32_t memoryTypeIdx = selectMemoryType(s_renderVK->m_memProps, memoryReqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        m_offscreenMemory = allocVkMemory(device, memoryReqs.size, memoryTypeIdx);
+
+        VK_CHECK(vkBindImageMemory(device, m_offscreenImage, m_offscreenMemory, 0));
+
+        m_swapchainImages[0] = m_offscreenImage;
+        m_swapchainImageCount = 1;
+        m_swapchainImageIndex = 0;
+
+        m_shouldPresent = false;
+        m_shouldRecreateSwapchain = false;
+    }
+
     void Swapchain_vk::createSurface()
     {
         const VkDevice device = s_renderVK->m_device;
@@ -208,6 +273,14 @@ namespace kage { namespace vk
 
     bool Swapchain_vk::acquire(VkCommandBuffer _cmdBuf)
     {
+        // nothing to wait or signal, the render waits on the fence only
+        if (m_headless)
+        {
+            m_prevAcquiredSemaphore = VK_NULL_HANDLE;
+            m_prevRenderedSemaphore = VK_NULL_HANDLE;
+            return VK_NULL_HANDLE != m_offscreenImage;
+        }
+
         if (   VK_NULL_HANDLE == m_swapchain
             || m_shouldRecreateSwapchain
             )
@@ -244,6 +317,11 @@ namespace kage { namespace vk
     {
         KG_ZoneScopedC(Color::light_yellow);
 
+        if (m_headless)
+        {
+            return;
+        }
+
         if (VK_NULL_HANDLE ==  m_swapchain
             && m_shouldPresent) 
         {
@@ -261,6 +339,7 @@ namespace kage { namespace vk
         presentInfo.waitSemaphoreCount = 1;
 
         VkResult result = vkQueuePresentKHR(queue, &presentInfo);
+        s_renderVK->checkDeviceLost(result);
 
         switch (result)
         {
@@ -278,6 +357,11 @@ namespace kage { namespace vk
 
     VkFormat Swapchain_vk::getSwapchainFormat()
     {
+        if (m_headless)
+        {
+            return VK_FORMAT_R8G8B8A8_UNORM;
+        }
+
         const VkPhysicalDevice physicalDevice = s_renderVK->m_physicalDevice;
 
         stl::vector<VkSurfaceFormatKHR> formats;
@@ -315,8 +399,23 @@ namespace kage { namespace vk
         release(m_surface);
     }
 
+    void Swapchain_vk::releaseOffscreen()
+    {
+        release(m_offscreenImage);
+        release(m_offscreenMemory);
+
+        m_swapchainImages[0] = VK_NULL_HANDLE;
+        m_swapchainImageCount = 0;
+    }
+
     void Swapchain_vk::destroy()
     {
+        if (m_headless)
+        {
+            releaseOffscreen();
+            return;
+        }
+
         releaseSwapchain();
         releaseSurface();
 
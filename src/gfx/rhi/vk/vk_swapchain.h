@@ -23,16 +23,22 @@ namespace kage { namespace vk
             , m_prevAcquiredSemaphore{ VK_NULL_HANDLE }
             , m_prevRenderedSemaphore{ VK_NULL_HANDLE }
             , m_currentSemaphore{ 0 }
+            , m_offscreenImage{ VK_NULL_HANDLE }
+            , m_offscreenMemory{ VK_NULL_HANDLE }
+            , m_headless{ false }
         {
         }
 
-        VkResult create(void* _nwh, const Resolution& _resolution);
+        VkResult create(void* _nwh, const Resolution& _resolution, bool _headless = false);
         void update(void* _nwh, const Resolution& _resolution);
         void destroy();
 
         void createSwapchain();
         void createSurface();
 
+        // headless: a single device local image takes the place of the swapchain images
+        void createOffscreen();
+
         bool acquire(VkCommandBuffer _cmdBuf);
         void present();
 
@@ -40,6 +46,7 @@ namespace kage { namespace vk
 
         void releaseSwapchain();
         void releaseSurface();
+        void releaseOffscreen();
 
         void* m_nwh;
         VkSwapchainKHR m_swapchain;
@@ -60,8 +67,12 @@ namespace kage { namespace vk
         VkSemaphore m_prevAcquiredSemaphore;
         VkSemaphore m_prevRenderedSemaphore;
 
+        VkImage m_offscreenImage;
+        VkDeviceMemory m_offscreenMemory;
+
         bool m_shouldRecreateSwapchain;
         bool m_shouldPresent;
+        bool m_headless;
     };
 
 } // namespace vk
@@ -3,9 +3,21 @@
 #include "core/kage_math.h"
 #include <vector >
 
-const GBuffer createGBuffer()
+const GBuffer createGBuffer(GBufferLayout _layout /*= GBufferLayout::full*/, bool _velocity /*= false*/)
 {
     GBuffer gb;
+    gb.layout = _layout;
+
+    if (_velocity)
+    {
+        kage::ImageDesc velocityDesc;
+        velocityDesc.depth = 1;
+        velocityDesc.numLayers = 1;
+        velocityDesc.numMips = 1;
+        velocityDesc.format = kage::ResourceFormat::r16g16_sfloat;
+        velocityDesc.usage = kage::ImageUsageFlagBits::transfer_src | kage::ImageUsageFlagBits::transfer_dst | kage::ImageUsageFlagBits::sampled | kage::BufferUsageFlagBits::storage;
+        gb.velocity = kage::registRenderTarget("gbuf_velocity", velocityDesc, kage::ResourceLifetime::non_transition);
+    }
 
     kage::ImageDesc albedoDesc;
     albedoDesc.depth = 1;
@@ -15,6 +27,29 @@ const GBuffer createGBuffer()
 
     gb.albedo = kage::registRenderTarget("gbuf_albedo", albedoDesc, kage::ResourceLifetime::non_transition);
 
+    if (GBufferLayout::compact == _layout)
+    {
+        // 11:11 octahedral normal, 5 bits roughness, 5 bits metalness
+        kage::ImageDesc normalDesc;
+        normalDesc.depth = 1;
+        normalDesc.numLayers = 1;
+        normalDesc.numMips = 1;
+        normalDesc.format = kage::ResourceFormat::r32_uint;
+        normalDesc.usage = kage::ImageUsageFlagBits::transfer_src | kage::ImageUsageFlagBits::sampled | kage::BufferUsageFlagBits::storage;
+        gb.normal = kage::registRenderTarget("gbuf_normal_packed", normalDesc, kage::ResourceLifetime::non_transition);
+
+        // rgb9e5 is not renderable, the shared exponent is packed in the fragment shader
+        kage::ImageDesc emissiveDesc;
+        emissiveDesc.depth = 1;
+        emissiveDesc.numLayers = 1;
+        emissiveDesc.numMips = 1;
+        emissiveDesc.format = kage::ResourceFormat::r32_uint;
+        emissiveDesc.usage = kage::ImageUsageFlagBits::transfer_src | kage::ImageUsageFlagBits::sampled | kage::BufferUsageFlagBits::storage;
+        gb.emissive = kage::registRenderTarget("gbuf_emissive_packed", emissiveDesc, kage::ResourceLifetime::non_transition);
+
+        return gb;
+    }
+
     kage::ImageDesc normalDesc;
     normalDesc.depth = 1;
     normalDesc.numLayers = 1;
@@ -49,15 +84,75 @@ const GBuffer createGBuffer()
 const GBuffer aliasGBuffer(const GBuffer& _gb)
 {
     GBuffer result;
+    result.layout = _gb.layout;
     result.albedo = kage::alias(_gb.albedo);
     result.normal = kage::alias(_gb.normal);
-    result.worldPos = kage::alias(_gb.worldPos);
     result.emissive = kage::alias(_gb.emissive);
-    result.specular = kage::alias(_gb.specular);
+
+    if (kage::isValid(_gb.velocity))
+    {
+        result.velocity = kage::alias(_gb.velocity);
+    }
+
+    if (GBufferLayout::full == _gb.layout)
+    {
+        result.worldPos = kage::alias(_gb.worldPos);
+        result.specular = kage::alias(_gb.specular);
+    }
 
     return result;
 }
 
+uint32_t getGBufferImages(const GBuffer& _gb, kage::ImageHandle* _outImages)
+{
+    uint32_t count = 0;
+    if (GBufferLayout::compact == _gb.layout)
+    {
+        _outImages[count++] = _gb.albedo;
+        _outImages[count++] = _gb.normal;
+        _outImages[count++] = _gb.emissive;
+    }
+    else
+    {
+        _outImages[count++] = _gb.albedo;
+        _outImages[count++] = _gb.normal;
+        _outImages[count++] = _gb.worldPos;
+        _outImages[count++] = _gb.emissive;
+        _outImages[count++] = _gb.specular;
+    }
+
+    // the fragment shaders write the velocity right after the layout targets
+    if (kage::isValid(_gb.velocity))
+    {
+        _outImages[count++] = _gb.velocity;
+    }
+
+    return count;
+}
+
+uint32_t getGBufferBytesPerPixel(GBufferLayout _layout)
+{
+    // the default color format is the swapchain one, 4 bytes per pixel
+    return (GBufferLayout::compact == _layout) ? 3 * 4 : 5 * 4;
+}
+
+float getGBufferTrafficMB(GBufferLayout _layout, uint32_t _w, uint32_t _h)
+{
+    // the compact layout reads the d32 depth to reconstruct the position
+    const uint32_t bytesPerPixel = getGBufferBytesPerPixel(_layout) * 2 + ((GBufferLayout::compact == _layout) ? 4 : 0);
+    return float(_w) * float(_h) * float(bytesPerPixel) / (1024.f * 1024.f);
+}
+
+const char* getGBufferFragShaderPath(GBufferLayout _layout, bool _texFeedback /*= false*/)
+{
+    if (_texFeedback)
+    {
+        return (GBufferLayout::compact == _layout) ? "shader/bindless_compact_feedback.frag.spv" : "shader/bindless_feedback.frag.spv";
+    }
+
+    return (GBufferLayout::compact == _layout) ? "shader/bindless_compact.frag.spv" : "shader/bindless.frag.spv";
+}
+
 struct alignas(16) DeferredConstants
 {
     float totalRadius;
@@ -70,6 +165,9 @@ struct alignas(16) DeferredConstants
 
     float w, h;
     float camx, camy, camz;
+    float padding;
+
+    mat4 invViewProj; // only used by the compact g-buffer
 };
 
 
@@ -83,14 +181,26 @@ struct RCAccessData
     float probeSideLen;
 };
 
-void initDeferredShading(DeferredShading& _ds, const GBuffer& _gb, const kage::ImageHandle _sky, const RadianceCascadesData& _rcData)
+void initDeferredShading(DeferredShading& _ds, const GBuffer& _gb, const kage::ImageHandle _depth, const kage::ImageHandle _sky, const RadianceCascadesData& _rcData, const LightClusterData& _lights, const SkyIblData& _ibl)
 {
+    const bool compact = (GBufferLayout::compact == _gb.layout);
+
     kage::ShaderHandle cs = kage::registShader("deferred", "shader/deferred.comp.spv");
     kage::ProgramHandle prog = kage::registProgram("deferred", { cs }, sizeof(DeferredConstants));
 
+    int pipelineSpecs[] = {
+        compact
+        , int(_rcData.format)
+    };
+
+    const kage::Memory* pConst = kage::alloc(sizeof(int) * COUNTOF(pipelineSpecs));
+    memcpy_s(pConst->data, pConst->size, pipelineSpecs, sizeof(int) * COUNTOF(pipelineSpecs));
+
     kage::PassDesc desc;
     desc.prog = prog;
     desc.queue = kage::PassExeQueue::compute;
+    desc.pipelineSpecNum = COUNTOF(pipelineSpecs);
+    desc.pipelineSpecData = (void*)pConst->data;
     kage::PassHandle pass = kage::registPass("deferred", desc);
 
     kage::ImageDesc outColorDesc;
@@ -113,23 +223,61 @@ void initDeferredShading(DeferredShading& _ds, const GBuffer& _gb, const kage::I
         , kage::SamplerReductionMode::min
     );
 
+    // the packed targets are integer formats, no min reduction for them
+    const kage::SamplerReductionMode packedReduction = compact
+        ? kage::SamplerReductionMode::weighted_average
+        : kage::SamplerReductionMode::min;
+
     kage::SamplerHandle normSamp = kage::sampleImage(pass, _gb.normal
         , Stage::compute_shader
         , kage::SamplerFilter::nearest
         , kage::SamplerMipmapMode::nearest
         , kage::SamplerAddressMode::clamp_to_edge
-        , kage::SamplerReductionMode::min
+        , packedReduction
     );
 
-    kage::SamplerHandle wpSamp = kage::sampleImage(pass, _gb.worldPos
+    kage::SamplerHandle emmiSamp = kage::sampleImage(pass, _gb.emissive
         , Stage::compute_shader
         , kage::SamplerFilter::nearest
         , kage::SamplerMipmapMode::nearest
         , kage::SamplerAddressMode::clamp_to_edge
-        , kage::SamplerReductionMode::min
+        , packedReduction
     );
 
-    kage::SamplerHandle emmiSamp = kage::sampleImage(pass, _gb.emissive
+    kage::SamplerHandle wpSamp;
+    kage::SamplerHandle specSamp;
+    kage::SamplerHandle depthSamp;
+    if (compact)
+    {
+        // the world position is reconstructed from the depth
+        depthSamp = kage::sampleImage(pass, _depth
+            , Stage::compute_shader
+            , kage::SamplerFilter::nearest
+            , kage::SamplerMipmapMode::nearest
+            , kage::SamplerAddressMode::clamp_to_edge
+            , kage::SamplerReductionMode::min
+        );
+    }
+    else
+    {
+        wpSamp = kage::sampleImage(pass, _gb.worldPos
+            , Stage::compute_shader
+            , kage::SamplerFilter::nearest
+            , kage::SamplerMipmapMode::nearest
+            , kage::SamplerAddressMode::clamp_to_edge
+            , kage::SamplerReductionMode::min
+        );
+
+        specSamp = kage::sampleImage(pass, _gb.specular
+            , Stage::compute_shader
+            , kage::SamplerFilter::nearest
+            , kage::SamplerMipmapMode::nearest
+            , kage::SamplerAddressMode::clamp_to_edge
+            , kage::SamplerReductionMode::min
+        );
+    }
+
+    kage::SamplerHandle skySamp = kage::sampleImage(pass, _sky
         , Stage::compute_shader
         , kage::SamplerFilter::nearest
         , kage::SamplerMipmapMode::nearest
@@ -137,20 +285,18 @@ void initDeferredShading(DeferredShading& _ds, const GBuffer& _gb, const kage::I
         , kage::SamplerReductionMode::min
     );
 
-    kage::SamplerHandle specSamp = kage::sampleImage(pass, _gb.specular
+    // the prefiltered mips are picked by the roughness
+    kage::SamplerHandle iblSamp = kage::sampleImage(pass, _ibl.specular
         , Stage::compute_shader
-        , kage::SamplerFilter::nearest
-        , kage::SamplerMipmapMode::nearest
+        , kage::SamplerFilter::linear
+        , kage::SamplerMipmapMode::linear
         , kage::SamplerAddressMode::clamp_to_edge
-        , kage::SamplerReductionMode::min
+        , kage::SamplerReductionMode::weighted_average
     );
 
-    kage::SamplerHandle skySamp = kage::sampleImage(pass, _sky
+    kage::bindBuffer(pass, _ibl.sh
         , Stage::compute_shader
-        , kage::SamplerFilter::nearest
-        , kage::SamplerMipmapMode::nearest
-        , kage::SamplerAddressMode::clamp_to_edge
-        , kage::SamplerReductionMode::min
+        , Access::shader_read
     );
 
     _ds.outColorAlias = kage::alias(outColor);
@@ -161,6 +307,20 @@ void initDeferredShading(DeferredShading& _ds, const GBuffer& _gb, const kage::I
         , _ds.outColorAlias
     );
 
+    kage::bindBuffer(pass, _lights.lights
+        , Stage::compute_shader
+        , Access::shader_read
+    );
+
+    kage::bindBuffer(pass, _lights.config
+        , Stage::compute_shader
+        , Access::shader_read
+    );
+
+    kage::bindBuffer(pass, _lights.clusters
+        , Stage::compute_shader
+        , Access::shader_read
+    );
 
 
     if (kage::kUseRadianceCascade) {
@@ -169,9 +329,12 @@ void initDeferredShading(DeferredShading& _ds, const GBuffer& _gb, const kage::I
             , Access::shader_read
         );
 
+        // the packed cascades are fetched and filtered by hand
+        const bool packed = (RCStorageFormat::rgb9e5 == _rcData.format);
+
         kage::SamplerHandle rcSamp = kage::sampleImage(pass, _rcData.cascades
             , Stage::compute_shader
-            , kage::SamplerFilter::linear
+            , packed ? kage::SamplerFilter::nearest : kage::SamplerFilter::linear
             , kage::SamplerMipmapMode::linear
             , kage::SamplerAddressMode::mirrored_repeat
             , kage::SamplerReductionMode::weighted_average
@@ -206,18 +369,29 @@ void initDeferredShading(DeferredShading& _ds, const GBuffer& _gb, const kage::I
     _ds.gBufSamplers.emissive = emmiSamp;
     _ds.gBufSamplers.specular = specSamp;
 
+    if (compact)
+    {
+        _ds.depth = _depth;
+        _ds.depthSampler = depthSamp;
+    }
+
     _ds.inSky = _sky;
     _ds.skySampler = skySamp;
+
+    _ds.lights = _lights;
+
+    _ds.ibl = _ibl;
+    _ds.iblSampler = iblSamp;
 }
 
-void recDeferredShading(const DeferredShading& _ds, const uint32_t _w, const uint32_t _h, const vec3 _camPos, const float _totalRadius, const uint32_t _idxType, const Dbg_RadianceCascades& _rc)
+void recDeferredShading(const DeferredShading& _ds, const uint32_t _w, const uint32_t _h, const vec3 _camPos, const mat4& _invViewProj, const float _totalRadius, const uint32_t _idxType, const Dbg_RadianceCascades& _rc)
 {
     kage::startRec(_ds.pass);
     DeferredConstants consts;
     
     consts.totalRadius = _rc.totalRadius;
-    consts.cascade_0_probGridCount = kage::k_rclv0_probeSideCount;
-    consts.cascade_0_rayGridCount = kage::k_rclv0_rayGridSideCount;
+    consts.cascade_0_probGridCount = getRCProbeSideCount(_rc);
+    consts.cascade_0_rayGridCount = getRCRayGridSideCount(_rc);
     consts.startCascade = _rc.startCascade;
     consts.cascadeCount = _rc.cascadeCount;
     consts.debugIdxType = _rc.idx_type;
@@ -237,6 +411,8 @@ void recDeferredShading(const DeferredShading& _ds, const uint32_t _w, const uin
     consts.camx = campos[0];
     consts.camy = campos[1];
     consts.camz = campos[2];
+    consts.padding = 0.f;
+    consts.invViewProj = _invViewProj;
 
     const kage::Memory* mem = kage::alloc(sizeof(consts));
     memcpy(mem->data, &consts, sizeof(consts));
@@ -244,19 +420,31 @@ void recDeferredShading(const DeferredShading& _ds, const uint32_t _w, const uin
 
 
 
+    // the compact layout reads the depth instead of the world position, the albedo is a placeholder of the specular
+    const bool compact = (GBufferLayout::compact == _ds.gBuffer.layout);
+    const kage::ImageHandle posImg = compact ? _ds.depth : _ds.gBuffer.worldPos;
+    const kage::SamplerHandle posSamp = compact ? _ds.depthSampler : _ds.gBufSamplers.worldPos;
+    const kage::ImageHandle specImg = compact ? _ds.gBuffer.albedo : _ds.gBuffer.specular;
+    const kage::SamplerHandle specSamp = compact ? _ds.gBufSamplers.albedo : _ds.gBufSamplers.specular;
+
     if (kage::kUseRadianceCascade) {
         kage::Binding binds[] =
         {
             {_ds.gBuffer.albedo,    _ds.gBufSamplers.albedo,    Stage::compute_shader},
             {_ds.gBuffer.normal,    _ds.gBufSamplers.normal,    Stage::compute_shader},
-            {_ds.gBuffer.worldPos,  _ds.gBufSamplers.worldPos,  Stage::compute_shader},
+            {posImg,                posSamp,                    Stage::compute_shader},
             {_ds.gBuffer.emissive,  _ds.gBufSamplers.emissive,  Stage::compute_shader},
-            {_ds.gBuffer.specular,  _ds.gBufSamplers.specular,  Stage::compute_shader},
+            {specImg,               specSamp,                   Stage::compute_shader},
             {_ds.inSky,             _ds.skySampler,             Stage::compute_shader},
+            {_ds.ibl.specular,      _ds.iblSampler,             Stage::compute_shader},
+            {_ds.ibl.sh,            BindingAccess::read,        Stage::compute_shader},
             {_ds.rcAccessData,      BindingAccess::read,        Stage::compute_shader},
             {_ds.radianceCascades,  _ds.rcSampler,              Stage::compute_shader},
             {_ds.rcMergedData,      _ds.rcMergedSampler,        Stage::compute_shader},
             {_ds.outColor,          0,                          Stage::compute_shader},
+            {_ds.lights.lights,     BindingAccess::read,        Stage::compute_shader},
+            {_ds.lights.config,     BindingAccess::read,        Stage::compute_shader},
+            {_ds.lights.clusters,   BindingAccess::read,        Stage::compute_shader},
         };
 
         kage::pushBindings(binds, COUNTOF(binds));
@@ -267,11 +455,16 @@ void recDeferredShading(const DeferredShading& _ds, const uint32_t _w, const uin
         {
             {_ds.gBuffer.albedo,    _ds.gBufSamplers.albedo,    Stage::compute_shader},
             {_ds.gBuffer.normal,    _ds.gBufSamplers.normal,    Stage::compute_shader},
-            {_ds.gBuffer.worldPos,  _ds.gBufSamplers.worldPos,  Stage::compute_shader},
+            {posImg,                posSamp,                    Stage::compute_shader},
             {_ds.gBuffer.emissive,  _ds.gBufSamplers.emissive,  Stage::compute_shader},
-            {_ds.gBuffer.specular,  _ds.gBufSamplers.specular,  Stage::compute_shader},
+            {specImg,               specSamp,                   Stage::compute_shader},
             {_ds.inSky,             _ds.skySampler,             Stage::compute_shader},
+            {_ds.ibl.specular,      _ds.iblSampler,             Stage::compute_shader},
+            {_ds.ibl.sh,            BindingAccess::read,        Stage::compute_shader},
             {_ds.outColor,          0,                          Stage::compute_shader},
+            {_ds.lights.lights,     BindingAccess::read,        Stage::compute_shader},
+            {_ds.lights.config,     BindingAccess::read,        Stage::compute_shader},
+            {_ds.lights.clusters,   BindingAccess::read,        Stage::compute_shader},
         };
 
         kage::pushBindings(binds, COUNTOF(binds));
@@ -282,16 +475,17 @@ void recDeferredShading(const DeferredShading& _ds, const uint32_t _w, const uin
     kage::endRec();
 }
 
-void updateBuffers(const DeferredShading& _ds, const float _tatalRadius)
+void updateBuffers(const DeferredShading& _ds, const float _tatalRadius, const Dbg_RadianceCascades& _rc)
 {
     if (kage::kUseRadianceCascade) {
+        // the levels without a probe are left zeroed
         std::vector<RCAccessData> consts(kage::k_rclv0_cascadeLv);
         uint32_t offset = 0;
-        for (size_t ii = 0; ii < kage::k_rclv0_cascadeLv; ii++)
+        for (size_t ii = 0; ii < getRCLevelCount(_rc); ii++)
         {
             uint32_t level_factor = uint32_t(1u << ii);
-            uint32_t probeSideCount = kage::k_rclv0_probeSideCount / level_factor;
-            uint32_t raySideCount = kage::k_rclv0_rayGridSideCount * level_factor;
+            uint32_t probeSideCount = getRCProbeSideCount(_rc) / level_factor;
+            uint32_t raySideCount = getRCRayGridSideCount(_rc) * level_factor;
 
             consts[ii].lv = (uint32_t)ii;
             consts[ii].raySideCount = raySideCount;
@@ -310,8 +504,8 @@ void updateBuffers(const DeferredShading& _ds, const float _tatalRadius)
 
 }
 
-void updateDeferredShading(const DeferredShading& _ds, const uint32_t _w, const uint32_t _h, const vec3 _camPos, const float _tatalRadius, const uint32_t _idxType, const Dbg_RadianceCascades& _rc)
+void updateDeferredShading(const DeferredShading& _ds, const uint32_t _w, const uint32_t _h, const vec3 _camPos, const mat4& _invViewProj, const float _tatalRadius, const uint32_t _idxType, const Dbg_RadianceCascades& _rc)
 {
-    updateBuffers(_ds, _tatalRadius);
-    recDeferredShading(_ds, _w, _h, _camPos, _tatalRadius, _idxType, _rc);
+    updateBuffers(_ds, _tatalRadius, _rc);
+    recDeferredShading(_ds, _w, _h, _camPos, _invViewProj, _tatalRadius, _idxType, _rc);
 }
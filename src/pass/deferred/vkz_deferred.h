@@ -3,14 +3,33 @@
 #include "core/kage.h"
 #include "core/kage_math.h"
 #include "demo_structs.h"
+#include "deferred/vkz_light_cluster.h"
+#include "deferred/vkz_sky_ibl.h"
+#include "radiance_cascade/vkz_rc_common.h"
+
+// keep sync with the COMPACT_GBUFFER in deferred.comp.glsl and the packing in gbuffer.h
+enum class GBufferLayout : uint8_t
+{
+    full,       // albedo, normal, world pos, emissive, specular in the default color format
+    compact,    // albedo + occlusion, octahedral normal + roughness/metalness, rgb9e5 emissive. position from depth
+};
+
+// 5 targets of the full layout + the optional velocity
+constexpr uint32_t kMaxGBufferImages = 6;
 
 struct GBuffer
 {
+    GBufferLayout layout{ GBufferLayout::full };
+
+    // worldPos and specular are not used by the compact layout
     kage::ImageHandle albedo;
     kage::ImageHandle normal;
     kage::ImageHandle worldPos;
     kage::ImageHandle emissive;
     kage::ImageHandle specular;
+
+    // optional, the screen motion in uv for the temporal upscaling, always the last attachment
+    kage::ImageHandle velocity;
 };
 
 struct GBufferSamplers
@@ -26,6 +45,8 @@ struct RadianceCascadesData
 {
     kage::ImageHandle cascades{};
     kage::ImageHandle mergedCascade{};
+
+    RCStorageFormat format{ RCStorageFormat::rgba8 };
 };
 
 struct DeferredShading
@@ -37,6 +58,10 @@ struct DeferredShading
     kage::ShaderHandle cs;
     kage::ProgramHandle prog;
 
+    // only sampled by the compact g-buffer
+    kage::ImageHandle depth;
+    kage::SamplerHandle depthSampler;
+
     kage::ImageHandle inSky;
     kage::SamplerHandle skySampler;
 
@@ -47,11 +72,30 @@ struct DeferredShading
     kage::ImageHandle rcMergedData;
     kage::SamplerHandle rcMergedSampler;
 
+    LightClusterData lights;
+
+    // the ambient of the sky
+    SkyIblData ibl;
+    kage::SamplerHandle iblSampler;
+
     kage::ImageHandle outColor;
     kage::ImageHandle outColorAlias;
 };
 
-const GBuffer createGBuffer();
+const GBuffer createGBuffer(GBufferLayout _layout = GBufferLayout::full, bool _velocity = false);
 const GBuffer aliasGBuffer(const GBuffer& _gb);
-void initDeferredShading(DeferredShading& _ds, const GBuffer& _gb, const kage::ImageHandle _sky, const RadianceCascadesData& _rcData);
-void updateDeferredShading(const DeferredShading& _ds, const uint32_t _w, const uint32_t _h, const vec3 _camPos, const float _tatalRadius, const uint32_t _idxType, const Dbg_RadianceCascades& _rc);
\ No newline at end of file
+
+// the color attachments in the order of the fragment shader outputs, returns the count
+uint32_t getGBufferImages(const GBuffer& _gb, kage::ImageHandle* _outImages);
+
+// bytes per pixel of all the g-buffer targets, the depth is not included
+uint32_t getGBufferBytesPerPixel(GBufferLayout _layout);
+
+// estimated g-buffer traffic of a frame in MB: written by the raster once, read by the deferred once
+float getGBufferTrafficMB(GBufferLayout _layout, uint32_t _w, uint32_t _h);
+
+// _texFeedback: the variant writing the texture streaming feedback, the buffer is bound after the hard raster bindings
+const char* getGBufferFragShaderPath(GBufferLayout _layout, bool _texFeedback = false);
+
+void initDeferredShading(DeferredShading& _ds, const GBuffer& _gb, const kage::ImageHandle _depth, const kage::ImageHandle _sky, const RadianceCascadesData& _rcData, const LightClusterData& _lights, const SkyIblData& _ibl);
+void updateDeferredShading(const DeferredShading& _ds, const uint32_t _w, const uint32_t _h, const vec3 _camPos, const mat4& _invViewProj, const float _tatalRadius, const uint32_t _idxType, const Dbg_RadianceCascades& _rc);
\ No newline at end of file
@@ -0,0 +1,318 @@
+#include "deferred/vkz_light_cluster.h"
+#include "vkz_pass.h"
+
+#include "core/profiler.h"
+#include "bx/timer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+static float getSliceNear(const LightClusterConfig& _cfg, uint32_t _slice)
+{
+    return _cfg.znear * powf(_cfg.zfar / _cfg.znear, float(_slice) / float(_cfg.gridZ));
+}
+
+static uint32_t getSlice(const LightClusterConfig& _cfg, float _viewZ)
+{
+    const float z = glm::max(_viewZ, _cfg.znear);
+    const float slice = logf(z / _cfg.znear) / logf(_cfg.zfar / _cfg.znear) * float(_cfg.gridZ);
+    return glm::min(uint32_t(slice), _cfg.gridZ - 1);
+}
+
+// keep sync with getFrustumAabb in light_cluster.comp.glsl
+static void getFrustumAabb(const LightClusterConfig& _cfg, const vec4& _uvRect, float _zNear, float _zFar, vec3& _min, vec3& _max)
+{
+    const vec2 ndcMin = vec2(_uvRect.x * 2.f - 1.f, 1.f - _uvRect.w * 2.f);
+    const vec2 ndcMax = vec2(_uvRect.z * 2.f - 1.f, 1.f - _uvRect.y * 2.f);
+    const vec2 scale = vec2(1.f / _cfg.P00, 1.f / _cfg.P11);
+
+    const vec2 n0 = ndcMin * scale * _zNear;
+    const vec2 n1 = ndcMax * scale * _zNear;
+    const vec2 f0 = ndcMin * scale * _zFar;
+    const vec2 f1 = ndcMax * scale * _zFar;
+
+    _min = vec3(glm::min(glm::min(n0, n1), glm::min(f0, f1)), _zNear);
+    _max = vec3(glm::max(glm::max(n0, n1), glm::max(f0, f1)), _zFar);
+}
+
+static bool sphereAabbIntersect(const vec3& _center, float _radius, const vec3& _min, const vec3& _max)
+{
+    const vec3 d = glm::max(_min - _center, vec3(0.f)) + glm::max(_center - _max, vec3(0.f));
+    return glm::dot(d, d) <= _radius * _radius;
+}
+
+void buildLightClustersCpu(const LightClusterConfig& _config, const PunctualLight* _lights, std::vector<uint32_t>& _outClusters, uint32_t* _outPairs /*= nullptr*/, uint32_t* _outMaxCount /*= nullptr*/)
+{
+    KG_ZoneScopedC(kage::Color::blue);
+
+    const uint32_t clusterCount = _config.gridX * _config.gridY * _config.gridZ;
+    _outClusters.assign(clusterCount * (1 + kLightClusterMaxLights), 0u);
+
+    uint32_t pairs = 0;
+    for (uint32_t li = 0; li < _config.lightCount; ++li)
+    {
+        const PunctualLight& light = _lights[li];
+        const vec3 center = vec3(_config.view * vec4(light.pos, 1.f));
+
+        // behind the camera or beyond the last slice
+        if (center.z + light.range < _config.znear || center.z - light.range > _config.zfar)
+            continue;
+
+        const uint32_t s0 = getSlice(_config, center.z - light.range);
+        const uint32_t s1 = getSlice(_config, center.z + light.range);
+
+        for (uint32_t slice = s0; slice <= s1; ++slice)
+        {
+            const float zNear = getSliceNear(_config, slice);
+            const float zFar = getSliceNear(_config, slice + 1);
+
+            for (uint32_t ty = 0; ty < _config.gridY; ++ty)
+            {
+                for (uint32_t tx = 0; tx < _config.gridX; ++tx)
+                {
+                    const vec2 tileMin = vec2(float(tx * kLightClusterTileSize), float(ty * kLightClusterTileSize));
+                    const vec2 tileMax = glm::min(tileMin + vec2(float(kLightClusterTileSize)), vec2(_config.screenWidth, _config.screenHeight));
+                    const vec4 uvRect = vec4(tileMin, tileMax) / vec4(_config.screenWidth, _config.screenHeight, _config.screenWidth, _config.screenHeight);
+
+                    vec3 aabbMin, aabbMax;
+                    getFrustumAabb(_config, uvRect, zNear, zFar, aabbMin, aabbMax);
+
+                    if (!sphereAabbIntersect(center, light.range, aabbMin, aabbMax))
+                        continue;
+
+                    const uint32_t ci = (slice * _config.gridY + ty) * _config.gridX + tx;
+                    uint32_t& count = _outClusters[ci];
+                    if (count < kLightClusterMaxLights)
+                    {
+                        _outClusters[clusterCount + ci * kLightClusterMaxLights + count] = li;
+                        count++;
+                        pairs++;
+                    }
+                }
+            }
+        }
+    }
+
+    if (_outPairs)
+        *_outPairs = pairs;
+
+    if (_outMaxCount)
+    {
+        uint32_t maxCount = 0;
+        for (uint32_t ci = 0; ci < clusterCount; ++ci)
+            maxCount = glm::max(maxCount, _outClusters[ci]);
+
+        *_outMaxCount = maxCount;
+    }
+}
+
+void initLightCluster(LightCluster& _lc, const LightClusterInitData& _initData)
+{
+    const uint32_t gridX = (_initData.width + kLightClusterTileSize - 1) / kLightClusterTileSize;
+    const uint32_t gridY = (_initData.height + kLightClusterTileSize - 1) / kLightClusterTileSize;
+    const uint32_t clusterCount = gridX * gridY * kLightClusterSlices;
+    const uint32_t maxLights = glm::max(1u, _initData.maxLights);
+
+    kage::ShaderHandle cs = kage::registShader("light_cluster", "shader/light_cluster.comp.spv");
+    kage::ProgramHandle prog = kage::registProgram("light_cluster", { cs });
+
+    kage::PassDesc passDesc;
+    passDesc.prog = prog;
+    passDesc.queue = kage::PassExeQueue::compute;
+    kage::PassHandle pass = kage::registPass("light_cluster", passDesc);
+
+    kage::BufferHandle lightBuf;
+    {
+        kage::BufferDesc desc;
+        desc.size = maxLights * sizeof(PunctualLight);
+        desc.usage = kage::BufferUsageFlagBits::storage | kage::BufferUsageFlagBits::transfer_dst;
+        desc.memFlags = kage::MemoryPropFlagBits::device_local;
+        lightBuf = kage::registBuffer("punctual_lights", desc);
+    }
+
+    kage::BufferHandle configBuf;
+    {
+        kage::BufferDesc desc;
+        desc.size = sizeof(LightClusterConfig);
+        desc.usage = kage::BufferUsageFlagBits::uniform | kage::BufferUsageFlagBits::transfer_dst;
+        desc.memFlags = kage::MemoryPropFlagBits::device_local | kage::MemoryPropFlagBits::host_visible;
+        configBuf = kage::registBuffer("light_cluster_config", desc);
+    }
+
+    // light counts, then kLightClusterMaxLights indices per cluster
+    kage::BufferHandle clusterBuf;
+    {
+        kage::BufferDesc desc;
+        desc.size = clusterCount * (1 + kLightClusterMaxLights) * sizeof(uint32_t);
+        desc.usage = kage::BufferUsageFlagBits::storage | kage::BufferUsageFlagBits::transfer_dst;
+        desc.memFlags = kage::MemoryPropFlagBits::device_local;
+        clusterBuf = kage::registBuffer("light_clusters", desc);
+    }
+
+    kage::bindBuffer(pass, configBuf
+        , Stage::compute_shader
+        , Access::shader_read
+    );
+
+    kage::bindBuffer(pass, lightBuf
+        , Stage::compute_shader
+        , Access::shader_read
+    );
+
+    kage::SamplerHandle samp = kage::sampleImage(pass, _initData.pyramid
+        , Stage::compute_shader
+        , kage::SamplerFilter::linear
+        , kage::SamplerMipmapMode::nearest
+        , kage::SamplerAddressMode::clamp_to_edge
+        , kage::SamplerReductionMode::min
+    );
+
+    kage::BufferHandle clusterBufOutAlias = kage::alias(clusterBuf);
+    kage::bindBuffer(pass, clusterBuf
+        , Stage::compute_shader
+        , Access::shader_write
+        , clusterBufOutAlias
+    );
+
+    _lc.pass = pass;
+    _lc.cs = cs;
+    _lc.prog = prog;
+
+    _lc.lightBuf = lightBuf;
+    _lc.configBuf = configBuf;
+    _lc.pyramid = _initData.pyramid;
+    _lc.pyramidSampler = samp;
+
+    _lc.clusterBuf = clusterBuf;
+    _lc.clusterBufOutAlias = clusterBufOutAlias;
+
+    _lc.gridX = gridX;
+    _lc.gridY = gridY;
+    _lc.maxLights = maxLights;
+}
+
+const LightClusterData getLightClusterData(const LightCluster& _lc)
+{
+    return LightClusterData{ _lc.lightBuf, _lc.configBuf, _lc.clusterBufOutAlias };
+}
+
+void setLights(LightCluster& _lc, const PunctualLight* _lights, uint32_t _count)
+{
+    const uint32_t count = glm::min(_count, _lc.maxLights);
+    _lc.lights.assign(_lights, _lights + count);
+    _lc.lightsDirty = true;
+}
+
+void generateRandomLights(std::vector<PunctualLight>& _outLights, uint32_t _count, float _radius, uint32_t _seed /*= 0*/)
+{
+    std::minstd_rand rng(_seed);
+    std::uniform_real_distribution<float> unorm(0.f, 1.f);
+    std::uniform_real_distribution<float> snorm(-1.f, 1.f);
+
+    _outLights.resize(_count);
+    for (uint32_t ii = 0; ii < _count; ++ii)
+    {
+        vec3 p;
+        do
+        {
+            p = vec3(snorm(rng), snorm(rng), snorm(rng));
+        } while (glm::dot(p, p) > 1.f);
+
+        PunctualLight& light = _outLights[ii];
+        light.pos = p * _radius;
+        light.range = _radius * glm::mix(0.02f, 0.08f, unorm(rng));
+        light.color = glm::normalize(vec3(unorm(rng), unorm(rng), unorm(rng)) + vec3(0.1f));
+
+        // the inverse square falloff, keep the brightness near the range similar
+        light.intensity = light.range * light.range * 0.5f;
+
+        if (0 == (ii & 3))
+        {
+            light.dir = glm::normalize(vec3(snorm(rng) * 0.5f, -1.f, snorm(rng) * 0.5f));
+            light.spotCos = cosf(glm::radians(glm::mix(20.f, 45.f, unorm(rng))));
+        }
+        else
+        {
+            light.dir = vec3(0.f, -1.f, 0.f);
+            light.spotCos = -1.f;
+        }
+    }
+}
+
+static void recLightCluster(const LightCluster& _lc)
+{
+    KG_ZoneScopedC(kage::Color::blue);
+
+    kage::startRec(_lc.pass);
+
+    // the clusters are uploaded from the cpu build
+    if (!_lc.useCpuBuild)
+    {
+        kage::Binding binds[] =
+        {
+            { _lc.configBuf,    BindingAccess::read,    Stage::compute_shader },
+            { _lc.lightBuf,     BindingAccess::read,    Stage::compute_shader },
+            { _lc.pyramid,      _lc.pyramidSampler,     Stage::compute_shader },
+            { _lc.clusterBuf,   BindingAccess::write,   Stage::compute_shader },
+        };
+        kage::pushBindings(binds, COUNTOF(binds));
+
+        // one workgroup per tile
+        kage::dispatch(_lc.gridX * kLightClusterSlices, _lc.gridY, 1);
+    }
+
+    kage::endRec();
+}
+
+void updateLightCluster(LightCluster& _lc, const TransformData& _trans, const Constants& _consts, bool _pausePyramid /*= false*/)
+{
+    KG_ZoneScopedC(kage::Color::blue);
+
+    if (_lc.lightsDirty && !_lc.lights.empty())
+    {
+        const kage::Memory* mem = kage::alloc(uint32_t(_lc.lights.size() * sizeof(PunctualLight)));
+        memcpy(mem->data, _lc.lights.data(), mem->size);
+        kage::updateBuffer(_lc.lightBuf, mem, 0, mem->size);
+    }
+    _lc.lightsDirty = false;
+
+    LightClusterConfig config{};
+    config.view = _trans.view;
+    config.gridX = _lc.gridX;
+    config.gridY = _lc.gridY;
+    config.gridZ = kLightClusterSlices;
+    config.lightCount = (uint32_t)_lc.lights.size();
+    config.znear = _consts.znear;
+    config.zfar = _consts.zfar;
+    config.screenWidth = _consts.screenWidth;
+    config.screenHeight = _consts.screenHeight;
+    config.P00 = _consts.P00;
+    config.P11 = _consts.P11;
+    config.pyramidWidth = _consts.pyramidWidth;
+    config.pyramidHeight = _consts.pyramidHeight;
+
+    // the paused pyramid is from another view
+    config.usePyramid = _pausePyramid ? 0 : 1;
+
+    {
+        const kage::Memory* mem = kage::alloc(sizeof(LightClusterConfig));
+        memcpy(mem->data, &config, mem->size);
+        kage::updateBuffer(_lc.configBuf, mem);
+    }
+
+    if (_lc.useCpuBuild)
+    {
+        int64_t start = bx::getHPCounter();
+
+        buildLightClustersCpu(config, _lc.lights.data(), _lc.cpuClusters, &_lc.cpuLightPairs, &_lc.cpuMaxClusterLights);
+
+        const kage::Memory* mem = kage::alloc(uint32_t(_lc.cpuClusters.size() * sizeof(uint32_t)));
+        memcpy(mem->data, _lc.cpuClusters.data(), mem->size);
+        kage::updateBuffer(_lc.clusterBuf, mem, 0, mem->size);
+
+        _lc.cpuTime = float(double(bx::getHPCounter() - start) / double(bx::getHPFrequency()) * 1000.0);
+    }
+
+    recLightCluster(_lc);
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "core/kage.h"
+#include "core/kage_math.h"
+#include "demo_structs.h"
+
+#include <vector>
+
+// clustered punctual lights for the deferred shading
+// lights are culled into a froxel grid: screen tiles x exponential depth slices
+// tiles behind the farthest depth of the pyramid are skipped, each cluster keeps at most kLightClusterMaxLights
+// keep sync with light_gpu.h
+constexpr uint32_t kLightClusterTileSize = 64;
+constexpr uint32_t kLightClusterSlices = 32;
+constexpr uint32_t kLightClusterMaxLights = 64;
+
+struct alignas(16) PunctualLight
+{
+    vec3 pos;
+    float range;
+
+    vec3 color;
+    float intensity;
+
+    vec3 dir;
+    float spotCos{ -1.f }; // <= -1 is a point light
+};
+
+struct alignas(16) LightClusterConfig
+{
+    mat4 view;
+
+    uint32_t gridX, gridY, gridZ;
+    uint32_t lightCount;
+
+    float znear, zfar;
+    float screenWidth, screenHeight;
+
+    float P00, P11;
+    float pyramidWidth, pyramidHeight;
+
+    uint32_t usePyramid;
+    uint32_t padding0, padding1, padding2;
+};
+
+struct LightClusterInitData
+{
+    kage::ImageHandle pyramid;
+
+    uint32_t width;
+    uint32_t height;
+
+    uint32_t maxLights{ 8192 };
+};
+
+// the resources deferred shading reads the lights from
+struct LightClusterData
+{
+    kage::BufferHandle lights;
+    kage::BufferHandle config;
+    kage::BufferHandle clusters;
+};
+
+struct LightCluster
+{
+    kage::PassHandle pass;
+    kage::ShaderHandle cs;
+    kage::ProgramHandle prog;
+
+    // read-only
+    kage::BufferHandle lightBuf;
+    kage::BufferHandle configBuf;
+    kage::ImageHandle pyramid;
+    kage::SamplerHandle pyramidSampler;
+
+    // write
+    kage::BufferHandle clusterBuf;
+
+    // out alias
+    kage::BufferHandle clusterBufOutAlias;
+
+    uint32_t gridX{ 0 };
+    uint32_t gridY{ 0 };
+    uint32_t maxLights{ 0 };
+
+    // cpu copy of the lights, uploaded when changed
+    std::vector<PunctualLight> lights;
+    bool lightsDirty{ false };
+
+    // build the clusters on the cpu and upload them instead of the dispatch, for validation
+    bool useCpuBuild{ false };
+    std::vector<uint32_t> cpuClusters;
+
+    // stats of the last cpu build
+    uint32_t cpuLightPairs{ 0 };
+    uint32_t cpuMaxClusterLights{ 0 };
+    float cpuTime{ 0.f };
+};
+
+void initLightCluster(LightCluster& _lc, const LightClusterInitData& _initData);
+
+const LightClusterData getLightClusterData(const LightCluster& _lc);
+
+// lights over the maxLights are dropped
+void setLights(LightCluster& _lc, const PunctualLight* _lights, uint32_t _count);
+
+// the same layout as light_cluster.comp.glsl without the pyramid rejection
+// the order inside a cluster may differ from the gpu one
+void buildLightClustersCpu(const LightClusterConfig& _config, const PunctualLight* _lights, std::vector<uint32_t>& _outClusters, uint32_t* _outPairs = nullptr, uint32_t* _outMaxCount = nullptr);
+
+// lights with random colors in a sphere of _radius around the origin, a quarter of them are spot lights
+void generateRandomLights(std::vector<PunctualLight>& _outLights, uint32_t _count, float _radius, uint32_t _seed = 0);
+
+void updateLightCluster(LightCluster& _lc, const TransformData& _trans, const Constants& _consts, bool _pausePyramid = false);
@@ -0,0 +1,585 @@
+#include "deferred/vkz_sky_ibl.h"
+#include "vkz_pass.h"
+
+#include "core/profiler.h"
+#include "bx/timer.h"
+#include "glm/glm.hpp"
+#include "glm/gtc/constants.hpp"
+#include "glm/gtc/packing.hpp"
+
+#include <ktx.h>
+#include <stdio.h>
+
+constexpr uint32_t kSkyIblCacheMagic = 0x4c424953; // 'SIBL'
+constexpr uint32_t kSkyIblCacheVersion = 1;
+
+struct SkyIblCacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t specularSize;
+    uint32_t specularMips;
+    uint32_t sampleCount;
+    uint32_t shSize;
+
+    // rebake if the sky is replaced
+    uint64_t srcFileSize;
+};
+
+static uint32_t getSpecularTexelCount()
+{
+    uint32_t count = 0;
+    for (uint32_t mip = 0; mip < kSkyIblSpecularMips; ++mip)
+    {
+        const uint32_t size = glm::max(1u, kSkyIblSpecularSize >> mip);
+        count += size * size * 6;
+    }
+    return count;
+}
+
+static uint64_t getFileSize(const char* _path)
+{
+    FILE* file = fopen(_path, "rb");
+    if (!file)
+        return 0;
+
+    fseek(file, 0, SEEK_END);
+    const uint64_t size = (uint64_t)ftell(file);
+    fclose(file);
+
+    return size;
+}
+
+static void getCachePath(char* _out, uint32_t _maxSize, const char* _ktxPath)
+{
+    snprintf(_out, _maxSize, "%s.ibl", _ktxPath);
+}
+
+static SkyIblCacheHeader makeCacheHeader(const char* _ktxPath)
+{
+    SkyIblCacheHeader header{};
+    header.magic = kSkyIblCacheMagic;
+    header.version = kSkyIblCacheVersion;
+    header.specularSize = kSkyIblSpecularSize;
+    header.specularMips = kSkyIblSpecularMips;
+    header.sampleCount = kSkyIblSampleCount;
+    header.shSize = kSkyIblShSize;
+    header.srcFileSize = getFileSize(_ktxPath);
+    return header;
+}
+
+// ==============================================================================
+// cpu reference, keep sync with sky_ibl.h, sky_prefilter.comp.glsl and sky_sh.comp.glsl
+
+struct CpuSkyCube
+{
+    const uint8_t* faces[6];
+    uint32_t size;
+};
+
+// keep sync with skyCubeDir in sky_ibl.h
+static vec3 skyCubeDir(uint32_t _face, vec2 _uv)
+{
+    vec3 dir;
+    switch (_face)
+    {
+    case 0: dir = vec3(1.f, -_uv.y, -_uv.x); break;
+    case 1: dir = vec3(-1.f, -_uv.y, _uv.x); break;
+    case 2: dir = vec3(_uv.x, 1.f, _uv.y); break;
+    case 3: dir = vec3(_uv.x, -1.f, -_uv.y); break;
+    case 4: dir = vec3(_uv.x, -_uv.y, 1.f); break;
+    default: dir = vec3(-_uv.x, -_uv.y, -1.f); break;
+    }
+    return glm::normalize(dir);
+}
+
+// the inverse of skyCubeDir
+static uint32_t skyCubeFace(const vec3& _dir, vec2& _uv)
+{
+    const vec3 a = glm::abs(_dir);
+    if (a.x >= a.y && a.x >= a.z)
+    {
+        _uv = (_dir.x > 0.f) ? vec2(-_dir.z, -_dir.y) / a.x : vec2(_dir.z, -_dir.y) / a.x;
+        return (_dir.x > 0.f) ? 0 : 1;
+    }
+
+    if (a.y >= a.z)
+    {
+        _uv = (_dir.y > 0.f) ? vec2(_dir.x, _dir.z) / a.y : vec2(_dir.x, -_dir.z) / a.y;
+        return (_dir.y > 0.f) ? 2 : 3;
+    }
+
+    _uv = (_dir.z > 0.f) ? vec2(_dir.x, -_dir.y) / a.z : vec2(-_dir.x, -_dir.y) / a.z;
+    return (_dir.z > 0.f) ? 4 : 5;
+}
+
+static vec3 fetchTexel(const CpuSkyCube& _cube, uint32_t _face, int32_t _x, int32_t _y)
+{
+    const int32_t maxPos = int32_t(_cube.size) - 1;
+    const uint32_t x = (uint32_t)glm::clamp(_x, 0, maxPos);
+    const uint32_t y = (uint32_t)glm::clamp(_y, 0, maxPos);
+
+    const uint8_t* texel = _cube.faces[_face] + (y * _cube.size + x) * 4;
+    return vec3(texel[0], texel[1], texel[2]) / 255.f;
+}
+
+// bilinear in the face, the edges are clamped
+static vec3 sampleCube(const CpuSkyCube& _cube, const vec3& _dir)
+{
+    vec2 uv;
+    const uint32_t face = skyCubeFace(_dir, uv);
+
+    const vec2 p = (uv * .5f + .5f) * float(_cube.size) - .5f;
+    const vec2 p0 = glm::floor(p);
+    const vec2 f = p - p0;
+    const int32_t x = int32_t(p0.x);
+    const int32_t y = int32_t(p0.y);
+
+    const vec3 c00 = fetchTexel(_cube, face, x, y);
+    const vec3 c10 = fetchTexel(_cube, face, x + 1, y);
+    const vec3 c01 = fetchTexel(_cube, face, x, y + 1);
+    const vec3 c11 = fetchTexel(_cube, face, x + 1, y + 1);
+
+    return glm::mix(glm::mix(c00, c10, f.x), glm::mix(c01, c11, f.x), f.y);
+}
+
+static float skyCubeAreaElement(float _x, float _y)
+{
+    return atan2f(_x * _y, sqrtf(_x * _x + _y * _y + 1.f));
+}
+
+static float skyCubeTexelSolidAngle(uint32_t _x, uint32_t _y, uint32_t _size)
+{
+    const float inv = 1.f / float(_size);
+    const vec2 p0 = vec2(float(_x), float(_y)) * 2.f * inv - 1.f;
+    const vec2 p1 = p0 + 2.f * inv;
+
+    return skyCubeAreaElement(p0.x, p0.y) - skyCubeAreaElement(p0.x, p1.y)
+        - skyCubeAreaElement(p1.x, p0.y) + skyCubeAreaElement(p1.x, p1.y);
+}
+
+static void skySHBasis(const vec3& _n, float* _y)
+{
+    _y[0] = 0.282095f;
+    _y[1] = 0.488603f * _n.y;
+    _y[2] = 0.488603f * _n.z;
+    _y[3] = 0.488603f * _n.x;
+    _y[4] = 1.092548f * _n.x * _n.y;
+    _y[5] = 1.092548f * _n.y * _n.z;
+    _y[6] = 0.315392f * (3.f * _n.z * _n.z - 1.f);
+    _y[7] = 1.092548f * _n.x * _n.z;
+    _y[8] = 0.546274f * (_n.x * _n.x - _n.y * _n.y);
+}
+
+static float skySHBandFactor(uint32_t _idx)
+{
+    const float pi = glm::pi<float>();
+    return _idx == 0 ? pi : (_idx < 4 ? 2.f * pi / 3.f : pi / 4.f);
+}
+
+static vec2 hammersley(uint32_t _idx, uint32_t _count)
+{
+    uint32_t bits = _idx;
+    bits = (bits << 16u) | (bits >> 16u);
+    bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+    bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+    bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+    bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+
+    return vec2(float(_idx) / float(_count), float(bits) * 2.3283064365386963e-10f);
+}
+
+static vec3 importanceSampleGGX(const vec2& _xi, const vec3& _n, float _linearRough)
+{
+    const float a2 = _linearRough * _linearRough;
+    const float phi = 2.f * glm::pi<float>() * _xi.x;
+    const float cosTheta = sqrtf((1.f - _xi.y) / (1.f + (a2 - 1.f) * _xi.y));
+    const float sinTheta = sqrtf(1.f - cosTheta * cosTheta);
+
+    const vec3 h = vec3(sinTheta * cosf(phi), sinTheta * sinf(phi), cosTheta);
+
+    const vec3 up = fabsf(_n.z) < .999f ? vec3(0.f, 0.f, 1.f) : vec3(1.f, 0.f, 0.f);
+    const vec3 tx = glm::normalize(glm::cross(up, _n));
+    const vec3 ty = glm::cross(_n, tx);
+
+    return glm::normalize(tx * h.x + ty * h.y + _n * h.z);
+}
+
+static void bakeSH(SkyIblBake& _out, const CpuSkyCube& _cube)
+{
+    vec3 sh[kSkyIblShCoeffs] = {};
+
+    for (uint32_t face = 0; face < 6; ++face)
+    {
+        for (uint32_t y = 0; y < kSkyIblShSize; ++y)
+        {
+            for (uint32_t x = 0; x < kSkyIblShSize; ++x)
+            {
+                const vec2 uv = (vec2(float(x), float(y)) + .5f) / float(kSkyIblShSize) * 2.f - 1.f;
+                const vec3 dir = skyCubeDir(face, uv);
+                const vec3 radiance = sampleCube(_cube, dir) * skyCubeTexelSolidAngle(x, y, kSkyIblShSize);
+
+                float basis[kSkyIblShCoeffs];
+                skySHBasis(dir, basis);
+
+                for (uint32_t cc = 0; cc < kSkyIblShCoeffs; ++cc)
+                    sh[cc] += radiance * basis[cc];
+            }
+        }
+    }
+
+    for (uint32_t cc = 0; cc < kSkyIblShCoeffs; ++cc)
+        _out.sh[cc] = vec4(sh[cc] * skySHBandFactor(cc), 0.f);
+}
+
+static void bakeSpecular(SkyIblBake& _out, const CpuSkyCube& _cube)
+{
+    _out.specular.resize(getSpecularTexelCount() * 4);
+
+    uint32_t offset = 0;
+    for (uint32_t mip = 0; mip < kSkyIblSpecularMips; ++mip)
+    {
+        const uint32_t size = glm::max(1u, kSkyIblSpecularSize >> mip);
+        const float rough = float(mip) / float(kSkyIblSpecularMips - 1);
+        const float linearRough = rough * rough;
+
+        for (uint32_t face = 0; face < 6; ++face)
+        {
+            for (uint32_t y = 0; y < size; ++y)
+            {
+                for (uint32_t x = 0; x < size; ++x)
+                {
+                    const vec2 uv = (vec2(float(x), float(y)) + .5f) / float(size) * 2.f - 1.f;
+                    const vec3 n = skyCubeDir(face, uv);
+
+                    vec3 color = vec3(0.f);
+                    float weight = 0.f;
+                    if (0 == mip)
+                    {
+                        color = sampleCube(_cube, n);
+                        weight = 1.f;
+                    }
+                    else
+                    {
+                        for (uint32_t ii = 0; ii < kSkyIblSampleCount; ++ii)
+                        {
+                            const vec3 h = importanceSampleGGX(hammersley(ii, kSkyIblSampleCount), n, linearRough);
+                            const vec3 l = glm::normalize(2.f * glm::dot(n, h) * h - n);
+
+                            const float nol = glm::dot(n, l);
+                            if (nol > 0.f)
+                            {
+                                color += sampleCube(_cube, l) * nol;
+                                weight += nol;
+                            }
+                        }
+                    }
+
+                    color /= glm::max(weight, 1e-4f);
+
+                    uint16_t* texel = &_out.specular[offset];
+                    texel[0] = glm::packHalf1x16(color.r);
+                    texel[1] = glm::packHalf1x16(color.g);
+                    texel[2] = glm::packHalf1x16(color.b);
+                    texel[3] = glm::packHalf1x16(1.f);
+                    offset += 4;
+                }
+            }
+        }
+    }
+}
+
+bool bakeSkyIblCpu(SkyIblBake& _out, const char* _ktxPath)
+{
+    KG_ZoneScopedC(kage::Color::blue);
+
+    ktxTexture* ktxTex = nullptr;
+    if (KTX_SUCCESS != ktxTexture_CreateFromNamedFile(_ktxPath, KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT, &ktxTex))
+    {
+        kage::message(kage::warning, "sky ibl: failed to load %s", _ktxPath);
+        return false;
+    }
+
+    // the same assumption as loadKtxFromFile, the texels are rgba8
+    const uint32_t size = ktxTex->baseWidth;
+    if (!ktxTex->isCubemap || ktxTex->baseHeight != size || ktxTexture_GetImageSize(ktxTex, 0) != size * size * 4)
+    {
+        kage::message(kage::warning, "sky ibl: %s is not a rgba8 cube, skip the cpu bake", _ktxPath);
+        ktxTexture_Destroy(ktxTex);
+        return false;
+    }
+
+    const int64_t start = bx::getHPCounter();
+
+    CpuSkyCube cube{};
+    cube.size = size;
+    for (uint32_t face = 0; face < 6; ++face)
+    {
+        ktx_size_t offset = 0;
+        ktxTexture_GetImageOffset(ktxTex, 0, 0, face, &offset);
+        cube.faces[face] = ktxTexture_GetData(ktxTex) + offset;
+    }
+
+    bakeSH(_out, cube);
+    bakeSpecular(_out, cube);
+
+    ktxTexture_Destroy(ktxTex);
+
+    const double ms = double(bx::getHPCounter() - start) * 1000.0 / double(bx::getHPFrequency());
+    kage::message(kage::info, "sky ibl: baked %s in %.2f ms", _ktxPath, ms);
+
+    return true;
+}
+
+bool loadSkyIblCache(SkyIblBake& _out, const char* _ktxPath)
+{
+    char path[256];
+    getCachePath(path, COUNTOF(path), _ktxPath);
+
+    FILE* file = fopen(path, "rb");
+    if (!file)
+        return false;
+
+    const SkyIblCacheHeader expected = makeCacheHeader(_ktxPath);
+
+    SkyIblCacheHeader header{};
+    bool valid = (1 == fread(&header, sizeof(SkyIblCacheHeader), 1, file))
+        && (0 == memcmp(&header, &expected, sizeof(SkyIblCacheHeader)));
+
+    if (valid)
+    {
+        _out.specular.resize(getSpecularTexelCount() * 4);
+
+        valid = (kSkyIblShCoeffs == fread(_out.sh, sizeof(vec4), kSkyIblShCoeffs, file))
+            && (_out.specular.size() == fread(_out.specular.data(), sizeof(uint16_t), _out.specular.size(), file));
+    }
+
+    fclose(file);
+
+    if (!valid)
+        kage::message(kage::warning, "sky ibl: the cache %s is outdated, rebake", path);
+
+    return valid;
+}
+
+bool saveSkyIblCache(const SkyIblBake& _bake, const char* _ktxPath)
+{
+    char path[256];
+    getCachePath(path, COUNTOF(path), _ktxPath);
+
+    FILE* file = fopen(path, "wb");
+    if (!file)
+    {
+        kage::message(kage::warning, "sky ibl: failed to write %s", path);
+        return false;
+    }
+
+    const SkyIblCacheHeader header = makeCacheHeader(_ktxPath);
+    fwrite(&header, sizeof(SkyIblCacheHeader), 1, file);
+    fwrite(_bake.sh, sizeof(vec4), kSkyIblShCoeffs, file);
+    fwrite(_bake.specular.data(), sizeof(uint16_t), _bake.specular.size(), file);
+
+    fclose(file);
+
+    return true;
+}
+
+// ==============================================================================
+// gpu path
+
+static void initSkyPrefilter(SkyIbl& _ibl)
+{
+    kage::ShaderHandle cs = kage::registShader("sky_prefilter", "shader/sky_prefilter.comp.spv");
+    kage::ProgramHandle prog = kage::registProgram("sky_prefilter", { cs }, sizeof(SkyPrefilterConsts));
+
+    kage::PassDesc passDesc{};
+    passDesc.prog = prog;
+    passDesc.queue = kage::PassExeQueue::compute;
+    kage::PassHandle pass = kage::registPass("sky_prefilter", passDesc);
+
+    _ibl.prefilterSampler = kage::sampleImage(pass, _ibl.skyCube
+        , Stage::compute_shader
+        , kage::SamplerFilter::linear
+        , kage::SamplerMipmapMode::nearest
+        , kage::SamplerAddressMode::clamp_to_edge
+        , kage::SamplerReductionMode::weighted_average
+    );
+
+    _ibl.specularOutAlias = kage::alias(_ibl.specular);
+    kage::bindImage(pass, _ibl.specular
+        , Stage::compute_shader
+        , Access::shader_write
+        , kage::ImageLayout::general
+        , _ibl.specularOutAlias
+    );
+
+    _ibl.prefilterPass = pass;
+    _ibl.prefilterProg = prog;
+    _ibl.prefilterCs = cs;
+}
+
+static void initSkySH(SkyIbl& _ibl)
+{
+    kage::ShaderHandle cs = kage::registShader("sky_sh", "shader/sky_sh.comp.spv");
+    kage::ProgramHandle prog = kage::registProgram("sky_sh", { cs });
+
+    kage::PassDesc passDesc{};
+    passDesc.prog = prog;
+    passDesc.queue = kage::PassExeQueue::compute;
+    kage::PassHandle pass = kage::registPass("sky_sh", passDesc);
+
+    _ibl.shSampler = kage::sampleImage(pass, _ibl.skyCube
+        , Stage::compute_shader
+        , kage::SamplerFilter::linear
+        , kage::SamplerMipmapMode::nearest
+        , kage::SamplerAddressMode::clamp_to_edge
+        , kage::SamplerReductionMode::weighted_average
+    );
+
+    _ibl.shOutAlias = kage::alias(_ibl.sh);
+    kage::bindBuffer(pass, _ibl.sh
+        , Stage::compute_shader
+        , Access::shader_write
+        , _ibl.shOutAlias
+    );
+
+    _ibl.shPass = pass;
+    _ibl.shProg = prog;
+    _ibl.shCs = cs;
+}
+
+void initSkyIbl(SkyIbl& _ibl, const kage::ImageHandle _skyCube, const char* _ktxPath, bool _forceGpu /*= false*/)
+{
+    SkyIblBake bake{};
+    bool cpuBaked = false;
+    if (!_forceGpu)
+    {
+        cpuBaked = loadSkyIblCache(bake, _ktxPath);
+        if (!cpuBaked && bakeSkyIblCpu(bake, _ktxPath))
+        {
+            cpuBaked = true;
+            saveSkyIblCache(bake, _ktxPath);
+        }
+    }
+
+    kage::ImageDesc imgDesc{};
+    imgDesc.width = kSkyIblSpecularSize;
+    imgDesc.height = kSkyIblSpecularSize;
+    imgDesc.depth = 1;
+    imgDesc.numLayers = 6;
+    imgDesc.numMips = kSkyIblSpecularMips;
+    imgDesc.type = kage::ImageType::type_2d;
+    imgDesc.viewType = kage::ImageViewType::type_cube;
+    imgDesc.format = kage::ResourceFormat::r16g16b16a16_sfloat;
+    imgDesc.usage = kage::ImageUsageFlagBits::sampled | kage::ImageUsageFlagBits::storage | kage::ImageUsageFlagBits::transfer_dst;
+
+    kage::BufferDesc bufDesc{};
+    bufDesc.size = sizeof(vec4) * kSkyIblShCoeffs;
+    bufDesc.usage = kage::BufferUsageFlagBits::storage | kage::BufferUsageFlagBits::transfer_dst;
+    bufDesc.memFlags = kage::MemoryPropFlagBits::device_local;
+
+    _ibl.skyCube = _skyCube;
+    _ibl.gpuBake = !cpuBaked;
+    _ibl.baked = cpuBaked;
+
+    if (cpuBaked)
+    {
+        const kage::Memory* specMem = kage::copy(bake.specular.data(), uint32_t(bake.specular.size() * sizeof(uint16_t)));
+        const kage::Memory* shMem = kage::copy(bake.sh, uint32_t(sizeof(bake.sh)));
+
+        _ibl.specular = kage::registTexture("sky_ibl_specular", imgDesc, specMem, kage::ResourceLifetime::non_transition);
+        _ibl.sh = kage::registBuffer("sky_ibl_sh", bufDesc, shMem, kage::ResourceLifetime::non_transition);
+
+        _ibl.specularOutAlias = _ibl.specular;
+        _ibl.shOutAlias = _ibl.sh;
+        return;
+    }
+
+    _ibl.specular = kage::registTexture("sky_ibl_specular", imgDesc, nullptr, kage::ResourceLifetime::non_transition);
+    _ibl.sh = kage::registBuffer("sky_ibl_sh", bufDesc, nullptr, kage::ResourceLifetime::non_transition);
+
+    initSkyPrefilter(_ibl);
+    initSkySH(_ibl);
+}
+
+static void recSkyPrefilter(const SkyIbl& _ibl)
+{
+    KG_ZoneScopedC(kage::Color::blue);
+
+    kage::startRec(_ibl.prefilterPass);
+
+    if (_ibl.baked)
+    {
+        kage::endRec();
+        return;
+    }
+
+    for (uint16_t mip = 0; mip < kSkyIblSpecularMips; ++mip)
+    {
+        const float rough = float(mip) / float(kSkyIblSpecularMips - 1);
+
+        SkyPrefilterConsts consts{};
+        consts.mip = mip;
+        consts.size = glm::max(1u, kSkyIblSpecularSize >> mip);
+        consts.linearRough = rough * rough;
+        consts.sampleCount = kSkyIblSampleCount;
+
+        const kage::Memory* mem = kage::alloc(sizeof(SkyPrefilterConsts));
+        bx::memCopy(mem->data, &consts, mem->size);
+        kage::setConstants(mem);
+
+        kage::Binding binds[] =
+        {
+            {_ibl.skyCube,      _ibl.prefilterSampler,  Stage::compute_shader},
+            {_ibl.specular,     mip,                    Stage::compute_shader},
+        };
+        kage::pushBindings(binds, COUNTOF(binds));
+
+        kage::dispatch(consts.size, consts.size, 6);
+    }
+
+    kage::endRec();
+}
+
+static void recSkySH(const SkyIbl& _ibl)
+{
+    KG_ZoneScopedC(kage::Color::blue);
+
+    kage::startRec(_ibl.shPass);
+
+    if (_ibl.baked)
+    {
+        kage::endRec();
+        return;
+    }
+
+    kage::Binding binds[] =
+    {
+        {_ibl.skyCube,  _ibl.shSampler,         Stage::compute_shader},
+        {_ibl.sh,       BindingAccess::write,   Stage::compute_shader},
+    };
+    kage::pushBindings(binds, COUNTOF(binds));
+
+    kage::dispatch(1, 1, 1);
+
+    kage::endRec();
+}
+
+void updateSkyIbl(SkyIbl& _ibl)
+{
+    if (!_ibl.gpuBake)
+        return;
+
+    recSkyPrefilter(_ibl);
+    recSkySH(_ibl);
+
+    _ibl.baked = true;
+}
+
+SkyIblData getSkyIblData(const SkyIbl& _ibl)
+{
+    SkyIblData data{};
+    data.specular = _ibl.specularOutAlias;
+    data.sh = _ibl.shOutAlias;
+    return data;
+}
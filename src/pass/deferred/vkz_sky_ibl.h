@@ -0,0 +1,78 @@
+#pragma once
+
+#include "core/kage.h"
+#include "core/kage_math.h"
+
+#include <vector>
+
+// image based lighting from the sky cube for the deferred shading
+// a ggx prefiltered specular cube and the sh9 of the irradiance are made once from the sky
+// the cpu reference bakes them into <ktx>.ibl next to the sky, the cache is uploaded as is on the next run
+// the gpu path runs the same steps in two compute passes on the first frame, it is used when there is no cache
+// keep sync with sky_ibl.h
+constexpr uint32_t kSkyIblSpecularSize = 128;
+constexpr uint32_t kSkyIblSpecularMips = 6;
+constexpr uint32_t kSkyIblShSize = 64;
+constexpr uint32_t kSkyIblShCoeffs = 9;
+constexpr uint32_t kSkyIblSampleCount = 256;
+
+struct alignas(16) SkyPrefilterConsts
+{
+    uint32_t mip;
+    uint32_t size;
+    float linearRough;
+    uint32_t sampleCount;
+};
+
+// the content of the cache
+struct SkyIblBake
+{
+    vec4 sh[kSkyIblShCoeffs]; // rgb in xyz, convolved with the cosine lobe
+    std::vector<uint16_t> specular; // rgba16f, mip major then face, the same as the image upload
+};
+
+// the resources deferred shading reads the ambient from
+struct SkyIblData
+{
+    kage::ImageHandle specular;
+    kage::BufferHandle sh;
+};
+
+struct SkyIbl
+{
+    // gpu path only
+    kage::PassHandle prefilterPass;
+    kage::ProgramHandle prefilterProg;
+    kage::ShaderHandle prefilterCs;
+    kage::SamplerHandle prefilterSampler;
+
+    kage::PassHandle shPass;
+    kage::ProgramHandle shProg;
+    kage::ShaderHandle shCs;
+    kage::SamplerHandle shSampler;
+
+    kage::ImageHandle skyCube;
+
+    kage::ImageHandle specular;
+    kage::BufferHandle sh;
+
+    kage::ImageHandle specularOutAlias;
+    kage::BufferHandle shOutAlias;
+
+    bool gpuBake{ false };
+    bool baked{ false };
+};
+
+// _forceGpu skips the cache and the cpu reference
+void initSkyIbl(SkyIbl& _ibl, const kage::ImageHandle _skyCube, const char* _ktxPath, bool _forceGpu = false);
+
+// records the gpu passes on the first frame only
+void updateSkyIbl(SkyIbl& _ibl);
+
+SkyIblData getSkyIblData(const SkyIbl& _ibl);
+
+// the cpu reference, returns false if the ktx is not a rgba8 cube
+bool bakeSkyIblCpu(SkyIblBake& _out, const char* _ktxPath);
+
+bool loadSkyIblCache(SkyIblBake& _out, const char* _ktxPath);
+bool saveSkyIblCache(const SkyIblBake& _bake, const char* _ktxPath);
@@ -102,83 +102,185 @@ mat4 modelMatrix(const vec3& _pos, const quat& _orit, const vec3& _scale)
     return  model;
 }
 
+FfxBrixelizerInstanceDescription getInstanceDesc(const BrixelResources& _brx, const Scene& _scene, uint32_t _drawIdx)
+{
+    const MeshDraw& mdraw = _scene.meshDraws[_drawIdx];
+    const Mesh& mesh = _scene.geometry.meshes[mdraw.meshIdx];
+    const BRX_Mesh& bMesh = _brx.meshes[mdraw.meshIdx];
+
+    vec3 oriAabbMin = mesh.aabbMin;
+    vec3 oriAabbMax = mesh.aabbMax;
+    vec3 aabbExtent = oriAabbMax - oriAabbMin;
+
+    const vec3 aabbCorners[8] = {
+        oriAabbMin + vec3(0.f),
+        oriAabbMin + vec3(aabbExtent.x, 0.f, 0.f),
+        oriAabbMin + vec3(0.f, 0.f, aabbExtent.z),
+        oriAabbMin + vec3(aabbExtent.x, 0.f, aabbExtent.z),
+        oriAabbMin + vec3(0.f, aabbExtent.y, 0.f),
+        oriAabbMin + vec3(aabbExtent.x, aabbExtent.y, 0.f),
+        oriAabbMin + vec3(0.f, aabbExtent.y, aabbExtent.z),
+        oriAabbMin + aabbExtent,
+    };
+
+    glm::mat4 transform = modelMatrix(mdraw.pos, mdraw.orit, vec3(mdraw.scale));
+
+    vec3 minAABB = vec3(FLT_MAX);
+    vec3 maxAABB = vec3(-FLT_MAX);
+    for (uint32_t jj = 0; jj < 8; ++jj) {
+        vec3 cornerWorldPos = transform * vec4(aabbCorners[jj], 1.f);
+        minAABB = glm::min(minAABB, cornerWorldPos);
+        maxAABB = glm::max(maxAABB, cornerWorldPos);
+    }
+
+    FfxBrixelizerInstanceDescription instDesc = {};
+
+    instDesc.maxCascade = kage::k_brixelizerCascadeCount;
+    for (uint32_t jj = 0; jj < 3; ++jj) {
+        instDesc.aabb.min[jj] = minAABB[jj];
+        instDesc.aabb.max[jj] = maxAABB[jj];
+    }
+
+    // store the transformation matrix in row major
+    for (uint32_t jj = 0; jj < 3; ++jj) {
+        for (uint32_t kk = 0; kk < 4; ++kk) {
+            instDesc.transform[jj * 4 + kk] = transform[kk][jj];
+        }
+    }
+
+    instDesc.indexFormat = FFX_INDEX_TYPE_UINT32;
+    instDesc.indexBuffer = 0; // reserve and set in the backend part
+    instDesc.indexBufferOffset = bMesh.idx_offset * sizeof(uint32_t);
+    instDesc.triangleCount = bMesh.idx_count / 3;
+    instDesc.vertexBuffer = 0; // reserve and set in the backend part
+    instDesc.vertexStride = sizeof(vec3);
+    instDesc.vertexBufferOffset = bMesh.vtx_offset * sizeof(vec3);
+    instDesc.vertexCount = bMesh.vtx_count;
+    instDesc.vertexFormat = FFX_SURFACE_FORMAT_R32G32B32_FLOAT;
+    instDesc.flags = FFX_BRIXELIZER_INSTANCE_FLAG_NONE; // static, the backend switches the moving ones to dynamic
+
+    instDesc.outInstanceID = nullptr;
+
+    return instDesc;
+}
+
 void brxProcessScene(BrixelResources& _brx, const Scene& _scene, bool _seamless)
 {
     assert(!_seamless); // not support seamless yet
 
-    std::vector<FfxBrixelizerInstanceDescription> instDescs;
-    instDescs.reserve(_scene.drawCount);
+    _brx.instDescs.clear();
+    _brx.instDescs.reserve(_scene.drawCount);
 
     for (uint32_t ii = 0; ii < _scene.drawCount; ++ii)
     {
-        const MeshDraw& mdraw = _scene.meshDraws[ii];
-        const Mesh& mesh = _scene.geometry.meshes[mdraw.meshIdx];
-        const BRX_Mesh& bMesh = _brx.meshes[mdraw.meshIdx];
-
-        vec3 center = mesh.center;
-        float radius = mesh.radius;
-        vec3 oriAabbMin = mesh.aabbMin;
-        vec3 oriAabbMax = mesh.aabbMax;
-        vec3 aabbExtent = oriAabbMax - oriAabbMin;
-
-        const vec3 aabbCorners[8] = {
-            oriAabbMin + vec3(0.f),
-            oriAabbMin + vec3(aabbExtent.x, 0.f, 0.f),
-            oriAabbMin + vec3(0.f, 0.f, aabbExtent.z),
-            oriAabbMin + vec3(aabbExtent.x, 0.f, aabbExtent.z),
-            oriAabbMin + vec3(0.f, aabbExtent.y, 0.f),
-            oriAabbMin + vec3(aabbExtent.x, aabbExtent.y, 0.f),
-            oriAabbMin + vec3(0.f, aabbExtent.y, aabbExtent.z),
-            oriAabbMin + aabbExtent,
-        };
-
-        glm::mat4 transform = modelMatrix(mdraw.pos, mdraw.orit, vec3(mdraw.scale));
-
-        vec3 minAABB = vec3(FLT_MAX);
-        vec3 maxAABB = vec3(FLT_MIN);
-        for (uint32_t jj = 0; jj < 8; ++jj) {
-            vec3 cornerWorldPos = transform * vec4(aabbCorners[jj], 1.f);
-            minAABB = glm::min(minAABB, cornerWorldPos);
-            maxAABB = glm::max(maxAABB, cornerWorldPos);
-        }
+        _brx.instDescs.emplace_back(getInstanceDesc(_brx, _scene, ii));
+    }
 
+    _brx.instSubmitted.assign(_scene.drawCount, 1);
+    _brx.instWanted.assign(_scene.drawCount, 1);
+    _brx.dirtyDraws.clear();
+    _brx.dirtyFlags.assign(_scene.drawCount, 0);
 
-        FfxBrixelizerInstanceDescription instDesc = {};
-        FfxBrixelizerInstanceID instId = FFX_BRIXELIZER_INVALID_ID;
+    const kage::Memory* descMem = kage::alloc((uint32_t)(_brx.instDescs.size() * sizeof(FfxBrixelizerInstanceDescription)));
+    std::memcpy(descMem->data, _brx.instDescs.data(), descMem->size);
 
-        instDesc.maxCascade = kage::k_brixelizerCascadeCount;
-        for (uint32_t jj = 0; jj < 3; ++jj) {
-            instDesc.aabb.min[jj] = minAABB[jj];
-            instDesc.aabb.max[jj] = maxAABB[jj];
-        }
-        
-        // store the transformation matrix in row major
-        for (uint32_t jj = 0; jj < 3; ++jj) {
-            for (uint32_t kk = 0; kk < 4; ++kk) {
-                instDesc.transform[jj * 4 + kk] = transform[kk][jj];
-            }
-        }
+    kage::brx_setGeoInstances(descMem);
+}
 
-        instDesc.indexFormat = FFX_INDEX_TYPE_UINT32;
-        instDesc.indexBuffer = 0; // reserve and set in the backend part
-        instDesc.indexBufferOffset = bMesh.idx_offset * sizeof(uint32_t);
-        instDesc.triangleCount = bMesh.idx_count / 3;
-        instDesc.vertexBuffer = 0; // reserve and set in the backend part
-        instDesc.vertexStride = sizeof(vec3);
-        instDesc.vertexBufferOffset = bMesh.vtx_offset * sizeof(vec3);
-        instDesc.vertexCount = bMesh.vtx_count;
-        instDesc.vertexFormat = FFX_SURFACE_FORMAT_R32G32B32_FLOAT;
-        instDesc.flags = FFX_BRIXELIZER_INSTANCE_FLAG_NONE; //static
+static void markInstanceDirty(BrixelResources& _brx, uint32_t _drawIdx)
+{
+    if (_drawIdx >= _brx.dirtyFlags.size())
+    {
+        _brx.instDescs.resize(_drawIdx + 1);
+        _brx.instSubmitted.resize(_drawIdx + 1, 0);
+        _brx.instWanted.resize(_drawIdx + 1, 0);
+        _brx.dirtyFlags.resize(_drawIdx + 1, 0);
+    }
+
+    if (_brx.dirtyFlags[_drawIdx])
+        return;
+
+    _brx.dirtyFlags[_drawIdx] = 1;
+    _brx.dirtyDraws.push_back(_drawIdx);
+}
 
-        instDesc.outInstanceID = nullptr;
+void brxAddInstance(BrixelResources& _brx, const Scene& _scene, uint32_t _drawIdx)
+{
+    assert(_drawIdx < _scene.meshDraws.size());
 
-        instDescs.emplace_back(instDesc);
+    markInstanceDirty(_brx, _drawIdx);
+    _brx.instDescs[_drawIdx] = getInstanceDesc(_brx, _scene, _drawIdx);
+    _brx.instWanted[_drawIdx] = 1;
+}
+
+void brxUpdateInstance(BrixelResources& _brx, const Scene& _scene, uint32_t _drawIdx)
+{
+    assert(_drawIdx < _scene.meshDraws.size());
+
+    markInstanceDirty(_brx, _drawIdx);
+    _brx.instDescs[_drawIdx] = getInstanceDesc(_brx, _scene, _drawIdx);
+}
+
+void brxRemoveInstance(BrixelResources& _brx, uint32_t _drawIdx)
+{
+    markInstanceDirty(_brx, _drawIdx);
+    _brx.instWanted[_drawIdx] = 0;
+}
+
+// the delta of a draw only depends on the backend state and the latest one
+void brxFlushInstances(BrixelResources& _brx)
+{
+    _brx.addedInsts = 0;
+    _brx.updatedInsts = 0;
+    _brx.removedInsts = 0;
+
+    if (_brx.dirtyDraws.empty())
+        return;
+
+    std::vector<BrixelInstanceDelta> deltas;
+    deltas.reserve(_brx.dirtyDraws.size());
+
+    for (uint32_t idx : _brx.dirtyDraws)
+    {
+        _brx.dirtyFlags[idx] = 0;
+
+        const bool submitted = _brx.instSubmitted[idx] != 0;
+        const bool wanted = _brx.instWanted[idx] != 0;
+        if (!submitted && !wanted)
+            continue;
+
+        BrixelInstanceDelta delta{};
+        delta.key = idx;
+        delta.desc = _brx.instDescs[idx];
+
+        if (!submitted)
+        {
+            delta.op = BrixelInstanceOp::add;
+            _brx.addedInsts++;
+        }
+        else if (!wanted)
+        {
+            delta.op = BrixelInstanceOp::remove;
+            _brx.removedInsts++;
+        }
+        else
+        {
+            delta.op = BrixelInstanceOp::update;
+            _brx.updatedInsts++;
+        }
+
+        _brx.instSubmitted[idx] = wanted ? 1 : 0;
+        deltas.emplace_back(delta);
     }
+    _brx.dirtyDraws.clear();
 
-    const kage::Memory* descMem = kage::alloc((uint32_t)(instDescs.size() * sizeof(FfxBrixelizerInstanceDescription)));
-    std::memcpy(descMem->data, instDescs.data(), descMem->size);
+    if (deltas.empty())
+        return;
 
-    kage::brx_setGeoInstances(descMem);
+    const kage::Memory* mem = kage::alloc((uint32_t)(deltas.size() * sizeof(BrixelInstanceDelta)));
+    std::memcpy(mem->data, deltas.data(), mem->size);
+
+    kage::brx_updateGeoInstances(mem);
 }
 
 void brxCreateResources(BrixelResources& _data)
@@ -329,11 +431,14 @@ void brxUpdate(BrixelResources& _bxl, const BrixelData& _data)
     desc.tmax = _data.tmax;
     desc.debugType = (BrixelDebugType)_data.debugType;
     desc.followCam = _data.followCam;
+    desc.maxBricksPerBake = _data.maxBricksPerBake;
 
     const kage::Memory* mem = kage::alloc(sizeof(BrixelDebugDescs));
 
     std::memcpy(mem->data, &desc, sizeof(BrixelDebugDescs));
 
     kage::brx_setDebugInfos(mem);
+
+    brxFlushInstances(_bxl);
 }
 
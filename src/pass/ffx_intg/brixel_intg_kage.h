@@ -25,6 +25,20 @@ struct BrixelResources
     std::vector<BRX_Mesh> meshes;
     std::vector<vec3> vtxes;
     std::vector<uint32_t> idxes;
+
+    // latest instance of each draw, the backend gets the dirty ones in next brxUpdate
+    std::vector<FfxBrixelizerInstanceDescription> instDescs;
+    std::vector<uint8_t> instSubmitted; // the backend has the instance
+    std::vector<uint8_t> instWanted;
+
+    // dirty draws of current frame
+    std::vector<uint32_t> dirtyDraws;
+    std::vector<uint8_t> dirtyFlags;
+
+    // stats of the last flush
+    uint32_t addedInsts{ 0 };
+    uint32_t updatedInsts{ 0 };
+    uint32_t removedInsts{ 0 };
 };
 
 struct BrixelInitDesc
@@ -53,8 +67,17 @@ struct BrixelData
     float sdfEps;
     float tmin;
     float tmax;
+
+    uint32_t maxBricksPerBake;
 };
 
 
 void brxInit(BrixelResources& _bxl, const BrixelInitDesc& _init, const Scene& _scene);
-void brxUpdate(BrixelResources& _bxl, const BrixelData& _trans);
\ No newline at end of file
+// flushes the instance changes of the frame
+void brxUpdate(BrixelResources& _bxl, const BrixelData& _trans);
+
+// instances are keyed by the draw index, changes of a draw in a frame are merged into one delta
+void brxAddInstance(BrixelResources& _bxl, const Scene& _scene, uint32_t _drawIdx);
+// call after the MeshDraw moved, the instance is rebuilt from it
+void brxUpdateInstance(BrixelResources& _bxl, const Scene& _scene, uint32_t _drawIdx);
+void brxRemoveInstance(BrixelResources& _bxl, uint32_t _drawIdx);
\ No newline at end of file
@@ -29,6 +29,9 @@ struct BrixelizerConfig
 
 const static BrixelizerConfig s_conf{};
 
+// a moved instance is rebaked as static once it stays still for these frames
+constexpr uint32_t c_instSettleFrames = 8;
+
 void createCtx(FFXBrixelizer_vk& _brx)
 {
     _brx.initDesc.sdfCenter[0] = 0.f;
@@ -63,6 +66,20 @@ void setGeoInstances(FFXBrixelizer_vk& _brx, const Memory* _descs)
     _brx.mem_geoInstDescs = _descs;
 }
 
+// copied here, the memory is released at the end of the frame
+void setGeoInstanceDeltas(FFXBrixelizer_vk& _brx, const Memory* _deltas)
+{
+    if (nullptr == _deltas) {
+        message(error, "invalid _deltas ptr!");
+        return;
+    }
+
+    uint32_t count = _deltas->size / sizeof(BrixelInstanceDelta);
+    const BrixelInstanceDelta* deltas = (const BrixelInstanceDelta*)_deltas->data;
+
+    _brx.pendingInstDeltas.insert(_brx.pendingInstDeltas.end(), deltas, deltas + count);
+}
+
 void setGeoBuffers(FFXBrixelizer_vk& _brx, const Memory* _buf)
 {
     if (nullptr == _buf) {
@@ -112,6 +129,8 @@ void parseGeoInst_n_submit(FFXBrixelizer_vk& _brx)
     FfxBrixelizerInstanceDescription* desc = (FfxBrixelizerInstanceDescription*)_brx.mem_geoInstDescs->data;
     descsRef.assign(desc, desc + instCount);
     idsRef.resize(instCount);
+    _brx.geoInstStates.resize(instCount);
+    _brx.geoInstStillFrames.resize(instCount);
     
     for (size_t ii = 0; ii < instCount; ii++)
     {
@@ -121,11 +140,150 @@ void parseGeoInst_n_submit(FFXBrixelizer_vk& _brx)
 
         idsRef[ii] = 0;
         descsRef[ii].outInstanceID = &idsRef[ii];
+
+        _brx.geoInstStates[ii] = InstanceState::static_baked;
+        _brx.geoInstStillFrames[ii] = 0;
     }
 
     FFX_CHECK(ffxBrixelizerCreateInstances(&_brx.context, descsRef.data(), instCount));
 }
 
+void resizeGeoInsts(FFXBrixelizer_vk& _brx, uint32_t _count)
+{
+    if (_count <= _brx.geoInstDescs.size())
+        return;
+
+    const uint32_t oldCount = (uint32_t)_brx.geoInstDescs.size();
+
+    _brx.geoInstDescs.resize(_count);
+    _brx.geoInstIds.resize(_count);
+    _brx.geoInstStates.resize(_count);
+    _brx.geoInstStillFrames.resize(_count);
+
+    for (uint32_t ii = oldCount; ii < _count; ++ii)
+    {
+        _brx.geoInstIds[ii] = FFX_BRIXELIZER_INVALID_ID;
+        _brx.geoInstStates[ii] = InstanceState::none;
+        _brx.geoInstStillFrames[ii] = 0;
+    }
+}
+
+// only the instances in the deltas are touched, the static bricks of the others stay baked
+// an updated instance is deleted from the static set and resubmitted as dynamic every frame,
+// then created as static again once it stays still for c_instSettleFrames
+void applyGeoInstDeltas(FFXBrixelizer_vk& _brx)
+{
+    stl::vector<FfxBrixelizerInstanceID> deleteIds;
+    stl::vector<uint32_t> createKeys;
+
+    for (const BrixelInstanceDelta& delta : _brx.pendingInstDeltas)
+    {
+        const uint32_t key = delta.key;
+        resizeGeoInsts(_brx, key + 1);
+
+        InstanceState& state = _brx.geoInstStates[key];
+
+        if (BrixelInstanceOp::remove == delta.op)
+        {
+            if (InstanceState::static_baked == state) {
+                deleteIds.push_back(_brx.geoInstIds[key]);
+                _brx.geoInstIds[key] = FFX_BRIXELIZER_INVALID_ID;
+            }
+
+            state = InstanceState::none;
+            continue;
+        }
+
+        FfxBrixelizerInstanceDescription& desc = _brx.geoInstDescs[key];
+        desc = delta.desc;
+        desc.vertexBuffer = _brx.bufferIdxes[0];
+        desc.indexBuffer = _brx.bufferIdxes[1];
+        desc.maxCascade = c_brixelizerCascadeCount;
+
+        if (InstanceState::none == state)
+        {
+            if (BrixelInstanceOp::update == delta.op) {
+                message(warning, "brixelizer instance %d updated before added!", key);
+            }
+
+            state = InstanceState::static_baked;
+            createKeys.push_back(key);
+            continue;
+        }
+
+        if (BrixelInstanceOp::add == delta.op) {
+            message(warning, "brixelizer instance %d added twice, updated instead!", key);
+        }
+
+        if (InstanceState::static_baked == state)
+        {
+            deleteIds.push_back(_brx.geoInstIds[key]);
+            _brx.geoInstIds[key] = FFX_BRIXELIZER_INVALID_ID;
+
+            state = InstanceState::dynamic;
+            _brx.dynamicInstKeys.push_back(key);
+        }
+
+        _brx.geoInstStillFrames[key] = 0;
+    }
+    _brx.pendingInstDeltas.clear();
+
+    // settle or resubmit the dynamic instances
+    stl::vector<FfxBrixelizerInstanceDescription> dynamicDescs;
+    stl::vector<FfxBrixelizerInstanceID> dynamicIds;
+    stl::vector<uint32_t> stillDynamicKeys;
+    for (uint32_t key : _brx.dynamicInstKeys)
+    {
+        if (InstanceState::dynamic != _brx.geoInstStates[key])
+            continue;
+
+        if (_brx.geoInstStillFrames[key] >= c_instSettleFrames)
+        {
+            _brx.geoInstStates[key] = InstanceState::static_baked;
+            createKeys.push_back(key);
+            continue;
+        }
+
+        _brx.geoInstStillFrames[key]++;
+        stillDynamicKeys.push_back(key);
+
+        FfxBrixelizerInstanceDescription desc = _brx.geoInstDescs[key];
+        desc.flags = FFX_BRIXELIZER_INSTANCE_FLAG_DYNAMIC;
+        dynamicDescs.push_back(desc);
+    }
+    _brx.dynamicInstKeys = stillDynamicKeys;
+
+    if (deleteIds.size() > 0) {
+        FFX_CHECK(ffxBrixelizerDeleteInstances(&_brx.context, deleteIds.data(), (uint32_t)deleteIds.size()));
+    }
+
+    if (createKeys.size() > 0)
+    {
+        stl::vector<FfxBrixelizerInstanceDescription> staticDescs;
+        for (uint32_t key : createKeys)
+        {
+            FfxBrixelizerInstanceDescription desc = _brx.geoInstDescs[key];
+            desc.flags = FFX_BRIXELIZER_INSTANCE_FLAG_NONE;
+            desc.outInstanceID = &_brx.geoInstIds[key];
+            staticDescs.push_back(desc);
+        }
+
+        FFX_CHECK(ffxBrixelizerCreateInstances(&_brx.context, staticDescs.data(), (uint32_t)staticDescs.size()));
+    }
+
+    // the ids of the dynamic instances are dropped after the update
+    if (dynamicDescs.size() > 0)
+    {
+        dynamicIds.resize(dynamicDescs.size());
+        for (size_t ii = 0; ii < dynamicDescs.size(); ++ii)
+        {
+            dynamicDescs[ii].outInstanceID = &dynamicIds[ii];
+        }
+
+        FFX_CHECK(ffxBrixelizerCreateInstances(&_brx.context, dynamicDescs.data(), (uint32_t)dynamicDescs.size()));
+    }
+}
+
 void parseGeoBuf_n_submit(FFXBrixelizer_vk& _brx)
 {
     if (nullptr == _brx.mem_geoBuf) {
@@ -346,6 +504,8 @@ void parseDebugVisDesc(FFXBrixelizer_vk& _brx)
     std::string nameStr = "brixelizer debug dest img";
     std::copy(nameStr.begin(), nameStr.end(), debugDestImgRef.name);
 
+    _brx.maxBricksPerBake = desc.maxBricksPerBake;
+
     memcpy(&visDesc.inverseViewMatrix[0], &desc.view[0], sizeof(visDesc.inverseViewMatrix));
     memcpy(&visDesc.inverseProjectionMatrix[0], &desc.proj[0], sizeof(visDesc.inverseProjectionMatrix));
     visDesc.debugState = getMode(desc.debugType);
@@ -382,7 +542,7 @@ void updateBrx(FFXBrixelizer_vk& _brx)
     _brx.updateDesc.populateDebugAABBsFlags = FFX_BRIXELIZER_POPULATE_AABBS_CASCADE_AABBS;
     _brx.updateDesc.debugVisualizationDesc = _brx.bDebug ? &_brx.debugVisDesc : nullptr;
     _brx.updateDesc.maxReferences = 32 * (1 << 20);
-    _brx.updateDesc.maxBricksPerBake = 1 << 14;
+    _brx.updateDesc.maxBricksPerBake = _brx.maxBricksPerBake;
     _brx.updateDesc.triangleSwapSize = 300 * (1 << 20);
     _brx.updateDesc.outStats = &_brx.stats;
     _brx.updateDesc.outScratchBufferSize = &scratchBufferSize;
@@ -545,6 +705,7 @@ void update(FFXBrixelizer_vk& _brx)
     }
 
     parseDebugVisDesc(_brx);
+    applyGeoInstDeltas(_brx);
     preUpdateBarriers(_brx);
     updateContextInfo(_brx);
     updateBrx(_brx);
@@ -8,6 +8,12 @@
 
 namespace kage { namespace vk { namespace brx
 {
+    enum class InstanceState : uint8_t
+    {
+        none = 0,
+        static_baked,
+        dynamic,    // resubmitted every frame, not kept in the static bricks
+    };
 
     struct FFXBrixelizer_vk
     {
@@ -28,8 +34,14 @@ namespace kage { namespace vk { namespace brx
 
         bool bDebug{ false };
 
+        // per instance key, the id is only valid for the static instances
         stl::vector<FfxBrixelizerInstanceDescription> geoInstDescs;
         stl::vector<FfxBrixelizerInstanceID> geoInstIds;
+        stl::vector<InstanceState> geoInstStates;
+        stl::vector<uint32_t> geoInstStillFrames;
+
+        stl::vector<uint32_t> dynamicInstKeys;
+        stl::vector<BrixelInstanceDelta> pendingInstDeltas;
 
         // 0 - vertex buffer
         // 1 - index buffer
@@ -44,6 +56,7 @@ namespace kage { namespace vk { namespace brx
         bool postInitilized{ false };
         uint32_t frameIdx{ 0 };
         float sdfCenter[3]{ 0.f, 0.f, 0.f };
+        uint32_t maxBricksPerBake{ 1 << 14 };
         size_t gpuScratchedBufferSize{ 128 * 1024 * 1024 }; // 128MB
 
         struct FfxCtx
@@ -60,6 +73,7 @@ namespace kage { namespace vk { namespace brx
     void shutdown(FFXBrixelizer_vk&);
 
     void setGeoInstances(FFXBrixelizer_vk& _bxl, const Memory* _desc);
+    void setGeoInstanceDeltas(FFXBrixelizer_vk& _bxl, const Memory* _deltas);
     void setGeoBuffers(FFXBrixelizer_vk& _bxl, const Memory* _bufs);
     void setUserResources(FFXBrixelizer_vk& _bxl, const Memory* _reses);
     void setDebugInfos(FFXBrixelizer_vk& _bxl, const Memory* _debug);
@@ -34,6 +34,24 @@ struct BrixelDebugDescs
     float tmax;
     BrixelDebugType debugType;
     bool followCam{ true };
+
+    // bricks baked per update, the rest of the dirty bricks wait for the next frames
+    uint32_t maxBricksPerBake{ 1 << 14 };
+};
+
+enum class BrixelInstanceOp : uint32_t
+{
+    add = 0,
+    update,     // moved, the instance goes dynamic until it stays still
+    remove,
+};
+
+// instances are keyed by the draw index
+struct BrixelInstanceDelta
+{
+    BrixelInstanceOp op;
+    uint32_t key;
+    FfxBrixelizerInstanceDescription desc;
 };
 
 
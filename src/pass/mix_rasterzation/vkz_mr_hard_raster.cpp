@@ -7,10 +7,19 @@ void initHardRaster(HardRaster& _hr, const HardRasterInitData& _init, const Pass
     bool isLate = (PassStage::late == _stage);
     bool isAlpha = (PassStage::alpha == _stage);
 
-    kage::ShaderHandle ms = kage::registShader("hard_raster_mesh", "shader/hard_raster.mesh.spv");
-    kage::ShaderHandle fs = kage::registShader("hard_raster_frag", "shader/bindless.frag.spv");
+    const bool useSceneAddr = kage::isValid(_init.sceneAddrBuffer);
 
-    kage::ProgramHandle prog = kage::registProgram("hard_raster_prog", { ms, fs }, sizeof(Constants), _init.bindless);
+    kage::ShaderHandle ms = useSceneAddr
+        ? kage::registShader("hard_raster_mesh_addr", "shader/hard_raster_addr.mesh.spv")
+        : kage::registShader("hard_raster_mesh", "shader/hard_raster.mesh.spv");
+    const bool compactGBuf = (GBufferLayout::compact == _init.g_buffer.layout);
+    const bool texFeedback = kage::isValid(_init.texFeedbackBuf);
+    const char* fsName = texFeedback
+        ? (compactGBuf ? "hard_raster_frag_compact_feedback" : "hard_raster_frag_feedback")
+        : (compactGBuf ? "hard_raster_frag_compact" : "hard_raster_frag");
+    kage::ShaderHandle fs = kage::registShader(fsName, getGBufferFragShaderPath(_init.g_buffer.layout, texFeedback));
+
+    kage::ProgramHandle prog = kage::registProgram(useSceneAddr ? "hard_raster_prog_addr" : "hard_raster_prog", { ms, fs }, sizeof(Constants), _init.bindless);
 
     kage::PassDesc desc{};
     desc.prog = prog;
@@ -30,22 +39,34 @@ void initHardRaster(HardRaster& _hr, const HardRasterInitData& _init, const Pass
         , Stage::mesh_shader
         , Access::shader_read);
 
-    kage::bindBuffer(pass, _init.transformBuffer
+    kage::bindBuffer(pass, _init.prevDrawBuffer
         , Stage::mesh_shader
         , Access::shader_read);
 
-    kage::bindBuffer(pass, _init.vtxBuffer
+    kage::bindBuffer(pass, _init.transformBuffer
         , Stage::mesh_shader
         , Access::shader_read);
 
-    kage::bindBuffer(pass, _init.meshletBuffer
-        , Stage::mesh_shader
-        , Access::shader_read);
+    if (useSceneAddr)
+    {
+        kage::bindBuffer(pass, _init.sceneAddrBuffer
+            , Stage::mesh_shader
+            , Access::shader_read);
+    }
+    else
+    {
+        kage::bindBuffer(pass, _init.vtxBuffer
+            , Stage::mesh_shader
+            , Access::shader_read);
 
+        kage::bindBuffer(pass, _init.meshletBuffer
+            , Stage::mesh_shader
+            , Access::shader_read);
 
-    kage::bindBuffer(pass, _init.meshletDataBuffer
-        , Stage::mesh_shader
-        , Access::shader_read);
+        kage::bindBuffer(pass, _init.meshletDataBuffer
+            , Stage::mesh_shader
+            , Access::shader_read);
+    }
 
     kage::bindBuffer(pass, _init.triPayloadBuffer
         , Stage::mesh_shader
@@ -66,17 +87,31 @@ void initHardRaster(HardRaster& _hr, const HardRasterInitData& _init, const Pass
     );
 
 
+    kage::BufferHandle texFeedbackOutAlias;
+    if (texFeedback)
+    {
+        texFeedbackOutAlias = kage::alias(_init.texFeedbackBuf);
+        kage::bindBuffer(pass, _init.texFeedbackBuf
+            , Stage::fragment_shader
+            , Access::shader_read | Access::shader_write
+            , texFeedbackOutAlias
+        );
+    }
+
     kage::setIndirectBuffer(pass, _init.triPayloadCountBuffer);
 
 
     kage::setAttachmentOutput(pass, _init.depth, depthOutAlias);
 
     // bind g-buffer
-    kage::setAttachmentOutput(pass, _init.g_buffer.albedo, gBufferOutAlias.albedo);
-    kage::setAttachmentOutput(pass, _init.g_buffer.normal, gBufferOutAlias.normal);
-    kage::setAttachmentOutput(pass, _init.g_buffer.worldPos, gBufferOutAlias.worldPos);
-    kage::setAttachmentOutput(pass, _init.g_buffer.emissive, gBufferOutAlias.emissive);
-    kage::setAttachmentOutput(pass, _init.g_buffer.specular, gBufferOutAlias.specular);
+    kage::ImageHandle gbImgs[kMaxGBufferImages];
+    kage::ImageHandle gbOutAliases[kMaxGBufferImages];
+    const uint32_t gbCount = getGBufferImages(_init.g_buffer, gbImgs);
+    getGBufferImages(gBufferOutAlias, gbOutAliases);
+    for (uint32_t ii = 0; ii < gbCount; ++ii)
+    {
+        kage::setAttachmentOutput(pass, gbImgs[ii], gbOutAliases[ii]);
+    }
 
     _hr.pass = pass;
     _hr.ms = ms;
@@ -93,9 +128,11 @@ void initHardRaster(HardRaster& _hr, const HardRasterInitData& _init, const Pass
     _hr.meshletBuffer = _init.meshletBuffer;
     _hr.meshletDataBuffer = _init.meshletDataBuffer;
     _hr.meshDrawBuffer = _init.meshDrawBuffer;
+    _hr.prevDrawBuffer = _init.prevDrawBuffer;
     _hr.transformBuffer = _init.transformBuffer;
     _hr.triPayloadBuffer = _init.triPayloadBuffer;
     _hr.triPayloadCountBuffer = _init.triPayloadCountBuffer;
+    _hr.sceneAddrBuffer = _init.sceneAddrBuffer;
 
     _hr.pyramid = _init.pyramid;
     _hr.pyrSampler = pyrSampler;
@@ -104,10 +141,12 @@ void initHardRaster(HardRaster& _hr, const HardRasterInitData& _init, const Pass
     // read / write images
     _hr.depth = _init.depth;
     _hr.g_buffer = _init.g_buffer;
+    _hr.texFeedbackBuf = _init.texFeedbackBuf;
 
     // out-alias
     _hr.depthOutAlias = depthOutAlias;
     _hr.g_bufferOutAlias = gBufferOutAlias;
+    _hr.texFeedbackBufOutAlias = texFeedbackOutAlias;
 }
 
 void recHardRaster(const HardRaster& _hr, const Constants& _consts)
@@ -120,18 +159,46 @@ void recHardRaster(const HardRaster& _hr, const Constants& _consts)
     memcpy(mem->data, &_consts, mem->size);
     kage::setConstants(mem);
 
-    kage::Binding binds[] =
+    // the feedback is the last one
+    const bool texFeedback = kage::isValid(_hr.texFeedbackBuf);
+    if (kage::isValid(_hr.sceneAddrBuffer))
     {
-        { _hr.transformBuffer,      BindingAccess::read,    Stage::mesh_shader },
-        { _hr.vtxBuffer,            BindingAccess::read,    Stage::mesh_shader },
-        { _hr.meshDrawBuffer,       BindingAccess::read,    Stage::mesh_shader | Stage::fragment_shader },
-        { _hr.meshletBuffer,        BindingAccess::read,    Stage::mesh_shader },
-        { _hr.meshletDataBuffer,    BindingAccess::read,    Stage::mesh_shader },
-        { _hr.triPayloadBuffer,     BindingAccess::read,    Stage::mesh_shader },
-        { _hr.triPayloadCountBuffer,BindingAccess::read,    Stage::mesh_shader },
-    };
-
-    kage::pushBindings(binds, COUNTOF(binds));
+        // the vertices, meshlets and meshlet data are in the address block, keep sync with hard_raster_mesh.h
+        // the feedback stays at binding 8 for the fragment shaders, the payload count is only a placeholder for the gap
+        kage::Binding binds[] =
+        {
+            { _hr.transformBuffer,      BindingAccess::read,    Stage::mesh_shader },
+            { _hr.sceneAddrBuffer,      BindingAccess::read,    Stage::mesh_shader },
+            { _hr.meshDrawBuffer,       BindingAccess::read,    Stage::mesh_shader | Stage::fragment_shader },
+            { _hr.triPayloadBuffer,     BindingAccess::read,    Stage::mesh_shader },
+            { _hr.triPayloadCountBuffer,BindingAccess::read,    Stage::mesh_shader },
+            { _hr.prevDrawBuffer,       BindingAccess::read,    Stage::mesh_shader },
+            { _hr.triPayloadCountBuffer,BindingAccess::read,    Stage::mesh_shader },
+            { _hr.triPayloadCountBuffer,BindingAccess::read,    Stage::mesh_shader },
+            { _hr.texFeedbackBuf,       BindingAccess::read_write, Stage::fragment_shader },
+        };
+
+        const uint16_t bindCount = texFeedback ? COUNTOF(binds) : COUNTOF(binds) - 3;
+        kage::pushBindings(binds, bindCount);
+    }
+    else
+    {
+        kage::Binding binds[] =
+        {
+            { _hr.transformBuffer,      BindingAccess::read,    Stage::mesh_shader },
+            { _hr.vtxBuffer,            BindingAccess::read,    Stage::mesh_shader },
+            { _hr.meshDrawBuffer,       BindingAccess::read,    Stage::mesh_shader | Stage::fragment_shader },
+            { _hr.meshletBuffer,        BindingAccess::read,    Stage::mesh_shader },
+            { _hr.meshletDataBuffer,    BindingAccess::read,    Stage::mesh_shader },
+            { _hr.triPayloadBuffer,     BindingAccess::read,    Stage::mesh_shader },
+            { _hr.triPayloadCountBuffer,BindingAccess::read,    Stage::mesh_shader },
+            { _hr.prevDrawBuffer,       BindingAccess::read,    Stage::mesh_shader },
+            { _hr.texFeedbackBuf,       BindingAccess::read_write, Stage::fragment_shader },
+        };
+
+        const uint16_t bindCount = texFeedback ? COUNTOF(binds) : COUNTOF(binds) - 1;
+        kage::pushBindings(binds, bindCount);
+    }
 
     kage::setBindless(_hr.bindless);
 
@@ -140,14 +207,15 @@ void recHardRaster(const HardRaster& _hr, const Constants& _consts)
 
     bool is_early = (PassStage::early == _hr.stage);
 
-    kage::Attachment attachments[] = {
-        {_hr.g_buffer.albedo,   is_early ? LoadOp::clear : LoadOp::dont_care, StoreOp::store},
-        {_hr.g_buffer.normal,   is_early ? LoadOp::clear : LoadOp::dont_care, StoreOp::store},
-        {_hr.g_buffer.worldPos, is_early ? LoadOp::clear : LoadOp::dont_care, StoreOp::store},
-        {_hr.g_buffer.emissive, is_early ? LoadOp::clear : LoadOp::dont_care, StoreOp::store},
-        {_hr.g_buffer.specular, is_early ? LoadOp::clear : LoadOp::dont_care, StoreOp::store},
-    };
-    kage::setColorAttachments(attachments, COUNTOF(attachments));
+    kage::ImageHandle gbImgs[kMaxGBufferImages];
+    const uint32_t gbCount = getGBufferImages(_hr.g_buffer, gbImgs);
+
+    kage::Attachment attachments[kMaxGBufferImages];
+    for (uint32_t ii = 0; ii < gbCount; ++ii)
+    {
+        attachments[ii] = { gbImgs[ii], is_early ? LoadOp::clear : LoadOp::dont_care, StoreOp::store };
+    }
+    kage::setColorAttachments(attachments, (uint16_t)gbCount);
 
     kage::Attachment depthAttachment = {
         _hr.depth
@@ -11,17 +11,25 @@ struct HardRasterInitData
     kage::BufferHandle meshletBuffer;
     kage::BufferHandle meshletDataBuffer;
     kage::BufferHandle meshDrawBuffer;
+    kage::BufferHandle prevDrawBuffer; // draw transforms of the previous frame, for the per-object motion
     kage::BufferHandle transformBuffer;
 
     kage::BufferHandle triPayloadBuffer;
     kage::BufferHandle triPayloadCountBuffer;
 
+    // optional, the scene address block, see SceneAddressSlot
+    // the vertices, meshlets and meshlet data are read through it instead of the bindings
+    kage::BufferHandle sceneAddrBuffer;
+
     kage::ImageHandle pyramid;
     kage::ImageHandle depth;
 
     kage::BindlessHandle bindless;
 
     GBuffer g_buffer;
+
+    // optional, the texture streaming feedback
+    kage::BufferHandle texFeedbackBuf;
 };
 
 // using mesh shading pipeline for hardware rasterization
@@ -42,12 +50,13 @@ struct HardRaster
     kage::BufferHandle meshletBuffer;
     kage::BufferHandle meshletDataBuffer;
     kage::BufferHandle meshDrawBuffer;
+    kage::BufferHandle prevDrawBuffer; // draw transforms of the previous frame, for the per-object motion
     kage::BufferHandle transformBuffer;
 
     kage::BufferHandle triPayloadBuffer;
     kage::BufferHandle triPayloadCountBuffer;
+    kage::BufferHandle sceneAddrBuffer;
 
-    
     kage::ImageHandle pyramid;
     kage::SamplerHandle pyrSampler;
 
@@ -56,10 +65,12 @@ struct HardRaster
     // read / write
     kage::ImageHandle depth;
     GBuffer g_buffer;
+    kage::BufferHandle texFeedbackBuf;
 
     // out-alias
     kage::ImageHandle depthOutAlias;
     GBuffer g_bufferOutAlias;
+    kage::BufferHandle texFeedbackBufOutAlias;
 };
 
 void initHardRaster(HardRaster& _hardRaster, const HardRasterInitData& _initData, const PassStage _stage);
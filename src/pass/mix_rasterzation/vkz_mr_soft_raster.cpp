@@ -13,6 +13,7 @@ void recSoftRaster(const SoftRaster& _raster)
         {
             { _raster.inColor,  Aspect::color, {kage::ClearColor { 0.f, 0.f, 0.f, 1.f }}},
             { _raster.inDepth,  Aspect::depth, {kage::ClearDepthStencil{0.f, 0}}},
+            { _raster.inVelocity, Aspect::color, {kage::ClearColor { 0.f, 0.f, 0.f, 0.f }}},
             { _raster.u32depth, Aspect::color, {kage::ClearColor { 0u, 0u, 0u, 0u }}},
             { _raster.u32depth, Aspect::color, {kage::ClearColor { 0u, 0u, 0u, 0u }}}
         };
@@ -28,23 +29,49 @@ void recSoftRaster(const SoftRaster& _raster)
     kage::setConstants(mem);
 
     // bind resources
-    kage::Binding binds[] =
+    if (kage::isValid(_raster.sceneAddrBuf))
     {
-        { _raster.meshDrawBuf,      BindingAccess::read,    Stage::compute_shader },
-        { _raster.transformBuf,     BindingAccess::read,    Stage::compute_shader },
-        { _raster.vtxBuf,           BindingAccess::read,    Stage::compute_shader },
-        { _raster.meshletBuf,       BindingAccess::read,    Stage::compute_shader },
-        { _raster.meshletDataBuf,   BindingAccess::read,    Stage::compute_shader },
-        { _raster.payloadBuf,       BindingAccess::read,    Stage::compute_shader },
-        { _raster.payloadCntBuf,    BindingAccess::read,    Stage::compute_shader },
-        { _raster.pyramid,          _raster.pyramidSamp,    Stage::compute_shader },
-        { _raster.inColor,          0,                      Stage::compute_shader },
-        { _raster.u32depth,         0,                      Stage::compute_shader },
-        { _raster.inDepth,          0,                      Stage::compute_shader },
-        { _raster.u32debugImg,      0,                      Stage::compute_shader },
-    };
-
-    kage::pushBindings(binds, COUNTOF(binds));
+        // the vertices, meshlets and meshlet data are in the address block, keep sync with soft_raster.h
+        kage::Binding binds[] =
+        {
+            { _raster.meshDrawBuf,      BindingAccess::read,    Stage::compute_shader },
+            { _raster.transformBuf,     BindingAccess::read,    Stage::compute_shader },
+            { _raster.sceneAddrBuf,     BindingAccess::read,    Stage::compute_shader },
+            { _raster.payloadBuf,       BindingAccess::read,    Stage::compute_shader },
+            { _raster.payloadCntBuf,    BindingAccess::read,    Stage::compute_shader },
+            { _raster.pyramid,          _raster.pyramidSamp,    Stage::compute_shader },
+            { _raster.inColor,          0,                      Stage::compute_shader },
+            { _raster.u32depth,         0,                      Stage::compute_shader },
+            { _raster.inDepth,          0,                      Stage::compute_shader },
+            { _raster.u32debugImg,      0,                      Stage::compute_shader },
+            { _raster.inVelocity,       0,                      Stage::compute_shader },
+            { _raster.prevDrawBuf,      BindingAccess::read,    Stage::compute_shader },
+        };
+
+        kage::pushBindings(binds, COUNTOF(binds));
+    }
+    else
+    {
+        kage::Binding binds[] =
+        {
+            { _raster.meshDrawBuf,      BindingAccess::read,    Stage::compute_shader },
+            { _raster.transformBuf,     BindingAccess::read,    Stage::compute_shader },
+            { _raster.vtxBuf,           BindingAccess::read,    Stage::compute_shader },
+            { _raster.meshletBuf,       BindingAccess::read,    Stage::compute_shader },
+            { _raster.meshletDataBuf,   BindingAccess::read,    Stage::compute_shader },
+            { _raster.payloadBuf,       BindingAccess::read,    Stage::compute_shader },
+            { _raster.payloadCntBuf,    BindingAccess::read,    Stage::compute_shader },
+            { _raster.pyramid,          _raster.pyramidSamp,    Stage::compute_shader },
+            { _raster.inColor,          0,                      Stage::compute_shader },
+            { _raster.u32depth,         0,                      Stage::compute_shader },
+            { _raster.inDepth,          0,                      Stage::compute_shader },
+            { _raster.u32debugImg,      0,                      Stage::compute_shader },
+            { _raster.inVelocity,       0,                      Stage::compute_shader },
+            { _raster.prevDrawBuf,      BindingAccess::read,    Stage::compute_shader },
+        };
+
+        kage::pushBindings(binds, COUNTOF(binds));
+    }
 
     kage::dispatchIndirect(_raster.payloadCntBuf, offsetof(IndirectDispatchCommand, x));
     kage::endRec();
@@ -52,9 +79,13 @@ void recSoftRaster(const SoftRaster& _raster)
 
 void initSoftRaster(SoftRaster& _softRaster, const SoftRasterDataInit& _initData, const PassStage _stage)
 {
-    kage::ShaderHandle cs = kage::registShader("soft_raster", "shader/soft_raster.comp.spv");
+    const bool useSceneAddr = kage::isValid(_initData.sceneAddrBuf);
+
+    kage::ShaderHandle cs = useSceneAddr
+        ? kage::registShader("soft_raster_addr", "shader/soft_raster_addr.comp.spv")
+        : kage::registShader("soft_raster", "shader/soft_raster.comp.spv");
 
-    kage::ProgramHandle prog = kage::registProgram("soft_raster", { cs }, sizeof(vec2));
+    kage::ProgramHandle prog = kage::registProgram(useSceneAddr ? "soft_raster_addr" : "soft_raster", { cs }, sizeof(vec2));
 
     kage::PassDesc passDesc;
     passDesc.prog = prog;
@@ -88,6 +119,7 @@ void initSoftRaster(SoftRaster& _softRaster, const SoftRasterDataInit& _initData
     kage::ImageHandle outDepth = kage::alias(_initData.depth);
     kage::ImageHandle outU32Depth = kage::alias(u32depth);
     kage::ImageHandle outU32Debug = kage::alias(u32debug);
+    kage::ImageHandle outVelocity = kage::alias(_initData.velocity);
 
     kage::setIndirectBuffer(pass, _initData.payloadCntBuf);
 
@@ -98,28 +130,45 @@ void initSoftRaster(SoftRaster& _softRaster, const SoftRasterDataInit& _initData
     );
 
     kage::bindBuffer(pass
-        , _initData.transformBuf
+        , _initData.prevDrawBuf
         , Stage::compute_shader
         , Access::shader_read
     );
 
     kage::bindBuffer(pass
-        , _initData.vtxBuf
-        , Stage::compute_shader
-        , Access::shader_read
-    );
-    
-    kage::bindBuffer(pass
-        , _initData.meshletBuf
+        , _initData.transformBuf
         , Stage::compute_shader
         , Access::shader_read
     );
 
-    kage::bindBuffer(pass
-        ,_initData.meshletDataBuf
-        , Stage::compute_shader
-        , Access::shader_read
-    );
+    if (useSceneAddr)
+    {
+        kage::bindBuffer(pass
+            , _initData.sceneAddrBuf
+            , Stage::compute_shader
+            , Access::shader_read
+        );
+    }
+    else
+    {
+        kage::bindBuffer(pass
+            , _initData.vtxBuf
+            , Stage::compute_shader
+            , Access::shader_read
+        );
+
+        kage::bindBuffer(pass
+            , _initData.meshletBuf
+            , Stage::compute_shader
+            , Access::shader_read
+        );
+
+        kage::bindBuffer(pass
+            ,_initData.meshletDataBuf
+            , Stage::compute_shader
+            , Access::shader_read
+        );
+    }
 
 
     kage::bindBuffer(pass
@@ -175,6 +224,14 @@ void initSoftRaster(SoftRaster& _softRaster, const SoftRasterDataInit& _initData
         , outU32Debug
     );
 
+    kage::bindImage(pass
+        , _initData.velocity
+        , Stage::compute_shader
+        , Access::shader_write
+        , kage::ImageLayout::general
+        , outVelocity
+    );
+
     _softRaster.pass = pass;
     _softRaster.cs = cs;
     _softRaster.prog = prog;
@@ -183,10 +240,12 @@ void initSoftRaster(SoftRaster& _softRaster, const SoftRasterDataInit& _initData
     _softRaster.payloadCntBuf = _initData.payloadCntBuf;
 
     _softRaster.meshDrawBuf = _initData.meshDrawBuf;
+    _softRaster.prevDrawBuf = _initData.prevDrawBuf;
     _softRaster.transformBuf = _initData.transformBuf;
     _softRaster.vtxBuf = _initData.vtxBuf;
     _softRaster.meshletBuf = _initData.meshletBuf;
     _softRaster.meshletDataBuf = _initData.meshletDataBuf;
+    _softRaster.sceneAddrBuf = _initData.sceneAddrBuf;
 
     _softRaster.inColor = _initData.color;
     _softRaster.inDepth = _initData.depth;
@@ -194,6 +253,8 @@ void initSoftRaster(SoftRaster& _softRaster, const SoftRasterDataInit& _initData
     _softRaster.u32depthOutAlias = outU32Depth;
     _softRaster.colorOutAlias = outColor;
     _softRaster.depthOutAlias = outDepth;
+    _softRaster.inVelocity = _initData.velocity;
+    _softRaster.velocityOutAlias = outVelocity;
 
     _softRaster.pyramid = _initData.pyramid;
     _softRaster.pyramidSamp = samp;
@@ -11,11 +11,16 @@ struct SoftRasterDataInit
     kage::BufferHandle payloadCntBuf;
 
     kage::BufferHandle meshDrawBuf;
+    kage::BufferHandle prevDrawBuf; // draw transforms of the previous frame, for the per-object motion
     kage::BufferHandle transformBuf;
     kage::BufferHandle vtxBuf;
     kage::BufferHandle meshletBuf;
     kage::BufferHandle meshletDataBuf;
 
+    // optional, the scene address block, see SceneAddressSlot
+    // the vertices, meshlets and meshlet data are read through it instead of the bindings
+    kage::BufferHandle sceneAddrBuf;
+
     kage::ImageHandle pyramid;
     
     uint32_t width; // width of the output image
@@ -23,6 +28,7 @@ struct SoftRasterDataInit
 
     kage::ImageHandle color; // output image for soft rasterization results
     kage::ImageHandle depth; // output depth image for soft rasterization results
+    kage::ImageHandle velocity; // output screen motion in uv, see GBuffer::velocity
 };
 
 struct SoftRaster
@@ -36,16 +42,19 @@ struct SoftRaster
     kage::BufferHandle payloadCntBuf;
 
     kage::BufferHandle meshDrawBuf;
+    kage::BufferHandle prevDrawBuf; // draw transforms of the previous frame, for the per-object motion
     kage::BufferHandle transformBuf;
     kage::BufferHandle vtxBuf;
     kage::BufferHandle meshletBuf;
     kage::BufferHandle meshletDataBuf;
+    kage::BufferHandle sceneAddrBuf;
 
     kage::ImageHandle pyramid; // input depth image for soft rasterization
     kage::SamplerHandle pyramidSamp; // sampler for the input image
 
     kage::ImageHandle inColor;
     kage::ImageHandle inDepth;
+    kage::ImageHandle inVelocity;
     
     kage::ImageHandle u32depth; // depth image in uint32_t format for soft rasterization
     kage::ImageHandle u32depthOutAlias;
@@ -56,6 +65,7 @@ struct SoftRaster
     // output alias
     kage::ImageHandle colorOutAlias; // output image for soft rasterization results
     kage::ImageHandle depthOutAlias; // output depth image for soft rasterization results
+    kage::ImageHandle velocityOutAlias;
 
     // other essential data
     uint32_t width; // width of the output image
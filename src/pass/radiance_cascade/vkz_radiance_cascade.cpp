@@ -10,58 +10,219 @@ struct RCBuildInit
     kage::ImageHandle skybox;
 
     BRX_UserResources brx;
+
+    kage::BufferHandle liveProbeCmd;
+    kage::BufferHandle liveProbes;
+
+    RCStorageFormat format;
+    uint32_t probeSideCount;
+    uint32_t rayGridSideCount;
 };
 
 struct RCMergeInit
 {
     kage::ImageHandle radianceCascade;
+    kage::ImageHandle rcAlpha;
     kage::ImageHandle skybox;
 
+    RCStorageFormat inFormat;
+    RCStorageFormat outFormat;
+
     uint32_t currCas;
+    uint32_t probeSideCount;
+    uint32_t rayGridSideCount;
+};
+
+static const char* s_rcStorageFormatNames[] =
+{
+    "rgba8",
+    "r11g11b10",
+    "rgb9e5",
+    "rgba16f",
 };
+static_assert(COUNTOF(s_rcStorageFormatNames) == (size_t)RCStorageFormat::count, "keep sync with RCStorageFormat");
 
-uint32_t getMaxCascadesCount()
+const char* getRCStorageFormatName(RCStorageFormat _format)
 {
-    uint32_t lvCount = 0;
-    while (true) {
-        if ((kage::k_rclv0_probeSideCount >> lvCount) == 0)
-            break;
-        ++lvCount;
+    if (_format >= RCStorageFormat::count)
+        return "unknown";
+
+    return s_rcStorageFormatNames[(uint32_t)_format];
+}
+
+RCStorageFormat parseRCStorageFormat(const char* _name)
+{
+    for (uint32_t ii = 0; ii < (uint32_t)RCStorageFormat::count; ++ii)
+    {
+        if (0 == strcmp(_name, s_rcStorageFormatNames[ii]))
+            return RCStorageFormat(ii);
     }
 
-    return lvCount - 1;
+    return RCStorageFormat::count;
 }
 
-void prepareRCbuild(RadianceCascadeBuild& _rc, const RCBuildInit& _init)
+static kage::ResourceFormat getRCImageFormat(RCStorageFormat _format)
 {
-    // build the cascade image
-    kage::ShaderHandle cs = kage::registShader("build_cascade", "shader/rc_build_cascade.comp.spv");
-    kage::ProgramHandle program = kage::registProgram("build_cascade", { cs }, sizeof(RadianceCascadesConfig));
+    switch (_format)
+    {
+    case RCStorageFormat::r11g11b10:    return kage::ResourceFormat::b10g11r11_sfloat;
+    case RCStorageFormat::rgb9e5:       return kage::ResourceFormat::r32_uint;
+    case RCStorageFormat::rgba16f:      return kage::ResourceFormat::r16g16b16a16_sfloat;
+    default:                            return kage::ResourceFormat::r8g8b8a8_unorm;
+    }
+}
 
-    kage::PassDesc passDesc{};
-    passDesc.prog = program;
-    passDesc.queue = kage::PassExeQueue::compute;
+uint32_t getRCStorageTexelSize(RCStorageFormat _format)
+{
+    switch (_format)
+    {
+    case RCStorageFormat::r11g11b10:    return 4 + 1;
+    case RCStorageFormat::rgb9e5:       return 4 + 1;
+    case RCStorageFormat::rgba16f:      return 8;
+    default:                            return 4;
+    }
+}
 
-    kage::PassHandle pass = kage::registPass("build_cascade", passDesc);
+RCStorageFormat getSupportedRCStorageFormat(RCStorageFormat _format)
+{
+    bool supported = kage::checkStorageImageSupports(getRCImageFormat(_format))
+        && kage::checkStorageImageSupports(getRCImageFormat(getRCMergedProbeFormat(_format)));
+
+    if (!rcStorageHasAlpha(_format))
+        supported = supported && kage::checkStorageImageSupports(kage::ResourceFormat::r8_unorm);
 
-    uint32_t texelSideCount = kage::k_rclv0_probeSideCount * kage::k_rclv0_rayGridSideCount;
-    uint32_t imgLayers = kage::k_rclv0_probeSideCount * 2 - 1;
+    if (supported || RCStorageFormat::rgba16f == _format)
+        return _format;
+
+    kage::message(kage::warning, "radiance cascades: %s is not a storage format on this device, use rgba16f", getRCStorageFormatName(_format));
+    return RCStorageFormat::rgba16f;
+}
+
+RCStorageFormat getRCMergedProbeFormat(RCStorageFormat _format)
+{
+    return (RCStorageFormat::rgb9e5 == _format) ? RCStorageFormat::rgba16f : _format;
+}
 
+// the packed format is fetched and filtered by hand
+static kage::SamplerFilter getRCSamplerFilter(RCStorageFormat _format, kage::SamplerFilter _filter)
+{
+    return (RCStorageFormat::rgb9e5 == _format) ? kage::SamplerFilter::nearest : _filter;
+}
+
+// the cascade atlas, all levels share the texel side and stack up the layers
+static void getRCAtlasSize(uint32_t& _outSide, uint32_t& _outLayers, uint32_t _probeSideCount, uint32_t _rayGridSideCount)
+{
+    _outSide = _probeSideCount * _rayGridSideCount;
+    _outLayers = _probeSideCount * 2 - 1;
+}
+
+static void getRCMergedSize(uint32_t& _outSide, uint32_t& _outLayers, bool _rayPrime, uint32_t _probeSideCount, uint32_t _rayGridSideCount, uint32_t _currCas)
+{
+    uint32_t probSideCnt = glm::max(_probeSideCount >> _currCas, 1u);
+    _outSide = _rayPrime ? _probeSideCount * _rayGridSideCount : probSideCnt;
+    _outLayers = _rayPrime ? probSideCnt * 2 : probSideCnt;
+}
+
+RCMemoryReport calcRadianceCascadeMemory(RCStorageFormat _format, uint32_t _probeSideCount, uint32_t _rayGridSideCount, uint32_t _currCas)
+{
+    uint32_t side, layers;
+    RCMemoryReport report{};
+
+    getRCAtlasSize(side, layers, _probeSideCount, _rayGridSideCount);
+    report.cascade = uint64_t(side) * side * layers * getRCStorageTexelSize(_format);
+
+    getRCMergedSize(side, layers, true, _probeSideCount, _rayGridSideCount, _currCas);
+    report.mergedRay = uint64_t(side) * side * layers * getRCStorageTexelSize(_format);
+
+    // the merged probes keep no hit mask
+    const RCStorageFormat probeFormat = getRCMergedProbeFormat(_format);
+    const uint32_t probeTexelSize = getRCStorageTexelSize(probeFormat) - (rcStorageHasAlpha(probeFormat) ? 0 : 1);
+    getRCMergedSize(side, layers, false, _probeSideCount, _rayGridSideCount, _currCas);
+    report.mergedProbe = uint64_t(side) * side * layers * probeTexelSize;
+
+    report.total = report.cascade + report.mergedRay + report.mergedProbe;
+    return report;
+}
+
+RCMemoryReport getRadianceCascadeMemory(const RadianceCascade& _rc)
+{
+    RCMemoryReport report = calcRadianceCascadeMemory(
+        _rc.build.format
+        , _rc.build.probeSideCount
+        , _rc.build.rayGridSideCount
+        , _rc.mergeProbe.currLv
+    );
+
+    report.occupancy = _rc.occupancy.memorySize;
+    report.total += report.occupancy;
+    return report;
+}
+
+static kage::ImageDesc getRCImageDesc(RCStorageFormat _format, uint32_t _side, uint32_t _layers)
+{
     kage::ImageDesc imgDesc{};
-    imgDesc.width = texelSideCount;
-    imgDesc.height = texelSideCount;
-    imgDesc.format = kage::ResourceFormat::r8g8b8a8_unorm;
+    imgDesc.width = _side;
+    imgDesc.height = _side;
+    imgDesc.format = getRCImageFormat(_format);
     imgDesc.depth = 1;
-    imgDesc.numLayers = imgLayers;
+    imgDesc.numLayers = _layers;
     imgDesc.numMips = 1;
     imgDesc.type = kage::ImageType::type_2d;
     imgDesc.viewType = kage::ImageViewType::type_2d_array;
     imgDesc.usage = ImgUsage::transfer_dst | ImgUsage::storage | ImgUsage::sampled;
     imgDesc.layout = kage::ImageLayout::general;
 
+    return imgDesc;
+}
+
+static kage::ImageDesc getRCAlphaImageDesc(uint32_t _side, uint32_t _layers)
+{
+    kage::ImageDesc imgDesc = getRCImageDesc(RCStorageFormat::rgba8, _side, _layers);
+    imgDesc.format = kage::ResourceFormat::r8_unorm;
+
+    return imgDesc;
+}
+
+void prepareRCbuild(RadianceCascadeBuild& _rc, const RCBuildInit& _init)
+{
+    // build the cascade image
+    kage::ShaderHandle cs = kage::registShader("build_cascade", "shader/rc_build_cascade.comp.spv");
+    kage::ProgramHandle program = kage::registProgram("build_cascade", { cs }, sizeof(RadianceCascadesConfig));
+
+    const bool compact = (GBufferLayout::compact == _init.g_buffer.layout);
+
+    int pipelineSpecs[] = {
+        compact
+        , int(_init.format)
+    };
+
+    const kage::Memory* pConst = kage::alloc(sizeof(int) * COUNTOF(pipelineSpecs));
+    memcpy_s(pConst->data, pConst->size, pipelineSpecs, sizeof(int) * COUNTOF(pipelineSpecs));
+
+    kage::PassDesc passDesc{};
+    passDesc.prog = program;
+    passDesc.queue = kage::PassExeQueue::compute;
+    passDesc.pipelineSpecNum = COUNTOF(pipelineSpecs);
+    passDesc.pipelineSpecData = (void*)pConst->data;
+
+    kage::PassHandle pass = kage::registPass("build_cascade", passDesc);
+
+    uint32_t texelSideCount, imgLayers;
+    getRCAtlasSize(texelSideCount, imgLayers, _init.probeSideCount, _init.rayGridSideCount);
+
+    kage::ImageDesc imgDesc = getRCImageDesc(_init.format, texelSideCount, imgLayers);
     kage::ImageHandle img = kage::registTexture("cascade", imgDesc, nullptr, kage::ResourceLifetime::non_transition);
     kage::ImageHandle outAlias = kage::alias(img);
 
+    kage::ImageHandle alphaImg = img;
+    kage::ImageHandle alphaOutAlias = outAlias;
+    if (!rcStorageHasAlpha(_init.format))
+    {
+        kage::ImageDesc alphaDesc = getRCAlphaImageDesc(texelSideCount, imgLayers);
+        alphaImg = kage::registTexture("cascade_alpha", alphaDesc, nullptr, kage::ResourceLifetime::non_transition);
+        alphaOutAlias = kage::alias(alphaImg);
+    }
+
     // transform buffer
     kage::BufferDesc transDesc{};
     transDesc.size = sizeof(RadianceCascadesTransform);
@@ -81,28 +242,38 @@ void prepareRCbuild(RadianceCascadeBuild& _rc, const RCBuildInit& _init)
         , kage::SamplerReductionMode::min
     );
 
+    // the packed targets are integer formats, no min reduction for them
+    const kage::SamplerReductionMode packedReduction = compact
+        ? kage::SamplerReductionMode::weighted_average
+        : kage::SamplerReductionMode::min;
+
     kage::SamplerHandle normSamp = kage::sampleImage(pass, _init.g_buffer.normal
         , Stage::compute_shader
         , kage::SamplerFilter::nearest
         , kage::SamplerMipmapMode::nearest
         , kage::SamplerAddressMode::clamp_to_edge
-        , kage::SamplerReductionMode::min
+        , packedReduction
     );
 
-    kage::SamplerHandle wpSamp = kage::sampleImage(pass, _init.g_buffer.worldPos
-        , Stage::compute_shader
-        , kage::SamplerFilter::nearest
-        , kage::SamplerMipmapMode::nearest
-        , kage::SamplerAddressMode::clamp_to_edge
-        , kage::SamplerReductionMode::min
-    );
+    // the compact g-buffer reconstructs the position from the depth
+    kage::SamplerHandle wpSamp;
+    if (!compact)
+    {
+        wpSamp = kage::sampleImage(pass, _init.g_buffer.worldPos
+            , Stage::compute_shader
+            , kage::SamplerFilter::nearest
+            , kage::SamplerMipmapMode::nearest
+            , kage::SamplerAddressMode::clamp_to_edge
+            , kage::SamplerReductionMode::min
+        );
+    }
 
     kage::SamplerHandle emmiSamp = kage::sampleImage(pass, _init.g_buffer.emissive
         , Stage::compute_shader
         , kage::SamplerFilter::nearest
         , kage::SamplerMipmapMode::nearest
         , kage::SamplerAddressMode::clamp_to_edge
-        , kage::SamplerReductionMode::min
+        , packedReduction
     );
 
     kage::SamplerHandle depthSamp = kage::sampleImage(pass, _init.depth
@@ -128,6 +299,23 @@ void prepareRCbuild(RadianceCascadeBuild& _rc, const RCBuildInit& _init)
         , outAlias
     );
 
+    if (!rcStorageHasAlpha(_init.format))
+    {
+        kage::bindImage(pass, alphaImg
+            , Stage::compute_shader
+            , Access::shader_write
+            , kage::ImageLayout::general
+            , alphaOutAlias
+        );
+    }
+
+    kage::bindBuffer(pass, _init.liveProbes
+        , Stage::compute_shader
+        , Access::shader_read
+    );
+
+    kage::setIndirectBuffer(pass, _init.liveProbeCmd);
+
     kage::SamplerHandle brxAtlasSamp = kage::sampleImage(pass, _init.brx.sdfAtlas
         , Stage::compute_shader
         , kage::SamplerFilter::nearest
@@ -157,19 +345,136 @@ void prepareRCbuild(RadianceCascadeBuild& _rc, const RCBuildInit& _init)
     memcpy(&_rc.brx, &_init.brx, sizeof(BRX_UserResources));
     _rc.brxAtlasSamp = brxAtlasSamp;
 
+    _rc.liveProbeCmd = _init.liveProbeCmd;
+    _rc.liveProbes = _init.liveProbes;
+
     _rc.cascadeImg = img;
     _rc.radCascdOutAlias = outAlias;
+
+    _rc.cascadeAlpha = alphaImg;
+    _rc.cascadeAlphaOutAlias = alphaOutAlias;
+
+    _rc.format = _init.format;
+    _rc.probeSideCount = _init.probeSideCount;
+    _rc.rayGridSideCount = _init.rayGridSideCount;
+}
+
+static uint32_t getBuildEndLv(const Dbg_RadianceCascades& _dbg)
+{
+    uint32_t cascadeCount = glm::min(kage::k_rclv0_cascadeLv, _dbg.cascadeCount);
+    return glm::min(_dbg.startCascade + cascadeCount, getRCLevelCount(_dbg));
+}
+
+vec3 getRadianceCascadeCenter(const Dbg_RadianceCascades& _dbg, const vec3& _cameraPos)
+{
+    if (_dbg.rayBudgetM <= 0.f && !_dbg.sparseProbes)
+        return _cameraPos;
+
+    const float cellLen = _dbg.totalRadius * 2.f / float(getRCProbeSideCount(_dbg));
+    if (cellLen <= 0.f)
+        return _cameraPos;
+
+    return glm::floor(_cameraPos / cellLen) * cellLen;
+}
+
+// the settings that change what the cascades store
+static bool isSameBuildSettings(const Dbg_RadianceCascades& _a, const Dbg_RadianceCascades& _b)
+{
+    return _a.totalRadius == _b.totalRadius
+        && _a.startCascade == _b.startCascade
+        && _a.cascadeCount == _b.cascadeCount
+        && _a.probeSideCount == _b.probeSideCount
+        && _a.rayGridSideCount == _b.rayGridSideCount
+        && _a.idx_type == _b.idx_type
+        && _a.color_type == _b.color_type
+        && 0 == memcmp(_a.probePosOffset, _b.probePosOffset, sizeof(_a.probePosOffset))
+        && _a.brx_offset == _b.brx_offset
+        && _a.brx_startCas == _b.brx_startCas
+        && _a.brx_endCas == _b.brx_endCas
+        && _a.brx_sdfEps == _b.brx_sdfEps;
+}
+
+static void scheduleRCBuild(RadianceCascadeBuild& _rc, const Dbg_RadianceCascades& _dbg, bool _occupancyRebuilt)
+{
+    const uint32_t endLv = getBuildEndLv(_dbg);
+
+    // the rows of a level and the rays of a row, the latter is the same for all levels
+    uint64_t totalRays = 0;
+    uint32_t minRows = ~0u;
+    for (uint32_t ii = 0; ii < endLv; ++ii)
+    {
+        uint32_t prob_sideCount = getRCProbeSideCount(_dbg) >> ii;
+        uint32_t ray_sideCount = getRCRayGridSideCount(_dbg) << ii;
+        uint32_t rows = prob_sideCount * ray_sideCount * prob_sideCount;
+
+        totalRays += uint64_t(rows) * (prob_sideCount * ray_sideCount);
+        minRows = glm::min(minRows, rows);
+    }
+
+    const bool moved = _rc.historyCenter != _rc.cameraPos;
+    const bool changed = !isSameBuildSettings(_rc.historyDbg, _dbg);
+
+    // the live probes only refresh themselves, the rest keep the values of the full build
+    _rc.sparse = _dbg.sparseProbes && !_occupancyRebuilt && !moved && !changed && _rc.historyValid;
+
+    if (!_rc.historyValid || moved || changed || _rc.sparse || _dbg.rayBudgetM <= 0.f || totalRays == 0)
+    {
+        // nothing to reuse, trace all the rows this frame, or all the live probes
+        if (_rc.historyValid && (moved || changed))
+            _rc.invalidations++;
+
+        _rc.rowStride = 1;
+        _rc.rowPhase = 0;
+        _rc.frameIdx = 0;
+        _rc.historyValid = true;
+    }
+    else
+    {
+        const uint64_t budget = glm::max(uint64_t(_dbg.rayBudgetM * 1e6f), uint64_t(1));
+        const uint64_t stride = (totalRays + budget - 1) / budget;
+
+        // keep at least one row of the smallest level per frame
+        _rc.rowStride = (uint32_t)glm::clamp(stride, uint64_t(1), uint64_t(glm::max(minRows, 1u)));
+        _rc.frameIdx++;
+        _rc.rowPhase = _rc.frameIdx % _rc.rowStride;
+    }
+
+    _rc.historyCenter = _rc.cameraPos;
+    _rc.historyDbg = _dbg;
+
+    _rc.raysPerFrame = uint32_t((totalRays + _rc.rowStride - 1) / _rc.rowStride);
+    _rc.convergeFrames = _rc.rowStride;
 }
 
-void updateRCBuild(RadianceCascadeBuild& _rc, const Dbg_RadianceCascades& _dbg, const TransformData& _trans)
+void updateRCBuild(RadianceCascadeBuild& _rc, RCOccupancy& _occ, const Dbg_RadianceCascades& _dbg, const TransformData& _trans)
 {
+    // resize the atlas to the level 0 sizes, the history is dropped by the schedule
+    const uint32_t probeSideCount = getRCProbeSideCount(_dbg);
+    const uint32_t rayGridSideCount = getRCRayGridSideCount(_dbg);
+    if (probeSideCount != _rc.probeSideCount || rayGridSideCount != _rc.rayGridSideCount)
+    {
+        uint32_t side, layers;
+        getRCAtlasSize(side, layers, probeSideCount, rayGridSideCount);
+
+        kage::updateImage(_rc.cascadeImg, side, side, layers);
+        if (!rcStorageHasAlpha(_rc.format))
+            kage::updateImage(_rc.cascadeAlpha, side, side, layers);
+
+        _rc.probeSideCount = probeSideCount;
+        _rc.rayGridSideCount = rayGridSideCount;
+    }
+
     // update trans buf
     RadianceCascadesTransform trans;
 
     if (_dbg.followCam) {
-        _rc.cameraPos = _trans.cameraPos;
+        _rc.cameraPos = getRadianceCascadeCenter(_dbg, _trans.cameraPos);
     }
 
+    const bool occupancyRebuilt = updateRCOccupancy(_occ, _dbg, _rc.cameraPos, getBuildEndLv(_dbg));
+
+    scheduleRCBuild(_rc, _dbg, occupancyRebuilt);
+
     if (!_dbg.pauseUpdate) {
         _rc.view = _trans.view;
         _rc.proj = _trans.proj;
@@ -178,6 +483,8 @@ void updateRCBuild(RadianceCascadeBuild& _rc, const Dbg_RadianceCascades& _dbg,
     trans.cameraPos = _rc.cameraPos;
     trans.view = _rc.view;
     trans.proj = _rc.proj;
+    trans.viewProj = _rc.proj * _rc.view;
+    trans.invViewProj = glm::inverse(trans.viewProj);
 
     const kage::Memory* memTransform = kage::alloc(sizeof(RadianceCascadesTransform));
     memcpy_s(memTransform->data, memTransform->size, &trans, sizeof(RadianceCascadesTransform));
@@ -188,16 +495,15 @@ void recRCBuild(const RadianceCascadeBuild& _rc, const Dbg_RadianceCascades& _db
 {
     kage::startRec(_rc.pass);
 
-    uint32_t cascadeCount = glm::min(kage::k_rclv0_cascadeLv, _dbg.cascadeCount);
-    uint32_t endLv = _dbg.startCascade + cascadeCount;
+    uint32_t endLv = getBuildEndLv(_dbg);
 
     float rayStartLen = 0.f;
     for (uint32_t ii = 0; ii < endLv; ++ii)
     {
         uint32_t    level_factor    = uint32_t(1 << ii);
-        uint32_t    prob_sideCount  = kage::k_rclv0_probeSideCount / level_factor;
+        uint32_t    prob_sideCount  = _rc.probeSideCount / level_factor;
         uint32_t    prob_count      = uint32_t(pow(prob_sideCount, 3));
-        uint32_t    ray_sideCount   = kage::k_rclv0_rayGridSideCount * level_factor;
+        uint32_t    ray_sideCount   = _rc.rayGridSideCount * level_factor;
         uint32_t    ray_count       = ray_sideCount * ray_sideCount; // each probe has a 2d grid of rays
         float prob_sideLen = _dbg.totalRadius * 2.f / float(prob_sideCount);
         float rayEndLen =  (ii == endLv - 1) ? 200.f : length(vec3(prob_sideLen)) * .5f;
@@ -206,7 +512,7 @@ void recRCBuild(const RadianceCascadeBuild& _rc, const Dbg_RadianceCascades& _db
         config.probe_sideCount = prob_sideCount;
         config.ray_gridSideCount = ray_sideCount;
         config.level = ii;
-        config.layerOffset = (kage::k_rclv0_probeSideCount - prob_sideCount) * 2;
+        config.layerOffset = (_rc.probeSideCount - prob_sideCount) * 2;
         config.rayStartLength = rayStartLen;
         config.rayEndLength = rayEndLen;
         config.probeSideLen = prob_sideLen;
@@ -228,6 +534,14 @@ void recRCBuild(const RadianceCascadeBuild& _rc, const Dbg_RadianceCascades& _db
         config.debug_idx_type = _dbg.idx_type;
         config.debug_color_type = _dbg.color_type;
 
+        config.rowStride = _rc.rowStride;
+        config.rowPhase = _rc.rowPhase;
+
+        uint32_t rayTileSideCount = (ray_sideCount + kRcSparseRayTile - 1) / kRcSparseRayTile;
+        config.sparse = _rc.sparse;
+        config.liveOffset = getRCOccupancyLevelOffset(ii);
+        config.rayTileSideCount = rayTileSideCount;
+
         const kage::Memory* mem = kage::alloc(sizeof(RadianceCascadesConfig));
         memcpy(mem->data, &config, mem->size);
 
@@ -235,16 +549,21 @@ void recRCBuild(const RadianceCascadeBuild& _rc, const Dbg_RadianceCascades& _db
 
         rayStartLen = rayEndLen;
 
+        // the depth is a placeholder of the world position for the compact g-buffer
+        const bool compact = (GBufferLayout::compact == _rc.g_buffer.layout);
+
         kage::Binding pushBinds[] =
         {
             {_rc.trans,                 BindingAccess::read,            Stage::compute_shader},
             {_rc.g_buffer.albedo,       _rc.g_bufferSamplers.albedo,    Stage::compute_shader},
             {_rc.g_buffer.normal,       _rc.g_bufferSamplers.normal,    Stage::compute_shader},
-            {_rc.g_buffer.worldPos,     _rc.g_bufferSamplers.worldPos,  Stage::compute_shader},
+            {compact ? _rc.inDepth : _rc.g_buffer.worldPos, compact ? _rc.depthSampler : _rc.g_bufferSamplers.worldPos, Stage::compute_shader},
             {_rc.g_buffer.emissive,     _rc.g_bufferSamplers.emissive,  Stage::compute_shader},
             {_rc.inDepth,               _rc.depthSampler,               Stage::compute_shader},
             {_rc.inSkybox,              _rc.skySampler,                 Stage::compute_shader},
             {_rc.cascadeImg,            0,                              Stage::compute_shader},
+            {_rc.liveProbes,            BindingAccess::read,            Stage::compute_shader},
+            {_rc.cascadeAlpha,          0,                              Stage::compute_shader},
         };
         kage::pushBindings(pushBinds, COUNTOF(pushBinds));
 
@@ -263,8 +582,18 @@ void recRCBuild(const RadianceCascadeBuild& _rc, const Dbg_RadianceCascades& _db
         kage::bindBindings(setBinds.data(), uint16_t(setBinds.size()), arrayCounts, COUNTOF(arrayCounts));
 
 
+        if (_rc.sparse)
+        {
+            // a workgroup per ray tile of each live probe, counted by the probe allocation
+            kage::dispatchIndirect(_rc.liveProbeCmd, uint32_t(ii * sizeof(IndirectDispatchCommand) + offsetof(IndirectDispatchCommand, x)));
+            continue;
+        }
+
+        // the scheduled rows of all the layers
         uint32_t groupCnt = prob_sideCount * ray_sideCount;
-        kage::dispatch(groupCnt, groupCnt, prob_sideCount);
+        uint32_t rowCnt = groupCnt * prob_sideCount;
+        uint32_t scheduledRows = (rowCnt - glm::min(_rc.rowPhase, rowCnt) + _rc.rowStride - 1) / _rc.rowStride;
+        kage::dispatch(groupCnt, scheduledRows, 1);
     }
 
     kage::endRec();
@@ -294,7 +623,11 @@ void prepareRCMerge(RadianceCascadeMerge& _rc, const RCMergeInit& _init, bool _r
     kage::ProgramHandle program = kage::registProgram(name, { cs }, sizeof(RCMergeData));
 
 
-    int pipelineSpecs[] = { _rayPrime };
+    int pipelineSpecs[] = { 
+        _rayPrime
+        , int(_init.inFormat)
+        , int(_init.outFormat)
+    };
     const kage::Memory* pConst = kage::alloc(sizeof(int) * COUNTOF(pipelineSpecs));
     memcpy_s(pConst->data, pConst->size, pipelineSpecs, sizeof(int) * COUNTOF(pipelineSpecs));
 
@@ -306,25 +639,11 @@ void prepareRCMerge(RadianceCascadeMerge& _rc, const RCMergeInit& _init, bool _r
 
     kage::PassHandle pass = kage::registPass(name, passDesc);
 
-    uint32_t lvFactor = uint32_t(1 << _init.currCas);
-    uint32_t probSideCnt = kage::k_rclv0_probeSideCount / lvFactor;
-    uint32_t resolution_xy = _rayPrime 
-                                ? kage::k_rclv0_probeSideCount * kage::k_rclv0_rayGridSideCount 
-                                : probSideCnt;
-    uint32_t resolution_z = _rayPrime ? probSideCnt * 2 : probSideCnt;
+    uint32_t resolution_xy, resolution_z;
+    getRCMergedSize(resolution_xy, resolution_z, _rayPrime, _init.probeSideCount, _init.rayGridSideCount, _init.currCas);
 
     const char* imgName = _rayPrime ? "merged_cascade_ray" : "merged_cascade_probe";
-    kage::ImageDesc mergedImgDesc{};
-    mergedImgDesc.width = resolution_xy;
-    mergedImgDesc.height = resolution_xy;
-    mergedImgDesc.numLayers = resolution_z;
-    mergedImgDesc.format = kage::ResourceFormat::r8g8b8a8_unorm;
-    mergedImgDesc.depth = 1;
-    mergedImgDesc.numMips = 1;
-    mergedImgDesc.type = kage::ImageType::type_2d;
-    mergedImgDesc.viewType = kage::ImageViewType::type_2d_array;
-    mergedImgDesc.usage = ImgUsage::transfer_dst | ImgUsage::storage | ImgUsage::sampled;
-    mergedImgDesc.layout = kage::ImageLayout::general;
+    kage::ImageDesc mergedImgDesc = getRCImageDesc(_init.outFormat, resolution_xy, resolution_z);
     kage::ImageHandle mergedCas = kage::registTexture(imgName, mergedImgDesc, nullptr, kage::ResourceLifetime::non_transition);
 
     kage::ImageHandle mergedCasAlias = kage::alias(mergedCas);
@@ -336,6 +655,25 @@ void prepareRCMerge(RadianceCascadeMerge& _rc, const RCMergeInit& _init, bool _r
         , kage::ImageLayout::general
         , mergedCasAlias
     );
+
+    // only the ray merge keeps the hit mask, the next merge reads it
+    const bool separateAlpha = _rayPrime && !rcStorageHasAlpha(_init.outFormat);
+
+    kage::ImageHandle mergedAlpha = mergedCas;
+    kage::ImageHandle mergedAlphaAlias = mergedCasAlias;
+    if (separateAlpha)
+    {
+        kage::ImageDesc alphaDesc = getRCAlphaImageDesc(resolution_xy, resolution_z);
+        mergedAlpha = kage::registTexture("merged_cascade_ray_alpha", alphaDesc, nullptr, kage::ResourceLifetime::non_transition);
+        mergedAlphaAlias = kage::alias(mergedAlpha);
+
+        kage::bindImage(pass, mergedAlpha
+            , Stage::compute_shader
+            , Access::shader_write | Access::shader_read
+            , kage::ImageLayout::general
+            , mergedAlphaAlias
+        );
+    }
     
     kage::SamplerHandle skySamp = kage::sampleImage(pass, _init.skybox
         , Stage::compute_shader
@@ -347,7 +685,7 @@ void prepareRCMerge(RadianceCascadeMerge& _rc, const RCMergeInit& _init, bool _r
 
     kage::SamplerHandle rcSamp = kage::sampleImage(pass, _init.radianceCascade
         , Stage::compute_shader
-        , kage::SamplerFilter::linear
+        , getRCSamplerFilter(_init.inFormat, kage::SamplerFilter::linear)
         , kage::SamplerMipmapMode::nearest
         , kage::SamplerAddressMode::mirrored_repeat
         , kage::SamplerReductionMode::min
@@ -355,7 +693,7 @@ void prepareRCMerge(RadianceCascadeMerge& _rc, const RCMergeInit& _init, bool _r
 
     kage::SamplerHandle linearSamp = kage::sampleImage(pass, mergedCas
         , Stage::compute_shader
-        , kage::SamplerFilter::linear
+        , getRCSamplerFilter(_init.outFormat, kage::SamplerFilter::linear)
         , kage::SamplerMipmapMode::nearest
         , kage::SamplerAddressMode::mirrored_repeat
         , kage::SamplerReductionMode::min
@@ -363,12 +701,37 @@ void prepareRCMerge(RadianceCascadeMerge& _rc, const RCMergeInit& _init, bool _r
 
     kage::SamplerHandle nearedSamp = kage::sampleImage(pass, mergedCas
         , Stage::compute_shader
-        , kage::SamplerFilter::linear
+        , getRCSamplerFilter(_init.outFormat, kage::SamplerFilter::linear)
         , kage::SamplerMipmapMode::nearest
         , kage::SamplerAddressMode::mirrored_repeat
         , kage::SamplerReductionMode::min
     );
 
+    // the formats with alpha use the color images as the placeholders
+    kage::SamplerHandle rcAlphaSamp = rcSamp;
+    if (_init.rcAlpha != _init.radianceCascade)
+    {
+        rcAlphaSamp = kage::sampleImage(pass, _init.rcAlpha
+            , Stage::compute_shader
+            , kage::SamplerFilter::linear
+            , kage::SamplerMipmapMode::nearest
+            , kage::SamplerAddressMode::mirrored_repeat
+            , kage::SamplerReductionMode::min
+        );
+    }
+
+    kage::SamplerHandle mergedAlphaSamp = linearSamp;
+    if (separateAlpha)
+    {
+        mergedAlphaSamp = kage::sampleImage(pass, mergedAlpha
+            , Stage::compute_shader
+            , kage::SamplerFilter::linear
+            , kage::SamplerMipmapMode::nearest
+            , kage::SamplerAddressMode::mirrored_repeat
+            , kage::SamplerReductionMode::min
+        );
+    }
+
     _rc.pass = pass;
     _rc.program = program;
     _rc.cs = cs;
@@ -384,27 +747,42 @@ void prepareRCMerge(RadianceCascadeMerge& _rc, const RCMergeInit& _init, bool _r
     _rc.mergedCascade = mergedCas;
     _rc.mergedCascadesAlias = mergedCasAlias;
 
+    _rc.rcAlpha = _init.rcAlpha;
+    _rc.rcAlphaSampler = rcAlphaSamp;
+
+    _rc.mergedAlpha = mergedAlpha;
+    _rc.mergedAlphaSampler = mergedAlphaSamp;
+    _rc.mergedAlphaAlias = mergedAlphaAlias;
+
+    _rc.inFormat = _init.inFormat;
+    _rc.outFormat = _init.outFormat;
+
     _rc.currLv = _init.currCas;
     _rc.rayPrime = _rayPrime;
+
+    _rc.probeSideCount = _init.probeSideCount;
+    _rc.rayGridSideCount = _init.rayGridSideCount;
 }
 
 void updateRCMerge(RadianceCascadeMerge& _rc, const Dbg_RadianceCascades& _dbg)
 {
-    // should update the merged ascade(probe) resolution if currLv changed
-    uint32_t currCas = _dbg.startCascade;
-    if (!_rc.rayPrime && currCas == _rc.currLv)
+    // should update the merged ascade(probe) resolution if currLv or the level 0 sizes changed
+    uint32_t currCas = glm::min(_dbg.startCascade, getRCLevelCount(_dbg) - 1);
+    uint32_t probeSideCount = getRCProbeSideCount(_dbg);
+    uint32_t rayGridSideCount = getRCRayGridSideCount(_dbg);
+    if (currCas == _rc.currLv && probeSideCount == _rc.probeSideCount && rayGridSideCount == _rc.rayGridSideCount)
         return;
 
-    uint32_t lvFactor = uint32_t(1 << currCas);
-    uint32_t probSideCnt = kage::k_rclv0_probeSideCount / lvFactor;
-    uint32_t resolution_xy = _rc.rayPrime 
-                                ? (kage::k_rclv0_probeSideCount * kage::k_rclv0_rayGridSideCount) 
-                                : probSideCnt;
-    uint32_t resolution_z = _rc.rayPrime ? (probSideCnt * 2) : probSideCnt;
+    uint32_t resolution_xy, resolution_z;
+    getRCMergedSize(resolution_xy, resolution_z, _rc.rayPrime, probeSideCount, rayGridSideCount, currCas);
 
     kage::updateImage(_rc.mergedCascade, resolution_xy, resolution_xy, resolution_z);
+    if (_rc.mergedAlpha != _rc.mergedCascade)
+        kage::updateImage(_rc.mergedAlpha, resolution_xy, resolution_xy, resolution_z);
 
     _rc.currLv = currCas;
+    _rc.probeSideCount = probeSideCount;
+    _rc.rayGridSideCount = rayGridSideCount;
 }
 
 void recRCMerge(const RadianceCascadeMerge& _rc, const Dbg_RadianceCascades& _dbg)
@@ -413,13 +791,13 @@ void recRCMerge(const RadianceCascadeMerge& _rc, const Dbg_RadianceCascades& _db
 
     uint32_t startLv = _rc.currLv;
     uint32_t cascadeCount = glm::min(kage::k_rclv0_cascadeLv, _dbg.cascadeCount);
-    uint32_t endLv = _rc.rayPrime ? (startLv + cascadeCount) : _rc.currLv + 1;
+    uint32_t endLv = _rc.rayPrime ? glm::min(startLv + cascadeCount, getRCLevelCount(_dbg)) : _rc.currLv + 1;
 
     uint32_t offsets[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
     uint32_t offset = 0u;
     for (int ii = 0; ii < 8; ++ii) {
         offsets[ii] = offset;
-        offset += kage::k_rclv0_probeSideCount >> ii;
+        offset += _rc.probeSideCount >> ii;
     }
 
     // for ray prime: https://mini.gmshaders.com/p/radiance-cascades
@@ -429,8 +807,8 @@ void recRCMerge(const RadianceCascadeMerge& _rc, const Dbg_RadianceCascades& _db
     {
         uint32_t lv = ii - 1;
         uint32_t lvFactor = uint32_t(1 << lv);
-        uint32_t probSideCnt = kage::k_rclv0_probeSideCount / lvFactor;
-        uint32_t raySideCnt = kage::k_rclv0_rayGridSideCount * lvFactor;
+        uint32_t probSideCnt = _rc.probeSideCount / lvFactor;
+        uint32_t raySideCnt = _rc.rayGridSideCount * lvFactor;
         uint32_t resolution_xy = _rc.rayPrime ? probSideCnt * raySideCnt : probSideCnt;
 
         RCMergeData data;
@@ -441,8 +819,8 @@ void recRCMerge(const RadianceCascadeMerge& _rc, const Dbg_RadianceCascades& _db
         data.endLv = endLv;
         data.idxType = _dbg.idx_type;
         data.offset = offsets[lv];
-        data.c0_probeSideCount = kage::k_rclv0_probeSideCount;
-        data.c0_raySideCount = kage::k_rclv0_rayGridSideCount;
+        data.c0_probeSideCount = _rc.probeSideCount;
+        data.c0_raySideCount = _rc.rayGridSideCount;
 
         const kage::Memory* mem = kage::alloc(sizeof(RCMergeData));
         memcpy(mem->data, &data, mem->size);
@@ -451,6 +829,7 @@ void recRCMerge(const RadianceCascadeMerge& _rc, const Dbg_RadianceCascades& _db
         
         // should sample the original cascades for the [endLv - 1]. The merged cascade
         // Also, using sampler istead of bind image directly is to take advantage of the hardware bilinear sampling
+        // the ray merge has the same input and output format, so the original cascades fit the merged slot
         bool useOriginalCas = _rc.rayPrime && (lv == endLv - 1);
         kage::ImageHandle accessImg = useOriginalCas ? _rc.radianceCascade : _rc.mergedCascade;
         kage::SamplerHandle accessSamp = 
@@ -460,11 +839,17 @@ void recRCMerge(const RadianceCascadeMerge& _rc, const Dbg_RadianceCascades& _db
                 : _rc.linearSamp 
             : _rc.nearedSamp;
 
+        kage::ImageHandle accessAlpha = useOriginalCas ? _rc.rcAlpha : _rc.mergedAlpha;
+        kage::SamplerHandle accessAlphaSamp = useOriginalCas ? _rc.rcAlphaSampler : _rc.mergedAlphaSampler;
+
         kage::Binding binds[] = {
-            {_rc.skybox,            _rc.skySampler,     Stage::compute_shader},
-            {_rc.radianceCascade,   _rc.rcSampler,      Stage::compute_shader},
-            {accessImg,             accessSamp,         Stage::compute_shader}, 
-            {_rc.mergedCascade,     0,                  Stage::compute_shader}, // current lv
+            {_rc.skybox,            _rc.skySampler,         Stage::compute_shader},
+            {_rc.radianceCascade,   _rc.rcSampler,          Stage::compute_shader},
+            {accessImg,             accessSamp,             Stage::compute_shader}, 
+            {_rc.mergedCascade,     0,                      Stage::compute_shader}, // current lv
+            {_rc.rcAlpha,           _rc.rcAlphaSampler,     Stage::compute_shader},
+            {accessAlpha,           accessAlphaSamp,        Stage::compute_shader},
+            {_rc.mergedAlpha,       0,                      Stage::compute_shader},
         };
 
         kage::pushBindings(binds, COUNTOF(binds));
@@ -479,26 +864,52 @@ void recRCMerge(const RadianceCascadeMerge& _rc, const Dbg_RadianceCascades& _db
 
 void prepareRadianceCascade(RadianceCascade& _rc, const RadianceCascadeInitData _init)
 {
+    RCOccupancyInit occInit{};
+    occInit.meshBuf = _init.meshBuf;
+    occInit.meshDrawBuf = _init.meshDrawBuf;
+    occInit.meshletBuf = _init.meshletBuf;
+    occInit.meshletDataBuf = _init.meshletDataBuf;
+    occInit.vtxBuf = _init.vtxBuf;
+    occInit.drawCount = _init.maxDrawCmdCount;
+    occInit.taskCapacity = _init.voxTaskCapacity;
+    occInit.seamless = _init.seamless;
+    prepareRCOccupancy(_rc.occupancy, occInit);
+
     RCBuildInit rcInit{};
     rcInit.g_buffer = _init.g_buffer;
     rcInit.depth = _init.depth;
     rcInit.skybox = _init.skybox;
     memcpy(&rcInit.brx, &_init.brx, sizeof(BRX_UserResources));
+    rcInit.liveProbeCmd = _rc.occupancy.probeAlloc.dispatchCmdBufOutAlias;
+    rcInit.liveProbes = _rc.occupancy.probeAlloc.liveProbesOutAlias;
+    rcInit.format = _init.format;
+    rcInit.probeSideCount = _init.probeSideCount;
+    rcInit.rayGridSideCount = _init.rayGridSideCount;
     prepareRCbuild(_rc.build, rcInit);
 
     {
         RCMergeInit mergeInit{};
         mergeInit.radianceCascade = _rc.build.radCascdOutAlias;
+        mergeInit.rcAlpha = _rc.build.cascadeAlphaOutAlias;
         mergeInit.skybox = _init.skybox;
+        mergeInit.inFormat = _init.format;
+        mergeInit.outFormat = _init.format;
         mergeInit.currCas = _init.currCas;
+        mergeInit.probeSideCount = _init.probeSideCount;
+        mergeInit.rayGridSideCount = _init.rayGridSideCount;
         prepareRCMerge(_rc.mergeRay, mergeInit, true);
     }
 
     {
         RCMergeInit mergeInit{};
         mergeInit.radianceCascade = _rc.mergeRay.mergedCascadesAlias;
+        mergeInit.rcAlpha = _rc.mergeRay.mergedAlphaAlias;
         mergeInit.skybox = _init.skybox;
+        mergeInit.inFormat = _init.format;
+        mergeInit.outFormat = getRCMergedProbeFormat(_init.format);
         mergeInit.currCas = _init.currCas;
+        mergeInit.probeSideCount = _init.probeSideCount;
+        mergeInit.rayGridSideCount = _init.rayGridSideCount;
         prepareRCMerge(_rc.mergeProbe, mergeInit, false);
     }
 }
@@ -509,9 +920,12 @@ void updateRadianceCascade(
     , const TransformData& _trans
 )
 {
-    updateRCBuild(_rc.build, _dbgRcBuild, _trans);
+    updateRCBuild(_rc.build, _rc.occupancy, _dbgRcBuild, _trans);
     recRCBuild(_rc.build, _dbgRcBuild);
 
+    updateRCMerge(_rc.mergeRay, _dbgRcBuild);
+    updateRCMerge(_rc.mergeProbe, _dbgRcBuild);
+
     recRCMerge(_rc.mergeRay, _dbgRcBuild);
     recRCMerge(_rc.mergeProbe, _dbgRcBuild);
 }
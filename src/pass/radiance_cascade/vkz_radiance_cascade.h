@@ -6,6 +6,7 @@
 #include "deferred/vkz_deferred.h"
 #include "demo_structs.h"
 #include "vkz_rc_common.h"
+#include "vkz_rc_occupancy.h"
 #include "ffx_intg/brixel_intg_kage.h"
 
 // each page has a 3d grid of probes, each probe has a 2d grid of rays
@@ -33,12 +34,21 @@ struct alignas(16) RadianceCascadesConfig
 
     uint32_t debug_idx_type;
     uint32_t debug_color_type;
+
+    uint32_t rowStride;
+    uint32_t rowPhase;
+
+    uint32_t sparse;
+    uint32_t liveOffset;
+    uint32_t rayTileSideCount;
 };
 
 struct alignas(16) RadianceCascadesTransform
 {
     mat4 view;
     mat4 proj;
+    mat4 viewProj;
+    mat4 invViewProj; // only used by the compact g-buffer
     vec3 cameraPos;
 };
 
@@ -63,12 +73,46 @@ struct RadianceCascadeBuild
     kage::ImageHandle cascadeImg;
     kage::ImageHandle radCascdOutAlias;
 
+    // the hit mask of the formats without alpha, the cascade image itself otherwise
+    kage::ImageHandle cascadeAlpha;
+    kage::ImageHandle cascadeAlphaOutAlias;
+
+    RCStorageFormat format{ RCStorageFormat::rgba8 };
+
+    // the level 0 sizes the images are allocated for
+    uint32_t probeSideCount{ 0 };
+    uint32_t rayGridSideCount{ 0 };
+
     BRX_UserResources brx;
     kage::SamplerHandle brxAtlasSamp;
 
+    // sparse probes, the per-level dispatch commands and the live probe list
+    kage::BufferHandle liveProbeCmd;
+    kage::BufferHandle liveProbes;
+
     vec3 cameraPos{vec3(0.f)};
     mat4 view{ mat4(1.f) };
     mat4 proj{ mat4(1.f) };
+
+    // temporal amortization
+    // a texel row of the cascade atlas is a unit of the schedule, it has the same ray count in all levels
+    // each frame traces every rowStride-th row, the phase rotates so a level converges in rowStride frames
+    uint32_t rowStride{ 1 };
+    uint32_t rowPhase{ 0 };
+    uint32_t frameIdx{ 0 };
+
+    // only the live probes are traced, except the frame the occupancy is rebuilt
+    bool sparse{ false };
+
+    // the history is dropped when the volume or the build settings changed
+    bool historyValid{ false };
+    vec3 historyCenter{ vec3(0.f) };
+    Dbg_RadianceCascades historyDbg{};
+
+    // stats
+    uint32_t raysPerFrame{ 0 };
+    uint32_t convergeFrames{ 1 };
+    uint32_t invalidations{ 0 };
 };
 
 struct RadianceCascadeMerge
@@ -90,12 +134,28 @@ struct RadianceCascadeMerge
     kage::ImageHandle mergedCascade;
     kage::ImageHandle mergedCascadesAlias;
 
+    // the hit masks of the formats without alpha, the color images otherwise
+    kage::ImageHandle rcAlpha;
+    kage::SamplerHandle rcAlphaSampler;
+
+    kage::ImageHandle mergedAlpha;
+    kage::SamplerHandle mergedAlphaSampler;
+    kage::ImageHandle mergedAlphaAlias;
+
+    RCStorageFormat inFormat{ RCStorageFormat::rgba8 };
+    RCStorageFormat outFormat{ RCStorageFormat::rgba8 };
+
     uint32_t currLv;
     bool    rayPrime;
+
+    // the level 0 sizes the images are allocated for
+    uint32_t probeSideCount{ 0 };
+    uint32_t rayGridSideCount{ 0 };
 };
 
 struct RadianceCascade
 {
+    RCOccupancy occupancy;
     RadianceCascadeBuild build;
     RadianceCascadeMerge mergeRay;
     RadianceCascadeMerge mergeProbe;
@@ -108,7 +168,8 @@ struct RadianceCascadeInitData
     kage::ImageHandle skybox;
     kage::BufferHandle meshBuf;
     kage::BufferHandle meshDrawBuf;
-    kage::BufferHandle idxBuf;
+    kage::BufferHandle meshletBuf;
+    kage::BufferHandle meshletDataBuf;
     kage::BufferHandle vtxBuf;
     kage::BindlessHandle bindless;
 
@@ -117,9 +178,53 @@ struct RadianceCascadeInitData
 
     uint32_t maxDrawCmdCount;
     uint32_t currCas;
+
+    // the voxelization walks the meshlets of the first lod, or the leaf clusters of the seamless lod
+    uint32_t voxTaskCapacity;
+    bool seamless{ false };
+
+    // images can't change the format at runtime, so it's picked at init
+    RCStorageFormat format{ RCStorageFormat::rgba8 };
+    uint32_t probeSideCount{ kage::k_rclv0_probeSideCount };
+    uint32_t rayGridSideCount{ kage::k_rclv0_rayGridSideCount };
+};
+
+// the vram of the cascades of a configuration, in bytes
+struct RCMemoryReport
+{
+    uint64_t cascade;       // the atlas of all the levels
+    uint64_t mergedRay;
+    uint64_t mergedProbe;
+    uint64_t occupancy;
+
+    uint64_t total;
 };
 
 
 void prepareRadianceCascade(RadianceCascade& _rc, const RadianceCascadeInitData _init);
+// the center of the probe volume, snapped to the level 0 probe grid when the update is amortized
+// so the probes stay at the same world position while the camera moves inside a cell
+vec3 getRadianceCascadeCenter(const Dbg_RadianceCascades& _dbg, const vec3& _cameraPos);
+
+const char* getRCStorageFormatName(RCStorageFormat _format);
+
+// returns RCStorageFormat::count for an unknown name
+RCStorageFormat parseRCStorageFormat(const char* _name);
+
+// bytes per texel including the hit mask image
+uint32_t getRCStorageTexelSize(RCStorageFormat _format);
+
+// falls back to rgba16f if the images of the format can't be written by the shaders on this device
+RCStorageFormat getSupportedRCStorageFormat(RCStorageFormat _format);
+
+// the merged probes are sampled by the deferred shading, the packed format is stored as rgba16f
+RCStorageFormat getRCMergedProbeFormat(RCStorageFormat _format);
+
+// the dense images of a configuration, the sparse probes still write into them. the occupancy is not counted
+RCMemoryReport calcRadianceCascadeMemory(RCStorageFormat _format, uint32_t _probeSideCount, uint32_t _rayGridSideCount, uint32_t _currCas);
+
+// the images currently allocated, with the occupancy
+RCMemoryReport getRadianceCascadeMemory(const RadianceCascade& _rc);
+
 void updateRadianceCascade(RadianceCascade& _rc, const Dbg_RadianceCascades& _dbgRcBuild, const TransformData& _trans);
 
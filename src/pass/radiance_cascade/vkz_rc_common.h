@@ -33,4 +33,43 @@ enum class Rc2dStage : uint32_t
     merge_ray,
     merge_probe,
     count
-};
\ No newline at end of file
+};
+
+// storage of the cascade and merged images, keep sync with rc_storage.h
+// the formats without alpha keep the hit mask in an extra r8 image
+enum class RCStorageFormat : uint32_t
+{
+    rgba8 = 0,
+    r11g11b10,
+    rgb9e5, // packed into r32ui, it's not a storage format on most devices
+    rgba16f,
+    count
+};
+
+inline bool rcStorageHasAlpha(RCStorageFormat _format)
+{
+    return _format == RCStorageFormat::rgba8 || _format == RCStorageFormat::rgba16f;
+}
+
+// the level 0 sizes are set at runtime, bounded by k_rclv0_* which the buffers are sized for
+// the other levels follow them: half the probes and twice the rays per level
+// previousPow2(v + 1) is the largest power of 2 not greater than v
+inline uint32_t getRCProbeSideCount(const Dbg_RadianceCascades& _dbg)
+{
+    return glm::clamp(previousPow2(_dbg.probeSideCount + 1), 1u, kage::k_rclv0_probeSideCount);
+}
+
+inline uint32_t getRCRayGridSideCount(const Dbg_RadianceCascades& _dbg)
+{
+    return glm::clamp(previousPow2(_dbg.rayGridSideCount + 1), 1u, kage::k_rclv0_rayGridSideCount);
+}
+
+// the level count that still has a probe
+inline uint32_t getRCLevelCount(const Dbg_RadianceCascades& _dbg)
+{
+    uint32_t lvCount = 0;
+    while ((getRCProbeSideCount(_dbg) >> lvCount) != 0)
+        ++lvCount;
+
+    return glm::min(kage::k_rclv0_cascadeLv, lvCount);
+}
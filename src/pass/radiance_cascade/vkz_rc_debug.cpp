@@ -55,6 +55,7 @@ struct ProbeDebugDrawInit
     kage::ImageHandle color;
     kage::ImageHandle depth;
     kage::ImageHandle cascade;
+    RCStorageFormat format;
 
     kage::BufferHandle trans;
     kage::BufferHandle cmd;
@@ -138,7 +139,7 @@ void prepareProbeDbgCmdGen(ProbeDbgCmdGen& _gen, const ProbeDebugGenInit& _init)
 
 void recProbeDbgCmdGen(const ProbeDbgCmdGen& _gen, const Constants& _consts, const Dbg_RadianceCascades _rcDbg)
 {
-    uint32_t probeSideCount = kage::k_rclv0_probeSideCount / (1 << glm::min(_rcDbg.startCascade, kage::k_rclv0_cascadeLv));
+    uint32_t probeSideCount = getRCProbeSideCount(_rcDbg) / (1 << glm::min(_rcDbg.startCascade, getRCLevelCount(_rcDbg) - 1));
     const float probeSideLen = _rcDbg.totalRadius * 2.f / (float)probeSideCount;
     const float sphereRadius = probeSideLen * 0.2f * _rcDbg.probeDebugScale;
 
@@ -148,7 +149,7 @@ void recProbeDbgCmdGen(const ProbeDbgCmdGen& _gen, const Constants& _consts, con
     consts.probeSideLen = probeSideLen;
     consts.sphereRadius = sphereRadius;
     consts.probeSideCount = probeSideCount;
-    consts.layerOffset = (kage::k_rclv0_probeSideCount - probeSideCount) * 2;
+    consts.layerOffset = (getRCProbeSideCount(_rcDbg) - probeSideCount) * 2;
     consts.idxCnt = _gen.idxCnt;
 
     consts.P00 = _consts.P00;
@@ -194,8 +195,18 @@ void prepareProbeDbgDraw(ProbeDbgDraw& _pd, const ProbeDebugDrawInit& _init)
     kage::ShaderHandle vs = kage::registShader("rc_probe_debug", "shader/rc_probe_debug.vert.spv");
     kage::ShaderHandle fs = kage::registShader("rc_probe_debug", "shader/rc_probe_debug.frag.spv");
     kage::ProgramHandle prog = kage::registProgram("rc_probe_debug", { vs, fs }, sizeof(ProbeDebugDrawConsts));
+
+    int pipelineSpecs[] = {
+        int(_init.format)
+    };
+
+    const kage::Memory* pConst = kage::alloc(sizeof(int) * COUNTOF(pipelineSpecs));
+    memcpy_s(pConst->data, pConst->size, pipelineSpecs, sizeof(int) * COUNTOF(pipelineSpecs));
+
     kage::PassDesc passDesc;
     passDesc.prog = prog;
+    passDesc.pipelineSpecNum = COUNTOF(pipelineSpecs);
+    passDesc.pipelineSpecData = (void*)pConst->data;
     passDesc.queue = kage::PassExeQueue::graphics;
     passDesc.pipelineConfig = { true, true, kage::CompareOp::greater, kage::CullModeFlagBits::back, kage::PolygonMode::fill };
     kage::PassHandle pass = kage::registPass("rc_probe_debug", passDesc);
@@ -228,7 +239,7 @@ void prepareProbeDbgDraw(ProbeDbgDraw& _pd, const ProbeDebugDrawInit& _init)
     kage::SamplerHandle samp = kage::sampleImage(
         pass, _init.cascade
         , Stage::fragment_shader
-        , kage::SamplerFilter::linear
+        , (RCStorageFormat::rgb9e5 == _init.format) ? kage::SamplerFilter::nearest : kage::SamplerFilter::linear
         , kage::SamplerMipmapMode::linear
         , kage::SamplerAddressMode::mirrored_repeat
         , kage::SamplerReductionMode::weighted_average
@@ -273,9 +284,9 @@ void recProbeDbgDraw(const ProbeDbgDraw& _pd, const Constants& _consts, const ui
     kage::setViewport(0, 0, _width, _height);
     kage::setScissor(0, 0, _width, _height);
 
-    uint32_t shift = (1 << glm::min(_rcDbg.startCascade, kage::k_rclv0_cascadeLv));
-    uint32_t probeSideCount = kage::k_rclv0_probeSideCount / shift;
-    uint32_t raySideCount = kage::k_rclv0_rayGridSideCount * shift;
+    uint32_t shift = (1 << glm::min(_rcDbg.startCascade, getRCLevelCount(_rcDbg) - 1));
+    uint32_t probeSideCount = getRCProbeSideCount(_rcDbg) / shift;
+    uint32_t raySideCount = getRCRayGridSideCount(_rcDbg) * shift;
     float sphereRadius = (_rcDbg.totalRadius / probeSideCount) * _rcDbg.probeDebugScale;
 
     ProbeDebugDrawConsts consts{};
@@ -343,6 +354,7 @@ void prepareProbeDebug(ProbeDebug& _pd, const RCDebugInit& _init)
     drawInit.color = _init.color;
     drawInit.depth = _init.depth;
     drawInit.cascade = _init.cascade;
+    drawInit.format = _init.format;
     drawInit.trans = _init.trans;
     drawInit.cmd = _pd.cmdGen.outCmdAlias;
     drawInit.drawData = _pd.cmdGen.outDrawDataBufAlias;
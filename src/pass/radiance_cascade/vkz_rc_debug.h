@@ -4,6 +4,7 @@
 #include "core/kage.h"
 #include "core/kage_structs.h"
 #include "demo_structs.h"
+#include "vkz_rc_common.h"
 
 struct RCDebugInit
 {
@@ -13,6 +14,8 @@ struct RCDebugInit
     kage::ImageHandle depth;
     kage::ImageHandle cascade;
     kage::ImageHandle pyramid;
+
+    RCStorageFormat format{ RCStorageFormat::rgba8 };
 };
 
 struct ProbeDbgCmdGen
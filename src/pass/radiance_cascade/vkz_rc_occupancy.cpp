@@ -0,0 +1,633 @@
+#include "radiance_cascade/vkz_rc_occupancy.h"
+
+#include "vkz_pass.h"
+#include "core/config.h"
+#include "scene/scene.h"
+
+// the node count of all the oct-tree levels, the level n has (kRcVoxSideCount >> (n + 1))^3 nodes
+static uint32_t getOctTreeNodeCount()
+{
+    return getRCOccupancyLevelOffset(kRcOctTreeLevels);
+}
+
+uint32_t getRCOccupancyLevelOffset(uint32_t _lv)
+{
+    uint32_t offset = 0;
+    for (uint32_t ii = 0; ii < _lv; ++ii)
+    {
+        uint32_t side = kRcVoxSideCount >> (ii + 1);
+        offset += side * side * side;
+    }
+
+    return offset;
+}
+
+uint32_t getRCVoxTaskCount(const Scene& _scene, bool _seamless)
+{
+    uint32_t count = 0;
+    for (const MeshDraw& draw : _scene.meshDraws)
+    {
+        const Mesh& mesh = _scene.geometry.meshes[draw.meshIdx];
+        const MeshLod& lod = _seamless ? mesh.seamlessLod : mesh.lods[0];
+
+        count += (lod.meshletCount + kRcVoxTaskMeshlets - 1) / kRcVoxTaskMeshlets;
+    }
+
+    return count;
+}
+
+void prepareRCVoxTasks(RCVoxTasks& _vt, const RCOccupancyInit& _init)
+{
+    kage::ShaderHandle cs = kage::registShader("rc_vox_tasks", "shader/rc_vox_tasks.comp.spv");
+    kage::ProgramHandle prog = kage::registProgram("rc_vox_tasks", { cs }, sizeof(VoxelizationConsts));
+
+    int pipelineSpecs[] = { _init.seamless }; // SEAMLESS_LOD
+
+    const kage::Memory* pConst = kage::alloc(sizeof(int) * COUNTOF(pipelineSpecs));
+    memcpy_s(pConst->data, pConst->size, pipelineSpecs, sizeof(int) * COUNTOF(pipelineSpecs));
+
+    kage::PassDesc passDesc;
+    passDesc.prog = prog;
+    passDesc.queue = kage::PassExeQueue::compute;
+    passDesc.pipelineSpecNum = COUNTOF(pipelineSpecs);
+    passDesc.pipelineSpecData = (void*)pConst->data;
+    kage::PassHandle pass = kage::registPass("rc_vox_tasks", passDesc);
+
+    // the voxels and the draw states are updated incrementally across frames
+    kage::BufferDesc voxDrawDesc{};
+    voxDrawDesc.size = glm::max(_init.drawCount, 1u) * sizeof(VoxDrawState);
+    voxDrawDesc.usage = BufUsage::storage | BufUsage::transfer_dst;
+    kage::BufferHandle voxDraws = kage::registBuffer("rc_vox_draws", voxDrawDesc, nullptr, kage::ResourceLifetime::non_transition);
+
+    kage::BufferDesc voxMapDesc{};
+    voxMapDesc.size = kRcVoxSideCount * kRcVoxSideCount * kRcVoxSideCount * sizeof(uint32_t);
+    voxMapDesc.usage = BufUsage::storage | BufUsage::transfer_dst;
+    kage::BufferHandle voxMap = kage::registBuffer("rc_vox_map", voxMapDesc, nullptr, kage::ResourceLifetime::non_transition);
+    kage::BufferHandle voxCount = kage::registBuffer("rc_vox_count", voxMapDesc, nullptr, kage::ResourceLifetime::non_transition);
+
+    // 0: remove, 1: add
+    kage::BufferDesc cmdDesc{};
+    cmdDesc.size = 2 * sizeof(IndirectDispatchCommand);
+    cmdDesc.usage = BufUsage::indirect | BufUsage::storage | BufUsage::transfer_dst;
+    kage::BufferHandle cmdBuf = kage::registBuffer("rc_vox_task_cmd", cmdDesc);
+
+    kage::BufferDesc taskDesc{};
+    taskDesc.size = 2 * glm::max(_init.taskCapacity, 1u) * sizeof(VoxTask);
+    taskDesc.usage = BufUsage::storage | BufUsage::transfer_dst;
+    kage::BufferHandle taskBuf = kage::registBuffer("rc_vox_tasks", taskDesc);
+
+    kage::BufferHandle voxDrawsAlias = kage::alias(voxDraws);
+    kage::BufferHandle cmdBufAlias = kage::alias(cmdBuf);
+    kage::BufferHandle taskBufAlias = kage::alias(taskBuf);
+    kage::BufferHandle voxCountAlias = kage::alias(voxCount);
+    kage::BufferHandle voxMapAlias = kage::alias(voxMap);
+
+    kage::bindBuffer(pass, _init.meshBuf
+        , Stage::compute_shader
+        , Access::shader_read
+    );
+
+    kage::bindBuffer(pass, _init.meshDrawBuf
+        , Stage::compute_shader
+        , Access::shader_read
+    );
+
+    kage::bindBuffer(pass, voxDraws
+        , Stage::compute_shader
+        , Access::shader_read | Access::shader_write
+        , voxDrawsAlias
+    );
+
+    kage::bindBuffer(pass, cmdBuf
+        , Stage::compute_shader
+        , Access::shader_read | Access::shader_write
+        , cmdBufAlias
+    );
+
+    kage::bindBuffer(pass, taskBuf
+        , Stage::compute_shader
+        , Access::shader_write
+        , taskBufAlias
+    );
+
+    // cleared here on a rebuild
+    kage::bindBuffer(pass, voxCount
+        , Stage::compute_shader
+        , Access::shader_write
+        , voxCountAlias
+    );
+
+    kage::bindBuffer(pass, voxMap
+        , Stage::compute_shader
+        , Access::shader_write
+        , voxMapAlias
+    );
+
+    _vt.pass = pass;
+    _vt.program = prog;
+    _vt.cs = cs;
+
+    _vt.meshBuf = _init.meshBuf;
+    _vt.meshDrawBuf = _init.meshDrawBuf;
+    _vt.voxDraws = voxDraws;
+    _vt.taskCmdBuf = cmdBuf;
+    _vt.taskBuf = taskBuf;
+    _vt.voxCount = voxCount;
+    _vt.voxMap = voxMap;
+
+    _vt.voxDrawsOutAlias = voxDrawsAlias;
+    _vt.taskCmdBufOutAlias = cmdBufAlias;
+    _vt.taskBufOutAlias = taskBufAlias;
+    _vt.voxCountOutAlias = voxCountAlias;
+    _vt.voxMapOutAlias = voxMapAlias;
+}
+
+void prepareRCVoxelize(RCVoxelize& _vox, const RCOccupancyInit& _init, const RCVoxTasks& _vt)
+{
+    kage::ShaderHandle cs = kage::registShader("rc_voxelize", "shader/rc_voxelize.comp.spv");
+    kage::ProgramHandle prog = kage::registProgram("rc_voxelize", { cs }, sizeof(VoxelizationConsts));
+
+    int pipelineSpecs[] = { _init.seamless }; // SEAMLESS_LOD
+
+    const kage::Memory* pConst = kage::alloc(sizeof(int) * COUNTOF(pipelineSpecs));
+    memcpy_s(pConst->data, pConst->size, pipelineSpecs, sizeof(int) * COUNTOF(pipelineSpecs));
+
+    kage::PassDesc passDesc;
+    passDesc.prog = prog;
+    passDesc.queue = kage::PassExeQueue::compute;
+    passDesc.pipelineSpecNum = COUNTOF(pipelineSpecs);
+    passDesc.pipelineSpecData = (void*)pConst->data;
+    kage::PassHandle pass = kage::registPass("rc_voxelize", passDesc);
+
+    kage::BufferHandle voxCountAlias = kage::alias(_vt.voxCountOutAlias);
+    kage::BufferHandle voxMapAlias = kage::alias(_vt.voxMapOutAlias);
+
+    kage::bindBuffer(pass, _init.vtxBuf
+        , Stage::compute_shader
+        , Access::shader_read
+    );
+
+    kage::bindBuffer(pass, _init.meshletBuf
+        , Stage::compute_shader
+        , Access::shader_read
+    );
+
+    kage::bindBuffer(pass, _init.meshletDataBuf
+        , Stage::compute_shader
+        , Access::shader_read
+    );
+
+    kage::setIndirectBuffer(pass, _vt.taskCmdBufOutAlias);
+
+    kage::bindBuffer(pass, _vt.taskBufOutAlias
+        , Stage::compute_shader
+        , Access::shader_read
+    );
+
+    kage::bindBuffer(pass, _vt.voxCountOutAlias
+        , Stage::compute_shader
+        , Access::shader_read | Access::shader_write
+        , voxCountAlias
+    );
+
+    kage::bindBuffer(pass, _vt.voxMapOutAlias
+        , Stage::compute_shader
+        , Access::shader_read | Access::shader_write
+        , voxMapAlias
+    );
+
+    _vox.pass = pass;
+    _vox.program = prog;
+    _vox.cs = cs;
+
+    _vox.vtxBuf = _init.vtxBuf;
+    _vox.meshletBuf = _init.meshletBuf;
+    _vox.meshletDataBuf = _init.meshletDataBuf;
+    _vox.taskCmdBuf = _vt.taskCmdBufOutAlias;
+    _vox.taskBuf = _vt.taskBufOutAlias;
+
+    _vox.voxCount = _vt.voxCountOutAlias;
+    _vox.voxMap = _vt.voxMapOutAlias;
+
+    _vox.voxCountOutAlias = voxCountAlias;
+    _vox.voxMapOutAlias = voxMapAlias;
+
+    _vox.taskCapacity = glm::max(_init.taskCapacity, 1u);
+}
+
+void prepareRCOctTree(RCOctTree& _ot, const RCVoxelize& _vox)
+{
+    kage::ShaderHandle cs = kage::registShader("rc_oct_tree", "shader/rc_oct_tree.comp.spv");
+    kage::ProgramHandle prog = kage::registProgram("rc_oct_tree", { cs }, sizeof(OctTreeProcessConfig));
+
+    kage::PassDesc passDesc;
+    passDesc.prog = prog;
+    passDesc.queue = kage::PassExeQueue::compute;
+    kage::PassHandle pass = kage::registPass("rc_oct_tree", passDesc);
+
+    const uint32_t nodeCount = getOctTreeNodeCount();
+
+    kage::BufferDesc mapDesc{};
+    mapDesc.size = nodeCount * sizeof(uint32_t);
+    mapDesc.usage = BufUsage::storage | BufUsage::transfer_dst;
+    kage::BufferHandle mediumMap = kage::registBuffer("rc_vox_medium_map", mapDesc);
+    kage::BufferHandle visited = kage::registBuffer("rc_vox_visited", mapDesc);
+
+    kage::BufferDesc treeDesc{};
+    treeDesc.size = nodeCount * sizeof(OctTreeNode);
+    treeDesc.usage = BufUsage::storage | BufUsage::transfer_dst;
+    kage::BufferHandle octTree = kage::registBuffer("rc_oct_tree", treeDesc);
+
+    kage::BufferDesc countDesc{};
+    countDesc.size = 2 * sizeof(uint32_t);
+    countDesc.usage = BufUsage::storage | BufUsage::transfer_dst;
+    kage::BufferHandle nodeCountBuf = kage::registBuffer("rc_oct_tree_node_count", countDesc);
+
+    kage::BufferHandle mediumMapAlias = kage::alias(mediumMap);
+    kage::BufferHandle octTreeAlias = kage::alias(octTree);
+    kage::BufferHandle nodeCountAlias = kage::alias(nodeCountBuf);
+    kage::BufferHandle visitedAlias = kage::alias(visited);
+
+    kage::bindBuffer(pass, _vox.voxMapOutAlias
+        , Stage::compute_shader
+        , Access::shader_read
+    );
+
+    kage::bindBuffer(pass, mediumMap
+        , Stage::compute_shader
+        , Access::shader_read | Access::shader_write
+        , mediumMapAlias
+    );
+
+    kage::bindBuffer(pass, octTree
+        , Stage::compute_shader
+        , Access::shader_read | Access::shader_write
+        , octTreeAlias
+    );
+
+    kage::bindBuffer(pass, nodeCountBuf
+        , Stage::compute_shader
+        , Access::shader_read | Access::shader_write
+        , nodeCountAlias
+    );
+
+    kage::bindBuffer(pass, visited
+        , Stage::compute_shader
+        , Access::shader_read | Access::shader_write
+        , visitedAlias
+    );
+
+    _ot.pass = pass;
+    _ot.program = prog;
+    _ot.cs = cs;
+
+    _ot.voxMap = _vox.voxMapOutAlias;
+    _ot.voxMediumMap = mediumMap;
+    _ot.octTree = octTree;
+    _ot.nodeCount = nodeCountBuf;
+    _ot.visited = visited;
+
+    _ot.voxMediumMapOutAlias = mediumMapAlias;
+    _ot.octTreeOutAlias = octTreeAlias;
+    _ot.nodeCountOutAlias = nodeCountAlias;
+    _ot.visitedOutAlias = visitedAlias;
+}
+
+void prepareRCProbeAlloc(RCProbeAlloc& _pa, const RCOctTree& _ot)
+{
+    kage::ShaderHandle cs = kage::registShader("rc_probe_alloc", "shader/rc_probe_alloc.comp.spv");
+    kage::ProgramHandle prog = kage::registProgram("rc_probe_alloc", { cs }, sizeof(ProbeAllocConsts));
+
+    kage::PassDesc passDesc;
+    passDesc.prog = prog;
+    passDesc.queue = kage::PassExeQueue::compute;
+    kage::PassHandle pass = kage::registPass("rc_probe_alloc", passDesc);
+
+    kage::BufferDesc cmdDesc{};
+    cmdDesc.size = kage::k_rclv0_cascadeLv * sizeof(IndirectDispatchCommand);
+    cmdDesc.usage = BufUsage::indirect | BufUsage::storage | BufUsage::transfer_dst;
+    // host visible to read the live probe count back
+    cmdDesc.memFlags = kage::MemoryPropFlagBits::device_local | kage::MemoryPropFlagBits::host_visible;
+    // the live probes are traced in the frames after the rebuild
+    kage::BufferHandle cmdBuf = kage::registBuffer("rc_live_probe_cmd", cmdDesc, nullptr, kage::ResourceLifetime::non_transition);
+
+    kage::BufferDesc liveDesc{};
+    liveDesc.size = getOctTreeNodeCount() * sizeof(uint32_t);
+    liveDesc.usage = BufUsage::storage | BufUsage::transfer_dst;
+    kage::BufferHandle liveProbes = kage::registBuffer("rc_live_probes", liveDesc, nullptr, kage::ResourceLifetime::non_transition);
+
+    kage::BufferHandle cmdBufAlias = kage::alias(cmdBuf);
+    kage::BufferHandle liveProbesAlias = kage::alias(liveProbes);
+
+    kage::bindBuffer(pass, _ot.voxMediumMapOutAlias
+        , Stage::compute_shader
+        , Access::shader_read
+    );
+
+    kage::bindBuffer(pass, _ot.octTreeOutAlias
+        , Stage::compute_shader
+        , Access::shader_read
+    );
+
+    kage::bindBuffer(pass, cmdBuf
+        , Stage::compute_shader
+        , Access::shader_read | Access::shader_write
+        , cmdBufAlias
+    );
+
+    kage::bindBuffer(pass, liveProbes
+        , Stage::compute_shader
+        , Access::shader_write
+        , liveProbesAlias
+    );
+
+    _pa.pass = pass;
+    _pa.program = prog;
+    _pa.cs = cs;
+
+    _pa.voxMediumMap = _ot.voxMediumMapOutAlias;
+    _pa.octTree = _ot.octTreeOutAlias;
+    _pa.dispatchCmdBuf = cmdBuf;
+    _pa.liveProbes = liveProbes;
+
+    _pa.dispatchCmdBufOutAlias = cmdBufAlias;
+    _pa.liveProbesOutAlias = liveProbesAlias;
+}
+
+void prepareRCOccupancy(RCOccupancy& _occ, const RCOccupancyInit& _init)
+{
+    static_assert(kRcVoxSideCount == kage::k_rclv0_probeSideCount * 2, "a level 0 node should cover the smallest level 0 probe");
+    static_assert(kRcOctTreeLevels >= kage::k_rclv0_cascadeLv, "each cascade level needs an oct-tree level");
+
+    prepareRCVoxTasks(_occ.voxTasks, _init);
+    prepareRCVoxelize(_occ.voxelize, _init, _occ.voxTasks);
+    prepareRCOctTree(_occ.octTree, _occ.voxelize);
+    prepareRCProbeAlloc(_occ.probeAlloc, _occ.octTree);
+
+    _occ.drawCount = _init.drawCount;
+
+    const uint64_t nodeCount = getOctTreeNodeCount();
+    _occ.memorySize = glm::max(_init.drawCount, 1u) * sizeof(VoxDrawState)
+        + 2 * sizeof(IndirectDispatchCommand)
+        + 2ull * _occ.voxelize.taskCapacity * sizeof(VoxTask)
+        + uint64_t(kRcVoxSideCount) * kRcVoxSideCount * kRcVoxSideCount * sizeof(uint32_t) * 2 // voxel map and counts
+        + nodeCount * (sizeof(uint32_t) * 3 + sizeof(OctTreeNode)) // medium map, visited, live probes and nodes
+        + 2 * sizeof(uint32_t)
+        + kage::k_rclv0_cascadeLv * sizeof(IndirectDispatchCommand);
+}
+
+static VoxelizationConsts getVoxelizationConsts(const RCOccupancy& _occ)
+{
+    // the volume to [-1, 1]^3
+    mat4 proj = glm::scale(mat4(1.f), vec3(1.f / _occ.radius));
+    proj = glm::translate(proj, -_occ.center);
+
+    VoxelizationConsts consts{};
+    consts.proj = proj;
+    consts.voxGridCount = kRcVoxSideCount;
+    consts.voxCellLen = _occ.radius * 2.f / float(kRcVoxSideCount);
+    consts.sceneRadius = _occ.radius;
+    consts.cx = _occ.center.x;
+    consts.cy = _occ.center.y;
+    consts.cz = _occ.center.z;
+    consts.drawCount = _occ.drawCount;
+    consts.taskCapacity = _occ.voxelize.taskCapacity;
+
+    return consts;
+}
+
+void recRCVoxTasks(const RCVoxTasks& _vt, const VoxelizationConsts& _consts, bool _update)
+{
+    KG_ZoneScopedC(kage::Color::blue);
+
+    kage::startRec(_vt.pass);
+
+    if (_update)
+    {
+        const kage::Memory* mem = kage::alloc(sizeof(VoxelizationConsts));
+        memcpy(mem->data, &_consts, mem->size);
+        kage::setConstants(mem);
+
+        kage::fillBuffer(_vt.taskCmdBuf, 0);
+
+        // all the draws are added again
+        if (_consts.rebuild)
+        {
+            kage::fillBuffer(_vt.voxCount, 0);
+            kage::fillBuffer(_vt.voxMap, kRcInvalidIdx);
+        }
+
+        kage::Binding binds[] =
+        {
+            { _vt.meshBuf,      BindingAccess::read,        Stage::compute_shader },
+            { _vt.meshDrawBuf,  BindingAccess::read,        Stage::compute_shader },
+            { _vt.voxDraws,     BindingAccess::read_write,  Stage::compute_shader },
+            { _vt.taskCmdBuf,   BindingAccess::read_write,  Stage::compute_shader },
+            { _vt.taskBuf,      BindingAccess::write,       Stage::compute_shader },
+        };
+        kage::pushBindings(binds, COUNTOF(binds));
+
+        kage::dispatch(_consts.drawCount, 1, 1);
+    }
+
+    kage::endRec();
+}
+
+void recRCVoxelize(const RCVoxelize& _vox, const VoxelizationConsts& _consts, bool _update)
+{
+    KG_ZoneScopedC(kage::Color::blue);
+
+    kage::startRec(_vox.pass);
+
+    if (_update)
+    {
+        kage::Binding binds[] =
+        {
+            { _vox.vtxBuf,          BindingAccess::read,        Stage::compute_shader },
+            { _vox.meshletBuf,      BindingAccess::read,        Stage::compute_shader },
+            { _vox.meshletDataBuf,  BindingAccess::read,        Stage::compute_shader },
+            { _vox.taskBuf,         BindingAccess::read,        Stage::compute_shader },
+            { _vox.voxCount,        BindingAccess::read_write,  Stage::compute_shader },
+            { _vox.voxMap,          BindingAccess::read_write,  Stage::compute_shader },
+        };
+
+        // remove first, a voxel left by one draw and entered by another keeps its count above 0
+        for (uint32_t ii = 0; ii < 2; ++ii)
+        {
+            VoxelizationConsts consts = _consts;
+            consts.remove = (ii == 0) ? 1 : 0;
+            consts.taskOffset = ii * _vox.taskCapacity;
+
+            const kage::Memory* mem = kage::alloc(sizeof(VoxelizationConsts));
+            memcpy(mem->data, &consts, mem->size);
+            kage::setConstants(mem);
+
+            kage::pushBindings(binds, COUNTOF(binds));
+
+            kage::dispatchIndirect(_vox.taskCmdBuf, uint32_t(ii * sizeof(IndirectDispatchCommand) + offsetof(IndirectDispatchCommand, x)));
+        }
+    }
+
+    kage::endRec();
+}
+
+void recRCOctTree(const RCOctTree& _ot, bool _rebuild)
+{
+    KG_ZoneScopedC(kage::Color::blue);
+
+    kage::startRec(_ot.pass);
+
+    if (_rebuild)
+    {
+        kage::fillBuffer(_ot.voxMediumMap, kRcInvalidIdx);
+        kage::fillBuffer(_ot.nodeCount, 0);
+        kage::fillBuffer(_ot.visited, 0);
+
+        // bottom-up, a level reads the node map of the previous one
+        for (uint32_t lv = 0; lv < kRcOctTreeLevels; ++lv)
+        {
+            OctTreeProcessConfig config{};
+            config.lv = lv;
+            config.voxGridSideCount = kRcVoxSideCount >> (lv + 1);
+            config.readOffset = (lv == 0) ? 0 : getRCOccupancyLevelOffset(lv - 1);
+            config.writeOffset = getRCOccupancyLevelOffset(lv);
+
+            const kage::Memory* mem = kage::alloc(sizeof(OctTreeProcessConfig));
+            memcpy(mem->data, &config, mem->size);
+            kage::setConstants(mem);
+
+            kage::Binding binds[] =
+            {
+                { _ot.voxMap,       BindingAccess::read,        Stage::compute_shader },
+                { _ot.voxMediumMap, BindingAccess::read_write,  Stage::compute_shader },
+                { _ot.octTree,      BindingAccess::read_write,  Stage::compute_shader },
+                { _ot.nodeCount,    BindingAccess::read_write,  Stage::compute_shader },
+                { _ot.visited,      BindingAccess::read_write,  Stage::compute_shader },
+            };
+            kage::pushBindings(binds, COUNTOF(binds));
+
+            kage::dispatch(config.voxGridSideCount, config.voxGridSideCount, config.voxGridSideCount);
+        }
+    }
+
+    kage::endRec();
+}
+
+void recRCProbeAlloc(const RCProbeAlloc& _pa, uint32_t _probeSideCount, uint32_t _rayGridSideCount, uint32_t _endLv, bool _rebuild)
+{
+    KG_ZoneScopedC(kage::Color::blue);
+
+    kage::startRec(_pa.pass);
+
+    if (_rebuild)
+    {
+        kage::fillBuffer(_pa.dispatchCmdBuf, 0);
+
+        // fewer probes on level 0 move a probe cell to a coarser node level
+        uint32_t nodeLvShift = 0;
+        while ((kRcVoxSideCount >> (nodeLvShift + 1)) > _probeSideCount)
+            ++nodeLvShift;
+
+        for (uint32_t lv = 0; lv < _endLv; ++lv)
+        {
+            uint32_t probeSideCount = _probeSideCount >> lv;
+            uint32_t raySideCount = _rayGridSideCount << lv;
+            uint32_t rayTileSideCount = (raySideCount + kRcSparseRayTile - 1) / kRcSparseRayTile;
+
+            ProbeAllocConsts consts{};
+            consts.lv = lv;
+            consts.probeSideCount = probeSideCount;
+            consts.nodeOffset = getRCOccupancyLevelOffset(lv + nodeLvShift);
+            consts.liveOffset = getRCOccupancyLevelOffset(lv);
+            consts.rayTileCount = rayTileSideCount * rayTileSideCount;
+
+            const kage::Memory* mem = kage::alloc(sizeof(ProbeAllocConsts));
+            memcpy(mem->data, &consts, mem->size);
+            kage::setConstants(mem);
+
+            kage::Binding binds[] =
+            {
+                { _pa.voxMediumMap,     BindingAccess::read,        Stage::compute_shader },
+                { _pa.octTree,          BindingAccess::read,        Stage::compute_shader },
+                { _pa.dispatchCmdBuf,   BindingAccess::read_write,  Stage::compute_shader },
+                { _pa.liveProbes,       BindingAccess::write,       Stage::compute_shader },
+            };
+            kage::pushBindings(binds, COUNTOF(binds));
+
+            kage::dispatch(probeSideCount, probeSideCount, probeSideCount);
+        }
+    }
+
+    kage::endRec();
+}
+
+static void readLiveProbeCount(RCOccupancy& _occ)
+{
+    _occ.totalProbes = 0;
+    for (uint32_t lv = 0; lv < _occ.endLv; ++lv)
+    {
+        const uint32_t side = _occ.probeSideCount >> lv;
+        _occ.totalProbes += side * side * side;
+    }
+
+    IndirectDispatchCommand cmds[kage::k_rclv0_cascadeLv];
+    if (!kage::readBuffer(_occ.probeAlloc.dispatchCmdBuf, cmds, sizeof(cmds)))
+        return;
+
+    _occ.liveProbes = 0;
+    for (uint32_t lv = 0; lv < _occ.endLv; ++lv)
+    {
+        _occ.liveProbes += cmds[lv].count;
+    }
+}
+
+bool updateRCOccupancy(RCOccupancy& _occ, const Dbg_RadianceCascades& _dbg, const vec3& _center, uint32_t _endLv)
+{
+    const vec3 center = _center + vec3(_dbg.probePosOffset[0], _dbg.probePosOffset[1], _dbg.probePosOffset[2]);
+
+    bool rebuild = false;
+    if (_dbg.sparseProbes)
+    {
+        rebuild = !_occ.valid
+            || _occ.center != center
+            || _occ.radius != _dbg.totalRadius
+            || _occ.endLv != _endLv
+            || _occ.probeSideCount != getRCProbeSideCount(_dbg)
+            || _occ.rayGridSideCount != getRCRayGridSideCount(_dbg);
+    }
+    else
+    {
+        // rebuild when enabled again
+        _occ.valid = false;
+    }
+
+    if (rebuild)
+    {
+        _occ.center = center;
+        _occ.radius = _dbg.totalRadius;
+        _occ.endLv = _endLv;
+        _occ.probeSideCount = getRCProbeSideCount(_dbg);
+        _occ.rayGridSideCount = getRCRayGridSideCount(_dbg);
+        _occ.valid = true;
+        _occ.rebuilds++;
+    }
+
+    VoxelizationConsts consts = getVoxelizationConsts(_occ);
+    consts.rebuild = rebuild ? 1 : 0;
+
+    // the unmoved draws emit no tasks, the dispatches are mostly empty
+    const bool update = rebuild || (_dbg.sparseProbes && _dbg.dynamicOccupancy);
+
+    recRCVoxTasks(_occ.voxTasks, consts, update);
+    recRCVoxelize(_occ.voxelize, consts, update);
+    recRCOctTree(_occ.octTree, update);
+    recRCProbeAlloc(_occ.probeAlloc, _occ.probeSideCount, _occ.rayGridSideCount, _endLv, update);
+
+    if (_dbg.sparseProbes)
+    {
+        readLiveProbeCount(_occ);
+    }
+
+    _occ.rebuilt = rebuild;
+    return rebuild;
+}
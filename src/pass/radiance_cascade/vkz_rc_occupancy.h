@@ -0,0 +1,217 @@
+#pragma once
+
+#include "core/kage_math.h"
+#include "core/common.h"
+#include "core/kage.h"
+#include "demo_structs.h"
+#include "vkz_rc_common.h"
+
+struct Scene;
+
+// the voxel occupancy of the probe volume, decides which probes of the cascades are traced
+// the scene is voxelized into a 64^3 grid, an oct-tree is built on it, a level n node covers a level n probe cell
+// of the largest probe grid, smaller level 0 grids start from a coarser node level
+// a probe is live if a cell around it has surfaces but is not fully solid, the live probes go to an indirection table
+// only the trace cost scales with the live probes: the cascade atlas stays dense so the merge passes read it unchanged,
+// its memory still scales with the volume
+// keep sync with rc_common.h
+constexpr uint32_t kRcVoxSideCount = 64;
+constexpr uint32_t kRcOctTreeLevels = 6;
+constexpr uint32_t kRcSparseRayTile = 16;
+constexpr uint32_t kRcInvalidIdx = 0xFFFFFFFFu;
+constexpr uint32_t kRcVoxTaskMeshlets = 32;
+
+struct alignas(16) VoxelizationConsts
+{
+    mat4 proj;
+    uint32_t voxGridCount;
+    float voxCellLen;
+    float sceneRadius;
+
+    float cx, cy, cz;
+    uint32_t drawCount;
+
+    uint32_t rebuild;
+    uint32_t taskCapacity;
+    uint32_t taskOffset;
+    uint32_t remove;
+    uint32_t padding0;
+};
+
+struct alignas(16) VoxDrawState
+{
+    vec3 pos;
+    uint32_t added;
+    vec3 scale;
+    uint32_t padding0;
+    quat orit;
+};
+
+struct alignas(16) VoxTask
+{
+    vec3 pos;
+    uint32_t meshletOffset;
+    vec3 scale;
+    uint32_t meshletCount;
+    quat orit;
+    uint32_t vertexOffset;
+    uint32_t padding0, padding1, padding2;
+};
+
+struct OctTreeNode
+{
+    uint32_t dataIdx;
+    uint32_t lv;
+    uint32_t childs[8];
+    uint32_t full;
+};
+
+struct OctTreeProcessConfig
+{
+    uint32_t lv;
+    uint32_t voxGridSideCount;
+    uint32_t readOffset;
+    uint32_t writeOffset;
+};
+
+struct alignas(16) ProbeAllocConsts
+{
+    uint32_t lv;
+    uint32_t probeSideCount;
+    uint32_t nodeOffset;
+    uint32_t liveOffset;
+    uint32_t rayTileCount;
+    uint32_t padding0, padding1, padding2;
+};
+
+struct RCOccupancyInit
+{
+    kage::BufferHandle meshBuf;
+    kage::BufferHandle meshDrawBuf;
+    kage::BufferHandle meshletBuf; // clusters with the seamless lod
+    kage::BufferHandle meshletDataBuf;
+    kage::BufferHandle vtxBuf;
+
+    uint32_t drawCount;
+    uint32_t taskCapacity; // see getRCVoxTaskCount()
+    bool seamless;
+};
+
+// compares each draw with the transform it was voxelized with
+// a moved draw emits tasks to remove its triangles with the old transform and to add them with the new one
+struct RCVoxTasks
+{
+    kage::PassHandle pass;
+    kage::ProgramHandle program;
+    kage::ShaderHandle cs;
+
+    kage::BufferHandle meshBuf;
+    kage::BufferHandle meshDrawBuf;
+
+    kage::BufferHandle voxDraws;
+    kage::BufferHandle taskCmdBuf;
+    kage::BufferHandle taskBuf;
+    kage::BufferHandle voxCount;
+    kage::BufferHandle voxMap;
+
+    kage::BufferHandle voxDrawsOutAlias;
+    kage::BufferHandle taskCmdBufOutAlias;
+    kage::BufferHandle taskBufOutAlias;
+    kage::BufferHandle voxCountOutAlias;
+    kage::BufferHandle voxMapOutAlias;
+};
+
+// a workgroup per task, the triangles of the meshlets are tested against the voxels they may touch
+// each voxel counts the triangles in it, the remove tasks run ahead of the add ones
+struct RCVoxelize
+{
+    kage::PassHandle pass;
+    kage::ProgramHandle program;
+    kage::ShaderHandle cs;
+
+    kage::BufferHandle vtxBuf;
+    kage::BufferHandle meshletBuf;
+    kage::BufferHandle meshletDataBuf;
+    kage::BufferHandle taskCmdBuf;
+    kage::BufferHandle taskBuf;
+
+    kage::BufferHandle voxCount;
+    kage::BufferHandle voxMap;
+
+    kage::BufferHandle voxCountOutAlias;
+    kage::BufferHandle voxMapOutAlias;
+
+    uint32_t taskCapacity{ 0 };
+};
+
+struct RCOctTree
+{
+    kage::PassHandle pass;
+    kage::ProgramHandle program;
+    kage::ShaderHandle cs;
+
+    kage::BufferHandle voxMap;
+
+    kage::BufferHandle voxMediumMap;
+    kage::BufferHandle octTree;
+    kage::BufferHandle nodeCount;
+    kage::BufferHandle visited;
+
+    kage::BufferHandle voxMediumMapOutAlias;
+    kage::BufferHandle octTreeOutAlias;
+    kage::BufferHandle nodeCountOutAlias;
+    kage::BufferHandle visitedOutAlias;
+};
+
+struct RCProbeAlloc
+{
+    kage::PassHandle pass;
+    kage::ProgramHandle program;
+    kage::ShaderHandle cs;
+
+    kage::BufferHandle voxMediumMap;
+    kage::BufferHandle octTree;
+
+    kage::BufferHandle dispatchCmdBuf;
+    kage::BufferHandle liveProbes;
+
+    kage::BufferHandle dispatchCmdBufOutAlias;
+    kage::BufferHandle liveProbesOutAlias;
+};
+
+struct RCOccupancy
+{
+    RCVoxTasks voxTasks;
+    RCVoxelize voxelize;
+    RCOctTree octTree;
+    RCProbeAlloc probeAlloc;
+
+    uint32_t drawCount{ 0 };
+
+    // the occupancy is rebuilt only when the volume moved or resized
+    // with the dynamic occupancy the moved draws are revoxelized every frame
+    bool valid{ false };
+    bool rebuilt{ false };
+    vec3 center{ vec3(0.f) };
+    float radius{ 0.f };
+    uint32_t endLv{ 0 };
+    uint32_t probeSideCount{ 0 };
+    uint32_t rayGridSideCount{ 0 };
+
+    // stats
+    uint32_t rebuilds{ 0 };
+    uint64_t memorySize{ 0 };
+    uint32_t liveProbes{ 0 }; // read back from the dispatch commands, late by the frames in flight
+    uint32_t totalProbes{ 0 }; // of the dense grid, on the traced levels
+};
+
+void prepareRCOccupancy(RCOccupancy& _occ, const RCOccupancyInit& _init);
+
+// the offset of the level in the oct-tree node map, the same for the live probe list
+uint32_t getRCOccupancyLevelOffset(uint32_t _lv);
+
+// the voxelization tasks to cover all the draws once, the remove and the add list have this capacity each
+uint32_t getRCVoxTaskCount(const Scene& _scene, bool _seamless);
+
+// returns true if the occupancy is rebuilt this frame, the probes should be fully traced then
+bool updateRCOccupancy(RCOccupancy& _occ, const Dbg_RadianceCascades& _dbg, const vec3& _center, uint32_t _endLv);
@@ -1,6 +1,17 @@
 #include "vkz_culling_pass.h"
 #include "vkz_pass.h"
 
+// keep sync with the DRAW_SORT_* in mesh_gpu.h
+constexpr uint32_t kDrawSortBinCount = 512;
+constexpr uint32_t kDrawSortBucketCount = 2;
+constexpr uint32_t kDrawSortTotalBins = kDrawSortBinCount * kDrawSortBucketCount;
+constexpr uint32_t kDrawSortItemSize = 4 * sizeof(uint32_t);
+constexpr uint32_t kDrawCullGroupSize = 128; // TASKGP_SIZE
+
+// keep sync with the MR_ACCEPTED_PAYLOAD_BASE in mesh_gpu.h
+constexpr uint32_t kAcceptedPayloadBase = 4 * 1024 * 1024;
+constexpr uint32_t kRasterMeshletPayloadSize = 24; // RasterMeshletPayload in mesh_gpu.h
+
 void recMeshCulling(const MeshCulling& _cull, uint32_t _drawCount)
 {
     KG_ZoneScopedC(kage::Color::blue);
@@ -10,7 +21,7 @@ void recMeshCulling(const MeshCulling& _cull, uint32_t _drawCount)
 
     kage::startRec(_cull.pass);
 
-    kage::fillBuffer(_cull.meshDrawCmdCountBuf, 0);
+    kage::fillBuffer(_cull.sortBinBuf, 0);
 
     kage::setConstants(mem);
 
@@ -19,10 +30,12 @@ void recMeshCulling(const MeshCulling& _cull, uint32_t _drawCount)
         { _cull.meshBuf,             BindingAccess::read,       Stage::compute_shader },
         { _cull.meshDrawBuf,         BindingAccess::read,       Stage::compute_shader },
         { _cull.transBuf,            BindingAccess::read,       Stage::compute_shader },
-        { _cull.meshDrawCmdBuf,      BindingAccess::write,      Stage::compute_shader },
-        { _cull.meshDrawCmdCountBuf, BindingAccess::read_write, Stage::compute_shader },
+        { _cull.sortItemBuf,         BindingAccess::write,      Stage::compute_shader },
+        { _cull.sortBinBuf,          BindingAccess::read_write, Stage::compute_shader },
         { _cull.meshDrawVisBuf,      BindingAccess::read_write, Stage::compute_shader },
         { _cull.pyramid,             _cull.pyrSampler,          Stage::compute_shader },
+        // the mesh buffer is only a placeholder when the software occlusion is not used
+        { kage::isValid(_cull.swOcclusionVisBuf) ? _cull.swOcclusionVisBuf : _cull.meshBuf, BindingAccess::read, Stage::compute_shader },
     };
     kage::pushBindings(binds, COUNTOF(binds));
     kage::dispatch(_drawCount, 1, 1);
@@ -30,6 +43,52 @@ void recMeshCulling(const MeshCulling& _cull, uint32_t _drawCount)
     kage::endRec();
 }
 
+void recDrawCmdScan(const MeshCulling& _cull)
+{
+    KG_ZoneScopedC(kage::Color::blue);
+
+    kage::startRec(_cull.scanPass);
+
+    kage::Binding binds[] =
+    {
+        { _cull.sortBinBufOutAlias,  BindingAccess::read_write, Stage::compute_shader },
+        { _cull.meshDrawCmdCountBuf, BindingAccess::write,      Stage::compute_shader },
+    };
+    kage::pushBindings(binds, COUNTOF(binds));
+    kage::dispatch(1, 1, 1);
+
+    kage::endRec();
+}
+
+void recDrawCmdScatter(const MeshCulling& _cull, uint32_t _drawCount)
+{
+    KG_ZoneScopedC(kage::Color::blue);
+
+    const kage::Memory* mem = kage::alloc(sizeof(Constants));
+    bx::memCopy(mem->data, &_cull.constants, mem->size);
+
+    kage::startRec(_cull.scatterPass);
+
+    kage::setConstants(mem);
+
+    kage::Binding binds[] =
+    {
+        { _cull.meshBuf,             BindingAccess::read,       Stage::compute_shader },
+        { _cull.meshDrawBuf,         BindingAccess::read,       Stage::compute_shader },
+        { _cull.sortItemBufOutAlias, BindingAccess::read,       Stage::compute_shader },
+        { _cull.sortBinBufScanAlias, BindingAccess::read_write, Stage::compute_shader },
+        { _cull.meshDrawCmdBuf,      BindingAccess::write,      Stage::compute_shader },
+    };
+    kage::pushBindings(binds, COUNTOF(binds));
+    kage::dispatch(_drawCount, 1, 1);
+
+    kage::endRec();
+}
+
+// draw commands are generated in 3 passes:
+// classify: cull draws, write the sort key and count the groups of each (bucket, depth bin)
+// scan: prefix sum the bin counts into offsets, which also gives the final command count
+// scatter: write commands into the slot of its bin, so the output is opaque -> alpha, near -> far
 void initMeshCulling(MeshCulling& _cullingComp, const MeshCullingInitData& _initData, PassStage _stage, RenderPipeline _pipeline)
 {
     kage::ShaderHandle cs = kage::registShader("mesh_draw_cmd", "shader/drawcmd.comp.spv");
@@ -40,6 +99,7 @@ void initMeshCulling(MeshCulling& _cullingComp, const MeshCullingInitData& _init
         , _pipeline == RenderPipeline::mesh_shading // TASK
         , _stage == PassStage::alpha // ALPHA_PASS
         , _pipeline == RenderPipeline::mixed // USE_MIXED_RASTER
+        , kage::isValid(_initData.swOcclusionVisBuf) // USE_SW_OCCLUSION
     };
 
     const kage::Memory* pConst = kage::alloc(sizeof(int) * COUNTOF(pipelineSpecs));
@@ -54,8 +114,26 @@ void initMeshCulling(MeshCulling& _cullingComp, const MeshCullingInitData& _init
     std::string passName = getPassName( "mesh_culling", _stage, _pipeline);
     kage::PassHandle pass = kage::registPass(passName.c_str(), passDesc);
 
-    kage::BufferHandle drawCmdOutAlias = kage::alias(_initData.meshDrawCmdBuf);
-    kage::BufferHandle drawCmdCountOutAlias = kage::alias(_initData.meshDrawCmdCountBuf);
+    // sort buffers
+    uint32_t itemCount = (_initData.drawCount + kDrawCullGroupSize - 1) / kDrawCullGroupSize * kDrawCullGroupSize;
+
+    kage::BufferDesc sortItemBufDesc;
+    sortItemBufDesc.size = glm::max(itemCount, 1u) * kDrawSortItemSize;
+    sortItemBufDesc.usage = kage::BufferUsageFlagBits::storage | kage::BufferUsageFlagBits::transfer_dst;
+    sortItemBufDesc.memFlags = kage::MemoryPropFlagBits::device_local;
+    std::string sortItemName = getPassName("draw_sort_item", _stage, _pipeline);
+    kage::BufferHandle sortItemBuf = kage::registBuffer(sortItemName.c_str(), sortItemBufDesc);
+
+    // counts, offsets and cursors
+    kage::BufferDesc sortBinBufDesc;
+    sortBinBufDesc.size = kDrawSortTotalBins * 3 * sizeof(uint32_t);
+    sortBinBufDesc.usage = kage::BufferUsageFlagBits::storage | kage::BufferUsageFlagBits::transfer_dst;
+    sortBinBufDesc.memFlags = kage::MemoryPropFlagBits::device_local;
+    std::string sortBinName = getPassName("draw_sort_bin", _stage, _pipeline);
+    kage::BufferHandle sortBinBuf = kage::registBuffer(sortBinName.c_str(), sortBinBufDesc);
+
+    kage::BufferHandle sortItemOutAlias = kage::alias(sortItemBuf);
+    kage::BufferHandle sortBinOutAlias = kage::alias(sortBinBuf);
     kage::BufferHandle drawVisOutAlias = kage::alias(_initData.meshDrawVisBuf);
 
     kage::bindBuffer(pass, _initData.meshBuf
@@ -70,21 +148,28 @@ void initMeshCulling(MeshCulling& _cullingComp, const MeshCullingInitData& _init
         , Stage::compute_shader
         , Access::shader_read);
 
-    kage::bindBuffer(pass, _initData.meshDrawCmdBuf
+    kage::bindBuffer(pass, sortItemBuf
         , Stage::compute_shader
-        , Access::shader_read | kage::AccessFlagBits::shader_write
-        , drawCmdOutAlias);
+        , Access::shader_write
+        , sortItemOutAlias);
 
-    kage::bindBuffer(pass, _initData.meshDrawCmdCountBuf
+    kage::bindBuffer(pass, sortBinBuf
         , Stage::compute_shader
         , Access::shader_read | kage::AccessFlagBits::shader_write
-        , drawCmdCountOutAlias);
+        , sortBinOutAlias);
 
     kage::bindBuffer(pass, _initData.meshDrawVisBuf
         , Stage::compute_shader
         , Access::shader_read | kage::AccessFlagBits::shader_write
         , drawVisOutAlias);
 
+    if (kage::isValid(_initData.swOcclusionVisBuf))
+    {
+        kage::bindBuffer(pass, _initData.swOcclusionVisBuf
+            , Stage::compute_shader
+            , Access::shader_read);
+    }
+
      kage::SamplerHandle samp = kage::sampleImage(pass, _initData.pyramid
         , Stage::compute_shader
         , kage::SamplerFilter::linear
@@ -93,19 +178,107 @@ void initMeshCulling(MeshCulling& _cullingComp, const MeshCullingInitData& _init
         , kage::SamplerReductionMode::min
      );
 
+    // scan pass
+    bool useWaveOps = kage::checkSubgroupArithmeticSupports();
+    kage::ShaderHandle scanCs = useWaveOps
+        ? kage::registShader("draw_cmd_scan_wave", "shader/drawcmd_scan_wave.comp.spv")
+        : kage::registShader("draw_cmd_scan", "shader/drawcmd_scan.comp.spv");
+    kage::ProgramHandle scanProg = kage::registProgram("draw_cmd_scan", { scanCs });
+
+    kage::PassDesc scanPassDesc;
+    scanPassDesc.prog = scanProg;
+    scanPassDesc.queue = kage::PassExeQueue::compute;
+
+    std::string scanPassName = getPassName("draw_cmd_scan", _stage, _pipeline);
+    kage::PassHandle scanPass = kage::registPass(scanPassName.c_str(), scanPassDesc);
+
+    kage::BufferHandle sortBinScanAlias = kage::alias(sortBinBuf);
+    kage::BufferHandle drawCmdCountOutAlias = kage::alias(_initData.meshDrawCmdCountBuf);
+
+    kage::bindBuffer(scanPass, sortBinOutAlias
+        , Stage::compute_shader
+        , Access::shader_read | kage::AccessFlagBits::shader_write
+        , sortBinScanAlias);
+
+    kage::bindBuffer(scanPass, _initData.meshDrawCmdCountBuf
+        , Stage::compute_shader
+        , Access::shader_write
+        , drawCmdCountOutAlias);
+
+    // scatter pass
+    kage::ShaderHandle scatterCs = kage::registShader("draw_cmd_scatter", "shader/drawcmd_scatter.comp.spv");
+    kage::ProgramHandle scatterProg = kage::registProgram("draw_cmd_scatter", { scatterCs }, sizeof(Constants));
+
+    int scatterSpecs[] = {
+        _pipeline == RenderPipeline::mesh_shading // TASK
+        , _pipeline == RenderPipeline::mixed // USE_MIXED_RASTER
+    };
+
+    const kage::Memory* pScatterConst = kage::alloc(sizeof(int) * COUNTOF(scatterSpecs));
+    memcpy_s(pScatterConst->data, pScatterConst->size, scatterSpecs, sizeof(int) * COUNTOF(scatterSpecs));
+
+    kage::PassDesc scatterPassDesc;
+    scatterPassDesc.prog = scatterProg;
+    scatterPassDesc.queue = kage::PassExeQueue::compute;
+    scatterPassDesc.pipelineSpecNum = COUNTOF(scatterSpecs);
+    scatterPassDesc.pipelineSpecData = (void*)pScatterConst->data;
+
+    std::string scatterPassName = getPassName("draw_cmd_scatter", _stage, _pipeline);
+    kage::PassHandle scatterPass = kage::registPass(scatterPassName.c_str(), scatterPassDesc);
+
+    kage::BufferHandle sortBinScatterAlias = kage::alias(sortBinBuf);
+    kage::BufferHandle drawCmdOutAlias = kage::alias(_initData.meshDrawCmdBuf);
+
+    kage::bindBuffer(scatterPass, _initData.meshBuf
+        , Stage::compute_shader
+        , Access::shader_read);
+
+    kage::bindBuffer(scatterPass, _initData.meshDrawBuf
+        , Stage::compute_shader
+        , Access::shader_read);
+
+    kage::bindBuffer(scatterPass, sortItemOutAlias
+        , Stage::compute_shader
+        , Access::shader_read);
+
+    kage::bindBuffer(scatterPass, sortBinScanAlias
+        , Stage::compute_shader
+        , Access::shader_read | kage::AccessFlagBits::shader_write
+        , sortBinScatterAlias);
+
+    kage::bindBuffer(scatterPass, _initData.meshDrawCmdBuf
+        , Stage::compute_shader
+        , Access::shader_write
+        , drawCmdOutAlias);
+
     _cullingComp.cs = cs;
     _cullingComp.prog = prog;
     _cullingComp.pass = pass;
 
+    _cullingComp.scanCs = scanCs;
+    _cullingComp.scanProg = scanProg;
+    _cullingComp.scanPass = scanPass;
+
+    _cullingComp.scatterCs = scatterCs;
+    _cullingComp.scatterProg = scatterProg;
+    _cullingComp.scatterPass = scatterPass;
+
     _cullingComp.meshBuf = _initData.meshBuf;
     _cullingComp.meshDrawBuf = _initData.meshDrawBuf;
     _cullingComp.transBuf = _initData.transBuf;
+    _cullingComp.swOcclusionVisBuf = _initData.swOcclusionVisBuf;
     _cullingComp.meshDrawCmdBuf = _initData.meshDrawCmdBuf;
     _cullingComp.meshDrawCmdCountBuf = _initData.meshDrawCmdCountBuf;
     _cullingComp.meshDrawVisBuf = _initData.meshDrawVisBuf;
     _cullingComp.pyramid = _initData.pyramid;
     _cullingComp.pyrSampler = samp;
 
+    _cullingComp.sortItemBuf = sortItemBuf;
+    _cullingComp.sortBinBuf = sortBinBuf;
+    _cullingComp.sortItemBufOutAlias = sortItemOutAlias;
+    _cullingComp.sortBinBufOutAlias = sortBinOutAlias;
+    _cullingComp.sortBinBufScanAlias = sortBinScanAlias;
+
     _cullingComp.cmdBufOutAlias = drawCmdOutAlias;
     _cullingComp.cmdCountBufOutAlias = drawCmdCountOutAlias;
     _cullingComp.meshDrawVisBufOutAlias = drawVisOutAlias;
@@ -118,17 +291,24 @@ void updateMeshCulling(MeshCulling& _cullingComp, const Constants& _consts, uint
     _cullingComp.constants = _consts;
 
     recMeshCulling(_cullingComp, _drawCount);
+    recDrawCmdScan(_cullingComp);
+    recDrawCmdScatter(_cullingComp, _drawCount);
 }
 
 void initMeshletCulling(MeshletCulling& _cullingComp, const MeshletCullingInitData& _initData, PassStage _stage, bool _seamless /*= false*/)
 {
-    kage::ShaderHandle cs = kage::registShader("meshlet_culling", "shader/culling_meshlet.comp.spv");
-    kage::ProgramHandle prog = kage::registProgram("meshlet_culling", { cs }, sizeof(Constants));
+    const bool useSceneAddr = kage::isValid(_initData.sceneAddrBuf);
+
+    kage::ShaderHandle cs = useSceneAddr
+        ? kage::registShader("meshlet_culling_addr", "shader/culling_meshlet_addr.comp.spv")
+        : kage::registShader("meshlet_culling", "shader/culling_meshlet.comp.spv");
+    kage::ProgramHandle prog = kage::registProgram(useSceneAddr ? "meshlet_culling_addr" : "meshlet_culling", { cs }, sizeof(Constants));
 
     int pipelineSpecs[] = {
         _stage == PassStage::late
         , _stage == PassStage::alpha
         , _seamless
+        , _initData.trivialAccept
     };
 
     const kage::Memory* pConst = kage::alloc(sizeof(int) * COUNTOF(pipelineSpecs));
@@ -159,6 +339,32 @@ void initMeshletCulling(MeshletCulling& _cullingComp, const MeshletCullingInitDa
     kage::BufferHandle meshletPayloadBufOutAlias = kage::alias(meshletPayloadBuf);
     kage::BufferHandle meshletPayloadCntOutAlias = kage::alias(meshletPayloadCntBuf);
 
+    // the triangle payload is shared with the triangle culling, the accepted meshlets are stored from MR_ACCEPTED_PAYLOAD_BASE
+    kage::BufferHandle triPayloadBuf;
+    kage::BufferHandle triCountBuf;
+    kage::BufferHandle triPayloadBufOutAlias;
+    kage::BufferHandle triCountBufOutAlias;
+    if (_initData.trivialAccept)
+    {
+        kage::BufferDesc triPayloadDesc;
+        triPayloadDesc.size = 512 * 1024 * 1024; // 512M
+        triPayloadDesc.usage = kage::BufferUsageFlagBits::storage | kage::BufferUsageFlagBits::transfer_dst;
+        triPayloadDesc.memFlags = kage::MemoryPropFlagBits::device_local;
+        triPayloadBuf = kage::registBuffer("tri_payload", triPayloadDesc);
+
+        assert(triPayloadDesc.size > kAcceptedPayloadBase * kRasterMeshletPayloadSize);
+
+        // 2 dispatch indirect commands, 1st: for software rasterization, 2nd: for hardware rasterization
+        kage::BufferDesc triCountDesc;
+        triCountDesc.size = sizeof(IndirectDispatchCommand) * 2;
+        triCountDesc.usage = kage::BufferUsageFlagBits::storage | kage::BufferUsageFlagBits::indirect | kage::BufferUsageFlagBits::transfer_dst;
+        triCountDesc.memFlags = kage::MemoryPropFlagBits::device_local;
+        triCountBuf = kage::registBuffer("triangle_payload_cnt", triCountDesc);
+
+        triPayloadBufOutAlias = kage::alias(triPayloadBuf);
+        triCountBufOutAlias = kage::alias(triCountBuf);
+    }
+
     kage::bindBuffer(pass
         , _initData.meshletCmdBuf
         , Stage::compute_shader
@@ -167,11 +373,28 @@ void initMeshletCulling(MeshletCulling& _cullingComp, const MeshletCullingInitDa
 
     kage::setIndirectBuffer(pass, _initData.meshletCmdCntBuf);
 
-    kage::bindBuffer(pass
-        , _initData.meshBuf
-        , Stage::compute_shader
-        , Access::shader_read
-    );
+    if (useSceneAddr)
+    {
+        kage::bindBuffer(pass
+            , _initData.sceneAddrBuf
+            , Stage::compute_shader
+            , Access::shader_read
+        );
+    }
+    else
+    {
+        kage::bindBuffer(pass
+            , _initData.meshBuf
+            , Stage::compute_shader
+            , Access::shader_read
+        );
+
+        kage::bindBuffer(pass
+            , _initData.meshletBuf
+            , Stage::compute_shader
+            , Access::shader_read
+        );
+    }
 
     kage::bindBuffer(pass
         , _initData.meshDrawBuf
@@ -185,18 +408,21 @@ void initMeshletCulling(MeshletCulling& _cullingComp, const MeshletCullingInitDa
         , Access::shader_read
     );
 
-    kage::bindBuffer(pass
-        , _initData.meshletBuf
-        , Stage::compute_shader
-        , Access::shader_read
-    );
-
     kage::bindBuffer(pass
         , _initData.meshletCmdCntBuf
         , Stage::compute_shader
         , Access::shader_read
     );
 
+    if (!useSceneAddr && kage::isValid(_initData.meshletLodBuf))
+    {
+        kage::bindBuffer(pass
+            , _initData.meshletLodBuf
+            , Stage::compute_shader
+            , Access::shader_read
+        );
+    }
+
     // read/write buffers
     kage::bindBuffer(pass
         , _initData.meshletVisBuf
@@ -220,6 +446,23 @@ void initMeshletCulling(MeshletCulling& _cullingComp, const MeshletCullingInitDa
         , meshletPayloadCntOutAlias
     );
 
+    if (_initData.trivialAccept)
+    {
+        kage::bindBuffer(pass
+            , triPayloadBuf
+            , Stage::compute_shader
+            , Access::shader_read | kage::AccessFlagBits::shader_write
+            , triPayloadBufOutAlias
+        );
+
+        kage::bindBuffer(pass
+            , triCountBuf
+            , Stage::compute_shader
+            , Access::shader_read | kage::AccessFlagBits::shader_write
+            , triCountBufOutAlias
+        );
+    }
+
     // samplers
     kage::SamplerHandle pyrSamp = kage::sampleImage( pass
         , _initData.pyramid
@@ -241,6 +484,8 @@ void initMeshletCulling(MeshletCulling& _cullingComp, const MeshletCullingInitDa
     _cullingComp.meshDrawBuf = _initData.meshDrawBuf;
     _cullingComp.transformBuf = _initData.transformBuf;
     _cullingComp.meshletBuf = _initData.meshletBuf;
+    _cullingComp.meshletLodBuf = _initData.meshletLodBuf;
+    _cullingComp.sceneAddrBuf = _initData.sceneAddrBuf;
     _cullingComp.pyramid = _initData.pyramid;
     _cullingComp.pyrSampler = pyrSamp;
 
@@ -248,11 +493,17 @@ void initMeshletCulling(MeshletCulling& _cullingComp, const MeshletCullingInitDa
     _cullingComp.meshletVisBuf = _initData.meshletVisBuf;
     _cullingComp.meshletPayloadBuf = meshletPayloadBuf;
     _cullingComp.meshletPayloadCntBuf = meshletPayloadCntBuf;
+    _cullingComp.triPayloadBuf = triPayloadBuf;
+    _cullingComp.triCountBuf = triCountBuf;
+
+    _cullingComp.stage = _stage;
 
     // out-alias
     _cullingComp.meshletVisBufOutAlias = meshletVisBufOutAlias;
     _cullingComp.cmdBufOutAlias = meshletPayloadBufOutAlias;
     _cullingComp.cmdCountBufOutAlias = meshletPayloadCntOutAlias;
+    _cullingComp.triPayloadBufOutAlias = triPayloadBufOutAlias;
+    _cullingComp.triCountBufOutAlias = triCountBufOutAlias;
 }
 
 void recMeshletCulling(const MeshletCulling& _mltc, const Constants& _consts)
@@ -266,22 +517,61 @@ void recMeshletCulling(const MeshletCulling& _mltc, const Constants& _consts)
 
     kage::fillBuffer(_mltc.meshletPayloadCntBuf, 0);
 
+    const bool trivialAccept = kage::isValid(_mltc.triCountBuf);
+    if (trivialAccept)
+    {
+        kage::fillBuffer(_mltc.triCountBuf, 0);
+
+        // clear payload buffer in late pass, moved from the triangle culling since the accepted meshlets are written here
+        if (PassStage::late == _mltc.stage)
+        {
+            kage::fillBuffer(_mltc.triPayloadBuf, 0);
+        }
+    }
+
     kage::setConstants(mem);
 
-    kage::Binding binds[] =
+    if (kage::isValid(_mltc.sceneAddrBuf))
     {
-        { _mltc.meshletCmdBuf,          BindingAccess::read,        Stage::compute_shader },
-        { _mltc.meshBuf,                BindingAccess::read,        Stage::compute_shader },
-        { _mltc.meshDrawBuf,            BindingAccess::read,        Stage::compute_shader },
-        { _mltc.transformBuf,           BindingAccess::read,        Stage::compute_shader },
-        { _mltc.meshletBuf,             BindingAccess::read,        Stage::compute_shader },
-        { _mltc.meshletCmdCntBuf,       BindingAccess::read,        Stage::compute_shader },
-        { _mltc.meshletVisBuf,          BindingAccess::read_write,  Stage::compute_shader },
-        { _mltc.meshletPayloadBuf,      BindingAccess::write,       Stage::compute_shader },
-        { _mltc.meshletPayloadCntBuf,   BindingAccess::write,       Stage::compute_shader },
-        { _mltc.pyramid,                _mltc.pyrSampler,           Stage::compute_shader },
-    };
-    kage::pushBindings(binds, COUNTOF(binds));
+        // the meshes, meshlets and meshlet lods are in the address block, keep sync with culling_meshlet.h
+        kage::Binding binds[] =
+        {
+            { _mltc.meshletCmdBuf,          BindingAccess::read,        Stage::compute_shader },
+            { _mltc.sceneAddrBuf,           BindingAccess::read,        Stage::compute_shader },
+            { _mltc.meshDrawBuf,            BindingAccess::read,        Stage::compute_shader },
+            { _mltc.transformBuf,           BindingAccess::read,        Stage::compute_shader },
+            { _mltc.meshletCmdCntBuf,       BindingAccess::read,        Stage::compute_shader },
+            { _mltc.meshletVisBuf,          BindingAccess::read_write,  Stage::compute_shader },
+            { _mltc.meshletPayloadBuf,      BindingAccess::write,       Stage::compute_shader },
+            { _mltc.meshletPayloadCntBuf,   BindingAccess::write,       Stage::compute_shader },
+            { _mltc.pyramid,                _mltc.pyrSampler,           Stage::compute_shader },
+            { trivialAccept ? _mltc.triPayloadBuf : _mltc.meshletPayloadBuf, BindingAccess::read_write, Stage::compute_shader },
+            { trivialAccept ? _mltc.triCountBuf : _mltc.meshletPayloadCntBuf, BindingAccess::read_write, Stage::compute_shader },
+        };
+        kage::pushBindings(binds, COUNTOF(binds));
+    }
+    else
+    {
+        kage::Binding binds[] =
+        {
+            { _mltc.meshletCmdBuf,          BindingAccess::read,        Stage::compute_shader },
+            { _mltc.meshBuf,                BindingAccess::read,        Stage::compute_shader },
+            { _mltc.meshDrawBuf,            BindingAccess::read,        Stage::compute_shader },
+            { _mltc.transformBuf,           BindingAccess::read,        Stage::compute_shader },
+            { _mltc.meshletBuf,             BindingAccess::read,        Stage::compute_shader },
+            { _mltc.meshletCmdCntBuf,       BindingAccess::read,        Stage::compute_shader },
+            { _mltc.meshletVisBuf,          BindingAccess::read_write,  Stage::compute_shader },
+            { _mltc.meshletPayloadBuf,      BindingAccess::write,       Stage::compute_shader },
+            { _mltc.meshletPayloadCntBuf,   BindingAccess::write,       Stage::compute_shader },
+            { _mltc.pyramid,                _mltc.pyrSampler,           Stage::compute_shader },
+            // the meshlet buffer is only a placeholder for the seamless lod pipeline
+            { kage::isValid(_mltc.meshletLodBuf) ? _mltc.meshletLodBuf : _mltc.meshletBuf, BindingAccess::read, Stage::compute_shader },
+            // the meshlet payload buffers are only placeholders without trivial accept
+            { trivialAccept ? _mltc.triPayloadBuf : _mltc.meshletPayloadBuf, BindingAccess::read_write, Stage::compute_shader },
+            { trivialAccept ? _mltc.triCountBuf : _mltc.meshletPayloadCntBuf, BindingAccess::read_write, Stage::compute_shader },
+        };
+        kage::pushBindings(binds, COUNTOF(binds));
+    }
 
     kage::dispatchIndirect(_mltc.meshletCmdCntBuf, offsetof(IndirectDispatchCommand, x));
     kage::endRec();
@@ -294,13 +584,21 @@ void updateMeshletCulling(MeshletCulling& _mltc, const Constants& _consts)
 
 void initTriangleCulling(TriangleCulling& _tric, const TriangleCullingInitData& _initData, PassStage _stage, bool _seamless /*= false*/)
 {
-    kage::ShaderHandle cs = kage::registShader("triangle_culling", "shader/culling_triangle.comp.spv");
-    kage::ProgramHandle prog = kage::registProgram("triangle_culling", { cs }, sizeof(Constants));
+    const bool useSceneAddr = kage::isValid(_initData.sceneAddrBuf);
+
+    kage::ShaderHandle cs = useSceneAddr
+        ? kage::registShader("triangle_culling_addr", "shader/culling_triangle_addr.comp.spv")
+        : kage::registShader("triangle_culling", "shader/culling_triangle.comp.spv");
+    kage::ProgramHandle prog = kage::registProgram(useSceneAddr ? "triangle_culling_addr" : "triangle_culling", { cs }, sizeof(Constants));
+
+    // the payload comes from the meshlet culling if it has trivially accepted meshlets in
+    const bool trivialAccept = kage::isValid(_initData.triPayloadBuf) && kage::isValid(_initData.triCountBuf);
 
     int pipelineSpecs[] = {
         _stage == PassStage::late
         , _stage == PassStage::alpha
         , _seamless
+        , trivialAccept
     };
 
     const kage::Memory* pConst = kage::alloc(sizeof(int) * COUNTOF(pipelineSpecs));
@@ -315,18 +613,23 @@ void initTriangleCulling(TriangleCulling& _tric, const TriangleCullingInitData&
     std::string passName = getPassName("triangle_culling", _stage, RenderPipeline::mixed);
     kage::PassHandle pass = kage::registPass(passName.c_str(), passDesc);
 
-    kage::BufferDesc triPayloadBuf;
-    triPayloadBuf.size = 512 * 1024 * 1024; // 512M
-    triPayloadBuf.usage = kage::BufferUsageFlagBits::storage | kage::BufferUsageFlagBits::transfer_dst;
-    triPayloadBuf.memFlags = kage::MemoryPropFlagBits::device_local;
-    kage::BufferHandle triPayload = kage::registBuffer("tri_payload", triPayloadBuf);
-
-    // 2 dispatch indirect commands, 1st: for hardware rasterization, 2nd: for software rasterization
-    kage::BufferDesc  trianglePayloadCntDesc;
-    trianglePayloadCntDesc.size = sizeof(IndirectDispatchCommand) * 2;
-    trianglePayloadCntDesc.usage = kage::BufferUsageFlagBits::storage | kage::BufferUsageFlagBits::indirect | kage::BufferUsageFlagBits::transfer_dst;
-    trianglePayloadCntDesc.memFlags = kage::MemoryPropFlagBits::device_local;
-    kage::BufferHandle trianglePayloadCntBuf = kage::registBuffer("triangle_payload_cnt", trianglePayloadCntDesc);
+    kage::BufferHandle triPayload = _initData.triPayloadBuf;
+    kage::BufferHandle trianglePayloadCntBuf = _initData.triCountBuf;
+    if (!trivialAccept)
+    {
+        kage::BufferDesc triPayloadBuf;
+        triPayloadBuf.size = 512 * 1024 * 1024; // 512M
+        triPayloadBuf.usage = kage::BufferUsageFlagBits::storage | kage::BufferUsageFlagBits::transfer_dst;
+        triPayloadBuf.memFlags = kage::MemoryPropFlagBits::device_local;
+        triPayload = kage::registBuffer("tri_payload", triPayloadBuf);
+
+        // 2 dispatch indirect commands, 1st: for hardware rasterization, 2nd: for software rasterization
+        kage::BufferDesc  trianglePayloadCntDesc;
+        trianglePayloadCntDesc.size = sizeof(IndirectDispatchCommand) * 2;
+        trianglePayloadCntDesc.usage = kage::BufferUsageFlagBits::storage | kage::BufferUsageFlagBits::indirect | kage::BufferUsageFlagBits::transfer_dst;
+        trianglePayloadCntDesc.memFlags = kage::MemoryPropFlagBits::device_local;
+        trianglePayloadCntBuf = kage::registBuffer("triangle_payload_cnt", trianglePayloadCntDesc);
+    }
 
     kage::BufferHandle triPayloadBufOutAlias = kage::alias(triPayload);
     kage::BufferHandle trianglePayloadCntOutAlias = kage::alias(trianglePayloadCntBuf);
@@ -351,23 +654,34 @@ void initTriangleCulling(TriangleCulling& _tric, const TriangleCullingInitData&
         , Access::shader_read
     );
 
-    kage::bindBuffer(pass
-        , _initData.vtxBuf
-        , Stage::compute_shader
-        , Access::shader_read
-    );
+    if (useSceneAddr)
+    {
+        kage::bindBuffer(pass
+            , _initData.sceneAddrBuf
+            , Stage::compute_shader
+            , Access::shader_read
+        );
+    }
+    else
+    {
+        kage::bindBuffer(pass
+            , _initData.vtxBuf
+            , Stage::compute_shader
+            , Access::shader_read
+        );
 
-    kage::bindBuffer(pass
-        , _initData.meshletBuf
-        , Stage::compute_shader
-        , Access::shader_read
-    );
+        kage::bindBuffer(pass
+            , _initData.meshletBuf
+            , Stage::compute_shader
+            , Access::shader_read
+        );
 
-    kage::bindBuffer(pass
-        , _initData.meshletDataBuf
-        , Stage::compute_shader
-        , Access::shader_read
-    );
+        kage::bindBuffer(pass
+            , _initData.meshletDataBuf
+            , Stage::compute_shader
+            , Access::shader_read
+        );
+    }
 
     kage::bindBuffer(pass
         , _initData.meshletPayloadCntBuf
@@ -375,18 +689,22 @@ void initTriangleCulling(TriangleCulling& _tric, const TriangleCullingInitData&
         , Access::shader_read
     );
 
-    // write buffers
+    // write buffers, the hw count is accumulated on the accepted meshlets
+    const kage::AccessFlags triAccess = trivialAccept
+        ? Access::shader_read | Access::shader_write
+        : Access::shader_write;
+
     kage::bindBuffer(pass
         , triPayload
         , Stage::compute_shader
-        , Access::shader_write
+        , triAccess
         , triPayloadBufOutAlias
     );
 
     kage::bindBuffer(pass
         , trianglePayloadCntBuf
         , Stage::compute_shader
-        , Access::shader_write
+        , triAccess
         , trianglePayloadCntOutAlias
     );
 
@@ -404,6 +722,7 @@ void initTriangleCulling(TriangleCulling& _tric, const TriangleCullingInitData&
     _tric.pass = pass;
 
     _tric.stage = _stage;
+    _tric.trivialAccept = trivialAccept;
 
     // read-only
     _tric.meshletPayloadBuf = _initData.meshletPayloadBuf;
@@ -413,6 +732,7 @@ void initTriangleCulling(TriangleCulling& _tric, const TriangleCullingInitData&
     _tric.vtxBuf = _initData.vtxBuf;
     _tric.meshletBuf = _initData.meshletBuf;
     _tric.meshletDataBuf = _initData.meshletDataBuf;
+    _tric.sceneAddrBuf = _initData.sceneAddrBuf;
 
     _tric.pyramid = _initData.pyramid;
     _tric.pyrSampler = pyrSamp;
@@ -438,26 +758,46 @@ void recTriangleCulling(const TriangleCulling& _tric, const Constants& _consts)
     kage::startRec(_tric.pass);
     kage::setConstants(mem);
 
-    // clear payload buffer in late pass
-    if (PassStage::late == _tric.stage)
+    // clear payload buffer in late pass, the meshlet culling does it if the payload is shared
+    if (PassStage::late == _tric.stage && !_tric.trivialAccept)
     {
         kage::fillBuffer(_tric.triPayloadBuf, 0);
     }
 
-    kage::Binding binds[] =
+    const BindingAccess triAccess = _tric.trivialAccept ? BindingAccess::read_write : BindingAccess::write;
+    if (kage::isValid(_tric.sceneAddrBuf))
     {
-        { _tric.meshletPayloadBuf,      BindingAccess::read,        Stage::compute_shader },
-        { _tric.meshDrawBuf,            BindingAccess::read,        Stage::compute_shader },
-        { _tric.transformBuf,           BindingAccess::read,        Stage::compute_shader },
-        { _tric.vtxBuf,                 BindingAccess::read,        Stage::compute_shader },
-        { _tric.meshletBuf,             BindingAccess::read,        Stage::compute_shader },
-        { _tric.meshletDataBuf,         BindingAccess::read,        Stage::compute_shader },
-        { _tric.meshletPayloadCntBuf,   BindingAccess::read,        Stage::compute_shader },
-        { _tric.triPayloadBuf,          BindingAccess::write,       Stage::compute_shader },
-        { _tric.triCountBuf,            BindingAccess::write,       Stage::compute_shader },
-        { _tric.pyramid,                _tric.pyrSampler,           Stage::compute_shader }
-    };
-    kage::pushBindings(binds, COUNTOF(binds));
+        // the vertices, meshlets and meshlet data are in the address block, keep sync with culling_triangle.h
+        kage::Binding binds[] =
+        {
+            { _tric.meshletPayloadBuf,      BindingAccess::read,        Stage::compute_shader },
+            { _tric.meshDrawBuf,            BindingAccess::read,        Stage::compute_shader },
+            { _tric.transformBuf,           BindingAccess::read,        Stage::compute_shader },
+            { _tric.sceneAddrBuf,           BindingAccess::read,        Stage::compute_shader },
+            { _tric.meshletPayloadCntBuf,   BindingAccess::read,        Stage::compute_shader },
+            { _tric.triPayloadBuf,          triAccess,                  Stage::compute_shader },
+            { _tric.triCountBuf,            triAccess,                  Stage::compute_shader },
+            { _tric.pyramid,                _tric.pyrSampler,           Stage::compute_shader }
+        };
+        kage::pushBindings(binds, COUNTOF(binds));
+    }
+    else
+    {
+        kage::Binding binds[] =
+        {
+            { _tric.meshletPayloadBuf,      BindingAccess::read,        Stage::compute_shader },
+            { _tric.meshDrawBuf,            BindingAccess::read,        Stage::compute_shader },
+            { _tric.transformBuf,           BindingAccess::read,        Stage::compute_shader },
+            { _tric.vtxBuf,                 BindingAccess::read,        Stage::compute_shader },
+            { _tric.meshletBuf,             BindingAccess::read,        Stage::compute_shader },
+            { _tric.meshletDataBuf,         BindingAccess::read,        Stage::compute_shader },
+            { _tric.meshletPayloadCntBuf,   BindingAccess::read,        Stage::compute_shader },
+            { _tric.triPayloadBuf,          triAccess,                  Stage::compute_shader },
+            { _tric.triCountBuf,            triAccess,                  Stage::compute_shader },
+            { _tric.pyramid,                _tric.pyrSampler,           Stage::compute_shader }
+        };
+        kage::pushBindings(binds, COUNTOF(binds));
+    }
     
     kage::dispatchIndirect(_tric.meshletPayloadCntBuf, offsetof(IndirectDispatchCommand, x));
     kage::endRec();
@@ -14,6 +14,11 @@ struct MeshCullingInitData
     kage::BufferHandle meshDrawCmdBuf;
     kage::BufferHandle meshDrawCmdCountBuf;
     kage::BufferHandle meshDrawVisBuf;
+
+    uint32_t drawCount{ 0 };
+
+    // optional, from the cpu software occlusion
+    kage::BufferHandle swOcclusionVisBuf;
 };
 
 struct MeshCulling
@@ -22,10 +27,20 @@ struct MeshCulling
     kage::ProgramHandle prog;
     kage::PassHandle pass;
 
+    // draw command compaction
+    kage::ShaderHandle scanCs;
+    kage::ProgramHandle scanProg;
+    kage::PassHandle scanPass;
+
+    kage::ShaderHandle scatterCs;
+    kage::ProgramHandle scatterProg;
+    kage::PassHandle scatterPass;
+
     // read-only
     kage::BufferHandle meshBuf;
     kage::BufferHandle meshDrawBuf;
     kage::BufferHandle transBuf;
+    kage::BufferHandle swOcclusionVisBuf;
 
     kage::ImageHandle pyramid;
     kage::SamplerHandle pyrSampler;
@@ -35,6 +50,13 @@ struct MeshCulling
     kage::BufferHandle meshDrawCmdCountBuf;
     kage::BufferHandle meshDrawVisBuf;
 
+    // internal
+    kage::BufferHandle sortItemBuf;
+    kage::BufferHandle sortBinBuf;
+    kage::BufferHandle sortItemBufOutAlias;
+    kage::BufferHandle sortBinBufOutAlias;
+    kage::BufferHandle sortBinBufScanAlias;
+
     kage::BufferHandle cmdBufOutAlias;
     kage::BufferHandle cmdCountBufOutAlias;
     kage::BufferHandle meshDrawVisBufOutAlias;
@@ -50,9 +72,18 @@ struct MeshletCullingInitData
     kage::BufferHandle meshDrawBuf;
     kage::BufferHandle transformBuf;
     kage::BufferHandle meshletBuf;
+    kage::BufferHandle meshletLodBuf; // optional, per-meshlet lod bounds for the regular lod pipeline
     kage::BufferHandle meshletVisBuf;
 
     kage::ImageHandle pyramid;
+
+    // optional, the scene address block, see SceneAddressSlot
+    // the meshes, meshlets and meshlet lods are read through it instead of the bindings, the draws are still bound since they are animated
+    kage::BufferHandle sceneAddrBuf;
+
+    // meshlets fully inside the frustum and large on screen skip the triangle culling
+    // they are written to the triangle payload directly, which is owned by the meshlet culling then
+    bool trivialAccept{ false };
 };
 
 struct MeshletCulling
@@ -68,6 +99,8 @@ struct MeshletCulling
     kage::BufferHandle meshDrawBuf;
     kage::BufferHandle transformBuf;
     kage::BufferHandle meshletBuf;
+    kage::BufferHandle meshletLodBuf;
+    kage::BufferHandle sceneAddrBuf;
 
     kage::ImageHandle pyramid;
     kage::SamplerHandle pyrSampler;
@@ -78,11 +111,17 @@ struct MeshletCulling
     // write
     kage::BufferHandle meshletPayloadBuf;
     kage::BufferHandle meshletPayloadCntBuf;
+    kage::BufferHandle triPayloadBuf; // only valid with trivial accept
+    kage::BufferHandle triCountBuf;
+
+    PassStage stage;
 
     // out alias
     kage::BufferHandle meshletVisBufOutAlias;
     kage::BufferHandle cmdBufOutAlias;
     kage::BufferHandle cmdCountBufOutAlias;
+    kage::BufferHandle triPayloadBufOutAlias;
+    kage::BufferHandle triCountBufOutAlias;
 };
 
 struct TriangleCullingInitData
@@ -99,7 +138,15 @@ struct TriangleCullingInitData
     kage::BufferHandle meshletBuf;
     kage::BufferHandle meshletDataBuf;
 
+    // optional, the triangle payload from the meshlet culling with trivially accepted meshlets in
+    kage::BufferHandle triPayloadBuf;
+    kage::BufferHandle triCountBuf;
+
     kage::ImageHandle pyramid;
+
+    // optional, the scene address block, see SceneAddressSlot
+    // the vertices, meshlets and meshlet data are read through it instead of the bindings
+    kage::BufferHandle sceneAddrBuf;
 };
 
 struct TriangleCulling
@@ -109,6 +156,7 @@ struct TriangleCulling
     kage::ProgramHandle prog;
 
     PassStage stage;
+    bool trivialAccept{ false };
 
     // read-only
     kage::BufferHandle meshletPayloadBuf;
@@ -118,6 +166,7 @@ struct TriangleCulling
     kage::BufferHandle vtxBuf;
     kage::BufferHandle meshletBuf;
     kage::BufferHandle meshletDataBuf;
+    kage::BufferHandle sceneAddrBuf;
 
     kage::ImageHandle pyramid;
     kage::SamplerHandle pyrSampler;
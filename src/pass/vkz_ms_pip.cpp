@@ -25,7 +25,9 @@ void meshShadingRec(const MeshShading& _ms)
         {_ms.meshletBuffer,     BindingAccess::read,       Stage::task_shader | Stage::mesh_shader},
         {_ms.meshletDataBuffer, BindingAccess::read,       Stage::task_shader | Stage::mesh_shader},
         {_ms.meshletVisBuffer,  BindingAccess::read_write, Stage::task_shader | Stage::mesh_shader},
-        {_ms.pyramid,       _ms.pyramidSampler,     Stage::task_shader | Stage::mesh_shader}
+        {_ms.pyramid,       _ms.pyramidSampler,     Stage::task_shader | Stage::mesh_shader},
+        // the meshlet buffer is only a placeholder for the seamless lod pipeline
+        {kage::isValid(_ms.meshletLodBuffer) ? _ms.meshletLodBuffer : _ms.meshletBuffer, BindingAccess::read, Stage::task_shader},
     };
 
     kage::startRec(_ms.pass);
@@ -40,14 +42,15 @@ void meshShadingRec(const MeshShading& _ms)
 
     bool is_early = (PassStage::early == _ms.stage);
 
-    kage::Attachment attachments[] = {
-        {_ms.g_buffer.albedo,   is_early ? LoadOp::clear : LoadOp::dont_care, StoreOp::store},
-        {_ms.g_buffer.normal,   is_early ? LoadOp::clear : LoadOp::dont_care, StoreOp::store},
-        {_ms.g_buffer.worldPos, is_early ? LoadOp::clear : LoadOp::dont_care, StoreOp::store},
-        {_ms.g_buffer.emissive, is_early ? LoadOp::clear : LoadOp::dont_care, StoreOp::store},
-        {_ms.g_buffer.specular, is_early ? LoadOp::clear : LoadOp::dont_care, StoreOp::store},
-    };
-    kage::setColorAttachments(attachments, COUNTOF(attachments));
+    kage::ImageHandle gbImgs[kMaxGBufferImages];
+    const uint32_t gbCount = getGBufferImages(_ms.g_buffer, gbImgs);
+
+    kage::Attachment attachments[kMaxGBufferImages];
+    for (uint32_t ii = 0; ii < gbCount; ++ii)
+    {
+        attachments[ii] = { gbImgs[ii], is_early ? LoadOp::clear : LoadOp::dont_care, StoreOp::store };
+    }
+    kage::setColorAttachments(attachments, (uint16_t)gbCount);
 
     kage::Attachment depthAttachment = { 
         _ms.depth
@@ -68,7 +71,8 @@ void prepareMeshShading(MeshShading& _meshShading, const Scene& _scene, uint32_t
 
     kage::ShaderHandle ms= kage::registShader("mesh_shader", "shader/meshlet.mesh.spv");
     kage::ShaderHandle ts = kage::registShader("task_shader", "shader/meshlet.task.spv");
-    kage::ShaderHandle fs = kage::registShader("mesh_frag_shader", "shader/bindless.frag.spv");
+    const bool compactGBuf = (GBufferLayout::compact == _initData.g_buffer.layout);
+    kage::ShaderHandle fs = kage::registShader(compactGBuf ? "mesh_frag_shader_compact" : "mesh_frag_shader", getGBufferFragShaderPath(_initData.g_buffer.layout));
 
     kage::ProgramHandle prog = kage::registProgram("mesh_prog", { ts, ms, fs }, sizeof(Constants), _initData.bindless);
 
@@ -126,6 +130,13 @@ void prepareMeshShading(MeshShading& _meshShading, const Scene& _scene, uint32_t
         , Stage::task_shader
         , Access::shader_read);
 
+    if (kage::isValid(_initData.meshletLodBuffer))
+    {
+        kage::bindBuffer(pass, _initData.meshletLodBuffer
+            , Stage::task_shader
+            , Access::shader_read);
+    }
+
     kage::bindBuffer(pass, _initData.meshletVisBuffer
         , Stage::task_shader
         , Access::shader_read | Access::shader_write
@@ -145,11 +156,14 @@ void prepareMeshShading(MeshShading& _meshShading, const Scene& _scene, uint32_t
     kage::setAttachmentOutput(pass, _initData.depth, depthOutAlias);
 
     // bind g-buffer
-    kage::setAttachmentOutput(pass, _initData.g_buffer.albedo, gb_outAlias.albedo);
-    kage::setAttachmentOutput(pass, _initData.g_buffer.normal, gb_outAlias.normal);
-    kage::setAttachmentOutput(pass, _initData.g_buffer.worldPos, gb_outAlias.worldPos);
-    kage::setAttachmentOutput(pass, _initData.g_buffer.emissive, gb_outAlias.emissive);
-    kage::setAttachmentOutput(pass, _initData.g_buffer.specular, gb_outAlias.specular);
+    kage::ImageHandle gbImgs[kMaxGBufferImages];
+    kage::ImageHandle gbOutAliases[kMaxGBufferImages];
+    const uint32_t gbCount = getGBufferImages(_initData.g_buffer, gbImgs);
+    getGBufferImages(gb_outAlias, gbOutAliases);
+    for (uint32_t ii = 0; ii < gbCount; ++ii)
+    {
+        kage::setAttachmentOutput(pass, gbImgs[ii], gbOutAliases[ii]);
+    }
 
     // set the data
     _meshShading.stage = _stage;
@@ -163,6 +177,7 @@ void prepareMeshShading(MeshShading& _meshShading, const Scene& _scene, uint32_t
     _meshShading.vtxBuffer = _initData.vtxBuffer;
     _meshShading.meshBuffer = _initData.meshBuffer;
     _meshShading.meshletBuffer = _initData.meshletBuffer;
+    _meshShading.meshletLodBuffer = _initData.meshletLodBuffer;
     _meshShading.meshletDataBuffer = _initData.meshletDataBuffer;
     _meshShading.meshDrawCmdBuffer = _initData.meshDrawCmdBuffer;
     _meshShading.meshDrawCmdCountBuffer = _initData.meshDrawCmdCountBuffer;
@@ -181,11 +196,26 @@ void prepareMeshShading(MeshShading& _meshShading, const Scene& _scene, uint32_t
     _meshShading.meshletVisBufferOutAlias = mltVisBufOutAlias;
     _meshShading.depthOutAlias = depthOutAlias;
     _meshShading.g_bufferOutAlias = gb_outAlias;
+
+    _meshShading.pipelineConfig = desc.pipelineConfig;
+
+    kage::GraphicsPipelineConfig lineConfig = desc.pipelineConfig;
+    lineConfig.polygonMode = kage::PolygonMode::line;
+    kage::precompilePassVariant(pass, lineConfig);
 }
 
-void updateMeshShading(MeshShading& _meshShading, const Constants& _consts)
+void updateMeshShading(MeshShading& _meshShading, const Constants& _consts, bool _wireframe /*= false*/)
 {
     _meshShading.constants = _consts;
 
+    if (_wireframe != _meshShading.wireframe)
+    {
+        kage::GraphicsPipelineConfig config = _meshShading.pipelineConfig;
+        config.polygonMode = _wireframe ? kage::PolygonMode::line : kage::PolygonMode::fill;
+        kage::setPassVariant(_meshShading.pass, config);
+
+        _meshShading.wireframe = _wireframe;
+    }
+
     meshShadingRec(_meshShading);
 }
\ No newline at end of file
@@ -10,6 +10,7 @@ struct MeshShadingInitData
     kage::BufferHandle vtxBuffer;
     kage::BufferHandle meshBuffer;
     kage::BufferHandle meshletBuffer;
+    kage::BufferHandle meshletLodBuffer; // optional, per-meshlet lod bounds for the regular lod pipeline
     kage::BufferHandle meshletDataBuffer;
     kage::BufferHandle meshDrawBuffer;
 
@@ -44,6 +45,7 @@ struct MeshShading
     kage::BufferHandle vtxBuffer;
     kage::BufferHandle meshBuffer;
     kage::BufferHandle meshletBuffer;
+    kage::BufferHandle meshletLodBuffer;
     kage::BufferHandle meshletDataBuffer;
     kage::BufferHandle meshDrawCmdBuffer;
     kage::BufferHandle meshDrawCmdCountBuffer;
@@ -74,9 +76,13 @@ struct MeshShading
     GBuffer g_bufferOutAlias;
 
     Constants constants;
+
+    // the wireframe is a pipeline variant of the pass, it is precompiled at the prepare
+    kage::GraphicsPipelineConfig pipelineConfig;
+    bool wireframe{ false };
 };
 
 
 void prepareMeshShading(MeshShading& _meshShading, const Scene& _scene, uint32_t _width, uint32_t _height, const MeshShadingInitData _initData, const PassStage _stage);
 
-void updateMeshShading(MeshShading& _meshShading, const Constants& _consts);
\ No newline at end of file
+void updateMeshShading(MeshShading& _meshShading, const Constants& _consts, bool _wireframe = false);
\ No newline at end of file
@@ -3,8 +3,15 @@
 #include "core/kage.h"
 #include "core/kage_math.h"
 #include "core/file_helper.h"
+#include "demo_structs.h" // for IndirectDispatchCommand
 #include "bx/bx.h"
 
+// the tile buffers cover 8k, larger targets are not supported in the tiled mode
+static uint32_t getSMAATileCount(uint32_t _width, uint32_t _height)
+{
+    return ((_width + kSMAATileSize - 1) / kSMAATileSize) * ((_height + kSMAATileSize - 1) / kSMAATileSize);
+}
+
 
 void prepare(SMAAEdgeDepth& _edge, uint32_t _width, uint32_t _height, kage::ImageHandle _inDepth)
 {
@@ -144,9 +151,110 @@ void prepare(SMAAEdgeLuma& _edge, uint32_t _width, uint32_t _height, kage::Image
     _edge.lumaOutAlias = edgeOutAlias;
 }
 
-void prepare(SMAAWeight& _weight, uint32_t _width, uint32_t _height, kage::ImageHandle _inEdge)
+void prepare(SMAAEdgeTiles& _edge, uint32_t _width, uint32_t _height, kage::ImageHandle _inColor, SMAAEdgeSource _source)
+{
+    const char* spvPathes[] =
+    {
+        "shader/smaa_edge_tiles.comp.spv",
+        "shader/smaa_edge_tiles_color.comp.spv",
+        "shader/smaa_edge_tiles_depth.comp.spv",
+    };
+    kage::ShaderHandle cs = kage::registShader("smaa_edge_tiles", spvPathes[(uint32_t)_source]);
+    kage::ProgramHandle prog = kage::registProgram("smaa_edge_tiles", { cs }, sizeof(glm::vec2));
+    kage::PassDesc passDesc{};
+    passDesc.prog = prog;
+    passDesc.queue = kage::PassExeQueue::compute;
+    kage::PassHandle pass = kage::registPass("smaa_edge_tiles", passDesc);
+
+    // edge, the same desc as the weight and the blend so the framegraph can alias it with the blend
+    kage::ImageDesc desc{};
+    desc.width = _width;
+    desc.height = _height;
+    desc.format = kage::ResourceFormat::r8g8b8a8_unorm;
+    desc.depth = 1;
+    desc.numLayers = 1;
+    desc.numMips = 1;
+    desc.usage = ImgUsage::sampled | ImgUsage::storage | ImgUsage::transfer_src | ImgUsage::color_attachment;
+    kage::ImageHandle edge = kage::registTexture("smaa_edge_tiles", desc, nullptr, kage::ResourceLifetime::transition);
+
+    const uint32_t tileCapacity = glm::max(getSMAATileCount(_width, _height), getSMAATileCount(7680, 4320));
+
+    kage::BufferDesc tileDesc{};
+    tileDesc.size = tileCapacity * sizeof(uint32_t);
+    tileDesc.usage = BufUsage::storage | BufUsage::transfer_dst;
+    kage::BufferHandle tileMask = kage::registBuffer("smaa_tile_mask", tileDesc);
+    kage::BufferHandle tileList = kage::registBuffer("smaa_tile_list", tileDesc);
+
+    kage::BufferDesc cmdDesc{};
+    cmdDesc.size = sizeof(IndirectDispatchCommand);
+    cmdDesc.usage = BufUsage::indirect | BufUsage::storage | BufUsage::transfer_dst;
+    kage::BufferHandle tileCmd = kage::registBuffer("smaa_tile_cmd", cmdDesc);
+
+    _edge.prog = prog;
+    _edge.pass = pass;
+    _edge.cs = cs;
+
+    _edge.source = _source;
+    _edge.inColor = _inColor;
+    _edge.sampler = kage::sampleImage(_edge.pass, _inColor
+        , Stage::compute_shader
+        , kage::SamplerFilter::nearest
+        , kage::SamplerMipmapMode::nearest
+        , kage::SamplerAddressMode::clamp_to_edge
+        , kage::SamplerReductionMode::weighted_average
+    );
+
+    kage::ImageHandle edgeOutAlias = kage::alias(edge);
+    kage::bindImage(_edge.pass, edge
+        , Stage::compute_shader
+        , Access::shader_write
+        , kage::ImageLayout::general
+        , edgeOutAlias
+    );
+
+    kage::BufferHandle tileMaskOutAlias = kage::alias(tileMask);
+    kage::bindBuffer(_edge.pass, tileMask
+        , Stage::compute_shader
+        , Access::shader_write
+        , tileMaskOutAlias
+    );
+
+    kage::BufferHandle tileListOutAlias = kage::alias(tileList);
+    kage::bindBuffer(_edge.pass, tileList
+        , Stage::compute_shader
+        , Access::shader_write
+        , tileListOutAlias
+    );
+
+    kage::BufferHandle tileCmdOutAlias = kage::alias(tileCmd);
+    kage::bindBuffer(_edge.pass, tileCmd
+        , Stage::compute_shader
+        , Access::shader_read | Access::shader_write
+        , tileCmdOutAlias
+    );
+
+    _edge.edge = edge;
+    _edge.tileMask = tileMask;
+    _edge.tileList = tileList;
+    _edge.tileCmd = tileCmd;
+
+    _edge.edgeOutAlias = edgeOutAlias;
+    _edge.tileMaskOutAlias = tileMaskOutAlias;
+    _edge.tileListOutAlias = tileListOutAlias;
+    _edge.tileCmdOutAlias = tileCmdOutAlias;
+
+    _edge.tileCapacity = tileCapacity;
+}
+
+// with the tile list, the weights are only calculated in the tiles with edges
+void prepare(SMAAWeight& _weight, uint32_t _width, uint32_t _height, kage::ImageHandle _inEdge
+    , kage::BufferHandle _tileList = {}, kage::BufferHandle _tileCmd = {})
 {
-    kage::ShaderHandle cs = kage::registShader("smaa_weight", "shader/smaa_weight.comp.spv");
+    const bool tiled = kage::isValid(_tileList);
+
+    kage::ShaderHandle cs = tiled
+        ? kage::registShader("smaa_weight_tiles", "shader/smaa_weight_tiles.comp.spv")
+        : kage::registShader("smaa_weight", "shader/smaa_weight.comp.spv");
     kage::ProgramHandle prog = kage::registProgram("smaa_weight_prog", { cs }, sizeof(SMAAWeightConstants));
     kage::PassDesc passDesc{};
     passDesc.prog = prog;
@@ -213,6 +321,16 @@ void prepare(SMAAWeight& _weight, uint32_t _width, uint32_t _height, kage::Image
         , weightOutAlias
     );
 
+    if (tiled)
+    {
+        kage::bindBuffer(_weight.pass, _tileList
+            , Stage::compute_shader
+            , Access::shader_read
+        );
+
+        kage::setIndirectBuffer(_weight.pass, _tileCmd);
+    }
+
     _weight.data.imageSize[0] = _width;
     _weight.data.imageSize[1] = _height;
 
@@ -223,12 +341,21 @@ void prepare(SMAAWeight& _weight, uint32_t _width, uint32_t _height, kage::Image
 
     _weight.weight = weight;
     _weight.weightOutAlias = weightOutAlias;
+
+    _weight.tileList = _tileList;
+    _weight.tileCmd = _tileCmd;
 }
 
-void prepare(SMAABlend& _blend, uint32_t _width, uint32_t _height, kage::ImageHandle _inColor, kage::ImageHandle _inWeight)
+// with the tile mask, the weights of the tiles without edges are skipped
+void prepare(SMAABlend& _blend, uint32_t _width, uint32_t _height, kage::ImageHandle _inColor, kage::ImageHandle _inWeight
+    , kage::BufferHandle _tileMask = {})
 {
-    kage::ShaderHandle cs = kage::registShader("smaa_blend", "shader/smaa_blend.comp.spv");
-    kage::ProgramHandle prog = kage::registProgram("smaa_blend_prog", { cs }, sizeof(glm::vec2));
+    const bool tiled = kage::isValid(_tileMask);
+
+    kage::ShaderHandle cs = tiled
+        ? kage::registShader("smaa_blend_tiles", "shader/smaa_blend_tiles.comp.spv")
+        : kage::registShader("smaa_blend", "shader/smaa_blend.comp.spv");
+    kage::ProgramHandle prog = kage::registProgram("smaa_blend_prog", { cs }, tiled ? sizeof(SMAABlendTileConstants) : sizeof(glm::vec2));
     kage::PassDesc passDesc{};
     passDesc.prog = prog;
     passDesc.queue = kage::PassExeQueue::compute;
@@ -275,8 +402,18 @@ void prepare(SMAABlend& _blend, uint32_t _width, uint32_t _height, kage::ImageHa
         , blendOutAlias
     );
 
+    if (tiled)
+    {
+        kage::bindBuffer(_blend.pass, _tileMask
+            , Stage::compute_shader
+            , Access::shader_read
+        );
+    }
+
     _blend.blend = blend;
     _blend.blendOutAlias = blendOutAlias;
+
+    _blend.tileMask = _tileMask;
 }
 
 void recordCmd(const SMAAEdgeColor& _edge, uint32_t _width, uint32_t _height)
@@ -339,6 +476,33 @@ void recordCmd(const SMAAEdgeLuma& _edge, uint32_t _width, uint32_t _height)
     kage::endRec();
 }
 
+void recordCmd(const SMAAEdgeTiles& _edge, uint32_t _width, uint32_t _height)
+{
+    KG_ZoneScopedC(kage::Color::blue);
+    kage::startRec(_edge.pass);
+
+    assert(getSMAATileCount(_width, _height) <= _edge.tileCapacity);
+
+    vec2 resolution = vec2(_width, _height);
+    const kage::Memory* mem = kage::alloc(sizeof(vec2));
+    bx::memCopy(mem->data, &resolution, mem->size);
+    kage::setConstants(mem);
+
+    kage::fillBuffer(_edge.tileCmd, 0);
+
+    kage::Binding binds[] =
+    {
+        {_edge.inColor,     _edge.sampler,              Stage::compute_shader},
+        {_edge.edge,        0,                          Stage::compute_shader},
+        {_edge.tileMask,    BindingAccess::write,       Stage::compute_shader},
+        {_edge.tileList,    BindingAccess::write,       Stage::compute_shader},
+        {_edge.tileCmd,     BindingAccess::read_write,  Stage::compute_shader},
+    };
+    kage::pushBindings(binds, COUNTOF(binds));
+    kage::dispatch(_width, _height, 1);
+    kage::endRec();
+}
+
 void recordCmd(const SMAAWeight& _weight)
 {
     KG_ZoneScopedC(kage::Color::blue);
@@ -349,6 +513,25 @@ void recordCmd(const SMAAWeight& _weight)
 
     kage::setConstants(mem);
 
+    if (kage::isValid(_weight.tileList))
+    {
+        kage::Binding binds[] =
+        {
+            {_weight.inEdge,    _weight.edgeSampler,        Stage::compute_shader},
+            {_weight.inEdge,    _weight.edgeNearestSampler, Stage::compute_shader},
+            {_weight.areaImg,   _weight.areaSampler,        Stage::compute_shader},
+            {_weight.searchImg, _weight.searchSampler,      Stage::compute_shader},
+            {_weight.weight,    0,                          Stage::compute_shader},
+            {_weight.tileList,  BindingAccess::read,        Stage::compute_shader},
+        };
+        kage::pushBindings(binds, COUNTOF(binds));
+
+        // a workgroup per edge tile
+        kage::dispatchIndirect(_weight.tileCmd, offsetof(IndirectDispatchCommand, x));
+        kage::endRec();
+        return;
+    }
+
     kage::Binding binds[] =
     {
         {_weight.inEdge,    _weight.edgeSampler,        Stage::compute_shader},
@@ -369,6 +552,31 @@ void recordCmd(const SMAABlend& _blend, uint32_t _width, uint32_t _height)
 {
     KG_ZoneScopedC(kage::Color::blue);
     kage::startRec(_blend.pass);
+
+    if (kage::isValid(_blend.tileMask))
+    {
+        SMAABlendTileConstants consts{};
+        consts.imageSize[0] = float(_width);
+        consts.imageSize[1] = float(_height);
+        consts.tileCountX = (_width + kSMAATileSize - 1) / kSMAATileSize;
+
+        const kage::Memory* mem = kage::alloc(sizeof(SMAABlendTileConstants));
+        bx::memCopy(mem->data, &consts, mem->size);
+        kage::setConstants(mem);
+
+        kage::Binding binds[] =
+        {
+            {_blend.inWeight,   _blend.weightSamper,    Stage::compute_shader},
+            {_blend.inColor,    _blend.colorSampler,    Stage::compute_shader},
+            {_blend.blend,      0,                      Stage::compute_shader},
+            {_blend.tileMask,   BindingAccess::read,    Stage::compute_shader},
+        };
+        kage::pushBindings(binds, COUNTOF(binds));
+        kage::dispatch(_width, _height, 1);
+        kage::endRec();
+        return;
+    }
+
     vec2 resolution = vec2(_width, _height);
     const kage::Memory* mem = kage::alloc(sizeof(vec2));
     bx::memCopy(mem->data, &resolution, mem->size);
@@ -386,15 +594,29 @@ void recordCmd(const SMAABlend& _blend, uint32_t _width, uint32_t _height)
 }
 
 
-void SMAA::prepare(uint32_t _width, uint32_t _height, kage::ImageHandle _inColor, kage::ImageHandle _inDepth)
+void SMAA::prepare(uint32_t _width, uint32_t _height, kage::ImageHandle _inColor, kage::ImageHandle _inDepth, SMAAMode _mode /*= SMAAMode::three_pass*/
+    , SMAAEdgeSource _edgeSource /*= SMAAEdgeSource::luma*/)
 {
-    ::prepare(m_edgeDepth, _width, _height, _inDepth);
-    ::prepare(m_edgeColor, _width, _height, _inColor);
-    ::prepare(m_edgeLuma, _width, _height, _inColor);
+    if (SMAAMode::tiled == _mode)
+    {
+        const kage::ImageHandle edgeIn = (SMAAEdgeSource::depth == _edgeSource) ? _inDepth : _inColor;
+        ::prepare(m_edgeTiles, _width, _height, edgeIn, _edgeSource);
 
-    ::prepare(m_weight, _width, _height, m_edgeLuma.lumaOutAlias);
-    ::prepare(m_blend, _width, _height, _inColor, m_weight.weightOutAlias);
+        ::prepare(m_weight, _width, _height, m_edgeTiles.edgeOutAlias, m_edgeTiles.tileListOutAlias, m_edgeTiles.tileCmdOutAlias);
+        ::prepare(m_blend, _width, _height, _inColor, m_weight.weightOutAlias, m_edgeTiles.tileMaskOutAlias);
+    }
+    else
+    {
+        ::prepare(m_edgeDepth, _width, _height, _inDepth);
+        ::prepare(m_edgeColor, _width, _height, _inColor);
+        ::prepare(m_edgeLuma, _width, _height, _inColor);
+
+        ::prepare(m_weight, _width, _height, m_edgeLuma.lumaOutAlias);
+        ::prepare(m_blend, _width, _height, _inColor, m_weight.weightOutAlias);
+    }
 
+    m_mode = _mode;
+    m_edgeSource = _edgeSource;
     m_w = _width;
     m_h = _height;
     m_outAliasImg = m_blend.blendOutAlias;
@@ -402,6 +624,8 @@ void SMAA::prepare(uint32_t _width, uint32_t _height, kage::ImageHandle _inColor
 
 void SMAA::update(uint32_t _rtWidth, uint32_t _rtHeight)
 {
+    const bool tiled = (SMAAMode::tiled == m_mode);
+
     if (_rtWidth != m_w || _rtHeight != m_h)
     {
         m_w = _rtWidth;
@@ -410,17 +634,49 @@ void SMAA::update(uint32_t _rtWidth, uint32_t _rtHeight)
         m_weight.data.imageSize[0] = _rtWidth;
         m_weight.data.imageSize[1] = _rtHeight;
 
-        kage::updateImage(m_edgeDepth.depth, _rtWidth, _rtHeight);
-        kage::updateImage(m_edgeColor.color, _rtWidth, _rtHeight);
-        kage::updateImage(m_edgeLuma.luma, _rtWidth, _rtHeight);
+        if (tiled)
+        {
+            kage::updateImage(m_edgeTiles.edge, _rtWidth, _rtHeight);
+        }
+        else
+        {
+            kage::updateImage(m_edgeDepth.depth, _rtWidth, _rtHeight);
+            kage::updateImage(m_edgeColor.color, _rtWidth, _rtHeight);
+            kage::updateImage(m_edgeLuma.luma, _rtWidth, _rtHeight);
+        }
 
         kage::updateImage(m_weight.weight, _rtWidth, _rtHeight);
         kage::updateImage(m_blend.blend, _rtWidth, _rtHeight);
     }
 
-    recordCmd(m_edgeDepth, m_w, m_h);
-    recordCmd(m_edgeColor, m_w, m_h);
-    recordCmd(m_edgeLuma, m_w, m_h);
+    if (tiled)
+    {
+        recordCmd(m_edgeTiles, m_w, m_h);
+    }
+    else
+    {
+        recordCmd(m_edgeDepth, m_w, m_h);
+        recordCmd(m_edgeColor, m_w, m_h);
+        recordCmd(m_edgeLuma, m_w, m_h);
+    }
     recordCmd(m_weight);
     recordCmd(m_blend, m_w, m_h);
 }
+
+double SMAA::getTime() const
+{
+    double time = kage::getPassTime(m_weight.pass) + kage::getPassTime(m_blend.pass);
+
+    if (SMAAMode::tiled == m_mode)
+    {
+        time += kage::getPassTime(m_edgeTiles.pass);
+    }
+    else
+    {
+        time += kage::getPassTime(m_edgeDepth.pass)
+            + kage::getPassTime(m_edgeColor.pass)
+            + kage::getPassTime(m_edgeLuma.pass);
+    }
+
+    return time;
+}
@@ -3,6 +3,23 @@
 #include "core/common.h"
 #include "core/kage.h"
 
+// the tiled mode runs the weights only in the tiles with edges, keep sync with smaa_inno.h
+constexpr uint32_t kSMAATileSize = 8;
+
+enum class SMAAMode : uint8_t
+{
+    three_pass, // depth, color and luma edges, weights and blend over the full screen
+    tiled,      // the edges emit the edge tiles, the weights are dispatched indirectly over them
+};
+
+// the edges of the tiled mode, keep sync with SMAA_EDGE_SOURCE in smaa_edge_tiles.h
+enum class SMAAEdgeSource : uint8_t
+{
+    luma,
+    color,
+    depth,
+};
+
 struct SMAAEdgeDepth
 {
     kage::PassHandle pass{ kage::kInvalidHandle };
@@ -42,6 +59,30 @@ struct SMAAEdgeLuma
     kage::ImageHandle lumaOutAlias{ kage::kInvalidHandle };
 };
 
+// edges of the tiled mode, also writes a flag per tile and appends the edge tiles to a list
+struct SMAAEdgeTiles
+{
+    kage::PassHandle pass{ kage::kInvalidHandle };
+    kage::ProgramHandle prog{ kage::kInvalidHandle };
+    kage::ShaderHandle cs{ kage::kInvalidHandle };
+
+    SMAAEdgeSource source{ SMAAEdgeSource::luma };
+    kage::ImageHandle inColor{ kage::kInvalidHandle }; // the depth with the depth source
+    kage::SamplerHandle sampler{ kage::kInvalidHandle };
+
+    kage::ImageHandle edge{ kage::kInvalidHandle };
+    kage::BufferHandle tileMask{ kage::kInvalidHandle };
+    kage::BufferHandle tileList{ kage::kInvalidHandle };
+    kage::BufferHandle tileCmd{ kage::kInvalidHandle };
+
+    kage::ImageHandle edgeOutAlias{ kage::kInvalidHandle };
+    kage::BufferHandle tileMaskOutAlias{ kage::kInvalidHandle };
+    kage::BufferHandle tileListOutAlias{ kage::kInvalidHandle };
+    kage::BufferHandle tileCmdOutAlias{ kage::kInvalidHandle };
+
+    uint32_t tileCapacity{ 0 };
+};
+
 struct alignas(16) SMAAWeightConstants
 {
     uint32_t imageSize[2]{ 0, 0 };
@@ -67,9 +108,20 @@ struct SMAAWeight
     kage::ImageHandle weight{ kage::kInvalidHandle };
     kage::ImageHandle weightOutAlias{ kage::kInvalidHandle };
 
+    // tiled mode only
+    kage::BufferHandle tileList{ kage::kInvalidHandle };
+    kage::BufferHandle tileCmd{ kage::kInvalidHandle };
+
     SMAAWeightConstants data{};
 };
 
+struct alignas(16) SMAABlendTileConstants
+{
+    float imageSize[2]{ 0.f, 0.f };
+    uint32_t tileCountX{ 0 };
+    uint32_t padding0{ 0 };
+};
+
 struct SMAABlend
 {
     kage::PassHandle pass{ kage::kInvalidHandle };
@@ -84,6 +136,9 @@ struct SMAABlend
 
     kage::ImageHandle blend{ kage::kInvalidHandle };
     kage::ImageHandle blendOutAlias{ kage::kInvalidHandle };
+
+    // tiled mode only, the weights are only valid in the tiles with edges
+    kage::BufferHandle tileMask{ kage::kInvalidHandle };
 };
 
 struct SMAA
@@ -93,14 +148,23 @@ struct SMAA
     SMAAEdgeLuma m_edgeLuma;
     SMAAWeight m_weight;
     SMAABlend m_blend;
+    SMAAEdgeTiles m_edgeTiles;
+
+    SMAAMode m_mode{ SMAAMode::three_pass };
+    SMAAEdgeSource m_edgeSource{ SMAAEdgeSource::luma }; // tiled mode only
 
     uint32_t m_w{ 0 };
     uint32_t m_h{ 0 };
 
     kage::ImageHandle m_outAliasImg{ kage::kInvalidHandle };
 
-    void prepare(uint32_t _width, uint32_t _height, kage::ImageHandle _inColor, kage::ImageHandle _inDepth);
+    // the passes of the mode are registered only
+    void prepare(uint32_t _width, uint32_t _height, kage::ImageHandle _inColor, kage::ImageHandle _inDepth, SMAAMode _mode = SMAAMode::three_pass
+        , SMAAEdgeSource _edgeSource = SMAAEdgeSource::luma);
     void update(uint32_t _rtWidth, uint32_t _rtHeight);
+
+    // the gpu time of all the passes of the mode
+    double getTime() const;
 };
 
 struct AntiAliasingPass
@@ -0,0 +1,629 @@
+#include "vkz_sw_occlusion.h"
+#include "vkz_pass.h"
+#include "bx/timer.h"
+
+#include <thread>
+#include <algorithm>
+#include <cfloat>
+#include <cassert>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define KG_SW_OCCLUSION_SSE 1
+#   include <emmintrin.h>
+#else
+#   define KG_SW_OCCLUSION_SSE 0
+#endif
+
+constexpr uint32_t kSoftOcclusionTileSize = 8;
+
+// same as the rotateQuat in shader/math.h
+static vec3 rotateQuat(const vec3& _v, const quat& _q)
+{
+    vec3 qv = vec3(_q.x, _q.y, _q.z);
+    return _v + 2.f * glm::cross(qv, glm::cross(qv, _v) + _q.w * _v);
+}
+
+static float maxElem(const vec3& _v)
+{
+    return glm::max(glm::max(_v.x, _v.y), _v.z);
+}
+
+// same as the projectSphere in shader/math.h, output aabb in uv space
+static bool projectSphere(const vec3& _c, float _r, float _znear, float _P00, float _P11, vec4& _aabb)
+{
+    if (_c.z < _r + _znear)
+        return false;
+
+    vec3 cr = _c * _r;
+    float czr2 = _c.z * _c.z - _r * _r;
+
+    float vx = sqrtf(_c.x * _c.x + czr2);
+    float minx = (vx * _c.x - cr.z) / (vx * _c.z + cr.x);
+    float maxx = (vx * _c.x + cr.z) / (vx * _c.z - cr.x);
+
+    float vy = sqrtf(_c.y * _c.y + czr2);
+    float miny = (vy * _c.y - cr.z) / (vy * _c.z + cr.y);
+    float maxy = (vy * _c.y + cr.z) / (vy * _c.z - cr.y);
+
+    _aabb = vec4(minx * _P00, maxy * _P11, maxx * _P00, miny * _P11);
+    _aabb = _aabb * vec4(0.5f, -0.5f, 0.5f, -0.5f) + vec4(0.5f);
+
+    return true;
+}
+
+SoftOcclusionWorkers::~SoftOcclusionWorkers()
+{
+    // the job needs the workers until it is done
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        jobDone.wait(lock, [&]() { return !job; });
+        quit = true;
+    }
+    wake.notify_all();
+    jobWake.notify_all();
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    if (jobThread.joinable())
+    {
+        jobThread.join();
+    }
+}
+
+static void workerLoop(SoftOcclusionWorkers& _w, uint32_t _workerIdx)
+{
+    uint64_t seen = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(_w.mutex);
+            _w.wake.wait(lock, [&]() { return _w.quit || _w.generation != seen; });
+
+            if (_w.quit)
+                return;
+
+            seen = _w.generation;
+        }
+
+        // the task stays the same until all workers are done with it
+        _w.task(_workerIdx);
+
+        {
+            std::lock_guard<std::mutex> lock(_w.mutex);
+            if (--_w.pending == 0)
+                _w.done.notify_one();
+        }
+    }
+}
+
+static void jobLoop(SoftOcclusionWorkers& _w)
+{
+    for (;;)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(_w.mutex);
+            _w.jobWake.wait(lock, [&]() { return _w.quit || _w.job; });
+
+            if (_w.quit)
+                return;
+
+            job = _w.job;
+        }
+
+        job();
+
+        {
+            std::lock_guard<std::mutex> lock(_w.mutex);
+            _w.job = nullptr;
+        }
+        _w.jobDone.notify_all();
+    }
+}
+
+static void startWorkers(SoftOcclusionWorkers& _w, uint32_t _count)
+{
+    _w.threads.reserve(_count);
+    for (uint32_t ii = 0; ii < _count; ++ii)
+    {
+        _w.threads.emplace_back(workerLoop, std::ref(_w), ii + 1);
+    }
+
+    _w.jobThread = std::thread(jobLoop, std::ref(_w));
+}
+
+static void kickJob(SoftOcclusionWorkers& _w, std::function<void()>&& _job)
+{
+    {
+        std::lock_guard<std::mutex> lock(_w.mutex);
+        assert(!_w.job);
+        _w.job = std::move(_job);
+    }
+    _w.jobWake.notify_one();
+}
+
+static void waitJob(SoftOcclusionWorkers& _w)
+{
+    std::unique_lock<std::mutex> lock(_w.mutex);
+    _w.jobDone.wait(lock, [&]() { return !_w.job; });
+}
+
+// split [0, _count) into ranges for the workers and the calling thread
+template<typename Func>
+static void parallelFor(SoftOcclusionWorkers& _w, uint32_t _count, Func&& _func)
+{
+    if (_count == 0)
+        return;
+
+    const uint32_t jobCount = glm::min(_count, (uint32_t)_w.threads.size() + 1);
+    const uint32_t step = (_count + jobCount - 1) / jobCount;
+
+    auto range = [&](uint32_t _jobIdx) {
+        uint32_t start = _jobIdx * step;
+        uint32_t end = glm::min(start + step, _count);
+        if (start < end)
+            _func(start, end);
+    };
+
+    if (jobCount > 1)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_w.mutex);
+            _w.task = [&range, jobCount](uint32_t _workerIdx) {
+                if (_workerIdx < jobCount)
+                    range(_workerIdx);
+            };
+            _w.pending = (uint32_t)_w.threads.size();
+            _w.generation++;
+        }
+        _w.wake.notify_all();
+    }
+
+    range(0);
+
+    if (jobCount > 1)
+    {
+        std::unique_lock<std::mutex> lock(_w.mutex);
+        _w.done.wait(lock, [&]() { return _w.pending == 0; });
+        _w.task = nullptr;
+    }
+}
+
+static void selectOccluders(SoftOcclusion& _so, const TransformData& _trans, const Constants& _consts)
+{
+    KG_ZoneScopedC(kage::Color::blue);
+
+    const Scene& scene = *_so.scene;
+    const Geometry& geom = scene.geometry;
+
+    std::vector<std::pair<float, uint32_t>> candidates;
+    candidates.reserve(scene.drawCount);
+
+    for (uint32_t ii = 0; ii < scene.drawCount; ++ii)
+    {
+        const MeshDraw& draw = scene.meshDraws[ii];
+        if (draw.withAlpha > 0)
+            continue;
+
+        const TransformNode& world = _so.drawTransforms[ii];
+
+        const Mesh& mesh = geom.meshes[draw.meshIdx];
+        if (mesh.lodCount == 0)
+            continue;
+
+        const MeshLod& lod = mesh.lods[mesh.lodCount - 1];
+        if (lod.indexCount == 0 || lod.indexOffset + lod.indexCount > geom.indices.size())
+            continue;
+
+        vec3 center = vec3(_trans.cull_view * vec4(rotateQuat(mesh.center, world.orit) * world.scale + world.pos, 1.f));
+        float radius = mesh.radius * maxElem(world.scale);
+
+        if (center.z - radius < _consts.znear)
+            continue;
+
+        float size = radius / center.z;
+        if (size < _so.minOccluderSize)
+            continue;
+
+        candidates.emplace_back(size, ii);
+    }
+
+    size_t count = glm::min(candidates.size(), size_t(_so.maxOccluders));
+    std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end()
+        , [](const std::pair<float, uint32_t>& _a, const std::pair<float, uint32_t>& _b) { return _a.first > _b.first; }
+    );
+
+    _so.occluders.clear();
+    _so.occluderTriOffsets.clear();
+
+    uint32_t triCount = 0;
+    for (size_t ii = 0; ii < count; ++ii)
+    {
+        uint32_t di = candidates[ii].second;
+        const Mesh& mesh = geom.meshes[scene.meshDraws[di].meshIdx];
+
+        _so.occluders.push_back(di);
+        _so.occluderTriOffsets.push_back(triCount);
+        triCount += mesh.lods[mesh.lodCount - 1].indexCount / 3;
+    }
+    _so.occluderTriOffsets.push_back(triCount);
+
+    _so.tris.resize(triCount);
+    _so.occluderCount = (uint32_t)count;
+}
+
+static void setupOccluderTris(SoftOcclusion& _so, uint32_t _start, uint32_t _end, const TransformData& _trans, const Constants& _consts)
+{
+    const Scene& scene = *_so.scene;
+    const Geometry& geom = scene.geometry;
+
+    const float w = (float)_so.width;
+    const float h = (float)_so.height;
+
+    for (uint32_t oi = _start; oi < _end; ++oi)
+    {
+        const MeshDraw& draw = scene.meshDraws[_so.occluders[oi]];
+        const TransformNode& world = _so.drawTransforms[_so.occluders[oi]];
+        const Mesh& mesh = geom.meshes[draw.meshIdx];
+        const MeshLod& lod = mesh.lods[mesh.lodCount - 1];
+
+        const uint32_t triOffset = _so.occluderTriOffsets[oi];
+        const uint32_t triCount = lod.indexCount / 3;
+
+        for (uint32_t ti = 0; ti < triCount; ++ti)
+        {
+            SoftOcclusionTri& tri = _so.tris[triOffset + ti];
+            tri.valid = true;
+
+            for (uint32_t vi = 0; vi < 3; ++vi)
+            {
+                uint32_t idx = geom.indices[lod.indexOffset + ti * 3 + vi] + mesh.vertexOffset;
+                const Vertex& vtx = geom.vertices[idx];
+
+                vec3 wPos = rotateQuat(vec3(vtx.vx, vtx.vy, vtx.vz), world.orit) * world.scale + world.pos;
+                vec3 vPos = vec3(_trans.cull_view * vec4(wPos, 1.f));
+
+                // triangles cross the near plane are simply dropped, occluders only need to be conservative
+                if (vPos.z < _consts.znear)
+                {
+                    tri.valid = false;
+                    break;
+                }
+
+                float invZ = 1.f / vPos.z;
+                tri.x[vi] = (vPos.x * _consts.P00 * invZ * 0.5f + 0.5f) * w;
+                tri.y[vi] = (-vPos.y * _consts.P11 * invZ * 0.5f + 0.5f) * h;
+                tri.z[vi] = _consts.znear * invZ;
+            }
+        }
+    }
+}
+
+static void rasterizeTri(SoftOcclusion& _so, const SoftOcclusionTri& _tri, int32_t _bandMinY, int32_t _bandMaxY)
+{
+    float x0 = _tri.x[0], y0 = _tri.y[0], z0 = _tri.z[0];
+    float x1 = _tri.x[1], y1 = _tri.y[1], z1 = _tri.z[1];
+    float x2 = _tri.x[2], y2 = _tri.y[2], z2 = _tri.z[2];
+
+    float area = (x1 - x0) * (y2 - y0) - (y1 - y0) * (x2 - x0);
+    if (fabsf(area) < 1e-6f)
+        return;
+
+    // both windings are accepted, the coarse lod is not guaranteed to be closed
+    if (area < 0.f)
+    {
+        std::swap(x1, x2);
+        std::swap(y1, y2);
+        std::swap(z1, z2);
+        area = -area;
+    }
+
+    int32_t minX = glm::max(0, (int32_t)floorf(glm::min(x0, glm::min(x1, x2))));
+    int32_t maxX = glm::min((int32_t)_so.width - 1, (int32_t)ceilf(glm::max(x0, glm::max(x1, x2))));
+    int32_t minY = glm::max(_bandMinY, (int32_t)floorf(glm::min(y0, glm::min(y1, y2))));
+    int32_t maxY = glm::min(_bandMaxY, (int32_t)ceilf(glm::max(y0, glm::max(y1, y2))));
+
+    if (minX > maxX || minY > maxY)
+        return;
+
+    // edge function: e(p) = a * p.x + b * p.y + c, inside when all three >= 0
+    const float a0 = y1 - y2, b0 = x2 - x1, c0 = (y2 - y1) * x1 - (x2 - x1) * y1;
+    const float a1 = y2 - y0, b1 = x0 - x2, c1 = (y0 - y2) * x2 - (x0 - x2) * y2;
+    const float a2 = y0 - y1, b2 = x1 - x0, c2 = (y1 - y0) * x0 - (x1 - x0) * y0;
+
+    // reverse-z is linear in screen space
+    const float invArea = 1.f / area;
+    const float za = (a0 * z0 + a1 * z1 + a2 * z2) * invArea;
+    const float zb = (b0 * z0 + b1 * z1 + b2 * z2) * invArea;
+    const float zc = (c0 * z0 + c1 * z1 + c2 * z2) * invArea;
+
+    minX &= ~3;
+
+#if KG_SW_OCCLUSION_SSE
+    const __m128 offs = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    const __m128 zero = _mm_setzero_ps();
+
+    for (int32_t yy = minY; yy <= maxY; ++yy)
+    {
+        const float py = (float)yy + 0.5f;
+        float* row = _so.depth.data() + yy * _so.width;
+
+        for (int32_t xx = minX; xx <= maxX; xx += 4)
+        {
+            __m128 px = _mm_add_ps(_mm_set1_ps((float)xx), offs);
+
+            __m128 e0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a0), px), _mm_set1_ps(b0 * py + c0));
+            __m128 e1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a1), px), _mm_set1_ps(b1 * py + c1));
+            __m128 e2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a2), px), _mm_set1_ps(b2 * py + c2));
+
+            __m128 mask = _mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_and_ps(_mm_cmpge_ps(e1, zero), _mm_cmpge_ps(e2, zero)));
+            if (_mm_movemask_ps(mask) == 0)
+                continue;
+
+            __m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(za), px), _mm_set1_ps(zb * py + zc));
+            __m128 dst = _mm_loadu_ps(row + xx);
+            __m128 closer = _mm_max_ps(dst, z);
+            _mm_storeu_ps(row + xx, _mm_or_ps(_mm_and_ps(mask, closer), _mm_andnot_ps(mask, dst)));
+        }
+    }
+#else
+    for (int32_t yy = minY; yy <= maxY; ++yy)
+    {
+        const float py = (float)yy + 0.5f;
+        float* row = _so.depth.data() + yy * _so.width;
+
+        for (int32_t xx = minX; xx <= maxX; ++xx)
+        {
+            const float px = (float)xx + 0.5f;
+
+            if (a0 * px + b0 * py + c0 < 0.f
+                || a1 * px + b1 * py + c1 < 0.f
+                || a2 * px + b2 * py + c2 < 0.f)
+                continue;
+
+            row[xx] = glm::max(row[xx], za * px + zb * py + zc);
+        }
+    }
+#endif // KG_SW_OCCLUSION_SSE
+}
+
+// each band owns a range of tile rows, so bands never write to the same pixel
+static void rasterizeBand(SoftOcclusion& _so, uint32_t _tileRowStart, uint32_t _tileRowEnd)
+{
+    const int32_t bandMinY = (int32_t)(_tileRowStart * kSoftOcclusionTileSize);
+    const int32_t bandMaxY = (int32_t)(_tileRowEnd * kSoftOcclusionTileSize) - 1;
+
+    memset(_so.depth.data() + bandMinY * _so.width, 0, (bandMaxY - bandMinY + 1) * _so.width * sizeof(float));
+
+    for (const SoftOcclusionTri& tri : _so.tris)
+    {
+        if (!tri.valid)
+            continue;
+
+        float minY = glm::min(tri.y[0], glm::min(tri.y[1], tri.y[2]));
+        float maxY = glm::max(tri.y[0], glm::max(tri.y[1], tri.y[2]));
+        if (maxY < (float)bandMinY || minY > (float)(bandMaxY + 1))
+            continue;
+
+        rasterizeTri(_so, tri, bandMinY, bandMaxY);
+    }
+
+    // farthest depth in each tile, used to early reject/accept the bounds test
+    for (uint32_t ty = _tileRowStart; ty < _tileRowEnd; ++ty)
+    {
+        for (uint32_t tx = 0; tx < _so.tileCountX; ++tx)
+        {
+            float tileMin = FLT_MAX;
+            for (uint32_t yy = 0; yy < kSoftOcclusionTileSize; ++yy)
+            {
+                const float* row = _so.depth.data() + (ty * kSoftOcclusionTileSize + yy) * _so.width + tx * kSoftOcclusionTileSize;
+                for (uint32_t xx = 0; xx < kSoftOcclusionTileSize; ++xx)
+                {
+                    tileMin = glm::min(tileMin, row[xx]);
+                }
+            }
+            _so.tileMinDepth[ty * _so.tileCountX + tx] = tileMin;
+        }
+    }
+}
+
+static bool testBounds(const SoftOcclusion& _so, const vec4& _aabb, float _depth)
+{
+    int32_t minX = glm::max(0, (int32_t)floorf(_aabb.x * _so.width));
+    int32_t minY = glm::max(0, (int32_t)floorf(_aabb.y * _so.height));
+    int32_t maxX = glm::min((int32_t)_so.width - 1, (int32_t)ceilf(_aabb.z * _so.width));
+    int32_t maxY = glm::min((int32_t)_so.height - 1, (int32_t)ceilf(_aabb.w * _so.height));
+
+    // out of screen, leave it to the frustum culling
+    if (minX > maxX || minY > maxY)
+        return true;
+
+    const uint32_t tMinX = minX / kSoftOcclusionTileSize;
+    const uint32_t tMaxX = maxX / kSoftOcclusionTileSize;
+    const uint32_t tMinY = minY / kSoftOcclusionTileSize;
+    const uint32_t tMaxY = maxY / kSoftOcclusionTileSize;
+
+    for (uint32_t ty = tMinY; ty <= tMaxY; ++ty)
+    {
+        for (uint32_t tx = tMinX; tx <= tMaxX; ++tx)
+        {
+            // whole tile is closer than the sphere
+            if (_so.tileMinDepth[ty * _so.tileCountX + tx] > _depth)
+                continue;
+
+            int32_t y0 = glm::max(minY, int32_t(ty * kSoftOcclusionTileSize));
+            int32_t y1 = glm::min(maxY, int32_t((ty + 1) * kSoftOcclusionTileSize) - 1);
+            int32_t x0 = glm::max(minX, int32_t(tx * kSoftOcclusionTileSize));
+            int32_t x1 = glm::min(maxX, int32_t((tx + 1) * kSoftOcclusionTileSize) - 1);
+
+            for (int32_t yy = y0; yy <= y1; ++yy)
+            {
+                const float* row = _so.depth.data() + yy * _so.width;
+                for (int32_t xx = x0; xx <= x1; ++xx)
+                {
+                    if (row[xx] <= _depth)
+                        return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+static void testDraws(SoftOcclusion& _so, uint32_t _start, uint32_t _end, const TransformData& _trans, const Constants& _consts)
+{
+    const Scene& scene = *_so.scene;
+
+    for (uint32_t di = _start; di < _end; ++di)
+    {
+        const MeshDraw& draw = scene.meshDraws[di];
+        const TransformNode& world = _so.drawTransforms[di];
+        const Mesh& mesh = scene.geometry.meshes[draw.meshIdx];
+
+        vec3 center = vec3(_trans.cull_view * vec4(rotateQuat(mesh.center, world.orit) * world.scale + world.pos, 1.f));
+        float radius = mesh.radius * maxElem(world.scale);
+
+        bool visible = true;
+
+        vec4 aabb;
+        if (projectSphere(center, radius, _consts.znear, _consts.P00, _consts.P11, aabb))
+        {
+            float depthSphere = _consts.znear / (center.z - radius);
+            visible = testBounds(_so, aabb, depthSphere);
+        }
+
+        _so.visibility[di] = visible ? 1u : 0u;
+    }
+}
+
+static void cullSoftOcclusion(SoftOcclusion& _so, const TransformData _trans, const Constants _consts)
+{
+    KG_ZoneScopedC(kage::Color::blue);
+
+    int64_t start = bx::getHPCounter();
+
+    selectOccluders(_so, _trans, _consts);
+
+    parallelFor(*_so.workers, _so.occluderCount, [&](uint32_t _s, uint32_t _e) {
+        setupOccluderTris(_so, _s, _e, _trans, _consts);
+    });
+
+    parallelFor(*_so.workers, _so.tileCountY, [&](uint32_t _s, uint32_t _e) {
+        rasterizeBand(_so, _s, _e);
+    });
+
+    parallelFor(*_so.workers, _so.scene->drawCount, [&](uint32_t _s, uint32_t _e) {
+        testDraws(_so, _s, _e, _trans, _consts);
+    });
+
+    uint32_t occluded = 0;
+    for (uint32_t vis : _so.visibility)
+    {
+        occluded += (vis == 0) ? 1 : 0;
+    }
+    _so.occludedCount = occluded;
+
+    _so.cpuTime = float(double(bx::getHPCounter() - start) / double(bx::getHPFrequency()) * 1000.0);
+}
+
+void initSoftOcclusion(SoftOcclusion& _so, const Scene& _scene, const SoftOcclusionInitData& _initData)
+{
+    assert(_initData.width % kSoftOcclusionTileSize == 0);
+    assert(_initData.height % kSoftOcclusionTileSize == 0);
+
+    _so.scene = &_scene;
+    _so.width = _initData.width;
+    _so.height = _initData.height;
+    _so.tileCountX = _initData.width / kSoftOcclusionTileSize;
+    _so.tileCountY = _initData.height / kSoftOcclusionTileSize;
+    _so.maxOccluders = _initData.maxOccluders;
+    _so.minOccluderSize = _initData.minOccluderSize;
+
+    uint32_t hwThreads = glm::max(1u, std::thread::hardware_concurrency());
+    _so.threadCount = _initData.threadCount > 0
+        ? _initData.threadCount
+        : glm::clamp(hwThreads - 1, 1u, 8u);
+
+    // the job thread takes a range too
+    _so.workers = std::make_unique<SoftOcclusionWorkers>();
+    startWorkers(*_so.workers, _so.threadCount - 1);
+
+    _so.depth.resize(_so.width * _so.height, 0.f);
+    _so.tileMinDepth.resize(_so.tileCountX * _so.tileCountY, 0.f);
+    _so.visibility.resize(_scene.drawCount, 1u);
+
+    _so.drawTransforms.resize(_scene.drawCount);
+    for (uint32_t ii = 0; ii < _scene.drawCount; ++ii)
+    {
+        const MeshDraw& draw = _scene.meshDraws[ii];
+        _so.drawTransforms[ii].pos = draw.pos;
+        _so.drawTransforms[ii].orit = draw.orit;
+        _so.drawTransforms[ii].scale = draw.scale;
+    }
+
+    const kage::Memory* mem = kage::alloc(uint32_t(_so.visibility.size() * sizeof(uint32_t)));
+    memcpy(mem->data, _so.visibility.data(), mem->size);
+
+    kage::BufferDesc desc;
+    desc.size = mem->size;
+    desc.usage = kage::BufferUsageFlagBits::storage | kage::BufferUsageFlagBits::transfer_dst;
+    desc.memFlags = kage::MemoryPropFlagBits::device_local | kage::MemoryPropFlagBits::host_visible;
+    _so.visBuf = kage::registBuffer("sw_occlusion_vis", desc, mem);
+}
+
+void setSoftOcclusionDrawTransform(SoftOcclusion& _so, uint32_t _drawIdx, const TransformNode& _world)
+{
+    // the job reads the transforms
+    assert(!_so.jobKicked);
+    assert(_drawIdx < _so.drawTransforms.size());
+
+    _so.drawTransforms[_drawIdx] = _world;
+}
+
+void kickSoftOcclusion(SoftOcclusion& _so, const TransformData& _trans, const Constants& _consts)
+{
+    KG_ZoneScopedC(kage::Color::blue);
+
+    if (!_so.enabled || _so.jobKicked)
+        return;
+
+    // copy the frame data, the job outlives the caller's stack
+    SoftOcclusion* so = &_so;
+    kickJob(*_so.workers, [so, _trans, _consts]() {
+        cullSoftOcclusion(*so, _trans, _consts);
+    });
+    _so.jobKicked = true;
+}
+
+void updateSoftOcclusion(SoftOcclusion& _so)
+{
+    KG_ZoneScopedC(kage::Color::blue);
+
+    if (_so.jobKicked)
+    {
+        waitJob(*_so.workers);
+        _so.jobKicked = false;
+        _so.allVisibleUploaded = false;
+    }
+    else if (!_so.enabled && !_so.allVisibleUploaded)
+    {
+        std::fill(_so.visibility.begin(), _so.visibility.end(), 1u);
+        _so.occluderCount = 0;
+        _so.occludedCount = 0;
+        _so.cpuTime = 0.f;
+        _so.allVisibleUploaded = true;
+    }
+    else
+    {
+        // nothing changed since the last upload
+        return;
+    }
+
+    const kage::Memory* mem = kage::alloc(uint32_t(_so.visibility.size() * sizeof(uint32_t)));
+    memcpy(mem->data, _so.visibility.data(), mem->size);
+    kage::updateBuffer(_so.visBuf, mem);
+}
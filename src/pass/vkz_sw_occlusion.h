@@ -0,0 +1,110 @@
+#pragma once
+
+#include "core/kage.h"
+#include "scene/scene.h"
+#include "demo_structs.h"
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+
+// cpu side masked software occlusion culling
+// the coarsest lod of the largest draws is rasterized into a low resolution reverse-z depth buffer,
+// then every draw's bounding sphere is tested against it before the mesh culling consumes the draw list.
+// the result is a per-draw visibility buffer that is read by the mesh culling passes.
+struct SoftOcclusionInitData
+{
+    uint32_t width{ 256 };          // must be multiple of 8
+    uint32_t height{ 128 };         // must be multiple of 8
+    uint32_t maxOccluders{ 64 };
+    uint32_t threadCount{ 0 };      // 0: use hardware concurrency
+    float minOccluderSize{ 0.05f }; // minimum projected radius / distance to be an occluder
+};
+
+struct SoftOcclusionTri
+{
+    float x[3];
+    float y[3];
+    float z[3];
+    bool valid;
+};
+
+// persistent workers of the parallel phases, the calling thread runs the first range itself
+// the frame job is kicked to the job thread, which is the calling thread of its parallel phases
+struct SoftOcclusionWorkers
+{
+    ~SoftOcclusionWorkers();
+
+    std::vector<std::thread> threads;
+    std::thread jobThread;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    std::function<void(uint32_t)> task; // takes the worker index, from 1
+    uint64_t generation{ 0 };
+    uint32_t pending{ 0 };
+    bool quit{ false };
+
+    std::condition_variable jobWake;
+    std::condition_variable jobDone;
+    std::function<void()> job; // cleared once it is done
+};
+
+struct SoftOcclusion
+{
+    const Scene* scene{ nullptr };
+
+    uint32_t width;
+    uint32_t height;
+    uint32_t tileCountX;
+    uint32_t tileCountY;
+    uint32_t maxOccluders;
+    uint32_t threadCount;
+    float minOccluderSize;
+
+    bool enabled{ true };
+
+    // reverse-z: 0 is the far plane, bigger value is closer
+    std::vector<float> depth;
+    std::vector<float> tileMinDepth;
+
+    std::vector<uint32_t> occluders;
+    std::vector<uint32_t> occluderTriOffsets;
+    std::vector<SoftOcclusionTri> tris;
+
+    // world transform of each draw, the load time ones until the moved draws are set
+    std::vector<TransformNode> drawTransforms;
+
+    // 1: visible, 0: occluded
+    std::vector<uint32_t> visibility;
+
+    // stats
+    uint32_t occluderCount{ 0 };
+    uint32_t occludedCount{ 0 };
+    float cpuTime{ 0.f };
+
+    // the pending job is waited for before the workers stop
+    std::unique_ptr<SoftOcclusionWorkers> workers;
+    bool jobKicked{ false };
+
+    // the all visible buffer is uploaded once when disabled
+    bool allVisibleUploaded{ false };
+
+    kage::BufferHandle visBuf;
+};
+
+void initSoftOcclusion(SoftOcclusion& _so, const Scene& _scene, const SoftOcclusionInitData& _initData);
+
+// the draw moved in the frame, must be called before the kick
+void setSoftOcclusionDrawTransform(SoftOcclusion& _so, uint32_t _drawIdx, const TransformNode& _world);
+
+// kick the culling job with the current frame cull transform, it runs in parallel with the pass recording
+void kickSoftOcclusion(SoftOcclusion& _so, const TransformData& _trans, const Constants& _consts);
+
+// wait for the job and upload the visibility, must be called before kage::render()
+void updateSoftOcclusion(SoftOcclusion& _so);
@@ -0,0 +1,245 @@
+#include "vkz_taa.h"
+#include "vkz_pass.h"
+#include "bx/bx.h"
+
+static float halton(uint32_t _idx, uint32_t _base)
+{
+    float f = 1.f;
+    float r = 0.f;
+    while (_idx > 0)
+    {
+        f /= float(_base);
+        r += f * float(_idx % _base);
+        _idx /= _base;
+    }
+    return r;
+}
+
+static void initTaaResolve(TaaResolve& _resolve, const TaaInitData& _init, kage::ImageHandle _history)
+{
+    kage::ShaderHandle cs = kage::registShader("taa_resolve", "shader/taa_resolve.comp.spv");
+    kage::ProgramHandle prog = kage::registProgram("taa_resolve", { cs }, sizeof(TaaConstants));
+
+    kage::PassDesc passDesc{};
+    passDesc.prog = prog;
+    passDesc.queue = kage::PassExeQueue::compute;
+    kage::PassHandle pass = kage::registPass("taa_resolve", passDesc);
+
+    // the same desc as the smaa blend, the ui draws on it
+    kage::ImageDesc desc{};
+    desc.width = _init.outWidth;
+    desc.height = _init.outHeight;
+    desc.format = kage::ResourceFormat::r8g8b8a8_unorm;
+    desc.depth = 1;
+    desc.numLayers = 1;
+    desc.numMips = 1;
+    desc.usage = ImgUsage::sampled | ImgUsage::storage | ImgUsage::transfer_src | ImgUsage::color_attachment;
+    kage::ImageHandle outColor = kage::registTexture("taa_out", desc, nullptr, kage::ResourceLifetime::transition);
+
+    _resolve.colorSampler = kage::sampleImage(pass, _init.color
+        , Stage::compute_shader
+        , kage::SamplerFilter::linear
+        , kage::SamplerMipmapMode::nearest
+        , kage::SamplerAddressMode::clamp_to_edge
+        , kage::SamplerReductionMode::weighted_average
+    );
+
+    _resolve.depthSampler = kage::sampleImage(pass, _init.depth
+        , Stage::compute_shader
+        , kage::SamplerFilter::nearest
+        , kage::SamplerMipmapMode::nearest
+        , kage::SamplerAddressMode::clamp_to_edge
+        , kage::SamplerReductionMode::weighted_average
+    );
+
+    _resolve.velocitySampler = kage::sampleImage(pass, _init.velocity
+        , Stage::compute_shader
+        , kage::SamplerFilter::nearest
+        , kage::SamplerMipmapMode::nearest
+        , kage::SamplerAddressMode::clamp_to_edge
+        , kage::SamplerReductionMode::weighted_average
+    );
+
+    _resolve.historySampler = kage::sampleImage(pass, _history
+        , Stage::compute_shader
+        , kage::SamplerFilter::linear
+        , kage::SamplerMipmapMode::nearest
+        , kage::SamplerAddressMode::clamp_to_edge
+        , kage::SamplerReductionMode::weighted_average
+    );
+
+    kage::ImageHandle outColorAlias = kage::alias(outColor);
+    kage::bindImage(pass, outColor
+        , Stage::compute_shader
+        , Access::shader_write
+        , kage::ImageLayout::general
+        , outColorAlias
+    );
+
+    _resolve.pass = pass;
+    _resolve.cs = cs;
+    _resolve.prog = prog;
+
+    _resolve.color = _init.color;
+    _resolve.depth = _init.depth;
+    _resolve.velocity = _init.velocity;
+    _resolve.history = _history;
+
+    _resolve.outColor = outColor;
+    _resolve.outColorAlias = outColorAlias;
+}
+
+static void initTaaHistory(TaaHistory& _copy, kage::ImageHandle _color, kage::ImageHandle _history)
+{
+    kage::ShaderHandle cs = kage::registShader("taa_history", "shader/taa_history.comp.spv");
+    kage::ProgramHandle prog = kage::registProgram("taa_history", { cs });
+
+    kage::PassDesc passDesc{};
+    passDesc.prog = prog;
+    passDesc.queue = kage::PassExeQueue::compute;
+    kage::PassHandle pass = kage::registPass("taa_history", passDesc);
+
+    // the color is only read, it goes through this pass so the copy is not clipped from the graph
+    kage::ImageHandle colorOutAlias = kage::alias(_color);
+    kage::bindImage(pass, _color
+        , Stage::compute_shader
+        , Access::shader_read | Access::shader_write
+        , kage::ImageLayout::general
+        , colorOutAlias
+    );
+
+    kage::ImageHandle historyOutAlias = kage::alias(_history);
+    kage::bindImage(pass, _history
+        , Stage::compute_shader
+        , Access::shader_write
+        , kage::ImageLayout::general
+        , historyOutAlias
+    );
+
+    _copy.pass = pass;
+    _copy.cs = cs;
+    _copy.prog = prog;
+
+    _copy.color = _color;
+    _copy.history = _history;
+
+    _copy.colorOutAlias = colorOutAlias;
+    _copy.historyOutAlias = historyOutAlias;
+}
+
+void initTaa(Taa& _taa, const TaaInitData& _init)
+{
+    kage::ImageDesc desc{};
+    desc.width = _init.outWidth;
+    desc.height = _init.outHeight;
+    desc.format = kage::ResourceFormat::r8g8b8a8_unorm;
+    desc.depth = 1;
+    desc.numLayers = 1;
+    desc.numMips = 1;
+    desc.usage = ImgUsage::sampled | ImgUsage::storage | ImgUsage::transfer_dst;
+    kage::ImageHandle history = kage::registTexture("taa_history", desc, nullptr, kage::ResourceLifetime::non_transition);
+
+    initTaaResolve(_taa.resolve, _init, history);
+    initTaaHistory(_taa.copy, _taa.resolve.outColorAlias, history);
+
+    _taa.outAlias = _taa.copy.colorOutAlias;
+
+    _taa.outWidth = _init.outWidth;
+    _taa.outHeight = _init.outHeight;
+    _taa.frameIdx = 0;
+    _taa.reset = true;
+}
+
+vec2 getTaaJitter(uint32_t _frameIdx, uint32_t _renderWidth, uint32_t _renderHeight, uint32_t _outWidth, uint32_t _outHeight)
+{
+    const float ratio = float(_outWidth) / float(glm::max(_renderWidth, 1u));
+    const uint32_t phases = (uint32_t)glm::ceil(float(kTaaBaseJitterPhases) * ratio * ratio);
+
+    // skip the 0, it is the same for both bases
+    const uint32_t idx = (_frameIdx % phases) + 1;
+
+    const vec2 jitter = vec2(halton(idx, 2), halton(idx, 3)) - vec2(.5f);
+    return jitter * 2.f / vec2(float(_renderWidth), float(_renderHeight));
+}
+
+static void recTaaResolve(const TaaResolve& _resolve, const TaaConstants& _consts)
+{
+    KG_ZoneScopedC(kage::Color::blue);
+
+    kage::startRec(_resolve.pass);
+
+    const kage::Memory* mem = kage::alloc(sizeof(TaaConstants));
+    bx::memCopy(mem->data, &_consts, mem->size);
+    kage::setConstants(mem);
+
+    kage::Binding binds[] =
+    {
+        { _resolve.color,       _resolve.colorSampler,      Stage::compute_shader },
+        { _resolve.depth,       _resolve.depthSampler,      Stage::compute_shader },
+        { _resolve.velocity,    _resolve.velocitySampler,   Stage::compute_shader },
+        { _resolve.history,     _resolve.historySampler,    Stage::compute_shader },
+        { _resolve.outColor,    0,                          Stage::compute_shader },
+    };
+    kage::pushBindings(binds, COUNTOF(binds));
+
+    kage::dispatch((uint32_t)_consts.outWidth, (uint32_t)_consts.outHeight, 1);
+
+    kage::endRec();
+}
+
+static void recTaaHistory(const TaaHistory& _copy, uint32_t _width, uint32_t _height)
+{
+    KG_ZoneScopedC(kage::Color::blue);
+
+    kage::startRec(_copy.pass);
+
+    kage::Binding binds[] =
+    {
+        { _copy.color,      0,  Stage::compute_shader },
+        { _copy.history,    0,  Stage::compute_shader },
+    };
+    kage::pushBindings(binds, COUNTOF(binds));
+
+    kage::dispatch(_width, _height, 1);
+
+    kage::endRec();
+}
+
+void updateTaa(Taa& _taa, uint32_t _renderWidth, uint32_t _renderHeight, uint32_t _outWidth, uint32_t _outHeight, const vec2& _jitter, float _feedback /*= .9f*/)
+{
+    if (_outWidth != _taa.outWidth || _outHeight != _taa.outHeight)
+    {
+        _taa.outWidth = _outWidth;
+        _taa.outHeight = _outHeight;
+
+        kage::updateImage(_taa.resolve.outColor, _outWidth, _outHeight);
+        kage::updateImage(_taa.resolve.history, _outWidth, _outHeight);
+
+        _taa.reset = true;
+    }
+
+    // the history is still valid but the current frame is sampled differently, drop it to avoid the smearing
+    if (_renderWidth != _taa.renderWidth || _renderHeight != _taa.renderHeight)
+    {
+        _taa.renderWidth = _renderWidth;
+        _taa.renderHeight = _renderHeight;
+
+        _taa.reset = true;
+    }
+
+    TaaConstants consts{};
+    consts.renderWidth = float(_renderWidth);
+    consts.renderHeight = float(_renderHeight);
+    consts.outWidth = float(_outWidth);
+    consts.outHeight = float(_outHeight);
+    consts.jitterX = _jitter.x;
+    consts.jitterY = _jitter.y;
+    consts.feedback = _feedback;
+    consts.reset = _taa.reset ? 1 : 0;
+
+    recTaaResolve(_taa.resolve, consts);
+    recTaaHistory(_taa.copy, _outWidth, _outHeight);
+
+    _taa.reset = false;
+    _taa.frameIdx++;
+}
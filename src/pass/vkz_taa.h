@@ -0,0 +1,99 @@
+#pragma once
+
+#include "core/kage.h"
+#include "core/kage_math.h"
+
+// temporal upscaling: the scene is rendered at a fraction of the output resolution with a halton jittered projection
+// the resolve reprojects the history with the velocity, clips it to the neighborhood of the current frame and blends them
+// the history is kept at the output resolution, a copy pass writes it back after the resolve
+// keep sync with taa_resolve.comp.glsl
+constexpr uint32_t kTaaBaseJitterPhases = 8;
+
+struct alignas(16) TaaConstants
+{
+    float renderWidth, renderHeight;
+    float outWidth, outHeight;
+
+    float jitterX, jitterY; // in ndc
+    float feedback;
+    uint32_t reset;
+};
+
+struct TaaInitData
+{
+    // at the render resolution
+    kage::ImageHandle color;
+    kage::ImageHandle depth;
+    kage::ImageHandle velocity;
+
+    uint32_t outWidth;
+    uint32_t outHeight;
+};
+
+struct TaaResolve
+{
+    kage::PassHandle pass;
+    kage::ShaderHandle cs;
+    kage::ProgramHandle prog;
+
+    // read-only
+    kage::ImageHandle color;
+    kage::SamplerHandle colorSampler;
+    kage::ImageHandle depth;
+    kage::SamplerHandle depthSampler;
+    kage::ImageHandle velocity;
+    kage::SamplerHandle velocitySampler;
+    kage::ImageHandle history;
+    kage::SamplerHandle historySampler;
+
+    // write
+    kage::ImageHandle outColor;
+
+    // out alias
+    kage::ImageHandle outColorAlias;
+};
+
+struct TaaHistory
+{
+    kage::PassHandle pass;
+    kage::ShaderHandle cs;
+    kage::ProgramHandle prog;
+
+    // read, passed through to the next pass
+    kage::ImageHandle color;
+
+    // write
+    kage::ImageHandle history;
+
+    // out alias
+    kage::ImageHandle colorOutAlias;
+    kage::ImageHandle historyOutAlias;
+};
+
+struct Taa
+{
+    TaaResolve resolve;
+    TaaHistory copy;
+
+    // the resolved color at the output resolution
+    kage::ImageHandle outAlias;
+
+    uint32_t outWidth{ 0 };
+    uint32_t outHeight{ 0 };
+    uint32_t renderWidth{ 0 };
+    uint32_t renderHeight{ 0 };
+
+    uint32_t frameIdx{ 0 };
+
+    // the history is dropped on the first frame and after any resize
+    bool reset{ true };
+};
+
+void initTaa(Taa& _taa, const TaaInitData& _init);
+
+// the jitter of the frame in ndc, a halton(2, 3) sequence
+// the sequence is longer for the larger upscaling ratio so each output pixel gets enough samples
+vec2 getTaaJitter(uint32_t _frameIdx, uint32_t _renderWidth, uint32_t _renderHeight, uint32_t _outWidth, uint32_t _outHeight);
+
+// _feedback is the weight of the history, the output size follows the swapchain
+void updateTaa(Taa& _taa, uint32_t _renderWidth, uint32_t _renderHeight, uint32_t _outWidth, uint32_t _outHeight, const vec2& _jitter, float _feedback = .9f);
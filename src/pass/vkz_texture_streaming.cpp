@@ -0,0 +1,433 @@
+#include "vkz_texture_streaming.h"
+#include "vkz_pass.h"
+#include "bx/file.h"
+#include "bx/timer.h"
+
+#include <algorithm>
+#include <chrono>
+
+static uint32_t getMipBytes(kage::ResourceFormat _format, uint32_t _width, uint32_t _height, uint32_t _texelSz)
+{
+    if (_format < kage::ResourceFormat::undefined)
+    {
+        const uint32_t blockSz = (kage::ResourceFormat::bc1 == _format || kage::ResourceFormat::bc4 == _format) ? 8 : 16;
+        return ((_width + 3) / 4) * ((_height + 3) / 4) * blockSz;
+    }
+
+    return _width * _height * _texelSz;
+}
+
+// the mips of a 2d image are tightly packed and mip major, any range of mips is a range of the data
+static bool buildMipOffsets(StreamedTexture& _tex, const ImageInfo& _info)
+{
+    uint32_t texelSz = 0;
+    if (_info.format >= kage::ResourceFormat::undefined)
+    {
+        uint32_t texelCount = 0;
+        for (uint32_t ii = 0; ii < _info.mipCount; ++ii)
+            texelCount += glm::max(1u, _info.w >> ii) * glm::max(1u, _info.h >> ii);
+
+        texelSz = _info.dataSize / glm::max(1u, texelCount);
+    }
+
+    _tex.mipOffsets.resize(_info.mipCount + 1);
+    _tex.mipOffsets[0] = 0;
+    for (uint32_t ii = 0; ii < _info.mipCount; ++ii)
+    {
+        const uint32_t w = glm::max(1u, _info.w >> ii);
+        const uint32_t h = glm::max(1u, _info.h >> ii);
+        _tex.mipOffsets[ii + 1] = _tex.mipOffsets[ii] + getMipBytes(_info.format, w, h, texelSz);
+    }
+
+    return _tex.mipOffsets[_info.mipCount] == _info.dataSize;
+}
+
+static uint64_t getResidentBytes(const StreamedTexture& _tex, uint32_t _mip)
+{
+    return _tex.mipOffsets[_tex.mipCount] - _tex.mipOffsets[_mip];
+}
+
+// runs on the io jobs as well, only touches the arguments
+static std::vector<uint8_t> readImageData(const std::string& _path, const uint8_t* _mem, int64_t _offset, uint32_t _size)
+{
+    std::vector<uint8_t> data(_size);
+
+    if (_path.empty())
+    {
+        bx::memCopy(data.data(), _mem + _offset, _size);
+        return data;
+    }
+
+    bx::FileReader reader;
+    bx::Error err;
+    if (!bx::open(&reader, _path.c_str(), &err))
+    {
+        return {};
+    }
+
+    bx::seek(&reader, _offset, bx::Whence::Begin);
+    const int32_t read = bx::read(&reader, data.data(), (int32_t)_size, &err);
+    bx::close(&reader);
+
+    if (read != (int32_t)_size)
+    {
+        return {};
+    }
+
+    return data;
+}
+
+static int64_t getImageDataOffset(const Scene& _scene, const ImageInfo& _info)
+{
+    return (_scene.imageDataPath.empty() ? 0 : _scene.imageDataFileOffset) + _info.dataOffset;
+}
+
+static const uint8_t* getImageDataMem(const Scene& _scene)
+{
+    return _scene.imageDataPath.empty() ? _scene.imageDatas.data() : nullptr;
+}
+
+static uint32_t getTopLevel(const StreamedTexture& _tex)
+{
+    uint32_t size = glm::max(_tex.width, _tex.height);
+    uint32_t level = 0;
+    while (size > 1)
+    {
+        size >>= 1;
+        level++;
+    }
+    return level;
+}
+
+void initTextureStreaming(TextureStreaming& _ts, const Scene& _scene, const TextureStreamingInitData& _initData)
+{
+    KG_ZoneScopedC(kage::Color::blue);
+
+    _ts.scene = &_scene;
+    _ts.budget = _initData.budget;
+    _ts.simulate = _initData.simulate;
+    _ts.gpuFeedback = _initData.gpuFeedback && !_initData.simulate;
+
+    const uint8_t* dataMem = getImageDataMem(_scene);
+
+    _ts.textures.resize(_scene.images.size());
+    for (size_t ii = 0; ii < _scene.images.size(); ++ii)
+    {
+        const ImageInfo& info = _scene.images[ii];
+        StreamedTexture& tex = _ts.textures[ii];
+
+        tex.width = info.w;
+        tex.height = info.h;
+        tex.mipCount = info.mipCount;
+        tex.dataOffset = getImageDataOffset(_scene, info);
+
+        tex.streamed = (1 == info.layerCount) && !info.isCubeMap && info.mipCount > 1;
+        if (tex.streamed && !buildMipOffsets(tex, info))
+        {
+            message(warning, "texture streaming: unexpected mip layout of %s, keep it resident", info.name);
+            tex.streamed = false;
+        }
+
+        tex.tailMip = 0;
+        if (tex.streamed)
+        {
+            while (tex.tailMip + 1 < tex.mipCount
+                && glm::max(tex.width >> tex.tailMip, tex.height >> tex.tailMip) > kTexStreamTailSize)
+            {
+                tex.tailMip++;
+            }
+        }
+        tex.residentMip = tex.tailMip;
+        tex.wantedMip = tex.tailMip;
+
+        // the simulated mode uploads the whole image, the residency is tracked from the tail anyway
+        const uint32_t firstMip = _ts.simulate ? 0 : tex.tailMip;
+        const uint32_t offset = tex.streamed ? tex.mipOffsets[firstMip] : 0;
+        const uint32_t size = info.dataSize - offset;
+
+        std::vector<uint8_t> data = readImageData(_scene.imageDataPath, dataMem, tex.dataOffset + offset, size);
+        if (data.empty())
+        {
+            message(error, "texture streaming: failed to read %s", info.name);
+            data.resize(size);
+        }
+
+        kage::ImageDesc imgDesc;
+        imgDesc.width = glm::max(1u, info.w >> firstMip);
+        imgDesc.height = glm::max(1u, info.h >> firstMip);
+        imgDesc.depth = 1;
+        imgDesc.numLayers = info.layerCount;
+        imgDesc.numMips = info.mipCount - firstMip;
+        imgDesc.format = info.format;
+        imgDesc.type = (info.layerCount > 1) ? kage::ImageType::type_3d : kage::ImageType::type_2d;
+        imgDesc.viewType = info.isCubeMap ? kage::ImageViewType::type_cube : kage::ImageViewType::type_2d;
+        // the shared mips are copied to the re-created image
+        imgDesc.usage = kage::ImageUsageFlagBits::sampled | kage::ImageUsageFlagBits::transfer_dst | kage::ImageUsageFlagBits::transfer_src;
+
+        tex.image = kage::registTexture(info.name, imgDesc, kage::copy(data.data(), size));
+
+        _ts.residentBytes += tex.streamed ? getResidentBytes(tex, tex.residentMip) : info.dataSize;
+    }
+
+    _ts.feedback.resize(_scene.images.size() + 1, 0);
+
+    if (_ts.gpuFeedback)
+    {
+        const kage::Memory* mem = kage::alloc(uint32_t(_ts.feedback.size() * sizeof(uint32_t)));
+        bx::memSet(mem->data, 0, mem->size);
+
+        kage::BufferDesc desc;
+        desc.size = mem->size;
+        desc.usage = kage::BufferUsageFlagBits::storage | kage::BufferUsageFlagBits::transfer_dst;
+        desc.memFlags = kage::MemoryPropFlagBits::device_local | kage::MemoryPropFlagBits::host_visible;
+        _ts.feedbackBuf = kage::registBuffer("tex_feedback", desc, mem, kage::ResourceLifetime::non_transition);
+    }
+
+    if (_ts.residentBytes > _ts.budget)
+    {
+        message(warning, "texture streaming: the tails take %.1f MB, over the budget of %.1f MB"
+            , float(_ts.residentBytes) / (1024.f * 1024.f), float(_ts.budget) / (1024.f * 1024.f));
+    }
+}
+
+void getStreamedImages(const TextureStreaming& _ts, std::vector<kage::ImageHandle>& _out)
+{
+    for (const StreamedTexture& tex : _ts.textures)
+        _out.emplace_back(tex.image);
+}
+
+// the projected size of each draw in pixels, with the uv assumed to span the mesh once
+// the same encoding as texture_feedback.h
+static void estimateFeedback(TextureStreaming& _ts, const TransformData& _trans, const Constants& _consts)
+{
+    const Scene& scene = *_ts.scene;
+    const vec3 camPos = vec3(_trans.cameraPos);
+
+    for (uint32_t ii = 0; ii < scene.drawCount; ++ii)
+    {
+        const MeshDraw& draw = scene.meshDraws[ii];
+        const Mesh& mesh = scene.geometry.meshes[draw.meshIdx];
+
+        const float scale = glm::max(draw.scale.x, glm::max(draw.scale.y, draw.scale.z));
+        const vec3 center = draw.pos + draw.orit * (mesh.center * draw.scale);
+        const float radius = mesh.radius * scale;
+
+        const float dist = glm::max(glm::length(center - camPos) - radius, _consts.znear);
+        const float pixels = radius / dist * _consts.P11 * _consts.screenHeight;
+        if (pixels < 1.f)
+            continue;
+
+        const uint32_t level = (uint32_t)glm::clamp(glm::ceil(glm::log2(pixels)), 0.f, float(kTexFeedbackMaxLevel)) + 1;
+
+        const uint32_t texs[] = { draw.albedoTex, draw.normalTex, draw.specularTex, draw.emissiveTex };
+        for (uint32_t tex : texs)
+        {
+            if (tex > 0 && tex < _ts.feedback.size())
+                _ts.feedback[tex] = glm::max(_ts.feedback[tex], level);
+        }
+    }
+}
+
+static void gatherFeedback(TextureStreaming& _ts, const TransformData& _trans, const Constants& _consts)
+{
+    std::fill(_ts.feedback.begin(), _ts.feedback.end(), 0u);
+
+    if (!_ts.gpuFeedback)
+    {
+        estimateFeedback(_ts, _trans, _consts);
+        return;
+    }
+
+    const uint32_t size = uint32_t(_ts.feedback.size() * sizeof(uint32_t));
+    if (!kage::readBuffer(_ts.feedbackBuf, _ts.feedback.data(), size))
+        return;
+
+    // the levels are the max since the last read back
+    const kage::Memory* mem = kage::alloc(size);
+    bx::memSet(mem->data, 0, mem->size);
+    kage::updateBuffer(_ts.feedbackBuf, mem);
+}
+
+static void applyFeedback(TextureStreaming& _ts)
+{
+    for (uint32_t ii = 0; ii < (uint32_t)_ts.textures.size(); ++ii)
+    {
+        StreamedTexture& tex = _ts.textures[ii];
+        if (!tex.streamed)
+            continue;
+
+        // the bindless index is shifted by the invalid texture
+        const uint32_t level = _ts.feedback[ii + 1];
+        if (0 == level)
+        {
+            tex.wantedMip = tex.tailMip;
+            continue;
+        }
+
+        // the level - 1 is the log2 of the size that maps a texel to a pixel
+        const int32_t mip = int32_t(getTopLevel(tex)) - int32_t(level - 1);
+        tex.wantedMip = (uint32_t)glm::clamp(mip, 0, int32_t(tex.tailMip));
+        tex.lastUsed = _ts.updateIdx;
+    }
+}
+
+// drop the mips down to _mip, the image keeps its tail
+static void evictTexture(TextureStreaming& _ts, StreamedTexture& _tex, uint32_t _mip)
+{
+    if (!_ts.simulate)
+    {
+        kage::updateImageMips(_tex.image
+            , glm::max(1u, _tex.width >> _mip)
+            , glm::max(1u, _tex.height >> _mip)
+            , _tex.mipCount - _mip
+        );
+    }
+
+    _ts.residentBytes -= getResidentBytes(_tex, _tex.residentMip) - getResidentBytes(_tex, _mip);
+    _tex.residentMip = _mip;
+    _ts.evictedCount++;
+}
+
+static uint32_t finishLoads(TextureStreaming& _ts)
+{
+    uint32_t swaps = 0;
+    for (auto it = _ts.loads.begin(); it != _ts.loads.end() && swaps < kTexStreamMaxSwaps; )
+    {
+        const bool ready = _ts.simulate
+            ? _ts.updateIdx >= it->readyUpdate
+            : it->data.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+
+        if (!ready)
+        {
+            ++it;
+            continue;
+        }
+
+        StreamedTexture& tex = _ts.textures[it->tex];
+        tex.loadingMip = kTexStreamNotLoading;
+        _ts.pendingBytes -= it->bytes;
+
+        if (!_ts.simulate)
+        {
+            std::vector<uint8_t> data = it->data.get();
+            if (data.empty())
+            {
+                message(warning, "texture streaming: failed to read the mips of %s", _ts.scene->images[it->tex].name);
+                it = _ts.loads.erase(it);
+                continue;
+            }
+
+            kage::updateImageMips(tex.image
+                , glm::max(1u, tex.width >> it->mip)
+                , glm::max(1u, tex.height >> it->mip)
+                , tex.mipCount - it->mip
+                , kage::copy(data.data(), (uint32_t)data.size())
+            );
+        }
+
+        _ts.residentBytes += it->bytes;
+        tex.residentMip = it->mip;
+        _ts.loadedCount++;
+        swaps++;
+
+        it = _ts.loads.erase(it);
+    }
+
+    return swaps;
+}
+
+// the least recently sampled textures drop to the tail, then the sampled ones drop their unused mips
+static bool makeRoom(TextureStreaming& _ts, uint64_t _bytes, uint32_t& _swaps)
+{
+    std::vector<uint32_t> candidates;
+    for (uint32_t ii = 0; ii < (uint32_t)_ts.textures.size(); ++ii)
+    {
+        const StreamedTexture& tex = _ts.textures[ii];
+        if (tex.streamed && kTexStreamNotLoading == tex.loadingMip && tex.residentMip < tex.wantedMip)
+            candidates.push_back(ii);
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [&_ts](uint32_t _a, uint32_t _b) {
+        return _ts.textures[_a].lastUsed < _ts.textures[_b].lastUsed;
+    });
+
+    for (uint32_t idx : candidates)
+    {
+        if (_ts.residentBytes + _ts.pendingBytes + _bytes <= _ts.budget || _swaps >= kTexStreamMaxSwaps)
+            break;
+
+        StreamedTexture& tex = _ts.textures[idx];
+        evictTexture(_ts, tex, tex.wantedMip);
+        _swaps++;
+    }
+
+    return _ts.residentBytes + _ts.pendingBytes + _bytes <= _ts.budget;
+}
+
+static void issueLoads(TextureStreaming& _ts, uint32_t& _swaps)
+{
+    std::vector<uint32_t> candidates;
+    for (uint32_t ii = 0; ii < (uint32_t)_ts.textures.size(); ++ii)
+    {
+        const StreamedTexture& tex = _ts.textures[ii];
+        if (tex.streamed && kTexStreamNotLoading == tex.loadingMip && tex.wantedMip < tex.residentMip)
+            candidates.push_back(ii);
+    }
+
+    // the most under resolved first
+    std::sort(candidates.begin(), candidates.end(), [&_ts](uint32_t _a, uint32_t _b) {
+        const StreamedTexture& a = _ts.textures[_a];
+        const StreamedTexture& b = _ts.textures[_b];
+        return (a.residentMip - a.wantedMip) > (b.residentMip - b.wantedMip);
+    });
+
+    const uint8_t* dataMem = getImageDataMem(*_ts.scene);
+
+    for (uint32_t idx : candidates)
+    {
+        if (_ts.loads.size() >= kTexStreamMaxLoads)
+            break;
+
+        StreamedTexture& tex = _ts.textures[idx];
+        const uint64_t bytes = getResidentBytes(tex, tex.wantedMip) - getResidentBytes(tex, tex.residentMip);
+
+        if (!makeRoom(_ts, bytes, _swaps))
+            continue;
+
+        TextureStreamLoad load;
+        load.tex = idx;
+        load.mip = tex.wantedMip;
+        load.readyUpdate = _ts.updateIdx + kTexStreamSimLatency;
+        load.bytes = bytes;
+
+        // the new mips are right ahead of the resident ones
+        if (!_ts.simulate)
+        {
+            const int64_t offset = tex.dataOffset + tex.mipOffsets[tex.wantedMip];
+            load.data = std::async(std::launch::async, readImageData, _ts.scene->imageDataPath, dataMem, offset, (uint32_t)bytes);
+        }
+
+        tex.loadingMip = tex.wantedMip;
+        _ts.pendingBytes += bytes;
+        _ts.loads.emplace_back(std::move(load));
+    }
+}
+
+void updateTextureStreaming(TextureStreaming& _ts, const TransformData& _trans, const Constants& _consts)
+{
+    KG_ZoneScopedC(kage::Color::blue);
+
+    if (_ts.frameIdx++ % kTexStreamFeedbackInterval != 0)
+        return;
+
+    const int64_t start = bx::getHPCounter();
+    _ts.updateIdx++;
+
+    gatherFeedback(_ts, _trans, _consts);
+    applyFeedback(_ts);
+
+    uint32_t swaps = finishLoads(_ts);
+    issueLoads(_ts, swaps);
+
+    _ts.cpuTime = float(double(bx::getHPCounter() - start) * 1000.0 / double(bx::getHPFrequency()));
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "core/kage.h"
+#include "scene/scene.h"
+#include "demo_structs.h"
+
+#include <vector>
+#include <future>
+
+// mip streaming of the scene textures in the bindless array
+// the textures are created with the mip tail only, the mips up to kTexStreamTailSize are never evicted
+// the hard raster writes the finest level each texture is sampled at into a feedback buffer, it is read back every few frames
+// the missing mips are read from the .scene on background jobs, the image is then re-created with the new top mip
+// the resident bytes are kept under the budget, the least recently sampled textures drop their mips first
+// the simulated mode estimates the feedback from the draw bounds and completes the loads after a fixed delay,
+// the images stay at the full size, only the residency is tracked
+// keep sync with texture_feedback.h
+constexpr uint32_t kTexStreamTailSize = 128;
+constexpr uint32_t kTexStreamFeedbackInterval = 4;
+constexpr uint32_t kTexStreamMaxLoads = 4;
+constexpr uint32_t kTexStreamMaxSwaps = 8; // the re-created images per update, loads and evictions together
+constexpr uint32_t kTexStreamSimLatency = 3; // the updates a simulated load takes
+constexpr uint32_t kTexFeedbackMaxLevel = 15;
+constexpr uint32_t kTexStreamNotLoading = ~0u;
+
+struct TextureStreamingInitData
+{
+    uint64_t budget{ 256ull << 20 }; // all resident bytes, the tails included
+    bool gpuFeedback{ true }; // the feedback is estimated on the cpu if false
+    bool simulate{ false };
+};
+
+struct StreamedTexture
+{
+    kage::ImageHandle image;
+
+    uint32_t width, height; // of the mip 0
+    uint32_t mipCount;
+
+    uint32_t tailMip; // the finest mip of the tail
+    uint32_t residentMip; // the finest resident mip
+    uint32_t wantedMip;
+    uint32_t loadingMip{ kTexStreamNotLoading };
+
+    uint64_t lastUsed{ 0 }; // the update it was last sampled in
+
+    // in the .scene or in the Scene::imageDatas
+    int64_t dataOffset;
+    // mipCount + 1 entries, relative to the dataOffset
+    std::vector<uint32_t> mipOffsets;
+
+    // layered and cube images stay resident as a whole
+    bool streamed{ false };
+};
+
+struct TextureStreamLoad
+{
+    uint32_t tex;
+    uint32_t mip;
+    uint64_t readyUpdate; // simulated only
+    uint64_t bytes;
+
+    std::future<std::vector<uint8_t>> data;
+};
+
+struct TextureStreaming
+{
+    const Scene* scene{ nullptr };
+
+    std::vector<StreamedTexture> textures;
+    std::vector<TextureStreamLoad> loads;
+
+    // imageCount + 1 entries, 0 is the invalid texture of the bindless array
+    std::vector<uint32_t> feedback;
+    kage::BufferHandle feedbackBuf;
+
+    uint64_t budget;
+    uint64_t residentBytes{ 0 };
+    uint64_t pendingBytes{ 0 };
+
+    bool gpuFeedback;
+    bool simulate;
+
+    uint32_t frameIdx{ 0 };
+    uint64_t updateIdx{ 0 };
+
+    // stats
+    uint32_t loadedCount{ 0 };
+    uint32_t evictedCount{ 0 };
+    float cpuTime{ 0.f };
+};
+
+// register the scene images, in the order of Scene::images
+void initTextureStreaming(TextureStreaming& _ts, const Scene& _scene, const TextureStreamingInitData& _initData);
+
+// the handles for the bindless array
+void getStreamedImages(const TextureStreaming& _ts, std::vector<kage::ImageHandle>& _out);
+
+// read the feedback, apply the finished loads and issue the new ones, must be called before kage::render()
+// the transform and constants are used by the cpu estimated feedback only
+void updateTextureStreaming(TextureStreaming& _ts, const TransformData& _trans, const Constants& _consts);
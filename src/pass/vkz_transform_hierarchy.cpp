@@ -0,0 +1,335 @@
+#include "vkz_transform_hierarchy.h"
+#include "vkz_pass.h"
+
+#include "core/kage_math.h"
+#include "core/profiler.h"
+
+// keep sync with the TRANSFORM_MODE_* in mesh_gpu.h
+enum class TransformMode : uint32_t
+{
+    scatter = 0,
+    resolve = 1,
+    draws = 2,
+};
+
+struct TransformHierarchyConsts
+{
+    uint32_t mode;
+    uint32_t offset;
+    uint32_t count;
+    uint32_t padding;
+};
+
+static void recTransformDispatch(const TransformHierarchy& _th, TransformMode _mode, uint32_t _offset, uint32_t _count)
+{
+    TransformHierarchyConsts consts{ (uint32_t)_mode, _offset, _count, 0 };
+
+    const kage::Memory* mem = kage::alloc(sizeof(TransformHierarchyConsts));
+    memcpy(mem->data, &consts, mem->size);
+
+    kage::setConstants(mem);
+
+    kage::Binding binds[] =
+    {
+        { _th.updateBuf,        BindingAccess::read,        Stage::compute_shader },
+        { _th.drawNodeBuf,      BindingAccess::read,        Stage::compute_shader },
+        { _th.nodeBuf,          BindingAccess::read_write,  Stage::compute_shader },
+        { _th.worldBuf,         BindingAccess::read_write,  Stage::compute_shader },
+        { _th.meshDrawBuf,      BindingAccess::read_write,  Stage::compute_shader },
+        { _th.prevDrawBuf,      BindingAccess::read_write,  Stage::compute_shader },
+    };
+    kage::pushBindings(binds, COUNTOF(binds));
+
+    kage::dispatch(_count, 1, 1);
+}
+
+static void recTransformHierarchy(const TransformHierarchy& _th, uint32_t _updateCount, uint32_t _resolveLevel, bool _writeDraws)
+{
+    KG_ZoneScopedC(kage::Color::blue);
+
+    kage::startRec(_th.pass);
+
+    if (_updateCount > 0)
+        recTransformDispatch(_th, TransformMode::scatter, 0, _updateCount);
+
+    const uint32_t levelCount = (uint32_t)_th.levelOffsets.size() - 1;
+    if (_resolveLevel < levelCount)
+    {
+        // levels above the lowest dirty one are still valid from last resolve
+        for (uint32_t ii = _resolveLevel; ii < levelCount; ++ii)
+        {
+            const uint32_t offset = _th.levelOffsets[ii];
+            const uint32_t count = _th.levelOffsets[ii + 1] - offset;
+            recTransformDispatch(_th, TransformMode::resolve, offset, count);
+        }
+    }
+
+    // also runs the frame after a resolve, so the previous transforms equal the current ones again
+    if (_writeDraws)
+        recTransformDispatch(_th, TransformMode::draws, 0, _th.drawCount);
+
+    kage::endRec();
+}
+
+void initTransformHierarchy(TransformHierarchy& _th, const Scene& _scene, const TransformHierarchyInitData& _initData)
+{
+    assert(!_scene.transformNodes.empty());
+    assert(_scene.drawNodes.size() == _scene.meshDraws.size());
+
+    const uint32_t nodeCount = (uint32_t)_scene.transformNodes.size();
+    const uint32_t drawCount = (uint32_t)_scene.drawNodes.size();
+
+    kage::ShaderHandle cs = kage::registShader("transform_hierarchy", "shader/transform_hierarchy.comp.spv");
+    kage::ProgramHandle prog = kage::registProgram("transform_hierarchy", { cs }, sizeof(TransformHierarchyConsts));
+
+    kage::PassDesc passDesc;
+    passDesc.prog = prog;
+    passDesc.queue = kage::PassExeQueue::compute;
+    kage::PassHandle pass = kage::registPass("transform_hierarchy", passDesc);
+
+    // local transforms
+    kage::BufferHandle nodeBuf;
+    {
+        const kage::Memory* mem = kage::alloc(nodeCount * sizeof(TransformNode));
+        memcpy(mem->data, _scene.transformNodes.data(), mem->size);
+
+        kage::BufferDesc desc;
+        desc.size = mem->size;
+        desc.usage = kage::BufferUsageFlagBits::storage | kage::BufferUsageFlagBits::transfer_dst;
+        desc.memFlags = kage::MemoryPropFlagBits::device_local;
+        nodeBuf = kage::registBuffer("transform_nodes", desc, mem);
+    }
+
+    // world transforms, resolved in the first frame
+    kage::BufferHandle worldBuf;
+    {
+        kage::BufferDesc desc;
+        desc.size = nodeCount * sizeof(TransformNode);
+        desc.usage = kage::BufferUsageFlagBits::storage | kage::BufferUsageFlagBits::transfer_dst;
+        desc.memFlags = kage::MemoryPropFlagBits::device_local;
+        worldBuf = kage::registBuffer("transform_worlds", desc);
+    }
+
+    // node index of each draw
+    kage::BufferHandle drawNodeBuf;
+    {
+        const kage::Memory* mem = kage::alloc(drawCount * sizeof(uint32_t));
+        memcpy(mem->data, _scene.drawNodes.data(), mem->size);
+
+        kage::BufferDesc desc;
+        desc.size = mem->size;
+        desc.usage = kage::BufferUsageFlagBits::storage | kage::BufferUsageFlagBits::transfer_dst;
+        desc.memFlags = kage::MemoryPropFlagBits::device_local;
+        drawNodeBuf = kage::registBuffer("draw_nodes", desc, mem);
+    }
+
+    // draw transforms of the previous frame, the draws mode keeps it one frame behind
+    std::vector<TransformNode> worlds(nodeCount);
+    for (uint32_t ii = 0; ii < nodeCount; ++ii)
+    {
+        const TransformNode& local = _scene.transformNodes[ii];
+        worlds[ii] = (local.parent == kInvalidTransformNode) ? local : combineTransform(worlds[local.parent], local);
+    }
+
+    kage::BufferHandle prevDrawBuf;
+    {
+        const kage::Memory* mem = kage::alloc(drawCount * sizeof(TransformNode));
+        TransformNode* prevDraws = (TransformNode*)mem->data;
+        for (uint32_t ii = 0; ii < drawCount; ++ii)
+        {
+            prevDraws[ii] = worlds[_scene.drawNodes[ii]];
+        }
+
+        kage::BufferDesc desc;
+        desc.size = mem->size;
+        desc.usage = kage::BufferUsageFlagBits::storage | kage::BufferUsageFlagBits::transfer_dst;
+        desc.memFlags = kage::MemoryPropFlagBits::device_local;
+        prevDrawBuf = kage::registBuffer("transform_prev_draws", desc, mem);
+    }
+
+    // dirty nodes of the frame, only the used part is uploaded
+    const uint32_t maxUpdates = glm::max(1u, glm::min(_initData.maxUpdatesPerFrame, nodeCount));
+    kage::BufferHandle updateBuf;
+    {
+        kage::BufferDesc desc;
+        desc.size = maxUpdates * sizeof(TransformNodeUpdate);
+        desc.usage = kage::BufferUsageFlagBits::storage | kage::BufferUsageFlagBits::transfer_dst;
+        desc.memFlags = kage::MemoryPropFlagBits::device_local | kage::MemoryPropFlagBits::host_visible;
+        updateBuf = kage::registBuffer("transform_node_updates", desc);
+    }
+
+    kage::BufferHandle nodeBufOutAlias = kage::alias(nodeBuf);
+    kage::BufferHandle worldBufOutAlias = kage::alias(worldBuf);
+    kage::BufferHandle meshDrawBufOutAlias = kage::alias(_initData.meshDrawBuf);
+    kage::BufferHandle prevDrawBufOutAlias = kage::alias(prevDrawBuf);
+
+    kage::bindBuffer(pass, updateBuf
+        , Stage::compute_shader
+        , Access::shader_read
+    );
+
+    kage::bindBuffer(pass, drawNodeBuf
+        , Stage::compute_shader
+        , Access::shader_read
+    );
+
+    kage::bindBuffer(pass, nodeBuf
+        , Stage::compute_shader
+        , Access::shader_read | Access::shader_write
+        , nodeBufOutAlias
+    );
+
+    kage::bindBuffer(pass, worldBuf
+        , Stage::compute_shader
+        , Access::shader_read | Access::shader_write
+        , worldBufOutAlias
+    );
+
+    kage::bindBuffer(pass, _initData.meshDrawBuf
+        , Stage::compute_shader
+        , Access::shader_read | Access::shader_write
+        , meshDrawBufOutAlias
+    );
+
+    kage::bindBuffer(pass, prevDrawBuf
+        , Stage::compute_shader
+        , Access::shader_read | Access::shader_write
+        , prevDrawBufOutAlias
+    );
+
+    _th.pass = pass;
+    _th.cs = cs;
+    _th.prog = prog;
+
+    _th.updateBuf = updateBuf;
+    _th.drawNodeBuf = drawNodeBuf;
+    _th.nodeBuf = nodeBuf;
+    _th.worldBuf = worldBuf;
+    _th.meshDrawBuf = _initData.meshDrawBuf;
+    _th.prevDrawBuf = prevDrawBuf;
+
+    _th.nodeBufOutAlias = nodeBufOutAlias;
+    _th.worldBufOutAlias = worldBufOutAlias;
+    _th.meshDrawBufOutAlias = meshDrawBufOutAlias;
+    _th.prevDrawBufOutAlias = prevDrawBufOutAlias;
+
+    _th.nodeCount = nodeCount;
+    _th.drawCount = drawCount;
+    _th.maxUpdatesPerFrame = maxUpdates;
+
+    _th.nodes = _scene.transformNodes;
+    _th.levelOffsets = _scene.transformLevelOffsets;
+
+    _th.dirtyNodes.clear();
+    _th.dirtyFlags.assign(nodeCount, 0);
+
+    _th.appliedNodes = _scene.transformNodes;
+    _th.worlds = std::move(worlds);
+    _th.movedNodes.assign(nodeCount, 0);
+    _th.drawNodes = _scene.drawNodes;
+    _th.movedDraws.clear();
+
+    // the world buffer is empty, resolve all levels in the first update
+    _th.resolveLevel = 0;
+}
+
+void setNodeTransform(TransformHierarchy& _th, uint32_t _nodeIdx, const vec3& _pos, const quat& _orit, const vec3& _scale)
+{
+    assert(_nodeIdx < _th.nodeCount);
+
+    TransformNode& node = _th.nodes[_nodeIdx];
+    node.pos = _pos;
+    node.orit = _orit;
+    node.scale = _scale;
+
+    if (0 == _th.dirtyFlags[_nodeIdx])
+    {
+        _th.dirtyFlags[_nodeIdx] = 1;
+        _th.dirtyNodes.push_back(_nodeIdx);
+    }
+}
+
+const TransformNode& getNodeTransform(const TransformHierarchy& _th, uint32_t _nodeIdx)
+{
+    assert(_nodeIdx < _th.nodeCount);
+    return _th.nodes[_nodeIdx];
+}
+
+const TransformNode& getDrawTransform(const TransformHierarchy& _th, uint32_t _drawIdx)
+{
+    assert(_drawIdx < _th.drawCount);
+    return _th.worlds[_th.drawNodes[_drawIdx]];
+}
+
+// same levels as the compute pass, a node moved if its local or its parent moved
+static void resolveCpuWorlds(TransformHierarchy& _th, uint32_t _resolveLevel)
+{
+    KG_ZoneScopedC(kage::Color::blue);
+
+    _th.movedDraws.clear();
+
+    const uint32_t levelCount = (uint32_t)_th.levelOffsets.size() - 1;
+    if (_resolveLevel >= levelCount)
+        return;
+
+    const uint32_t start = _th.levelOffsets[_resolveLevel];
+    for (uint32_t ni = start; ni < _th.nodeCount; ++ni)
+    {
+        const TransformNode& local = _th.appliedNodes[ni];
+        const TransformNode world = (local.parent == kInvalidTransformNode) ? local : combineTransform(_th.worlds[local.parent], local);
+
+        TransformNode& prev = _th.worlds[ni];
+        _th.movedNodes[ni] = (world.pos != prev.pos || world.orit != prev.orit || world.scale != prev.scale) ? 1 : 0;
+        prev = world;
+    }
+
+    for (uint32_t di = 0; di < _th.drawCount; ++di)
+    {
+        const uint32_t ni = _th.drawNodes[di];
+        if (ni >= start && _th.movedNodes[ni])
+            _th.movedDraws.push_back(di);
+    }
+}
+
+void updateTransformHierarchy(TransformHierarchy& _th)
+{
+    KG_ZoneScopedC(kage::Color::blue);
+
+    const uint32_t updateCount = glm::min((uint32_t)_th.dirtyNodes.size(), _th.maxUpdatesPerFrame);
+
+    uint32_t resolveLevel = _th.resolveLevel;
+    if (updateCount > 0)
+    {
+        const kage::Memory* mem = kage::alloc(updateCount * sizeof(TransformNodeUpdate));
+        TransformNodeUpdate* updates = (TransformNodeUpdate*)mem->data;
+
+        for (uint32_t ii = 0; ii < updateCount; ++ii)
+        {
+            const uint32_t nodeIdx = _th.dirtyNodes[ii];
+
+            updates[ii] = {};
+            updates[ii].nodeIdx = nodeIdx;
+            updates[ii].node = _th.nodes[nodeIdx];
+
+            resolveLevel = glm::min(resolveLevel, _th.nodes[nodeIdx].level);
+            _th.dirtyFlags[nodeIdx] = 0;
+            _th.appliedNodes[nodeIdx] = _th.nodes[nodeIdx];
+        }
+
+        kage::updateBuffer(_th.updateBuf, mem, 0, mem->size);
+
+        // over budget, the rest are uploaded in the next frame
+        _th.dirtyNodes.erase(_th.dirtyNodes.begin(), _th.dirtyNodes.begin() + updateCount);
+    }
+
+    const bool resolved = resolveLevel < _th.levelOffsets.size() - 1;
+    recTransformHierarchy(_th, updateCount, resolveLevel, resolved || _th.settleDraws);
+    resolveCpuWorlds(_th, resolveLevel);
+    _th.settleDraws = resolved;
+
+    _th.uploadedCount = updateCount;
+    _th.resolvedLevels = resolved
+        ? (uint32_t)_th.levelOffsets.size() - 1 - resolveLevel
+        : 0;
+    _th.resolveLevel = kNoDirtyTransformLevel;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "core/kage.h"
+#include "scene/scene.h"
+
+#include <vector>
+
+// gpu side transform hierarchy
+// the local transforms live in a device buffer, the cpu only uploads the dirty nodes each frame
+// then the compute pass scatters them, resolves the world transform level by level and writes the draws
+// the draw transforms of the previous frame are kept for the per-object motion
+struct TransformHierarchyInitData
+{
+    kage::BufferHandle meshDrawBuf;
+
+    uint32_t maxUpdatesPerFrame{ 64 * 1024 }; // dirty nodes beyond this are deferred to the next frame
+};
+
+constexpr uint32_t kNoDirtyTransformLevel = ~0u;
+
+struct alignas(16) TransformNodeUpdate
+{
+    uint32_t nodeIdx;
+    uint32_t padding[3];
+
+    TransformNode node;
+};
+
+struct TransformHierarchy
+{
+    kage::PassHandle pass;
+    kage::ShaderHandle cs;
+    kage::ProgramHandle prog;
+
+    // read-only
+    kage::BufferHandle updateBuf;
+    kage::BufferHandle drawNodeBuf;
+
+    // read / write
+    kage::BufferHandle nodeBuf;
+    kage::BufferHandle worldBuf;
+    kage::BufferHandle meshDrawBuf;
+    kage::BufferHandle prevDrawBuf; // TransformNode of each draw, as of the previous frame
+
+    // out alias
+    kage::BufferHandle nodeBufOutAlias;
+    kage::BufferHandle worldBufOutAlias;
+    kage::BufferHandle meshDrawBufOutAlias;
+    kage::BufferHandle prevDrawBufOutAlias;
+
+    uint32_t nodeCount{ 0 };
+    uint32_t drawCount{ 0 };
+    uint32_t maxUpdatesPerFrame{ 0 };
+
+    // cpu copy of the local transforms, the source of the updates
+    std::vector<TransformNode> nodes;
+    std::vector<uint32_t> levelOffsets;
+
+    // dirty nodes of current frame
+    std::vector<uint32_t> dirtyNodes;
+    std::vector<uint8_t> dirtyFlags;
+    uint32_t resolveLevel{ kNoDirtyTransformLevel }; // lowest level that needs resolve besides the dirty nodes
+    bool settleDraws{ false }; // the draws moved in the last update, the previous transforms catch up in the next one
+
+    // cpu mirror of the resolve in the compute pass, for the cpu side consumers of the draw transforms
+    std::vector<TransformNode> appliedNodes; // the uploaded local transforms, the deferred updates are not in it
+    std::vector<TransformNode> worlds;
+    std::vector<uint8_t> movedNodes;
+    std::vector<uint32_t> drawNodes;
+
+    // draws whose world transform changed in the last update
+    std::vector<uint32_t> movedDraws;
+
+    // stats
+    uint32_t uploadedCount{ 0 };
+    uint32_t resolvedLevels{ 0 };
+};
+
+void initTransformHierarchy(TransformHierarchy& _th, const Scene& _scene, const TransformHierarchyInitData& _initData);
+
+// change the local transform of a node, the node and all its children are updated in next updateTransformHierarchy
+void setNodeTransform(TransformHierarchy& _th, uint32_t _nodeIdx, const vec3& _pos, const quat& _orit, const vec3& _scale);
+
+const TransformNode& getNodeTransform(const TransformHierarchy& _th, uint32_t _nodeIdx);
+
+// the world transform of a draw as of the last update, the same the gpu resolves
+const TransformNode& getDrawTransform(const TransformHierarchy& _th, uint32_t _drawIdx);
+
+void updateTransformHierarchy(TransformHierarchy& _th);
@@ -13,6 +13,7 @@
 #include <cstring>
 #include <vector>
 #include <unordered_map>
+#include <algorithm>
 
 using HashId = uint64_t;
 
@@ -373,6 +374,23 @@ void updataContentRCBuild(Dbg_RadianceCascades& _rc)
     ImGui::SliderInt("cas count", (int*)&_rc.cascadeCount, 1, 8);
     ImGui::Checkbox("follow Cam", &_rc.followCam);
     ImGui::Checkbox("pause update", &_rc.pauseUpdate);  
+    ImGui::SliderFloat("ray budget(M)", &_rc.rayBudgetM, 0.f, 64.f);
+    ImGui::Checkbox("sparse probes", &_rc.sparseProbes);
+    ImGui::Checkbox("dynamic occupancy", &_rc.dynamicOccupancy);
+
+    // level 0 sizes, the other levels follow them. the images are resized on change
+    static const char* const side_counts[] = { "8", "16", "32" };
+    int probeSideIdx = 0;
+    while (probeSideIdx < int(COUNTOF(side_counts)) - 1 && (8u << probeSideIdx) < _rc.probeSideCount)
+        ++probeSideIdx;
+    int raySideIdx = 0;
+    while (raySideIdx < int(COUNTOF(side_counts)) - 1 && (8u << raySideIdx) < _rc.rayGridSideCount)
+        ++raySideIdx;
+
+    if (ImGui::Combo("probe side", &probeSideIdx, side_counts, COUNTOF(side_counts)))
+        _rc.probeSideCount = 8u << probeSideIdx;
+    if (ImGui::Combo("ray grid side", &raySideIdx, side_counts, COUNTOF(side_counts)))
+        _rc.rayGridSideCount = 8u << raySideIdx;
     
     ImGui::End();
 }
@@ -407,12 +425,132 @@ void updateContentBrx(Dbg_Brixel& _brx)
     ImGui::SliderFloat("sdf eps", &_brx.sdfEps, 0.1f, 10.f);
     ImGui::SliderFloat("tmin", &_brx.tmin, .2f, 10.f);
     ImGui::SliderFloat("tmax", &_brx.tmax, 1000.f, 10000.f);
+    ImGui::SliderInt("bricks per bake", (int*)&_brx.maxBricksPerBake, 256, 1 << 16);
     ImGui::Checkbox("follow Cam", &_brx.followCam);
+    ImGui::Checkbox("animate instances", &_brx.animateInstances);
+    ImGui::Checkbox("hide instances", &_brx.hideInstances);
     ImGui::Image((ImTextureID)(_brx.presentImg.id), { 640, 360 });
 
     ImGui::End();
 }
 
+// the transient buckets as bars over the passes, the largest first
+constexpr uint32_t kMemoryTimelineMaxRows = 32;
+
+void updateContentMemory()
+{
+    KG_ZoneScopedC(kage::Color::blue);
+
+    ImGui::SetNextWindowSize({ 480, 420 }, ImGuiCond_FirstUseEver);
+    ImGui::Begin("memory:");
+
+    const float toMB = 1.f / (1024.f * 1024.f);
+
+    const kage::MemoryStats stats = kage::getMemoryStats();
+
+    static std::vector<kage::MemoryPassUsage> passes;
+    passes.resize(kage::getMemoryPassUsage(nullptr, 0));
+    kage::getMemoryPassUsage(passes.data(), (uint32_t)passes.size());
+
+    static std::vector<kage::MemoryBucket> buckets;
+    buckets.resize(kage::getMemoryBuckets(nullptr, 0));
+    kage::getMemoryBuckets(buckets.data(), (uint32_t)buckets.size());
+
+    const char* peakName = "-";
+    for (const kage::MemoryPassUsage& usage : passes)
+    {
+        if (usage.pass.id == stats.peakPass.id)
+        {
+            peakName = usage.name;
+        }
+    }
+
+    ImGui::Text("allocated: %.2f MB, %u buckets, %u buffers, %u images", float(stats.allocatedBytes) * toMB, stats.bucketCount, stats.bufferCount, stats.imageCount);
+    ImGui::Text("aliased: %.2f MB", float(stats.aliasedBytes) * toMB);
+    ImGui::Text("transient: %.2f MB, peak %.2f MB in %s", float(stats.transientBytes) * toMB, float(stats.peakTransientBytes) * toMB, peakName);
+    ImGui::Text("staging: %.2f MB, pending %.2f MB, host %.2f MB", float(stats.stagingBytes) * toMB, float(stats.pendingStagingBytes) * toMB, float(stats.hostBytes) * toMB);
+
+    if (ImGui::Button("dump json"))
+    {
+        kage::dumpMemoryTimeline("memory_timeline.json");
+    }
+
+    if (passes.empty())
+    {
+        ImGui::End();
+        return;
+    }
+
+    // the transient bytes of each pass
+    static std::vector<float> transientMB;
+    transientMB.resize(passes.size());
+    for (size_t ii = 0; ii < passes.size(); ++ii)
+    {
+        transientMB[ii] = float(passes[ii].transientBytes) * toMB;
+    }
+
+    const float width = ImGui::GetContentRegionAvail().x;
+    ImGui::PlotHistogram("##transient", transientMB.data(), (int)transientMB.size(), 0, "transient MB per pass", 0.f, FLT_MAX, { width, 80.f });
+
+    if (ImGui::IsItemHovered())
+    {
+        const float x = (ImGui::GetIO().MousePos.x - ImGui::GetItemRectMin().x) / ImGui::GetItemRectSize().x;
+        const size_t idx = glm::clamp(size_t(x * float(passes.size())), size_t(0), passes.size() - 1);
+        ImGui::SetTooltip("%s: %.2f MB transient, %.2f MB live", passes[idx].name, transientMB[idx], float(passes[idx].liveBytes) * toMB);
+    }
+
+    // the lifetimes
+    static std::vector<uint32_t> rows;
+    rows.clear();
+    for (uint32_t ii = 0; ii < (uint32_t)buckets.size(); ++ii)
+    {
+        if (buckets[ii].transient && kage::kInvalidHandle != buckets[ii].firstPass)
+        {
+            rows.push_back(ii);
+        }
+    }
+
+    std::sort(rows.begin(), rows.end(), [](uint32_t _a, uint32_t _b) {
+        return buckets[_a].allocatedBytes > buckets[_b].allocatedBytes;
+    });
+    rows.resize(glm::min((uint32_t)rows.size(), kMemoryTimelineMaxRows));
+
+    const float rowHeight = ImGui::GetTextLineHeight();
+    const float passWidth = width / float(passes.size());
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+
+    // the peak pass
+    if (stats.peakTransientBytes > 0)
+    {
+        const float peakIdx = float(std::max_element(transientMB.begin(), transientMB.end()) - transientMB.begin());
+        drawList->AddRectFilled({ origin.x + peakIdx * passWidth, origin.y }, { origin.x + (peakIdx + 1.f) * passWidth, origin.y + rowHeight * float(rows.size()) }, IM_COL32(255, 80, 80, 48));
+    }
+
+    const ImVec2 mouse = ImGui::GetIO().MousePos;
+    for (uint32_t rr = 0; rr < (uint32_t)rows.size(); ++rr)
+    {
+        const kage::MemoryBucket& bucket = buckets[rows[rr]];
+
+        const ImVec2 pmin = { origin.x + float(bucket.firstPass) * passWidth, origin.y + float(rr) * rowHeight };
+        const ImVec2 pmax = { origin.x + float(bucket.lastPass + 1) * passWidth, pmin.y + rowHeight - 1.f };
+
+        const ImU32 color = bucket.isImage ? IM_COL32(90, 160, 230, 200) : IM_COL32(120, 200, 120, 200);
+        drawList->AddRectFilled(pmin, pmax, color);
+
+        if (mouse.x >= pmin.x && mouse.x < pmax.x && mouse.y >= pmin.y && mouse.y < pmax.y)
+        {
+            ImGui::SetTooltip("%s: %.2f MB, %u resources, %.2f MB aliased\n%s -> %s"
+                , bucket.name, float(bucket.allocatedBytes) * toMB, bucket.resCount, float(bucket.aliasedBytes) * toMB
+                , passes[bucket.firstPass].name, passes[bucket.lastPass].name);
+        }
+    }
+
+    ImGui::Dummy({ width, rowHeight * float(rows.size()) });
+
+    ImGui::End();
+}
+
 void updateContentCommon(Dbg_Common& _common, const DebugLogicData& _ld)
 {
     KG_ZoneScopedC(kage::Color::blue);
@@ -420,6 +558,24 @@ void updateContentCommon(Dbg_Common& _common, const DebugLogicData& _ld)
     ImGui::SetNextWindowSize({ 400, 150 }, ImGuiCond_FirstUseEver);
     ImGui::Begin("info:");
     ImGui::Checkbox("pause cull transform", &_common.dbgPauseCullTransform);
+    ImGui::Checkbox("cpu occlusion", &_common.swOcclusionEnabled);
+    ImGui::Checkbox("animate instances", &_common.animateInstances);
+    ImGui::Checkbox("wireframe", &_common.wireframe);
+    ImGui::Checkbox("memory", &_common.dbgMemory);
+
+    if (ImGui::TreeNode("lights:"))
+    {
+        ImGui::SliderInt("count", &_common.lightCount, 0, 8192);
+        ImGui::Checkbox("cpu clusters", &_common.cpuLightClusters);
+        ImGui::TreePop();
+    }
+
+    if (_common.taaEnabled && ImGui::TreeNode("temporal upscale:"))
+    {
+        ImGui::SliderFloat("render scale", &_common.renderScale, .25f, 1.f);
+        ImGui::SliderFloat("feedback", &_common.taaFeedback, .5f, .98f);
+        ImGui::TreePop();
+    }
 
     if(ImGui::TreeNode("time:")) 
     {
@@ -459,6 +615,9 @@ void updateImGuiContent(DebugFeatures& _ft, const DebugLogicData& _ld)
 
     if (_ft.common.dbgRc2d)
         updateRc2d(_ft.rc2d);
+
+    if (_ft.common.dbgMemory)
+        updateContentMemory();
 }
 
 void updateImGui(const UIInput& input, DebugFeatures& ft, const DebugLogicData& ld)
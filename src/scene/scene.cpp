@@ -7,6 +7,8 @@
 
 #include "scene.h"
 
+#include "bx/platform.h"
+
 enum class Scene_Enum : uint64_t
 {
     RamdomScene = 0,
@@ -90,7 +92,7 @@ void CreateRandomScene(Scene& scene, bool _seamlessLod)
         }
         else {
             for (uint32_t lod = 0; lod < mesh.lodCount; lod++)
-                meshletCount = std::max(meshletCount, mesh.lods[lod].meshletCount); // use the maximum one for current mesh
+                meshletCount += mesh.lods[lod].meshletCount; // meshlets from different lods can be selected for the same draw
         }
         meshletVisibilityCount += meshletCount;
     }
@@ -140,7 +142,7 @@ void CreateMatrixScene(Scene& scene, bool _seamlessLod)
         }
         else {
             for (uint32_t lod = 0; lod < mesh.lodCount; lod++)
-                meshletCount = std::max(meshletCount, mesh.lods[lod].meshletCount); // use the maximum one for current mesh
+                meshletCount += mesh.lods[lod].meshletCount; // meshlets from different lods can be selected for the same draw
         }
 
         meshletVisibilityCount += meshletCount;
@@ -189,7 +191,7 @@ void CreateTenObjScene(Scene& scene, bool _seamlessLod)
         }
         else {
             for (uint32_t lod = 0; lod < mesh.lodCount; lod++)
-                meshletCount = std::max(meshletCount, mesh.lods[lod].meshletCount); // use the maximum one for current mesh
+                meshletCount += mesh.lods[lod].meshletCount; // meshlets from different lods can be selected for the same draw
         }
 
         meshletVisibilityCount += meshletCount;
@@ -236,7 +238,7 @@ void CreateInRowMeshScene(Scene& _scene, bool _seamlessLod)
         }
         else {
             for (uint32_t lod = 0; lod < mesh.lodCount; lod++)
-                meshletCount = std::max(meshletCount, mesh.lods[lod].meshletCount); // use the maximum one for current mesh
+                meshletCount += mesh.lods[lod].meshletCount; // meshlets from different lods can be selected for the same draw
         }
 
         meshletVisibilityCount += meshletCount;
@@ -272,7 +274,7 @@ void CreateSingleMeshScene(Scene& _scene, bool _seamlessLod)
     }
     else {
         for (uint32_t lod = 0; lod < mesh.lodCount; lod++)
-            meshletCount = std::max(meshletCount, mesh.lods[lod].meshletCount); // use the maximum one for current mesh
+            meshletCount += mesh.lods[lod].meshletCount; // meshlets from different lods can be selected for the same draw
     }
 
     _scene.drawCount = 1;
@@ -418,6 +420,117 @@ bool dumpScene(const Scene& _scene, const char* _path)
 }
 
 
+TransformNode combineTransform(const TransformNode& _parent, const TransformNode& _local)
+{
+    // non-uniform scale under a rotated parent can not be kept in pos/scale/orit, it's approximated by a component-wise scale
+    TransformNode world = _local;
+    world.pos = _parent.pos + _parent.orit * (_parent.scale * _local.pos);
+    world.orit = _parent.orit * _local.orit;
+    world.scale = _parent.scale * _local.scale;
+
+    return world;
+}
+
+void buildTransformHierarchy(Scene& _scene)
+{
+    // scenes without hierarchy, use one root node for each draw
+    if (_scene.drawNodes.size() != _scene.meshDraws.size())
+    {
+        _scene.transformNodes.clear();
+        _scene.drawNodes.resize(_scene.meshDraws.size());
+
+        for (size_t ii = 0; ii < _scene.meshDraws.size(); ++ii)
+        {
+            const MeshDraw& draw = _scene.meshDraws[ii];
+
+            TransformNode node{};
+            node.pos = draw.pos;
+            node.scale = draw.scale;
+            node.orit = draw.orit;
+
+            _scene.drawNodes[ii] = (uint32_t)_scene.transformNodes.size();
+            _scene.transformNodes.push_back(node);
+        }
+    }
+
+    const std::vector<TransformNode>& nodes = _scene.transformNodes;
+    const uint32_t nodeCount = (uint32_t)nodes.size();
+
+    // the source order is not guaranteed to be parent first, walk up to the first resolved node
+    std::vector<uint32_t> levels(nodeCount, kInvalidTransformNode);
+    uint32_t levelCount = 0;
+    for (uint32_t ii = 0; ii < nodeCount; ++ii)
+    {
+        uint32_t depth = 0;
+        uint32_t curr = ii;
+        while (curr != kInvalidTransformNode && levels[curr] == kInvalidTransformNode)
+        {
+            assert(depth <= nodeCount); // cycle in the hierarchy
+            depth++;
+            curr = nodes[curr].parent;
+        }
+
+        const uint32_t base = (curr == kInvalidTransformNode) ? 0 : levels[curr] + 1;
+
+        curr = ii;
+        for (uint32_t jj = depth; jj > 0; --jj)
+        {
+            levels[curr] = base + jj - 1;
+            curr = nodes[curr].parent;
+        }
+
+        levelCount = std::max(levelCount, levels[ii] + 1);
+    }
+
+    // counting sort by level, keep the source order inside a level
+    std::vector<uint32_t> levelOffsets(levelCount + 1, 0);
+    for (uint32_t ii = 0; ii < nodeCount; ++ii)
+        levelOffsets[levels[ii] + 1]++;
+
+    for (uint32_t ii = 0; ii < levelCount; ++ii)
+        levelOffsets[ii + 1] += levelOffsets[ii];
+
+    std::vector<uint32_t> remap(nodeCount);
+    std::vector<uint32_t> cursors(levelOffsets.begin(), levelOffsets.end() - 1);
+    for (uint32_t ii = 0; ii < nodeCount; ++ii)
+        remap[ii] = cursors[levels[ii]]++;
+
+    std::vector<TransformNode> sorted(nodeCount);
+    for (uint32_t ii = 0; ii < nodeCount; ++ii)
+    {
+        TransformNode node = nodes[ii];
+        node.parent = (node.parent == kInvalidTransformNode) ? kInvalidTransformNode : remap[node.parent];
+        node.level = levels[ii];
+        sorted[remap[ii]] = node;
+    }
+
+    for (uint32_t& nodeIdx : _scene.drawNodes)
+        nodeIdx = remap[nodeIdx];
+
+    // resolve the world transform in level order, the draws are initialized with it
+    std::vector<TransformNode> worlds(nodeCount);
+    for (uint32_t ii = 0; ii < nodeCount; ++ii)
+    {
+        const TransformNode& local = sorted[ii];
+        worlds[ii] = (local.parent == kInvalidTransformNode)
+            ? local
+            : combineTransform(worlds[local.parent], local);
+    }
+
+    for (size_t ii = 0; ii < _scene.meshDraws.size(); ++ii)
+    {
+        const TransformNode& world = worlds[_scene.drawNodes[ii]];
+
+        MeshDraw& draw = _scene.meshDraws[ii];
+        draw.pos = world.pos;
+        draw.scale = world.scale;
+        draw.orit = world.orit;
+    }
+
+    _scene.transformNodes = std::move(sorted);
+    _scene.transformLevelOffsets = std::move(levelOffsets);
+}
+
 float calcRadius(const Scene& _scene)
 {
     float radius = 0.f;
@@ -521,7 +634,25 @@ size_t getElementCount(Scene& _scene, SceneDumpDataTags _tag)
 }
 
 
-bool loadSceneDump(Scene& _scene, const char* _path)
+static int64_t fileTell(FILE* _file)
+{
+#if BX_PLATFORM_WINDOWS
+    return _ftelli64(_file);
+#else
+    return (int64_t)ftello(_file);
+#endif
+}
+
+static void fileSeek(FILE* _file, int64_t _offset)
+{
+#if BX_PLATFORM_WINDOWS
+    _fseeki64(_file, _offset, SEEK_SET);
+#else
+    fseeko(_file, (off_t)_offset, SEEK_SET);
+#endif
+}
+
+bool loadSceneDump(Scene& _scene, const char* _path, bool _skipImageData)
 {
     const char* ext = getExtension(_path);
     if (strcmp(ext, "scene") != 0)
@@ -551,7 +682,8 @@ bool loadSceneDump(Scene& _scene, const char* _path)
     _scene.imageDataSize = brief.imageDataSize;
     _scene.meshDraws.resize(brief.drawCount);
     _scene.images.resize(brief.imageCount);
-    _scene.imageDatas.resize(brief.imageDataSize);
+    if (!_skipImageData)
+        _scene.imageDatas.resize(brief.imageDataSize);
     _scene.cameras.resize(brief.cameraCount);
     _scene.radius = brief.radius;
 
@@ -564,6 +696,14 @@ bool loadSceneDump(Scene& _scene, const char* _path)
         SceneDumpDataTags tag;
         fread(&tag, sizeof(SceneDumpDataTags), 1, file);
 
+        // the image data stays in the file, the texture streaming reads it on demand
+        if (SceneDumpDataTags::image_data == tag && _skipImageData)
+        {
+            _scene.imageDataPath = _path;
+            _scene.imageDataFileOffset = fileTell(file);
+            fileSeek(file, _scene.imageDataFileOffset + brief.imageDataSize);
+            continue;
+        }
 
         size_t stride = getStride(tag);
         size_t count = getElementCount(_scene, tag);
@@ -588,7 +728,23 @@ bool loadSceneDump(Scene& _scene, const char* _path)
     return true;
 }
 
-bool loadScene(Scene& _scene, const std::vector<std::string>& _pathes, bool _buildMeshlets, bool _seamlessLod, bool _forceParse)
+// dumps written before the per-meshlet lod selection only reserve the largest lod for each draw
+static void refreshMeshletVisibility(Scene& _scene)
+{
+    uint32_t meshletVisibilityCount = 0;
+    for (MeshDraw& draw : _scene.meshDraws)
+    {
+        const Mesh& mesh = _scene.geometry.meshes[draw.meshIdx];
+        draw.meshletVisibilityOffset = meshletVisibilityCount;
+
+        for (uint32_t lod = 0; lod < mesh.lodCount; lod++)
+            meshletVisibilityCount += mesh.lods[lod].meshletCount;
+    }
+
+    _scene.meshletVisibilityCount = meshletVisibilityCount;
+}
+
+static bool loadSceneFiles(Scene& _scene, const std::vector<std::string>& _pathes, bool _buildMeshlets, bool _seamlessLod, bool _forceParse, bool _streamImages)
 {
     if (_pathes.empty())
     {
@@ -608,7 +764,10 @@ bool loadScene(Scene& _scene, const std::vector<std::string>& _pathes, bool _bui
             char path[256];
             strcpy(path, p.c_str());
             strcat(path, ".scene");
-            rcm = loadSceneDump(_scene, path);
+            rcm = loadSceneDump(_scene, path, _streamImages);
+
+            if (rcm && !_seamlessLod)
+                refreshMeshletVisibility(_scene);
         }
 
         if (!rcm)
@@ -623,4 +782,18 @@ bool loadScene(Scene& _scene, const std::vector<std::string>& _pathes, bool _bui
 
     kage::message(kage::error, "Unsupported file format: %s", p.c_str());
     return false;
-}
\ No newline at end of file
+}
+bool loadScene(Scene& _scene, const std::vector<std::string>& _pathes, bool _buildMeshlets, bool _seamlessLod, bool _forceParse, bool _streamImages /*= false*/)
+{
+    if (!loadSceneFiles(_scene, _pathes, _buildMeshlets, _seamlessLod, _forceParse, _streamImages))
+        return false;
+
+    // not part of the dump, the bounds are cheap to rebuild from the meshlets
+    if (_buildMeshlets && !_seamlessLod)
+        buildMeshletLodBounds(_scene.geometry);
+
+    // the dump only keeps the resolved draws, rebuild as flat roots
+    buildTransformHierarchy(_scene);
+
+    return true;
+}
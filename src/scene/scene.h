@@ -25,6 +25,21 @@ struct alignas(16) MeshDraw
     uint32_t emissiveTex{0};
 };
 
+constexpr uint32_t kInvalidTransformNode = ~0u;
+
+// node of the flat transform hierarchy, nodes are sorted by level so a parent is always ahead of its children
+// the draws attached to a node take the resolved world transform of it
+struct alignas(16) TransformNode
+{
+    vec3 pos;
+    uint32_t parent{ kInvalidTransformNode };
+
+    vec3 scale;
+    uint32_t level{ 0 };
+
+    quat orit;
+};
+
 struct alignas(16) ImageInfo
 {
     char name[128];
@@ -61,11 +76,30 @@ struct Scene
     std::vector<ImageInfo> images;
     std::vector<uint8_t> imageDatas;
 
+    // set if the image data is left in the .scene for the streaming, imageDatas is empty then
+    std::string imageDataPath;
+    int64_t imageDataFileOffset{ 0 };
+
     uint32_t cameraCount;
     std::vector<Camera> cameras;
+
+    // local transforms, level ordered
+    std::vector<TransformNode> transformNodes;
+    // [levelOffsets[i], levelOffsets[i + 1]) are the nodes in level i
+    std::vector<uint32_t> transformLevelOffsets;
+    // node index for each draw
+    std::vector<uint32_t> drawNodes;
 };
 
-bool loadScene(Scene& _scene, const std::vector<std::string>& _pathes, bool _buildMeshlets, bool _seamlessLod, bool _forceParse);
+// _streamImages: keep the image data of a .scene in the file
+bool loadScene(Scene& _scene, const std::vector<std::string>& _pathes, bool _buildMeshlets, bool _seamlessLod, bool _forceParse, bool _streamImages = false);
 bool dumpScene(const Scene& scene, const char* path);
 
+// the world transform of a node from the world transform of its parent
+TransformNode combineTransform(const TransformNode& _parent, const TransformNode& _local);
+
+// sort the nodes by level and resolve the world transform of the draws
+// draws without a node get a root node from their current transform
+void buildTransformHierarchy(Scene& _scene);
+
 float calcRadius(const Scene& _scene);
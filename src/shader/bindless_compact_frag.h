@@ -0,0 +1,109 @@
+// the compact g-buffer fragment shader, see gbuffer.h for the layout
+// TEXTURE_FEEDBACK must be defined before including this file
+// with it the finest level each texture is sampled with is written for the texture streaming, see texture_feedback.h
+
+# extension GL_EXT_shader_16bit_storage: require
+# extension GL_EXT_shader_8bit_storage: require
+# extension GL_GOOGLE_include_directive: require
+# extension GL_EXT_nonuniform_qualifier: require
+
+# include "debug_gpu.h"
+# include "mesh_gpu.h"
+# include "math.h"
+# include "rc_common.h"
+# include "gbuffer.h"
+
+#if TEXTURE_FEEDBACK
+# include "texture_feedback.h"
+#endif // TEXTURE_FEEDBACK
+
+layout(location = 0) in flat uint in_drawId;
+layout(location = 1) in vec3 in_wPos;
+layout(location = 2) in vec3 in_norm;
+layout(location = 3) in vec4 in_tan;
+layout(location = 4) in vec2 in_uv;
+layout(location = 5) in flat uint in_triId;
+layout(location = 6) in vec4 in_currClip;
+layout(location = 7) in vec4 in_prevClip;
+
+layout(location = 0) out vec4 out_albedo;
+layout(location = 1) out uint out_normal;
+layout(location = 2) out uint out_emissive;
+layout(location = 3) out vec2 out_velocity; // discarded if the g-buffer has no velocity
+
+layout(binding = 0, set = 1) uniform sampler2D textures[];
+
+layout(push_constant) uniform block
+{
+    Constants consts;
+};
+
+// readonly
+layout(binding = 2) readonly buffer MeshDraws
+{
+    MeshDraw meshDraws [];
+};
+
+
+void main()
+{
+    out_velocity = calcVelocity(in_currClip, in_prevClip);
+
+#if DEBUG_MESHLET
+    uint mhash = hash(in_drawId);
+    out_albedo = vec4(float(mhash & 255), float((mhash >> 8) & 255), float((mhash >> 16) & 255), 255) / 255.0;
+    out_normal = packGBufferNormal(normalize(in_norm), 1.0, 0.0);
+    out_emissive = 0u;
+#elif DEBUG_TRIANGLE
+    uint thash = hash(in_triId);
+    out_albedo = vec4(float(thash & 255), float((thash >> 8) & 255), float((thash >> 16) & 255), 255) / 255.0;
+    out_normal = packGBufferNormal(normalize(in_norm), 1.0, 0.0);
+    out_emissive = 0u;
+#else
+    MeshDraw mDraw = meshDraws[in_drawId];
+
+#if TEXTURE_FEEDBACK
+    // before any branch, the derivatives are undefined in the non-uniform control flow
+    uint feedbackLevel = textureFeedbackLevel(in_uv);
+    if (textureFeedbackPixel(in_drawId))
+    {
+        writeTextureFeedback(mDraw.albedoTex, feedbackLevel);
+        writeTextureFeedback(mDraw.normalTex, feedbackLevel);
+        writeTextureFeedback(mDraw.specularTex, feedbackLevel);
+        writeTextureFeedback(mDraw.emissiveTex, feedbackLevel);
+    }
+#endif // TEXTURE_FEEDBACK
+
+    vec4 albedo = vec4(0.5, 0.5, 0.5, 1.0);
+    if (mDraw.albedoTex > 0) {
+        albedo = texture(textures[nonuniformEXT(mDraw.albedoTex)], in_uv);
+    }
+
+    vec4 normal = vec4(0.0, 0.0, 1.0, 0.0);
+    if (mDraw.normalTex > 0)
+    {
+        normal = texture(textures[nonuniformEXT(mDraw.normalTex)], in_uv) * 2.0 - 1.0;
+    }
+
+    vec3 bitan = cross(in_norm, in_tan.xyz) * in_tan.w;
+    vec3 n = normalize(normal.x * in_tan.xyz + normal.y * bitan + normal.z * in_norm);
+
+    // r: occlusion, g: roughness, b: metalness
+    vec4 specular = vec4(0.04, 0.04, 0.04, 1.0);
+    if (mDraw.specularTex > 0)
+    {
+        specular = texture(textures[nonuniformEXT(mDraw.specularTex)], in_uv);
+    }
+
+    vec3 emissive = vec3(0.0);
+    if (mDraw.emissiveTex > 0)
+    {
+        emissive = texture(textures[nonuniformEXT(mDraw.emissiveTex)], in_uv).rgb;
+    }
+
+    // the coverage is from the depth, the alpha stores the occlusion
+    out_albedo = vec4(albedo.rgb, specular.r);
+    out_normal = packGBufferNormal(n, specular.g, specular.b);
+    out_emissive = packRGB9E5(emissive);
+#endif
+}
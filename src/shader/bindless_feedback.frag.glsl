@@ -0,0 +1,8 @@
+#version 450
+
+#extension GL_GOOGLE_include_directive: require
+
+// the texture streaming feedback, after the hard raster bindings
+#define TEXTURE_FEEDBACK 1
+#define TEX_FEEDBACK_BINDING 8
+#include "bindless_frag.h"
@@ -6,10 +6,20 @@
 
 #include "pbr.h"
 #include "rc_common.h"
+#include "gbuffer.h"
+#include "light_gpu.h"
 #include "debug_gpu.h"
+#include "rc_storage.h"
+#include "sky_ibl.h"
 
 layout(local_size_x = 32, local_size_y = 32, local_size_z = 1) in;
 
+// keep sync with GBufferLayout in vkz_deferred.h
+layout(constant_id = 0) const bool COMPACT_GBUFFER = false;
+
+// the storage format of the radiance cascades, see rc_storage.h
+layout(constant_id = 1) const uint RC_STORAGE_FORMAT = 0;
+
 layout(push_constant) uniform blocks
 {
     DeferredConstants consts;
@@ -23,24 +33,56 @@ layout(binding = 3) uniform sampler2D in_emmision;
 layout(binding = 4) uniform sampler2D in_specular;
 layout(binding = 5) uniform sampler2D in_sky;
 
+// the ambient of the sky, see vkz_sky_ibl.h
+layout(binding = 6) uniform samplerCube in_skySpecular;
+layout(binding = 7) readonly buffer SkySH
+{
+    vec4 skySH [SKY_IBL_SH_COEFFS];
+};
+
+// compact g-buffer, the specular slot is unused
+layout(binding = 1) uniform usampler2D in_normalPacked;
+layout(binding = 2) uniform sampler2D in_depth;
+layout(binding = 3) uniform usampler2D in_emmisionPacked;
+
 #if ENABLE_RADIANCE_CASCADES
 
 
-layout(binding = 6) readonly buffer RadianceConstants
+layout(binding = 8) readonly buffer RadianceConstants
 {
     RCAccessData rcAccesses [];
 };
 
-layout(binding = 7) uniform sampler2DArray in_rcMergedProbe;
-layout(binding = 8) uniform sampler2DArray in_rcMergedInverval;
-layout(binding = 9) uniform writeonly image2D out_color;
+layout(binding = 9) uniform sampler2DArray in_rcMergedProbe;
+layout(binding = 9) uniform usampler2DArray in_rcMergedProbePacked;
+layout(binding = 10) uniform sampler2DArray in_rcMergedInverval;
+layout(binding = 11) uniform writeonly image2D out_color;
+
+#define LIGHT_BINDING_BASE 12
 
 #else
 
-layout(binding = 6) uniform writeonly image2D out_color;
+layout(binding = 8) uniform writeonly image2D out_color;
+
+#define LIGHT_BINDING_BASE 9
 
 #endif // ENABLE_RADIANCE_CASCADES
 
+// clustered punctual lights, see light_cluster.comp.glsl
+layout(binding = LIGHT_BINDING_BASE) readonly buffer Lights
+{
+    PunctualLight lights [];
+};
+
+layout(binding = LIGHT_BINDING_BASE + 1) readonly uniform LightConfig
+{
+    LightClusterConfig lightCfg;
+};
+
+layout(binding = LIGHT_BINDING_BASE + 2) readonly buffer Clusters
+{
+    uint clusters [];
+};
 
 struct Light
 {
@@ -67,6 +109,48 @@ vec3 brdfSpecular(float _nov, float _nol, float _noh, float _loh, vec3 _f0, floa
     return F * D * V;
 }
 
+// diffuse + specular of a light from direction _l, without the light color
+vec3 brdfDirect(vec3 _n, vec3 _v, vec3 _l, vec3 _f0, vec3 _diffuseColor, float _linearRough)
+{
+    vec3 h = normalize(_v + _l);
+    float NoV = abs(dot(_n, _v)) + 1e-5;
+    float NoL = saturate(dot(_n, _l));
+    float NoH = saturate(dot(_n, h));
+    float LoH = saturate(dot(_l, h));
+
+    vec3 Fr = brdfSpecular(NoV, NoL, NoH, LoH, _f0, _linearRough);
+    vec3 Fd = _diffuseColor * Fd_Burley(_linearRough, NoV, NoL, LoH);
+
+    return (Fd + Fr) * NoL;
+}
+
+vec3 shadeClusterLights(uvec2 _pixel, vec3 _wPos, vec3 _n, vec3 _v, vec3 _f0, vec3 _diffuseColor, float _linearRough)
+{
+    float viewZ = (lightCfg.view * vec4(_wPos, 1.0)).z;
+    uvec2 tile = _pixel / LIGHT_CLUSTER_TILE_SIZE;
+    uint ci = getClusterIndex(lightCfg, tile, getClusterSlice(lightCfg, viewZ));
+
+    uint count = clusters[ci];
+    uint offset = getClusterCount(lightCfg) + ci * LIGHT_CLUSTER_MAX_LIGHTS;
+
+    vec3 color = vec3(0.0);
+    for (uint ii = 0; ii < count; ++ii)
+    {
+        PunctualLight light = lights[clusters[offset + ii]];
+
+        vec3 l = light.pos - _wPos;
+        float dist = length(l);
+        if (dist >= light.range)
+            continue;
+
+        l /= max(dist, 1e-4);
+        float atten = getLightAttenuation(light, dist) * getSpotAttenuation(light, l);
+        color += brdfDirect(_n, _v, l, _f0, _diffuseColor, _linearRough) * light.color * light.intensity * atten;
+    }
+
+    return color;
+}
+
 
 ProbeSample getNearestProbeSample(vec3 _mappedPos, float _probeSideLen)
 {
@@ -85,7 +169,9 @@ vec4 getProbeColor(uint _probeSideCnt, ivec3 _probeIdx)
 {
     vec2 uv = (vec2(_probeIdx) + 0.5f) / float(_probeSideCnt);
 
-    vec4 rcc = texture(in_rcMergedProbe, vec3(uv, _probeIdx.z));
+    vec4 rcc = (RC_STORAGE_FORMAT == RC_STORAGE_RGB9E5)
+        ? vec4(sampleRGB9E5(in_rcMergedProbePacked, vec3(uv, _probeIdx.z)), 1.f)
+        : texture(in_rcMergedProbe, vec3(uv, _probeIdx.z));
 
     return rcc;
 }
@@ -121,19 +207,48 @@ void main()
     vec2 uv = vec2((pos.x + .5f) / consts.w, (pos.y + .5f) / consts.h);
     vec3 camPos = vec3(consts.camx, consts.camy, consts.camz);
 
-    vec4 albedo = texture(in_albedo, uv);
-    vec4 normal = texture(in_normal, uv);
-    vec4 emmision = texture(in_emmision, uv);
+    vec4 albedo;
+    vec4 normal;
+    vec4 emmision;
     vec4 sky = texture(in_sky, uv);
-    vec3 wPos = texture(in_wPos, uv).xyz;
-    vec4 specular = texture(in_specular, uv);
+    vec3 wPos;
+    vec4 specular;
     float radius = consts.totalRadius;
-    wPos = (wPos * 2.f - 1.f) * radius; // [0.f, 1.f] to [-radius, +radius]
+    bool covered;
+
+    if (COMPACT_GBUFFER)
+    {
+        vec4 packedAlbedo = texture(in_albedo, uv);
+
+        float roughness, metalness;
+        unpackGBufferNormal(texture(in_normalPacked, uv).x, normal.xyz, roughness, metalness);
+        normal.w = 1.f;
+
+        albedo = vec4(packedAlbedo.rgb, 1.f);
+        specular = vec4(packedAlbedo.a, roughness, metalness, 1.f);
+        emmision = vec4(unpackRGB9E5(texture(in_emmisionPacked, uv).x), 1.f);
+
+        // reverse-z, the cleared depth is the far plane
+        float depth = texture(in_depth, uv).x;
+        wPos = reconstructWorldPos(uv, depth, consts.invViewProj);
+        covered = depth > 0.f;
+    }
+    else
+    {
+        albedo = texture(in_albedo, uv);
+        normal = texture(in_normal, uv);
+        emmision = texture(in_emmision, uv);
+        wPos = texture(in_wPos, uv).xyz;
+        specular = texture(in_specular, uv);
+        wPos = (wPos * 2.f - 1.f) * radius; // [0.f, 1.f] to [-radius, +radius]
+        covered = !(albedo.a < 0.5 || normal.w < 0.02);
+    }
 
 #if DEBUG_MESHLET
     
-    vec3 color = emmision.xyz;
-    if (emmision.a < 0.5f)
+    // the compact fragment shader writes the debug color to the albedo
+    vec3 color = COMPACT_GBUFFER ? albedo.xyz : emmision.xyz;
+    if ((COMPACT_GBUFFER && !covered) || (!COMPACT_GBUFFER && emmision.a < 0.5f))
         color = sky.xyz;
 
     imageStore(out_color, ivec2(pos), vec4(color, 1.f));
@@ -166,38 +281,41 @@ void main()
 
     vec3 v = normalize(vec3(camPos - wPos)); // from surface to observer
 
-    // BRDF
     vec3 n = normal.xyz;
-    vec3 h = normalize(v + lightDir);
-    float NoV = abs(dot(n, v)) + 1e-5;
-    float NoL = saturate(dot(n, lightDir));
-    float NoH = saturate(dot(n, h));
-    float LoH = saturate(dot(lightDir, h));
-
     vec3 f0 = 0.04 * (1.0 - matalness) + baseColor.rgb * matalness;
     vec3 diffuseColor = (1.0 - matalness) * baseColor.rgb;
 
     float linearRoughness = roughness * roughness;
 
-    // specular BRDF
-    vec3 Fr = brdfSpecular(NoV, NoL, NoH, LoH, f0, linearRoughness);
+    vec3 color = brdfDirect(n, v, lightDir, f0, diffuseColor, linearRoughness);
+    color *= lightIntensity * lightCol;
 
-    // diffuse BRDF
-    vec3 Fd = diffuseColor * Fd_Burley(linearRoughness, NoV, NoL, LoH);
-    
-    vec3 color = Fd + Fr;
-    color *= lightIntensity * lightCol * NoL;
+    // sky pixels have no cluster lights
+    if (covered)
+        color += shadeClusterLights(pos, wPos, n, v, f0, diffuseColor, linearRoughness);
+
+    // diffuse indirect from the sh9 of the sky
+    vec4 sh[SKY_IBL_SH_COEFFS];
+    for (uint ii = 0; ii < SKY_IBL_SH_COEFFS; ++ii)
+        sh[ii] = skySH[ii];
+
+    vec3 indirectDiffuse = skyIrradianceSH(sh, n) * Fd_Lambert();
+
+    // specular indirect, split sum with the prefiltered sky
+    float NoV = abs(dot(n, v)) + 1e-5;
+    vec3 r = reflect(-v, n);
+    vec3 prefiltered = textureLod(in_skySpecular, r, roughness * float(SKY_IBL_SPECULAR_MIPS - 1)).rgb;
+    vec2 dfg = PrefilteredDFG_Karis(roughness, NoV);
+    vec3 indirectSpecular = prefiltered * (f0 * dfg.x + dfg.y);
 
-    // diffuse indirect
-    vec3 indirectDiffuse = Irradiance_SphericalHarmonics(n) * Fd_Lambert();
-    vec3 ibl = indirectDiffuse * diffuseColor;
+    vec3 ibl = (indirectDiffuse * diffuseColor + indirectSpecular) * occlusion;
     color += ibl * indirectIntensity;
 
     color = Tonemap_ACES(color);
     color = OECF_sRGBFast(color);
     //color = rc_pc.rgb;
 
-    if (albedo.a < 0.5 || normal.w < 0.02)
+    if (!covered)
         color = sky.xyz;
 
     imageStore(out_color, ivec2(pos), vec4(color, 1.f));
@@ -14,6 +14,7 @@ layout(constant_id = 0) const bool LATE = false;
 layout(constant_id = 1) const bool TASK = false;
 layout(constant_id = 2) const bool ALPHA_PASS = false;
 layout(constant_id = 3) const bool USE_MIXED_RASTER = false;
+layout(constant_id = 4) const bool USE_SW_OCCLUSION = false;
 
 layout(push_constant) uniform block 
 {
@@ -37,25 +38,17 @@ layout(binding = 2) readonly uniform Transform
 };
 
 // writeonly
-layout(binding = 3) writeonly buffer DrawCommands
+layout(binding = 3) writeonly buffer DrawSortItems
 {
-    MeshDrawCommand drawCmds[];
-};
-
-layout(binding = 3) writeonly buffer TaskCommands
-{
-    MeshTaskCommand taskCmds[];
-};
-
-layout(binding = 3) writeonly buffer MeshletInfo
-{
-    MeshTaskCommand meshletCmds[] ;
+    DrawSortItem sortItems[];
 };
 
 // read/write 
-layout(binding = 4) buffer DrawCommandCount
+layout(binding = 4) buffer DrawSortBins
 {
-    uint drawCmdCount;
+    uint binCounts[DRAW_SORT_TOTAL_BINS];
+    uint binOffsets[DRAW_SORT_TOTAL_BINS];
+    uint binCursors[DRAW_SORT_TOTAL_BINS];
 };
 
 layout(binding = 5) buffer DrawVisibility
@@ -65,10 +58,19 @@ layout(binding = 5) buffer DrawVisibility
 
 layout(binding = 6) uniform sampler2D depthPyramid;
 
+// cpu software occlusion result, 0 means the draw is fully occluded by the cpu occluders
+layout(binding = 7) readonly buffer SoftOcclusionVisibility
+{
+    uint swVisibility[];
+};
+
 void main()
 {
     uint di = gl_GlobalInvocationID.x;
 
+    // the scatter pass reads all items, so culled draws must write an empty one
+    sortItems[di] = DrawSortItem(0, 0, 0, 0);
+
     MeshDraw draw = draws[di];
     if (draw.withAlpha > 0 && !ALPHA_PASS)
         return;
@@ -92,6 +94,10 @@ void main()
     visible = visible && (center.z + radius > consts.znear);
 
     visible = visible || (consts.enableCull == 0);
+
+    // the cpu occluders are from current frame, so it's valid for both early and late pass
+    if (USE_SW_OCCLUSION && consts.enableOcclusion == 1)
+        visible = visible && (swVisibility[di] == 1);
     
     
     // do occlusion culling in late pass
@@ -116,68 +122,48 @@ void main()
     if(visible && (!LATE || consts.enableMeshletOcclusion == 1 || drawVisibility[di] == 0))
     {
         float dist = max(length(center.xyz) - radius, 0);
+        float farDist = length(center.xyz) + radius;
         float threshold = dist * consts.lodErrorThreshold / maxElem(draw.scale);
-        uint lodIdx = 0;
+        float farThreshold = farDist * consts.lodErrorThreshold / maxElem(draw.scale);
+
+        // the nearest point of the draw decides the finest lod, the farthest point decides the coarsest lod
+        // meshlets in between select their own lod in the meshlet culling
+        uint minLod = 0;
+        uint maxLod = 0;
         for (uint ii = 0; ii < mesh.lodCount; ++ii){
             if (mesh.lods[ii].error < threshold){
-                lodIdx = ii;
+                minLod = ii;
+            }
+            if (mesh.lods[ii].error < farThreshold){
+                maxLod = ii;
             }
         }
 
-        MeshLod lod = consts.enableSeamlessLod == 1 ? mesh.seamlessLod : mesh.lods[lodIdx];
+        MeshLod lod = consts.enableSeamlessLod == 1 ? mesh.seamlessLod : mesh.lods[minLod];
 
-        if(TASK)
-        {
-            uint taskGroupCount = (lod.meshletCount + TASKGP_SIZE - 1) / TASKGP_SIZE; // each task group handle TASKGP_SIZE meshlets
-            uint dci = atomicAdd(drawCmdCount, taskGroupCount);
-
-            uint meshletVisibilityOffset = draw.meshletVisibilityOffset;
-            uint lateDrawVisibility = drawVisibility[di];
-
-            // the command for each command idx is the same
-            for(uint i = 0; i < taskGroupCount; ++i)
-            {
-                taskCmds[dci + i].drawId = di;
-                taskCmds[dci + i].taskOffset = lod.meshletOffset + i * TASKGP_SIZE;
-                taskCmds[dci + i].taskCount = min(TASKGP_SIZE, lod.meshletCount - i * TASKGP_SIZE); // the last task group may have less than TASKGP_SIZE meshlets
-                taskCmds[dci + i].lateDrawVisibility = lateDrawVisibility;
-                taskCmds[dci + i].meshletVisibilityOffset = meshletVisibilityOffset + i * TASKGP_SIZE;
-            }
-        }
-        else if (USE_MIXED_RASTER) // samiliar as the task group, but use meshlet group size
-        {
-            uint groupCount = (lod.meshletCount + MR_MESHLETGP_SIZE - 1) / MR_MESHLETGP_SIZE; // each group handles MR_MESHLETGP_SIZE meshlets
-            uint dci = atomicAdd(drawCmdCount, groupCount);
-
-            uint meshletVisibilityOffset = draw.meshletVisibilityOffset;
-            uint lateDrawVisibility = drawVisibility[di];
-
-            // the command for each command idx is the same
-            for (uint i = 0; i < groupCount; ++i)
-            {
-                meshletCmds[dci + i].drawId = di;
-                meshletCmds[dci + i].taskOffset = lod.meshletOffset + i * MR_MESHLETGP_SIZE;
-                meshletCmds[dci + i].taskCount = min(MR_MESHLETGP_SIZE, lod.meshletCount - i * MR_MESHLETGP_SIZE); // fill when the last group lesser than MR_MESHLETGP_SIZE
-                meshletCmds[dci + i].lateDrawVisibility = lateDrawVisibility;
-                meshletCmds[dci + i].meshletVisibilityOffset = meshletVisibilityOffset + i * MR_MESHLETGP_SIZE;
-            }
-        }
-        else
-        {
-            uint dci = atomicAdd(drawCmdCount, 1);
-            drawCmds[dci].drawId = di;
-            drawCmds[dci].lateDrawVisibility = drawVisibility[di];
-            drawCmds[dci].taskCount = lod.meshletCount;
-            drawCmds[dci].taskOffset = lod.meshletOffset;
-            drawCmds[dci].indexCount = lod.indexCount;
-            drawCmds[dci].instanceCount = 1;
-            drawCmds[dci].firstIndex = lod.indexOffset;
-            drawCmds[dci].vertexOffset = mesh.vertexOffset;
-            drawCmds[dci].firstInstance = 0;
-            drawCmds[dci].local_x = (lod.meshletCount + TASKGP_SIZE - 1) / TASKGP_SIZE;
-            drawCmds[dci].local_y = 1;
-            drawCmds[dci].local_z = 1;
-        }
+        // lods of a mesh are stored contiguously, so the span covers every lod in [minLod, maxLod]
+        uint meshletCount = lod.meshletCount;
+        if (consts.enableSeamlessLod == 0)
+            meshletCount = mesh.lods[maxLod].meshletOffset + mesh.lods[maxLod].meshletCount - lod.meshletOffset;
+
+        uint groupCount = 1;
+        if (TASK)
+            groupCount = (meshletCount + TASKGP_SIZE - 1) / TASKGP_SIZE; // each task group handle TASKGP_SIZE meshlets
+        else if (USE_MIXED_RASTER)
+            groupCount = (meshletCount + MR_MESHLETGP_SIZE - 1) / MR_MESHLETGP_SIZE; // each group handles MR_MESHLETGP_SIZE meshlets
+
+        // front-to-back key, log distribution keeps the precision for the near draws
+        float depthRange = log2(max(consts.zfar / consts.znear, 2.0));
+        float depthT = clamp(log2(max(dist, consts.znear) / consts.znear) / depthRange, 0.0, 1.0);
+        uint bin = min(uint(depthT * float(DRAW_SORT_BIN_COUNT)), DRAW_SORT_BIN_COUNT - 1);
+        uint bucket = draw.withAlpha > 0 ? 1 : 0;
+        uint key = bucket * DRAW_SORT_BIN_COUNT + bin;
+
+        // only count here, the scan pass turns the counts into offsets
+        if (groupCount > 0)
+            atomicAdd(binCounts[key], groupCount);
+
+        sortItems[di] = DrawSortItem(key, groupCount, minLod | (maxLod << 8), drawVisibility[di]);
     }
 
     // set dvb in late pass
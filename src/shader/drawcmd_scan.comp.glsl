@@ -0,0 +1,7 @@
+#version 450
+
+#extension GL_GOOGLE_include_directive: require
+
+// portable version, used when subgroup arithmetic is not supported
+#define USE_WAVE_OPS 0
+#include "drawcmd_scan.h"
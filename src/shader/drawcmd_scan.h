@@ -0,0 +1,114 @@
+// exclusive prefix sum over the draw sort bins, single work group
+// USE_WAVE_OPS must be defined before including this file
+
+#extension GL_GOOGLE_include_directive: require
+
+#if USE_WAVE_OPS
+#extension GL_KHR_shader_subgroup_basic: require
+#extension GL_KHR_shader_subgroup_arithmetic: require
+#endif // USE_WAVE_OPS
+
+#include "mesh_gpu.h"
+
+layout(local_size_x = DRAW_SORT_SCAN_GP_SIZE, local_size_y = 1, local_size_z = 1) in;
+
+layout(binding = 0) buffer DrawSortBins
+{
+    uint binCounts[DRAW_SORT_TOTAL_BINS];
+    uint binOffsets[DRAW_SORT_TOTAL_BINS];
+    uint binCursors[DRAW_SORT_TOTAL_BINS];
+};
+
+layout(binding = 1) writeonly buffer DrawCommandCount
+{
+    uint drawCmdCount;
+};
+
+#if USE_WAVE_OPS
+
+// the second level scan walks the subgroup sums in chunks of the subgroup size in the first subgroup
+// no assumption on the subgroup size, it may vary per dispatch and the subgroups may not be full
+shared uint s_waveSums[DRAW_SORT_SCAN_GP_SIZE];
+
+uint groupExclusiveScan(uint _val)
+{
+    uint waveEx = subgroupExclusiveAdd(_val);
+    uint waveTotal = subgroupAdd(_val);
+
+    if (subgroupElect())
+        s_waveSums[gl_SubgroupID] = waveTotal;
+
+    barrier();
+
+    if (gl_SubgroupID == 0)
+    {
+        uint carry = 0;
+        for (uint base = 0; base < gl_NumSubgroups; base += gl_SubgroupSize)
+        {
+            uint wi = base + gl_SubgroupInvocationID;
+            bool active = wi < gl_NumSubgroups;
+            uint waveSum = active ? s_waveSums[wi] : 0;
+            uint waveOffset = subgroupExclusiveAdd(waveSum);
+            if (active)
+                s_waveSums[wi] = carry + waveOffset;
+
+            carry += subgroupAdd(waveSum);
+        }
+    }
+
+    barrier();
+
+    return s_waveSums[gl_SubgroupID] + waveEx;
+}
+
+#else
+
+shared uint s_scan[DRAW_SORT_SCAN_GP_SIZE];
+
+// Hillis-Steele scan in shared memory
+uint groupExclusiveScan(uint _val)
+{
+    uint ti = gl_LocalInvocationID.x;
+
+    s_scan[ti] = _val;
+    barrier();
+
+    for (uint offset = 1; offset < DRAW_SORT_SCAN_GP_SIZE; offset <<= 1)
+    {
+        uint v = (ti >= offset) ? s_scan[ti - offset] : 0;
+        barrier();
+        s_scan[ti] += v;
+        barrier();
+    }
+
+    return s_scan[ti] - _val;
+}
+
+#endif // USE_WAVE_OPS
+
+void main()
+{
+    uint ti = gl_LocalInvocationID.x;
+    uint base = ti * DRAW_SORT_BINS_PER_THREAD;
+
+    // serial scan for bins owned by this thread
+    uint localOffsets[DRAW_SORT_BINS_PER_THREAD];
+    uint sum = 0;
+    for (uint ii = 0; ii < DRAW_SORT_BINS_PER_THREAD; ++ii)
+    {
+        localOffsets[ii] = sum;
+        sum += binCounts[base + ii];
+    }
+
+    uint offset = groupExclusiveScan(sum);
+
+    for (uint ii = 0; ii < DRAW_SORT_BINS_PER_THREAD; ++ii)
+    {
+        uint bi = base + ii;
+        binOffsets[bi] = offset + localOffsets[ii];
+        binCursors[bi] = 0;
+    }
+
+    if (ti == DRAW_SORT_SCAN_GP_SIZE - 1)
+        drawCmdCount = offset + sum;
+}
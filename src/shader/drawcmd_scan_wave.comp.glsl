@@ -0,0 +1,6 @@
+#version 450
+
+#extension GL_GOOGLE_include_directive: require
+
+#define USE_WAVE_OPS 1
+#include "drawcmd_scan.h"
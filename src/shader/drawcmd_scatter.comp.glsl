@@ -0,0 +1,126 @@
+#version 450
+
+#extension GL_EXT_shader_16bit_storage: require
+#extension GL_EXT_shader_8bit_storage: require
+
+#extension GL_GOOGLE_include_directive: require
+
+#include "mesh_gpu.h"
+
+layout(local_size_x = TASKGP_SIZE, local_size_y = 1, local_size_z = 1) in;
+
+layout(constant_id = 0) const bool TASK = false;
+layout(constant_id = 1) const bool USE_MIXED_RASTER = false;
+
+layout(push_constant) uniform block 
+{
+    Constants consts;
+};
+
+// readonly
+layout(binding = 0) readonly buffer Meshes
+{
+    Mesh meshes[];
+};
+
+layout(binding = 1) readonly buffer MeshDraws
+{
+    MeshDraw draws[];
+};
+
+layout(binding = 2) readonly buffer DrawSortItems
+{
+    DrawSortItem sortItems[];
+};
+
+// read/write
+layout(binding = 3) buffer DrawSortBins
+{
+    uint binCounts[DRAW_SORT_TOTAL_BINS];
+    uint binOffsets[DRAW_SORT_TOTAL_BINS];
+    uint binCursors[DRAW_SORT_TOTAL_BINS];
+};
+
+// writeonly
+layout(binding = 4) writeonly buffer DrawCommands
+{
+    MeshDrawCommand drawCmds[];
+};
+
+layout(binding = 4) writeonly buffer TaskCommands
+{
+    MeshTaskCommand taskCmds[];
+};
+
+layout(binding = 4) writeonly buffer MeshletInfo
+{
+    MeshTaskCommand meshletCmds[] ;
+};
+
+void main()
+{
+    uint di = gl_GlobalInvocationID.x;
+
+    DrawSortItem item = sortItems[di];
+    if (item.groupCount == 0)
+        return;
+
+    // bins are already in order, only the order inside a bin is decided by the atomic
+    uint dci = binOffsets[item.key] + atomicAdd(binCursors[item.key], item.groupCount);
+
+    MeshDraw draw = draws[di];
+    Mesh mesh = meshes[draw.meshIdx];
+    uint minLod = item.lodIdx & 0xff;
+    uint maxLod = (item.lodIdx >> 8) & 0xff;
+    MeshLod lod = consts.enableSeamlessLod == 1 ? mesh.seamlessLod : mesh.lods[minLod];
+
+    // the visibility bits of a draw cover all lods, starts from the first meshlet of the lod 0
+    uint meshletCount = lod.meshletCount;
+    uint meshletVisibilityOffset = draw.meshletVisibilityOffset;
+    if (consts.enableSeamlessLod == 0)
+    {
+        meshletCount = mesh.lods[maxLod].meshletOffset + mesh.lods[maxLod].meshletCount - lod.meshletOffset;
+        meshletVisibilityOffset += lod.meshletOffset - mesh.lods[0].meshletOffset;
+    }
+
+    uint lateDrawVisibility = item.lateDrawVisibility;
+
+    if (TASK)
+    {
+        // the command for each command idx is the same
+        for (uint i = 0; i < item.groupCount; ++i)
+        {
+            taskCmds[dci + i].drawId = di;
+            taskCmds[dci + i].taskOffset = lod.meshletOffset + i * TASKGP_SIZE;
+            taskCmds[dci + i].taskCount = min(TASKGP_SIZE, meshletCount - i * TASKGP_SIZE); // the last task group may have less than TASKGP_SIZE meshlets
+            taskCmds[dci + i].lateDrawVisibility = lateDrawVisibility;
+            taskCmds[dci + i].meshletVisibilityOffset = meshletVisibilityOffset + i * TASKGP_SIZE;
+        }
+    }
+    else if (USE_MIXED_RASTER) // samiliar as the task group, but use meshlet group size
+    {
+        for (uint i = 0; i < item.groupCount; ++i)
+        {
+            meshletCmds[dci + i].drawId = di;
+            meshletCmds[dci + i].taskOffset = lod.meshletOffset + i * MR_MESHLETGP_SIZE;
+            meshletCmds[dci + i].taskCount = min(MR_MESHLETGP_SIZE, meshletCount - i * MR_MESHLETGP_SIZE); // fill when the last group lesser than MR_MESHLETGP_SIZE
+            meshletCmds[dci + i].lateDrawVisibility = lateDrawVisibility;
+            meshletCmds[dci + i].meshletVisibilityOffset = meshletVisibilityOffset + i * MR_MESHLETGP_SIZE;
+        }
+    }
+    else
+    {
+        drawCmds[dci].drawId = di;
+        drawCmds[dci].lateDrawVisibility = lateDrawVisibility;
+        drawCmds[dci].taskCount = lod.meshletCount;
+        drawCmds[dci].taskOffset = lod.meshletOffset;
+        drawCmds[dci].indexCount = lod.indexCount;
+        drawCmds[dci].instanceCount = 1;
+        drawCmds[dci].firstIndex = lod.indexOffset;
+        drawCmds[dci].vertexOffset = mesh.vertexOffset;
+        drawCmds[dci].firstInstance = 0;
+        drawCmds[dci].local_x = (lod.meshletCount + TASKGP_SIZE - 1) / TASKGP_SIZE;
+        drawCmds[dci].local_y = 1;
+        drawCmds[dci].local_z = 1;
+    }
+}
@@ -0,0 +1,73 @@
+// ==============================================================================
+// compact g-buffer packing, keep sync with GBufferLayout in vkz_deferred.h
+// - albedo:    rgba8, rgb: base color, a: occlusion
+// - normal:    r32ui, 11:11 octahedral normal, 5 bits roughness, 5 bits metalness
+// - emissive:  r32ui, rgb9e5 shared exponent
+// - the world position is reconstructed from the depth
+// octEncode/octDecode are from rc_common.h
+
+#define GBUF_OCT_BITS 11
+#define GBUF_MAT_BITS 5
+
+uint packGBufferNormal(vec3 _n, float _roughness, float _metalness)
+{
+    const float octMax = float((1u << GBUF_OCT_BITS) - 1u);
+    const float matMax = float((1u << GBUF_MAT_BITS) - 1u);
+
+    uvec2 oct = uvec2(round(clamp(octEncode(_n), 0.0, 1.0) * octMax));
+    uint r = uint(round(clamp(_roughness, 0.0, 1.0) * matMax));
+    uint m = uint(round(clamp(_metalness, 0.0, 1.0) * matMax));
+
+    return oct.x
+        | (oct.y << GBUF_OCT_BITS)
+        | (r << (GBUF_OCT_BITS * 2))
+        | (m << (GBUF_OCT_BITS * 2 + GBUF_MAT_BITS));
+}
+
+void unpackGBufferNormal(uint _v, out vec3 _n, out float _roughness, out float _metalness)
+{
+    const uint octMask = (1u << GBUF_OCT_BITS) - 1u;
+    const uint matMask = (1u << GBUF_MAT_BITS) - 1u;
+
+    vec2 oct = vec2(_v & octMask, (_v >> GBUF_OCT_BITS) & octMask) / float(octMask);
+    _n = octDecode(oct);
+    _roughness = float((_v >> (GBUF_OCT_BITS * 2)) & matMask) / float(matMask);
+    _metalness = float((_v >> (GBUF_OCT_BITS * 2 + GBUF_MAT_BITS)) & matMask) / float(matMask);
+}
+
+// the same encoding as VK_FORMAT_E5B9G9R9_UFLOAT_PACK32
+// https://registry.khronos.org/OpenGL/extensions/EXT/EXT_texture_shared_exponent.txt
+uint packRGB9E5(vec3 _c)
+{
+    const float maxVal = 65408.0; // (2^9 - 1) / 2^9 * 2^(31 - 15)
+    vec3 c = clamp(_c, vec3(0.0), vec3(maxVal));
+
+    float maxC = max(max(c.r, max(c.g, c.b)), 1.0 / 65536.0);
+    int e = max(-16, int(floor(log2(maxC)))) + 1 + 15;
+    float denom = exp2(float(e - 15 - 9));
+
+    // rounding may overflow the mantissa
+    if (uint(floor(maxC / denom + 0.5)) == 512u)
+    {
+        denom *= 2.0;
+        e += 1;
+    }
+
+    uvec3 m = uvec3(floor(c / denom + 0.5));
+    return m.r | (m.g << 9) | (m.b << 18) | (uint(e) << 27);
+}
+
+vec3 unpackRGB9E5(uint _v)
+{
+    uvec3 m = uvec3(_v, _v >> 9, _v >> 18) & 0x1ffu;
+    float scale = exp2(float(int(_v >> 27) - 15 - 9));
+    return vec3(m) * scale;
+}
+
+// reverse-z depth to world space, the viewport is flipped in y
+vec3 reconstructWorldPos(vec2 _uv, float _depth, mat4 _invViewProj)
+{
+    vec4 ndc = vec4(_uv.x * 2.0 - 1.0, 1.0 - _uv.y * 2.0, _depth, 1.0);
+    vec4 wPos = _invViewProj * ndc;
+    return wPos.xyz / wPos.w;
+}
@@ -0,0 +1,131 @@
+#version 450
+
+#extension GL_GOOGLE_include_directive: require
+
+#include "light_gpu.h"
+
+// one workgroup per screen tile, one thread per depth slice
+layout(local_size_x = LIGHT_CLUSTER_SLICES, local_size_y = 1, local_size_z = 1) in;
+
+layout(binding = 0) readonly uniform Config
+{
+    LightClusterConfig cfg;
+};
+
+layout(binding = 1) readonly buffer Lights
+{
+    PunctualLight lights [];
+};
+
+// reverse-z, min reduction gives the farthest depth of the footprint
+layout(binding = 2) uniform sampler2D pyramid;
+
+layout(binding = 3) writeonly buffer Clusters
+{
+    uint clusters [];
+};
+
+// view space light spheres that touch the tile, refilled for each batch
+shared vec4 s_spheres[LIGHT_CLUSTER_SLICES];
+shared uint s_lightIds[LIGHT_CLUSTER_SLICES];
+shared uint s_count;
+
+// view space aabb of the tile between two depths, the viewport is flipped in y
+void getFrustumAabb(vec4 _uvRect, float _zNear, float _zFar, out vec3 _min, out vec3 _max)
+{
+    vec2 ndcMin = vec2(_uvRect.x * 2.0 - 1.0, 1.0 - _uvRect.w * 2.0);
+    vec2 ndcMax = vec2(_uvRect.z * 2.0 - 1.0, 1.0 - _uvRect.y * 2.0);
+    vec2 scale = vec2(1.0 / cfg.P00, 1.0 / cfg.P11);
+
+    vec2 n0 = ndcMin * scale * _zNear;
+    vec2 n1 = ndcMax * scale * _zNear;
+    vec2 f0 = ndcMin * scale * _zFar;
+    vec2 f1 = ndcMax * scale * _zFar;
+
+    _min = vec3(min(min(n0, n1), min(f0, f1)), _zNear);
+    _max = vec3(max(max(n0, n1), max(f0, f1)), _zFar);
+}
+
+void main()
+{
+    uvec2 tile = gl_WorkGroupID.xy;
+    uint slice = gl_LocalInvocationID.x;
+
+    vec2 tileMin = vec2(tile * LIGHT_CLUSTER_TILE_SIZE);
+    vec2 tileMax = min(tileMin + vec2(LIGHT_CLUSTER_TILE_SIZE), vec2(cfg.screenWidth, cfg.screenHeight));
+    vec4 uvRect = vec4(tileMin, tileMax) / vec4(cfg.screenWidth, cfg.screenHeight, cfg.screenWidth, cfg.screenHeight);
+
+    // the farthest surface of the tile, nothing behind it needs lights
+    // the pyramid is from the early depth, the late pass only adds nearer surface so it stays conservative
+    float tileFarZ = cfg.zfar;
+    if (cfg.usePyramid != 0)
+    {
+        float width = (uvRect.z - uvRect.x) * cfg.pyramidWidth;
+        float height = (uvRect.w - uvRect.y) * cfg.pyramidHeight;
+        float level = ceil(log2(max(width, height)));
+
+        // 0 is the cleared depth, the sky may be covered by the late pass
+        float depth = textureLod(pyramid, (uvRect.xy + uvRect.zw) * 0.5, level).x;
+        if (depth > 0.0)
+            tileFarZ = min(cfg.znear / depth, cfg.zfar);
+    }
+
+    float sliceNear = getClusterSliceNear(cfg, slice);
+    float sliceFar = getClusterSliceFar(cfg, slice);
+    bool active = sliceNear <= tileFarZ;
+
+    vec3 tileAabbMin, tileAabbMax;
+    getFrustumAabb(uvRect, cfg.znear, tileFarZ, tileAabbMin, tileAabbMax);
+
+    vec3 sliceAabbMin, sliceAabbMax;
+    getFrustumAabb(uvRect, sliceNear, min(sliceFar, tileFarZ), sliceAabbMin, sliceAabbMax);
+
+    uint ci = getClusterIndex(cfg, tile, slice);
+    uint offset = getClusterCount(cfg) + ci * LIGHT_CLUSTER_MAX_LIGHTS;
+    uint count = 0;
+
+    for (uint base = 0; base < cfg.lightCount; base += LIGHT_CLUSTER_SLICES)
+    {
+        if (slice == 0)
+            s_count = 0;
+
+        barrier();
+
+        // each thread rejects one light against the whole tile
+        uint li = base + slice;
+        if (li < cfg.lightCount)
+        {
+            PunctualLight light = lights[li];
+            vec3 center = (cfg.view * vec4(light.pos, 1.0)).xyz;
+
+            if (sphereAabbIntersect(center, light.range, tileAabbMin, tileAabbMax))
+            {
+                uint slot = atomicAdd(s_count, 1);
+                s_spheres[slot] = vec4(center, light.range);
+                s_lightIds[slot] = li;
+            }
+        }
+
+        barrier();
+
+        if (active)
+        {
+            for (uint ii = 0; ii < s_count; ++ii)
+            {
+                vec4 sphere = s_spheres[ii];
+                if (sphereAabbIntersect(sphere.xyz, sphere.w, sliceAabbMin, sliceAabbMax))
+                {
+                    // the cost per pixel is bounded, the rest lights of the cluster are dropped
+                    if (count < LIGHT_CLUSTER_MAX_LIGHTS)
+                        clusters[offset + count] = s_lightIds[ii];
+
+                    count++;
+                }
+            }
+        }
+
+        barrier();
+    }
+
+    clusters[ci] = min(count, LIGHT_CLUSTER_MAX_LIGHTS);
+}
@@ -0,0 +1,92 @@
+// ==============================================================================
+// clustered punctual lights, keep sync with vkz_light_cluster.h
+// - the screen is split into tiles of LIGHT_CLUSTER_TILE_SIZE pixels
+// - each tile has LIGHT_CLUSTER_SLICES exponential depth slices in [znear, zfar]
+// - cluster buffer: the light count of each cluster, then LIGHT_CLUSTER_MAX_LIGHTS indices per cluster
+
+#define LIGHT_CLUSTER_TILE_SIZE 64
+#define LIGHT_CLUSTER_SLICES 32
+#define LIGHT_CLUSTER_MAX_LIGHTS 64
+
+struct PunctualLight
+{
+    vec3 pos;
+    float range;
+
+    vec3 color;
+    float intensity;
+
+    vec3 dir;       // spot direction, from the light source
+    float spotCos;  // cosine of the outer cone angle, <= -1 is a point light
+};
+
+struct LightClusterConfig
+{
+    mat4 view;
+
+    uint gridX, gridY, gridZ;
+    uint lightCount;
+
+    float znear, zfar;
+    float screenWidth, screenHeight;
+
+    float P00, P11;
+    float pyramidWidth, pyramidHeight;
+
+    uint usePyramid;
+    uint padding0, padding1, padding2;
+};
+
+uint getClusterCount(LightClusterConfig _cfg)
+{
+    return _cfg.gridX * _cfg.gridY * _cfg.gridZ;
+}
+
+uint getClusterIndex(LightClusterConfig _cfg, uvec2 _tile, uint _slice)
+{
+    return (_slice * _cfg.gridY + _tile.y) * _cfg.gridX + _tile.x;
+}
+
+// view space z, +z forward
+uint getClusterSlice(LightClusterConfig _cfg, float _viewZ)
+{
+    float z = max(_viewZ, _cfg.znear);
+    float slice = log(z / _cfg.znear) / log(_cfg.zfar / _cfg.znear) * float(_cfg.gridZ);
+    return min(uint(slice), _cfg.gridZ - 1);
+}
+
+float getClusterSliceNear(LightClusterConfig _cfg, uint _slice)
+{
+    return _cfg.znear * pow(_cfg.zfar / _cfg.znear, float(_slice) / float(_cfg.gridZ));
+}
+
+// nothing is drawn beyond zfar, the last slice ends there
+float getClusterSliceFar(LightClusterConfig _cfg, uint _slice)
+{
+    return getClusterSliceNear(_cfg, _slice + 1);
+}
+
+bool sphereAabbIntersect(vec3 _center, float _radius, vec3 _aabbMin, vec3 _aabbMax)
+{
+    vec3 d = max(_aabbMin - _center, vec3(0.0)) + max(_center - _aabbMax, vec3(0.0));
+    return dot(d, d) <= _radius * _radius;
+}
+
+// smooth window on the inverse square falloff, reaches zero at the range
+// https://google.github.io/filament/Filament.html#lighting/directlighting/punctuallights
+float getLightAttenuation(PunctualLight _light, float _dist)
+{
+    float r = _dist / _light.range;
+    float window = clamp(1.0 - r * r * r * r, 0.0, 1.0);
+    return window * window / max(_dist * _dist, 1e-4);
+}
+
+float getSpotAttenuation(PunctualLight _light, vec3 _l)
+{
+    if (_light.spotCos <= -1.0)
+        return 1.0;
+
+    // 0.1 cosine of soft edge inside the cone
+    float cd = dot(-_l, _light.dir);
+    return clamp((cd - _light.spotCos) / 0.1, 0.0, 1.0);
+}
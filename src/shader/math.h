@@ -60,6 +60,24 @@ vec3 rotateQuat(vec3 v, vec4 q)
     return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
 }
 
+// q0 * q1, apply q1 first
+vec4 mulQuat(vec4 q0, vec4 q1)
+{
+    return vec4(q0.w * q1.xyz + q1.w * q0.xyz + cross(q0.xyz, q1.xyz), q0.w * q1.w - dot(q0.xyz, q1.xyz));
+}
+
+// the screen motion in uv from the last frame, both clip positions are without the jitter
+vec2 calcVelocity(vec4 _currClip, vec4 _prevClip)
+{
+    return (_currClip.xy / _currClip.w - _prevClip.xy / _prevClip.w) * 0.5;
+}
+
+// removes the jitter of the proj from a clip position
+vec4 unjitterClip(vec4 _clip, vec4 _jitter)
+{
+    return vec4(_clip.xy - _jitter.xy * _clip.w, _clip.zw);
+}
+
 float maxElem(vec3 _v)
 {
     return max(max(_v.x, _v.y), _v.z);
@@ -39,6 +39,8 @@ layout(location = 1) out vec3 out_wPos;
 layout(location = 2) out vec3 out_norm;
 layout(location = 3) out vec4 out_tan;
 layout(location = 4) out vec2 out_uv;
+layout(location = 6) out vec4 out_currClip;
+layout(location = 7) out vec4 out_prevClip;
 
 void main()
 {
@@ -55,6 +57,8 @@ void main()
     vec3 result = vec3(rotateQuat(pos, meshDraw.orit) * meshDraw.scale + meshDraw.pos);
 
     gl_Position = trans.proj * trans.view * vec4(result, 1.0);
+    out_currClip = unjitterClip(gl_Position, trans.jitter);
+    out_prevClip = trans.prevViewProj * vec4(result, 1.0);
 
     out_drawId = drawId;
     out_wPos = result;
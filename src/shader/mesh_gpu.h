@@ -6,6 +6,26 @@
 #define MR_TRIANGLEGP_SIZE 64
 #define MR_SOFT_RASTGP_SIZE 64
 
+// trivially accepted meshlets skip the triangle culling, they are written from this raster payload index
+// the triangle culled meshlets use [0, MR_ACCEPTED_PAYLOAD_BASE)
+#define MR_ACCEPTED_PAYLOAD_BASE (4 * 1024 * 1024)
+// minimal projected area in pixel per triangle to accept a meshlet
+#define MR_ACCEPT_MIN_TRI_PIXELS 32.0
+
+// draw command compaction, keep sync with vkz_culling_pass.cpp
+#define DRAW_SORT_BIN_COUNT 512     // depth bins per bucket
+#define DRAW_SORT_BUCKET_COUNT 2    // opaque, alpha
+#define DRAW_SORT_TOTAL_BINS (DRAW_SORT_BIN_COUNT * DRAW_SORT_BUCKET_COUNT)
+#define DRAW_SORT_SCAN_GP_SIZE 256
+#define DRAW_SORT_BINS_PER_THREAD (DRAW_SORT_TOTAL_BINS / DRAW_SORT_SCAN_GP_SIZE)
+
+// transform hierarchy, keep sync with vkz_transform_hierarchy.cpp
+#define TRANSFORM_GP_SIZE 64
+#define TRANSFORM_INVALID_NODE 0xffffffff
+#define TRANSFORM_MODE_SCATTER 0
+#define TRANSFORM_MODE_RESOLVE 1
+#define TRANSFORM_MODE_DRAWS 2
+
 
 #extension GL_EXT_shader_16bit_storage : require
 #extension GL_EXT_shader_8bit_storage : require
@@ -96,6 +116,10 @@ struct TransformData
     
     vec4 cameraPos;
     vec4 cull_cameraPos;
+
+    // the last frame's view proj without the jitter, for the velocity
+    mat4 prevViewProj;
+    vec4 jitter; // xy: the jitter of the proj in ndc
 };
 
 struct MeshLod
@@ -144,6 +168,36 @@ struct Cluster
     uint8_t vertexCount;
 };
 
+// parallel to meshlets, used by the regular lod pipeline to select lod per meshlet
+struct MeshletLodBounds
+{
+    vec3 p_c;
+    float p_r;
+
+    float s_err;
+    float p_err;
+};
+
+// transform hierarchy, nodes are level ordered
+struct TransformNode
+{
+    vec3 pos;
+    uint parent;
+
+    vec3 scale;
+    uint level;
+
+    vec4 orit;
+};
+
+struct TransformNodeUpdate
+{
+    uint nodeIdx;
+    uint padding[3];
+
+    TransformNode node;
+};
+
 // Instances
 struct MeshDraw
 {
@@ -172,6 +226,15 @@ struct MeshTaskCommand
     uint meshletVisibilityOffset;
 };
 
+// per draw culling result, groupCount == 0 means the draw is culled
+struct DrawSortItem
+{
+    uint key; // bucket * DRAW_SORT_BIN_COUNT + depth bin
+    uint groupCount;
+    uint lodIdx; // min lod in low 8 bits, max lod in the next 8 bits
+    uint lateDrawVisibility;
+};
+
 struct MeshDrawCommand
 {
     uint    drawId;
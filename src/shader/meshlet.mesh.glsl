@@ -65,6 +65,8 @@ layout(location = 2) out vec3 out_norm[];
 layout(location = 3) out vec4 out_tan[];
 layout(location = 4) out vec2 out_uv[];
 layout(location = 5) out flat uint out_triId[] ;
+layout(location = 6) out vec4 out_currClip[];
+layout(location = 7) out vec4 out_prevClip[];
 
 taskPayloadSharedEXT TaskPayload payload;
 
@@ -124,6 +126,8 @@ void main()
         out_tan[i] = tan;
         out_uv[i] = uv;
         out_triId[i] = i; // for debug
+        out_currClip[i] = unjitterClip(result, trans.jitter);
+        out_prevClip[i] = trans.prevViewProj * vec4(wPos, 1.0);
 
 
 #if DEBUG_MESHLET
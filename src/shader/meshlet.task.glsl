@@ -62,6 +62,12 @@ layout(binding = 7) buffer MeshletVisibility
 // read
 layout(binding = 8) uniform sampler2D pyramid;
 
+// only used by the regular lod pipeline
+layout(binding = 9) readonly buffer MeshletLods
+{
+    MeshletLodBounds meshletLods [];
+};
+
 taskPayloadSharedEXT TaskPayload payload;
 
 #if CULL
@@ -157,6 +163,20 @@ void main()
 
         ori_center = rotateQuat(meshlets[mi].center, meshDraw.orit) * meshDraw.scale + meshDraw.pos;
         radius = meshlets[mi].radius * maxScaleAxis;
+
+        // the draw emits every lod between its nearest and farthest point, select the lod per meshlet
+        // the parent distance is clamped by the draw bounds to keep the same finest lod as the draw culling
+        vec3 p_center = rotateQuat(meshletLods[mi].p_c, meshDraw.orit) * meshDraw.scale + meshDraw.pos;
+        vec3 m_center = rotateQuat(mesh.center, meshDraw.orit) * meshDraw.scale + meshDraw.pos;
+
+        float m_dist = max(length(m_center - trans.cull_cameraPos.xyz) - mesh.radius * maxScaleAxis, 0);
+        float p_dist = max(length(p_center - trans.cull_cameraPos.xyz) - meshletLods[mi].p_r * maxScaleAxis, m_dist);
+        float p_threshold = p_dist * consts.lodErrorThreshold / maxScaleAxis;
+        float s_dist = max(length(ori_center - trans.cull_cameraPos.xyz) - radius, 0);
+        float s_threshold = s_dist * consts.lodErrorThreshold / maxScaleAxis;
+
+        bool cond = meshletLods[mi].s_err <= s_threshold && meshletLods[mi].p_err > p_threshold;
+        visible = visible && cond;
     }
 
     center = (trans.cull_view * vec4(ori_center, 1.0)).xyz;
@@ -7,7 +7,13 @@
 
 #include "mesh_gpu.h"
 #include "rc_common.h"
+#include "gbuffer.h"
 #include "debug_gpu.h"
+#include "rc_storage.h"
+
+// keep sync with GBufferLayout in vkz_deferred.h
+layout(constant_id = 0) const bool COMPACT_GBUFFER = false;
+layout(constant_id = 1) const uint STORAGE_FORMAT = RC_STORAGE_RGBA8;
 
 layout(push_constant) uniform block
 {
@@ -37,7 +43,22 @@ layout(binding = 4) uniform sampler2D in_emmision;
 layout(binding = 5) uniform sampler2D in_depth;
 layout(binding = 6) uniform samplerCube in_skybox;
 
-layout(binding = 7, RGBA8) uniform writeonly image2DArray out_octProbAtlas;
+// compact g-buffer, the world position slot is unused
+layout(binding = 2) uniform usampler2D in_normalPacked;
+layout(binding = 4) uniform usampler2D in_emmisionPacked;
+
+// the format is picked at init, see rc_storage.h
+layout(binding = 7) uniform writeonly image2DArray out_octProbAtlas;
+layout(binding = 7) uniform writeonly uimage2DArray out_octProbAtlasPacked;
+
+// the live probes of the sparse build, see rc_probe_alloc.comp.glsl
+layout(binding = 8) readonly buffer LiveProbes
+{
+    uint liveProbes[];
+};
+
+// the hit mask of the formats without alpha
+layout(binding = 9) uniform writeonly image2DArray out_octProbAlpha;
 
 // ffx brixelizer data
 layout(binding = 0, set = 2) uniform sampler3D in_sdfAtlas;
@@ -111,6 +132,22 @@ FfxUInt32 LoadCascadeBrickMapArrayUniform(FfxUInt32 _casId, FfxUInt32 _elemIdx)
     return uint(in_cas_brick_maps[_casId].map[_elemIdx]);
 }
 
+void storeCascade(ivec3 _iuv, vec4 _var)
+{
+    if (rcStorageHasAlpha(STORAGE_FORMAT))
+    {
+        imageStore(out_octProbAtlas, _iuv, _var);
+        return;
+    }
+
+    if (STORAGE_FORMAT == RC_STORAGE_RGB9E5)
+        imageStore(out_octProbAtlasPacked, _iuv, uvec4(packRGB9E5(_var.rgb)));
+    else
+        imageStore(out_octProbAtlas, _iuv, _var);
+
+    imageStore(out_octProbAlpha, _iuv, vec4(_var.a));
+}
+
 bool inScreenSpaceRange(vec3 _uvw, float _depth)
 {
     bool res = true;
@@ -123,14 +160,37 @@ bool inScreenSpaceRange(vec3 _uvw, float _depth)
 
 void main()
 {
-    const ivec2 di = ivec2(gl_GlobalInvocationID.xy);
-    const uint lvLayer = gl_GlobalInvocationID.z;
-
     // the config for the radiance cascade.
     const uint prob_gridSideCount = config.probe_sideCount;
     const uint ray_gridSideCount = config.ray_gridSideCount;
     const float rcRadius = config.radius;
 
+    ivec2 di;
+    uint lvLayer;
+    if (config.sparse != 0)
+    {
+        // x of the dispatch is the live probe, y is the ray tile of the probe
+        const ivec3 probe = getWorld3DIdx(liveProbes[config.liveOffset + gl_WorkGroupID.x], prob_gridSideCount);
+        const uvec2 tile = uvec2(gl_WorkGroupID.y % config.rayTileSideCount, gl_WorkGroupID.y / config.rayTileSideCount);
+        const uvec2 rayIdx = tile * gl_WorkGroupSize.xy + gl_LocalInvocationID.xy;
+        if (any(greaterThanEqual(rayIdx, uvec2(ray_gridSideCount))))
+            return;
+
+        di = probe.xy * int(ray_gridSideCount) + ivec2(rayIdx);
+        lvLayer = probe.z;
+    }
+    else
+    {
+        // the y of the dispatch walks the scheduled texel rows of all layers
+        const uint rowsPerLayer = prob_gridSideCount * ray_gridSideCount;
+        const uint row = gl_GlobalInvocationID.y * config.rowStride + config.rowPhase;
+        if (row >= rowsPerLayer * prob_gridSideCount)
+            return;
+
+        di = ivec2(gl_GlobalInvocationID.x, row % rowsPerLayer);
+        lvLayer = row / rowsPerLayer;
+    }
+
     const ivec2 prob_idx = di / int(ray_gridSideCount);
     const ivec2 ray_idx = di % int(ray_gridSideCount);
 
@@ -174,7 +234,7 @@ void main()
         vec3 hit_pos = seg_origin + ffx_hit.t * seg_dir;
 
         // hit pos is in world space, now to uv space
-        vec4 hit_ppos = (trans.proj * trans.view * vec4(hit_pos, 1.0)).xyzw;
+        vec4 hit_ppos = trans.viewProj * vec4(hit_pos, 1.0);
 
         hit_ppos.xyz /= hit_ppos.w;
         hit_ppos.y = -hit_ppos.y; // flip y
@@ -186,9 +246,19 @@ void main()
         //if (inScreenSpaceRange(hit_uvw, depth)) 
         {
             albedo = texture(in_albedo, hit_uvw.xy).xyz;
-            normal = texture(in_normal, hit_uvw.xy).xyz;
-            wpos = texture(in_wPos, hit_uvw.xy).xyz;
-            emision = texture(in_emmision, hit_uvw.xy).xyz;
+            if (COMPACT_GBUFFER)
+            {
+                float roughness, metalness;
+                unpackGBufferNormal(texture(in_normalPacked, hit_uvw.xy).x, normal, roughness, metalness);
+                wpos = reconstructWorldPos(hit_uvw.xy, depth, trans.invViewProj);
+                emision = unpackRGB9E5(texture(in_emmisionPacked, hit_uvw.xy).x);
+            }
+            else
+            {
+                normal = texture(in_normal, hit_uvw.xy).xyz;
+                wpos = texture(in_wPos, hit_uvw.xy).xyz;
+                emision = texture(in_emmision, hit_uvw.xy).xyz;
+            }
         }
         hit_distance = ffx_hit.t;
         hit_normal = norm;
@@ -245,5 +315,5 @@ void main()
             break;
     }
     float hitvar = (hit) ? 0.f : 1.f;
-    imageStore(out_octProbAtlas, iuv, vec4(var, hitvar));
+    storeCascade(iuv, vec4(var, hitvar));
 }
\ No newline at end of file
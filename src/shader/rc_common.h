@@ -29,6 +29,15 @@ struct RadianceCascadesConfig
 
     uint debug_idx_type;
     uint debug_color_type;
+
+    // temporal amortization, every rowStride-th texel row starting from rowPhase is traced
+    uint rowStride;
+    uint rowPhase;
+
+    // sparse probes, a workgroup traces a ray tile of a live probe
+    uint sparse;
+    uint liveOffset;
+    uint rayTileSideCount;
 };
 
 struct RCMergeData
@@ -51,6 +60,40 @@ struct VoxelizationConsts
     uint voxGridCount;
     float voxCellLen;
     float sceneRadius;
+
+    // the center of the voxel volume, the same as the probe volume
+    float cx, cy, cz;
+    uint drawCount;
+
+    // the voxel counts are cleared, all the draws are voxelized
+    uint rebuild;
+    // the task list has a region to remove and one to add, each of taskCapacity
+    uint taskCapacity;
+    uint taskOffset;
+    uint remove;
+    uint padding0;
+};
+
+// the transform a draw was voxelized with, compared to the current one to find the moved draws
+struct VoxDrawState
+{
+    vec3 pos;
+    uint added; // the draw was in the volume, its triangles are counted
+    vec3 scale;
+    uint padding0;
+    vec4 orit;
+};
+
+// a range of meshlets of a draw with the transform to voxelize them with
+struct VoxTask
+{
+    vec3 pos;
+    uint meshletOffset;
+    vec3 scale;
+    uint meshletCount;
+    vec4 orit;
+    uint vertexOffset;
+    uint padding0, padding1, padding2;
 };
 
 // ==============================================================================
@@ -58,11 +101,31 @@ struct VoxelizationConsts
 #define INVALID_OCT_IDX 0xFFFFFFFFu
 #define INVALID_VOX_ID 0xFFFFFFFFu
 
+// the occupancy grid has 2 voxels per level 0 probe, so the level n oct-tree node covers a level n probe
+// keep sync with vkz_rc_occupancy.h
+#define RC_VOX_SIDE_COUNT 64
+#define RC_OCT_TREE_LEVELS 6
+#define RC_SPARSE_RAY_TILE 16
+
+// meshlets per voxelization workgroup, a draw is split into tasks of this size
+#define RC_VOX_TASK_MESHLETS 32
+
 struct OctTreeNode
 {
     uint dataIdx;
     uint lv;
     uint childs[8]; // if is leaf, it's the index of voxel, else the index in the octTree;
+    uint full;      // all the voxels under the node are occupied
+};
+
+struct ProbeAllocConsts
+{
+    uint lv;
+    uint probeSideCount;
+    uint nodeOffset;        // offset of the oct-tree level in the vox medium map
+    uint liveOffset;        // offset of the cascade level in the live probe list
+    uint rayTileCount;      // workgroups per probe of the sparse build
+    uint padding0, padding1, padding2;
 };
 
 struct OctTreeProcessConfig
@@ -98,6 +161,9 @@ struct DeferredConstants
 
     float w, h;
     float camx, camy, camz;
+    float padding;
+
+    mat4 invViewProj; // only used by the compact g-buffer
 };
 
 struct RCAccessData
@@ -154,6 +220,8 @@ struct RadianceCascadesTransform
 {
     mat4 view;
     mat4 proj;
+    mat4 viewProj;
+    mat4 invViewProj; // only used by the compact g-buffer
     vec3 cameraPos;
 };
 
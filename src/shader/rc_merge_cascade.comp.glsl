@@ -9,6 +9,8 @@
 #include "math.h"
 #include "rc_common.h"
 #include "debug_gpu.h"
+#include "gbuffer.h"
+#include "rc_storage.h"
 
 #define DEBUG_LEVELS 0
 
@@ -17,6 +19,10 @@
 // 2. merge each probe(cascade interval) into 1 texel, which can be treated as a LoD of the level 0
 layout(constant_id = 0) const bool RAY_PRIME = false;
 
+// the format of the input cascade and of the merged output, see rc_storage.h
+layout(constant_id = 1) const uint IN_FORMAT = RC_STORAGE_RGBA8;
+layout(constant_id = 2) const uint OUT_FORMAT = RC_STORAGE_RGBA8;
+
 layout(push_constant) uniform block
 {
     RCMergeData data;
@@ -27,7 +33,45 @@ layout(local_size_x = 8, local_size_y = 8, local_size_z = 8) in;
 layout(binding = 0) uniform samplerCube in_skybox;
 layout(binding = 1) uniform sampler2DArray in_rc; // rc data
 layout(binding = 2) uniform sampler2DArray in_merged_rc; // intermediate data, which is merged [current level + 1] + [next level + 1] into the current level
-layout(binding = 3, RGBA8) uniform image2DArray merged_rc; // store the merged data
+layout(binding = 3) uniform writeonly image2DArray merged_rc; // store the merged data
+
+// the packed rgb9e5 views of the above
+layout(binding = 1) uniform usampler2DArray in_rcPacked;
+layout(binding = 2) uniform usampler2DArray in_merged_rcPacked;
+layout(binding = 3) uniform writeonly uimage2DArray merged_rcPacked;
+
+// the hit mask of the formats without alpha, the input of the ray merge shares the output format
+layout(binding = 4) uniform sampler2DArray in_rcAlpha;
+layout(binding = 5) uniform sampler2DArray in_merged_rcAlpha;
+layout(binding = 6) uniform writeonly image2DArray merged_rcAlpha;
+
+vec4 sampleInRC(vec3 _uvl)
+{
+    return sampleRC(IN_FORMAT, in_rc, in_rcPacked, in_rcAlpha, _uvl);
+}
+
+vec4 sampleMergedRC(vec3 _uvl)
+{
+    return sampleRC(OUT_FORMAT, in_merged_rc, in_merged_rcPacked, in_merged_rcAlpha, _uvl);
+}
+
+void storeMergedRC(ivec3 _pos, vec4 _var)
+{
+    if (rcStorageHasAlpha(OUT_FORMAT))
+    {
+        imageStore(merged_rc, _pos, _var);
+        return;
+    }
+
+    if (OUT_FORMAT == RC_STORAGE_RGB9E5)
+        imageStore(merged_rcPacked, _pos, uvec4(packRGB9E5(_var.rgb)));
+    else
+        imageStore(merged_rc, _pos, _var);
+
+    // the merged probes keep no hit mask
+    if (RAY_PRIME)
+        imageStore(merged_rcAlpha, _pos, vec4(_var.a));
+}
 
 
 // merge intervals based on the alpha channel
@@ -178,7 +222,7 @@ void main()
 #if DEBUG_LEVELS
         radiance0 = getDebugLvColor(currLv);
 #else
-        radiance0 = texture(in_rc, vec3(uv0, layerIdx));  // current currLv would always use the in_rc value;
+        radiance0 = sampleInRC(vec3(uv0, layerIdx));  // current currLv would always use the in_rc value;
 #endif
 
         ProbeSample probe_samp = getProbeNextLvSamp(ivec3(probeIdx.xy, float(layer)));
@@ -216,7 +260,7 @@ void main()
             ivec3 nextLvProbeIdx = getNextLvProbeIdx(di, nextProbeSideCount, offset);
             uint nextLvLayerIdx = nextLvProbeIdx.z + data.offset + probeSideCount;
 
-            vec4 radianceN_1 = texture(in_merged_rc, vec3(uv, nextLvLayerIdx));
+            vec4 radianceN_1 = sampleMergedRC(vec3(uv, nextLvLayerIdx));
 #if DEBUG_LEVELS
             if (currLv == data.endLv - 1)
             {
@@ -235,7 +279,7 @@ void main()
             mergedRadiance += mergeIntervals(radiance0, radianceN_1) * weights[ii];
         }
 
-        imageStore(merged_rc, ivec3(currTexelPos, layerIdx), mergedRadiance);
+        storeMergedRC(ivec3(currTexelPos, layerIdx), mergedRadiance);
     }
     else
     {
@@ -250,7 +294,7 @@ void main()
                 vec2 texelPos = getRCTexelPos(data.idxType, raySideCount, probeSideCount, di.xy, ivec2(ww, hh));
 
                 vec2 uv = vec2(texelPos + .5f) / float(probeSideCount * raySideCount);
-                vec4 radiance = texture(in_rc, vec3(uv.xy, di.z));
+                vec4 radiance = sampleInRC(vec3(uv.xy, di.z));
 
                 if (compare(radiance.w, 1.f))
                     continue;
@@ -261,6 +305,6 @@ void main()
 
         mergedRadiance /= float(raySideCount * raySideCount);
 
-        imageStore(merged_rc, ivec3(di.xyz), mergedRadiance);
+        storeMergedRC(ivec3(di.xyz), mergedRadiance);
     }
 }
\ No newline at end of file
@@ -66,12 +66,19 @@ void main()
     // e.g.: vox resolution was 32^3, the the 0 level has 16^3 nodes, each node contains 8 voxels
     uint nodes[8];
     uint res = 0;
+    uint full = 1;
     for (uint ii = 0; ii < 8; ii++)
     {
         uint cIdx = getVoxChildGridIdx(vp, voxSideCnt, ii);
         uint var = (lv == 0) ? voxMap[cIdx] : voxMediumMap[cIdx + roff];
         nodes[ii] = var;
         res |= (var ^ INVALID_OCT_IDX);
+
+        // a node is full when all the voxels under it are occupied
+        if (var == INVALID_OCT_IDX)
+            full = 0;
+        else if (lv > 0)
+            full &= octTree[var].full;
     }
 
     if (res > 0)
@@ -84,6 +91,7 @@ void main()
 
         octTree[octNodeIdx].dataIdx = octNodeIdx;
         octTree[octNodeIdx].lv = lv;
+        octTree[octNodeIdx].full = full;
         voxMediumMap[vi] = octNodeIdx;
 
         memoryBarrierBuffer();
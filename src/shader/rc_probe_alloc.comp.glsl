@@ -0,0 +1,90 @@
+#version 450
+
+#extension GL_EXT_shader_16bit_storage: require
+#extension GL_EXT_shader_8bit_storage: require
+
+#extension GL_GOOGLE_include_directive: require
+
+#include "mesh_gpu.h"
+#include "rc_common.h"
+
+layout(local_size_x = 4, local_size_y = 4, local_size_z = 4) in;
+
+layout(push_constant) uniform block
+{
+    ProbeAllocConsts consts;
+};
+
+layout(binding = 0) readonly buffer VoxMediumMap
+{
+    uint voxMediumMap[];
+};
+
+layout(binding = 1) readonly buffer OctTree
+{
+    OctTreeNode octTree[];
+};
+
+// one dispatch command per cascade level
+layout(binding = 2) buffer DispatchCommands
+{
+    IndirectDispatchCommand cmds[];
+};
+
+// the indirection table, the linear index of the live probes of each level
+layout(binding = 3) writeonly buffer LiveProbes
+{
+    uint liveProbes[];
+};
+
+// the node of the same level covers the probe cell
+// a cell is worth a probe if it has surfaces but is not buried inside the geometry
+bool isSurfaceCell(ivec3 _ni)
+{
+    const int side = int(consts.probeSideCount);
+    if (any(lessThan(_ni, ivec3(0))) || any(greaterThanEqual(_ni, ivec3(side))))
+        return false;
+
+    uint node = voxMediumMap[consts.nodeOffset + (_ni.z * side + _ni.y) * side + _ni.x];
+    if (node == INVALID_OCT_IDX)
+        return false;
+
+    return octTree[node].full == 0;
+}
+
+void main()
+{
+    const uint side = consts.probeSideCount;
+    const uint lv = consts.lv;
+
+    if (gl_GlobalInvocationID.x == 0 && gl_GlobalInvocationID.y == 0 && gl_GlobalInvocationID.z == 0)
+    {
+        cmds[lv].local_y = consts.rayTileCount;
+        cmds[lv].local_z = 1;
+    }
+
+    ivec3 pi = ivec3(gl_GlobalInvocationID.xyz);
+    if (any(greaterThanEqual(pi, ivec3(side))))
+        return;
+
+    // the probe is interpolated by the surfaces of the neighbor cells as well
+    bool live = false;
+    for (int z = -1; z <= 1 && !live; ++z)
+    {
+        for (int y = -1; y <= 1 && !live; ++y)
+        {
+            for (int x = -1; x <= 1 && !live; ++x)
+            {
+                live = isSurfaceCell(pi + ivec3(x, y, z));
+            }
+        }
+    }
+
+    if (!live)
+        return;
+
+    uint slot = atomicAdd(cmds[lv].count, 1);
+    atomicAdd(cmds[lv].local_x, 1);
+
+    liveProbes[consts.liveOffset + slot] = (pi.z * side + pi.y) * side + pi.x;
+}
@@ -8,6 +8,10 @@
 # include "mesh_gpu.h"
 # include "rc_common.h"
 #include "debug_gpu.h"
+# include "gbuffer.h"
+# include "rc_storage.h"
+
+layout(constant_id = 0) const uint STORAGE_FORMAT = RC_STORAGE_RGBA8;
 
 
 layout(push_constant) uniform block
@@ -16,6 +20,7 @@ layout(push_constant) uniform block
 };
 
 layout(binding = 3) uniform sampler2DArray in_cascades;
+layout(binding = 3) uniform usampler2DArray in_cascadesPacked;
 
 layout(location = 0) in flat ivec3 in_probeId;
 layout(location = 1) in vec3 in_dir;
@@ -38,7 +43,9 @@ void main()
 
     vec2 uv = (vec2(pixelIdx) + vec2(0.5f)) / (probeSideCnt * raySideCnt);
 
-    vec3 color = texture(in_cascades, vec3(uv.xy, layerId)).rgb;
+    vec3 color = (STORAGE_FORMAT == RC_STORAGE_RGB9E5)
+        ? sampleRGB9E5(in_cascadesPacked, vec3(uv.xy, layerId))
+        : texture(in_cascades, vec3(uv.xy, layerId)).rgb;
 
     outColor = vec4(color.rgb, 1.f);
 }
\ No newline at end of file
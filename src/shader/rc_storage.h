@@ -0,0 +1,49 @@
+// ==============================================================================
+// storage formats of the cascade images, keep sync with RCStorageFormat in vkz_rc_common.h
+// - rgba8, rgba16f: the hit mask is kept in the alpha
+// - r11g11b10: the hit mask is kept in an extra r8 image
+// - rgb9e5: not a storage format on most devices, packed by hand into r32ui, the hit mask is kept in an extra r8 image
+// requires gbuffer.h for the rgb9e5 packing
+
+#define RC_STORAGE_RGBA8        0
+#define RC_STORAGE_R11G11B10    1
+#define RC_STORAGE_RGB9E5       2
+#define RC_STORAGE_RGBA16F      3
+
+bool rcStorageHasAlpha(uint _format)
+{
+    return _format == RC_STORAGE_RGBA8 || _format == RC_STORAGE_RGBA16F;
+}
+
+// integer images can't be filtered, do the bilinear by hand
+// the layer is rounded the same as texture()
+vec3 sampleRGB9E5(usampler2DArray _tex, vec3 _uvl)
+{
+    ivec3 size = textureSize(_tex, 0);
+    ivec2 maxPos = size.xy - ivec2(1);
+    int layer = clamp(int(_uvl.z + 0.5), 0, size.z - 1);
+
+    vec2 p = _uvl.xy * vec2(size.xy) - 0.5;
+    ivec2 p0 = ivec2(floor(p));
+    vec2 f = p - vec2(p0);
+
+    vec3 c00 = unpackRGB9E5(texelFetch(_tex, ivec3(clamp(p0, ivec2(0), maxPos), layer), 0).x);
+    vec3 c10 = unpackRGB9E5(texelFetch(_tex, ivec3(clamp(p0 + ivec2(1, 0), ivec2(0), maxPos), layer), 0).x);
+    vec3 c01 = unpackRGB9E5(texelFetch(_tex, ivec3(clamp(p0 + ivec2(0, 1), ivec2(0), maxPos), layer), 0).x);
+    vec3 c11 = unpackRGB9E5(texelFetch(_tex, ivec3(clamp(p0 + ivec2(1, 1), ivec2(0), maxPos), layer), 0).x);
+
+    return mix(mix(c00, c10, f.x), mix(c01, c11, f.x), f.y);
+}
+
+// only the sampler that matches the format is accessed
+vec4 sampleRC(uint _format, sampler2DArray _tex, usampler2DArray _packed, sampler2DArray _alpha, vec3 _uvl)
+{
+    if (rcStorageHasAlpha(_format))
+        return texture(_tex, _uvl);
+
+    vec3 rgb = (_format == RC_STORAGE_RGB9E5)
+        ? sampleRGB9E5(_packed, _uvl)
+        : texture(_tex, _uvl).rgb;
+
+    return vec4(rgb, texture(_alpha, _uvl).x);
+}
@@ -0,0 +1,139 @@
+#version 450
+
+#extension GL_EXT_shader_16bit_storage: require
+#extension GL_EXT_shader_8bit_storage: require
+
+#extension GL_GOOGLE_include_directive: require
+
+#include "mesh_gpu.h"
+#include "math.h"
+#include "rc_common.h"
+
+layout(local_size_x = TASKGP_SIZE, local_size_y = 1, local_size_z = 1) in;
+
+layout(constant_id = 0) const bool SEAMLESS_LOD = false;
+
+layout(push_constant) uniform block
+{
+    VoxelizationConsts consts;
+};
+
+// readonly
+layout(binding = 0) readonly buffer Meshes
+{
+    Mesh meshes[];
+};
+
+layout(binding = 1) readonly buffer MeshDraws
+{
+    MeshDraw draws[];
+};
+
+// read-write
+layout(binding = 2) buffer VoxDraws
+{
+    VoxDrawState voxDraws[];
+};
+
+// 0: remove, 1: add
+layout(binding = 3) buffer VoxTaskCommands
+{
+    IndirectDispatchCommand cmds[];
+};
+
+// writeonly
+layout(binding = 4) writeonly buffer VoxTasks
+{
+    VoxTask tasks[];
+};
+
+bool inVolume(Mesh _mesh, vec3 _pos, vec3 _scale, vec4 _orit)
+{
+    vec3 center = rotateQuat(_mesh.center, _orit) * _scale + _pos;
+    float radius = _mesh.radius * max(_scale.x, max(_scale.y, _scale.z));
+
+    vec3 volCenter = vec3(consts.cx, consts.cy, consts.cz);
+    vec3 d = max(abs(center - volCenter) - vec3(consts.sceneRadius), vec3(0.0));
+    return dot(d, d) <= radius * radius;
+}
+
+// split the meshlets into tasks, the draws beyond the capacity are dropped
+void emitTasks(uint _cmdIdx, MeshLod _lod, uint _vertexOffset, vec3 _pos, vec3 _scale, vec4 _orit)
+{
+    uint taskCount = (_lod.meshletCount + RC_VOX_TASK_MESHLETS - 1) / RC_VOX_TASK_MESHLETS;
+    if (taskCount == 0)
+        return;
+
+    uint slot = atomicAdd(cmds[_cmdIdx].count, taskCount);
+    if (slot + taskCount > consts.taskCapacity)
+        return;
+
+    atomicAdd(cmds[_cmdIdx].local_x, taskCount);
+
+    uint base = _cmdIdx * consts.taskCapacity + slot;
+    for (uint ii = 0; ii < taskCount; ++ii)
+    {
+        uint first = ii * RC_VOX_TASK_MESHLETS;
+
+        VoxTask task;
+        task.pos = _pos;
+        task.meshletOffset = _lod.meshletOffset + first;
+        task.scale = _scale;
+        task.meshletCount = min(RC_VOX_TASK_MESHLETS, _lod.meshletCount - first);
+        task.orit = _orit;
+        task.vertexOffset = _vertexOffset;
+        task.padding0 = 0;
+        task.padding1 = 0;
+        task.padding2 = 0;
+
+        tasks[base + ii] = task;
+    }
+}
+
+// compare each draw with the transform it was voxelized with
+// a moved draw removes its triangles with the old transform and adds them with the new one
+void main()
+{
+    uint di = gl_GlobalInvocationID.x;
+
+    if (di == 0)
+    {
+        cmds[0].local_y = 1;
+        cmds[0].local_z = 1;
+        cmds[1].local_y = 1;
+        cmds[1].local_z = 1;
+    }
+
+    if (di >= consts.drawCount)
+        return;
+
+    MeshDraw draw = draws[di];
+    VoxDrawState state = voxDraws[di];
+
+    bool moved = (consts.rebuild == 1)
+        || any(notEqual(state.pos, draw.pos))
+        || any(notEqual(state.scale, draw.scale))
+        || any(notEqual(state.orit, draw.orit));
+
+    if (!moved)
+        return;
+
+    Mesh mesh = meshes[draw.meshIdx];
+
+    // the seamless lod voxelizes the clusters of the first level only, see rc_voxelize.comp.glsl
+    MeshLod lod = SEAMLESS_LOD ? mesh.seamlessLod : mesh.lods[0];
+
+    // the counts are cleared for a rebuild, nothing to remove
+    if (consts.rebuild == 0 && state.added == 1)
+        emitTasks(0, lod, draw.vertexOffset, state.pos, state.scale, state.orit);
+
+    bool inside = inVolume(mesh, draw.pos, draw.scale, draw.orit);
+    if (inside)
+        emitTasks(1, lod, draw.vertexOffset, draw.pos, draw.scale, draw.orit);
+
+    state.pos = draw.pos;
+    state.scale = draw.scale;
+    state.orit = draw.orit;
+    state.added = inside ? 1 : 0;
+    voxDraws[di] = state;
+}
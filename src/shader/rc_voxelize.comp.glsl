@@ -0,0 +1,226 @@
+#version 450
+
+// ============================================
+// the compute voxelizer of the radiance cascades occupancy
+// - each workgroup processes one task: a range of meshlets of a draw
+// - each invocation processes one triangle of the meshlet
+// the triangles are counted into the voxels they overlap, conservatively
+// a voxel is occupied while its count is not 0, so a moved draw only removes and adds its own triangles
+
+#extension GL_EXT_shader_16bit_storage: require
+#extension GL_EXT_shader_8bit_storage: require
+
+// for using uint8_t in general code
+#extension GL_EXT_shader_explicit_arithmetic_types: require
+#extension GL_EXT_shader_explicit_arithmetic_types_int8: require
+
+#extension GL_GOOGLE_include_directive: require
+
+#include "mesh_gpu.h"
+#include "math.h"
+#include "rc_common.h"
+
+layout(local_size_x = MESHGP_SIZE, local_size_y = 1, local_size_z = 1) in;
+
+layout(constant_id = 0) const bool SEAMLESS_LOD = false;
+
+layout(push_constant) uniform block
+{
+    VoxelizationConsts consts;
+};
+
+// readonly
+layout(binding = 0) readonly buffer Vertices
+{
+    Vertex vertices[];
+};
+
+layout(binding = 1) readonly buffer Meshlets
+{
+    Meshlet meshlets[];
+};
+
+layout(binding = 1) readonly buffer Clusters
+{
+    Cluster clusters[];
+};
+
+layout(binding = 2) readonly buffer MeshletData
+{
+    uint meshletData[];
+};
+
+layout(binding = 2) readonly buffer MeshletData8
+{
+    uint8_t meshletData8[];
+};
+
+layout(binding = 3) readonly buffer VoxTasks
+{
+    VoxTask tasks[];
+};
+
+// read-write
+layout(binding = 4) buffer VoxCounts
+{
+    uint voxCounts[];
+};
+
+// the occupied voxels store their own index, the rest keep INVALID_VOX_ID
+layout(binding = 5) buffer VoxelMap
+{
+    uint voxels[];
+};
+
+shared vec3 gridPos[MESH_MAX_VTX];
+
+// separating axis test of the triangle and the box, both relative to the box center
+bool separated(vec3 _axis, vec3 _v0, vec3 _v1, vec3 _v2, vec3 _halfSize)
+{
+    float p0 = dot(_v0, _axis);
+    float p1 = dot(_v1, _axis);
+    float p2 = dot(_v2, _axis);
+    float r = dot(_halfSize, abs(_axis));
+
+    return min(p0, min(p1, p2)) > r || max(p0, max(p1, p2)) < -r;
+}
+
+// Akenine-Moller, the box axes are covered by the voxel range of the triangle bounds
+bool triBoxOverlap(vec3 _center, vec3 _halfSize, vec3 _a, vec3 _b, vec3 _c)
+{
+    vec3 v0 = _a - _center;
+    vec3 v1 = _b - _center;
+    vec3 v2 = _c - _center;
+
+    vec3 e0 = v1 - v0;
+    vec3 e1 = v2 - v1;
+    vec3 e2 = v0 - v2;
+
+    // the plane of the triangle
+    vec3 n = cross(e0, e1);
+    if (abs(dot(n, v0)) > dot(_halfSize, abs(n)))
+        return false;
+
+    // the edges against the box axes
+    vec3 edges[3] = { e0, e1, e2 };
+    for (uint ii = 0; ii < 3; ++ii)
+    {
+        vec3 e = edges[ii];
+        if (separated(vec3(0.f, -e.z, e.y), v0, v1, v2, _halfSize)
+            || separated(vec3(e.z, 0.f, -e.x), v0, v1, v2, _halfSize)
+            || separated(vec3(-e.y, e.x, 0.f), v0, v1, v2, _halfSize))
+            return false;
+    }
+
+    return true;
+}
+
+void countVoxel(uint _idx)
+{
+    if (consts.remove == 1)
+    {
+        // the last triangle left the voxel
+        if (atomicAdd(voxCounts[_idx], 0xFFFFFFFFu) == 1)
+            voxels[_idx] = INVALID_VOX_ID;
+    }
+    else
+    {
+        // the first triangle entered the voxel
+        if (atomicAdd(voxCounts[_idx], 1) == 0)
+            voxels[_idx] = _idx;
+    }
+}
+
+// the triangle in voxel units, a voxel is the unit box at its integer coordinate
+void voxelizeTriangle(vec3 _a, vec3 _b, vec3 _c)
+{
+    const int side = int(consts.voxGridCount);
+
+    ivec3 minVox = ivec3(floor(min(_a, min(_b, _c))));
+    ivec3 maxVox = ivec3(floor(max(_a, max(_b, _c))));
+
+    if (any(lessThan(maxVox, ivec3(0))) || any(greaterThanEqual(minVox, ivec3(side))))
+        return;
+
+    minVox = clamp(minVox, ivec3(0), ivec3(side - 1));
+    maxVox = clamp(maxVox, ivec3(0), ivec3(side - 1));
+
+    // large triangles walk their whole bounds, they are rare in the meshlets
+    for (int z = minVox.z; z <= maxVox.z; ++z)
+    {
+        for (int y = minVox.y; y <= maxVox.y; ++y)
+        {
+            for (int x = minVox.x; x <= maxVox.x; ++x)
+            {
+                if (!triBoxOverlap(vec3(x, y, z) + vec3(.5f), vec3(.5f), _a, _b, _c))
+                    continue;
+
+                countVoxel(uint((z * side + y) * side + x));
+            }
+        }
+    }
+}
+
+void main()
+{
+    uint ti = gl_LocalInvocationID.x;
+    VoxTask task = tasks[consts.taskOffset + gl_WorkGroupID.x];
+
+    for (uint mm = 0; mm < task.meshletCount; ++mm)
+    {
+        uint mi = task.meshletOffset + mm;
+
+        uint vertexCount = 0;
+        uint triangleCount = 0;
+        uint dataOffset = 0;
+
+        if (SEAMLESS_LOD)
+        {
+            // the clusters of the first level have no error, the coarser ones cover the same surface
+            Cluster clt = clusters[mi];
+            if (clt.s_err != 0.f)
+                continue;
+
+            vertexCount = uint(clt.vertexCount);
+            triangleCount = uint(clt.triangleCount);
+            dataOffset = clt.dataOffset;
+        }
+        else
+        {
+            Meshlet mlt = meshlets[mi];
+            vertexCount = uint(mlt.vertexCount);
+            triangleCount = uint(mlt.triangleCount);
+            dataOffset = mlt.dataOffset;
+        }
+
+        uint vertexOffset = dataOffset;
+        uint indexOffset = dataOffset + vertexCount;
+
+        // the previous meshlet is done with the shared positions
+        barrier();
+
+        // world space to the voxel grid
+        for (uint ii = ti; ii < vertexCount; ii += MESHGP_SIZE)
+        {
+            uint vi = meshletData[vertexOffset + ii] + task.vertexOffset;
+
+            vec3 pos = vec3(vertices[vi].vx, vertices[vi].vy, vertices[vi].vz);
+            vec3 wPos = rotateQuat(pos, task.orit) * task.scale + task.pos;
+            vec3 ndc = (consts.proj * vec4(wPos, 1.f)).xyz;
+            gridPos[ii] = (ndc * .5f + .5f) * float(consts.voxGridCount);
+        }
+
+        barrier();
+
+        for (uint ii = ti; ii < triangleCount; ii += MESHGP_SIZE)
+        {
+            uint offset = indexOffset * 4 + ii * 3; // x4 for uint8_t
+
+            uint idx0 = uint(meshletData8[offset + 0]);
+            uint idx1 = uint(meshletData8[offset + 1]);
+            uint idx2 = uint(meshletData8[offset + 2]);
+
+            voxelizeTriangle(gridPos[idx0], gridPos[idx1], gridPos[idx2]);
+        }
+    }
+}
@@ -0,0 +1,51 @@
+// ==============================================================================
+// the static scene buffers read through the device addresses, keep sync with SceneAddressSlot in demo_structs.h
+// the block is filled with kage::updateBufferAddresses in the order of the slots, mesh_gpu.h must be included first
+
+#extension GL_EXT_buffer_reference: require
+#extension GL_EXT_shader_explicit_arithmetic_types_int64: require
+
+layout(buffer_reference, std430) readonly buffer MeshesRef
+{
+    Mesh data[];
+};
+
+layout(buffer_reference, std430) readonly buffer MeshletsRef
+{
+    Meshlet data[];
+};
+
+layout(buffer_reference, std430) readonly buffer ClustersRef
+{
+    Cluster data[];
+};
+
+layout(buffer_reference, std430) readonly buffer MeshletLodsRef
+{
+    MeshletLodBounds data[];
+};
+
+layout(buffer_reference, std430) readonly buffer VerticesRef
+{
+    Vertex data[];
+};
+
+layout(buffer_reference, std430) readonly buffer MeshletDataRef
+{
+    uint data[];
+};
+
+// the triangle indices are packed as uint8_t, needs GL_EXT_shader_8bit_storage
+layout(buffer_reference, std430) readonly buffer MeshletData8Ref
+{
+    uint8_t data[];
+};
+
+struct SceneAddresses
+{
+    MeshesRef meshes;
+    uint64_t meshlets; // the clusters with the seamless lod, cast to MeshletsRef or ClustersRef
+    MeshletLodsRef meshletLods;
+    VerticesRef vertices;
+    uint64_t meshletData; // cast to MeshletDataRef or MeshletData8Ref
+};
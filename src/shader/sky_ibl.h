@@ -0,0 +1,98 @@
+// ==============================================================================
+// image based lighting from the sky cube, keep sync with vkz_sky_ibl.h/.cpp
+// - specular: a ggx prefiltered cube, the roughness of a mip is mip / (SKY_IBL_SPECULAR_MIPS - 1)
+// - irradiance: 9 sh coefficients of the cosine convolved radiance, rgb in the xyz
+// the cpu reference in vkz_sky_ibl.cpp runs the same steps
+
+#define SKY_IBL_SPECULAR_MIPS 6
+#define SKY_IBL_SH_SIZE 64
+#define SKY_IBL_SH_COEFFS 9
+
+#define SKY_IBL_PI 3.14159265359
+
+// vulkan cube face order: +x, -x, +y, -y, +z, -z
+// _uv in [-1, 1]
+vec3 skyCubeDir(uint _face, vec2 _uv)
+{
+    vec3 dir;
+    switch (_face)
+    {
+    case 0: dir = vec3( 1.0, -_uv.y, -_uv.x); break;
+    case 1: dir = vec3(-1.0, -_uv.y,  _uv.x); break;
+    case 2: dir = vec3( _uv.x,  1.0,  _uv.y); break;
+    case 3: dir = vec3( _uv.x, -1.0, -_uv.y); break;
+    case 4: dir = vec3( _uv.x, -_uv.y,  1.0); break;
+    default: dir = vec3(-_uv.x, -_uv.y, -1.0); break;
+    }
+    return normalize(dir);
+}
+
+float skyCubeAreaElement(float _x, float _y)
+{
+    return atan(_x * _y, sqrt(_x * _x + _y * _y + 1.0));
+}
+
+// the solid angle of the texel at _pos on a _size^2 face
+float skyCubeTexelSolidAngle(uvec2 _pos, uint _size)
+{
+    float inv = 1.0 / float(_size);
+    vec2 p0 = vec2(_pos) * 2.0 * inv - 1.0;
+    vec2 p1 = p0 + 2.0 * inv;
+
+    return skyCubeAreaElement(p0.x, p0.y) - skyCubeAreaElement(p0.x, p1.y)
+        - skyCubeAreaElement(p1.x, p0.y) + skyCubeAreaElement(p1.x, p1.y);
+}
+
+void skySHBasis(vec3 _n, out float _y[SKY_IBL_SH_COEFFS])
+{
+    _y[0] = 0.282095;
+    _y[1] = 0.488603 * _n.y;
+    _y[2] = 0.488603 * _n.z;
+    _y[3] = 0.488603 * _n.x;
+    _y[4] = 1.092548 * _n.x * _n.y;
+    _y[5] = 1.092548 * _n.y * _n.z;
+    _y[6] = 0.315392 * (3.0 * _n.z * _n.z - 1.0);
+    _y[7] = 1.092548 * _n.x * _n.z;
+    _y[8] = 0.546274 * (_n.x * _n.x - _n.y * _n.y);
+}
+
+// the cosine lobe of each band, applied when the coefficients are stored
+float skySHBandFactor(uint _idx)
+{
+    return _idx == 0 ? SKY_IBL_PI : (_idx < 4 ? 2.0 * SKY_IBL_PI / 3.0 : SKY_IBL_PI / 4.0);
+}
+
+vec3 skyIrradianceSH(vec4 _sh[SKY_IBL_SH_COEFFS], vec3 _n)
+{
+    float y[SKY_IBL_SH_COEFFS];
+    skySHBasis(_n, y);
+
+    vec3 result = vec3(0.0);
+    for (uint ii = 0; ii < SKY_IBL_SH_COEFFS; ++ii)
+        result += _sh[ii].xyz * y[ii];
+
+    return max(result, vec3(0.0));
+}
+
+vec2 hammersley(uint _idx, uint _count)
+{
+    uint bits = bitfieldReverse(_idx);
+    return vec2(float(_idx) / float(_count), float(bits) * 2.3283064365386963e-10);
+}
+
+// the half vector around _n, _linearRough is the alpha of the ggx
+vec3 importanceSampleGGX(vec2 _xi, vec3 _n, float _linearRough)
+{
+    float a2 = _linearRough * _linearRough;
+    float phi = 2.0 * SKY_IBL_PI * _xi.x;
+    float cosTheta = sqrt((1.0 - _xi.y) / (1.0 + (a2 - 1.0) * _xi.y));
+    float sinTheta = sqrt(1.0 - cosTheta * cosTheta);
+
+    vec3 h = vec3(sinTheta * cos(phi), sinTheta * sin(phi), cosTheta);
+
+    vec3 up = abs(_n.z) < 0.999 ? vec3(0.0, 0.0, 1.0) : vec3(1.0, 0.0, 0.0);
+    vec3 tx = normalize(cross(up, _n));
+    vec3 ty = cross(_n, tx);
+
+    return normalize(tx * h.x + ty * h.y + _n * h.z);
+}
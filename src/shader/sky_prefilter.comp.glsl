@@ -0,0 +1,56 @@
+#version 450
+
+#extension GL_GOOGLE_include_directive: require
+
+#include "sky_ibl.h"
+
+// one thread per texel of a mip, z is the face
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+
+layout(push_constant) uniform blocks
+{
+    uint mip;
+    uint size;
+    float linearRough;
+    uint sampleCount;
+};
+
+layout(binding = 0) uniform samplerCube in_sky;
+layout(binding = 1, rgba16f) uniform writeonly imageCube out_specular;
+
+void main()
+{
+    uvec3 pos = gl_GlobalInvocationID;
+    if (pos.x >= size || pos.y >= size)
+        return;
+
+    vec2 uv = (vec2(pos.xy) + 0.5) / float(size) * 2.0 - 1.0;
+
+    // n = v = r, the split sum approximation
+    vec3 n = skyCubeDir(pos.z, uv);
+
+    vec3 color = vec3(0.0);
+    float weight = 0.0;
+    if (mip == 0)
+    {
+        color = textureLod(in_sky, n, 0.0).rgb;
+        weight = 1.0;
+    }
+    else
+    {
+        for (uint ii = 0; ii < sampleCount; ++ii)
+        {
+            vec3 h = importanceSampleGGX(hammersley(ii, sampleCount), n, linearRough);
+            vec3 l = normalize(2.0 * dot(n, h) * h - n);
+
+            float nol = dot(n, l);
+            if (nol > 0.0)
+            {
+                color += textureLod(in_sky, l, 0.0).rgb * nol;
+                weight += nol;
+            }
+        }
+    }
+
+    imageStore(out_specular, ivec3(pos), vec4(color / max(weight, 1e-4), 1.0));
+}
@@ -0,0 +1,64 @@
+#version 450
+
+#extension GL_GOOGLE_include_directive: require
+
+#include "sky_ibl.h"
+
+// a single workgroup, the sky is projected on a SKY_IBL_SH_SIZE^2 grid of each face
+// 64 threads keep s_sh at 64 * 9 * 16 bytes, well below the guaranteed 16KB of shared memory
+#define SKY_SH_THREADS 64
+
+layout(local_size_x = SKY_SH_THREADS, local_size_y = 1, local_size_z = 1) in;
+
+layout(binding = 0) uniform samplerCube in_sky;
+
+layout(binding = 1) writeonly buffer SkySH
+{
+    vec4 out_sh [SKY_IBL_SH_COEFFS];
+};
+
+shared vec3 s_sh[SKY_SH_THREADS][SKY_IBL_SH_COEFFS];
+
+void main()
+{
+    uint tid = gl_LocalInvocationID.x;
+
+    vec3 sh[SKY_IBL_SH_COEFFS];
+    for (uint cc = 0; cc < SKY_IBL_SH_COEFFS; ++cc)
+        sh[cc] = vec3(0.0);
+
+    const uint faceTexels = SKY_IBL_SH_SIZE * SKY_IBL_SH_SIZE;
+    for (uint ii = tid; ii < faceTexels * 6; ii += SKY_SH_THREADS)
+    {
+        uint face = ii / faceTexels;
+        uvec2 pos = uvec2(ii % SKY_IBL_SH_SIZE, (ii % faceTexels) / SKY_IBL_SH_SIZE);
+
+        vec2 uv = (vec2(pos) + 0.5) / float(SKY_IBL_SH_SIZE) * 2.0 - 1.0;
+        vec3 dir = skyCubeDir(face, uv);
+        vec3 radiance = textureLod(in_sky, dir, 0.0).rgb * skyCubeTexelSolidAngle(pos, SKY_IBL_SH_SIZE);
+
+        float y[SKY_IBL_SH_COEFFS];
+        skySHBasis(dir, y);
+
+        for (uint cc = 0; cc < SKY_IBL_SH_COEFFS; ++cc)
+            sh[cc] += radiance * y[cc];
+    }
+
+    for (uint cc = 0; cc < SKY_IBL_SH_COEFFS; ++cc)
+        s_sh[tid][cc] = sh[cc];
+
+    barrier();
+
+    for (uint stride = SKY_SH_THREADS / 2; stride > 0; stride >>= 1)
+    {
+        if (tid < stride)
+        {
+            for (uint cc = 0; cc < SKY_IBL_SH_COEFFS; ++cc)
+                s_sh[tid][cc] += s_sh[tid + stride][cc];
+        }
+        barrier();
+    }
+
+    if (tid < SKY_IBL_SH_COEFFS)
+        out_sh[tid] = vec4(s_sh[0][tid] * skySHBandFactor(tid), 0.0);
+}
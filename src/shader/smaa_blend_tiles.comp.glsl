@@ -0,0 +1,82 @@
+# version 450
+
+# extension GL_EXT_shader_16bit_storage: require
+# extension GL_EXT_shader_8bit_storage: require
+# extension GL_GOOGLE_include_directive: require
+
+layout(push_constant) uniform blocks
+{
+    vec2 imageSize;
+    uint tileCountX;
+    uint padding0;
+};
+
+#include "smaa_impl.h"
+#include "smaa_inno.h"
+
+layout(local_size_x = SMAA_TILE_SIZE, local_size_y = SMAA_TILE_SIZE, local_size_z = 1) in;
+
+layout(binding = 0) uniform SMAATexture2D(in_weight); // point sampler
+layout(binding = 1) uniform SMAATexture2D(in_color);
+layout(binding = 2) uniform writeonly image2D out_img;
+
+layout(binding = 3) readonly buffer TileMask
+{
+    uint tileMask[];
+};
+
+bool hasEdges(ivec2 _pos)
+{
+    ivec2 tile = min(_pos, ivec2(imageSize) - 1) / SMAA_TILE_SIZE;
+    return tileMask[tile.y * tileCountX + tile.x] != 0;
+}
+
+// the weight image is only written in the edge tiles
+vec4 loadWeight(ivec2 _pos)
+{
+    return hasEdges(_pos) ? SMAALoad(in_weight, _pos) : vec4(0.0);
+}
+
+// SMAANeighborhoodBlendingCS, reads the weights only where the tiles have edges
+void main()
+{
+    ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThanEqual(pos, ivec2(imageSize))))
+        return;
+
+    vec2 texcoord = (vec2(pos) + 0.5) * SMAA_RT_METRICS.xy;
+
+    vec4 a = vec4(0.0);
+    if (hasEdges(pos) || hasEdges(pos + ivec2(1, 0)) || hasEdges(pos + ivec2(0, API_V_DIR(1))))
+    {
+        a.x = loadWeight(pos + ivec2(1, 0)).a; // Right
+        a.y = loadWeight(pos + ivec2(0, API_V_DIR(1))).g; // Top
+        a.wz = loadWeight(pos).xz; // Bottom / Left
+    }
+
+    vec4 color;
+    if (dot(a, vec4(1.0)) < 1e-5)
+    {
+        color = SMAASampleLevelZero(in_color, texcoord);
+    }
+    else
+    {
+        bool h = max(a.x, a.z) > max(a.y, a.w); // max(horizontal) > max(vertical)
+
+        // Calculate the blending offsets:
+        vec4 blendingOffset = vec4(0.0, API_V_DIR(a.y), 0.0, API_V_DIR(a.w));
+        vec2 blendingWeight = a.yw;
+        SMAAMovc(bvec4(h, h, h, h), blendingOffset, vec4(a.x, 0.0, a.z, 0.0));
+        SMAAMovc(bvec2(h, h), blendingWeight, a.xz);
+        blendingWeight /= dot(blendingWeight, vec2(1.0));
+
+        // Calculate the texture coordinates:
+        vec4 blendingCoord = mad(blendingOffset, vec4(SMAA_RT_METRICS.xy, -SMAA_RT_METRICS.xy), texcoord.xyxy);
+
+        // bilinear filtering mixes the current pixel with the chosen neighbor
+        color = blendingWeight.x * SMAASampleLevelZero(in_color, blendingCoord.xy);
+        color += blendingWeight.y * SMAASampleLevelZero(in_color, blendingCoord.zw);
+    }
+
+    imageStore(out_img, pos, color);
+}
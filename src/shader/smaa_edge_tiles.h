@@ -0,0 +1,98 @@
+// the edges of the tiled smaa mode
+// and appends the tile to the list for the weight pass if any pixel in it has an edge
+// SMAA_EDGE_SOURCE must be defined before including this file
+// 0: luma, the same as smaa_edge_luma.comp.glsl
+// 1: color, the same as smaa_edge_color.comp.glsl
+// 2: depth, the same as smaa_edge_depth.comp.glsl, in_color is the depth then
+// keep sync with SMAAEdgeSource in vkz_smaa_pip.h
+
+# extension GL_EXT_shader_16bit_storage: require
+# extension GL_EXT_shader_8bit_storage: require
+
+layout(push_constant) uniform blocks
+{
+    vec2 imageSize;
+};
+
+#include "smaa_impl.h"
+#include "smaa_inno.h"
+
+layout(local_size_x = SMAA_TILE_SIZE, local_size_y = SMAA_TILE_SIZE, local_size_z = 1) in;
+
+layout(binding = 0) uniform SMAATexture2D(in_color); // point sampler
+layout(binding = 1) uniform writeonly image2D out_edge;
+
+// one flag per tile, the blend skips the weights of the tiles without edges
+layout(binding = 2) writeonly buffer TileMask
+{
+    uint tileMask[];
+};
+
+// the tiles with edges, packed as x | y << 16
+layout(binding = 3) writeonly buffer TileList
+{
+    uint tiles[];
+};
+
+// the same layout as IndirectDispatchCommand
+layout(binding = 4) buffer TileCmd
+{
+    uint count;
+    uint local_x;
+    uint local_y;
+    uint local_z;
+} tileCmd;
+
+shared uint s_hasEdge;
+
+vec2 detectEdge(ivec2 _pos)
+{
+#if SMAA_EDGE_SOURCE == 2
+    return SMAADepthEdgeDetectionCSInno(_pos, in_color);
+#elif SMAA_EDGE_SOURCE == 1
+    return SMAAColorEdgeDetectionCSInno(_pos, in_color);
+#else
+    return SMAALumaEdgeDetectionCSInno(_pos, in_color);
+#endif // SMAA_EDGE_SOURCE
+}
+
+void main()
+{
+    ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
+    uint li = gl_LocalInvocationIndex;
+
+    if (li == 0)
+        s_hasEdge = 0;
+
+    if (gl_GlobalInvocationID.x == 0 && gl_GlobalInvocationID.y == 0)
+    {
+        tileCmd.local_y = 1;
+        tileCmd.local_z = 1;
+    }
+
+    barrier();
+
+    bool inside = all(lessThan(pos, ivec2(imageSize)));
+    vec2 edge = inside ? detectEdge(pos) : vec2(0.0);
+
+    if (inside)
+        imageStore(out_edge, pos, vec4(edge.xy, 0.0, 0.0));
+
+    if (dot(edge, vec2(1.0)) > 0.0)
+        atomicOr(s_hasEdge, 1);
+
+    barrier();
+
+    if (li == 0)
+    {
+        uint tileIdx = gl_WorkGroupID.y * gl_NumWorkGroups.x + gl_WorkGroupID.x;
+        tileMask[tileIdx] = s_hasEdge;
+
+        if (s_hasEdge != 0)
+        {
+            uint slot = atomicAdd(tileCmd.count, 1);
+            tiles[slot] = gl_WorkGroupID.x | (gl_WorkGroupID.y << 16);
+            atomicAdd(tileCmd.local_x, 1);
+        }
+    }
+}
@@ -0,0 +1,7 @@
+# version 450
+
+# extension GL_GOOGLE_include_directive: require
+
+// the depth edges of the tiled mode
+#define SMAA_EDGE_SOURCE 2
+#include "smaa_edge_tiles.h"
@@ -0,0 +1,44 @@
+# version 450
+
+# extension GL_EXT_shader_16bit_storage: require
+# extension GL_EXT_shader_8bit_storage: require
+# extension GL_GOOGLE_include_directive: require
+
+layout(push_constant) uniform blocks
+{
+    uvec2 imageSize;
+    vec4 subsampleIndices;
+};
+
+#include "smaa_impl.h"
+#include "smaa_inno.h"
+
+layout(local_size_x = SMAA_TILE_SIZE, local_size_y = SMAA_TILE_SIZE, local_size_z = 1) in;
+
+layout(binding = 0) uniform SMAATexture2D(in_edge);
+layout(binding = 1) uniform SMAATexture2D(in_edgePoint);
+layout(binding = 2) uniform SMAATexture2D(in_area);
+layout(binding = 3) uniform SMAATexture2D(in_search);
+
+layout(binding = 4) uniform writeonly image2D out_img;
+
+layout(binding = 5) readonly buffer TileList
+{
+    uint tiles[];
+};
+
+// a workgroup per edge tile, dispatched indirectly by smaa_edge_tiles.comp.glsl
+// the weights of the other tiles are never written, the blend treats them as 0
+void main()
+{
+    uint tile = tiles[gl_WorkGroupID.x];
+    ivec2 tilePos = ivec2(tile & 0xFFFF, tile >> 16);
+    ivec2 pos = tilePos * SMAA_TILE_SIZE + ivec2(gl_LocalInvocationID.xy);
+
+    if (any(greaterThanEqual(pos, ivec2(imageSize))))
+        return;
+
+    vec4 weight = SMAABlendingWeightCalculationCSInno(pos, out_img, in_edgePoint, in_edge, in_area, in_search, subsampleIndices);
+
+    imageStore(out_img, pos, weight);
+}
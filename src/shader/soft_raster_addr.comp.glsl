@@ -0,0 +1,7 @@
+# version 450
+
+# extension GL_GOOGLE_include_directive: require
+
+// the vertices, meshlets and meshlet data are read through the scene address block
+#define USE_SCENE_ADDRESS 1
+#include "soft_raster.h"
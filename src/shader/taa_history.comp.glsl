@@ -0,0 +1,17 @@
+# version 450
+
+// copies the resolved color to the history of the next frame, see vkz_taa.h
+
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+
+layout(binding = 0, rgba8) uniform readonly image2D in_color;
+layout(binding = 1) uniform writeonly image2D out_history;
+
+void main()
+{
+    ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThanEqual(pos, imageSize(in_color))))
+        return;
+
+    imageStore(out_history, pos, imageLoad(in_color, pos));
+}
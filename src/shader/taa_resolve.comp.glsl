@@ -0,0 +1,110 @@
+# version 450
+
+# extension GL_GOOGLE_include_directive: require
+
+// temporal upscaling resolve, keep sync with vkz_taa.h
+// runs at the output resolution, the current frame is at the render resolution and jittered
+
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+
+layout(push_constant) uniform block
+{
+    vec2 renderSize;
+    vec2 outSize;
+
+    vec2 jitter; // in ndc
+    float feedback;
+    uint reset;
+};
+
+layout(binding = 0) uniform sampler2D in_color;
+layout(binding = 1) uniform sampler2D in_depth;
+layout(binding = 2) uniform sampler2D in_velocity;
+layout(binding = 3) uniform sampler2D in_history;
+layout(binding = 4) uniform writeonly image2D out_color;
+
+vec3 rgbToYCoCg(vec3 _c)
+{
+    return vec3(
+        0.25 * _c.r + 0.5 * _c.g + 0.25 * _c.b
+        , 0.5 * _c.r - 0.5 * _c.b
+        , -0.25 * _c.r + 0.5 * _c.g - 0.25 * _c.b
+    );
+}
+
+vec3 yCoCgToRgb(vec3 _c)
+{
+    return vec3(_c.x + _c.y - _c.z, _c.x + _c.z, _c.x - _c.y - _c.z);
+}
+
+// clips the history towards the center of the neighborhood box instead of clamping each channel
+vec3 clipToAABB(vec3 _history, vec3 _min, vec3 _max)
+{
+    vec3 center = 0.5 * (_max + _min);
+    vec3 extents = 0.5 * (_max - _min) + 1e-5;
+
+    vec3 offset = _history - center;
+    vec3 ts = abs(extents / (offset + 1e-7));
+    float t = clamp(min(ts.x, min(ts.y, ts.z)), 0.0, 1.0);
+
+    return center + offset * t;
+}
+
+void main()
+{
+    ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThanEqual(pos, ivec2(outSize))))
+        return;
+
+    vec2 uv = (vec2(pos) + 0.5) / outSize;
+
+    // the scene at uv is shifted by the jitter in the current frame
+    vec2 currUv = uv + jitter * 0.5;
+    ivec2 renderPos = clamp(ivec2(currUv * renderSize), ivec2(0), ivec2(renderSize) - 1);
+
+    // the neighborhood box in YCoCg, the velocity is taken from the closest sample to keep the edges of the moving objects
+    vec3 boxMin = vec3(1e10);
+    vec3 boxMax = vec3(-1e10);
+    float closestDepth = 0.0;
+    ivec2 closestPos = renderPos;
+    for (int yy = -1; yy <= 1; ++yy)
+    {
+        for (int xx = -1; xx <= 1; ++xx)
+        {
+            ivec2 p = clamp(renderPos + ivec2(xx, yy), ivec2(0), ivec2(renderSize) - 1);
+
+            vec3 c = rgbToYCoCg(texelFetch(in_color, p, 0).rgb);
+            boxMin = min(boxMin, c);
+            boxMax = max(boxMax, c);
+
+            // reversed z, the larger is closer
+            float d = texelFetch(in_depth, p, 0).x;
+            if (d > closestDepth)
+            {
+                closestDepth = d;
+                closestPos = p;
+            }
+        }
+    }
+
+    vec3 curr = rgbToYCoCg(texture(in_color, currUv).rgb);
+
+    vec2 velocity = texelFetch(in_velocity, closestPos, 0).xy;
+    vec2 prevUv = uv - velocity;
+
+    bool validHistory = (reset == 0) && all(greaterThanEqual(prevUv, vec2(0.0))) && all(lessThanEqual(prevUv, vec2(1.0)));
+    if (!validHistory)
+    {
+        imageStore(out_color, pos, vec4(yCoCgToRgb(curr), 1.0));
+        return;
+    }
+
+    vec3 history = clipToAABB(rgbToYCoCg(texture(in_history, prevUv).rgb), boxMin, boxMax);
+
+    // weight by the inverse luma to keep the fireflies from dominating the history
+    float wCurr = (1.0 - feedback) / (1.0 + curr.x);
+    float wHistory = feedback / (1.0 + history.x);
+    vec3 result = (curr * wCurr + history * wHistory) / (wCurr + wHistory);
+
+    imageStore(out_color, pos, vec4(yCoCgToRgb(result), 1.0));
+}
@@ -0,0 +1,36 @@
+// ==============================================================================
+// texture streaming feedback, keep sync with vkz_texture_streaming.h
+// each texture keeps the finest level it is sampled with: 1 + log2 of the texture size that maps a texel to a pixel
+// 0 is for the textures not sampled since the last read back
+// TEX_FEEDBACK_BINDING must be defined before including this file
+
+#define TEX_FEEDBACK_TILE 4
+#define TEX_FEEDBACK_MAX_LEVEL 15
+
+layout(binding = TEX_FEEDBACK_BINDING) buffer TextureFeedback
+{
+    uint texFeedback [];
+};
+
+// all textures of a draw share the uv, so the level is the same for them
+uint textureFeedbackLevel(vec2 _uv)
+{
+    float footprint = max(max(length(dFdx(_uv)), length(dFdy(_uv))), 1e-8);
+    return uint(clamp(ceil(-log2(footprint)), 0.0, float(TEX_FEEDBACK_MAX_LEVEL))) + 1;
+}
+
+// one pixel of a TEX_FEEDBACK_TILE^2 tile writes, the pixel moves with the draw so the small draws are not missed
+bool textureFeedbackPixel(uint _drawId)
+{
+    uvec2 pix = uvec2(gl_FragCoord.xy) % TEX_FEEDBACK_TILE;
+    return (pix.x + pix.y * TEX_FEEDBACK_TILE) == (_drawId % (TEX_FEEDBACK_TILE * TEX_FEEDBACK_TILE));
+}
+
+// read first, most of the writes would not change the value and the atomics are on a few hot entries
+void writeTextureFeedback(uint _tex, uint _level)
+{
+    if (_tex > 0 && texFeedback[_tex] < _level)
+    {
+        atomicMax(texFeedback[_tex], _level);
+    }
+}
@@ -0,0 +1,93 @@
+#version 450
+
+#extension GL_GOOGLE_include_directive: require
+
+#include "mesh_gpu.h"
+#include "math.h"
+
+layout(local_size_x = TRANSFORM_GP_SIZE, local_size_y = 1, local_size_z = 1) in;
+
+layout(push_constant) uniform block
+{
+    uint mode;
+    uint offset;
+    uint count;
+    uint padding;
+};
+
+// read
+layout(binding = 0) readonly buffer NodeUpdates
+{
+    TransformNodeUpdate updates[];
+};
+
+layout(binding = 1) readonly buffer DrawNodes
+{
+    uint drawNodes[];
+};
+
+// read/write
+layout(binding = 2) buffer Nodes
+{
+    TransformNode nodes[];
+};
+
+layout(binding = 3) buffer WorldNodes
+{
+    TransformNode worlds[];
+};
+
+layout(binding = 4) buffer MeshDraws
+{
+    MeshDraw draws[];
+};
+
+layout(binding = 5) buffer PrevDraws
+{
+    TransformNode prevDraws[];
+};
+
+void main()
+{
+    uint ii = gl_GlobalInvocationID.x;
+    if (ii >= count)
+        return;
+
+    // copy the dirty local transforms to its place
+    if (mode == TRANSFORM_MODE_SCATTER)
+    {
+        TransformNodeUpdate update = updates[ii];
+        nodes[update.nodeIdx] = update.node;
+    }
+    // one dispatch for each level, the parents are resolved by the previous dispatch
+    else if (mode == TRANSFORM_MODE_RESOLVE)
+    {
+        uint ni = offset + ii;
+        TransformNode local = nodes[ni];
+        TransformNode world = local;
+
+        if (local.parent != TRANSFORM_INVALID_NODE)
+        {
+            TransformNode parent = worlds[local.parent];
+
+            world.pos = parent.pos + rotateQuat(parent.scale * local.pos, parent.orit);
+            world.orit = mulQuat(parent.orit, local.orit);
+            world.scale = parent.scale * local.scale;
+        }
+
+        worlds[ni] = world;
+    }
+    // write the world transform to the draws, the replaced one is kept for the motion
+    else if (mode == TRANSFORM_MODE_DRAWS)
+    {
+        TransformNode world = worlds[drawNodes[ii]];
+
+        prevDraws[ii].pos = draws[ii].pos;
+        prevDraws[ii].scale = draws[ii].scale;
+        prevDraws[ii].orit = draws[ii].orit;
+
+        draws[ii].pos = world.pos;
+        draws[ii].scale = world.scale;
+        draws[ii].orit = world.orit;
+    }
+}